@@ -1,9 +1,7 @@
-#include <math.h>
-#include <vector>
+#include <ctype.h>
+#include <string.h>
 #include "Calculator.hpp"
 
-using namespace std;
-
 LV_IMG_DECLARE(img_app_calculator);
 
 #define KEYBOARD_H_PERCENT      65
@@ -16,22 +14,28 @@ LV_IMG_DECLARE(img_app_calculator);
 #define LABEL_COLOR             lv_color_make(170, 170, 170)
 #define LABEL_FORMULA_LEN_MAX   256
 
+#define KEYBOARD_BTN_ZERO       25
+#define KEYBOARD_BTN_EQUAL      27
+
+// The keys are the ones of the expression, but "C", "=" and the backspace
 static const char *keyboard_map[] = {
-    "C", "/", "x", LV_SYMBOL_BACKSPACE, "\n",
-    "7", "8", "9", "-", "\n",
-    "4", "5", "6", "+", "\n",
-    "1", "2", "3", "%", "\n",
-    "0", ".", "=", ""
+    "sin", "cos", "tan", "ln", "log", "\n",
+    "C", "(", ")", "^", LV_SYMBOL_BACKSPACE, "\n",
+    "7", "8", "9", "sqrt", "/", "\n",
+    "4", "5", "6", "%", "x", "\n",
+    "1", "2", "3", "pi", "-", "\n",
+    "0", ".", "=", "+", ""
 };
 
 Calculator::Calculator():
-    ESP_Brookesia_PhoneApp("Calculator", &img_app_calculator, true)
+    ESP_Brookesia_PhoneApp("Calculator", &img_app_calculator, true),
+    expr(NULL)
 {
 }
 
 Calculator::~Calculator()
 {
-
+    calc_expr_del(expr);
 }
 
 bool Calculator::run(void)
@@ -39,7 +43,7 @@ bool Calculator::run(void)
     lv_area_t area = getVisualArea();
     _width = area.x2 - area.x1;
     _height = area.y2 - area.y1;
-    formula_len = 1;
+    calc_expr_clear(expr);
 
     int keyboard_h = (int)(_height * KEYBOARD_H_PERCENT / 100.0);
     int label_h = _height - keyboard_h;
@@ -47,12 +51,12 @@ bool Calculator::run(void)
 
     keyboard = lv_btnmatrix_create(lv_scr_act());
     lv_btnmatrix_set_map(keyboard, keyboard_map);
-    lv_btnmatrix_set_btn_width(keyboard, 18, 1);
+    lv_btnmatrix_set_btn_width(keyboard, KEYBOARD_BTN_ZERO, 2);
     lv_obj_set_size(keyboard, _width, keyboard_h);
     lv_obj_set_style_text_font(keyboard, KEYBOARD_FONT, 0);
     lv_obj_align(keyboard, LV_ALIGN_BOTTOM_MID, 0, 0);
     lv_obj_add_event_cb(keyboard, keyboard_event_cb, LV_EVENT_ALL, this);
-    lv_btnmatrix_set_btn_ctrl(keyboard, 18, LV_BTNMATRIX_CTRL_CHECKED);
+    lv_btnmatrix_set_btn_ctrl(keyboard, KEYBOARD_BTN_EQUAL, LV_BTNMATRIX_CTRL_CHECKED);
     lv_obj_set_style_border_width(keyboard, 0, 0);
     lv_obj_set_style_radius(keyboard, 0, 0);
 
@@ -90,7 +94,8 @@ bool Calculator::run(void)
     lv_obj_align(formula_label, LV_ALIGN_RIGHT_MID, 0, 0);
     lv_obj_set_style_text_align(formula_label, LV_TEXT_ALIGN_RIGHT, 0);
     lv_obj_set_style_text_font(formula_label, LABEL_FONT_BIG, 0);
-    lv_label_set_text(formula_label, "0");
+    // The labels show the text of the expression and of the result, they are not copied on each key
+    lv_label_set_text_static(formula_label, calc_expr_get_text(expr));
 
     lv_obj_t *result_label_obj = lv_obj_create(label_obj);
     lv_obj_set_size(result_label_obj, _width, text_h / 3);
@@ -104,7 +109,8 @@ bool Calculator::run(void)
     lv_obj_align(result_label, LV_ALIGN_RIGHT_MID, 0, 0);
     lv_obj_set_style_text_color(result_label, LABEL_COLOR, 0);
     lv_obj_set_style_text_align(result_label, LV_TEXT_ALIGN_RIGHT, 0);
-    lv_label_set_text(result_label, "= 0");
+    strcpy(result_text, "= 0");
+    lv_label_set_text_static(result_label, result_text);
 
     return true;
 }
@@ -130,153 +136,56 @@ bool Calculator::close(void)
 
 bool Calculator::init(void)
 {
-
-    return true;
-}
-
-bool Calculator::isStartZero(void)
-{
-    const char *text = lv_label_get_text(formula_label);
-    int text_len = strlen(text);
-
-    if ((text_len == 1) && (text[0] == '0')) {
-        // LOG_I(TAG, "start 0");
-        return true;
-    }
-    if ((text[text_len - 1] == '0') &&
-        (text[text_len - 2] > '9') &&
-        (text[text_len - 2] < '0')) {
-        // LOG_I(TAG, "start 0");
-        return true;
+    if (expr == NULL) {
+        expr = calc_expr_new();
     }
 
-    return false;
+    return (expr != NULL);
 }
 
-bool Calculator::isStartNum(void)
+void Calculator::updatePreview(void)
 {
-    const char *text = lv_label_get_text(formula_label);
-    int text_len = strlen(text);
-
-    if ((text[text_len - 1] >= '0') && (text[text_len - 1] <= '9')) {
-        // LOG_I(TAG, "start num");
-        return true;
+    double value = 0;
+
+    lv_label_set_text_static(formula_label, calc_expr_get_text(expr));
+    switch (calc_expr_preview(expr, &value)) {
+    case CALC_EXPR_OK:
+        strcpy(result_text, "= ");
+        calc_expr_format(value, result_text + 2, sizeof(result_text) - 2);
+        break;
+    case CALC_EXPR_ERR_MATH:
+        strcpy(result_text, "= Error");
+        break;
+    default:
+        strcpy(result_text, "= 0");
+        break;
     }
-
-    return false;
+    lv_label_set_text_static(result_label, result_text);
 }
 
-bool Calculator::isStartPercent(void)
+void Calculator::showResult(void)
 {
-    const char *text = lv_label_get_text(formula_label);
-    int text_len = strlen(text);
+    double value = 0;
+    char history_str[LABEL_FORMULA_LEN_MAX + sizeof(result_text) + 4];
+    int ret = calc_expr_preview(expr, &value);
 
-    if (text[text_len - 1] == '%') {
-        // LOG_I(TAG, "start %");
-        return true;
+    if (ret == CALC_EXPR_ERR_EMPTY) {
+        return;
     }
 
-    return false;
-}
-
-bool Calculator::isLegalDot(void)
-{
-    const char *text = lv_label_get_text(formula_label);
-    int text_len = strlen(text);
-
-    while (text_len-- > 0) {
-        if (text[text_len] == '.') {
-            // LOG_I(TAG, "illegal dot");
-            return false;
-        }
-        else if ((text[text_len] < '0') ||
-                 (text[text_len] > '9')) {
-            return true;
-        }
-    }
-
-    return true;
-}
-
-double Calculator::calculate(const char *input)
-{
-    vector<double> stk;
-    int input_len = strlen(input);
-    double num = 0;
-    bool dot_flag = false;
-    int dot_len = 0;
-    char pre_sign = '+';
-
-    for (int i = 0; i < input_len; i++) {
-        if (input[i] == '.') {
-            dot_flag = true;
-            dot_len = 0;
-        }
-        else if (isdigit(input[i])) {
-            if (!dot_flag) {
-                num = num * 10 + input[i] - '0';
-            }
-            else {
-                num += (input[i] - '0') / pow(10.0, ++dot_len);
-            }
-        }
-        else if (input[i] == '%') {
-            num /= 100.0;
-        }
-        else if (i != input_len - 1){
-            dot_flag = false;
-            dot_len = 0;
-            switch (pre_sign) {
-                case '+':
-                    stk.push_back(num);
-                    break;
-                case '-':
-                    stk.push_back(-num);
-                    break;
-                case 'x':
-                    stk.back() *= num;
-                    break;
-                default:
-                    if (num != 0) {
-                        stk.back() /= num;
-                    }
-                    else {
-                        return 0;
-                    }
-            }
-            num = 0;
-            pre_sign = input[i];
-        }
+    updatePreview();
+    lv_obj_set_style_text_font(result_label, LABEL_FONT_BIG, 0);
 
-        if (i == input_len - 1) {
-            switch (pre_sign) {
-                case '+':
-                    stk.push_back(num);
-                    break;
-                case '-':
-                    stk.push_back(-num);
-                    break;
-                case 'x':
-                    stk.back() *= num;
-                    break;
-                default:
-                    if (num != 0) {
-                        stk.back() /= num;
-                    }
-                    else {
-                        return 0;
-                    }
-            }
-            num = 0;
-        }
-    }
+    snprintf(history_str, sizeof(history_str), "\n%s %s ", calc_expr_get_text(expr), result_text);
+    lv_textarea_set_cursor_pos(history_label, LV_TEXTAREA_CURSOR_LAST);
+    lv_textarea_add_text(history_label, history_str);
 
-    for (int i = 0; i < stk.size(); i++) {
-        num += stk.at(i);
+    // An error is kept in the formula to be corrected, a result goes on with the next operator
+    if (ret == CALC_EXPR_OK) {
+        calc_expr_set_value(expr, value);
+        lv_label_set_text_static(formula_label, calc_expr_get_text(expr));
+        lv_obj_set_style_text_font(formula_label, LABEL_FONT_SMALL, 0);
     }
-    // LOG_I(TAG, "cal: %s = %f", input, num);
-
-    return num;
 }
 
 void Calculator::keyboard_event_cb(lv_event_t *e)
@@ -289,151 +198,43 @@ void Calculator::keyboard_event_cb(lv_event_t *e)
 
         /* When the button matrix draws the buttons... */
         if(dsc->class_p == &lv_btnmatrix_class && dsc->type == LV_BTNMATRIX_DRAW_PART_BTN) {
-            /*Change the draw descriptor the 0/1/2/3/7/11/15nd button*/
-            if((dsc->id == 0) || (dsc->id == 1) ||
-               (dsc->id == 2) || (dsc->id == 3) ||
-               (dsc->id == 7) || (dsc->id == 11) ||
-               (dsc->id == 15)) {
+            /*Change the draw descriptor of the buttons which are not a digit or the dot*/
+            const char *key = lv_btnmatrix_get_btn_text(app->keyboard, dsc->id);
+            if ((key != NULL) && !isdigit((unsigned char)key[0]) && (key[0] != '.')) {
                 dsc->label_dsc->color = KEYBOARD_SPECIAL_COLOR;
             }
         }
     } else if (code == LV_EVENT_VALUE_CHANGED) {
-        int btn_id = lv_btnmatrix_get_selected_btn(app->keyboard);
-        bool calculate_flag = false;
-        bool equal_flag = false;
-        double res_num;
-        char res_str[32];
-        char history_str[32];
+        uint16_t btn_id = lv_btnmatrix_get_selected_btn(app->keyboard);
+        const char *key = lv_btnmatrix_get_btn_text(app->keyboard, btn_id);
+        bool is_changed = false;
+
+        if (key == NULL) {
+            return;
+        }
 
         if (lv_obj_get_style_text_font(app->formula_label, 0) == LABEL_FONT_SMALL) {
             lv_obj_set_style_text_font(app->formula_label, LABEL_FONT_BIG, 0);
             lv_obj_set_style_text_font(app->result_label, LABEL_FONT_SMALL, 0);
         }
 
-        switch (btn_id) {
-        // "C"
-        case 0:
-            lv_label_set_text(app->formula_label, "0");
-            app->formula_len = 1;
-            calculate_flag = true;
-            break;
-        // "<"
-        case 3:
-            if ((app->formula_len == 1) && app->isStartZero()) {
-                break;
-            }
-            lv_label_cut_text(
-                app->formula_label,
-                --(app->formula_len),
-                1
-            );
-            if (app->formula_len == 0) {
-                lv_label_set_text(app->formula_label, "0");
-                app->formula_len = 1;
-            }
-            calculate_flag = true;
-            break;
-        // "="
-        case 18:
-            calculate_flag = true;
-            equal_flag = true;
-            break;
-        // "/,X,-,+,%"
-        case 1:
-        case 2:
-        case 7:
-        case 11:
-        case 15:
-            // Need number or percent
-            if (app->isStartPercent() ||
-                app->isStartNum()) {
-                // Firstly input "+, -"
-                if (((btn_id == 7) || (btn_id == 11)) &&
-                    (app->isStartZero())) {
-                    // Remove "0"
-                    lv_label_cut_text(
-                        app->formula_label,
-                        --(app->formula_len),
-                        1
-                    );
-                }
-                lv_label_ins_text(
-                    app->formula_label,
-                    app->formula_len++,
-                    lv_btnmatrix_get_btn_text(app->keyboard, btn_id)
-                );
-                if (btn_id == 15) {
-                    calculate_flag = true;
-                }
-            }
-            break;
-        // "1234567890"
-        case 4:
-        case 5:
-        case 6:
-        case 8:
-        case 9:
-        case 10:
-        case 12:
-        case 13:
-        case 14:
-        case 16:
-            // Remove First "0"
-            if (app->isStartZero()) {
-                lv_label_cut_text(
-                    app->formula_label,
-                    --(app->formula_len),
-                    1
-                );
-            }
-            // Except "%"
-            if (!app->isStartPercent()) {
-                lv_label_ins_text(
-                    app->formula_label,
-                    app->formula_len++,
-                    lv_btnmatrix_get_btn_text(app->keyboard, btn_id)
-                );
-                calculate_flag = true;
-            }
-            break;
-        // "."
-        case 17:
-            if (app->isLegalDot() && app->isStartNum()) {
-                lv_label_ins_text(
-                    app->formula_label,
-                    app->formula_len++,
-                    "."
-                );
-            }
-            break;
-        default:
-            break;
+        if (strcmp(key, "=") == 0) {
+            app->showResult();
+            return;
         }
 
-        if (calculate_flag) {
-            lv_obj_set_style_text_font(app->formula_label, LABEL_FONT_BIG, 0);
-
-            res_num = app->calculate(lv_label_get_text(app->formula_label));
-            if (int(res_num) == res_num) {
-                snprintf(res_str, sizeof(res_str) - 1, "%ld", long(res_num));
-            }
-            else {
-                snprintf(res_str, sizeof(res_str) - 1, "%.6f", res_num);
-            }
-            lv_label_set_text_fmt(app->result_label, "= %s", res_str);
-            lv_obj_set_style_text_font(app->result_label, LABEL_FONT_SMALL, 0);
+        if (strcmp(key, "C") == 0) {
+            calc_expr_clear(app->expr);
+            is_changed = true;
+        } else if (strcmp(key, LV_SYMBOL_BACKSPACE) == 0) {
+            is_changed = calc_expr_backspace(app->expr);
+        } else {
+            is_changed = calc_expr_input(app->expr, key);
         }
 
-        if (equal_flag) {
-            lv_obj_set_style_text_font(app->result_label, LABEL_FONT_BIG, 0);
-
-            snprintf(history_str, sizeof(history_str) - 1, "\n%s = %s ", lv_label_get_text(app->formula_label), res_str);
-            lv_textarea_set_cursor_pos(app->history_label, strlen(lv_textarea_get_text(app->history_label)));
-            lv_textarea_add_text(app->history_label, history_str);
-
-            lv_label_set_text_fmt(app->formula_label, "%s", res_str);
-            lv_obj_set_style_text_font(app->formula_label, LABEL_FONT_SMALL, 0);
-            app->formula_len = strlen(history_str);
+        // The expression is evaluated as it's typed, so the result is the preview
+        if (is_changed) {
+            app->updatePreview();
         }
     }
 }
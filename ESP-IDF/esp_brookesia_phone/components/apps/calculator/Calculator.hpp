@@ -2,6 +2,7 @@
 
 #include "lvgl.h"
 #include "esp_brookesia.hpp"
+#include "calc_expr.h"
 
 class Calculator: public ESP_Brookesia_PhoneApp
 {
@@ -15,13 +16,11 @@ public:
 
     bool init(void) override;
 
-    bool isStartZero(void);
-    bool isStartNum(void);
-    bool isStartPercent(void);
-    bool isLegalDot(void);
-    double calculate(const char *input);
+    void updatePreview(void);
+    void showResult(void);
 
-    int formula_len;
+    calc_expr_t *expr;
+    char result_text[48];
     lv_obj_t *keyboard;
     lv_obj_t *history_label;
     lv_obj_t *formula_label;
@@ -80,6 +80,7 @@ Camera::Camera(uint16_t hor_res, uint16_t ver_res):
     _img_album_dsc_size(hor_res > ver_res ? ver_res : hor_res),
     _img_album_buffer(NULL),
     _camera_init_sem(NULL),
+    _camera_probed(false),
     _camera_ctlr_handle(0)
 {
     _img_album_buf_bytes = _img_album_dsc_size * _img_album_dsc_size * sizeof(lv_color_t);
@@ -249,22 +250,8 @@ bool Camera::init(void)
     xEventGroupClearBits(camera_event_group, CAMERA_EVENT_PED_DETECT);
     xEventGroupClearBits(camera_event_group, CAMERA_EVENT_HUMAN_DETECT);
 
-    i2c_master_bus_handle_t i2c_bus_handle = bsp_i2c_get_handle();
-    esp_err_t ret = app_video_main(i2c_bus_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "video main init failed with error 0x%x", ret);
-    }
-
-    // Open the video device
-    _camera_ctlr_handle = app_video_open(EXAMPLE_CAM_DEV_PATH, APP_VIDEO_FMT_RGB565);
-    if (_camera_ctlr_handle < 0) {
-        ESP_LOGE(TAG, "video cam open failed");
-
-        if (ESP_OK == i2c_master_probe(i2c_bus_handle, ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS, 100) || ESP_OK == i2c_master_probe(i2c_bus_handle, ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP, 100)) {
-            ESP_LOGI(TAG, "gt911 touch found");
-        } else {
-            ESP_LOGE(TAG, "Touch not found");
-        }
+    if (!_camera_probed) {
+        probe();
     }
 
     ESP_ERROR_CHECK(esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &data_cache_line_size));
@@ -324,6 +311,30 @@ bool Camera::init(void)
     return true;
 }
 
+bool Camera::probe(void)
+{
+    i2c_master_bus_handle_t i2c_bus_handle = bsp_i2c_get_handle();
+    esp_err_t ret = app_video_main(i2c_bus_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "video main init failed with error 0x%x", ret);
+    }
+
+    // Open the video device
+    _camera_ctlr_handle = app_video_open(EXAMPLE_CAM_DEV_PATH, APP_VIDEO_FMT_RGB565);
+    if (_camera_ctlr_handle < 0) {
+        ESP_LOGE(TAG, "video cam open failed");
+
+        if (ESP_OK == i2c_master_probe(i2c_bus_handle, ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS, 100) || ESP_OK == i2c_master_probe(i2c_bus_handle, ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP, 100)) {
+            ESP_LOGI(TAG, "gt911 touch found");
+        } else {
+            ESP_LOGE(TAG, "Touch not found");
+        }
+    }
+    _camera_probed = true;
+
+    return (_camera_ctlr_handle >= 0);
+}
+
 int Camera::get_camera_ctlr_handle(void)
 {
     return _camera_ctlr_handle;
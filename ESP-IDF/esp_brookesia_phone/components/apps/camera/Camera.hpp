@@ -25,6 +25,13 @@ public:
 
     bool init(void) override;
 
+    /**
+     * Open the camera sensor, `init()` does it if it wasn't done before. It doesn't use LVGL, so it can run before
+     * the app is installed, in parallel with the UI.
+     *
+     * @return true if the sensor is opened
+     */
+    bool probe(void);
     int get_camera_ctlr_handle(void);
 
 private:
@@ -44,6 +51,7 @@ private:
     uint32_t _img_album_buf_bytes;
     uint8_t *_img_album_buffer;
     SemaphoreHandle_t _camera_init_sem;
+    bool _camera_probed;
     int _camera_ctlr_handle;
     lv_img_dsc_t _img_refresh_dsc;
     lv_img_dsc_t _img_album_dsc;
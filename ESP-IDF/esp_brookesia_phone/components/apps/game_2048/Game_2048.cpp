@@ -4,6 +4,8 @@
 #include "bsp/esp-bsp.h"
 #include "Game_2048.hpp"
 #include "esp_log.h"
+#include "settings_store_nvs.h"
+#include "game_2048_solver.h"
 
 #define ENABLE_CELL_DEBUG       (0)
 
@@ -27,11 +29,11 @@
 #define CELL_OPA_2				LV_OPA_COVER
 
 #define ANIM_PERIOD				200
+#define HINT_POLL_PERIOD		50
 
 #define EMOJI_SCORE_NORMAL		8
 #define EMOJI_SCORE_GOOD		64
 
-#define NVS_STORAGE_NAMESPACE   "storage"
 #define NVS_BEST_SCORE          "score"
 #define MUSIC_DIR               "/2048"
 #define MUSIC_WEAK              BSP_SPIFFS_MOUNT_POINT MUSIC_DIR "/weak.mp3"
@@ -41,12 +43,15 @@
 
 #define randint_between(min, max)		(rand() % (max - min) + min)
 #define rand_1_2()						(randint_between(1, 2))
+/* The x or y of a cell has a bit per cell merged into it, a cell merges once per move */
+#define is_merged(mask)					(((mask) & ((mask) - 1)) != 0)
 
 using namespace std;
 
 static const char *TAG = "Game2048";
 static bool anim_running_flag = false;
 static bool generate_cell_flag = false;
+static const char *const hint_dir_names[GAME_2048_DIR_NUM] = {"up", "down", "left", "right"};
 
 LV_IMG_DECLARE(img_app_2048);
 LV_IMG_DECLARE(img_game2048_excellent);
@@ -64,14 +69,19 @@ Game2048::Game2048():
     current_score(0),
     best_score(0),
     _weight_max(0),
-    nvs_handle(NULL),
     _file_iterator(NULL),
     _cur_score_label(NULL),
     _best_score_label(NULL),
     _background_cells({}),
     _emoji_imgs({}),
     _emoji_label(NULL),
-    _foreground_grid(NULL)
+    _foreground_grid(NULL),
+    _gesture(NULL),
+    _solver(NULL),
+    _hint_timer(NULL),
+    _hint_btn_label(NULL),
+    _is_hint_pending(false),
+    _is_auto_play(false)
 {
     best_score = 0;
     for (int i = 0; i < 16; i++) {
@@ -217,6 +227,27 @@ bool Game2048::run(void)
     lv_label_set_text(title, "New Game");
     lv_obj_align(title, LV_ALIGN_CENTER, 0, 0);
 
+    btn = lv_btn_create(board);
+    // Size
+    lv_obj_set_size(btn, 100, 70);
+    // Position
+    lv_obj_align(btn, LV_ALIGN_BOTTOM_RIGHT, -170, -90);
+    // Shape
+    lv_obj_set_style_radius(btn, CELL_RADIUS, 0);
+    lv_obj_set_style_border_width(btn, 0, 0);
+    lv_obj_set_style_pad_all(btn, 10, 0);
+    // Background
+    lv_obj_set_style_bg_color(btn, GRID_BG_COLOR, 0);
+    // Others: a click shows the best move, a long press plays until the next swipe
+    lv_obj_add_event_cb(btn, hint_event_cb, LV_EVENT_SHORT_CLICKED, this);
+    lv_obj_add_event_cb(btn, hint_event_cb, LV_EVENT_LONG_PRESSED, this);
+
+    _hint_btn_label = lv_label_create(btn);
+    lv_obj_set_style_text_font(_hint_btn_label, SCORE_TITLE_FONT, 0);
+    lv_obj_set_style_text_color(_hint_btn_label, SCORE_TITLE_COLOR, 0);
+    lv_label_set_text(_hint_btn_label, "Hint");
+    lv_obj_align(_hint_btn_label, LV_ALIGN_CENTER, 0, 0);
+
     /* Setup grid */
     static lv_coord_t col_dsc[] = {CELL_SIZE, CELL_SIZE, CELL_SIZE, CELL_SIZE, LV_GRID_TEMPLATE_LAST};
     static lv_coord_t row_dsc[] = {CELL_SIZE, CELL_SIZE, CELL_SIZE, CELL_SIZE, LV_GRID_TEMPLATE_LAST};
@@ -275,6 +306,9 @@ bool Game2048::run(void)
     /* Add motion detect module */
     lv_obj_add_event_cb(_gesture->getEventObj(), motion_event_cb, _gesture->getReleaseEventCode(), this);
 
+    /* The hints are searched by the solver's worker, and polled here in the UI task */
+    _hint_timer = lv_timer_create(hint_timer_cb, HINT_POLL_PERIOD, this);
+
     _is_paused = false;
 
     newGame();
@@ -298,14 +332,22 @@ bool Game2048::back(void)
 bool Game2048::close(void)
 {
     lv_obj_remove_event_cb(_gesture->getEventObj(), motion_event_cb);
+    flushBestScore();
+
+    setAutoPlay(false);
+    if (_hint_timer != NULL) {
+        lv_timer_del(_hint_timer);
+        _hint_timer = NULL;
+    }
+    // The transposition table is only kept while the game is open
+    game_2048_solver_del(_solver);
+    _solver = NULL;
 
     return true;
 }
 
 bool Game2048::init(void)
 {
-    esp_err_t err = ESP_OK;
-
     ESP_Brookesia_Phone *phone = getPhone();
     ESP_Brookesia_PhoneManager& manager = phone->getManager();
     _gesture = manager.getGesture();
@@ -320,28 +362,24 @@ bool Game2048::init(void)
         return false;
     }
 
-    err = nvs_open(NVS_STORAGE_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) opening NVS handle!", esp_err_to_name(err));
+    if (game_2048_board_init() != GAME_2048_OK) {
+        ESP_LOGE(TAG, "Build tables of the boards failed");
+        return false;
+    }
+
+    settings_store_t *store = settings_store_get_default();
+    if (store == NULL) {
+        ESP_LOGE(TAG, "Settings store is not available");
         return false;
     }
 
     int32_t value = 0;
-    err = nvs_get_i32(nvs_handle, NVS_BEST_SCORE, &value);
-    switch (err) {
-    case ESP_OK:
-        ESP_LOGI(TAG, "Load %s: %d", NVS_BEST_SCORE, value);
-        break;
-    case ESP_ERR_NVS_NOT_FOUND:
-        err = nvs_set_i32(nvs_handle, NVS_BEST_SCORE, value);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Error (%s) setting %s", esp_err_to_name(err), NVS_BEST_SCORE);
-        }
-        ESP_LOGW(TAG, "The value of %s is not initialized yet, set it to default value: %d", NVS_BEST_SCORE, value);
-        break;
-    default:
+    int ret = settings_store_get_i32(store, NVS_BEST_SCORE, &value, 0);
+    if (ret != SETTINGS_STORE_OK) {
+        ESP_LOGE(TAG, "Error (%d) loading %s", ret, NVS_BEST_SCORE);
         return false;
     }
+    ESP_LOGI(TAG, "Load %s: %d", NVS_BEST_SCORE, value);
     best_score = value;
 
     return true;
@@ -350,6 +388,8 @@ bool Game2048::init(void)
 bool Game2048::pause(void)
 {
     _is_paused = true;
+    flushBestScore();
+    setAutoPlay(false);
 
     return true;
 }
@@ -666,9 +706,18 @@ void Game2048::updateBestScore(int score)
 {
     lv_label_set_text_fmt(_best_score_label, "%d", score);
 
-    esp_err_t err = nvs_set_i32(nvs_handle, NVS_BEST_SCORE, score);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) setting %s", esp_err_to_name(err), NVS_BEST_SCORE);
+    // A run of merges raises it several times, the store writes it to NVS once they stop
+    int ret = settings_store_set_i32(settings_store_get_default(), NVS_BEST_SCORE, score);
+    if (ret != SETTINGS_STORE_OK) {
+        ESP_LOGE(TAG, "Error (%d) setting %s", ret, NVS_BEST_SCORE);
+    }
+}
+
+void Game2048::flushBestScore(void)
+{
+    settings_store_t *store = settings_store_get_default();
+    if ((store != NULL) && (settings_store_flush(store) != SETTINGS_STORE_OK)) {
+        ESP_LOGE(TAG, "Flush %s failed", NVS_BEST_SCORE);
     }
 }
 
@@ -711,7 +760,7 @@ int Game2048::moveLeft(void)
                 int cur_j = j;
                 while (cur_j != 0) {
                     if ((_cells_weight[i][cur_j-1].weight == _cells_weight[i][cur_j].weight) &&
-                        (!merge_flag)) {
+                        (!merge_flag) && !is_merged(_cells_weight[i][cur_j-1].y)) {
                         merge_flag = true;
                         for (int k = 0; k < 4; k++) {
                             int target_flag = _cells_weight[i][cur_j].y & (1 << k);
@@ -806,7 +855,7 @@ int Game2048::moveRight(void)
                 int cur_j = j;
                 while (cur_j != 3) {
                     if ((_cells_weight[i][cur_j+1].weight == _cells_weight[i][cur_j].weight) &&
-                        (!merge_flag)) {
+                        (!merge_flag) && !is_merged(_cells_weight[i][cur_j+1].y)) {
                         merge_flag = true;
                         for (int k = 0; k < 4; k++) {
                             int target_flag = _cells_weight[i][cur_j].y & (1 << k);
@@ -901,7 +950,7 @@ int Game2048::moveUp(void)
                 int cur_i = i;
                 while (cur_i != 0) {
                     if ((_cells_weight[cur_i-1][j].weight == _cells_weight[cur_i][j].weight) &&
-                        (!merge_flag)) {
+                        (!merge_flag) && !is_merged(_cells_weight[cur_i-1][j].x)) {
                         merge_flag = true;
                         for (int k = 0; k < 4; k++) {
                             int target_flag = _cells_weight[cur_i][j].x & (1 << k);
@@ -996,7 +1045,7 @@ int Game2048::moveDown(void)
                 int cur_i = i;
                 while (cur_i != 3) {
                     if ((_cells_weight[cur_i+1][j].weight == _cells_weight[cur_i][j].weight) &&
-                        (!merge_flag)) {
+                        (!merge_flag) && !is_merged(_cells_weight[cur_i+1][j].x)) {
                         merge_flag = true;
                         for (int k = 0; k < 4; k++) {
                             int target_flag = _cells_weight[cur_i][j].x & (1 << k);
@@ -1074,19 +1123,104 @@ int Game2048::moveDown(void)
 
 bool Game2048::isGameOver(void)
 {
-    for (int i = 0; i < 4; i++) {
-        for (int j = 1; j < 4; j++) {
-            if ((_cells_weight[i][j].weight == _cells_weight[i][j-1].weight) ||
-                (_cells_weight[j][i].weight == _cells_weight[j-1][i].weight) ||
-                (_cells_weight[i][j].weight == 0)) {
-                    return false;
-            }
+    return !game_2048_board_can_move(getBoard());
+}
+
+game_2048_board_t Game2048::getBoard(void)
+{
+    int exponents[4][4];
+
+    for (int i = 0; i < 16; i++) {
+        exponents[i/4][i%4] = _cells_weight[i/4][i%4].weight;
+    }
+
+    return game_2048_board_pack(exponents);
+}
+
+bool Game2048::handleMove(game_2048_dir_t dir)
+{
+    int score;
+
+    if (anim_running_flag) {
+        return false;
+    }
+
+    switch (dir) {
+        case GAME_2048_DIR_UP:
+            score = moveUp();
+            break;
+        case GAME_2048_DIR_DOWN:
+            score = moveDown();
+            break;
+        case GAME_2048_DIR_LEFT:
+            score = moveLeft();
+            break;
+        case GAME_2048_DIR_RIGHT:
+            score = moveRight();
+            break;
+        default:
+            return false;
+    }
+
+    printf("score: %d\n", score);
+
+    if (score >= 0) {
+        generate_cell_flag = true;
+        showEmojiScore(score);
+        current_score += score;
+        updateCurrentScore(current_score);
+        if (current_score > best_score) {
+            best_score = current_score;
+            updateBestScore(best_score);
         }
     }
+    if (maxWeight() == 2048) {
+        printf("Congratualation! You win!\n");
+        newGame();
+    }
+    if (isGameOver()) {
+        printf("Game Over\n");
+        setAutoPlay(false);
+        showEmojiGameOver();
+    }
 
     return true;
 }
 
+bool Game2048::requestHint(void)
+{
+    if (_solver == NULL) {
+        game_2048_solver_config_t config = GAME_2048_SOLVER_DEFAULT_CONFIG();
+        _solver = game_2048_solver_new(&config);
+        if (_solver == NULL) {
+            ESP_LOGE(TAG, "Create solver failed");
+            return false;
+        }
+    }
+    if (game_2048_solver_request(_solver, getBoard()) != GAME_2048_OK) {
+        return false;
+    }
+    _is_hint_pending = true;
+
+    return true;
+}
+
+void Game2048::setAutoPlay(bool enable)
+{
+    if (enable == _is_auto_play) {
+        return;
+    }
+
+    _is_auto_play = enable;
+    if (_hint_btn_label != NULL) {
+        lv_label_set_text(_hint_btn_label, enable ? "Stop" : "Hint");
+    }
+    if (!enable) {
+        game_2048_solver_cancel(_solver);
+        _is_hint_pending = false;
+    }
+}
+
 void Game2048::new_game_event_cb(lv_event_t *e)
 {
     Game2048 *app= (Game2048 *)lv_event_get_user_data(e);
@@ -1096,7 +1230,7 @@ void Game2048::new_game_event_cb(lv_event_t *e)
 
 void Game2048::motion_event_cb(lv_event_t *e)
 {
-    int score;
+    game_2048_dir_t dir;
     ESP_Brookesia_GestureInfo_t *type = (ESP_Brookesia_GestureInfo_t *)lv_event_get_param(e);
     Game2048 *app= (Game2048 *)lv_event_get_user_data(e);
 
@@ -1104,48 +1238,80 @@ void Game2048::motion_event_cb(lv_event_t *e)
         return;
     }
 
-    if (!anim_running_flag) {
-        switch (type->direction) {
-            case ESP_BROOKESIA_GESTURE_DIR_UP:
-                // printf(NULL, "up");
-                score = app->moveUp();
-                break;
-            case ESP_BROOKESIA_GESTURE_DIR_DOWN:
-                // printf(NULL, "down");
-                score = app->moveDown();
-                break;
-            case ESP_BROOKESIA_GESTURE_DIR_LEFT:
-                // printf(NULL, "left");
-                score = app->moveLeft();
-                break;
-            case ESP_BROOKESIA_GESTURE_DIR_RIGHT:
-                // printf(NULL, "right");
-                score = app->moveRight();
-                break;
-            default:
-                return;
-        }
+    switch (type->direction) {
+        case ESP_BROOKESIA_GESTURE_DIR_UP:
+            dir = GAME_2048_DIR_UP;
+            break;
+        case ESP_BROOKESIA_GESTURE_DIR_DOWN:
+            dir = GAME_2048_DIR_DOWN;
+            break;
+        case ESP_BROOKESIA_GESTURE_DIR_LEFT:
+            dir = GAME_2048_DIR_LEFT;
+            break;
+        case ESP_BROOKESIA_GESTURE_DIR_RIGHT:
+            dir = GAME_2048_DIR_RIGHT;
+            break;
+        default:
+            return;
+    }
 
-        printf("score: %d\n", score);
+    // A swipe takes the game back from the solver
+    app->setAutoPlay(false);
+    app->handleMove(dir);
+}
 
-        if (score >= 0) {
-            generate_cell_flag = true;
-            app->showEmojiScore(score);
-            app->current_score += score;
-            app->updateCurrentScore(app->current_score);
-            if (app->current_score > app->best_score) {
-                app->best_score = app->current_score;
-                app->updateBestScore(app->best_score);
-            }
-        }
-        if (app->maxWeight() == 2048) {
-            printf("Congratualation! You win!\n");
-            app->newGame();
-        }
-        if (app->isGameOver()) {
-            printf("Game Over\n");
-            app->showEmojiGameOver();
+void Game2048::hint_event_cb(lv_event_t *e)
+{
+    Game2048 *app= (Game2048 *)lv_event_get_user_data(e);
+
+    if (app->_is_auto_play) {
+        app->setAutoPlay(false);
+        return;
+    }
+    if (lv_event_get_code(e) == LV_EVENT_LONG_PRESSED) {
+        app->setAutoPlay(true);
+        return;
+    }
+    if (app->requestHint()) {
+        lv_label_set_text(app->_emoji_label, "Thinking...");
+    }
+}
+
+void Game2048::hint_timer_cb(lv_timer_t *timer)
+{
+    Game2048 *app= (Game2048 *)timer->user_data;
+    game_2048_hint_t hint;
+
+    // The board is only read once the tiles have stopped and the new one is added
+    if (app->_is_paused || anim_running_flag) {
+        return;
+    }
+    if (!app->_is_hint_pending) {
+        if (app->_is_auto_play) {
+            app->requestHint();
         }
+        return;
+    }
+    if (!game_2048_solver_get_hint(app->_solver, &hint)) {
+        return;
+    }
+    app->_is_hint_pending = false;
+
+    // The board may have been swiped or restarted since the request
+    if (hint.board != app->getBoard()) {
+        return;
+    }
+    if (hint.dir == GAME_2048_DIR_NONE) {
+        app->setAutoPlay(false);
+        return;
+    }
+    ESP_LOGD(TAG, "Hint %s: depth %d, %d nodes, %d hits, %d ms", hint_dir_names[hint.dir], hint.depth,
+             (int)hint.node_num, (int)hint.tt_hit_num, (int)hint.time_ms);
+
+    if (app->_is_auto_play) {
+        app->handleMove(hint.dir);
+    } else {
+        lv_label_set_text_fmt(app->_emoji_label, "Hint: swipe %s", hint_dir_names[hint.dir]);
     }
 }
 
@@ -1,9 +1,9 @@
 #pragma once
 
-#include "nvs.h"
 #include "lvgl.h"
 #include "bsp_board_extra.h"
 #include "esp_brookesia.hpp"
+#include "game_2048_solver.h"
 
 typedef struct {
 	// Index of row
@@ -43,6 +43,7 @@ public:
     void updateCellValue(void);
     void updateCurrentScore(int score);
     void updateBestScore(int score);
+    void flushBestScore(void);
     void updateCellsStyle(void);
     int maxWeight(void);
     int moveLeft(void);
@@ -50,6 +51,10 @@ public:
     int moveUp(void);
     int moveDown(void);
     bool isGameOver(void);
+    game_2048_board_t getBoard(void);
+    bool handleMove(game_2048_dir_t dir);
+    bool requestHint(void);
+    void setAutoPlay(bool enable);
 
 private:
     lv_obj_t *addBackgroundCell(lv_obj_t *parent);
@@ -59,6 +64,8 @@ private:
     static void new_game_event_cb(lv_event_t *e);
     static void motion_event_cb(lv_event_t *e);
     static void anim_finish_cb(struct _lv_anim_t *a);
+    static void hint_event_cb(lv_event_t *e);
+    static void hint_timer_cb(lv_timer_t *timer);
 
     bool _is_paused;
     uint16_t _height;
@@ -66,7 +73,6 @@ private:
     uint16_t current_score;
     uint16_t best_score;
     uint16_t _weight_max;
-    nvs_handle_t nvs_handle;
     file_iterator_instance_t *_file_iterator;
     cell_weight_t _cells_weight[4][4];
     lv_obj_t *_cur_score_label, *_best_score_label;
@@ -78,4 +84,9 @@ private:
     lv_obj_t *_foreground_grid;
     lv_color_t  _cell_colors[11];
     const ESP_Brookesia_Gesture *_gesture;
+    game_2048_solver_t *_solver;
+    lv_timer_t *_hint_timer;
+    lv_obj_t *_hint_btn_label;
+    bool _is_hint_pending;
+    bool _is_auto_play;
 };
@@ -8,12 +8,15 @@
 #include "sdkconfig.h"
 #include "bsp/esp-bsp.h"
 #include "bsp_board_extra.h"
+#include "audio_spectrum.h"
 
 #include "gui_music/lv_demo_music.h"
 #include "gui_music/lv_demo_music_main.h"
 #include "MusicPlayer.hpp"
 
 #define MUSIC_DIR   BSP_SPIFFS_MOUNT_POINT "/music"
+/* The bars fall from the top in about half a second */
+#define SPECTRUM_RELEASE    (4)
 
 using namespace std;
 
@@ -33,6 +36,14 @@ MusicPlayer::~MusicPlayer()
 
 bool MusicPlayer::run(void)
 {
+    audio_spectrum_config_t spectrum_config = AUDIO_SPECTRUM_DEFAULT_CONFIG();
+    spectrum_config.dsp.release = SPECTRUM_RELEASE;
+    if (audio_spectrum_start(&spectrum_config) == ESP_OK) {
+        bsp_extra_i2s_write_tap_register(audio_spectrum_feed, NULL);
+    } else {
+        ESP_LOGE(TAG, "Start spectrum analyzer failed, the bars won't move");
+    }
+
     lv_demo_music(lv_scr_act(), _file_iterator);
 
     return true;
@@ -54,6 +65,9 @@ bool MusicPlayer::back(void)
 
 bool MusicPlayer::close(void)
 {
+    bsp_extra_i2s_write_tap_register(NULL, NULL);
+    audio_spectrum_stop();
+
     if (audio_player_pause() != ESP_OK) {
         ESP_LOGE(TAG, "audio_player_pause failed");
         return false;
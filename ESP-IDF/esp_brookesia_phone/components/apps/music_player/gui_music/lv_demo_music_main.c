@@ -18,6 +18,7 @@
 #include "esp_log.h"
 #include "bsp_board_extra.h"
 #include "audio_player.h"
+#include "audio_spectrum.h"
 
 /*********************
  *      DEFINES
@@ -96,8 +97,10 @@ static bool playing;
 static bool start_anim;
 static lv_coord_t start_anim_values[40];
 static lv_obj_t * play_obj;
+/*The canned spectrum only sets the length of the animation, the bars show the levels of the played audio*/
 static const uint16_t (* spectrum)[4];
 static uint32_t spectrum_len;
+static uint16_t spectrum_levels[BAND_CNT];
 static const uint16_t rnd_array[30] = {994, 285, 553, 11, 792, 707, 966, 641, 852, 827, 44, 352, 146, 581, 490, 80, 729, 58, 695, 940, 724, 561, 124, 653, 27, 292, 557, 506, 382, 199};
 
 static file_iterator_instance_t *file_iterator;
@@ -400,6 +403,7 @@ void _lv_demo_music_pause(void)
     pause = true;
     spectrum_i_pause = spectrum_i;
     spectrum_i = 0;
+    lv_memset_00(spectrum_levels, sizeof(spectrum_levels));
     lv_anim_del(spectrum_obj, spectrum_anim_cb);
     lv_obj_invalidate(spectrum_obj);
     lv_img_set_zoom(album_img_obj, LV_IMG_ZOOM_NONE);
@@ -866,7 +870,7 @@ static void spectrum_draw_event_cb(lv_event_t * e)
 
             /* Add "side bars" with cosine characteristic.*/
             for(f = 0; f < band_w; f++) {
-                uint32_t ampl_main = spectrum[spectrum_i][s];
+                uint32_t ampl_main = spectrum_levels[s];
                 int32_t ampl_mod = get_cos(f * 360 / band_w + 180, 180) + 180;
                 int32_t t = BAR_PER_BAND_CNT * s - band_w / 2 + f;
                 if(t < 0) t = BAR_CNT + t;
@@ -937,12 +941,16 @@ static void spectrum_anim_cb(void * a, int32_t v)
     }
 
     spectrum_i = v;
+    /*Called once per frame, so the bars are updated at the display rate*/
+    audio_spectrum_get_levels(spectrum_levels, BAND_CNT);
     lv_obj_invalidate(obj);
 
+    /*The bass band goes up to 64, the canned one went up to about 30*/
+    uint32_t bass = spectrum_levels[0] / 2;
     static uint32_t bass_cnt = 0;
     static int32_t last_bass = -1000;
     static int32_t dir = 1;
-    if(spectrum[spectrum_i][0] > 12) {
+    if(bass > 12) {
         if(spectrum_i - last_bass > 5) {
             bass_cnt++;
             last_bass = spectrum_i;
@@ -953,9 +961,9 @@ static void spectrum_anim_cb(void * a, int32_t v)
             }
         }
     }
-    if(spectrum[spectrum_i][0] < 4) bar_rot += dir;
+    if(bass < 4) bar_rot += dir;
 
-    lv_img_set_zoom(album_img_obj, LV_IMG_ZOOM_NONE + spectrum[spectrum_i][0]);
+    lv_img_set_zoom(album_img_obj, LV_IMG_ZOOM_NONE + bass);
 }
 
 static void start_anim_cb(void * a, int32_t v)
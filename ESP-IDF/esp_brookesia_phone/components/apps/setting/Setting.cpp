@@ -15,7 +15,7 @@
 #include "esp_mac.h"
 #include "bsp/esp-bsp.h"
 #include "bsp_board_extra.h"
-#include "nvs.h"
+#include "settings_store_nvs.h"
 
 
 #include "ui/ui.h"
@@ -32,6 +32,12 @@ static bool example_adc_calibration_init(adc_unit_t unit, adc_channel_t channel,
 #define HOME_REFRESH_TASK_PRIORITY      (1)
 #define HOME_REFRESH_TASK_PERIOD_MS     (2000)
 
+// Keys of the UI queue, only the latest value of each key is shown
+#define UI_QUEUE_KEY_CLOCK              (1)
+#define UI_QUEUE_KEY_WIFI_ICON          (2)
+#define UI_QUEUE_KEY_MEMORY             (3)
+#define UI_QUEUE_KEY_BATTERY            (4)
+
 #define WIFI_SCAN_TASK_STACK_SIZE       (1024 * 6)
 #define WIFI_SCAN_TASK_PRIORITY         (1)
 #define WIFI_SCAN_TASK_PERIOD_MS        (5 * 1000)
@@ -49,7 +55,6 @@ static bool example_adc_calibration_init(adc_unit_t unit, adc_channel_t channel,
 #define SPEAKER_VOLUME_MIN              (0)
 #define SPEAKER_VOLUME_MAX              (100)
 
-#define NVS_STORAGE_NAMESPACE           "storage"
 #define NVS_KEY_WIFI_ENABLE             "wifi_en"
 #define NVS_KEY_BLE_ENABLE              "ble_en"
 #define NVS_KEY_AUDIO_VOLUME            "volume"
@@ -125,7 +130,8 @@ AppSettings::AppSettings():
     _is_ui_resumed(false),
     _is_ui_del(true),
     _screen_index(UI_MAIN_SETTING_INDEX),
-    _screen_list({nullptr})
+    _screen_list({nullptr}),
+    ui_queue(nullptr)
 {
 }
 
@@ -172,6 +178,7 @@ bool AppSettings::back(void)
             vTaskDelay(pdMS_TO_TICKS(100));
             stopWifiScan();
         } 
+        flushNvsParam();
         notifyCoreClosed();
     }
 
@@ -187,6 +194,7 @@ bool AppSettings::close(void)
     } 
     
     _is_ui_del = true;
+    flushNvsParam();
     
     return true;
 }
@@ -197,6 +205,7 @@ bool AppSettings::init(void)
     ESP_Brookesia_PhoneHome& home = phone->getHome();
     status_bar = home.getStatusBar();
     backstage = home.getRecentsScreen();
+    ui_queue = phone->getCoreUiQueue();
 
      i2c_master_get_bus_handle(1,&RX8028_handle);
 
@@ -266,6 +275,7 @@ bool AppSettings::init(void)
 bool AppSettings::pause(void)
 {
     _is_ui_resumed = true;
+    flushNvsParam();
 
     return true;
 }
@@ -445,68 +455,45 @@ void AppSettings::processWifiConnect(WifiConnectState_t state)
 
 bool AppSettings::loadNvsParam(void)
 {
-    esp_err_t err = ESP_OK;
-    nvs_handle_t nvs_handle;
-    err = nvs_open(NVS_STORAGE_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) opening NVS handle!", esp_err_to_name(err));
-        return false;
-    }
+    settings_store_t *store = settings_store_get_default();
+    ESP_RETURN_ON_FALSE(store != NULL, false, TAG, "Settings store is not available");
 
+    // The missing values keep the default ones, they are written once they change
     for (auto& key_value : _nvs_param_map) {
-        err = nvs_get_i32(nvs_handle, key_value.first.c_str(), &key_value.second);
-        switch (err) {
-        case ESP_OK:
-            ESP_LOGI(TAG, "Load %s: %d", key_value.first.c_str(), key_value.second);
-            break;
-        case ESP_ERR_NVS_NOT_FOUND:
-            err = nvs_set_i32(nvs_handle, key_value.first.c_str(), key_value.second);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Error (%s) setting %s", esp_err_to_name(err), key_value.first.c_str());
-            }
-            ESP_LOGW(TAG, "The value of %s is not initialized yet, set it to default value: %d", key_value.first.c_str(),
-                     key_value.second);
-            break;
-        default:
-            break;
+        int ret = settings_store_get_i32(store, key_value.first.c_str(), &key_value.second, key_value.second);
+        if (ret != SETTINGS_STORE_OK) {
+            ESP_LOGE(TAG, "Error (%d) loading %s", ret, key_value.first.c_str());
+            continue;
         }
+        ESP_LOGI(TAG, "Load %s: %d", key_value.first.c_str(), key_value.second);
     }
 
-    err = nvs_commit(nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) committing NVS changes", esp_err_to_name(err));
-        return false;
-    }
-    nvs_close(nvs_handle);
-
     return true;
 }
 
 bool AppSettings::setNvsParam(std::string key, int value)
 {
-    esp_err_t err = ESP_OK;
-    nvs_handle_t nvs_handle;
-    err = nvs_open(NVS_STORAGE_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) opening NVS handle!", esp_err_to_name(err));
-        return false;
-    }
+    settings_store_t *store = settings_store_get_default();
+    ESP_RETURN_ON_FALSE(store != NULL, false, TAG, "Settings store is not available");
 
-    err = nvs_set_i32(nvs_handle, key.c_str(), value);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) setting %s", esp_err_to_name(err), key.c_str());
-    }
-
-    err = nvs_commit(nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error (%s) committing NVS changes", esp_err_to_name(err));
+    // Only the cache is updated here, the store writes the value to NVS once the slider stops
+    int ret = settings_store_set_i32(store, key.c_str(), value);
+    if (ret != SETTINGS_STORE_OK) {
+        ESP_LOGE(TAG, "Error (%d) setting %s", ret, key.c_str());
         return false;
     }
-    nvs_close(nvs_handle);
 
     return true;
 }
 
+void AppSettings::flushNvsParam(void)
+{
+    settings_store_t *store = settings_store_get_default();
+    if ((store != NULL) && (settings_store_flush(store) != SETTINGS_STORE_OK)) {
+        ESP_LOGE(TAG, "Flush settings failed");
+    }
+}
+
 void AppSettings::updateUiByNvsParam(void)
 {
     if (_nvs_param_map[NVS_KEY_WIFI_ENABLE]) {
@@ -675,6 +662,8 @@ void AppSettings::euiRefresTask(void *arg)
     uint16_t total_sram_size_kb = 0;
     uint16_t free_psram_size_kb = 0;
     uint16_t total_psram_size_kb = 0;
+    int clock_data[3] = {0};
+    uint16_t memory_data[4] = {0};
 
     uint8_t data_add[1] = {0x01};
     uint8_t data_time[4];
@@ -695,11 +684,12 @@ void AppSettings::euiRefresTask(void *arg)
         //  is_time_pm = (timeinfo.tm_hour >= 12);
         is_time_pm = (app->time_rx[1] >= 12);
 
-        bsp_display_lock(0);
-        if(!app->status_bar->setClock(app->time_rx[1], app->time_rx[0], is_time_pm)) {
-            ESP_LOGE(TAG, "Set clock failed");
+        clock_data[0] = app->time_rx[1];
+        clock_data[1] = app->time_rx[0];
+        clock_data[2] = is_time_pm;
+        if(!app->ui_queue->push(onUiQueueClockUpdate, app, clock_data, UI_QUEUE_KEY_CLOCK)) {
+            ESP_LOGE(TAG, "Push clock failed");
         }
-        bsp_display_unlock();
 
         // Update WiFi icon state
         if((xEventGroupGetBits(s_wifi_event_group) & WIFI_EVENT_CONNECTED)) {
@@ -714,17 +704,10 @@ void AppSettings::euiRefresTask(void *arg)
 
             i2c_master_transmit(app->RX8028_dev,data_time,4,100);
 
-            bsp_display_lock(0);
-            if(app->_wifi_signal_strength_level == WIFI_SIGNAL_STRENGTH_NONE) {
-                app->status_bar->setWifiIconState(0);
-            } else if(app->_wifi_signal_strength_level == WIFI_SIGNAL_STRENGTH_WEAK) {
-                app->status_bar->setWifiIconState(1);
-            } else if(app->_wifi_signal_strength_level == WIFI_SIGNAL_STRENGTH_MODERATE) {
-                app->status_bar->setWifiIconState(2);
-            } else if (app->_wifi_signal_strength_level == WIFI_SIGNAL_STRENGTH_GOOD) {
-                app->status_bar->setWifiIconState(3);
+            if(!app->ui_queue->push(onUiQueueWifiIconUpdate, app, app->_wifi_signal_strength_level,
+                                    UI_QUEUE_KEY_WIFI_ICON)) {
+                ESP_LOGE(TAG, "Push WiFi icon failed");
             }
-            bsp_display_unlock();
         }
 
         /* Updte Smart Gadget app */
@@ -740,11 +723,13 @@ void AppSettings::euiRefresTask(void *arg)
                         "free psram size: %d KB, total psram size: %d KB",
                         free_sram_size_kb, total_sram_size_kb, free_psram_size_kb, total_psram_size_kb);
 
-            bsp_display_lock(0);
-            if(!app->backstage->setMemoryLabel(free_sram_size_kb, total_sram_size_kb, free_psram_size_kb, total_psram_size_kb)) {
-                ESP_LOGE(TAG, "Update memory usage failed");
+            memory_data[0] = free_sram_size_kb;
+            memory_data[1] = total_sram_size_kb;
+            memory_data[2] = free_psram_size_kb;
+            memory_data[3] = total_psram_size_kb;
+            if(!app->ui_queue->push(onUiQueueMemoryUpdate, app, memory_data, UI_QUEUE_KEY_MEMORY)) {
+                ESP_LOGE(TAG, "Push memory usage failed");
             }
-            bsp_display_unlock();
         }
 
         vTaskDelay(pdMS_TO_TICKS(HOME_REFRESH_TASK_PERIOD_MS));
@@ -759,6 +744,7 @@ err:
  void AppSettings::euiBatteryTask(void *arg)
  {
     AppSettings *app = (AppSettings *)arg;
+    int battery_data[2] = {0};
 
     while(1)
     {
@@ -770,11 +756,11 @@ err:
         // printf("Battery capacity: %.1f%%\n", capacity);
          
  
-         bsp_display_lock(0);
-
-         if(!app->status_bar->setBatteryPercent(app->charge_flag,capacity))
+         battery_data[0] = app->charge_flag;
+         battery_data[1] = capacity;
+         if(!app->ui_queue->push(onUiQueueBatteryUpdate, app, battery_data, UI_QUEUE_KEY_BATTERY))
          {
-             ESP_LOGE(TAG,"Set battery failed");
+             ESP_LOGE(TAG,"Push battery failed");
          }
         //  if(app->charge_flag)
         //  {
@@ -784,7 +770,6 @@ err:
         //  {
         //     app->status_bar->showBatteryPercent();
         //  }
-         bsp_display_unlock();
 
          vTaskDelay(pdMS_TO_TICKS(5000));
     }
@@ -793,6 +778,52 @@ err:
  }
 
 
+void AppSettings::onUiQueueClockUpdate(void *user_data, const void *data)
+{
+    AppSettings *app = (AppSettings *)user_data;
+    const int *clock_data = (const int *)data;
+
+    if(!app->status_bar->setClock(clock_data[0], clock_data[1], clock_data[2])) {
+        ESP_LOGE(TAG, "Set clock failed");
+    }
+}
+
+void AppSettings::onUiQueueWifiIconUpdate(void *user_data, const void *data)
+{
+    AppSettings *app = (AppSettings *)user_data;
+    WifiSignalStrengthLevel_t level = *(const WifiSignalStrengthLevel_t *)data;
+
+    if(level == WIFI_SIGNAL_STRENGTH_NONE) {
+        app->status_bar->setWifiIconState(0);
+    } else if(level == WIFI_SIGNAL_STRENGTH_WEAK) {
+        app->status_bar->setWifiIconState(1);
+    } else if(level == WIFI_SIGNAL_STRENGTH_MODERATE) {
+        app->status_bar->setWifiIconState(2);
+    } else if (level == WIFI_SIGNAL_STRENGTH_GOOD) {
+        app->status_bar->setWifiIconState(3);
+    }
+}
+
+void AppSettings::onUiQueueMemoryUpdate(void *user_data, const void *data)
+{
+    AppSettings *app = (AppSettings *)user_data;
+    const uint16_t *memory_data = (const uint16_t *)data;
+
+    if(!app->backstage->setMemoryLabel(memory_data[0], memory_data[1], memory_data[2], memory_data[3])) {
+        ESP_LOGE(TAG, "Update memory usage failed");
+    }
+}
+
+void AppSettings::onUiQueueBatteryUpdate(void *user_data, const void *data)
+{
+    AppSettings *app = (AppSettings *)user_data;
+    const int *battery_data = (const int *)data;
+
+    if(!app->status_bar->setBatteryPercent(battery_data[0], battery_data[1])) {
+        ESP_LOGE(TAG,"Set battery failed");
+    }
+}
+
 void AppSettings::wifiScanTask(void *arg)
 {
     AppSettings *app = (AppSettings *)arg;
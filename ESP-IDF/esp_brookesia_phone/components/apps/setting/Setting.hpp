@@ -67,6 +67,7 @@ private:
     // NVS Parameters
     bool loadNvsParam(void);
     bool setNvsParam(std::string key, int value);
+    void flushNvsParam(void);
     void updateUiByNvsParam(void);
     // WiFi
     esp_err_t initWifi(void);
@@ -85,6 +86,13 @@ private:
     static void wifiScanTask(void *arg);
     static void wifiConnectTask(void *arg);
 
+    /* UI Queue Handler */
+    // Called in the LVGL task with the values pushed by the tasks
+    static void onUiQueueClockUpdate(void *user_data, const void *data);
+    static void onUiQueueWifiIconUpdate(void *user_data, const void *data);
+    static void onUiQueueMemoryUpdate(void *user_data, const void *data);
+    static void onUiQueueBatteryUpdate(void *user_data, const void *data);
+
     /* Event Handler */
     // WiFi
     static void wifiEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
@@ -116,6 +124,7 @@ private:
     std::map<std::string, int32_t> _nvs_param_map;
     const ESP_Brookesia_StatusBar *status_bar; 
     const ESP_Brookesia_RecentsScreen *backstage;
+    ESP_Brookesia_CoreUiQueue *ui_queue;
 
     bool do_calibration2;
     bool charge_flag;
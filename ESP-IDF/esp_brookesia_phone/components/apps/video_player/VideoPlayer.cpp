@@ -170,6 +170,8 @@ bool AppVideoPlayer::init(void)
     ESP_LOGI(TAG,"avi player init success");
 
     semph_event = xSemaphoreCreateBinary();
+    semph_frame_free = xSemaphoreCreateBinary();
+    xSemaphoreGive(semph_frame_free);
 
     jpeg_decode_engine_cfg_t decode_eng_cfg = {
         .timeout_ms = 40,
@@ -213,6 +215,15 @@ void AppVideoPlayer::video_write(frame_data_t *data, void *arg)
             return;
         }
        
+        // Don't decode into the buffer on the screen, wait until the UI queue has shown the last frame
+        while(xSemaphoreTake(app->semph_frame_free, pdMS_TO_TICKS(100)) != pdTRUE)
+        {
+            if(!app->playing)
+            {
+                return;
+            }
+        }
+
         if(app->index == 0)
         {
             app->index = 1;
@@ -228,17 +239,32 @@ void AppVideoPlayer::video_write(frame_data_t *data, void *arg)
         
         if(ret != ESP_OK)
         {
+            xSemaphoreGive(app->semph_frame_free);
             return;
         }
 
-        bsp_display_lock(0);
-        lv_canvas_set_buffer(app->video_canvas,app->jpeg_data_buffer[app->index],1024,600,LV_IMG_CF_TRUE_COLOR);
-        bsp_display_unlock();
+        if(!app->getCore()->getCoreUiQueue()->push(onUiQueueFrameUpdate, app, app->index))
+        {
+            xSemaphoreGive(app->semph_frame_free);
+        }
     }
     
     return;
 }
 
+void AppVideoPlayer::onUiQueueFrameUpdate(void *user_data, const void *data)
+{
+    AppVideoPlayer *app = (AppVideoPlayer *)user_data;
+    int index = *(const int *)data;
+
+    // The buffers are freed when the app is closed
+    if(app->playing && lv_obj_is_valid(app->video_canvas))
+    {
+        lv_canvas_set_buffer(app->video_canvas,app->jpeg_data_buffer[index],1024,600,LV_IMG_CF_TRUE_COLOR);
+    }
+    xSemaphoreGive(app->semph_frame_free);
+}
+
 void AppVideoPlayer::avi_play_end(void *arg)
 {
     AppVideoPlayer *app = (AppVideoPlayer *)arg;
@@ -36,6 +36,7 @@ public:
 
     static void play_avi_task(void *arg);
     static void mjpeg_decode_task(void *arg);
+    static void onUiQueueFrameUpdate(void *user_data, const void *data);
 
 private:
     typedef struct {
@@ -60,4 +61,6 @@ private:
     jpeg_decoder_handle_t avi_jpgd_handle;
     uint8_t *jpeg_data_buffer[2];
     size_t jpeg_buf_size[2];
+    // Taken while a decoded frame is waiting for the UI queue to show it
+    SemaphoreHandle_t semph_frame_free;
 };
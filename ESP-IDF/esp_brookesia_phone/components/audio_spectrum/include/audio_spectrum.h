@@ -0,0 +1,120 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "audio_spectrum_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Spectrum analyzer of the played audio.
+ *
+ * The PCM written to the codec is fed by `audio_spectrum_feed()`, which only mixes it down into a lock-free ring.
+ * A task analyzes the latest `fft_size` samples `rate_hz` times per second, so its cost doesn't depend on the
+ * sample rate or on how the audio is written, and publishes the levels of the bands. The UI reads them by
+ * `audio_spectrum_get_levels()` when it draws a frame.
+ */
+
+typedef struct {
+    audio_spectrum_dsp_config_t dsp;    /*!< Configuration of the analysis, `sample_rate` follows the fed audio */
+    uint32_t ring_size;                 /*!< Number of mono samples of the ring, power of 2, at least `fft_size` */
+    uint8_t rate_hz;                    /*!< Analyses per second */
+    UBaseType_t task_priority;
+    BaseType_t task_core_id;            /*!< Core of the task, or `tskNO_AFFINITY` */
+    uint32_t task_stack_size;
+} audio_spectrum_config_t;
+
+#define AUDIO_SPECTRUM_DEFAULT_CONFIG()                 \
+    {                                                   \
+        .dsp = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG(),     \
+        .ring_size = 4096,                              \
+        .rate_hz = 30,                                  \
+        .task_priority = 2,                             \
+        .task_core_id = tskNO_AFFINITY,                 \
+        .task_stack_size = 3 * 1024,                    \
+    }
+
+typedef struct {
+    uint32_t analysis_num;      /*!< Number of analyzed blocks */
+    uint32_t analysis_us_last;  /*!< Time of the last analysis */
+    uint32_t analysis_us_avg;   /*!< Average time of an analysis */
+    uint32_t analysis_us_max;   /*!< Longest analysis */
+    uint32_t load_permille;     /*!< Time of the analyses over the run time of the analyzer, 1/1000 */
+    uint32_t dropped_samples;   /*!< Samples which didn't fit in the ring */
+} audio_spectrum_stats_t;
+
+/**
+ * @brief Start the analyzer task.
+ *
+ * @param config The configuration, NULL for `AUDIO_SPECTRUM_DEFAULT_CONFIG()`
+ *
+ * @return
+ *    - ESP_OK: Success
+ *    - ESP_ERR_INVALID_STATE: Already started
+ *    - ESP_ERR_INVALID_ARG: Invalid configuration
+ *    - ESP_ERR_NO_MEM: Out of memory
+ */
+esp_err_t audio_spectrum_start(const audio_spectrum_config_t *config);
+
+/**
+ * @brief Stop the analyzer task and wait for it.
+ *
+ * It also waits for a running `audio_spectrum_feed()`, so the tap doesn't need to be unregistered first.
+ *
+ * @return
+ *    - ESP_OK: Success
+ *    - ESP_ERR_INVALID_STATE: Not started
+ */
+esp_err_t audio_spectrum_stop(void);
+
+/**
+ * @brief Feed the played PCM. It never blocks and does nothing if the analyzer isn't started.
+ *
+ * The signature matches `bsp_extra_i2s_write_tap_t`.
+ *
+ * @param pcm Interleaved PCM
+ * @param len Length of `pcm` in bytes
+ * @param sample_rate Sample rate, Hz
+ * @param bits Bits per sample: 16, 24 or 32
+ * @param channels Number of channels
+ * @param user_data Not used
+ */
+void audio_spectrum_feed(const void *pcm, size_t len, uint32_t sample_rate, uint8_t bits, uint8_t channels,
+                         void *user_data);
+
+/**
+ * @brief Get the latest levels of the bands.
+ *
+ * @param levels Buffer of `band_num` levels
+ * @param band_num Number of levels to get, at most `band_num` of the configuration
+ *
+ * @return
+ *    - true: The levels are from the analyzer
+ *    - false: The analyzer isn't started, the levels are 0
+ */
+bool audio_spectrum_get_levels(uint16_t *levels, uint8_t band_num);
+
+/**
+ * @brief Get the statistics of the analyzer since it was started.
+ *
+ * @param stats The statistics
+ *
+ * @return
+ *    - ESP_OK: Success
+ *    - ESP_ERR_INVALID_ARG: `stats` is NULL
+ */
+esp_err_t audio_spectrum_get_stats(audio_spectrum_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,134 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The DSP core of the spectrum analyzer. It only uses standard C, so it's built and tested on the host too
+ * (see `test_apps/host_test`).
+ *
+ * A block of mono 16-bit samples is windowed (Hann), transformed by a fixed-point real FFT and the power of the
+ * bins is summed into logarithmically spaced bands. The energy of each band is converted to dBFS and mapped to a
+ * level between `0` (`floor_db`) and `level_max` (`floor_db + range_db`).
+ */
+
+#define AUDIO_SPECTRUM_FFT_SIZE_MIN     (64)
+#define AUDIO_SPECTRUM_FFT_SIZE_MAX     (4096)
+#define AUDIO_SPECTRUM_BAND_NUM_MAX     (32)
+
+typedef struct {
+    uint32_t sample_rate;   /*!< Sample rate of the analyzed samples, Hz */
+    uint16_t fft_size;      /*!< Number of samples of a block, power of 2 in [AUDIO_SPECTRUM_FFT_SIZE_MIN, AUDIO_SPECTRUM_FFT_SIZE_MAX] */
+    uint8_t band_num;       /*!< Number of bands, at most AUDIO_SPECTRUM_BAND_NUM_MAX */
+    uint16_t freq_min;      /*!< Lower edge of the first band, Hz */
+    uint16_t freq_max;      /*!< Upper edge of the last band, Hz. It's limited to the half of the sample rate */
+    int8_t floor_db;        /*!< Band energy mapped to level 0, dBFS */
+    uint8_t range_db;       /*!< Band energy mapped to `level_max` is `floor_db + range_db`, dBFS */
+    uint16_t level_max;     /*!< Level of the loudest band */
+    uint16_t release;       /*!< A level falls at most this much per block, 0 to follow the signal immediately */
+} audio_spectrum_dsp_config_t;
+
+#define AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG() \
+    {                                       \
+        .sample_rate = 44100,               \
+        .fft_size = 1024,                   \
+        .band_num = 4,                      \
+        .freq_min = 40,                     \
+        .freq_max = 16000,                  \
+        .floor_db = -60,                    \
+        .range_db = 60,                     \
+        .level_max = 64,                    \
+        .release = 0,                       \
+    }
+
+typedef struct audio_spectrum_dsp_t audio_spectrum_dsp_t;
+
+/**
+ * @brief Create a DSP instance, all the tables and the work buffers are allocated here.
+ *
+ * @param config The configuration, it's copied
+ *
+ * @return
+ *    - The new instance
+ *    - NULL: The configuration is invalid or out of memory
+ */
+audio_spectrum_dsp_t *audio_spectrum_dsp_new(const audio_spectrum_dsp_config_t *config);
+
+/**
+ * @brief Delete a DSP instance.
+ *
+ * @param dsp The instance, can be NULL
+ */
+void audio_spectrum_dsp_del(audio_spectrum_dsp_t *dsp);
+
+/**
+ * @brief Get the configuration of a DSP instance.
+ *
+ * @param dsp The instance
+ *
+ * @return The configuration
+ */
+const audio_spectrum_dsp_config_t *audio_spectrum_dsp_get_config(const audio_spectrum_dsp_t *dsp);
+
+/**
+ * @brief Get the bins of a band.
+ *
+ * Bin `k` is the frequency `k * sample_rate / fft_size`. The bands are adjacent and each of them has at least
+ * one bin, so the lowest bands can be wider than their logarithmic share.
+ *
+ * @param dsp The instance
+ * @param band Index of the band
+ * @param bin_start The first bin of the band
+ * @param bin_end The bin after the last one of the band
+ */
+void audio_spectrum_dsp_get_band_bins(const audio_spectrum_dsp_t *dsp, uint8_t band, uint16_t *bin_start,
+                                      uint16_t *bin_end);
+
+/**
+ * @brief Compute the power spectrum of a block.
+ *
+ * The block is normalized before the FFT, the returned shift tells how much: the power of the full-scale
+ * input is `power[k] << (2 * shift)`. A full-scale sine at the center of bin `k` gives `power[k]` of about
+ * `(32767 / 8)^2` with `shift` 0.
+ *
+ * @param dsp The instance
+ * @param samples `fft_size` samples
+ * @param power `fft_size / 2 + 1` bins, from DC to the half of the sample rate
+ *
+ * @return The normalization shift of the block, between 0 and 13
+ */
+uint8_t audio_spectrum_dsp_power(audio_spectrum_dsp_t *dsp, const int16_t *samples, uint32_t *power);
+
+/**
+ * @brief Analyze a block and update the levels of the bands.
+ *
+ * @param dsp The instance
+ * @param samples `fft_size` samples, or NULL for silence (the levels only fall by `release`)
+ * @param levels `band_num` levels, they are also used as the previous levels for `release`
+ */
+void audio_spectrum_dsp_process(audio_spectrum_dsp_t *dsp, const int16_t *samples, uint16_t *levels);
+
+/**
+ * @brief Convert an energy to dBFS.
+ *
+ * @param energy Energy of a band as the sum of `power` of `audio_spectrum_dsp_power()`
+ * @param shift The normalization shift returned by `audio_spectrum_dsp_power()`
+ *
+ * @return dBFS in 1/256 dB, a full-scale sine gives about 0. It's INT32_MIN if the energy is 0
+ */
+int32_t audio_spectrum_dsp_energy_to_db(uint64_t energy, uint8_t shift);
+
+#ifdef __cplusplus
+}
+#endif
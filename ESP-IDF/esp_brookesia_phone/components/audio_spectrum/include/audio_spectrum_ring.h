@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lock-free ring of mono 16-bit samples between one writer (the audio task) and one reader (the analyzer task).
+ * The writer never waits: the samples which don't fit are dropped and counted.
+ */
+typedef struct {
+    int16_t *buf;
+    uint32_t size;              /*!< Number of samples, power of 2 */
+    atomic_uint head;           /*!< Written by the writer only */
+    atomic_uint tail;           /*!< Written by the reader only */
+    atomic_uint dropped;        /*!< Number of samples which didn't fit */
+} audio_spectrum_ring_t;
+
+/**
+ * @brief Initialize a ring on a buffer.
+ *
+ * @param ring The ring
+ * @param buf Buffer of `size` samples
+ * @param size Number of samples, power of 2
+ *
+ * @return
+ *    - 0: Success
+ *    - -1: `size` isn't a power of 2
+ */
+int audio_spectrum_ring_init(audio_spectrum_ring_t *ring, int16_t *buf, uint32_t size);
+
+/**
+ * @brief Drop all the samples of the ring. Only the reader can call it.
+ *
+ * @param ring The ring
+ */
+void audio_spectrum_ring_flush(audio_spectrum_ring_t *ring);
+
+/**
+ * @brief Number of samples which can be read.
+ *
+ * @param ring The ring
+ *
+ * @return Number of samples
+ */
+uint32_t audio_spectrum_ring_available(audio_spectrum_ring_t *ring);
+
+/**
+ * @brief Write PCM, it's mixed down to mono 16-bit samples.
+ *
+ * @param ring The ring
+ * @param pcm Interleaved PCM, little-endian signed samples
+ * @param len Length of `pcm` in bytes
+ * @param bits Bits per sample: 16, 24 or 32
+ * @param channels Number of channels, the samples of each frame are averaged
+ *
+ * @return Number of mono samples written, the rest of the frames are dropped
+ */
+uint32_t audio_spectrum_ring_write_pcm(audio_spectrum_ring_t *ring, const void *pcm, size_t len, uint8_t bits,
+                                       uint8_t channels);
+
+/**
+ * @brief Read samples.
+ *
+ * @param ring The ring
+ * @param samples Buffer of `num` samples
+ * @param num Maximum number of samples to read
+ *
+ * @return Number of samples read
+ */
+uint32_t audio_spectrum_ring_read(audio_spectrum_ring_t *ring, int16_t *samples, uint32_t num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,281 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "audio_spectrum_ring.h"
+#include "audio_spectrum.h"
+
+typedef struct {
+    audio_spectrum_config_t config;
+    audio_spectrum_dsp_t *dsp;
+    audio_spectrum_ring_t ring;
+    int16_t *ring_buf;
+    int16_t *window;            /* The latest `fft_size` samples, circular */
+    uint32_t window_pos;
+    int16_t *block;             /* `window` in order, the input of the DSP */
+    uint16_t levels[AUDIO_SPECTRUM_BAND_NUM_MAX];
+    /* Levels read by the UI, guarded by a sequence counter which is odd while they are written */
+    atomic_uint published_seq;
+    uint16_t published[AUDIO_SPECTRUM_BAND_NUM_MAX];
+    /* `audio_spectrum_feed()` only writes to the ring while `running`, `feeding` counts the writers */
+    atomic_bool running;
+    atomic_int feeding;
+    atomic_uint sample_rate;
+    atomic_bool exit;
+    TaskHandle_t task;
+    SemaphoreHandle_t task_done;
+    portMUX_TYPE stats_lock;
+    audio_spectrum_stats_t stats;
+    int64_t start_us;
+    uint64_t analysis_us_sum;
+} audio_spectrum_t;
+
+static const char *TAG = "audio_spectrum";
+
+static audio_spectrum_t spectrum = {
+    .stats_lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void publish_levels(audio_spectrum_t *ctx)
+{
+    unsigned int seq = atomic_load_explicit(&ctx->published_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&ctx->published_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(ctx->published, ctx->levels, sizeof(ctx->published));
+    atomic_store_explicit(&ctx->published_seq, seq + 2, memory_order_release);
+}
+
+/* Move the new samples of the ring into the window, returns their number */
+static uint32_t drain_ring(audio_spectrum_t *ctx)
+{
+    uint32_t fft_size = ctx->config.dsp.fft_size;
+    uint32_t fresh = 0;
+    uint32_t num = 0;
+
+    /* Bounded by the size of the ring, the writer can't fill it faster than the audio plays */
+    do {
+        num = audio_spectrum_ring_read(&ctx->ring, ctx->window + ctx->window_pos, fft_size - ctx->window_pos);
+        ctx->window_pos = (ctx->window_pos + num) % fft_size;
+        fresh += num;
+    } while (num && (fresh < ctx->ring.size));
+
+    return fresh;
+}
+
+static esp_err_t update_sample_rate(audio_spectrum_t *ctx)
+{
+    uint32_t sample_rate = atomic_load(&ctx->sample_rate);
+    if ((sample_rate == 0) || (sample_rate == audio_spectrum_dsp_get_config(ctx->dsp)->sample_rate)) {
+        return ESP_OK;
+    }
+
+    audio_spectrum_dsp_config_t dsp_config = ctx->config.dsp;
+    dsp_config.sample_rate = sample_rate;
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&dsp_config);
+    ESP_RETURN_ON_FALSE(dsp, ESP_ERR_NO_MEM, TAG, "Create DSP for %" PRIu32 " Hz failed", sample_rate);
+
+    audio_spectrum_dsp_del(ctx->dsp);
+    ctx->dsp = dsp;
+    ESP_LOGI(TAG, "Sample rate: %" PRIu32, sample_rate);
+
+    return ESP_OK;
+}
+
+static void analyzer_task(void *arg)
+{
+    audio_spectrum_t *ctx = arg;
+    uint32_t fft_size = ctx->config.dsp.fft_size;
+    TickType_t period = pdMS_TO_TICKS(1000 / ctx->config.rate_hz);
+    TickType_t wake = xTaskGetTickCount();
+
+    if (period == 0) {
+        period = 1;
+    }
+
+    while (!atomic_load(&ctx->exit)) {
+        vTaskDelayUntil(&wake, period);
+
+        update_sample_rate(ctx);
+        uint32_t fresh = drain_ring(ctx);
+
+        int64_t begin_us = esp_timer_get_time();
+        if (fresh) {
+            uint32_t tail = fft_size - ctx->window_pos;
+            memcpy(ctx->block, ctx->window + ctx->window_pos, tail * sizeof(int16_t));
+            memcpy(ctx->block + tail, ctx->window, ctx->window_pos * sizeof(int16_t));
+            audio_spectrum_dsp_process(ctx->dsp, ctx->block, ctx->levels);
+        } else {
+            /* Paused or stopped: the bars fall */
+            audio_spectrum_dsp_process(ctx->dsp, NULL, ctx->levels);
+        }
+        int64_t end_us = esp_timer_get_time();
+        publish_levels(ctx);
+
+        uint32_t analysis_us = (uint32_t)(end_us - begin_us);
+        ctx->analysis_us_sum += analysis_us;
+        portENTER_CRITICAL(&ctx->stats_lock);
+        ctx->stats.analysis_num++;
+        ctx->stats.analysis_us_last = analysis_us;
+        ctx->stats.analysis_us_avg = ctx->analysis_us_sum / ctx->stats.analysis_num;
+        if (analysis_us > ctx->stats.analysis_us_max) {
+            ctx->stats.analysis_us_max = analysis_us;
+        }
+        ctx->stats.load_permille = (end_us > ctx->start_us) ?
+                                   (uint32_t)(ctx->analysis_us_sum * 1000 / (end_us - ctx->start_us)) : 0;
+        ctx->stats.dropped_samples = atomic_load_explicit(&ctx->ring.dropped, memory_order_relaxed);
+        portEXIT_CRITICAL(&ctx->stats_lock);
+    }
+
+    xSemaphoreGive(ctx->task_done);
+    vTaskDelete(NULL);
+}
+
+static void free_buffers(audio_spectrum_t *ctx)
+{
+    audio_spectrum_dsp_del(ctx->dsp);
+    ctx->dsp = NULL;
+    free(ctx->ring_buf);
+    ctx->ring_buf = NULL;
+    free(ctx->window);
+    ctx->window = NULL;
+    free(ctx->block);
+    ctx->block = NULL;
+    if (ctx->task_done) {
+        vSemaphoreDelete(ctx->task_done);
+        ctx->task_done = NULL;
+    }
+}
+
+esp_err_t audio_spectrum_start(const audio_spectrum_config_t *config)
+{
+    audio_spectrum_t *ctx = &spectrum;
+    audio_spectrum_config_t default_config = AUDIO_SPECTRUM_DEFAULT_CONFIG();
+
+    ESP_RETURN_ON_FALSE(!atomic_load(&ctx->running), ESP_ERR_INVALID_STATE, TAG, "Already started");
+    if (config == NULL) {
+        config = &default_config;
+    }
+    ESP_RETURN_ON_FALSE((config->rate_hz > 0) && (config->ring_size >= config->dsp.fft_size), ESP_ERR_INVALID_ARG,
+                        TAG, "Invalid rate or ring size");
+
+    esp_err_t ret = ESP_OK;
+    ctx->config = *config;
+    ctx->dsp = audio_spectrum_dsp_new(&config->dsp);
+    ESP_GOTO_ON_FALSE(ctx->dsp, ESP_ERR_INVALID_ARG, err, TAG, "Invalid DSP configuration");
+
+    ctx->ring_buf = heap_caps_malloc(config->ring_size * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ctx->window = calloc(config->dsp.fft_size, sizeof(int16_t));
+    ctx->block = malloc(config->dsp.fft_size * sizeof(int16_t));
+    ctx->task_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(ctx->ring_buf && ctx->window && ctx->block && ctx->task_done, ESP_ERR_NO_MEM, err, TAG,
+                      "No memory");
+    ESP_GOTO_ON_FALSE(audio_spectrum_ring_init(&ctx->ring, ctx->ring_buf, config->ring_size) == 0, ESP_ERR_INVALID_ARG,
+                      err, TAG, "Ring size isn't a power of 2");
+
+    ctx->window_pos = 0;
+    memset(ctx->levels, 0, sizeof(ctx->levels));
+    publish_levels(ctx);
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    ctx->analysis_us_sum = 0;
+    ctx->start_us = esp_timer_get_time();
+    atomic_store(&ctx->sample_rate, 0);
+    atomic_store(&ctx->exit, false);
+
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(analyzer_task, "audio_spectrum", config->task_stack_size, ctx,
+                      config->task_priority, &ctx->task, config->task_core_id) == pdPASS, ESP_ERR_NO_MEM, err, TAG,
+                      "Create task failed");
+    atomic_store(&ctx->running, true);
+
+    return ESP_OK;
+
+err:
+    free_buffers(ctx);
+    return ret;
+}
+
+esp_err_t audio_spectrum_stop(void)
+{
+    audio_spectrum_t *ctx = &spectrum;
+
+    ESP_RETURN_ON_FALSE(atomic_load(&ctx->running), ESP_ERR_INVALID_STATE, TAG, "Not started");
+
+    /* No new writer can enter after this, wait for the ones which are writing */
+    atomic_store(&ctx->running, false);
+    while (atomic_load(&ctx->feeding)) {
+        vTaskDelay(1);
+    }
+
+    atomic_store(&ctx->exit, true);
+    xSemaphoreTake(ctx->task_done, portMAX_DELAY);
+    ctx->task = NULL;
+
+    ESP_LOGI(TAG, "Analyses: %" PRIu32 ", avg: %" PRIu32 " us, max: %" PRIu32 " us, load: %" PRIu32 "/1000, "
+             "dropped: %" PRIu32, ctx->stats.analysis_num, ctx->stats.analysis_us_avg, ctx->stats.analysis_us_max,
+             ctx->stats.load_permille, ctx->stats.dropped_samples);
+
+    memset(ctx->levels, 0, sizeof(ctx->levels));
+    publish_levels(ctx);
+    free_buffers(ctx);
+
+    return ESP_OK;
+}
+
+void audio_spectrum_feed(const void *pcm, size_t len, uint32_t sample_rate, uint8_t bits, uint8_t channels,
+                         void *user_data)
+{
+    audio_spectrum_t *ctx = &spectrum;
+    (void)user_data;
+
+    if (!atomic_load(&ctx->running)) {
+        return;
+    }
+    atomic_fetch_add(&ctx->feeding, 1);
+    /* Checked again, `audio_spectrum_stop()` may have missed this writer before */
+    if (atomic_load(&ctx->running)) {
+        atomic_store_explicit(&ctx->sample_rate, sample_rate, memory_order_relaxed);
+        audio_spectrum_ring_write_pcm(&ctx->ring, pcm, len, bits, channels);
+    }
+    atomic_fetch_sub(&ctx->feeding, 1);
+}
+
+bool audio_spectrum_get_levels(uint16_t *levels, uint8_t band_num)
+{
+    audio_spectrum_t *ctx = &spectrum;
+    unsigned int seq = 0;
+
+    if (band_num > AUDIO_SPECTRUM_BAND_NUM_MAX) {
+        band_num = AUDIO_SPECTRUM_BAND_NUM_MAX;
+    }
+    do {
+        seq = atomic_load_explicit(&ctx->published_seq, memory_order_acquire);
+        memcpy(levels, ctx->published, band_num * sizeof(uint16_t));
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || (seq != atomic_load_explicit(&ctx->published_seq, memory_order_relaxed)));
+
+    return atomic_load(&ctx->running);
+}
+
+esp_err_t audio_spectrum_get_stats(audio_spectrum_stats_t *stats)
+{
+    audio_spectrum_t *ctx = &spectrum;
+
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid stats");
+
+    portENTER_CRITICAL(&ctx->stats_lock);
+    *stats = ctx->stats;
+    portEXIT_CRITICAL(&ctx->stats_lock);
+
+    return ESP_OK;
+}
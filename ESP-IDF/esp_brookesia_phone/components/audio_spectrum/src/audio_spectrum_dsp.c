@@ -0,0 +1,375 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_spectrum_dsp.h"
+
+#ifndef M_PI
+#define M_PI    (3.14159265358979323846)
+#endif
+
+/* log2 of the energy of a full-scale sine in a band, in 1/256: (32767 / 8)^2 * 1.5 (main lobe of the Hann window) */
+#define ENERGY_REF_LOG2_Q8      (6294)
+/* 10 * log10(2) in 1/1024 */
+#define DB_PER_LOG2_Q10         (3083)
+/* The normalized block peaks below this. The complex samples are at most `NORM_PEAK * sqrt(2)` then, and the
+ * scaled butterflies never make them larger, so they can't overflow */
+#define NORM_PEAK               (16384)
+
+struct audio_spectrum_dsp_t {
+    audio_spectrum_dsp_config_t config;
+    uint16_t half;              /* Size of the complex FFT: fft_size / 2 */
+    uint8_t stage_num;          /* log2(half) */
+    int16_t *window;            /* Hann window, fft_size */
+    uint16_t *bit_rev;          /* Bit reversed indexes of the complex FFT, half */
+    /* Twiddles of the complex FFT. The ones of a stage are contiguous, so the inner loop of the butterflies
+     * has unit stride over all the arrays and can be vectorized */
+    int16_t *stage_cos;
+    int16_t *stage_sin;
+    /* Twiddles of splitting the complex FFT into the spectrum of the real input: W_N^k, k < half */
+    int16_t *split_cos;
+    int16_t *split_sin;
+    /* Real and imaginary parts in separate arrays (structure of arrays) */
+    int16_t *re;
+    int16_t *im;
+    uint32_t *power;
+    uint16_t band_bins[AUDIO_SPECTRUM_BAND_NUM_MAX + 1];
+};
+
+static int16_t q15(double v)
+{
+    long r = lround(v * 32768.0);
+    if (r > INT16_MAX) {
+        r = INT16_MAX;
+    } else if (r < INT16_MIN) {
+        r = INT16_MIN;
+    }
+    return (int16_t)r;
+}
+
+static bool is_power_of_2(uint32_t v)
+{
+    return (v != 0) && ((v & (v - 1)) == 0);
+}
+
+static void init_band_bins(audio_spectrum_dsp_t *dsp)
+{
+    const audio_spectrum_dsp_config_t *cfg = &dsp->config;
+    double nyquist = cfg->sample_rate / 2.0;
+    double f_min = cfg->freq_min;
+    double f_max = (cfg->freq_max < nyquist) ? cfg->freq_max : nyquist;
+    double bin_hz = (double)cfg->sample_rate / cfg->fft_size;
+    /* The bins of the bands: DC is never used and the last band ends at Nyquist at most */
+    uint16_t bin_last = dsp->half + 1;
+
+    uint16_t prev = (uint16_t)lround(f_min / bin_hz);
+    if (prev < 1) {
+        prev = 1;
+    }
+    dsp->band_bins[0] = prev;
+    for (int b = 1; b <= cfg->band_num; b++) {
+        double f = f_min * pow(f_max / f_min, (double)b / cfg->band_num);
+        long bin = lround(f / bin_hz);
+        /* Each band gets at least one bin */
+        if (bin <= prev) {
+            bin = prev + 1;
+        }
+        if (bin > bin_last) {
+            bin = bin_last;
+        }
+        dsp->band_bins[b] = (uint16_t)bin;
+        prev = (uint16_t)bin;
+    }
+}
+
+audio_spectrum_dsp_t *audio_spectrum_dsp_new(const audio_spectrum_dsp_config_t *config)
+{
+    if ((config == NULL) || !is_power_of_2(config->fft_size) || (config->fft_size < AUDIO_SPECTRUM_FFT_SIZE_MIN) ||
+            (config->fft_size > AUDIO_SPECTRUM_FFT_SIZE_MAX) || (config->band_num == 0) ||
+            (config->band_num > AUDIO_SPECTRUM_BAND_NUM_MAX) || (config->sample_rate == 0) ||
+            (config->freq_min == 0) || (config->freq_min >= config->freq_max) || (config->range_db == 0)) {
+        return NULL;
+    }
+    /* Every band needs a bin between `freq_min` and Nyquist */
+    if ((uint32_t)config->freq_min * 2 >= config->sample_rate ||
+            (uint32_t)config->freq_min * config->fft_size / config->sample_rate + config->band_num > config->fft_size / 2) {
+        return NULL;
+    }
+
+    audio_spectrum_dsp_t *dsp = calloc(1, sizeof(audio_spectrum_dsp_t));
+    if (dsp == NULL) {
+        return NULL;
+    }
+    dsp->config = *config;
+
+    uint16_t n = config->fft_size;
+    uint16_t half = n / 2;
+    dsp->half = half;
+    while ((1U << dsp->stage_num) < half) {
+        dsp->stage_num++;
+    }
+
+    dsp->window = malloc(n * sizeof(int16_t));
+    dsp->bit_rev = malloc(half * sizeof(uint16_t));
+    dsp->stage_cos = malloc(half * sizeof(int16_t));
+    dsp->stage_sin = malloc(half * sizeof(int16_t));
+    dsp->split_cos = malloc(half * sizeof(int16_t));
+    dsp->split_sin = malloc(half * sizeof(int16_t));
+    dsp->re = malloc(half * sizeof(int16_t));
+    dsp->im = malloc(half * sizeof(int16_t));
+    dsp->power = malloc((half + 1) * sizeof(uint32_t));
+    if ((dsp->window == NULL) || (dsp->bit_rev == NULL) || (dsp->stage_cos == NULL) || (dsp->stage_sin == NULL) ||
+            (dsp->split_cos == NULL) || (dsp->split_sin == NULL) || (dsp->re == NULL) || (dsp->im == NULL) ||
+            (dsp->power == NULL)) {
+        audio_spectrum_dsp_del(dsp);
+        return NULL;
+    }
+
+    /* Periodic Hann window */
+    for (int i = 0; i < n; i++) {
+        dsp->window[i] = q15(0.5 - 0.5 * cos(2.0 * M_PI * i / n));
+    }
+
+    for (int i = 0; i < half; i++) {
+        uint16_t r = 0;
+        for (int b = 0; b < dsp->stage_num; b++) {
+            r |= ((i >> b) & 1) << (dsp->stage_num - 1 - b);
+        }
+        dsp->bit_rev[i] = r;
+    }
+
+    /* The stage with butterflies `span` apart uses W_(2 * span)^j, j < span. Its twiddles start at `span - 1` */
+    for (int span = 1; span < half; span *= 2) {
+        for (int j = 0; j < span; j++) {
+            double a = M_PI * j / span;
+            dsp->stage_cos[span - 1 + j] = q15(cos(a));
+            dsp->stage_sin[span - 1 + j] = q15(sin(a));
+        }
+    }
+
+    for (int k = 0; k < half; k++) {
+        double a = 2.0 * M_PI * k / n;
+        dsp->split_cos[k] = q15(cos(a));
+        dsp->split_sin[k] = q15(sin(a));
+    }
+
+    init_band_bins(dsp);
+
+    return dsp;
+}
+
+void audio_spectrum_dsp_del(audio_spectrum_dsp_t *dsp)
+{
+    if (dsp == NULL) {
+        return;
+    }
+    free(dsp->window);
+    free(dsp->bit_rev);
+    free(dsp->stage_cos);
+    free(dsp->stage_sin);
+    free(dsp->split_cos);
+    free(dsp->split_sin);
+    free(dsp->re);
+    free(dsp->im);
+    free(dsp->power);
+    free(dsp);
+}
+
+const audio_spectrum_dsp_config_t *audio_spectrum_dsp_get_config(const audio_spectrum_dsp_t *dsp)
+{
+    return &dsp->config;
+}
+
+void audio_spectrum_dsp_get_band_bins(const audio_spectrum_dsp_t *dsp, uint8_t band, uint16_t *bin_start,
+                                      uint16_t *bin_end)
+{
+    *bin_start = dsp->band_bins[band];
+    *bin_end = dsp->band_bins[band + 1];
+}
+
+/* Window and halve the samples, normalize them to NORM_PEAK and store them in bit reversed order as `half`
+ * complex samples: the even ones are the real parts, the odd ones the imaginary parts */
+static uint8_t load_block(audio_spectrum_dsp_t *dsp, const int16_t *samples)
+{
+    const int16_t *w = dsp->window;
+    int16_t *re = dsp->re;
+    int16_t *im = dsp->im;
+    int32_t peak = 0;
+
+    for (int i = 0; i < dsp->half; i++) {
+        int32_t a = ((int32_t)samples[2 * i] * w[2 * i]) >> 16;
+        int32_t b = ((int32_t)samples[2 * i + 1] * w[2 * i + 1]) >> 16;
+        re[i] = (int16_t)a;
+        im[i] = (int16_t)b;
+        a = (a < 0) ? -a : a;
+        b = (b < 0) ? -b : b;
+        peak = (a > peak) ? a : peak;
+        peak = (b > peak) ? b : peak;
+    }
+
+    /* Quiet blocks are shifted up to keep the precision of the scaled butterflies */
+    uint8_t shift = 0;
+    if (peak) {
+        while ((peak << (shift + 1)) < NORM_PEAK) {
+            shift++;
+        }
+    }
+
+    /* Bit reversal, in place: swap each pair once */
+    for (int i = 0; i < dsp->half; i++) {
+        int j = dsp->bit_rev[i];
+        if (j > i) {
+            int16_t t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+    if (shift) {
+        for (int i = 0; i < dsp->half; i++) {
+            re[i] = (int16_t)(re[i] * (1 << shift));
+            im[i] = (int16_t)(im[i] * (1 << shift));
+        }
+    }
+
+    return shift;
+}
+
+/* The butterflies of one group: `a` and `b` are `span` apart. All the arrays are contiguous and don't overlap,
+ * so the loop is vectorized */
+static inline void butterflies(int16_t *restrict ar, int16_t *restrict ai, int16_t *restrict br, int16_t *restrict bi,
+                               const int16_t *restrict tc, const int16_t *restrict ts, int span)
+{
+    for (int j = 0; j < span; j++) {
+        /* b * W, W = cos - j * sin, in Q16 to round it with the half of the butterfly */
+        int32_t tr = ((int32_t)br[j] * tc[j] + (int32_t)bi[j] * ts[j] + (1 << 13)) >> 14;
+        int32_t ti = ((int32_t)bi[j] * tc[j] - (int32_t)br[j] * ts[j] + (1 << 13)) >> 14;
+        int32_t xr = (int32_t)ar[j] * 2;
+        int32_t xi = (int32_t)ai[j] * 2;
+        ar[j] = (int16_t)((xr + tr + 2) >> 2);
+        ai[j] = (int16_t)((xi + ti + 2) >> 2);
+        br[j] = (int16_t)((xr - tr + 2) >> 2);
+        bi[j] = (int16_t)((xi - ti + 2) >> 2);
+    }
+}
+
+/* Radix-2 decimation in time, every stage is scaled by 1/2 so the result is the FFT divided by `half`.
+ * The products and the halves are rounded, truncating them would add a bias to every bin */
+static void fft_complex(audio_spectrum_dsp_t *dsp)
+{
+    int16_t *re = dsp->re;
+    int16_t *im = dsp->im;
+    const uint16_t half = dsp->half;
+
+    /* First stage, the twiddle is 1 */
+    for (int i = 0; i < half; i += 2) {
+        int32_t ar = re[i], ai = im[i];
+        int32_t br = re[i + 1], bi = im[i + 1];
+        re[i] = (int16_t)((ar + br + 1) >> 1);
+        im[i] = (int16_t)((ai + bi + 1) >> 1);
+        re[i + 1] = (int16_t)((ar - br + 1) >> 1);
+        im[i + 1] = (int16_t)((ai - bi + 1) >> 1);
+    }
+
+    for (int span = 2; span < half; span *= 2) {
+        const int16_t *tc = dsp->stage_cos + span - 1;
+        const int16_t *ts = dsp->stage_sin + span - 1;
+        for (int k = 0; k < half; k += 2 * span) {
+            butterflies(re + k, im + k, re + k + span, im + k + span, tc, ts, span);
+        }
+    }
+}
+
+uint8_t audio_spectrum_dsp_power(audio_spectrum_dsp_t *dsp, const int16_t *samples, uint32_t *power)
+{
+    uint8_t shift = load_block(dsp, samples);
+    fft_complex(dsp);
+
+    /* Split the FFT of the packed block Z into the spectrum of the real block:
+     * X[k] = (Z[k] + Z*[half - k]) / 2 - j * W_N^k * (Z[k] - Z*[half - k]) / 2
+     * It's scaled by 1/2 once more, so the power fits 32 bits */
+    const int16_t *re = dsp->re;
+    const int16_t *im = dsp->im;
+    const uint16_t half = dsp->half;
+
+    int32_t dc = ((int32_t)re[0] + im[0]) >> 1;
+    int32_t ny = ((int32_t)re[0] - im[0]) >> 1;
+    power[0] = (uint32_t)(dc * dc);
+    power[half] = (uint32_t)(ny * ny);
+
+    for (int k = 1; k < half; k++) {
+        int32_t a = re[k], b = im[k];
+        int32_t c = re[half - k], d = im[half - k];
+        int32_t c_ = dsp->split_cos[k], s_ = dsp->split_sin[k];
+        /* Halved first, so the products can't overflow */
+        int32_t sum_re = (a + c) >> 1;
+        int32_t dif_im = (b - d) >> 1;
+        int32_t sum_im = (b + d) >> 1;
+        int32_t dif_re = (a - c) >> 1;
+        int32_t xr = (sum_re + ((sum_im * c_ - dif_re * s_) >> 15)) >> 1;
+        int32_t xi = (dif_im + ((-dif_re * c_ - sum_im * s_) >> 15)) >> 1;
+        power[k] = (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+    }
+
+    return shift;
+}
+
+/* log2 in 1/256 */
+static int32_t log2_q8(uint64_t v)
+{
+    int msb = 63 - __builtin_clzll(v);
+    /* The 8 bits below the leading one, log2(1 + f) ~= f + 0.34 * f * (1 - f) */
+    uint32_t f = (msb >= 8) ? (uint32_t)(v >> (msb - 8)) & 0xff : (uint32_t)(v << (8 - msb)) & 0xff;
+    return msb * 256 + f + ((f * (256 - f) * 87) >> 16);
+}
+
+int32_t audio_spectrum_dsp_energy_to_db(uint64_t energy, uint8_t shift)
+{
+    if (energy == 0) {
+        return INT32_MIN;
+    }
+    int32_t log2 = log2_q8(energy) - shift * 2 * 256 - ENERGY_REF_LOG2_Q8;
+    return (log2 * DB_PER_LOG2_Q10) / 1024;
+}
+
+void audio_spectrum_dsp_process(audio_spectrum_dsp_t *dsp, const int16_t *samples, uint16_t *levels)
+{
+    const audio_spectrum_dsp_config_t *cfg = &dsp->config;
+    uint8_t shift = 0;
+
+    if (samples) {
+        shift = audio_spectrum_dsp_power(dsp, samples, dsp->power);
+    }
+
+    for (int b = 0; b < cfg->band_num; b++) {
+        int32_t level = 0;
+        if (samples) {
+            uint64_t energy = 0;
+            for (int k = dsp->band_bins[b]; k < dsp->band_bins[b + 1]; k++) {
+                energy += dsp->power[k];
+            }
+            int32_t db = audio_spectrum_dsp_energy_to_db(energy, shift);
+            if (db != INT32_MIN) {
+                int32_t above = db - cfg->floor_db * 256;
+                if (above > 0) {
+                    level = (int32_t)(((int64_t)above * cfg->level_max) / (cfg->range_db * 256));
+                }
+            }
+            if (level > cfg->level_max) {
+                level = cfg->level_max;
+            }
+        }
+        if (cfg->release && (level < levels[b])) {
+            int32_t fall = levels[b] - cfg->release;
+            level = (fall > level) ? fall : level;
+        }
+        levels[b] = (uint16_t)level;
+    }
+}
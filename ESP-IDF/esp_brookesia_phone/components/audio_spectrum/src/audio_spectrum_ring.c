@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "audio_spectrum_ring.h"
+
+int audio_spectrum_ring_init(audio_spectrum_ring_t *ring, int16_t *buf, uint32_t size)
+{
+    if ((size == 0) || (size & (size - 1))) {
+        return -1;
+    }
+    ring->buf = buf;
+    ring->size = size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+
+    return 0;
+}
+
+void audio_spectrum_ring_flush(audio_spectrum_ring_t *ring)
+{
+    atomic_store_explicit(&ring->tail, atomic_load_explicit(&ring->head, memory_order_acquire), memory_order_release);
+}
+
+uint32_t audio_spectrum_ring_available(audio_spectrum_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    return head - tail;
+}
+
+static inline int32_t read_sample(const uint8_t *p, uint8_t bytes)
+{
+    /* The top 16 bits of the little-endian sample */
+    return (int16_t)(p[bytes - 2] | (p[bytes - 1] << 8));
+}
+
+uint32_t audio_spectrum_ring_write_pcm(audio_spectrum_ring_t *ring, const void *pcm, size_t len, uint8_t bits,
+                                       uint8_t channels)
+{
+    if ((bits != 16 && bits != 24 && bits != 32) || (channels == 0)) {
+        return 0;
+    }
+
+    uint8_t bytes = bits / 8;
+    size_t frame_bytes = (size_t)bytes * channels;
+    uint32_t frames = len / frame_bytes;
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t room = ring->size - (head - tail);
+    uint32_t num = (frames < room) ? frames : room;
+    const uint8_t *p = pcm;
+    uint32_t mask = ring->size - 1;
+
+    if ((bits == 16) && (channels == 2)) {
+        /* The format of the player */
+        const int16_t *s = pcm;
+        for (uint32_t i = 0; i < num; i++) {
+            ring->buf[(head + i) & mask] = (int16_t)(((int32_t)s[2 * i] + s[2 * i + 1]) >> 1);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            int32_t sum = 0;
+            for (uint8_t c = 0; c < channels; c++) {
+                sum += read_sample(p, bytes);
+                p += bytes;
+            }
+            ring->buf[(head + i) & mask] = (int16_t)(sum / channels);
+        }
+    }
+
+    atomic_store_explicit(&ring->head, head + num, memory_order_release);
+    if (num < frames) {
+        atomic_fetch_add_explicit(&ring->dropped, frames - num, memory_order_relaxed);
+    }
+
+    return num;
+}
+
+uint32_t audio_spectrum_ring_read(audio_spectrum_ring_t *ring, int16_t *samples, uint32_t num)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t avail = head - tail;
+
+    if (num > avail) {
+        num = avail;
+    }
+
+    uint32_t start = tail & (ring->size - 1);
+    uint32_t first = ring->size - start;
+    if (first > num) {
+        first = num;
+    }
+    memcpy(samples, ring->buf + start, first * sizeof(int16_t));
+    memcpy(samples + first, ring->buf, (num - first) * sizeof(int16_t));
+
+    atomic_store_explicit(&ring->tail, tail + num, memory_order_release);
+
+    return num;
+}
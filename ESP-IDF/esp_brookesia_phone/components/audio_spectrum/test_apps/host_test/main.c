@@ -0,0 +1,331 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * Check the DSP core of the spectrum analyzer with known signals: the FFT against a floating-point DFT, sine
+ * sweeps against the bands and the levels against the amplitude. See README.md.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_spectrum_dsp.h"
+#include "audio_spectrum_ring.h"
+
+#define SAMPLE_RATE         (44100)
+#define FFT_SIZE            (1024)
+#define SWEEP_STEPS         (120)
+#define BENCH_BLOCKS        (2000)
+
+#ifndef M_PI
+#define M_PI    (3.14159265358979323846)
+#endif
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+static int16_t samples[FFT_SIZE];
+static uint32_t power[FFT_SIZE / 2 + 1];
+
+static void make_sine(int16_t *buf, int num, double freq, double dbfs, double phase)
+{
+    double amp = 32767.0 * pow(10.0, dbfs / 20.0);
+    for (int i = 0; i < num; i++) {
+        buf[i] = (int16_t)lround(amp * sin(2.0 * M_PI * freq * i / SAMPLE_RATE + phase));
+    }
+}
+
+static uint64_t band_energy(const audio_spectrum_dsp_t *dsp, uint8_t band)
+{
+    uint16_t start = 0, end = 0;
+    audio_spectrum_dsp_get_band_bins(dsp, band, &start, &end);
+
+    uint64_t energy = 0;
+    for (int k = start; k < end; k++) {
+        energy += power[k];
+    }
+    return energy;
+}
+
+static int find_band(const audio_spectrum_dsp_t *dsp, double freq)
+{
+    const audio_spectrum_dsp_config_t *cfg = audio_spectrum_dsp_get_config(dsp);
+    double bin = freq * FFT_SIZE / SAMPLE_RATE;
+    for (int b = 0; b < cfg->band_num; b++) {
+        uint16_t start = 0, end = 0;
+        audio_spectrum_dsp_get_band_bins(dsp, b, &start, &end);
+        if ((bin >= start - 0.5) && (bin < end - 0.5)) {
+            return b;
+        }
+    }
+    return -1;
+}
+
+static bool test_config(void)
+{
+    audio_spectrum_dsp_config_t config = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    config.fft_size = 1000;
+    TEST_CHECK(audio_spectrum_dsp_new(&config) == NULL, "FFT size isn't a power of 2");
+
+    config = (audio_spectrum_dsp_config_t)AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    config.band_num = AUDIO_SPECTRUM_BAND_NUM_MAX + 1;
+    TEST_CHECK(audio_spectrum_dsp_new(&config) == NULL, "Too many bands");
+
+    config = (audio_spectrum_dsp_config_t)AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    config.freq_min = 30000;
+    TEST_CHECK(audio_spectrum_dsp_new(&config) == NULL, "First band over Nyquist");
+
+    /* More bands than bins: each band still gets one */
+    config = (audio_spectrum_dsp_config_t)AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    config.fft_size = 64;
+    config.band_num = 16;
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&config);
+    TEST_CHECK(dsp, "Create DSP failed");
+    uint16_t prev_end = 1;
+    for (int b = 0; b < config.band_num; b++) {
+        uint16_t start = 0, end = 0;
+        audio_spectrum_dsp_get_band_bins(dsp, b, &start, &end);
+        TEST_CHECK((start == prev_end) || (b == 0), "Band %d isn't adjacent", b);
+        TEST_CHECK((end > start) && (end <= config.fft_size / 2 + 1), "Band %d: [%d, %d)", b, start, end);
+        prev_end = end;
+    }
+    audio_spectrum_dsp_del(dsp);
+
+    return true;
+}
+
+/* The power spectrum against a floating-point DFT of the same windowed block */
+static bool test_fft_matches_dft(void)
+{
+    audio_spectrum_dsp_config_t config = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&config);
+    TEST_CHECK(dsp, "Create DSP failed");
+
+    /* Two tones and noise */
+    srand(1);
+    make_sine(samples, FFT_SIZE, 1000.0, -6.0, 0.3);
+    for (int i = 0; i < FFT_SIZE; i++) {
+        double v = samples[i] * 0.5 + 8000.0 * sin(2.0 * M_PI * 5123.0 * i / SAMPLE_RATE) + (rand() % 2001 - 1000);
+        samples[i] = (int16_t)lround(v);
+    }
+
+    uint8_t shift = audio_spectrum_dsp_power(dsp, samples, power);
+    double peak = 0;
+    double max_err = 0;
+    for (int k = 0; k <= FFT_SIZE / 2; k++) {
+        double re = 0, im = 0;
+        for (int i = 0; i < FFT_SIZE; i++) {
+            double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / FFT_SIZE);
+            double a = 2.0 * M_PI * k * i / FFT_SIZE;
+            re += samples[i] * w * cos(a);
+            im -= samples[i] * w * sin(a);
+        }
+        /* The fixed-point spectrum is X / (2 * N) */
+        double mag = sqrt(re * re + im * im) / (2.0 * FFT_SIZE);
+        double fixed = sqrt((double)power[k]) / (1 << shift);
+        peak = (mag > peak) ? mag : peak;
+        double err = fabs(mag - fixed);
+        max_err = (err > max_err) ? err : max_err;
+    }
+    audio_spectrum_dsp_del(dsp);
+
+    /* 16-bit butterflies scaled in every stage: the error stays 50 dB below the peak of the block */
+    TEST_CHECK(max_err < peak / 316.0, "Max error %.2f, peak %.2f", max_err, peak);
+    printf("fft: peak %.1f, max error %.3f (%.1f dB)\n", peak, max_err, 20.0 * log10(max_err / peak));
+
+    return true;
+}
+
+/* A logarithmic sine sweep: the loudest band follows the frequency and the others are far below */
+static bool test_sine_sweep(void)
+{
+    audio_spectrum_dsp_config_t config = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    config.band_num = 8;
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&config);
+    TEST_CHECK(dsp, "Create DSP failed");
+
+    uint16_t levels[AUDIO_SPECTRUM_BAND_NUM_MAX];
+    int prev_band = 0;
+    for (int step = 0; step < SWEEP_STEPS; step++) {
+        double freq = 50.0 * pow(15000.0 / 50.0, (double)step / (SWEEP_STEPS - 1));
+        make_sine(samples, FFT_SIZE, freq, -6.0, step * 0.1);
+        audio_spectrum_dsp_process(dsp, samples, levels);
+
+        int loudest = 0;
+        for (int b = 1; b < config.band_num; b++) {
+            loudest = (levels[b] > levels[loudest]) ? b : loudest;
+        }
+        int expected = find_band(dsp, freq);
+        /* Close to an edge the tone is shared by the two bands */
+        TEST_CHECK(abs(loudest - expected) <= 1, "%.1f Hz: band %d, expected %d", freq, loudest, expected);
+        TEST_CHECK(loudest >= prev_band, "%.1f Hz: band %d after band %d", freq, loudest, prev_band);
+        prev_band = loudest;
+
+        /* -6 dBFS with 60 dB of range: 54/60 of the maximum, minus what leaks into the next band */
+        TEST_CHECK(levels[loudest] >= config.level_max * 45 / 60, "%.1f Hz: level %d", freq, levels[loudest]);
+        /* The side lobes of the window are at least 30 dB down, the narrow low bands get more of them */
+        for (int b = 0; b < config.band_num; b++) {
+            if (abs(b - loudest) > 1) {
+                TEST_CHECK(levels[b] + config.level_max * 30 / 60 <= levels[loudest], "%.1f Hz: band %d leaks %d",
+                           freq, b, levels[b]);
+            }
+        }
+    }
+    TEST_CHECK(prev_band == config.band_num - 1, "The sweep ends in band %d", prev_band);
+    audio_spectrum_dsp_del(dsp);
+
+    return true;
+}
+
+/* The level of a band follows the amplitude in dB, also for quiet signals thanks to the normalization */
+static bool test_level_accuracy(void)
+{
+    audio_spectrum_dsp_config_t config = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&config);
+    TEST_CHECK(dsp, "Create DSP failed");
+
+    const double freqs[] = {100.0, 440.0, 2500.0, 9000.0};
+    for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+        int band = find_band(dsp, freqs[f]);
+        for (int dbfs = 0; dbfs >= -60; dbfs -= 6) {
+            make_sine(samples, FFT_SIZE, freqs[f], dbfs, 0.7);
+            uint8_t shift = audio_spectrum_dsp_power(dsp, samples, power);
+            double db = audio_spectrum_dsp_energy_to_db(band_energy(dsp, band), shift) / 256.0;
+            TEST_CHECK(fabs(db - dbfs) < 1.0, "%.0f Hz at %d dBFS: %.2f dB", freqs[f], dbfs, db);
+        }
+    }
+    audio_spectrum_dsp_del(dsp);
+
+    return true;
+}
+
+static bool test_silence_and_release(void)
+{
+    audio_spectrum_dsp_config_t config = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    config.release = 4;
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&config);
+    TEST_CHECK(dsp, "Create DSP failed");
+
+    uint16_t levels[AUDIO_SPECTRUM_BAND_NUM_MAX] = {0};
+    memset(samples, 0, sizeof(samples));
+    audio_spectrum_dsp_process(dsp, samples, levels);
+    for (int b = 0; b < config.band_num; b++) {
+        TEST_CHECK(levels[b] == 0, "Band %d of silence: %d", b, levels[b]);
+    }
+
+    /* Immediate attack, then falls by `release` per block */
+    make_sine(samples, FFT_SIZE, 100.0, 0.0, 0.0);
+    audio_spectrum_dsp_process(dsp, samples, levels);
+    uint16_t peak = levels[0];
+    TEST_CHECK(peak > config.level_max * 9 / 10, "Level of a full-scale sine: %d", peak);
+    for (int i = 1; i <= 3; i++) {
+        audio_spectrum_dsp_process(dsp, NULL, levels);
+        TEST_CHECK(levels[0] == peak - i * config.release, "Level after %d blocks: %d", i, levels[0]);
+    }
+    for (int i = 0; i < 100; i++) {
+        audio_spectrum_dsp_process(dsp, NULL, levels);
+    }
+    TEST_CHECK(levels[0] == 0, "Level doesn't fall to 0: %d", levels[0]);
+    audio_spectrum_dsp_del(dsp);
+
+    return true;
+}
+
+static bool test_ring(void)
+{
+    int16_t buf[16];
+    int16_t out[16];
+    audio_spectrum_ring_t ring;
+
+    TEST_CHECK(audio_spectrum_ring_init(&ring, buf, 12) != 0, "Size isn't a power of 2");
+    TEST_CHECK(audio_spectrum_ring_init(&ring, buf, 16) == 0, "Init failed");
+
+    /* Stereo 16-bit is averaged */
+    int16_t stereo[2 * 10];
+    for (int i = 0; i < 10; i++) {
+        stereo[2 * i] = (int16_t)(i * 100);
+        stereo[2 * i + 1] = (int16_t)(i * 100 + 50);
+    }
+    TEST_CHECK(audio_spectrum_ring_write_pcm(&ring, stereo, sizeof(stereo), 16, 2) == 10, "Write failed");
+    TEST_CHECK(audio_spectrum_ring_read(&ring, out, 6) == 6, "Read failed");
+    for (int i = 0; i < 6; i++) {
+        TEST_CHECK(out[i] == i * 100 + 25, "Sample %d: %d", i, out[i]);
+    }
+
+    /* Wraps around, what doesn't fit is dropped */
+    TEST_CHECK(audio_spectrum_ring_write_pcm(&ring, stereo, sizeof(stereo), 16, 2) == 10, "Write failed");
+    TEST_CHECK(audio_spectrum_ring_write_pcm(&ring, stereo, sizeof(stereo), 16, 2) == 2, "Write over full");
+    TEST_CHECK(atomic_load(&ring.dropped) == 8, "Dropped: %u", atomic_load(&ring.dropped));
+    TEST_CHECK(audio_spectrum_ring_available(&ring) == 16, "Available: %u", audio_spectrum_ring_available(&ring));
+    TEST_CHECK(audio_spectrum_ring_read(&ring, out, 16) == 16, "Read failed");
+    TEST_CHECK((out[3] == 925) && (out[4] == 25) && (out[14] == 25) && (out[15] == 125), "Wrong order");
+
+    /* 24-bit mono and 32-bit stereo keep the top 16 bits */
+    const uint8_t mono24[] = {0x00, 0x34, 0x12, 0xff, 0xff, 0xff};
+    TEST_CHECK(audio_spectrum_ring_write_pcm(&ring, mono24, sizeof(mono24), 24, 1) == 2, "Write 24-bit failed");
+    const int32_t stereo32[] = {0x10000000, 0x30000000};
+    TEST_CHECK(audio_spectrum_ring_write_pcm(&ring, stereo32, sizeof(stereo32), 32, 2) == 1, "Write 32-bit failed");
+    TEST_CHECK(audio_spectrum_ring_read(&ring, out, 16) == 3, "Read failed");
+    TEST_CHECK((out[0] == 0x1234) && (out[1] == -1) && (out[2] == 0x2000), "%x %x %x", out[0], out[1], out[2]);
+
+    TEST_CHECK(audio_spectrum_ring_write_pcm(&ring, mono24, sizeof(mono24), 8, 1) == 0, "8-bit isn't supported");
+
+    return true;
+}
+
+/* Not a check, the cost of an analysis on the host */
+static bool bench(void)
+{
+    audio_spectrum_dsp_config_t config = AUDIO_SPECTRUM_DSP_DEFAULT_CONFIG();
+    audio_spectrum_dsp_t *dsp = audio_spectrum_dsp_new(&config);
+    TEST_CHECK(dsp, "Create DSP failed");
+
+    uint16_t levels[AUDIO_SPECTRUM_BAND_NUM_MAX] = {0};
+    make_sine(samples, FFT_SIZE, 440.0, -12.0, 0.0);
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < BENCH_BLOCKS; i++) {
+        audio_spectrum_dsp_process(dsp, samples, levels);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double us = ((end.tv_sec - begin.tv_sec) * 1e9 + (end.tv_nsec - begin.tv_nsec)) / 1e3 / BENCH_BLOCKS;
+    printf("bench: %d-point analysis in %.2f us\n", FFT_SIZE, us);
+    audio_spectrum_dsp_del(dsp);
+
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"config", test_config},
+        {"fft_matches_dft", test_fft_matches_dft},
+        {"sine_sweep", test_sine_sweep},
+        {"level_accuracy", test_level_accuracy},
+        {"silence_and_release", test_silence_and_release},
+        {"ring", test_ring},
+        {"bench", bench},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Boot sequencer: the init steps declare the steps they depend on and run on a pool of worker threads as soon as
+ * their dependencies are finished, so independent steps run in parallel on whichever core is free.
+ *
+ * It only uses pthreads, so it's built and tested on the host too (see `test_apps/host_test`).
+ */
+
+#define BOOT_GRAPH_STEP_MAX         (32)
+#define BOOT_GRAPH_DEP_MAX          (8)
+#define BOOT_GRAPH_WORKER_MAX       (4)
+
+/**
+ * @brief Function of a step.
+ *
+ * @param arg The argument of the step
+ *
+ * @return 0 on success. On failure, the steps which require this one are skipped
+ */
+typedef int (*boot_graph_func_t)(void *arg);
+
+typedef enum {
+    BOOT_GRAPH_STEP_PENDING = 0,
+    BOOT_GRAPH_STEP_RUNNING,
+    BOOT_GRAPH_STEP_DONE,
+    BOOT_GRAPH_STEP_FAILED,
+    BOOT_GRAPH_STEP_SKIPPED,    /*!< A required dependency failed or was skipped */
+} boot_graph_step_state_t;
+
+typedef struct {
+    const char *name;
+    boot_graph_step_state_t state;
+    int result;                 /*!< Return value of the function */
+    int8_t worker;              /*!< Index of the worker which ran the step, -1 if it wasn't run */
+    int64_t start_us;           /*!< Since the start of the run */
+    int64_t end_us;
+    int64_t path_us;            /*!< Longest chain of dependencies finished by this step, its own time included */
+    int8_t critical;            /*!< 1 if the step is on the critical path */
+} boot_graph_step_info_t;
+
+typedef struct {
+    uint8_t worker_num;         /*!< Number of worker threads, at most BOOT_GRAPH_WORKER_MAX */
+    uint32_t stack_size;        /*!< Stack of a worker, bytes. Only used on the target, the host uses the default */
+    uint8_t priority;           /*!< Priority of the workers. Only used on the target */
+} boot_graph_config_t;
+
+#define BOOT_GRAPH_DEFAULT_CONFIG()     \
+    {                                   \
+        .worker_num = 2,                \
+        .stack_size = 8 * 1024,         \
+        .priority = 5,                  \
+    }
+
+typedef struct {
+    int64_t total_us;           /*!< Time of the run */
+    int64_t critical_path_us;   /*!< Longest chain of dependencies: the shortest possible run with enough workers */
+    int64_t serial_us;          /*!< Sum of the times of the steps: the run with one worker */
+    uint8_t failed_num;
+    uint8_t skipped_num;
+} boot_graph_result_t;
+
+typedef struct boot_graph_t boot_graph_t;
+
+/**
+ * @brief Create an empty graph.
+ *
+ * @return The graph, NULL if out of memory
+ */
+boot_graph_t *boot_graph_new(void);
+
+/**
+ * @brief Delete a graph.
+ *
+ * @param graph The graph, can be NULL
+ */
+void boot_graph_del(boot_graph_t *graph);
+
+/**
+ * @brief Add a step.
+ *
+ * The dependencies are the names of other steps separated by commas, e.g. `"display, codec"`. They can be added
+ * before or after this step. A name starting with `?` only orders the steps: this step runs after it is finished,
+ * even if it failed.
+ *
+ * @param graph The graph
+ * @param name Name of the step, the string is kept
+ * @param func Function of the step
+ * @param arg Argument of the function
+ * @param deps Dependencies, NULL or "" for none. The string is kept
+ *
+ * @return
+ *    - 0: Success
+ *    - -1: Invalid argument, duplicated name or too many steps
+ */
+int boot_graph_add(boot_graph_t *graph, const char *name, boot_graph_func_t func, void *arg, const char *deps);
+
+/**
+ * @brief Run all the steps and wait for them. A graph can be run once.
+ *
+ * Among the steps which are ready, the one added first runs first.
+ *
+ * @param graph The graph
+ * @param config The configuration, NULL for `BOOT_GRAPH_DEFAULT_CONFIG()`
+ * @param result The times of the run, can be NULL
+ *
+ * @return
+ *    - 0: All the steps are done
+ *    - >0: Number of the steps which failed or were skipped
+ *    - -1: The graph is invalid (unknown dependency, cycle) or the workers can't be started, no step was run
+ */
+int boot_graph_run(boot_graph_t *graph, const boot_graph_config_t *config, boot_graph_result_t *result);
+
+/**
+ * @brief Get the state and the times of a step after the run.
+ *
+ * @param graph The graph
+ * @param name Name of the step
+ * @param info The information of the step
+ *
+ * @return
+ *    - 0: Success
+ *    - -1: Unknown step
+ */
+int boot_graph_get_step(const boot_graph_t *graph, const char *name, boot_graph_step_info_t *info);
+
+/**
+ * @brief Log the timeline of the run: when and on which worker each step ran, and the critical path.
+ *
+ * @param graph The graph
+ */
+void boot_graph_print_timeline(const boot_graph_t *graph);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,463 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "boot_graph.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#define BOOT_GRAPH_LOGI(format, ...)    ESP_LOGI(TAG, format, ##__VA_ARGS__)
+#define BOOT_GRAPH_LOGE(format, ...)    ESP_LOGE(TAG, format, ##__VA_ARGS__)
+#else
+#define BOOT_GRAPH_LOGI(format, ...)    printf("[%s] " format "\n", TAG, ##__VA_ARGS__)
+#define BOOT_GRAPH_LOGE(format, ...)    fprintf(stderr, "[%s] " format "\n", TAG, ##__VA_ARGS__)
+#endif
+
+#define BOOT_GRAPH_NAME_LEN_MAX     (32)
+
+typedef struct {
+    const char *name;
+    boot_graph_func_t func;
+    void *arg;
+    const char *deps_str;
+    /* Resolved from `deps_str` when the graph is run */
+    uint8_t dep_num;
+    uint8_t deps[BOOT_GRAPH_DEP_MAX];
+    bool dep_optional[BOOT_GRAPH_DEP_MAX];
+    /* Guarded by the lock of the graph while it runs */
+    boot_graph_step_state_t state;
+    int result;
+    int8_t worker;
+    int64_t start_us;
+    int64_t end_us;
+    /* Computed after the run */
+    int64_t path_us;
+    int8_t path_prev;
+    bool critical;
+} boot_graph_step_t;
+
+typedef struct {
+    boot_graph_t *graph;
+    int8_t index;
+} boot_graph_worker_t;
+
+struct boot_graph_t {
+    boot_graph_step_t steps[BOOT_GRAPH_STEP_MAX];
+    uint8_t step_num;
+    uint8_t worker_num;
+    uint8_t finished_num;
+    bool ran;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int64_t start_us;
+    boot_graph_result_t result;
+};
+
+static const char *TAG = "boot_graph";
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int find_step(const boot_graph_t *graph, const char *name, size_t len)
+{
+    for (int i = 0; i < graph->step_num; i++) {
+        if ((strncmp(graph->steps[i].name, name, len) == 0) && (graph->steps[i].name[len] == '\0')) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+boot_graph_t *boot_graph_new(void)
+{
+    boot_graph_t *graph = calloc(1, sizeof(boot_graph_t));
+    if (graph == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&graph->lock, NULL) != 0) {
+        free(graph);
+        return NULL;
+    }
+    if (pthread_cond_init(&graph->cond, NULL) != 0) {
+        pthread_mutex_destroy(&graph->lock);
+        free(graph);
+        return NULL;
+    }
+
+    return graph;
+}
+
+void boot_graph_del(boot_graph_t *graph)
+{
+    if (graph == NULL) {
+        return;
+    }
+    pthread_cond_destroy(&graph->cond);
+    pthread_mutex_destroy(&graph->lock);
+    free(graph);
+}
+
+int boot_graph_add(boot_graph_t *graph, const char *name, boot_graph_func_t func, void *arg, const char *deps)
+{
+    if ((graph == NULL) || (name == NULL) || (name[0] == '\0') || (strlen(name) > BOOT_GRAPH_NAME_LEN_MAX) ||
+            (func == NULL) || graph->ran) {
+        return -1;
+    }
+    if (graph->step_num >= BOOT_GRAPH_STEP_MAX) {
+        BOOT_GRAPH_LOGE("Too many steps, %s isn't added", name);
+        return -1;
+    }
+    if (find_step(graph, name, strlen(name)) >= 0) {
+        BOOT_GRAPH_LOGE("Step %s is added twice", name);
+        return -1;
+    }
+
+    boot_graph_step_t *step = &graph->steps[graph->step_num++];
+    step->name = name;
+    step->func = func;
+    step->arg = arg;
+    step->deps_str = deps ? deps : "";
+    step->worker = -1;
+
+    return 0;
+}
+
+static bool resolve_deps(boot_graph_t *graph)
+{
+    for (int i = 0; i < graph->step_num; i++) {
+        boot_graph_step_t *step = &graph->steps[i];
+        const char *p = step->deps_str;
+        step->dep_num = 0;
+
+        while (*p) {
+            while ((*p == ',') || isspace((unsigned char)*p)) {
+                p++;
+            }
+            if (*p == '\0') {
+                break;
+            }
+            bool optional = (*p == '?');
+            if (optional) {
+                p++;
+            }
+            const char *begin = p;
+            while (*p && (*p != ',') && !isspace((unsigned char)*p)) {
+                p++;
+            }
+
+            int dep = find_step(graph, begin, p - begin);
+            if ((dep < 0) || (dep == i)) {
+                BOOT_GRAPH_LOGE("Step %s depends on unknown step %.*s", step->name, (int)(p - begin), begin);
+                return false;
+            }
+            if (step->dep_num >= BOOT_GRAPH_DEP_MAX) {
+                BOOT_GRAPH_LOGE("Step %s has too many dependencies", step->name);
+                return false;
+            }
+            step->dep_optional[step->dep_num] = optional;
+            step->deps[step->dep_num++] = (uint8_t)dep;
+        }
+    }
+
+    return true;
+}
+
+/* Depth-first search, `mark` is 1 while a step is on the stack and 2 when it's checked */
+static bool has_cycle_from(const boot_graph_t *graph, int i, uint8_t *mark)
+{
+    if (mark[i] == 1) {
+        BOOT_GRAPH_LOGE("Dependency cycle through step %s", graph->steps[i].name);
+        return true;
+    }
+    if (mark[i] == 2) {
+        return false;
+    }
+    mark[i] = 1;
+    for (int d = 0; d < graph->steps[i].dep_num; d++) {
+        if (has_cycle_from(graph, graph->steps[i].deps[d], mark)) {
+            return true;
+        }
+    }
+    mark[i] = 2;
+
+    return false;
+}
+
+static bool is_finished(boot_graph_step_state_t state)
+{
+    return (state == BOOT_GRAPH_STEP_DONE) || (state == BOOT_GRAPH_STEP_FAILED) || (state == BOOT_GRAPH_STEP_SKIPPED);
+}
+
+/* With the lock taken: the first step which can run, skipping the ones whose required dependencies didn't succeed */
+static boot_graph_step_t *take_ready_step(boot_graph_t *graph)
+{
+    for (int i = 0; i < graph->step_num; i++) {
+        boot_graph_step_t *step = &graph->steps[i];
+        if (step->state != BOOT_GRAPH_STEP_PENDING) {
+            continue;
+        }
+
+        bool ready = true;
+        bool skip = false;
+        for (int d = 0; d < step->dep_num; d++) {
+            boot_graph_step_state_t dep_state = graph->steps[step->deps[d]].state;
+            if (!is_finished(dep_state)) {
+                ready = false;
+                break;
+            }
+            if (!step->dep_optional[d] && (dep_state != BOOT_GRAPH_STEP_DONE)) {
+                skip = true;
+            }
+        }
+        if (!ready) {
+            continue;
+        }
+        if (skip) {
+            step->state = BOOT_GRAPH_STEP_SKIPPED;
+            step->start_us = step->end_us = now_us() - graph->start_us;
+            graph->finished_num++;
+            /* The steps after it may be ready now */
+            pthread_cond_broadcast(&graph->cond);
+            i = -1;
+            continue;
+        }
+
+        return step;
+    }
+
+    return NULL;
+}
+
+static void *worker_main(void *arg)
+{
+    boot_graph_worker_t *worker = arg;
+    boot_graph_t *graph = worker->graph;
+
+    pthread_mutex_lock(&graph->lock);
+    while (graph->finished_num < graph->step_num) {
+        boot_graph_step_t *step = take_ready_step(graph);
+        if (step == NULL) {
+            if (graph->finished_num < graph->step_num) {
+                pthread_cond_wait(&graph->cond, &graph->lock);
+            }
+            continue;
+        }
+
+        step->state = BOOT_GRAPH_STEP_RUNNING;
+        step->worker = worker->index;
+        step->start_us = now_us() - graph->start_us;
+        pthread_mutex_unlock(&graph->lock);
+
+        int ret = step->func(step->arg);
+
+        pthread_mutex_lock(&graph->lock);
+        step->end_us = now_us() - graph->start_us;
+        step->result = ret;
+        step->state = (ret == 0) ? BOOT_GRAPH_STEP_DONE : BOOT_GRAPH_STEP_FAILED;
+        if (ret != 0) {
+            BOOT_GRAPH_LOGE("Step %s failed (%d)", step->name, ret);
+        }
+        graph->finished_num++;
+        pthread_cond_broadcast(&graph->cond);
+    }
+    pthread_mutex_unlock(&graph->lock);
+
+    return NULL;
+}
+
+/* The longest chain of measured times ending at each step, in dependency order */
+static void compute_paths(boot_graph_t *graph)
+{
+    boot_graph_result_t *result = &graph->result;
+    bool computed[BOOT_GRAPH_STEP_MAX] = {false};
+    int end = -1;
+
+    for (int n = 0; n < graph->step_num; n++) {
+        for (int i = 0; i < graph->step_num; i++) {
+            boot_graph_step_t *step = &graph->steps[i];
+            if (computed[i]) {
+                continue;
+            }
+            bool deps_computed = true;
+            for (int d = 0; d < step->dep_num; d++) {
+                deps_computed = deps_computed && computed[step->deps[d]];
+            }
+            if (!deps_computed) {
+                continue;
+            }
+
+            int64_t duration = step->end_us - step->start_us;
+            step->path_us = duration;
+            step->path_prev = -1;
+            for (int d = 0; d < step->dep_num; d++) {
+                boot_graph_step_t *dep = &graph->steps[step->deps[d]];
+                if (dep->path_us + duration > step->path_us) {
+                    step->path_us = dep->path_us + duration;
+                    step->path_prev = (int8_t)step->deps[d];
+                }
+            }
+            computed[i] = true;
+
+            result->serial_us += duration;
+            if ((end < 0) || (step->path_us > graph->steps[end].path_us)) {
+                end = i;
+            }
+            if (step->state == BOOT_GRAPH_STEP_FAILED) {
+                result->failed_num++;
+            } else if (step->state == BOOT_GRAPH_STEP_SKIPPED) {
+                result->skipped_num++;
+            }
+        }
+    }
+
+    for (int i = end; i >= 0; i = graph->steps[i].path_prev) {
+        graph->steps[i].critical = true;
+    }
+    result->critical_path_us = (end >= 0) ? graph->steps[end].path_us : 0;
+}
+
+int boot_graph_run(boot_graph_t *graph, const boot_graph_config_t *config, boot_graph_result_t *result)
+{
+    boot_graph_config_t default_config = BOOT_GRAPH_DEFAULT_CONFIG();
+
+    if ((graph == NULL) || graph->ran) {
+        return -1;
+    }
+    if (config == NULL) {
+        config = &default_config;
+    }
+    if ((config->worker_num == 0) || (config->worker_num > BOOT_GRAPH_WORKER_MAX)) {
+        BOOT_GRAPH_LOGE("Invalid number of workers: %d", config->worker_num);
+        return -1;
+    }
+    if (!resolve_deps(graph)) {
+        return -1;
+    }
+    uint8_t mark[BOOT_GRAPH_STEP_MAX] = {0};
+    for (int i = 0; i < graph->step_num; i++) {
+        if (has_cycle_from(graph, i, mark)) {
+            return -1;
+        }
+    }
+
+#ifdef ESP_PLATFORM
+    /* The workers aren't pinned, each step runs on the core which is free */
+    esp_pthread_cfg_t prev_cfg;
+    bool has_prev_cfg = (esp_pthread_get_cfg(&prev_cfg) == ESP_OK);
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = config->stack_size;
+    cfg.prio = config->priority;
+    cfg.thread_name = "boot";
+    cfg.pin_to_core = tskNO_AFFINITY;
+    esp_pthread_set_cfg(&cfg);
+#endif
+
+    pthread_t threads[BOOT_GRAPH_WORKER_MAX];
+    boot_graph_worker_t workers[BOOT_GRAPH_WORKER_MAX];
+    int started = 0;
+
+    graph->ran = true;
+    graph->worker_num = config->worker_num;
+    graph->start_us = now_us();
+    for (int i = 0; i < config->worker_num; i++) {
+        workers[i].graph = graph;
+        workers[i].index = (int8_t)i;
+        if (pthread_create(&threads[i], NULL, worker_main, &workers[i]) != 0) {
+            BOOT_GRAPH_LOGE("Start worker %d failed", i);
+            break;
+        }
+        started++;
+    }
+
+#ifdef ESP_PLATFORM
+    if (has_prev_cfg) {
+        esp_pthread_set_cfg(&prev_cfg);
+    } else {
+        esp_pthread_cfg_t restore_cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&restore_cfg);
+    }
+#endif
+
+    if (started == 0) {
+        return -1;
+    }
+    /* Fewer workers only take longer */
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    graph->result.total_us = now_us() - graph->start_us;
+    compute_paths(graph);
+    if (result) {
+        *result = graph->result;
+    }
+
+    return graph->result.failed_num + graph->result.skipped_num;
+}
+
+int boot_graph_get_step(const boot_graph_t *graph, const char *name, boot_graph_step_info_t *info)
+{
+    int i = find_step(graph, name, strlen(name));
+    if ((i < 0) || (info == NULL)) {
+        return -1;
+    }
+
+    const boot_graph_step_t *step = &graph->steps[i];
+    info->name = step->name;
+    info->state = step->state;
+    info->result = step->result;
+    info->worker = step->worker;
+    info->start_us = step->start_us;
+    info->end_us = step->end_us;
+    info->path_us = step->path_us;
+    info->critical = step->critical ? 1 : 0;
+
+    return 0;
+}
+
+void boot_graph_print_timeline(const boot_graph_t *graph)
+{
+    static const char *state_str[] = {"pending", "running", "done", "FAILED", "skipped"};
+    const boot_graph_result_t *result = &graph->result;
+
+    BOOT_GRAPH_LOGI("Boot timeline, %d workers: %lld ms, critical path %lld ms, serial %lld ms",
+                    graph->worker_num, (long long)(result->total_us / 1000), (long long)(result->critical_path_us / 1000),
+                    (long long)(result->serial_us / 1000));
+
+    /* In the order of the start times */
+    bool printed[BOOT_GRAPH_STEP_MAX] = {false};
+    for (int n = 0; n < graph->step_num; n++) {
+        int first = -1;
+        for (int i = 0; i < graph->step_num; i++) {
+            if (!printed[i] && ((first < 0) || (graph->steps[i].start_us < graph->steps[first].start_us))) {
+                first = i;
+            }
+        }
+        printed[first] = true;
+
+        const boot_graph_step_t *step = &graph->steps[first];
+        char worker[8] = "-";
+        if (step->worker >= 0) {
+            snprintf(worker, sizeof(worker), "w%d", step->worker);
+        }
+        BOOT_GRAPH_LOGI("%c %-3s %6lld.%03lld - %6lld.%03lld ms  %-20s %s", step->critical ? '*' : ' ', worker,
+                        (long long)(step->start_us / 1000), (long long)(step->start_us % 1000),
+                        (long long)(step->end_us / 1000), (long long)(step->end_us % 1000), step->name,
+                        state_str[step->state]);
+    }
+}
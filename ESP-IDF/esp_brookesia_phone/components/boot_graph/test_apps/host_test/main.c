@@ -0,0 +1,347 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * Run the boot graph with steps which sleep: the graph of the phone from `main/boot_steps.h` for the ordering and
+ * the critical path, and small graphs for the failures and the invalid graphs. See README.md.
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "boot_graph.h"
+#include "boot_steps.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+typedef struct {
+    const char *name;
+    const char *deps;
+    int ms;
+    int ret;
+} stub_step_t;
+
+static atomic_int run_num;
+
+static int stub_func(void *arg)
+{
+    const stub_step_t *step = arg;
+    struct timespec ts = {
+        .tv_sec = step->ms / 1000,
+        .tv_nsec = (long)(step->ms % 1000) * 1000000,
+    };
+
+    atomic_fetch_add(&run_num, 1);
+    nanosleep(&ts, NULL);
+
+    return step->ret;
+}
+
+/* Times of the phone steps in ms, about a tenth of the target's */
+static int phone_step_ms(const char *name)
+{
+    static const struct {
+        const char *name;
+        int ms;
+    } times[] = {
+        {"i2c", 2}, {"display", 60}, {"camera_probe", 80}, {"codec", 30}, {"nvs", 20}, {"spiffs", 40},
+        {"sdcard", 50}, {"stylesheet", 30}, {"phone_begin", 40}, {"app_squareline", 20},
+    };
+
+    for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        if (strcmp(times[i].name, name) == 0) {
+            return times[i].ms;
+        }
+    }
+
+    return 10;
+}
+
+#define PHONE_STEP(name, deps) {#name, deps, 0, 0},
+static stub_step_t phone_steps[] = {
+    BOOT_STEPS(PHONE_STEP)
+};
+#undef PHONE_STEP
+#define PHONE_STEP_NUM  (sizeof(phone_steps) / sizeof(phone_steps[0]))
+
+static boot_graph_t *new_graph(stub_step_t *steps, size_t num)
+{
+    boot_graph_t *graph = boot_graph_new();
+    if (graph == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < num; i++) {
+        if (boot_graph_add(graph, steps[i].name, stub_func, &steps[i], steps[i].deps) != 0) {
+            boot_graph_del(graph);
+            return NULL;
+        }
+    }
+
+    return graph;
+}
+
+/* Every step which ran started after the end of its dependencies */
+static bool check_order(const boot_graph_t *graph, const stub_step_t *steps, size_t num)
+{
+    for (size_t i = 0; i < num; i++) {
+        boot_graph_step_info_t info;
+        TEST_CHECK(boot_graph_get_step(graph, steps[i].name, &info) == 0, "No step %s", steps[i].name);
+        if (info.worker < 0) {
+            continue;
+        }
+
+        const char *p = steps[i].deps;
+        while (*p) {
+            while ((*p == ',') || (*p == ' ') || (*p == '?')) {
+                p++;
+            }
+            char dep_name[32] = {0};
+            size_t len = strcspn(p, ", ");
+            if (len == 0) {
+                break;
+            }
+            memcpy(dep_name, p, len);
+            p += len;
+
+            boot_graph_step_info_t dep;
+            TEST_CHECK(boot_graph_get_step(graph, dep_name, &dep) == 0, "No step %s", dep_name);
+            TEST_CHECK(info.start_us >= dep.end_us, "%s started at %lld us before the end of %s at %lld us",
+                       steps[i].name, (long long)info.start_us, dep_name, (long long)dep.end_us);
+        }
+    }
+
+    return true;
+}
+
+static bool run_phone_graph(uint8_t worker_num, boot_graph_result_t *result)
+{
+    for (size_t i = 0; i < PHONE_STEP_NUM; i++) {
+        phone_steps[i].ms = phone_step_ms(phone_steps[i].name);
+        phone_steps[i].ret = 0;
+    }
+
+    boot_graph_t *graph = new_graph(phone_steps, PHONE_STEP_NUM);
+    TEST_CHECK(graph, "Create graph failed");
+
+    boot_graph_config_t config = BOOT_GRAPH_DEFAULT_CONFIG();
+    config.worker_num = worker_num;
+    int ret = boot_graph_run(graph, &config, result);
+    boot_graph_print_timeline(graph);
+    bool ok = (ret == 0) && check_order(graph, phone_steps, PHONE_STEP_NUM);
+
+    /* The apps are installed in the order of the launcher */
+    int64_t prev_start = -1;
+    for (size_t i = 0; ok && (i < PHONE_STEP_NUM); i++) {
+        boot_graph_step_info_t info;
+        if (strncmp(phone_steps[i].name, "app_", 4) == 0) {
+            boot_graph_get_step(graph, phone_steps[i].name, &info);
+            ok = (info.start_us >= prev_start);
+            prev_start = info.end_us;
+        }
+    }
+    boot_graph_del(graph);
+    TEST_CHECK(ok, "Run with %d workers failed (%d) or out of order", worker_num, ret);
+
+    return true;
+}
+
+static bool test_phone_parallel(void)
+{
+    boot_graph_result_t result;
+    if (!run_phone_graph(3, &result)) {
+        return false;
+    }
+
+    /* Enough workers: the boot takes the critical path, plus the scheduling */
+    TEST_CHECK(result.total_us >= result.critical_path_us, "Total %lld us is shorter than the critical path %lld us",
+               (long long)result.total_us, (long long)result.critical_path_us);
+    TEST_CHECK(result.total_us < result.critical_path_us * 11 / 10 + 5000,
+               "Total %lld us is too long for the critical path %lld us", (long long)result.total_us,
+               (long long)result.critical_path_us);
+    TEST_CHECK(result.total_us < result.serial_us * 2 / 3, "Total %lld us isn't shorter than serial %lld us",
+               (long long)result.total_us, (long long)result.serial_us);
+
+    return true;
+}
+
+static bool test_phone_two_workers(void)
+{
+    boot_graph_result_t result;
+    if (!run_phone_graph(2, &result)) {
+        return false;
+    }
+
+    TEST_CHECK(result.total_us < result.serial_us * 3 / 4, "Total %lld us isn't shorter than serial %lld us",
+               (long long)result.total_us, (long long)result.serial_us);
+
+    return true;
+}
+
+static bool test_phone_serial(void)
+{
+    boot_graph_result_t result;
+    if (!run_phone_graph(1, &result)) {
+        return false;
+    }
+
+    /* One worker runs the steps one after another */
+    TEST_CHECK(result.total_us >= result.serial_us, "Total %lld us is shorter than serial %lld us",
+               (long long)result.total_us, (long long)result.serial_us);
+    TEST_CHECK(result.total_us < result.serial_us * 11 / 10 + 5000, "Total %lld us is too long for serial %lld us",
+               (long long)result.total_us, (long long)result.serial_us);
+
+    return true;
+}
+
+static bool test_critical_path(void)
+{
+    /* Two chains: a -> b (50 ms) and c -> d (20 ms), e waits for both */
+    stub_step_t steps[] = {
+        {"a", "", 20, 0},
+        {"b", "a", 30, 0},
+        {"c", "", 10, 0},
+        {"d", "c", 10, 0},
+        {"e", "b, d", 10, 0},
+    };
+    boot_graph_t *graph = new_graph(steps, 5);
+    TEST_CHECK(graph, "Create graph failed");
+
+    boot_graph_result_t result;
+    TEST_CHECK(boot_graph_run(graph, NULL, &result) == 0, "Run failed");
+    TEST_CHECK(check_order(graph, steps, 5), "Out of order");
+    TEST_CHECK((result.critical_path_us >= 60000) && (result.critical_path_us < 66000), "Critical path %lld us",
+               (long long)result.critical_path_us);
+
+    static const char *critical[] = {"a", "b", "e"};
+    static const char *not_critical[] = {"c", "d"};
+    boot_graph_step_info_t info;
+    for (int i = 0; i < 3; i++) {
+        boot_graph_get_step(graph, critical[i], &info);
+        TEST_CHECK(info.critical, "%s isn't critical", critical[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        boot_graph_get_step(graph, not_critical[i], &info);
+        TEST_CHECK(!info.critical, "%s is critical", not_critical[i]);
+    }
+    boot_graph_get_step(graph, "e", &info);
+    TEST_CHECK(info.path_us == result.critical_path_us, "Path of e %lld us", (long long)info.path_us);
+    boot_graph_del(graph);
+
+    return true;
+}
+
+static bool test_failure(void)
+{
+    /* b requires a which fails, so b and d are skipped. c only runs after a */
+    stub_step_t steps[] = {
+        {"a", "", 5, -1},
+        {"b", "a", 5, 0},
+        {"c", "?a", 5, 0},
+        {"d", "b, c", 5, 0},
+        {"e", "?d", 5, 0},
+    };
+    boot_graph_t *graph = new_graph(steps, 5);
+    TEST_CHECK(graph, "Create graph failed");
+
+    boot_graph_result_t result;
+    atomic_store(&run_num, 0);
+    TEST_CHECK(boot_graph_run(graph, NULL, &result) == 3, "Not 3 steps failed or skipped");
+    TEST_CHECK((result.failed_num == 1) && (result.skipped_num == 2), "%d failed, %d skipped", result.failed_num,
+               result.skipped_num);
+    TEST_CHECK(atomic_load(&run_num) == 3, "%d steps ran", atomic_load(&run_num));
+    TEST_CHECK(check_order(graph, steps, 5), "Out of order");
+
+    static const boot_graph_step_state_t states[] = {
+        BOOT_GRAPH_STEP_FAILED, BOOT_GRAPH_STEP_SKIPPED, BOOT_GRAPH_STEP_DONE, BOOT_GRAPH_STEP_SKIPPED,
+        BOOT_GRAPH_STEP_DONE,
+    };
+    for (int i = 0; i < 5; i++) {
+        boot_graph_step_info_t info;
+        boot_graph_get_step(graph, steps[i].name, &info);
+        TEST_CHECK(info.state == states[i], "State of %s is %d", steps[i].name, info.state);
+        TEST_CHECK((info.state == BOOT_GRAPH_STEP_SKIPPED) == (info.worker < 0), "Worker of %s is %d",
+                   steps[i].name, info.worker);
+    }
+    boot_graph_step_info_t info;
+    boot_graph_get_step(graph, "a", &info);
+    TEST_CHECK(info.result == -1, "Result of a is %d", info.result);
+    boot_graph_del(graph);
+
+    return true;
+}
+
+static bool test_invalid(void)
+{
+    boot_graph_result_t result;
+    stub_step_t unknown[] = {
+        {"a", "", 1, 0},
+        {"b", "a, c", 1, 0},
+    };
+    stub_step_t cycle[] = {
+        {"a", "", 1, 0},
+        {"b", "a, ?d", 1, 0},
+        {"c", "b", 1, 0},
+        {"d", "c", 1, 0},
+    };
+
+    atomic_store(&run_num, 0);
+    boot_graph_t *graph = new_graph(unknown, 2);
+    TEST_CHECK(graph, "Create graph failed");
+    TEST_CHECK(boot_graph_run(graph, NULL, &result) == -1, "Unknown dependency is run");
+    boot_graph_del(graph);
+
+    graph = new_graph(cycle, 4);
+    TEST_CHECK(graph, "Create graph failed");
+    TEST_CHECK(boot_graph_run(graph, NULL, &result) == -1, "Cycle is run");
+    boot_graph_del(graph);
+    TEST_CHECK(atomic_load(&run_num) == 0, "%d steps ran", atomic_load(&run_num));
+
+    graph = new_graph(unknown, 1);
+    TEST_CHECK(graph, "Create graph failed");
+    TEST_CHECK(boot_graph_add(graph, "a", stub_func, &unknown[0], "") == -1, "Duplicated step is added");
+    TEST_CHECK(boot_graph_add(graph, "b", NULL, NULL, "") == -1, "Step without function is added");
+    boot_graph_config_t config = BOOT_GRAPH_DEFAULT_CONFIG();
+    config.worker_num = BOOT_GRAPH_WORKER_MAX + 1;
+    TEST_CHECK(boot_graph_run(graph, &config, &result) == -1, "Too many workers are started");
+    TEST_CHECK(boot_graph_run(graph, NULL, &result) == 0, "Run failed");
+    TEST_CHECK(boot_graph_run(graph, NULL, &result) == -1, "Graph is run twice");
+    TEST_CHECK(atomic_load(&run_num) == 1, "%d steps ran", atomic_load(&run_num));
+    boot_graph_del(graph);
+
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"phone_parallel", test_phone_parallel},
+        {"phone_two_workers", test_phone_two_workers},
+        {"phone_serial", test_phone_serial},
+        {"critical_path", test_critical_path},
+        {"failure", test_failure},
+        {"invalid", test_invalid},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
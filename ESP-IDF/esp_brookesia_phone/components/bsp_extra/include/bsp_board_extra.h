@@ -33,6 +33,21 @@ extern "C" {
  * BSP Extra interface
  * Mainly provided some I2S Codec interfaces.
  **************************************************************************************************/
+/**
+ * @brief Tap of the data written to the player, it's called by `bsp_extra_i2s_write()` before the data is sent.
+ *
+ * It runs in the task of the audio player, so it must not block.
+ *
+ * @param audio_buffer: The written data, interleaved PCM
+ * @param len: Length of the data in bytes
+ * @param sample_rate: Sample rate of the player
+ * @param bits: Bits per sample
+ * @param channels: Number of channels
+ * @param user_data: User data of the tap
+ */
+typedef void (*bsp_extra_i2s_write_tap_t)(const void *audio_buffer, size_t len, uint32_t sample_rate, uint8_t bits,
+                                          uint8_t channels, void *user_data);
+
 /**
  * @brief Player set mute.
  *
@@ -124,6 +139,13 @@ esp_err_t bsp_extra_i2s_read(void *audio_buffer, size_t len, size_t *bytes_read,
  */
 esp_err_t bsp_extra_i2s_write(void *audio_buffer, size_t len, size_t *bytes_written, uint32_t timeout_ms);
 
+/**
+ * @brief Register the tap of the data written to the player, e.g. to analyze the played audio.
+ *
+ * @param tap: The tap, NULL to remove it
+ * @param user_data: User data passed to the tap
+ */
+void bsp_extra_i2s_write_tap_register(bsp_extra_i2s_write_tap_t tap, void *user_data);
 
 /**
  * @brief Initialize codec play and record handle.
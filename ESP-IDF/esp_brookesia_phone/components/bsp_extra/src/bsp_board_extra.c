@@ -30,6 +30,14 @@ static bool _is_audio_init = false;
 static bool _is_player_init = false;
 static int _vloume_intensity = CODEC_DEFAULT_VOLUME;
 
+static esp_codec_dev_sample_info_t play_fs = {
+    .sample_rate = CODEC_DEFAULT_SAMPLE_RATE,
+    .channel = CODEC_DEFAULT_CHANNEL,
+    .bits_per_sample = CODEC_DEFAULT_BIT_WIDTH,
+};
+static bsp_extra_i2s_write_tap_t volatile i2s_write_tap = NULL;
+static void *volatile i2s_write_tap_user_data = NULL;
+
 static audio_player_cb_t audio_idle_callback = NULL;
 static void *audio_idle_cb_user_data = NULL;
 static char audio_file_path[128];
@@ -74,11 +82,22 @@ esp_err_t bsp_extra_i2s_read(void *audio_buffer, size_t len, size_t *bytes_read,
 esp_err_t bsp_extra_i2s_write(void *audio_buffer, size_t len, size_t *bytes_written, uint32_t timeout_ms)
 {
     esp_err_t ret = ESP_OK;
+    bsp_extra_i2s_write_tap_t tap = i2s_write_tap;
+    if (tap) {
+        tap(audio_buffer, len, play_fs.sample_rate, play_fs.bits_per_sample, play_fs.channel, i2s_write_tap_user_data);
+    }
     ret = esp_codec_dev_write(play_dev_handle, audio_buffer, len);
     *bytes_written = len;
     return ret;
 }
 
+void bsp_extra_i2s_write_tap_register(bsp_extra_i2s_write_tap_t tap, void *user_data)
+{
+    i2s_write_tap = NULL;
+    i2s_write_tap_user_data = user_data;
+    i2s_write_tap = tap;
+}
+
 esp_err_t bsp_extra_codec_set_fs(uint32_t rate, uint32_t bits_cfg, i2s_slot_mode_t ch)
 {
     esp_err_t ret = ESP_OK;
@@ -100,6 +119,7 @@ esp_err_t bsp_extra_codec_set_fs(uint32_t rate, uint32_t bits_cfg, i2s_slot_mode
 
     if (play_dev_handle) {
         ret |= esp_codec_dev_open(play_dev_handle, &fs);
+        play_fs = fs;
     }
     if (record_dev_handle) {
         ret |= esp_codec_dev_open(record_dev_handle, &fs);
@@ -126,6 +146,7 @@ esp_err_t bsp_extra_codec_set_fs_play(uint32_t rate, uint32_t bits_cfg, i2s_slot
 
     if (play_dev_handle) {
         ret |= esp_codec_dev_open(play_dev_handle, &fs);
+        play_fs = fs;
     }
 
     ESP_LOGI(TAG,"ret = 0x%x , %s",ret,strerror(ret));
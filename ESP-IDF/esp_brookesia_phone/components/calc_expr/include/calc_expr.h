@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The expression of a calculator, typed one key at a time. The tokens of the formula are kept with its text, and the
+ * tokens which are complete are already reduced by a shunting-yard evaluator, with the precedences of `+ -`, `x /`,
+ * the unary minus and `^` (right associative). So a key updates the formula and its value without parsing the text
+ * again, and without allocating: the expression is allocated once, by `calc_expr_new()`.
+ *
+ * The keys are:
+ * - "0" to "9" and ".": a number, a `0` is added before a lonely dot
+ * - "+", "-", "x", "/", "^": an operator, it replaces the previous one, "-" is also the unary minus
+ * - "%": divides the operand before it by 100
+ * - "(", ")", "pi"
+ * - "sqrt", "sin", "cos", "tan", "ln", "log": a function, its parenthesis is opened with it
+ *
+ * A `x` is added between an operand and a number, a parenthesis, a function or "pi" which follows it.
+ */
+
+#define CALC_EXPR_TOKEN_MAX         (64)
+#define CALC_EXPR_TEXT_LEN_MAX      (256)
+#define CALC_EXPR_NUM_LEN_MAX       (15)
+
+#define CALC_EXPR_OK                (0)
+#define CALC_EXPR_ERR_INVALID       (-1)
+#define CALC_EXPR_ERR_EMPTY         (-2)    /*!< There is no operand yet */
+#define CALC_EXPR_ERR_MATH          (-3)    /*!< Division by zero, out of the domain of a function, or overflow */
+
+typedef struct calc_expr_t calc_expr_t;
+
+/**
+ * @brief Create an empty expression.
+ *
+ * @return The expression, NULL if out of memory
+ */
+calc_expr_t *calc_expr_new(void);
+
+/**
+ * @brief Delete an expression.
+ *
+ * @param expr The expression, can be NULL
+ */
+void calc_expr_del(calc_expr_t *expr);
+
+/**
+ * @brief Empty an expression.
+ *
+ * @param expr The expression
+ */
+void calc_expr_clear(calc_expr_t *expr);
+
+/**
+ * @brief Type a key.
+ *
+ * @param expr The expression
+ * @param key The key
+ *
+ * @return true if the key is added, false if it's unknown, not allowed here, or the expression is full
+ */
+bool calc_expr_input(calc_expr_t *expr, const char *key);
+
+/**
+ * @brief Remove the last character of a number, or the last token.
+ *
+ * @param expr The expression
+ *
+ * @return true if something is removed
+ */
+bool calc_expr_backspace(calc_expr_t *expr);
+
+/**
+ * @brief Get the value of the expression as it's typed: the open parentheses are closed, and the operators and the
+ *        parentheses at its end, which have no operand yet, are left out.
+ *
+ * @param expr The expression
+ * @param value The value
+ *
+ * @return CALC_EXPR_OK, CALC_EXPR_ERR_EMPTY or CALC_EXPR_ERR_MATH
+ */
+int calc_expr_preview(calc_expr_t *expr, double *value);
+
+/**
+ * @brief Replace the expression by a value, after "=". It's an operand for the next operator, and it's replaced by
+ *        the next number, parenthesis, function or "pi".
+ *
+ * @param expr The expression
+ * @param value The value, a finite one
+ *
+ * @return CALC_EXPR_OK, or CALC_EXPR_ERR_INVALID
+ */
+int calc_expr_set_value(calc_expr_t *expr, double value);
+
+/**
+ * @brief Get the text of the formula, "0" if it's empty. The text is kept by the expression until its next change.
+ *
+ * @param expr The expression
+ *
+ * @return The text
+ */
+const char *calc_expr_get_text(const calc_expr_t *expr);
+
+/**
+ * @brief Format a value with up to 10 significant digits.
+ *
+ * @param value The value
+ * @param buf The buffer
+ * @param size The size of the buffer
+ */
+void calc_expr_format(double value, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
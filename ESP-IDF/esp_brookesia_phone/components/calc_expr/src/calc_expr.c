@@ -0,0 +1,525 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calc_expr.h"
+
+#ifndef M_PI
+#define M_PI                    (3.14159265358979323846)
+#endif
+
+typedef enum {
+    /* The operands, a number is pending while it's the last token since its digits can still change */
+    TOKEN_NUM = 0,
+    TOKEN_RESULT,
+    TOKEN_PI,
+    /* The binary operators, by precedence */
+    TOKEN_ADD,
+    TOKEN_SUB,
+    TOKEN_MUL,
+    TOKEN_DIV,
+    TOKEN_POW,
+    TOKEN_NEG,
+    TOKEN_PERCENT,
+    TOKEN_LPAREN,
+    TOKEN_RPAREN,
+    /* The functions, which open a parenthesis */
+    TOKEN_SQRT,
+    TOKEN_SIN,
+    TOKEN_COS,
+    TOKEN_TAN,
+    TOKEN_LN,
+    TOKEN_LOG,
+} token_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint16_t offset;
+    double value;
+} token_t;
+
+/* The operands and the operators which are not reduced yet, one token pushes one of them at most */
+typedef struct {
+    double values[CALC_EXPR_TOKEN_MAX];
+    uint8_t ops[CALC_EXPR_TOKEN_MAX];
+    int value_num;
+    int op_num;
+} expr_stack_t;
+
+struct calc_expr_t {
+    token_t tokens[CALC_EXPR_TOKEN_MAX];
+    int token_num;
+    /* The tokens in the stack, all of them but a pending number */
+    int reduced_num;
+    int paren_depth;
+    expr_stack_t stack;
+    expr_stack_t preview;
+    char text[CALC_EXPR_TEXT_LEN_MAX];
+    int text_len;
+};
+
+typedef struct {
+    const char *key;
+    const char *text;
+    token_type_t type;
+} key_info_t;
+
+static const key_info_t key_infos[] = {
+    {"+", "+", TOKEN_ADD},
+    {"-", "-", TOKEN_SUB},
+    {"x", "x", TOKEN_MUL},
+    {"/", "/", TOKEN_DIV},
+    {"^", "^", TOKEN_POW},
+    {"%", "%", TOKEN_PERCENT},
+    {"(", "(", TOKEN_LPAREN},
+    {")", ")", TOKEN_RPAREN},
+    {"pi", "pi", TOKEN_PI},
+    {"sqrt", "sqrt(", TOKEN_SQRT},
+    {"sin", "sin(", TOKEN_SIN},
+    {"cos", "cos(", TOKEN_COS},
+    {"tan", "tan(", TOKEN_TAN},
+    {"ln", "ln(", TOKEN_LN},
+    {"log", "log(", TOKEN_LOG},
+};
+
+static inline bool is_pending(int type)
+{
+    return (type == TOKEN_NUM) || (type == TOKEN_RESULT);
+}
+
+static inline bool is_binary(int type)
+{
+    return (type >= TOKEN_ADD) && (type <= TOKEN_POW);
+}
+
+static inline bool is_open(int type)
+{
+    return (type == TOKEN_LPAREN) || (type >= TOKEN_SQRT);
+}
+
+/* The token can be followed by an operator */
+static inline bool is_operand_end(int type)
+{
+    return ((type >= 0) && (type <= TOKEN_PI)) || (type == TOKEN_PERCENT) || (type == TOKEN_RPAREN);
+}
+
+static inline int get_precedence(int type)
+{
+    switch (type) {
+    case TOKEN_ADD:
+    case TOKEN_SUB:
+        return 1;
+    case TOKEN_MUL:
+    case TOKEN_DIV:
+        return 2;
+    case TOKEN_NEG:
+        return 3;
+    case TOKEN_POW:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static void stack_reduce(expr_stack_t *stack)
+{
+    int op = stack->ops[--stack->op_num];
+
+    if (op == TOKEN_NEG) {
+        stack->values[stack->value_num - 1] = -stack->values[stack->value_num - 1];
+        return;
+    }
+
+    double b = stack->values[--stack->value_num];
+    double *a = &stack->values[stack->value_num - 1];
+    switch (op) {
+    case TOKEN_ADD:
+        *a += b;
+        break;
+    case TOKEN_SUB:
+        *a -= b;
+        break;
+    case TOKEN_MUL:
+        *a *= b;
+        break;
+    case TOKEN_DIV:
+        *a /= b;
+        break;
+    case TOKEN_POW:
+        *a = pow(*a, b);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Pop an open parenthesis, and apply its function */
+static void stack_close(expr_stack_t *stack)
+{
+    int op = stack->ops[--stack->op_num];
+    double *value = &stack->values[stack->value_num - 1];
+
+    switch (op) {
+    case TOKEN_SQRT:
+        *value = sqrt(*value);
+        break;
+    case TOKEN_SIN:
+        *value = sin(*value);
+        break;
+    case TOKEN_COS:
+        *value = cos(*value);
+        break;
+    case TOKEN_TAN:
+        *value = tan(*value);
+        break;
+    case TOKEN_LN:
+        *value = log(*value);
+        break;
+    case TOKEN_LOG:
+        *value = log10(*value);
+        break;
+    default:
+        break;
+    }
+}
+
+static void stack_push(expr_stack_t *stack, const token_t *token)
+{
+    int type = token->type;
+
+    if (type <= TOKEN_PI) {
+        stack->values[stack->value_num++] = token->value;
+    } else if (is_binary(type)) {
+        int precedence = get_precedence(type);
+        /* `^` is right associative, the other operators are left associative */
+        while ((stack->op_num > 0) && !is_open(stack->ops[stack->op_num - 1])) {
+            int top_precedence = get_precedence(stack->ops[stack->op_num - 1]);
+            if ((top_precedence < precedence) || ((top_precedence == precedence) && (type == TOKEN_POW))) {
+                break;
+            }
+            stack_reduce(stack);
+        }
+        stack->ops[stack->op_num++] = (uint8_t)type;
+    } else if (type == TOKEN_PERCENT) {
+        stack->values[stack->value_num - 1] /= 100;
+    } else if (type == TOKEN_RPAREN) {
+        while (!is_open(stack->ops[stack->op_num - 1])) {
+            stack_reduce(stack);
+        }
+        stack_close(stack);
+    } else {
+        stack->ops[stack->op_num++] = (uint8_t)type;
+    }
+}
+
+static inline token_t *get_last(calc_expr_t *expr)
+{
+    return (expr->token_num > 0) ? &expr->tokens[expr->token_num - 1] : NULL;
+}
+
+static inline int get_last_type(const calc_expr_t *expr)
+{
+    return (expr->token_num > 0) ? expr->tokens[expr->token_num - 1].type : -1;
+}
+
+static inline bool has_room(const calc_expr_t *expr, int token_num, int text_len)
+{
+    return (expr->token_num + token_num <= CALC_EXPR_TOKEN_MAX) &&
+           (expr->text_len + text_len < CALC_EXPR_TEXT_LEN_MAX);
+}
+
+static void push_token(calc_expr_t *expr, token_type_t type, const char *text, double value)
+{
+    int len = strlen(text);
+    token_t *token = &expr->tokens[expr->token_num];
+
+    /* The number before the token is complete now */
+    if (expr->reduced_num < expr->token_num) {
+        stack_push(&expr->stack, &expr->tokens[expr->reduced_num++]);
+    }
+
+    token->type = type;
+    token->len = (uint8_t)len;
+    token->offset = (uint16_t)expr->text_len;
+    token->value = value;
+    memcpy(&expr->text[expr->text_len], text, len + 1);
+    expr->text_len += len;
+    expr->token_num++;
+
+    if (is_open(type)) {
+        expr->paren_depth++;
+    } else if (type == TOKEN_RPAREN) {
+        expr->paren_depth--;
+    }
+    if (!is_pending(type)) {
+        stack_push(&expr->stack, token);
+        expr->reduced_num++;
+    }
+}
+
+static void pop_token(calc_expr_t *expr)
+{
+    token_t *token = get_last(expr);
+
+    expr->token_num--;
+    expr->text_len = token->offset;
+    expr->text[expr->text_len] = '\0';
+    if (is_open(token->type)) {
+        expr->paren_depth--;
+    } else if (token->type == TOKEN_RPAREN) {
+        expr->paren_depth++;
+    }
+    if (expr->reduced_num <= expr->token_num) {
+        return;
+    }
+
+    /* The stack can't be undone since the operators reduce it, so the tokens are pushed again */
+    int reduced_num = is_pending(get_last_type(expr)) ? (expr->token_num - 1) : expr->token_num;
+    expr->stack.value_num = 0;
+    expr->stack.op_num = 0;
+    for (int i = 0; i < reduced_num; i++) {
+        stack_push(&expr->stack, &expr->tokens[i]);
+    }
+    expr->reduced_num = reduced_num;
+}
+
+static bool input_digit(calc_expr_t *expr, char c)
+{
+    token_t *last = get_last(expr);
+
+    if ((last != NULL) && (last->type == TOKEN_NUM)) {
+        char *num = &expr->text[last->offset];
+        bool has_dot = (memchr(num, '.', last->len) != NULL);
+        if ((c == '.') && has_dot) {
+            return false;
+        }
+        /* A leading zero is replaced */
+        if ((last->len == 1) && (num[0] == '0') && (c != '.')) {
+            num[0] = c;
+        } else {
+            if ((last->len >= CALC_EXPR_NUM_LEN_MAX) || !has_room(expr, 0, 1)) {
+                return false;
+            }
+            num[last->len++] = c;
+            num[last->len] = '\0';
+            expr->text_len++;
+        }
+        last->value = strtod(num, NULL);
+        return true;
+    }
+
+    char text[3] = {c, '\0', '\0'};
+    if (c == '.') {
+        text[0] = '0';
+        text[1] = '.';
+    }
+    bool need_mul = (last != NULL) && is_operand_end(last->type);
+    if (!has_room(expr, need_mul ? 2 : 1, need_mul ? 3 : 2)) {
+        return false;
+    }
+    if (need_mul) {
+        push_token(expr, TOKEN_MUL, "x", 0);
+    }
+    push_token(expr, TOKEN_NUM, text, strtod(text, NULL));
+    return true;
+}
+
+static bool input_token(calc_expr_t *expr, const key_info_t *info)
+{
+    int last_type = get_last_type(expr);
+    int type = info->type;
+    int len = strlen(info->text);
+
+    /* The unary minus follows an operator, an open parenthesis, or nothing */
+    if ((type == TOKEN_SUB) && !is_operand_end(last_type)) {
+        if (last_type == TOKEN_NEG) {
+            return false;
+        }
+        type = TOKEN_NEG;
+    }
+
+    if (is_binary(type)) {
+        if (is_binary(last_type)) {
+            pop_token(expr);
+        } else if (last_type < 0) {
+            if (!has_room(expr, 2, len + 2)) {
+                return false;
+            }
+            push_token(expr, TOKEN_NUM, "0", 0);
+        } else if (!is_operand_end(last_type)) {
+            return false;
+        }
+    } else if ((type == TOKEN_PERCENT) || (type == TOKEN_RPAREN)) {
+        if (!is_operand_end(last_type)) {
+            return false;
+        }
+        if ((type == TOKEN_PERCENT) ? (last_type == TOKEN_PERCENT) : (expr->paren_depth == 0)) {
+            return false;
+        }
+    } else if ((type != TOKEN_NEG) && is_operand_end(last_type)) {
+        if (!has_room(expr, 2, len + 2)) {
+            return false;
+        }
+        push_token(expr, TOKEN_MUL, "x", 0);
+    }
+
+    if (!has_room(expr, 1, len + 1)) {
+        return false;
+    }
+    push_token(expr, type, info->text, (type == TOKEN_PI) ? M_PI : 0);
+    return true;
+}
+
+calc_expr_t *calc_expr_new(void)
+{
+    calc_expr_t *expr = calloc(1, sizeof(calc_expr_t));
+
+    return expr;
+}
+
+void calc_expr_del(calc_expr_t *expr)
+{
+    free(expr);
+}
+
+void calc_expr_clear(calc_expr_t *expr)
+{
+    expr->token_num = 0;
+    expr->reduced_num = 0;
+    expr->paren_depth = 0;
+    expr->stack.value_num = 0;
+    expr->stack.op_num = 0;
+    expr->text[0] = '\0';
+    expr->text_len = 0;
+}
+
+bool calc_expr_input(calc_expr_t *expr, const char *key)
+{
+    if ((expr == NULL) || (key == NULL)) {
+        return false;
+    }
+
+    bool is_digit = ((key[0] >= '0') && (key[0] <= '9')) || (key[0] == '.');
+    if (is_digit && (key[1] != '\0')) {
+        return false;
+    }
+
+    const key_info_t *info = NULL;
+    if (!is_digit) {
+        for (size_t i = 0; i < sizeof(key_infos) / sizeof(key_infos[0]); i++) {
+            if (strcmp(key, key_infos[i].key) == 0) {
+                info = &key_infos[i];
+                break;
+            }
+        }
+        if (info == NULL) {
+            return false;
+        }
+    }
+
+    /* A result is replaced by a new operand, and continued by an operator */
+    if ((get_last_type(expr) == TOKEN_RESULT) && (is_digit || (info->type == TOKEN_PI) || is_open(info->type))) {
+        calc_expr_clear(expr);
+    }
+
+    return is_digit ? input_digit(expr, key[0]) : input_token(expr, info);
+}
+
+bool calc_expr_backspace(calc_expr_t *expr)
+{
+    token_t *last = get_last(expr);
+
+    if (last == NULL) {
+        return false;
+    }
+
+    if ((last->type == TOKEN_NUM) && (last->len > 1)) {
+        char *num = &expr->text[last->offset];
+        num[--last->len] = '\0';
+        expr->text_len--;
+        last->value = strtod(num, NULL);
+    } else {
+        pop_token(expr);
+    }
+    return true;
+}
+
+int calc_expr_preview(calc_expr_t *expr, double *value)
+{
+    if ((expr == NULL) || (value == NULL)) {
+        return CALC_EXPR_ERR_INVALID;
+    }
+
+    /* Only the used part of the stack is copied, its depth is the one of the nesting, not the length */
+    expr_stack_t *preview = &expr->preview;
+    preview->value_num = expr->stack.value_num;
+    preview->op_num = expr->stack.op_num;
+    memcpy(preview->values, expr->stack.values, preview->value_num * sizeof(double));
+    memcpy(preview->ops, expr->stack.ops, preview->op_num);
+    if (expr->reduced_num < expr->token_num) {
+        stack_push(preview, &expr->tokens[expr->reduced_num]);
+    }
+
+    /* The operators and the parentheses at the end are the top of the stack, since none of them reduced it */
+    for (int i = expr->token_num - 1; i >= 0; i--) {
+        int type = expr->tokens[i].type;
+        if (!is_binary(type) && (type != TOKEN_NEG) && !is_open(type)) {
+            break;
+        }
+        preview->op_num--;
+    }
+    if (preview->value_num == 0) {
+        return CALC_EXPR_ERR_EMPTY;
+    }
+
+    while (preview->op_num > 0) {
+        if (is_open(preview->ops[preview->op_num - 1])) {
+            stack_close(preview);
+        } else {
+            stack_reduce(preview);
+        }
+    }
+    *value = preview->values[0];
+
+    return isfinite(*value) ? CALC_EXPR_OK : CALC_EXPR_ERR_MATH;
+}
+
+int calc_expr_set_value(calc_expr_t *expr, double value)
+{
+    if ((expr == NULL) || !isfinite(value)) {
+        return CALC_EXPR_ERR_INVALID;
+    }
+
+    char num[32];
+    char text[sizeof(num) + 3];
+    calc_expr_format(value, num, sizeof(num));
+    /* A negative result is in parentheses, so `^` after it is applied to all of it */
+    snprintf(text, sizeof(text), (value < 0) ? "(%s)" : "%s", num);
+
+    calc_expr_clear(expr);
+    push_token(expr, TOKEN_RESULT, text, value);
+
+    return CALC_EXPR_OK;
+}
+
+const char *calc_expr_get_text(const calc_expr_t *expr)
+{
+    return (expr->text_len > 0) ? expr->text : "0";
+}
+
+void calc_expr_format(double value, char *buf, size_t size)
+{
+    /* No "-0" */
+    if (value == 0) {
+        value = 0;
+    }
+    snprintf(buf, size, "%.10g", value);
+}
@@ -0,0 +1,507 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * Check the values of the expression, typed key by key, against a recursive descent parser of its text, on known
+ * formulas and on seeded random keys. Then count its allocations and measure a key against a parse. See README.md.
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "calc_expr.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+#define TEST_FUZZ_KEY_NUM       (500000)
+#define TEST_ALLOC_KEY_NUM      (100000)
+#define TEST_BENCH_KEY_NUM      (200000)
+
+#ifndef M_PI
+#define M_PI                    (3.14159265358979323846)
+#endif
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static int alloc_num = 0;
+
+void *__wrap_malloc(size_t size)
+{
+    alloc_num++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size)
+{
+    alloc_num++;
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    alloc_num++;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    __real_free(ptr);
+}
+
+static uint64_t rand_state = 0xca1c;
+
+/* xorshift64, the same keys on every host */
+static uint32_t test_rand(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 7;
+    rand_state ^= rand_state << 17;
+    return (uint32_t)(rand_state >> 32);
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* The reference: a recursive descent parser of the text, which leaves out what has no operand yet, like a preview */
+static bool ref_expr(const char **p, double *value);
+static bool ref_unary(const char **p, double *value);
+
+static bool ref_primary(const char **p, double *value)
+{
+    static const struct {
+        const char *name;
+        double (*func)(double);
+    } funcs[] = {
+        {"sqrt(", sqrt}, {"sin(", sin}, {"cos(", cos}, {"tan(", tan}, {"ln(", log}, {"log(", log10},
+    };
+
+    /* Not strtod() on the text, which reads "0x7" as a hexadecimal number */
+    size_t len = strspn(*p, "0123456789.");
+    if (len > 0) {
+        char num[CALC_EXPR_NUM_LEN_MAX + 1] = {};
+        memcpy(num, *p, (len < CALC_EXPR_NUM_LEN_MAX) ? len : CALC_EXPR_NUM_LEN_MAX);
+        *value = strtod(num, NULL);
+        *p += len;
+        return true;
+    }
+    if (strncmp(*p, "pi", 2) == 0) {
+        *p += 2;
+        *value = M_PI;
+        return true;
+    }
+
+    double (*func)(double) = NULL;
+    if (**p == '(') {
+        (*p)++;
+    } else {
+        size_t i = 0;
+        for (; i < sizeof(funcs) / sizeof(funcs[0]); i++) {
+            if (strncmp(*p, funcs[i].name, strlen(funcs[i].name)) == 0) {
+                break;
+            }
+        }
+        if (i == sizeof(funcs) / sizeof(funcs[0])) {
+            return false;
+        }
+        *p += strlen(funcs[i].name);
+        func = funcs[i].func;
+    }
+    bool has_value = ref_expr(p, value);
+    if (**p == ')') {
+        (*p)++;
+    }
+    if (has_value && (func != NULL)) {
+        *value = func(*value);
+    }
+    return has_value;
+}
+
+static bool ref_power(const char **p, double *value)
+{
+    if (!ref_primary(p, value)) {
+        return false;
+    }
+    while (**p == '%') {
+        (*p)++;
+        *value /= 100;
+    }
+    if (**p == '^') {
+        double exponent = 0;
+        (*p)++;
+        if (ref_unary(p, &exponent)) {
+            *value = pow(*value, exponent);
+        }
+    }
+    return true;
+}
+
+static bool ref_unary(const char **p, double *value)
+{
+    if (**p == '-') {
+        (*p)++;
+        if (!ref_unary(p, value)) {
+            return false;
+        }
+        *value = -*value;
+        return true;
+    }
+    return ref_power(p, value);
+}
+
+static bool ref_term(const char **p, double *value)
+{
+    if (!ref_unary(p, value)) {
+        return false;
+    }
+    while ((**p == 'x') || (**p == '/')) {
+        char op = *(*p)++;
+        double rhs = 0;
+        if (!ref_unary(p, &rhs)) {
+            break;
+        }
+        *value = (op == 'x') ? (*value * rhs) : (*value / rhs);
+    }
+    return true;
+}
+
+static bool ref_expr(const char **p, double *value)
+{
+    if (!ref_term(p, value)) {
+        return false;
+    }
+    while ((**p == '+') || (**p == '-')) {
+        char op = *(*p)++;
+        double rhs = 0;
+        if (!ref_term(p, &rhs)) {
+            break;
+        }
+        *value = (op == '+') ? (*value + rhs) : (*value - rhs);
+    }
+    return true;
+}
+
+static int ref_eval(const char *text, double *value)
+{
+    const char *p = text;
+
+    if (!ref_expr(&p, value)) {
+        return CALC_EXPR_ERR_EMPTY;
+    }
+    return isfinite(*value) ? CALC_EXPR_OK : CALC_EXPR_ERR_MATH;
+}
+
+/* Type the keys separated by spaces, "<" is a backspace */
+static bool type_keys(calc_expr_t *expr, const char *keys)
+{
+    char key[8];
+    bool all_added = true;
+
+    while (*keys != '\0') {
+        size_t len = strcspn(keys, " ");
+        memcpy(key, keys, len);
+        key[len] = '\0';
+        keys += len + ((keys[len] == ' ') ? 1 : 0);
+        all_added &= (strcmp(key, "<") == 0) ? calc_expr_backspace(expr) : calc_expr_input(expr, key);
+    }
+    return all_added;
+}
+
+static bool test_formulas(void)
+{
+    static const struct {
+        const char *keys;
+        const char *text;
+        int ret;
+        double value;
+    } cases[] = {
+        {"2 + 3 x 4", "2+3x4", CALC_EXPR_OK, 14},
+        {"8 - 3 - 2", "8-3-2", CALC_EXPR_OK, 3},
+        {"6 4 / 4 / 2", "64/4/2", CALC_EXPR_OK, 8},
+        {"2 ^ 3 ^ 2", "2^3^2", CALC_EXPR_OK, 512},
+        {"- 2 ^ 2", "-2^2", CALC_EXPR_OK, -4},
+        {"2 ^ - 1", "2^-1", CALC_EXPR_OK, 0.5},
+        {"2 x - 3", "2x-3", CALC_EXPR_OK, -6},
+        {"( 2 + 3 ) x 4", "(2+3)x4", CALC_EXPR_OK, 20},
+        {"2 ( 3 + 1", "2x(3+1", CALC_EXPR_OK, 8},
+        {"( 1 + 1 ) ( 2", "(1+1)x(2", CALC_EXPR_OK, 4},
+        {"5 0 + 1 0 %", "50+10%", CALC_EXPR_OK, 50.1},
+        {"( 5 + 5 ) %", "(5+5)%", CALC_EXPR_OK, 0.1},
+        {"1 0 / 4", "10/4", CALC_EXPR_OK, 2.5},
+        {"sqrt 1 6", "sqrt(16", CALC_EXPR_OK, 4},
+        {"sqrt 9 ) + log 1 0 0 0", "sqrt(9)+log(1000", CALC_EXPR_OK, 6},
+        {"cos 0 ) + ln 1", "cos(0)+ln(1", CALC_EXPR_OK, 1},
+        {"2 pi", "2xpi", CALC_EXPR_OK, 2 * M_PI},
+        {". 5 x 4", "0.5x4", CALC_EXPR_OK, 2},
+        {"2 +", "2+", CALC_EXPR_OK, 2},
+        {"2 + ( - sin", "2+(-sin(", CALC_EXPR_OK, 2},
+        {"1 / 0", "1/0", CALC_EXPR_ERR_MATH, 0},
+        {"sqrt - 1", "sqrt(-1", CALC_EXPR_ERR_MATH, 0},
+        {"ln 0", "ln(0", CALC_EXPR_ERR_MATH, 0},
+        {"( -", "(-", CALC_EXPR_ERR_EMPTY, 0},
+        {"", "0", CALC_EXPR_ERR_EMPTY, 0},
+    };
+
+    calc_expr_t *expr = calc_expr_new();
+    TEST_CHECK(expr != NULL, "no expression");
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double value = 0;
+        calc_expr_clear(expr);
+        TEST_CHECK(type_keys(expr, cases[i].keys), "keys `%s` refused", cases[i].keys);
+        TEST_CHECK(strcmp(calc_expr_get_text(expr), cases[i].text) == 0, "keys `%s`: text %s, expected %s",
+                   cases[i].keys, calc_expr_get_text(expr), cases[i].text);
+        int ret = calc_expr_preview(expr, &value);
+        TEST_CHECK(ret == cases[i].ret, "%s: ret %d, expected %d", cases[i].text, ret, cases[i].ret);
+        TEST_CHECK((ret != CALC_EXPR_OK) || (fabs(value - cases[i].value) < 1e-12), "%s = %.17g, expected %.17g",
+                   cases[i].text, value, cases[i].value);
+    }
+
+    calc_expr_del(expr);
+    return true;
+}
+
+static bool test_editing(void)
+{
+    double value = 0;
+    char text[CALC_EXPR_TEXT_LEN_MAX];
+    calc_expr_t *expr = calc_expr_new();
+    TEST_CHECK(expr != NULL, "no expression");
+
+    /* Numbers */
+    TEST_CHECK(type_keys(expr, "0 0 7 . 2"), "number refused");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "7.2") == 0, "leading zero kept: %s", calc_expr_get_text(expr));
+    TEST_CHECK(!calc_expr_input(expr, "."), "second dot added");
+    TEST_CHECK(!calc_expr_input(expr, "12"), "unknown key added");
+    calc_expr_clear(expr);
+    for (int i = 0; i < CALC_EXPR_NUM_LEN_MAX; i++) {
+        TEST_CHECK(calc_expr_input(expr, "9"), "digit %d refused", i);
+    }
+    TEST_CHECK(!calc_expr_input(expr, "9"), "number longer than %d", CALC_EXPR_NUM_LEN_MAX);
+
+    /* Operators */
+    calc_expr_clear(expr);
+    TEST_CHECK(type_keys(expr, "+ 2 + x"), "operators refused");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "0+2x") == 0, "operator not replaced: %s", calc_expr_get_text(expr));
+    TEST_CHECK(calc_expr_input(expr, "-") && !calc_expr_input(expr, "-") && !calc_expr_input(expr, "x"),
+               "unary minus misplaced");
+    TEST_CHECK(!calc_expr_input(expr, ")") && !calc_expr_input(expr, "%"), "closing without operand");
+    calc_expr_clear(expr);
+    TEST_CHECK(type_keys(expr, "( 2 % )") && !calc_expr_input(expr, ")"), "parentheses unbalanced");
+    TEST_CHECK(!calc_expr_input(expr, "%") || !calc_expr_input(expr, "%"), "two percents");
+
+    /* Backspaces, through the tokens which reduced the stack */
+    calc_expr_clear(expr);
+    TEST_CHECK(type_keys(expr, "2 x 3 ^ 2 + 1 0"), "keys refused");
+    TEST_CHECK(type_keys(expr, "< < <"), "backspace refused");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "2x3^2") == 0, "text %s", calc_expr_get_text(expr));
+    TEST_CHECK((calc_expr_preview(expr, &value) == CALC_EXPR_OK) && (value == 18), "2x3^2 = %g", value);
+    TEST_CHECK(type_keys(expr, "< < - 4"), "keys refused");
+    TEST_CHECK((calc_expr_preview(expr, &value) == CALC_EXPR_OK) && (value == 2), "2x3-4 = %g", value);
+    TEST_CHECK(type_keys(expr, "< < < < <") && !calc_expr_backspace(expr), "not emptied");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "0") == 0, "empty text %s", calc_expr_get_text(expr));
+
+    /* Results */
+    TEST_CHECK(calc_expr_set_value(expr, -3) == CALC_EXPR_OK, "result refused");
+    TEST_CHECK(type_keys(expr, "^ 2"), "keys refused");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "(-3)^2") == 0, "text %s", calc_expr_get_text(expr));
+    TEST_CHECK((calc_expr_preview(expr, &value) == CALC_EXPR_OK) && (value == 9), "(-3)^2 = %g", value);
+    TEST_CHECK(calc_expr_set_value(expr, 1.0 / 3) == CALC_EXPR_OK, "result refused");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "0.3333333333") == 0, "text %s", calc_expr_get_text(expr));
+    TEST_CHECK((calc_expr_preview(expr, &value) == CALC_EXPR_OK) && (value == 1.0 / 3), "result %.17g", value);
+    TEST_CHECK(type_keys(expr, "5"), "digit refused");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), "5") == 0, "result not replaced: %s", calc_expr_get_text(expr));
+    TEST_CHECK(calc_expr_set_value(expr, 42) == CALC_EXPR_OK, "result refused");
+    TEST_CHECK(calc_expr_backspace(expr) && (strcmp(calc_expr_get_text(expr), "0") == 0), "result not removed");
+    TEST_CHECK(calc_expr_set_value(expr, NAN) == CALC_EXPR_ERR_INVALID, "NaN result");
+
+    /* Full */
+    calc_expr_clear(expr);
+    while (calc_expr_input(expr, "1") && calc_expr_input(expr, "+")) {
+    }
+    strcpy(text, calc_expr_get_text(expr));
+    TEST_CHECK(!calc_expr_input(expr, "(") && !calc_expr_input(expr, "pi"), "added to a full expression");
+    TEST_CHECK(strcmp(calc_expr_get_text(expr), text) == 0, "a full expression changed");
+    TEST_CHECK(calc_expr_preview(expr, &value) == CALC_EXPR_OK, "full expression not evaluated");
+
+    calc_expr_del(expr);
+    return true;
+}
+
+static const char *random_key(void)
+{
+    static const char *keys[] = {
+        "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+        ".", "+", "-", "-", "x", "/", "^", "%", "(", "(", ")", ")", ")", "pi",
+        "sqrt", "sin", "cos", "tan", "ln", "log", "<", "<", "<", "<", "C",
+    };
+    return keys[test_rand() % (sizeof(keys) / sizeof(keys[0]))];
+}
+
+static bool test_fuzz(void)
+{
+    char text[CALC_EXPR_TEXT_LEN_MAX];
+    int refused_num = 0;
+    int error_num = 0;
+    int max_len = 0;
+    calc_expr_t *expr = calc_expr_new();
+    TEST_CHECK(expr != NULL, "no expression");
+
+    for (int i = 0; i < TEST_FUZZ_KEY_NUM; i++) {
+        const char *key = random_key();
+        bool added = true;
+        strcpy(text, calc_expr_get_text(expr));
+        if (strcmp(key, "C") == 0) {
+            calc_expr_clear(expr);
+        } else if (strcmp(key, "<") == 0) {
+            added = calc_expr_backspace(expr);
+        } else {
+            added = calc_expr_input(expr, key);
+        }
+        if (!added) {
+            refused_num++;
+            TEST_CHECK(strcmp(calc_expr_get_text(expr), text) == 0, "key %d `%s` refused but %s changed to %s",
+                       i, key, text, calc_expr_get_text(expr));
+        }
+
+        const char *expr_text = calc_expr_get_text(expr);
+        int len = strlen(expr_text);
+        max_len = (len > max_len) ? len : max_len;
+
+        double value = 0;
+        double ref_value = 0;
+        int ret = calc_expr_preview(expr, &value);
+        int ref_ret = ref_eval(expr_text, &ref_value);
+        /* The empty expression has the text "0" */
+        if ((len == 1) && (expr_text[0] == '0')) {
+            continue;
+        }
+        TEST_CHECK(ret == ref_ret, "key %d `%s`: %s ret %d, reference %d", i, key, expr_text, ret, ref_ret);
+        TEST_CHECK((ret != CALC_EXPR_OK) || (value == ref_value), "key %d `%s`: %s = %.17g, reference %.17g",
+                   i, key, expr_text, value, ref_value);
+        /* Most of the keys don't change a math error, so it's often cleared */
+        if ((ret == CALC_EXPR_ERR_MATH) && (test_rand() % 4 == 0)) {
+            error_num++;
+            calc_expr_clear(expr);
+        }
+    }
+    printf("%d keys: %d refused, %d math errors cleared, %d characters at most\n", TEST_FUZZ_KEY_NUM, refused_num,
+           error_num, max_len);
+
+    calc_expr_del(expr);
+    return true;
+}
+
+static bool test_allocs(void)
+{
+    double value = 0;
+
+    int start_num = alloc_num;
+    calc_expr_t *expr = calc_expr_new();
+    TEST_CHECK(expr != NULL, "no expression");
+    int new_num = alloc_num - start_num;
+
+    start_num = alloc_num;
+    for (int i = 0; i < TEST_ALLOC_KEY_NUM; i++) {
+        const char *key = random_key();
+        if (strcmp(key, "C") == 0) {
+            calc_expr_set_value(expr, value);
+        } else if (strcmp(key, "<") == 0) {
+            calc_expr_backspace(expr);
+        } else {
+            calc_expr_input(expr, key);
+        }
+        if (calc_expr_preview(expr, &value) != CALC_EXPR_OK) {
+            value = 0;
+        }
+    }
+    int key_num = alloc_num - start_num;
+    printf("allocations: %d by calc_expr_new(), %d by %d keys and previews\n", new_num, key_num,
+           TEST_ALLOC_KEY_NUM);
+    TEST_CHECK(new_num == 1, "%d allocations to create the expression", new_num);
+    TEST_CHECK(key_num == 0, "%d allocations by the keys", key_num);
+
+    calc_expr_del(expr);
+    return true;
+}
+
+static bool test_key_bench(void)
+{
+    double value = 0;
+    double sum = 0;
+    calc_expr_t *expr = calc_expr_new();
+    TEST_CHECK(expr != NULL, "no expression");
+
+    /* A long formula, then a number at its end, typed and removed */
+    while (type_keys(expr, "1 2 . 5 x ( 3 + sin 4 ) ) ^ 2 - 7 / 9 +")) {
+    }
+    int token_len = strlen(calc_expr_get_text(expr));
+    TEST_CHECK(type_keys(expr, "< < < < < <"), "backspace refused");
+    TEST_CHECK(calc_expr_input(expr, "1"), "digit refused");
+
+    int64_t start_us = now_us();
+    for (int i = 0; i < TEST_BENCH_KEY_NUM; i++) {
+        calc_expr_input(expr, "2");
+        calc_expr_preview(expr, &value);
+        sum += value;
+        calc_expr_backspace(expr);
+    }
+    int64_t key_us = now_us() - start_us;
+
+    start_us = now_us();
+    for (int i = 0; i < TEST_BENCH_KEY_NUM; i++) {
+        ref_eval(calc_expr_get_text(expr), &value);
+        sum += value;
+    }
+    int64_t parse_us = now_us() - start_us;
+
+    double key_ns = (double)key_us * 1000 / TEST_BENCH_KEY_NUM / 2;
+    double parse_ns = (double)parse_us * 1000 / TEST_BENCH_KEY_NUM;
+    printf("formula of %d characters: %.0f ns per key and preview, %.0f ns per parse (%g)\n", token_len, key_ns,
+           parse_ns, sum);
+    TEST_CHECK(key_ns < parse_ns, "a key is not faster than a parse");
+
+    calc_expr_del(expr);
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"formulas", test_formulas},
+        {"editing", test_editing},
+        {"fuzz", test_fuzz},
+        {"allocs", test_allocs},
+        {"key_bench", test_key_bench},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -153,6 +153,15 @@ bool PhoneAppComplexConf::back(void)
 //     return true;
 // }
 
+// bool PhoneAppComplexConf::trimMemory()
+// {
+//     ESP_BROOKESIA_LOGD("Trim memory");
+
+//     /* Release the caches here if needed */
+
+//     return true;
+// }
+
 // bool PhoneAppComplexConf::cleanResource()
 // {
 //     ESP_BROOKESIA_LOGD("Clean resource");
@@ -89,6 +89,15 @@ bool PhoneAppSimpleConf::back(void)
 //     return true;
 // }
 
+// bool PhoneAppSimpleConf::trimMemory()
+// {
+//     ESP_BROOKESIA_LOGD("Trim memory");
+
+//     /* Release the caches here if needed */
+
+//     return true;
+// }
+
 // bool PhoneAppSimpleConf::cleanResource()
 // {
 //     ESP_BROOKESIA_LOGD("Clean resource");
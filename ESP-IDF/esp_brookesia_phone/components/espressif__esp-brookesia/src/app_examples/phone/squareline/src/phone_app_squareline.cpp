@@ -96,6 +96,15 @@ bool PhoneAppSquareline::deinit()
 //     return true;
 // }
 
+// bool PhoneAppSquareline::trimMemory()
+// {
+//     ESP_BROOKESIA_LOGD("Trim memory");
+
+//     /* Release the caches here if needed */
+
+//     return true;
+// }
+
 // bool PhoneAppSquareline::cleanResource()
 // {
 //     ESP_BROOKESIA_LOGD("Clean resource");
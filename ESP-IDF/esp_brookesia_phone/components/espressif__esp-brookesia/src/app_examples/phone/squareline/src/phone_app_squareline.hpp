@@ -131,6 +131,18 @@ protected:
      */
     // bool resume(void) override;
 
+    /**
+     * @brief Called when the app is paused and the system is short of memory. The app can release the caches which can
+     *        be rebuilt in the `resume()` function, such as decoded images and buffers.
+     *
+     * @note  If the memory is still not enough, the core will close the paused app. Its snapshot is kept in the recents
+     *        screen, and the `run()` function will be called again when it is resumed.
+     *
+     * @return true if successful, otherwise false
+     *
+     */
+    // bool trimMemory(void) override;
+
     /**
      * @brief Called when the app starts to close. The app can perform extra resource cleanup here.
      *
@@ -18,7 +18,8 @@ ESP_Brookesia_Core::ESP_Brookesia_Core(const ESP_Brookesia_CoreData_t &data, ESP
     _core_data(data),
     _core_home(home),
     _core_manager(manager),
-    _core_event(),
+    _core_event(&_core_ui_queue),
+    _core_ui_queue(),
     _display(display),
     _touch(nullptr),
     _free_event_code(_LV_EVENT_LAST),
@@ -235,6 +236,9 @@ bool ESP_Brookesia_Core::beginCore(void)
     _navigate_event_code = navigate_event_code;
     _app_event_code = app_event_code;
 
+    // Worker tasks update the UI through the queue, it's drained once per display refresh
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(_core_ui_queue.begin(LV_DISP_DEF_REFR_PERIOD), err, "Begin core UI queue failed");
+
     // Initialize cores
     ESP_BROOKESIA_CHECK_FALSE_GOTO(_core_home.beginCore(), err, "Begin core home failed");
     ESP_BROOKESIA_CHECK_FALSE_GOTO(_core_manager.beginCore(), err, "Begin core manager failed");
@@ -270,6 +274,10 @@ bool ESP_Brookesia_Core::delCore(void)
     _navigate_event_code = _LV_EVENT_LAST;
     _app_event_code = _LV_EVENT_LAST;
 
+    if (!_core_ui_queue.del()) {
+        ESP_BROOKESIA_LOGE("Delete core UI queue failed");
+        ret = false;
+    }
     if (!_core_home.delCore()) {
         ESP_BROOKESIA_LOGE("Delete core home failed");
         ret = false;
@@ -299,6 +307,12 @@ bool ESP_Brookesia_Core::calibrateCoreData(ESP_Brookesia_CoreData_t &data)
     // Home
     ESP_BROOKESIA_CHECK_FALSE_RETURN(_core_home.calibrateCoreData(data.home), false, "Invalid Core home data");
 
+    // Manager
+    if (data.manager.flags.enable_memory_pressure_check) {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(data.manager.memory.close_free_size <= data.manager.memory.trim_free_size,
+                                         false, "Invalid Core manager memory free size");
+    }
+
     return true;
 }
 
@@ -368,7 +368,7 @@ bool ESP_Brookesia_CoreApp::cleanRecordResource(void)
     return ret;
 }
 
-bool ESP_Brookesia_CoreApp::processInstall(ESP_Brookesia_Core *core, int id)
+bool ESP_Brookesia_CoreApp::processInstall(ESP_Brookesia_Core *core, int id, ESP_Brookesia_CoreAppInitMode_t init_mode)
 {
     ESP_BROOKESIA_CHECK_FALSE_RETURN(!checkInitialized(), false, "Already initialized");
     ESP_BROOKESIA_CHECK_NULL_RETURN(_core_init_data.name, false, "App name is invalid");
@@ -385,7 +385,11 @@ bool ESP_Brookesia_CoreApp::processInstall(ESP_Brookesia_Core *core, int id)
     _id = id;
 
     ESP_BROOKESIA_CHECK_FALSE_GOTO(beginExtra(), err, "Begin extra failed");
-    ESP_BROOKESIA_CHECK_FALSE_GOTO(init(), err, "Init failed");
+    if (init_mode == ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND) {
+        _flags.is_init_pending = true;
+    } else {
+        ESP_BROOKESIA_CHECK_FALSE_GOTO(processInit(), err, "Init failed");
+    }
 
     _status = ESP_BROOKESIA_CORE_APP_STATUS_CLOSED;
 
@@ -397,8 +401,26 @@ err:
     return false;
 }
 
+bool ESP_Brookesia_CoreApp::processInit(void)
+{
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not installed");
+    ESP_BROOKESIA_LOGD("App(%s: %d) init", getName(), _id);
+
+    uint32_t start_ms = lv_tick_get();
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(init(), false, "Init app(%s) failed", getName());
+    if (_flags.is_init_pending) {
+        ESP_BROOKESIA_LOGI("App(%s) initialized on demand in %d ms", getName(), (int)lv_tick_elaps(start_ms));
+    }
+    _flags.is_init_pending = false;
+    _flags.is_init_done = true;
+
+    return true;
+}
+
 bool ESP_Brookesia_CoreApp::processUninstall(void)
 {
+    bool is_init_done = _flags.is_init_done;
+
     ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
     ESP_BROOKESIA_LOGD("App(%s: %d) uninstall", getName(), _id);
 
@@ -426,7 +448,10 @@ bool ESP_Brookesia_CoreApp::processUninstall(void)
     _resource_anims.clear();
 
     ESP_BROOKESIA_CHECK_FALSE_RETURN(delExtra(), false, "Begin extra failed");
-    ESP_BROOKESIA_CHECK_FALSE_RETURN(deinit(), false, "Deinit failed");
+    // An app installed on demand which never ran has nothing to deinitialize
+    if (is_init_done) {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(deinit(), false, "Deinit failed");
+    }
 
     return true;
 }
@@ -438,6 +463,10 @@ bool ESP_Brookesia_CoreApp::processRun()
     ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
     ESP_BROOKESIA_LOGD("App(%s: %d) run", getName(), _id);
 
+    if (_flags.is_init_pending) {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(processInit(), false, "Init app before run failed");
+    }
+
     // TODO
     // if (_flags.is_screen_small) {
     //     // Create a temp screen to recolor the background
@@ -463,6 +492,7 @@ bool ESP_Brookesia_CoreApp::processRun()
     ESP_BROOKESIA_CHECK_FALSE_GOTO(ret, err, "App run failed");
 
     _status = ESP_BROOKESIA_CORE_APP_STATUS_RUNNING;
+    _flags.is_memory_trimmed = false;
 
     return true;
 
@@ -489,6 +519,7 @@ bool ESP_Brookesia_CoreApp::processResume(void)
     ESP_BROOKESIA_CHECK_FALSE_GOTO(endRecordResource(), err, "End record resource failed");
 
     _status = ESP_BROOKESIA_CORE_APP_STATUS_RUNNING;
+    _flags.is_memory_trimmed = false;
 
     return ret;
 
@@ -551,7 +582,11 @@ bool ESP_Brookesia_CoreApp::processClose(bool is_app_active)
             ESP_BROOKESIA_CHECK_FALSE_GOTO(cleanDefaultScreen(), err, "Clean active screen failed");
         }
     }
-    ESP_BROOKESIA_CHECK_FALSE_GOTO(loadDisplayTheme(), err, "Load display theme failed");
+    // The display theme was already loaded when the app was paused, and loading it again would replace the theme of
+    // the active app, e.g. when a paused app is evicted under memory pressure
+    if (is_app_active) {
+        ESP_BROOKESIA_CHECK_FALSE_GOTO(loadDisplayTheme(), err, "Load display theme failed");
+    }
 
     _flags.is_closing = false;
     _status = ESP_BROOKESIA_CORE_APP_STATUS_CLOSED;
@@ -564,6 +599,21 @@ err:
     return false;
 }
 
+bool ESP_Brookesia_CoreApp::processTrimMemory(void)
+{
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(_status == ESP_BROOKESIA_CORE_APP_STATUS_PAUSED, false, "App is not paused");
+    ESP_BROOKESIA_LOGD("App(%s: %d) trim memory", getName(), _id);
+
+    // Only trim once until the app is resumed
+    _flags.is_memory_trimmed = true;
+
+    ESP_BROOKESIA_LOGD("Do trim memory");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(trimMemory(), false, "Trim memory failed");
+
+    return true;
+}
+
 bool ESP_Brookesia_CoreApp::setVisualArea(const lv_area_t &area)
 {
     ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
@@ -59,6 +59,18 @@ public:
         return (_id > 0);
     }
 
+    /**
+     * @brief  Check if the `init()` function of the app is still to be called, when it's installed with
+     *         `ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND`
+     *
+     * @return true if the app is installed and not initialized yet, otherwise false
+     *
+     */
+    bool checkInitPending(void) const
+    {
+        return _flags.is_init_pending;
+    }
+
     /**
      * @brief Get the id. The id is assigned by the core when installed and is unique for each app.
      *
@@ -185,6 +197,9 @@ protected:
     /**
      * @brief Called when the app starts to install. The app can perform initialization here.
      *
+     * @note  If the app is installed with `ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND`, this function is called before the
+     *        first `run()`, or when the app is prewarmed. It's not called again if it succeeded
+     *
      * @return true if successful, otherwise false
      *
      */
@@ -236,6 +251,21 @@ protected:
         return true;
     }
 
+    /**
+     * @brief Called when the app is paused and the system is short of memory. The app can release the caches which can
+     *        be rebuilt in the `resume()` function, such as decoded images and buffers.
+     *
+     * @note  If the memory is still not enough, the core will close the paused app. Its snapshot is kept in the recents
+     *        screen, and the `run()` function will be called again when it is resumed.
+     *
+     * @return true if successful, otherwise false
+     *
+     */
+    virtual bool trimMemory(void)
+    {
+        return true;
+    }
+
     /**
      * @brief Called when the app starts to close. The app can perform extra resource cleanup here.
      *
@@ -319,12 +349,14 @@ protected:
 private:
     virtual bool beginExtra(void) { return true; }
     virtual bool delExtra(void)   { return true; }
-    virtual bool processInstall(ESP_Brookesia_Core *core, int id);
+    virtual bool processInstall(ESP_Brookesia_Core *core, int id, ESP_Brookesia_CoreAppInitMode_t init_mode);
+    virtual bool processInit(void);
     virtual bool processUninstall(void);
     virtual bool processRun(void);
     virtual bool processResume(void);
     virtual bool processPause(void);
     virtual bool processClose(bool is_app_active);
+    virtual bool processTrimMemory(void);
 
     bool setVisualArea(const lv_area_t &area);
     bool calibrateVisualArea(void);
@@ -355,6 +387,9 @@ private:
         uint8_t is_closing: 1;
         uint8_t is_screen_small: 1;
         uint8_t is_resource_recording: 1;
+        uint8_t is_memory_trimmed: 1;
+        uint8_t is_init_pending: 1;
+        uint8_t is_init_done: 1;
     } _flags;
     struct {
         uint16_t w;
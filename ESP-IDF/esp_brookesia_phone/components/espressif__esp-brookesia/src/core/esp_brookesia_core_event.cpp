@@ -5,12 +5,17 @@
  */
 #include <algorithm>
 #include "esp_brookesia_core_utils.h"
+#include "esp_brookesia_core_ui_queue.hpp"
 #include "esp_brookesia_core_event.hpp"
 
 using namespace std;
 
-ESP_Brookesia_CoreEvent::ESP_Brookesia_CoreEvent():
-    _free_event_id(ID::CUSTOM)
+ESP_Brookesia_CoreEvent::ESP_Brookesia_CoreEvent(ESP_Brookesia_CoreUiQueue *post_queue):
+    _free_event_id(ID::CUSTOM),
+    _bucket_used_num(0),
+    _dispatch_depth(0),
+    _has_unregistered_entries(false),
+    _post_queue(post_queue)
 {
 }
 
@@ -33,85 +38,201 @@ ESP_Brookesia_CoreEvent::ID operator++(ESP_Brookesia_CoreEvent::ID &id, int)
     return old;
 }
 
+static inline size_t hash_key(void *object, ESP_Brookesia_CoreEvent::ID id)
+{
+    uint32_t key = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(object)) ^ (static_cast<uint32_t>(id) << 24);
+
+    key = (key ^ (key >> 16)) * 0x45d9f3b;
+    key = (key ^ (key >> 16)) * 0x45d9f3b;
+
+    return key ^ (key >> 16);
+}
+
+void ESP_Brookesia_CoreEvent::HandlerList::push(const Entry &entry)
+{
+    if (!more_entries.empty()) {
+        more_entries.push_back(entry);
+    } else if (num < INLINE_HANDLER_NUM) {
+        inline_entries[num] = entry;
+    } else {
+        more_entries.reserve(INLINE_HANDLER_NUM * 2);
+        more_entries.assign(inline_entries.begin(), inline_entries.end());
+        more_entries.push_back(entry);
+    }
+    num++;
+}
+
+void ESP_Brookesia_CoreEvent::HandlerList::erase(size_t i)
+{
+    // Keep the order of registration
+    if (!more_entries.empty()) {
+        more_entries.erase(more_entries.begin() + i);
+    } else {
+        for (size_t j = i; j + 1 < num; j++) {
+            inline_entries[j] = inline_entries[j + 1];
+        }
+    }
+    num--;
+}
+
 void ESP_Brookesia_CoreEvent::reset(void)
 {
+    ESP_BROOKESIA_CHECK_FALSE_EXIT(_dispatch_depth == 0, "Can't reset while sending an event");
+
     _free_event_id = ID::CUSTOM;
-    _event_handlers.clear();
     _available_event_ids.clear();
+    _lists.clear();
+    _free_lists.clear();
+    _buckets.clear();
+    _bucket_used_num = 0;
+    _id_handler_nums.clear();
+    // Keep the slots, so the handles of the removed handlers are still stale after the slots are reused
+    _free_slots.clear();
+    for (size_t i = _slots.size(); i > 0; i--) {
+        Slot &slot = _slots[i - 1];
+        if (slot.list != LIST_NONE) {
+            slot.list = LIST_NONE;
+            slot.generation = (slot.generation == UINT16_MAX) ? 1 : (slot.generation + 1);
+        }
+        _free_slots.push_back(i - 1);
+    }
+    _has_unregistered_entries = false;
 }
 
-bool ESP_Brookesia_CoreEvent::registerEvent(void *object, Handler handler, ID id, void *user_data)
+bool ESP_Brookesia_CoreEvent::registerEvent(void *object, Handler handler, ID id, void *user_data, Handle *handle)
 {
+    uint16_t list = LIST_NONE;
+    uint16_t index = 0;
+    size_t id_index = static_cast<size_t>(id);
+
     ESP_BROOKESIA_LOGD("Register event for object(0x%p) ID(%d) handler(0x%p), user_data(0x%p)", object, static_cast<int>(id),
                        handler, user_data);
     ESP_BROOKESIA_CHECK_NULL_RETURN(handler, false, "Invalid handler");
 
-    auto &handlers_for_object = _event_handlers[object];
-    handlers_for_object[id].emplace_back(handler, user_data);
+    list = getList(object, id);
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(list != LIST_NONE, false, "Too many objects and IDs");
+
+    if (!_free_slots.empty()) {
+        index = _free_slots.back();
+        _free_slots.pop_back();
+    } else {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(_slots.size() < UINT16_MAX, false, "Too many handlers");
+        index = _slots.size();
+        _slots.push_back({LIST_NONE, 1});
+    }
+    _slots[index].list = list;
+    _lists[list].push({handler, user_data, index});
+
+    if (id_index >= _id_handler_nums.size()) {
+        _id_handler_nums.resize(id_index + 1, 0);
+    }
+    // The ID is in use, so it can't be given by `getFreeEventID()`
+    if ((_id_handler_nums[id_index]++ == 0) && (id > ID::CUSTOM)) {
+        _available_event_ids.erase(id);
+    }
+
+    if (handle != nullptr) {
+        *handle = {index, _slots[index].generation};
+    }
 
     return true;
 }
 
-bool ESP_Brookesia_CoreEvent::sendEvent(void *object, ID id, void *param) const
+bool ESP_Brookesia_CoreEvent::sendEvent(void *object, ID id, void *param)
 {
-    ESP_BROOKESIA_LOGD("Send event for object(0x%p) ID(%d) param(0x%p)", object, static_cast<int>(id), param);
+    uint16_t list = LIST_NONE;
+    size_t num = 0;
+    HandlerData data = {};
+    bool ret = true;
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
-        return true;
-    }
+    ESP_BROOKESIA_LOGD("Send event for object(0x%p) ID(%d) param(0x%p)", object, static_cast<int>(id), param);
 
-    auto &handlers_for_object = object_it->second;
-    auto handler_it = handlers_for_object.find(id);
-    if (handler_it == handlers_for_object.end()) {
+    list = findList(object, id);
+    if (list == LIST_NONE) {
         return true;
     }
 
-    HandlerData data = {};
-    bool ret = true;
-    for (auto &handler_data_pair : handler_it->second) {
-        auto &handler = handler_data_pair.first;
-        auto &user_data = handler_data_pair.second;
-        if (handler == nullptr) {
-            ESP_BROOKESIA_LOGE("Handler is nullptr");
+    // The handlers registered by the handlers are not called in this event
+    num = _lists[list].num;
+    _dispatch_depth++;
+    for (size_t i = 0; i < num; i++) {
+        // The lists may be reallocated by the handlers, so the entry is copied before the call
+        const Entry entry = _lists[list].data()[i];
+        if (entry.handler == nullptr) {
             continue;
         }
-        data = {id, object, param, user_data};
-        if (!handler(data)) {
+        data = {id, object, param, entry.user_data};
+        if (!entry.handler(data)) {
             ret = false;
             ESP_BROOKESIA_LOGE("Do handler failed");
         }
     }
+    _dispatch_depth--;
+
+    if ((_dispatch_depth == 0) && _has_unregistered_entries) {
+        removeUnregisteredEntries();
+    }
 
     return ret;
 }
 
-void ESP_Brookesia_CoreEvent::unregisterEvent(void *object)
+bool ESP_Brookesia_CoreEvent::postEvent(void *object, ID id, void *param)
 {
-    ESP_BROOKESIA_LOGD("Unregister event for object(0x%p)", object);
+    PostedEvent event = {object, param, id};
+
+    ESP_BROOKESIA_CHECK_NULL_RETURN(_post_queue, false, "No UI queue to post events");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(_post_queue->push(onPostedEventCallback, this, event), false, "Post event failed");
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
+    return true;
+}
+
+void ESP_Brookesia_CoreEvent::unregisterEvent(Handle handle)
+{
+    ESP_BROOKESIA_LOGD("Unregister event for handle(%d:%d)", handle.index, handle.generation);
+
+    if ((handle.index >= _slots.size()) || (handle.generation != _slots[handle.index].generation) ||
+            (_slots[handle.index].list == LIST_NONE)) {
         return;
     }
 
-    // Save event IDs to be removed
-    std::unordered_set<ID> event_ids;
-    for (auto &id_handlers_pair : object_it->second) {
-        event_ids.insert(id_handlers_pair.first);
+    uint16_t list = _slots[handle.index].list;
+    ID id = _lists[list].id;
+    Entry *entries = _lists[list].data();
+    for (size_t i = 0; i < _lists[list].num; i++) {
+        if ((entries[i].slot == handle.index) && (entries[i].handler != nullptr)) {
+            removeEntry(list, i);
+            break;
+        }
     }
+    recycleEventID(id);
+}
 
-    // Remove handlers for the given object
-    size_t handlers_count = getEventHandlersCount();
-    _event_handlers.erase(object_it);
-    ESP_BROOKESIA_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+void ESP_Brookesia_CoreEvent::unregisterEvent(void *object)
+{
+    ESP_BROOKESIA_LOGD("Unregister event for object(0x%p)", object);
 
-    // Add removed event IDs to available event IDs
-    for (const auto &id : event_ids) {
-        if (!checkUsedEventID(id)) {
-            ESP_BROOKESIA_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-            _available_event_ids.insert(id);
+    // Probe the index with each ID in use, unless there are fewer lists than IDs
+    if (_id_handler_nums.size() < _bucket_used_num) {
+        for (size_t id_index = 0; id_index < _id_handler_nums.size(); id_index++) {
+            if (_id_handler_nums[id_index] == 0) {
+                continue;
+            }
+            uint16_t list = findList(object, static_cast<ID>(id_index));
+            if (list != LIST_NONE) {
+                removeEntries(list);
+                recycleEventID(static_cast<ID>(id_index));
+            }
         }
+        return;
+    }
+
+    for (size_t list = 0; list < _lists.size(); list++) {
+        if ((_lists[list].num == 0) || (_lists[list].object != object)) {
+            continue;
+        }
+        ID id = _lists[list].id;
+        removeEntries(list);
+        recycleEventID(id);
     }
 }
 
@@ -119,170 +240,240 @@ void ESP_Brookesia_CoreEvent::unregisterEvent(void *object, ID id)
 {
     ESP_BROOKESIA_LOGD("Unregister event for object(0x%p) ID(%d)", object, static_cast<int>(id));
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
-        return;
-    }
-
-    auto &handlers_for_object = object_it->second;
-    size_t handlers_count = getEventHandlersCount();
-    if (handlers_for_object.erase(id) == 0) {
+    uint16_t list = findList(object, id);
+    if (list == LIST_NONE) {
         return;
     }
-    if (handlers_for_object.empty()) {
-        _event_handlers.erase(object_it);
-    }
-    ESP_BROOKESIA_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
 
-    // Add removed event IDs to available event IDs
-    if (!checkUsedEventID(id)) {
-        ESP_BROOKESIA_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-        _available_event_ids.insert(id);
-    }
+    removeEntries(list);
+    recycleEventID(id);
 }
 
 void ESP_Brookesia_CoreEvent::unregisterEvent(void *object, Handler handler, ID id)
 {
     ESP_BROOKESIA_LOGD("Unregister event for object(0x%p) ID(%d) handler(0x%p)", object, static_cast<int>(id), handler);
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
+    uint16_t list = findList(object, id);
+    if (list == LIST_NONE) {
         return;
     }
 
-    auto &handlers_for_object = object_it->second;
-    auto handler_it = handlers_for_object.find(id);
-    if (handler_it == handlers_for_object.end()) {
-        return;
+    for (size_t i = _lists[list].num; i > 0; i--) {
+        if (_lists[list].data()[i - 1].handler == handler) {
+            removeEntry(list, i - 1);
+        }
     }
+    recycleEventID(id);
+}
+
+void ESP_Brookesia_CoreEvent::unregisterEvent(ID id)
+{
+    size_t id_index = static_cast<size_t>(id);
 
-    auto &handlers = handler_it->second;
-    auto it = std::remove_if(handlers.begin(), handlers.end(),
-    [&](const std::pair<Handler, void *> &pair) {
-        return handler == pair.first;
-    });
-    if (it == handlers.end()) {
+    ESP_BROOKESIA_LOGD("Unregister event for ID(%d)", static_cast<int>(id));
+
+    if ((id_index >= _id_handler_nums.size()) || (_id_handler_nums[id_index] == 0)) {
+        recycleEventID(id);
         return;
     }
 
-    size_t handlers_count = getEventHandlersCount();
-    handlers.erase(it, handlers.end());
-    if (handlers.empty()) {
-        handlers_for_object.erase(handler_it);
-    }
-    if (handlers_for_object.empty()) {
-        _event_handlers.erase(object_it);
+    for (size_t list = 0; list < _lists.size(); list++) {
+        if ((_lists[list].num == 0) || (_lists[list].id != id)) {
+            continue;
+        }
+        removeEntries(list);
+        // Stop once the last handler of the ID is removed
+        if (_id_handler_nums[id_index] == 0) {
+            break;
+        }
     }
-    ESP_BROOKESIA_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+    recycleEventID(id);
+}
 
-    // Add removed event IDs to available event IDs
-    if (!checkUsedEventID(id)) {
-        _available_event_ids.insert(id);
+void ESP_Brookesia_CoreEvent::unregisterEvent(Handler handler)
+{
+    ESP_BROOKESIA_LOGD("Unregister event for handler(0x%p)", handler);
+
+    // The index is keyed by the object and ID, so all the lists are checked
+    for (size_t list = 0; list < _lists.size(); list++) {
+        bool is_removed = false;
+        ID id = _lists[list].id;
+        for (size_t i = _lists[list].num; i > 0; i--) {
+            if (_lists[list].data()[i - 1].handler == handler) {
+                removeEntry(list, i - 1);
+                is_removed = true;
+            }
+        }
+        if (is_removed) {
+            recycleEventID(id);
+        }
     }
 }
 
-void ESP_Brookesia_CoreEvent::unregisterEvent(ID id)
+ESP_Brookesia_CoreEvent::ID ESP_Brookesia_CoreEvent::getFreeEventID()
 {
-    ESP_BROOKESIA_LOGD("Unregister event for ID(%d)", static_cast<int>(id));
+    if (!_available_event_ids.empty()) {
+        ID id = *_available_event_ids.begin();
+        _available_event_ids.erase(id);
 
-    size_t handlers_count = getEventHandlersCount();
-    for (auto &object_handler_pair : _event_handlers) {
-        auto &handlers_for_object = object_handler_pair.second;
-        if (handlers_for_object.find(id) != handlers_for_object.end()) {
-            handlers_for_object.erase(id);
-        }
+        return id;
     }
-    cleanEmptyHandlers();
-    ESP_BROOKESIA_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
 
-    // Add removed event IDs to available event IDs
-    ESP_BROOKESIA_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-    _available_event_ids.insert(id);
+    return ++_free_event_id;
 }
 
-void ESP_Brookesia_CoreEvent::unregisterEvent(Handler handler)
+void ESP_Brookesia_CoreEvent::onPostedEventCallback(void *user_data, const void *data)
 {
-    ESP_BROOKESIA_LOGD("Unregister event for handler(0x%p)", handler);
+    ESP_Brookesia_CoreEvent *event = static_cast<ESP_Brookesia_CoreEvent *>(user_data);
+    const PostedEvent *posted_event = static_cast<const PostedEvent *>(data);
 
-    // Save event IDs to be removed
-    std::unordered_set<ID> event_ids;
-    size_t handlers_count = getEventHandlersCount();
-    for (auto &object_handler_pair : _event_handlers) {
-        auto &handlers_for_object = object_handler_pair.second;
-        for (auto &id_handlers_pair : handlers_for_object) {
-            auto &handlers = id_handlers_pair.second;
-            auto it = std::remove_if(handlers.begin(), handlers.end(),
-            [&](const std::pair<Handler, void *> &pair) {
-                return handler == pair.first;
-            });
-            if (it != handlers.end()) {
-                event_ids.insert(id_handlers_pair.first);
-                handlers.erase(it, handlers.end());
-            }
-        }
+    if (!event->sendEvent(posted_event->object, posted_event->id, posted_event->param)) {
+        ESP_BROOKESIA_LOGE("Send posted event failed");
     }
-    cleanEmptyHandlers();
-    ESP_BROOKESIA_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+}
 
-    // Add removed event IDs to available event IDs
-    for (const auto &id : event_ids) {
-        if (!checkUsedEventID(id)) {
-            ESP_BROOKESIA_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-            _available_event_ids.insert(id);
+size_t ESP_Brookesia_CoreEvent::findBucket(void *object, ID id) const
+{
+    // The index is never more than half full, so there is always an empty bucket to stop the probing
+    size_t mask = _buckets.size() - 1;
+    size_t bucket = hash_key(object, id) & mask;
+
+    while (_buckets[bucket] != LIST_NONE) {
+        const HandlerList &list = _lists[_buckets[bucket]];
+        if ((list.object == object) && (list.id == id)) {
+            break;
         }
+        bucket = (bucket + 1) & mask;
     }
+
+    return bucket;
 }
 
-bool ESP_Brookesia_CoreEvent::checkUsedEventID(ID id) const
+uint16_t ESP_Brookesia_CoreEvent::findList(void *object, ID id) const
 {
-    for (auto &object_handler_pair : _event_handlers) {
-        auto &handlers_for_object = object_handler_pair.second;
-        if (handlers_for_object.find(id) != handlers_for_object.end()) {
-            return true;
+    if (_buckets.empty()) {
+        return LIST_NONE;
+    }
+
+    return _buckets[findBucket(object, id)];
+}
+
+uint16_t ESP_Brookesia_CoreEvent::getList(void *object, ID id)
+{
+    size_t bucket = 0;
+    uint16_t list = LIST_NONE;
+
+    if ((_bucket_used_num + 1) * 2 > _buckets.size()) {
+        // Rebuild the index with double buckets
+        vector<uint16_t> old_buckets(max<size_t>(_buckets.size() * 2, 16), LIST_NONE);
+        _buckets.swap(old_buckets);
+        for (auto old_list : old_buckets) {
+            if (old_list != LIST_NONE) {
+                _buckets[findBucket(_lists[old_list].object, _lists[old_list].id)] = old_list;
+            }
         }
     }
-    return false;
+
+    bucket = findBucket(object, id);
+    if (_buckets[bucket] != LIST_NONE) {
+        return _buckets[bucket];
+    }
+
+    if (!_free_lists.empty()) {
+        list = _free_lists.back();
+        _free_lists.pop_back();
+    } else {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(_lists.size() < LIST_NONE, LIST_NONE, "Too many lists");
+        list = _lists.size();
+        _lists.emplace_back();
+    }
+    _lists[list].object = object;
+    _lists[list].id = id;
+    _lists[list].num = 0;
+    _buckets[bucket] = list;
+    _bucket_used_num++;
+
+    return list;
 }
 
-ESP_Brookesia_CoreEvent::ID ESP_Brookesia_CoreEvent::getFreeEventID()
+void ESP_Brookesia_CoreEvent::removeEntry(uint16_t list, size_t i)
 {
-    if (!_available_event_ids.empty()) {
-        ID id = *_available_event_ids.begin();
-        _available_event_ids.erase(id);
+    Entry &entry = _lists[list].data()[i];
+    uint16_t index = entry.slot;
+    Slot &slot = _slots[index];
 
-        return id;
+    if (entry.handler != nullptr) {
+        entry.handler = nullptr;
+        _id_handler_nums[static_cast<size_t>(_lists[list].id)]--;
+    }
+    // The handlers of the sending event are looked up by their position, so they are only marked here and removed
+    // when the event is finished
+    if (_dispatch_depth > 0) {
+        _has_unregistered_entries = true;
+        return;
     }
 
-    return ++_free_event_id;
+    _lists[list].erase(i);
+    slot.list = LIST_NONE;
+    slot.generation = (slot.generation == UINT16_MAX) ? 1 : (slot.generation + 1);
+    _free_slots.push_back(index);
+    if (_lists[list].num == 0) {
+        removeList(list);
+    }
+}
+
+void ESP_Brookesia_CoreEvent::removeEntries(uint16_t list)
+{
+    // The list is removed with its last entry when no event is being sent
+    for (size_t i = _lists[list].num; i > 0; i--) {
+        removeEntry(list, i - 1);
+    }
 }
 
-size_t ESP_Brookesia_CoreEvent::getEventHandlersCount(void) const
+void ESP_Brookesia_CoreEvent::removeList(uint16_t list)
 {
-    size_t count = 0;
-    for (auto &object_handler_pair : _event_handlers) {
-        for (auto &id_handlers_pair : object_handler_pair.second) {
-            count += id_handlers_pair.second.size();
+    size_t mask = _buckets.size() - 1;
+    size_t bucket = findBucket(_lists[list].object, _lists[list].id);
+
+    // Shift the following lists of the probing back, so no tombstone is left
+    for (size_t next = (bucket + 1) & mask; _buckets[next] != LIST_NONE; next = (next + 1) & mask) {
+        const HandlerList &next_list = _lists[_buckets[next]];
+        size_t home = hash_key(next_list.object, next_list.id) & mask;
+        if (((next - home) & mask) >= ((next - bucket) & mask)) {
+            _buckets[bucket] = _buckets[next];
+            bucket = next;
         }
     }
+    _buckets[bucket] = LIST_NONE;
+    _bucket_used_num--;
 
-    return count;
+    _lists[list].more_entries.clear();
+    _free_lists.push_back(list);
 }
 
-void ESP_Brookesia_CoreEvent::cleanEmptyHandlers()
+void ESP_Brookesia_CoreEvent::removeUnregisteredEntries(void)
 {
-    for (auto it = _event_handlers.begin(); it != _event_handlers.end(); ) {
-        auto &id_map = it->second;
-        for (auto id_it = id_map.begin(); id_it != id_map.end(); ) {
-            if (id_it->second.empty()) {
-                id_it = id_map.erase(id_it);
-            } else {
-                ++id_it;
+    for (size_t list = 0; list < _lists.size(); list++) {
+        for (size_t i = _lists[list].num; i > 0; i--) {
+            if (_lists[list].data()[i - 1].handler == nullptr) {
+                removeEntry(list, i - 1);
             }
         }
-        if (id_map.empty()) {
-            it = _event_handlers.erase(it);
-        } else {
-            ++it;
-        }
     }
+    _has_unregistered_entries = false;
+}
+
+void ESP_Brookesia_CoreEvent::recycleEventID(ID id)
+{
+    size_t id_index = static_cast<size_t>(id);
+
+    // Only the IDs given by `getFreeEventID()` are recycled
+    if ((id <= ID::CUSTOM) || ((id_index < _id_handler_nums.size()) && (_id_handler_nums[id_index] > 0))) {
+        return;
+    }
+    if (_available_event_ids.find(id) != _available_event_ids.end()) {
+        return;
+    }
+    ESP_BROOKESIA_LOGD("Recycle event ID(%d)", static_cast<int>(id));
+    _available_event_ids.insert(id);
 }
@@ -5,12 +5,23 @@
  */
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
 #include <unordered_set>
 #include <functional>
 #include <memory>
 
+class ESP_Brookesia_CoreUiQueue;
+
+/**
+ * The handlers of each object and ID are stored in a small array, which is found by an open addressing index, so
+ * sending an event is one probe and a walk over its own handlers. A handler registered with a handle is found by its
+ * slot without searching the index, the generation of the slot makes a stale handle harmless.
+ *
+ * The handlers can register or unregister handlers while an event is being sent. The unregistered ones are not called
+ * anymore, and the registered ones are called from the next event.
+ */
 class ESP_Brookesia_CoreEvent {
 public:
     enum class ID {
@@ -27,12 +38,20 @@ public:
     };
     using Handler = bool (*)(const HandlerData &data);
 
-    ESP_Brookesia_CoreEvent();
+    struct Handle {
+        uint16_t index;
+        uint16_t generation;    // 0 means invalid
+    };
+
+    ESP_Brookesia_CoreEvent(ESP_Brookesia_CoreUiQueue *post_queue = nullptr);
     ~ESP_Brookesia_CoreEvent();
 
     void reset(void);
-    bool registerEvent(void *object, Handler handler, ID id, void *user_data = nullptr);
-    bool sendEvent(void *object, ID id, void *param = nullptr) const;
+    bool registerEvent(void *object, Handler handler, ID id, void *user_data = nullptr, Handle *handle = nullptr);
+    bool sendEvent(void *object, ID id, void *param = nullptr);
+    /* Can be called in any task, the event is sent in the LVGL task when the UI queue is drained */
+    bool postEvent(void *object, ID id, void *param = nullptr);
+    void unregisterEvent(Handle handle);
     void unregisterEvent(void *object);
     void unregisterEvent(void *object, ID id);
     void unregisterEvent(void *object, Handler handler, ID id);
@@ -42,13 +61,58 @@ public:
     ID getFreeEventID();
 
 private:
-    using HandlerList = std::vector<std::pair<Handler, void *>>;
+    static constexpr size_t INLINE_HANDLER_NUM = 4;
+    static constexpr uint16_t LIST_NONE = UINT16_MAX;
+
+    // Only keeps the handle valid, the handler itself is stored in the list
+    struct Slot {
+        uint16_t list;          // `LIST_NONE` if it's free
+        uint16_t generation;
+    };
+    struct Entry {
+        Handler handler;        // nullptr if it's unregistered during dispatching
+        void *user_data;
+        uint16_t slot;
+    };
+    // The handlers of an object and ID in the order of registration, they are stored inline until there are too many
+    struct HandlerList {
+        void *object;
+        ID id;
+        size_t num;
+        std::array<Entry, INLINE_HANDLER_NUM> inline_entries;
+        std::vector<Entry> more_entries;    // Holds all the entries once they don't fit inline
+
+        Entry *data(void)       { return more_entries.empty() ? inline_entries.data() : more_entries.data(); }
+        void push(const Entry &entry);
+        void erase(size_t i);
+    };
+    struct PostedEvent {
+        void *object;
+        void *param;
+        ID id;
+    };
+
+    static void onPostedEventCallback(void *user_data, const void *data);
 
-    bool checkUsedEventID(ID id) const;
-    size_t getEventHandlersCount(void) const;
-    void cleanEmptyHandlers();
+    size_t findBucket(void *object, ID id) const;
+    uint16_t findList(void *object, ID id) const;
+    uint16_t getList(void *object, ID id);
+    void removeEntry(uint16_t list, size_t i);
+    void removeEntries(uint16_t list);
+    void removeList(uint16_t list);
+    void removeUnregisteredEntries(void);
+    void recycleEventID(ID id);
 
     ID _free_event_id;
-    std::unordered_map<void *, std::unordered_map<ID, HandlerList>> _event_handlers;
     std::unordered_set<ID> _available_event_ids;
+    std::vector<Slot> _slots;
+    std::vector<uint16_t> _free_slots;
+    std::vector<HandlerList> _lists;
+    std::vector<uint16_t> _free_lists;
+    std::vector<uint16_t> _buckets;             // The index of the list, or `LIST_NONE` if it's empty
+    size_t _bucket_used_num;
+    std::vector<size_t> _id_handler_nums;       // The number of the registered handlers of each ID
+    int _dispatch_depth;
+    bool _has_unregistered_entries;
+    ESP_Brookesia_CoreUiQueue *_post_queue;
 };
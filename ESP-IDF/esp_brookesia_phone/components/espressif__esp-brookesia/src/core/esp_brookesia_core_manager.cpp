@@ -10,6 +10,9 @@
 #ifdef ESP_BROOKESIA_MEMORY_INCLUDE
 #include ESP_BROOKESIA_MEMORY_INCLUDE
 #endif
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
 
 #if !ESP_BROOKESIA_LOG_ENABLE_DEBUG_CORE_MANAGER
 #undef ESP_BROOKESIA_LOGD
@@ -18,11 +21,25 @@
 
 using namespace std;
 
+#ifdef ESP_PLATFORM
+static size_t getDefaultFreeMemory(void *user_data)
+{
+    return heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+#endif
+
 ESP_Brookesia_CoreManager::ESP_Brookesia_CoreManager(ESP_Brookesia_Core &core, const ESP_Brookesia_CoreManagerData_t &data):
     _core(core),
     _core_data(data),
     _app_free_id(0),
     _active_app(nullptr),
+#ifdef ESP_PLATFORM
+    _free_memory_getter(getDefaultFreeMemory),
+#else
+    _free_memory_getter(nullptr),
+#endif
+    _free_memory_getter_user_data(nullptr),
+    _memory_check_timer(nullptr),
     _navigate_type(ESP_BROOKESIA_CORE_NAVIGATE_TYPE_MAX)
 {
 }
@@ -37,6 +54,12 @@ ESP_Brookesia_CoreManager::~ESP_Brookesia_CoreManager()
 
 int ESP_Brookesia_CoreManager::installApp(ESP_Brookesia_CoreApp *app)
 {
+    return installApp(app, ESP_BROOKESIA_CORE_APP_INIT_ON_INSTALL);
+}
+
+int ESP_Brookesia_CoreManager::installApp(ESP_Brookesia_CoreApp *app, ESP_Brookesia_CoreAppInitMode_t init_mode)
+{
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_install");
     bool app_installed = false;
     bool home_process_app_installed = false;
     lv_area_t app_visual_area = {};
@@ -52,7 +75,7 @@ int ESP_Brookesia_CoreManager::installApp(ESP_Brookesia_CoreApp *app)
     }
 
     // Initialize app
-    ESP_BROOKESIA_CHECK_FALSE_GOTO(app_installed = app->processInstall(&_core, _app_free_id), err, "App install failed");
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(app_installed = app->processInstall(&_core, _app_free_id, init_mode), err, "App install failed");
     ESP_BROOKESIA_CHECK_FALSE_GOTO(home.getAppVisualArea(app, app_visual_area), err, "Home get app visual area failed");
     ESP_BROOKESIA_CHECK_FALSE_GOTO(app->setVisualArea(app_visual_area), err, "App set visual area failed");
     ESP_BROOKESIA_CHECK_FALSE_GOTO(app->calibrateVisualArea(), err, "App calibrate visual area failed");
@@ -88,6 +111,7 @@ int ESP_Brookesia_CoreManager::installApp(ESP_Brookesia_CoreApp &app)
 
 int ESP_Brookesia_CoreManager::uninstallApp(ESP_Brookesia_CoreApp *app)
 {
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_uninstall");
     bool ret = true;
     int app_id = -1;
     ESP_Brookesia_CoreHome &home = _core._core_home;
@@ -140,6 +164,21 @@ bool ESP_Brookesia_CoreManager::uninstallApp(int id)
     return true;
 }
 
+bool ESP_Brookesia_CoreManager::prewarmApp(ESP_Brookesia_CoreApp *app)
+{
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_prewarm");
+    ESP_BROOKESIA_CHECK_NULL_RETURN(app, false, "Invalid app");
+    ESP_BROOKESIA_CHECK_NULL_RETURN(getInstalledApp(app->getId()), false, "App is not installed");
+
+    if (!app->checkInitPending()) {
+        return true;
+    }
+    ESP_BROOKESIA_LOGD("Prewarm app(%d)", app->getId());
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(app->processInit(), false, "App init failed");
+
+    return true;
+}
+
 bool ESP_Brookesia_CoreManager::startApp(int id)
 {
     ESP_Brookesia_CoreApp *app = NULL;
@@ -149,9 +188,14 @@ bool ESP_Brookesia_CoreManager::startApp(int id)
     auto find_ret = _id_running_app_map.find(id);
     if (find_ret != _id_running_app_map.end()) {
         app = find_ret->second;
-        ESP_BROOKESIA_LOGD("App(%d) is already running, just resume it", app->_id);
-        // If so, resume app
-        ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppResume(app), false, "Resume app failed");
+        // If so, run the app again if it has been evicted, otherwise resume it
+        if (app->_status == ESP_BROOKESIA_CORE_APP_STATUS_CLOSED) {
+            ESP_BROOKESIA_LOGD("App(%d) has been evicted, run it again", app->_id);
+            ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppRelaunch(app), false, "Relaunch app failed");
+        } else {
+            ESP_BROOKESIA_LOGD("App(%d) is already running, just resume it", app->_id);
+            ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppResume(app), false, "Resume app failed");
+        }
 
         return true;
     }
@@ -163,9 +207,7 @@ bool ESP_Brookesia_CoreManager::startApp(int id)
 
     // Check if the running app num is at the limit
     if ((_core_data.app.max_running_num != 0) && (int)_id_running_app_map.size() >= _core_data.app.max_running_num) {
-        for (auto it = _id_running_app_map.begin(); it != _id_running_app_map.end(); it++) {
-            app_old = it->second;
-        }
+        app_old = _lru_running_apps.empty() ? nullptr : _lru_running_apps.front();
         ESP_BROOKESIA_CHECK_NULL_RETURN(app_old, false, "Get old app failed");
 
         ESP_BROOKESIA_LOGW("Running app num(%d) is already at the limit, will close the oldest app(%d)",
@@ -174,6 +216,11 @@ bool ESP_Brookesia_CoreManager::startApp(int id)
         ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppClose(app_old), false, "Close app failed");
     }
 
+    // Make room for the new app before it allocates its resources
+    if (!checkMemoryPressure()) {
+        ESP_BROOKESIA_LOGE("Check memory pressure failed");
+    }
+
     // Start app
     ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppRun(app), false, "Start app failed");
 
@@ -191,6 +238,7 @@ err:
 
 bool ESP_Brookesia_CoreManager::processAppRun(ESP_Brookesia_CoreApp *app)
 {
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_run");
     bool is_home_run = false;
     bool is_app_run = false;
     ESP_Brookesia_CoreHome &home = _core._core_home;
@@ -209,6 +257,7 @@ bool ESP_Brookesia_CoreManager::processAppRun(ESP_Brookesia_CoreApp *app)
 
     // Update active app
     _active_app = app;
+    updateAppRecentlyUsed(app);
 
     return true;
 
@@ -226,6 +275,7 @@ err:
 
 bool ESP_Brookesia_CoreManager::processAppResume(ESP_Brookesia_CoreApp *app)
 {
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_resume");
     ESP_Brookesia_CoreHome &home = _core._core_home;
 
     ESP_BROOKESIA_CHECK_NULL_RETURN(app, false, "Invalid app");
@@ -248,12 +298,14 @@ bool ESP_Brookesia_CoreManager::processAppResume(ESP_Brookesia_CoreApp *app)
 
     // Update active app
     _active_app = app;
+    updateAppRecentlyUsed(app);
 
     return true;
 }
 
 bool ESP_Brookesia_CoreManager::processAppPause(ESP_Brookesia_CoreApp *app)
 {
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_pause");
     ESP_Brookesia_CoreHome &home = _core._core_home;
 
     ESP_BROOKESIA_CHECK_NULL_RETURN(app, false, "Invalid app");
@@ -283,13 +335,16 @@ err:
 
 bool ESP_Brookesia_CoreManager::processAppClose(ESP_Brookesia_CoreApp *app)
 {
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_close");
     ESP_Brookesia_CoreHome &home = _core._core_home;
 
     ESP_BROOKESIA_CHECK_NULL_RETURN(app, false, "Invalid app");
     ESP_BROOKESIA_LOGD("Process app(%d) close", app->_id);
 
-    // Process app, enable auto clean when the app is showing
-    ESP_BROOKESIA_CHECK_FALSE_RETURN(app->processClose(_active_app == app), false, "App process close failed");
+    // Process app, enable auto clean when the app is showing. The evicted app has already been closed
+    if (app->_status != ESP_BROOKESIA_CORE_APP_STATUS_CLOSED) {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(app->processClose(_active_app == app), false, "App process close failed");
+    }
     if (_core_data.flags.enable_app_save_snapshot) {
         if (!releaseAppSnapshot(app)) {
             ESP_BROOKESIA_LOGE("Release app snapshot failed");
@@ -304,6 +359,7 @@ bool ESP_Brookesia_CoreManager::processAppClose(ESP_Brookesia_CoreApp *app)
 
     // Remove app from running map and update active app
     ESP_BROOKESIA_CHECK_FALSE_RETURN(_id_running_app_map.erase(app->_id) > 0, false, "Remove app from running map failed");
+    _lru_running_apps.remove(app);
     if (_active_app == app) {
         _active_app = nullptr;
     }
@@ -311,11 +367,133 @@ bool ESP_Brookesia_CoreManager::processAppClose(ESP_Brookesia_CoreApp *app)
     return true;
 }
 
+bool ESP_Brookesia_CoreManager::processAppRelaunch(ESP_Brookesia_CoreApp *app)
+{
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_relaunch");
+    ESP_Brookesia_CoreHome &home = _core._core_home;
+
+    ESP_BROOKESIA_CHECK_NULL_RETURN(app, false, "Invalid app");
+    ESP_BROOKESIA_LOGD("Process app(%d) relaunch", app->_id);
+
+    // The app is still in the running map and the recents screen, so it's shown like a resumed one
+    if ((_active_app != nullptr) && (_active_app != app)) {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppPause(_active_app), false, "App process pause failed");
+    }
+
+    if (!checkMemoryPressure()) {
+        ESP_BROOKESIA_LOGE("Check memory pressure failed");
+    }
+
+    // Process home
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(home.processAppResume(app), err, "Home process resume failed");
+
+    // Process app
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(app->processRun(), err, "App process run failed");
+
+    // Process extra
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(processAppRunExtra(app), err, "Process app run extra failed");
+
+    // Update active app
+    _active_app = app;
+    updateAppRecentlyUsed(app);
+
+    return true;
+
+err:
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(processAppClose(app), false, "Close app failed");
+
+    return false;
+}
+
+bool ESP_Brookesia_CoreManager::processAppEvict(ESP_Brookesia_CoreApp *app)
+{
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_evict");
+
+    ESP_BROOKESIA_CHECK_NULL_RETURN(app, false, "Invalid app");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(app != _active_app, false, "Can't evict the active app");
+    ESP_BROOKESIA_LOGD("Process app(%d) evict", app->_id);
+
+    // Only the resources of the app are released. It's kept in the running map with its snapshot, so the recents
+    // screen still shows it, and it will be run again by `processAppRelaunch()`
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(app->processClose(false), false, "App process close failed");
+
+    return true;
+}
+
+bool ESP_Brookesia_CoreManager::setFreeMemoryGetter(FreeMemoryGetter_t getter, void *user_data)
+{
+    ESP_BROOKESIA_LOGD("Set free memory getter(@0x%p)", getter);
+
+    _free_memory_getter = getter;
+    _free_memory_getter_user_data = user_data;
+
+    return true;
+}
+
+bool ESP_Brookesia_CoreManager::checkMemoryPressure(void)
+{
+    bool ret = true;
+    size_t free_size = 0;
+
+    if (!_core_data.flags.enable_memory_pressure_check || (_free_memory_getter == nullptr)) {
+        return true;
+    }
+
+    free_size = _free_memory_getter(_free_memory_getter_user_data);
+    if (free_size >= _core_data.memory.trim_free_size) {
+        return true;
+    }
+    ESP_BROOKESIA_LOGW("Free memory(%d) is below %d, trim the paused apps", (int)free_size,
+                       (int)_core_data.memory.trim_free_size);
+
+    // Ask the paused apps to trim memory, from the least recently used one
+    for (auto app : _lru_running_apps) {
+        if ((app == _active_app) || (app->_status != ESP_BROOKESIA_CORE_APP_STATUS_PAUSED) ||
+                app->_flags.is_memory_trimmed) {
+            continue;
+        }
+        if (!app->processTrimMemory()) {
+            ESP_BROOKESIA_LOGE("App(%d) trim memory failed", app->_id);
+            ret = false;
+        }
+        free_size = _free_memory_getter(_free_memory_getter_user_data);
+        if (free_size >= _core_data.memory.trim_free_size) {
+            return ret;
+        }
+    }
+
+    // Then evict them in the same order until the free memory is above the close threshold
+    for (auto app : _lru_running_apps) {
+        if (free_size >= _core_data.memory.close_free_size) {
+            break;
+        }
+        if ((app == _active_app) || (app->_status != ESP_BROOKESIA_CORE_APP_STATUS_PAUSED)) {
+            continue;
+        }
+        ESP_BROOKESIA_LOGW("Free memory(%d) is below %d, evict app(%d)", (int)free_size,
+                           (int)_core_data.memory.close_free_size, app->_id);
+        if (!processAppEvict(app)) {
+            ESP_BROOKESIA_LOGE("Evict app(%d) failed", app->_id);
+            ret = false;
+        }
+        free_size = _free_memory_getter(_free_memory_getter_user_data);
+    }
+
+    return ret;
+}
+
+void ESP_Brookesia_CoreManager::updateAppRecentlyUsed(ESP_Brookesia_CoreApp *app)
+{
+    _lru_running_apps.remove(app);
+    _lru_running_apps.push_back(app);
+}
+
 bool ESP_Brookesia_CoreManager::saveAppSnapshot(ESP_Brookesia_CoreApp *app)
 {
 #if !LV_USE_SNAPSHOT
     ESP_BROOKESIA_CHECK_FALSE_RETURN(false, false, "`LV_USE_SNAPSHOT` is not enabled");
 #else
+    ESP_BROOKESIA_LV_PROFILER_SCOPE("app_snapshot");
     bool resize_app_screen = false;
     uint8_t *snapshot_buffer = nullptr;
     uint32_t snapshot_buffer_size = 0;
@@ -483,6 +661,11 @@ bool ESP_Brookesia_CoreManager::beginCore(void)
                                      "Register app event failed");
     ESP_BROOKESIA_CHECK_FALSE_GOTO(_core.registerNavigateEventCallback(onNavigationEventCallback, this), err,
                                    "Register navigation event failed");
+    if (_core_data.flags.enable_memory_pressure_check && (_core_data.memory.check_period_ms > 0)) {
+        _memory_check_timer = ESP_BROOKESIA_LV_TIMER(onMemoryCheckTimerCallback, _core_data.memory.check_period_ms,
+                              this);
+        ESP_BROOKESIA_CHECK_NULL_GOTO(_memory_check_timer, err, "Create memory check timer failed");
+    }
 
     return true;
 
@@ -508,6 +691,7 @@ bool ESP_Brookesia_CoreManager::delCore(void)
 
     _app_free_id = 0;
     _active_app = nullptr;
+    _memory_check_timer.reset();
     for (auto app : id_installed_app_map) {
         if (!uninstallApp(app.second)) {
             ESP_BROOKESIA_LOGE("Uninstall app(%d) failed", app.second->_id);
@@ -517,6 +701,7 @@ bool ESP_Brookesia_CoreManager::delCore(void)
     _id_installed_app_map.clear();
     _id_running_app_map.clear();
     _id_app_snapshot_map.clear();
+    _lru_running_apps.clear();
 
     return ret;
 }
@@ -572,3 +757,15 @@ void ESP_Brookesia_CoreManager::onNavigationEventCallback(lv_event_t *event)
 
     ESP_BROOKESIA_CHECK_FALSE_EXIT(manager->processNavigationEvent(navigation_type), "Process navigation bar event failed");
 }
+
+void ESP_Brookesia_CoreManager::onMemoryCheckTimerCallback(lv_timer_t *timer)
+{
+    ESP_Brookesia_CoreManager *manager = nullptr;
+
+    ESP_BROOKESIA_CHECK_NULL_EXIT(timer, "Invalid timer");
+
+    manager = static_cast<ESP_Brookesia_CoreManager *>(timer->user_data);
+    ESP_BROOKESIA_CHECK_NULL_EXIT(manager, "Invalid manager");
+
+    ESP_BROOKESIA_CHECK_FALSE_EXIT(manager->checkMemoryPressure(), "Check memory pressure failed");
+}
@@ -5,11 +5,13 @@
  */
 #pragma once
 
+#include <list>
 #include <map>
 #include <unordered_map>
 #include "esp_brookesia_core_app.hpp"
 #include "esp_brookesia_core_home.hpp"
 #include "esp_brookesia_core_type.h"
+#include "esp_brookesia_lv.hpp"
 
 class ESP_Brookesia_Core;
 
@@ -17,14 +19,22 @@ class ESP_Brookesia_CoreManager {
 public:
     friend class ESP_Brookesia_Core;
 
+    typedef size_t (*FreeMemoryGetter_t)(void *user_data);
+
     ESP_Brookesia_CoreManager(ESP_Brookesia_Core &core, const ESP_Brookesia_CoreManagerData_t &data);
     ~ESP_Brookesia_CoreManager();
 
     int installApp(ESP_Brookesia_CoreApp &app);
     int installApp(ESP_Brookesia_CoreApp *app);
+    int installApp(ESP_Brookesia_CoreApp *app, ESP_Brookesia_CoreAppInitMode_t init_mode);
     int uninstallApp(ESP_Brookesia_CoreApp &app);
     int uninstallApp(ESP_Brookesia_CoreApp *app);
     bool uninstallApp(int id);
+    // Initialize an app installed with `ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND` before it's run
+    bool prewarmApp(ESP_Brookesia_CoreApp *app);
+
+    bool setFreeMemoryGetter(FreeMemoryGetter_t getter, void *user_data);
+    bool checkMemoryPressure(void);
 
     // *INDENT-OFF*
     int getAppFreeId(void) const             { return _app_free_id++; }
@@ -49,6 +59,8 @@ protected:
     bool processAppResume(ESP_Brookesia_CoreApp *app);
     bool processAppPause(ESP_Brookesia_CoreApp *app);
     bool processAppClose(ESP_Brookesia_CoreApp *app);
+    bool processAppRelaunch(ESP_Brookesia_CoreApp *app);
+    bool processAppEvict(ESP_Brookesia_CoreApp *app);
     bool saveAppSnapshot(ESP_Brookesia_CoreApp *app);
     bool releaseAppSnapshot(ESP_Brookesia_CoreApp *app);
     void resetActiveApp(void);
@@ -60,9 +72,11 @@ private:
     bool beginCore(void);
     bool delCore(void);
     bool startApp(int id);
+    void updateAppRecentlyUsed(ESP_Brookesia_CoreApp *app);
 
     static void onAppEventCallback(lv_event_t *event);
     static void onNavigationEventCallback(lv_event_t *event);
+    static void onMemoryCheckTimerCallback(lv_timer_t *timer);
 
     typedef struct {
         uint8_t *image_buffer;
@@ -75,6 +89,12 @@ private:
     std::unordered_map <int, ESP_Brookesia_CoreApp *> _id_installed_app_map;
     std::unordered_map <int, ESP_Brookesia_CoreApp *> _id_running_app_map;
     std::unordered_map <int, std::shared_ptr<ESP_Brookesia_AppSnapshot_t>> _id_app_snapshot_map;
+    // The running apps from the least recently used one, the evicted apps are still in it
+    std::list <ESP_Brookesia_CoreApp *> _lru_running_apps;
+    // Memory
+    FreeMemoryGetter_t _free_memory_getter;
+    void *_free_memory_getter_user_data;
+    ESP_Brookesia_LvTimer_t _memory_check_timer;
     // Navigation
     ESP_Brookesia_CoreNavigateType_t _navigate_type;
 };
@@ -58,8 +58,14 @@ typedef struct {
     struct {
         uint16_t max_running_num;
     } app;
+    struct {
+        uint32_t trim_free_size;        /* Paused apps are asked to trim memory when the free memory is below it */
+        uint32_t close_free_size;       /* Paused apps are closed when the free memory is still below it */
+        uint32_t check_period_ms;
+    } memory;
     struct {
         uint8_t enable_app_save_snapshot: 1;
+        uint8_t enable_memory_pressure_check: 1;    /* Off in the built-in stylesheets, the thresholds depend on the apps */
     } flags;
 } ESP_Brookesia_CoreManagerData_t;
 
@@ -118,6 +124,16 @@ typedef struct {
         },                                                               \
     }
 
+/**
+ * @brief When the core calls the `init()` function of an app
+ *
+ */
+typedef enum {
+    ESP_BROOKESIA_CORE_APP_INIT_ON_INSTALL = 0,     /*!< When the app is installed */
+    ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND,          /*!< Before the first run of the app, or when it's prewarmed. Only its
+                                                         name and launcher icon are registered when it's installed */
+} ESP_Brookesia_CoreAppInitMode_t;
+
 typedef enum {
     ESP_BROOKESIA_CORE_APP_STATUS_UNINSTALLED = 0,
     ESP_BROOKESIA_CORE_APP_STATUS_RUNNING,
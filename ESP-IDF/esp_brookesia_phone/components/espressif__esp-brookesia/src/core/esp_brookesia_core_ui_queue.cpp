@@ -0,0 +1,282 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "esp_brookesia_core_utils.h"
+#include "esp_brookesia_core_ui_queue.hpp"
+
+using namespace std;
+
+ESP_Brookesia_CoreUiQueue::ESP_Brookesia_CoreUiQueue(size_t capacity):
+    _capacity(1),
+    _cells(nullptr),
+    _keyed_slots(nullptr),
+    _enqueue_pos(0),
+    _dequeue_pos(0),
+    _drain_timer(nullptr),
+    _pushed(0),
+    _dropped(0),
+    _coalesced(0),
+    _executed(0)
+{
+    // The capacity is rounded up to a power of 2, so the position can be mapped to the cell by a mask
+    while (_capacity < capacity) {
+        _capacity <<= 1;
+    }
+    _cells = unique_ptr<Cell[]>(new Cell[_capacity]);
+    for (size_t i = 0; i < _capacity; i++) {
+        _cells[i].sequence.store(i, memory_order_relaxed);
+    }
+    _keyed_slots = unique_ptr<KeyedSlot[]>(new KeyedSlot[KEYED_SLOT_NUM]);
+    for (size_t i = 0; i < KEYED_SLOT_NUM; i++) {
+        _keyed_slots[i].state.store(KEYED_SLOT_STATE_FREE, memory_order_relaxed);
+        _keyed_slots[i].sequence.store(0, memory_order_relaxed);
+        _keyed_slots[i].pending.store(false, memory_order_relaxed);
+        _keyed_slots[i].executed_sequence = 0;
+    }
+    _batch.reserve(_capacity);
+}
+
+ESP_Brookesia_CoreUiQueue::~ESP_Brookesia_CoreUiQueue()
+{
+    ESP_BROOKESIA_LOGD("Destroy(@0x%p)", this);
+    if (!del()) {
+        ESP_BROOKESIA_LOGE("Delete failed");
+    }
+}
+
+bool ESP_Brookesia_CoreUiQueue::begin(uint32_t drain_period_ms)
+{
+    ESP_BROOKESIA_LOGD("Begin(@0x%p) with drain period(%d)", this, (int)drain_period_ms);
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(_drain_timer == nullptr, false, "Already begun");
+
+    _drain_timer = ESP_BROOKESIA_LV_TIMER(onDrainTimerCallback, drain_period_ms, this);
+    ESP_BROOKESIA_CHECK_NULL_RETURN(_drain_timer, false, "Create drain timer failed");
+
+    return true;
+}
+
+bool ESP_Brookesia_CoreUiQueue::del(void)
+{
+    ESP_BROOKESIA_LOGD("Delete(@0x%p)", this);
+
+    if (_drain_timer == nullptr) {
+        return true;
+    }
+
+    // Execute the remaining commands, their data may be released by the pushers after this
+    drain();
+    _drain_timer.reset();
+
+    return true;
+}
+
+bool ESP_Brookesia_CoreUiQueue::push(Handler handler, void *user_data, const void *data, size_t data_size, uint32_t key)
+{
+    KeyedSlot *slot = nullptr;
+
+    if ((handler == nullptr) || (data_size > DATA_SIZE_MAX) || ((data == nullptr) && (data_size > 0))) {
+        return false;
+    }
+
+    if (key != KEY_NONE) {
+        slot = getKeyedSlot(handler, user_data, key);
+        if (slot != nullptr) {
+            return pushKeyed(slot, data, data_size);
+        }
+    }
+
+    if (!enqueue(handler, user_data, nullptr, data, data_size)) {
+        return false;
+    }
+    _pushed.fetch_add(1, memory_order_relaxed);
+
+    return true;
+}
+
+ESP_Brookesia_CoreUiQueue::KeyedSlot *ESP_Brookesia_CoreUiQueue::getKeyedSlot(Handler handler, void *user_data,
+        uint32_t key)
+{
+    KeyedSlot *slot = nullptr;
+    uint8_t state = KEYED_SLOT_STATE_FREE;
+
+    for (size_t i = 0; i < KEYED_SLOT_NUM; i++) {
+        slot = &_keyed_slots[i];
+        state = slot->state.load(memory_order_acquire);
+        if (state == KEYED_SLOT_STATE_FREE) {
+            if (slot->state.compare_exchange_strong(state, KEYED_SLOT_STATE_CLAIMING, memory_order_acquire)) {
+                slot->handler = handler;
+                slot->user_data = user_data;
+                slot->key = key;
+                slot->state.store(KEYED_SLOT_STATE_READY, memory_order_release);
+                return slot;
+            }
+            // Claimed by another push meanwhile, `state` is its new state
+        }
+        if ((state == KEYED_SLOT_STATE_READY) && (slot->key == key) && (slot->handler == handler) &&
+                (slot->user_data == user_data)) {
+            return slot;
+        }
+    }
+
+    return nullptr;
+}
+
+bool ESP_Brookesia_CoreUiQueue::pushKeyed(KeyedSlot *slot, const void *data, size_t data_size)
+{
+    uint32_t sequence = slot->sequence.load(memory_order_relaxed);
+
+    // Make the sequence odd while the data is written. If another task or an ISR is writing it, the writer wins and
+    // this push fails like a full queue. Waiting for the writer could never end if it was preempted by this push.
+    do {
+        if (sequence & 1) {
+            _dropped.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+    } while (!slot->sequence.compare_exchange_weak(sequence, sequence + 1, memory_order_acq_rel,
+             memory_order_relaxed));
+    if (data_size > 0) {
+        memcpy(slot->data, data, data_size);
+    }
+    slot->sequence.store(sequence + 2);
+
+    // Queue a token of the slot unless one is already waiting, it will execute the data written above
+    if (slot->pending.exchange(true)) {
+        _pushed.fetch_add(1, memory_order_relaxed);
+        _coalesced.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    if (!enqueue(nullptr, nullptr, slot, nullptr, 0)) {
+        slot->pending.store(false);
+        return false;
+    }
+    _pushed.fetch_add(1, memory_order_relaxed);
+
+    return true;
+}
+
+bool ESP_Brookesia_CoreUiQueue::enqueue(Handler handler, void *user_data, KeyedSlot *slot, const void *data,
+                                        size_t data_size)
+{
+    Cell *cell = nullptr;
+    size_t pos = 0;
+    intptr_t diff = 0;
+
+    // Claim a cell by moving the enqueue position, the cell is free if its sequence equals the position
+    pos = _enqueue_pos.load(memory_order_relaxed);
+    for (;;) {
+        cell = &_cells[pos & (_capacity - 1)];
+        diff = (intptr_t)cell->sequence.load(memory_order_acquire) - (intptr_t)pos;
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The consumer hasn't released the cell of the last round, so the queue is full
+            _dropped.fetch_add(1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = _enqueue_pos.load(memory_order_relaxed);
+        }
+    }
+
+    cell->command.handler = handler;
+    cell->command.user_data = user_data;
+    cell->command.slot = slot;
+    if (data_size > 0) {
+        memcpy(cell->command.data, data, data_size);
+    }
+    // Publish the command to the consumer
+    cell->sequence.store(pos + 1, memory_order_release);
+
+    return true;
+}
+
+bool ESP_Brookesia_CoreUiQueue::executeKeyed(KeyedSlot *slot)
+{
+    uint8_t data[DATA_SIZE_MAX];
+    uint32_t sequence = 0;
+
+    // A push from now on queues a new token, so the data can be left to it if it's being written
+    slot->pending.store(false);
+    // The data of this token is being replaced, or has been executed by an earlier token. Either way the push which
+    // queued it is replaced by a later one
+    sequence = slot->sequence.load();
+    if ((sequence & 1) || (sequence == slot->executed_sequence)) {
+        _coalesced.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    memcpy(data, slot->data, sizeof(data));
+    atomic_thread_fence(memory_order_acquire);
+    if (slot->sequence.load(memory_order_relaxed) != sequence) {
+        _coalesced.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    slot->executed_sequence = sequence;
+    slot->handler(slot->user_data, data);
+
+    return true;
+}
+
+size_t ESP_Brookesia_CoreUiQueue::drain(void)
+{
+    Cell *cell = nullptr;
+    size_t executed_num = 0;
+
+    // Take all the ready commands at once, the commands pushed during the execution are left to the next drain
+    _batch.clear();
+    for (;;) {
+        cell = &_cells[_dequeue_pos & (_capacity - 1)];
+        if (cell->sequence.load(memory_order_acquire) != _dequeue_pos + 1) {
+            break;
+        }
+        _batch.push_back(cell->command);
+        // Release the cell for the producer of the next round
+        cell->sequence.store(_dequeue_pos + _capacity, memory_order_release);
+        _dequeue_pos++;
+    }
+
+    for (const Command &command : _batch) {
+        if (command.slot != nullptr) {
+            executed_num += executeKeyed(command.slot) ? 1 : 0;
+            continue;
+        }
+        command.handler(command.user_data, command.data);
+        executed_num++;
+    }
+    _executed += executed_num;
+
+    return executed_num;
+}
+
+ESP_Brookesia_CoreUiQueue::Stats ESP_Brookesia_CoreUiQueue::getStats(void) const
+{
+    return {
+        .pushed = _pushed.load(memory_order_relaxed),
+        .dropped = _dropped.load(memory_order_relaxed),
+        .coalesced = _coalesced.load(memory_order_relaxed),
+        .executed = _executed,
+    };
+}
+
+void ESP_Brookesia_CoreUiQueue::resetStats(void)
+{
+    _pushed.store(0, memory_order_relaxed);
+    _dropped.store(0, memory_order_relaxed);
+    _coalesced.store(0, memory_order_relaxed);
+    _executed = 0;
+}
+
+void ESP_Brookesia_CoreUiQueue::onDrainTimerCallback(lv_timer_t *timer)
+{
+    ESP_Brookesia_CoreUiQueue *queue = nullptr;
+
+    ESP_BROOKESIA_CHECK_NULL_EXIT(timer, "Invalid timer");
+
+    queue = static_cast<ESP_Brookesia_CoreUiQueue *>(timer->user_data);
+    ESP_BROOKESIA_CHECK_NULL_EXIT(queue, "Invalid queue");
+
+    queue->drain();
+}
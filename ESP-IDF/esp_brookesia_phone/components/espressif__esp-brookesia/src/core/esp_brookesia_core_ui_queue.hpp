@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "lvgl.h"
+#include "esp_brookesia_lv.hpp"
+
+/**
+ * A lock-free queue of UI commands, which is pushed by any task and drained in the LVGL task. Worker tasks use it
+ * instead of taking the LVGL lock to update the UI.
+ *
+ * The commands with the same handler, user data and non-zero key are coalesced when they are pushed: they share a slot
+ * which only keeps the latest data, and the queue only holds a token of the slot until it's drained. So a task can push a
+ * value as often as it changes, like the battery percent or the clock, and it takes one cell of the queue at most. The
+ * slots are kept until the queue is destroyed, the keyed commands are queued like the others if all of them are used.
+ *
+ * If a key is pushed while another task or an ISR is writing its slot, the writer wins and the push returns false, so
+ * the caller can push the value again. The pushes of a key from a single task always succeed unless the queue is full.
+ */
+// *INDENT-OFF*
+class ESP_Brookesia_CoreUiQueue {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+    // Large enough for two pointers and an ID on 64-bit hosts
+    static constexpr size_t DATA_SIZE_MAX = 24;
+    static constexpr uint32_t KEY_NONE = 0;
+    static constexpr size_t KEYED_SLOT_NUM = 16;
+
+    // Called in the LVGL task, `data` is the copy of the pushed data
+    using Handler = void (*)(void *user_data, const void *data);
+
+    struct Stats {
+        uint32_t pushed;
+        uint32_t dropped;       // The queue was full, or the slot of the key was being written by another push
+        uint32_t coalesced;     // Replaced by a later command with the same key before being drained
+        uint32_t executed;
+    };
+
+    ESP_Brookesia_CoreUiQueue(size_t capacity = DEFAULT_CAPACITY);
+    ~ESP_Brookesia_CoreUiQueue();
+
+    bool begin(uint32_t drain_period_ms);
+    bool del(void);
+
+    /* Can be called in any task or ISR */
+    bool push(Handler handler, void *user_data, const void *data = nullptr, size_t data_size = 0,
+              uint32_t key = KEY_NONE);
+    template <typename T>
+    bool push(Handler handler, void *user_data, const T &data, uint32_t key = KEY_NONE)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Data must be trivially copyable");
+        static_assert(sizeof(T) <= DATA_SIZE_MAX, "Data is too large");
+        return push(handler, user_data, &data, sizeof(T), key);
+    }
+
+    /* Should be called in the LVGL task, it's called by the drain timer after `begin()` */
+    size_t drain(void);
+
+    size_t getCapacity(void) const  { return _capacity; }
+    Stats getStats(void) const;
+    void resetStats(void);
+
+private:
+    enum KeyedSlotState : uint8_t {
+        KEYED_SLOT_STATE_FREE = 0,
+        KEYED_SLOT_STATE_CLAIMING,
+        KEYED_SLOT_STATE_READY,
+    };
+    struct KeyedSlot {
+        // The handler, user data and key are written once when the slot is claimed, then the state is ready
+        std::atomic<uint8_t> state;
+        Handler handler;
+        void *user_data;
+        uint32_t key;
+        // Odd while the data is written, so the consumer can detect a torn read
+        std::atomic<uint32_t> sequence;
+        // A token of the slot is in the queue
+        std::atomic<bool> pending;
+        uint8_t data[DATA_SIZE_MAX];
+        // Only used by the consumer
+        uint32_t executed_sequence;
+    };
+    struct Command {
+        Handler handler;
+        void *user_data;
+        KeyedSlot *slot;    // Only set for the token of a keyed command, its handler and data are in the slot
+        uint8_t data[DATA_SIZE_MAX];
+    };
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Command command;
+    };
+
+    KeyedSlot *getKeyedSlot(Handler handler, void *user_data, uint32_t key);
+    bool pushKeyed(KeyedSlot *slot, const void *data, size_t data_size);
+    bool enqueue(Handler handler, void *user_data, KeyedSlot *slot, const void *data, size_t data_size);
+    bool executeKeyed(KeyedSlot *slot);
+
+    static void onDrainTimerCallback(lv_timer_t *timer);
+
+    // Ring of cells, each cell's sequence tells if it's free for the producer at this position or ready for the consumer
+    size_t _capacity;
+    std::unique_ptr<Cell[]> _cells;
+    std::unique_ptr<KeyedSlot[]> _keyed_slots;
+    std::atomic<size_t> _enqueue_pos;
+    size_t _dequeue_pos;
+    // Only used by the consumer
+    std::vector<Command> _batch;
+    ESP_Brookesia_LvTimer_t _drain_timer;
+    // Stats
+    std::atomic<uint32_t> _pushed;
+    std::atomic<uint32_t> _dropped;
+    std::atomic<uint32_t> _coalesced;
+    uint32_t _executed;
+};
+// *INDENT-OFF*
@@ -45,3 +45,21 @@ struct LvAnimDeleter {
     }
 };
 #define ESP_BROOKESIA_LV_ANIM() ESP_Brookesia_LvAnim_t(LvAnimConstructor(), LvAnimDeleter());
+
+/* Record a begin/end pair of LVGL profiler events for the rest of the current scope (LVGL v9 with `LV_USE_PROFILER`) */
+#if (LVGL_VERSION_MAJOR >= 9) && LV_USE_PROFILER
+struct LvProfilerScope {
+    LvProfilerScope(const char *tag): _tag(tag)
+    {
+        LV_PROFILER_BEGIN_TAG(_tag);
+    }
+    ~LvProfilerScope()
+    {
+        LV_PROFILER_END_TAG(_tag);
+    }
+    const char *_tag;
+};
+#define ESP_BROOKESIA_LV_PROFILER_SCOPE(tag) LvProfilerScope _lv_profiler_scope(tag)
+#else
+#define ESP_BROOKESIA_LV_PROFILER_SCOPE(tag)
+#endif
@@ -14,11 +14,15 @@
 #include "esp_brookesia_core_type.h"
 
 template <typename T>
-using ESP_Brookesia_NameStylesheetMap_t = std::unordered_map<std::string, std::shared_ptr<T>>;
+using ESP_Brookesia_NameStylesheetMap_t = std::unordered_map<std::string, std::shared_ptr<const T>>;
 
 template <typename T>
 using ESP_Brookesia_ResolutionNameStylesheetMap_t = std::map<uint32_t, ESP_Brookesia_NameStylesheetMap_t<T>>;
 
+/**
+ * The stylesheets are kept as they are added and only calibrated when activated, so the percentage sizes and the fonts
+ * are resolved once for the screen in use, not for every added stylesheet.
+ */
 // *INDENT-OFF*
 template <typename T>
 class ESP_Brookesia_StyleSheetTemplate {
@@ -29,6 +33,17 @@ public:
     virtual bool calibrateScreenSize(ESP_Brookesia_StyleSize_t &size) = 0;
 
     bool addStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size, const T &stylesheet);
+    /**
+     * @brief Add a stylesheet without copying it, e.g. a `static const` one placed in flash
+     *
+     * @param name The name of the stylesheet
+     * @param screen_size The screen size of the stylesheet
+     * @param stylesheet The stylesheet, it must be kept until the stylesheets are deleted
+     *
+     * @return true if success, otherwise false
+     *
+     */
+    bool addStaticStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size, const T &stylesheet);
     bool activateStylesheet(const ESP_Brookesia_StyleSize_t &screen_size, const T &stylesheet);
     bool activateStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size);
 
@@ -39,7 +54,7 @@ public:
     /**
      * @brief Get the active stylesheet
      *
-     * @return stylesheet
+     * @return stylesheet calibrated for the screen size given to `activateStylesheet()`
      *
      */
     const T *getStylesheet(void) const { return &_active_stylesheet; }
@@ -50,7 +65,10 @@ public:
      * @param name The name of the stylesheet
      * @param screen_size The screen size of the stylesheet
      *
-     * @return stylesheet
+     * @return stylesheet as it was added, it isn't calibrated
+     *
+     * @note  The percentage sizes and the fonts are only resolved when the stylesheet is activated. Pass it to
+     *        `activateStylesheet()` and use `getStylesheet()` to read the calibrated one
      *
      */
     const T *getStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size);
@@ -60,7 +78,9 @@ public:
      *
      * @param screen_size The screen size of the stylesheet
      *
-     * @return stylesheet
+     * @return stylesheet as it was added, it isn't calibrated
+     *
+     * @note  Like the lookup by name, it's only calibrated when it's activated
      *
      */
     const T *getStylesheet(const ESP_Brookesia_StyleSize_t &screen_size);
@@ -75,6 +95,8 @@ protected:
 private:
     ESP_Brookesia_ResolutionNameStylesheetMap_t<T> _resolution_name_stylesheet_map;
 
+    bool addStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size,
+                       std::shared_ptr<const T> stylesheet);
     uint32_t getResolution(const ESP_Brookesia_StyleSize_t &screen_size)
     {
         return (screen_size.width << 16) | screen_size.height;
@@ -99,25 +121,39 @@ ESP_Brookesia_StyleSheetTemplate<T>::~ESP_Brookesia_StyleSheetTemplate()
 
 template <typename T>
 bool ESP_Brookesia_StyleSheetTemplate<T>::addStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size, const T &stylesheet)
+{
+    std::shared_ptr<const T> stylesheet_copy = std::make_shared<const T>(stylesheet);
+    ESP_BROOKESIA_CHECK_NULL_RETURN(stylesheet_copy, false, "Create stylesheet failed");
+
+    return addStylesheet(name, screen_size, stylesheet_copy);
+}
+
+template <typename T>
+bool ESP_Brookesia_StyleSheetTemplate<T>::addStaticStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size,
+                                                              const T &stylesheet)
+{
+    // Alias an empty pointer, so there is neither a copy nor a control block
+    return addStylesheet(name, screen_size, std::shared_ptr<const T>(std::shared_ptr<const T>(), &stylesheet));
+}
+
+template <typename T>
+bool ESP_Brookesia_StyleSheetTemplate<T>::addStylesheet(const char *name, const ESP_Brookesia_StyleSize_t &screen_size,
+                                                        std::shared_ptr<const T> stylesheet)
 {
     uint32_t resolution = 0;
     ESP_Brookesia_StyleSize_t calibrate_size = screen_size;
-    std::shared_ptr<T> calibration_stylesheet = std::make_shared<T>(stylesheet);
 
     ESP_BROOKESIA_CHECK_NULL_RETURN(name, false, "Invalid name");
-    ESP_BROOKESIA_CHECK_NULL_RETURN(calibration_stylesheet, false, "Create stylesheet failed");
 
     ESP_BROOKESIA_CHECK_FALSE_RETURN(calibrateScreenSize(calibrate_size), false, "Invalid screen size");
     ESP_BROOKESIA_LOGD("Add stylesheet(%s - %dx%d)", name, calibrate_size.width, calibrate_size.height);
 
-    ESP_BROOKESIA_CHECK_FALSE_RETURN(calibrateStylesheet(calibrate_size, *calibration_stylesheet), false, "Invalid stylesheet");
-
     // Check if the resolution is already exist
     resolution = getResolution(calibrate_size);
     auto it_resolution_map = _resolution_name_stylesheet_map.find(resolution);
     // If not exist, create a new map which contains the name and data
     if (it_resolution_map == _resolution_name_stylesheet_map.end()) {
-        _resolution_name_stylesheet_map[resolution][std::string(name)] = calibration_stylesheet;
+        _resolution_name_stylesheet_map[resolution][std::string(name)] = stylesheet;
         return true;
     }
 
@@ -126,9 +162,9 @@ bool ESP_Brookesia_StyleSheetTemplate<T>::addStylesheet(const char *name, const
     // If exist, overwrite it, else add it
     if (it_name_map != it_resolution_map->second.end()) {
         ESP_BROOKESIA_LOGW("Stylesheet(%s) already exist, overwrite it", it_name_map->first.c_str());
-        it_name_map->second = calibration_stylesheet;
+        it_name_map->second = stylesheet;
     } else {
-        it_resolution_map->second[name] = calibration_stylesheet;
+        it_resolution_map->second[name] = stylesheet;
     }
 
     return true;
@@ -167,7 +203,14 @@ bool ESP_Brookesia_StyleSheetTemplate<T>::activateStylesheet(const char *name, c
     stylesheet = getStylesheet(name, screen_size);
     ESP_BROOKESIA_CHECK_NULL_RETURN(stylesheet, false, "Get stylesheet failed");
 
-    _active_stylesheet = *stylesheet;
+    // Calibrate a copy, so the active stylesheet is kept if the stylesheet is invalid
+    std::shared_ptr<T> calibration_stylesheet = std::make_shared<T>(*stylesheet);
+    ESP_BROOKESIA_CHECK_NULL_RETURN(calibration_stylesheet, false, "Create stylesheet failed");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(
+        calibrateStylesheet(calibrate_size, *calibration_stylesheet), false, "Invalid stylesheet"
+    );
+
+    _active_stylesheet = *calibration_stylesheet;
 
     return true;
 }
@@ -250,7 +293,7 @@ const T *ESP_Brookesia_StyleSheetTemplate<T>::getStylesheet(const ESP_Brookesia_
         return nullptr;
     }
 
-    auto name_map = it_resolution_map->second;
+    auto &name_map = it_resolution_map->second;
     if (name_map.empty()) {
         return nullptr;
     }
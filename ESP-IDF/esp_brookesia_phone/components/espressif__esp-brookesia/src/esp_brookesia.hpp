@@ -18,16 +18,19 @@
 #include "core/esp_brookesia_core_manager.hpp"
 #include "core/esp_brookesia_core.hpp"
 #include "core/esp_brookesia_core_event.hpp"
+#include "core/esp_brookesia_core_ui_queue.hpp"
 #include "core/esp_brookesia_stylesheet_template.hpp"
 
 /* Widgets */
 // App Launcher
 #include "widgets/app_launcher/esp_brookesia_app_launcher.hpp"
 #include "widgets/app_launcher/esp_brookesia_app_launcher_icon.hpp"
+#include "widgets/app_launcher/esp_brookesia_app_launcher_icon_atlas.hpp"
 // Recents Screen
 #include "widgets/recents_screen/esp_brookesia_recents_screen.hpp"
 // Gesture
 #include "widgets/gesture/esp_brookesia_gesture.hpp"
+#include "widgets/gesture/esp_brookesia_gesture_tracker.hpp"
 // Navigation Bar
 #include "widgets/navigation_bar/esp_brookesia_navigation_bar.hpp"
 // Status Bar
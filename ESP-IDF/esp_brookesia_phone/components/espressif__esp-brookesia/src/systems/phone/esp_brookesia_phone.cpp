@@ -45,7 +45,7 @@ bool ESP_Brookesia_Phone::begin(void)
     if (getStylesheetCount() == 0) {
         ESP_BROOKESIA_LOGW("No phone stylesheet is added, adding default dark stylesheet(%s)",
                            _default_stylesheet_dark.core.name);
-        ESP_BROOKESIA_CHECK_FALSE_GOTO(ret = addStylesheet(_default_stylesheet_dark), end,
+        ESP_BROOKESIA_CHECK_FALSE_GOTO(ret = addStaticStylesheet(_default_stylesheet_dark), end,
                                        "Failed to add default stylesheet");
     }
     // Check if any phone stylesheet is activated, if not, activate default stylesheet
@@ -116,6 +116,18 @@ bool ESP_Brookesia_Phone::addStylesheet(const ESP_Brookesia_PhoneStylesheet_t *s
     return true;
 }
 
+bool ESP_Brookesia_Phone::addStaticStylesheet(const ESP_Brookesia_PhoneStylesheet_t &stylesheet)
+{
+    ESP_BROOKESIA_LOGD("Add phone(0x%p) static stylesheet", this);
+
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(
+        ESP_Brookesia_PhoneStylesheet::addStaticStylesheet(stylesheet.core.name, stylesheet.core.screen_size,
+                stylesheet), false, "Failed to add phone static stylesheet"
+    );
+
+    return true;
+}
+
 bool ESP_Brookesia_Phone::activateStylesheet(const ESP_Brookesia_PhoneStylesheet_t &stylesheet)
 {
     ESP_BROOKESIA_LOGD("Activate phone(0x%p) stylesheet", this);
@@ -23,6 +23,10 @@ public:
 
     int installApp(ESP_Brookesia_PhoneApp &app)    { return _core_manager.installApp(app); }
     int installApp(ESP_Brookesia_PhoneApp *app)    { return _core_manager.installApp(app); }
+    int installApp(ESP_Brookesia_PhoneApp *app, ESP_Brookesia_CoreAppInitMode_t init_mode)
+    {
+        return _core_manager.installApp(app, init_mode);
+    }
     int uninstallApp(ESP_Brookesia_PhoneApp &app)  { return _core_manager.uninstallApp(app); }
     int uninstallApp(ESP_Brookesia_PhoneApp *app)  { return _core_manager.uninstallApp(app); }
     bool uninstallApp(int id)               { return _core_manager.uninstallApp(id); }
@@ -31,6 +35,8 @@ public:
     bool del(void);
     bool addStylesheet(const ESP_Brookesia_PhoneStylesheet_t &stylesheet);
     bool addStylesheet(const ESP_Brookesia_PhoneStylesheet_t *stylesheet);
+    // The stylesheet isn't copied, it must be kept until the phone is deleted, e.g. a `static const` one in flash
+    bool addStaticStylesheet(const ESP_Brookesia_PhoneStylesheet_t &stylesheet);
     bool activateStylesheet(const ESP_Brookesia_PhoneStylesheet_t &stylesheet);
     bool activateStylesheet(const ESP_Brookesia_PhoneStylesheet_t *stylesheet);
 
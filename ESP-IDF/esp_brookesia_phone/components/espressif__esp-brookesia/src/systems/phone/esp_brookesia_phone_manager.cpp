@@ -27,7 +27,9 @@ ESP_Brookesia_PhoneManager::ESP_Brookesia_PhoneManager(ESP_Brookesia_Core &core_
     _recents_screen_drag_tan_threshold(0),
     _recents_screen_start_point{},
     _recents_screen_last_point{},
-    _recents_screen_active_app(nullptr)
+    _recents_screen_active_app(nullptr),
+    _recents_screen_pause_app(nullptr),
+    _app_prewarm_timer(nullptr)
 {
 }
 
@@ -147,6 +149,13 @@ bool ESP_Brookesia_PhoneManager::begin(void)
     if (gesture != nullptr) {
         _gesture = std::move(gesture);
     }
+    // App Prewarm
+    if (data.app_prewarm_idle_ms > 0) {
+        // Check twice per idle time, so an app is prewarmed at most 1.5 idle time after the last input
+        _app_prewarm_timer = ESP_BROOKESIA_LV_TIMER(onAppPrewarmTimerCallback,
+                             max<uint32_t>(data.app_prewarm_idle_ms / 2, 1), this);
+        ESP_BROOKESIA_CHECK_NULL_RETURN(_app_prewarm_timer, false, "Create app prewarm timer failed");
+    }
     _flags.is_initialized = true;
 
     ESP_BROOKESIA_CHECK_FALSE_RETURN(processHomeScreenChange(ESP_BROOKESIA_PHONE_MANAGER_SCREEN_MAIN, nullptr), false,
@@ -168,6 +177,8 @@ bool ESP_Brookesia_PhoneManager::del(void)
     if (_gesture != nullptr) {
         _gesture.reset();
     }
+    _app_prewarm_timer.reset();
+    _app_prewarm_failed_ids.clear();
     if (home.getRecentsScreen() != nullptr) {
         temp_obj = home.getRecentsScreen()->getEventObject();
         if (temp_obj != nullptr && lv_obj_is_valid(temp_obj)) {
@@ -713,9 +724,10 @@ void ESP_Brookesia_PhoneManager::onGestureNavigationReleaseEventCallback(lv_even
         return;
     }
 
-    // Check if there is a "home" gesture
+    // Check if there is a "home" gesture, a short flick is enough if it would go far enough
     if ((gesture_info->start_area & ESP_BROOKESIA_GESTURE_AREA_BOTTOM_EDGE) && (gesture_info->flags.short_duration) &&
-            (gesture_info->direction & ESP_BROOKESIA_GESTURE_DIR_UP) && manager->_flags.enable_gesture_navigation_home) {
+            ((gesture_info->direction | gesture_info->fling_direction) & ESP_BROOKESIA_GESTURE_DIR_UP) &&
+            manager->_flags.enable_gesture_navigation_home) {
         navigation_type = ESP_BROOKESIA_CORE_NAVIGATE_TYPE_HOME;
     }
 
@@ -1074,6 +1086,7 @@ void ESP_Brookesia_PhoneManager::onRecentsScreenGestureReleaseEventCallback(lv_e
     int distance_move_down_threshold = 0;
     int distance_move_up_exit_threshold = 0;
     int distance_y = 0;
+    int fling_distance_y = 0;
     int state = RECENTS_SCREEN_NONE;
     lv_event_code_t event_code = _LV_EVENT_LAST;
     lv_point_t start_point = { 0 };
@@ -1123,12 +1136,14 @@ void ESP_Brookesia_PhoneManager::onRecentsScreenGestureReleaseEventCallback(lv_e
 
     data = &manager->data;
     distance_y = gesture_info->stop_y - gesture_info->start_y;
+    fling_distance_y = gesture_info->fling_stop_y - gesture_info->start_y;
     distance_move_up_threshold = -1 * data->recents_screen.drag_snapshot_y_step + 1;
     distance_move_down_threshold = -distance_move_up_threshold;
     distance_move_up_exit_threshold = -1 * data->recents_screen.delete_snapshot_y_threshold;
     if ((distance_y > distance_move_up_threshold) && (distance_y < distance_move_down_threshold)) {
         state |= RECENTS_SCREEN_APP_SHOW | RECENTS_SCREEN_HIDE;
-    } else if (distance_y <= distance_move_up_exit_threshold) {
+    } else if ((distance_y <= distance_move_up_exit_threshold) || (fling_distance_y <= distance_move_up_exit_threshold)) {
+        // The snapshot is dragged or flung out of the screen
         state |= RECENTS_SCREEN_APP_CLOSE;
     }
 
@@ -1217,3 +1232,78 @@ void ESP_Brookesia_PhoneManager::onRecentsScreenSnapshotDeletedEventCallback(lv_
         }
     }
 }
+
+bool ESP_Brookesia_PhoneManager::checkAppPrewarmIdle(void) const
+{
+    const ESP_Brookesia_AppLauncher *app_launcher = home.getAppLauncher();
+    const ESP_Brookesia_RecentsScreen *recents_screen = home.getRecentsScreen();
+
+    // Only while the user lingers on the launcher, so the init never delays an interaction
+    return (_home_active_screen == ESP_BROOKESIA_PHONE_MANAGER_SCREEN_MAIN) && (getActiveApp() == nullptr) &&
+           app_launcher->checkVisible() && ((recents_screen == nullptr) || !recents_screen->checkVisible()) &&
+           (lv_disp_get_inactive_time(_core.getDisplayDevice()) >= data.app_prewarm_idle_ms);
+}
+
+bool ESP_Brookesia_PhoneManager::processAppPrewarm(void)
+{
+    ESP_Brookesia_AppLauncher *app_launcher = home.getAppLauncher();
+    lv_indev_t *touch = _core.getTouchDevice();
+    ESP_Brookesia_CoreApp *app = nullptr;
+    std::vector<int> ids;
+
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
+
+    if (!checkAppPrewarmIdle()) {
+        return true;
+    }
+
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(app_launcher->getPageIconIds(app_launcher->getActiveScreenIndex(), ids), false,
+                                     "Get page icon ids failed");
+    // One app per period, the next one waits for the next period
+    for (int id : ids) {
+        if (_app_prewarm_failed_ids.count(id)) {
+            continue;
+        }
+        app = getInstalledApp(id);
+        if ((app != nullptr) && app->checkInitPending()) {
+            break;
+        }
+        app = nullptr;
+    }
+    if (app == nullptr) {
+        return true;
+    }
+
+    // The init runs in the LVGL task and can't be interrupted, so read the touch right before it. A press since the
+    // last read resets the inactive time, then the prewarm waits for the next idle period
+    if (touch == nullptr) {
+        touch = esp_brookesia_core_utils_get_input_dev(_core.getDisplayDevice(), LV_INDEV_TYPE_POINTER);
+    }
+    if ((touch != nullptr) && (touch->driver->read_timer != nullptr)) {
+        lv_indev_read_timer_cb(touch->driver->read_timer);
+    }
+    // The events of the read may have started an app or changed the screen
+    if (!checkAppPrewarmIdle() || (getInstalledApp(app->getId()) != app) || !app->checkInitPending()) {
+        return true;
+    }
+
+    if (!prewarmApp(app)) {
+        // It will be initialized again when it's started
+        ESP_BROOKESIA_LOGE("Prewarm app(%d) failed", app->getId());
+        _app_prewarm_failed_ids.insert(app->getId());
+    }
+
+    return true;
+}
+
+void ESP_Brookesia_PhoneManager::onAppPrewarmTimerCallback(lv_timer_t *timer)
+{
+    ESP_Brookesia_PhoneManager *manager = nullptr;
+
+    ESP_BROOKESIA_CHECK_NULL_EXIT(timer, "Invalid timer");
+
+    manager = static_cast<ESP_Brookesia_PhoneManager *>(timer->user_data);
+    ESP_BROOKESIA_CHECK_NULL_EXIT(manager, "Invalid manager");
+
+    ESP_BROOKESIA_CHECK_FALSE_EXIT(manager->processAppPrewarm(), "Process app prewarm failed");
+}
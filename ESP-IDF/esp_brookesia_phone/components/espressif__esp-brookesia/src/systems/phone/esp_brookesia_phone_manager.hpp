@@ -6,6 +6,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include "lvgl.h"
 #include "core/esp_brookesia_core_manager.hpp"
 #include "widgets/gesture/esp_brookesia_gesture.hpp"
@@ -62,6 +63,10 @@ private:
     static void onRecentsScreenGesturePressingEventCallback(lv_event_t *event);
     static void onRecentsScreenGestureReleaseEventCallback(lv_event_t *event);
     static void onRecentsScreenSnapshotDeletedEventCallback(lv_event_t *event);
+    // App Prewarm
+    bool checkAppPrewarmIdle(void) const;
+    bool processAppPrewarm(void);
+    static void onAppPrewarmTimerCallback(lv_timer_t *timer);
 
     // Flags
     struct {
@@ -101,5 +106,8 @@ private:
     lv_point_t _recents_screen_last_point;
     ESP_Brookesia_CoreApp *_recents_screen_active_app;
     ESP_Brookesia_CoreApp *_recents_screen_pause_app;
+    // App Prewarm
+    ESP_Brookesia_LvTimer_t _app_prewarm_timer;
+    std::set<int> _app_prewarm_failed_ids;
 };
 // *INDENT-OFF*
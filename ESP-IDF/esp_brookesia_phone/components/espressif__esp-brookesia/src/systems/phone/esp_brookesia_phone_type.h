@@ -59,6 +59,9 @@ typedef struct {
         uint16_t drag_snapshot_angle_threshold;
         uint16_t delete_snapshot_y_threshold;
     } recents_screen;
+    uint32_t app_prewarm_idle_ms;   /* The apps installed with `ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND` on the page of the
+                                       app launcher are initialized one by one after the home screen has been idle for
+                                       this time. Set to 0 to disable */
     struct {
         uint8_t enable_gesture: 1;
         uint8_t enable_gesture_navigation_back: 1;
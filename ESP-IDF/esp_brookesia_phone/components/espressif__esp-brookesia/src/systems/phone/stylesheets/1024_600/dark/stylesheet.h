@@ -57,6 +57,7 @@ extern "C" {
             .drag_snapshot_angle_threshold = 60,              \
             .delete_snapshot_y_threshold = 50,                \
         },                                                    \
+        .app_prewarm_idle_ms = 1000,                          \
         .flags = {                                            \
             .enable_gesture = 1,                              \
             .enable_gesture_navigation_back = 1,             \
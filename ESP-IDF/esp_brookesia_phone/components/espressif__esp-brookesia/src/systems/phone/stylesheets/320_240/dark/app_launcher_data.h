@@ -49,6 +49,7 @@ extern "C" {
         .icon = ESP_BROOKESIA_PHONE_320_240_DARK_APP_LAUNCHER_ICON_DATA(),         \
         .flags = {                                                          \
             .enable_table_scroll_anim = 0,                                  \
+            .enable_icon_atlas = 0,                                         \
         },                                                                  \
     }
 
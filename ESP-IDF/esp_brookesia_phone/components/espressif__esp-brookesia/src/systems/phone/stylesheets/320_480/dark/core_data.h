@@ -63,8 +63,14 @@ extern "C" {
         .app = {                                      \
             .max_running_num = 3,                     \
         },                                            \
+        .memory = {                                   \
+            .trim_free_size = 512 * 1024,             \
+            .close_free_size = 256 * 1024,            \
+            .check_period_ms = 1000,                  \
+        },                                            \
         .flags = {                                    \
             .enable_app_save_snapshot = 1,            \
+            .enable_memory_pressure_check = 0,        \
         },                                            \
     }
 
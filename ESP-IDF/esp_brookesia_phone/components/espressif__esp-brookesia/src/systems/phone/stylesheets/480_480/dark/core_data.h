@@ -65,8 +65,14 @@ LV_IMG_DECLARE(esp_brookesia_image_middle_wallpaper_image_dark);
         .app = {                                      \
             .max_running_num = 3,                     \
         },                                            \
+        .memory = {                                   \
+            .trim_free_size = 512 * 1024,             \
+            .close_free_size = 256 * 1024,            \
+            .check_period_ms = 1000,                  \
+        },                                            \
         .flags = {                                    \
             .enable_app_save_snapshot = 1,            \
+            .enable_memory_pressure_check = 0,        \
         },                                            \
     }
 
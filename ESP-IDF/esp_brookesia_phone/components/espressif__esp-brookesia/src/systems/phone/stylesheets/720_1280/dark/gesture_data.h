@@ -60,6 +60,7 @@ extern "C" {
             .vertical_edge = 30, \
             .duration_short_ms = 600,                                               \
             .speed_slow_px_per_ms = 0.1,                                            \
+            .fling_deceleration_px_per_ms2 = 0.005,                                 \
         },                                                                          \
         .indicator_bars = {                                                         \
             [ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_LEFT] =                              \
@@ -129,6 +129,10 @@ bool ESP_Brookesia_AppLauncher::del(void)
     _indicator_obj.reset();
     _mix_objs.clear();
     _id_mix_icon_map.clear();
+    if (!_icon_atlas.del()) {
+        ESP_BROOKESIA_LOGE("Delete icon atlas failed");
+        ret = false;
+    }
 
     return ret;
 }
@@ -164,7 +168,7 @@ bool ESP_Brookesia_AppLauncher::addIcon(uint8_t page_index, const ESP_Brookesia_
     }
     mix_icon.current_page_index = page_index;
 
-    mix_icon.icon = make_shared<ESP_Brookesia_AppLauncherIcon>(_core, info, _data.icon);
+    mix_icon.icon = make_shared<ESP_Brookesia_AppLauncherIcon>(_core, info, _data.icon, _icon_atlas);
     ESP_BROOKESIA_CHECK_NULL_RETURN(mix_icon.icon, false, "Create icon failed");
 
     ESP_BROOKESIA_CHECK_FALSE_RETURN(mix_icon.icon->begin(_mix_objs[page_index].page_obj.get()), false,
@@ -303,6 +307,21 @@ bool ESP_Brookesia_AppLauncher::checkPointInsideMain(lv_point_t &point) const
     return _lv_area_is_point_on(&area, &point, lv_obj_get_style_radius(_main_obj.get(), 0));
 }
 
+bool ESP_Brookesia_AppLauncher::getPageIconIds(uint8_t page_index, std::vector<int> &ids) const
+{
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(page_index < _mix_objs.size(), false, "Invalid page index");
+
+    ids.clear();
+    for (auto &id_mix_icon : _id_mix_icon_map) {
+        if (id_mix_icon.second.current_page_index == page_index) {
+            ids.push_back(id_mix_icon.first);
+        }
+    }
+
+    return true;
+}
+
 bool ESP_Brookesia_AppLauncher::calibrateData(const ESP_Brookesia_StyleSize_t &screen_size, const ESP_Brookesia_CoreHome &home,
         ESP_Brookesia_AppLauncherData_t &data)
 {
@@ -504,6 +523,28 @@ bool ESP_Brookesia_AppLauncher::updateActiveSpot(void)
     return true;
 }
 
+bool ESP_Brookesia_AppLauncher::updateIconAtlas(void)
+{
+    const ESP_Brookesia_StyleSize_t &icon_size = _data.icon.image.default_size;
+
+    ESP_BROOKESIA_LOGD("Update icon atlas");
+
+    // The icons are scaled to the old size, so they should be drawn again
+    if (_icon_atlas.checkInitialized() && (!_data.flags.enable_icon_atlas ||
+                                          (_icon_atlas.getIconSize().width != icon_size.width) ||
+                                          (_icon_atlas.getIconSize().height != icon_size.height))) {
+        for (auto &id_icon : _id_mix_icon_map) {
+            id_icon.second.icon->releaseAtlasImage();
+        }
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(_icon_atlas.del(), false, "Delete icon atlas failed");
+    }
+    if (_data.flags.enable_icon_atlas && !_icon_atlas.checkInitialized()) {
+        ESP_BROOKESIA_CHECK_FALSE_RETURN(_icon_atlas.begin(icon_size), false, "Begin icon atlas failed");
+    }
+
+    return true;
+}
+
 bool ESP_Brookesia_AppLauncher::updateByNewData(void)
 {
     uint8_t app_num_hor = 0;
@@ -519,6 +560,9 @@ bool ESP_Brookesia_AppLauncher::updateByNewData(void)
     ESP_BROOKESIA_LOGD("Update(0x%p)", this);
     ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), false, "Not initialized");
 
+    // Update the atlas first, so the icons moved to other tables use the new size
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(updateIconAtlas(), false, "Update icon atlas failed");
+
     // Calculate the max amount of app's icons in column and row.
     app_num_hor = _data.table.size.width / _data.icon.main.size.width;
     app_num_ver = _data.table.size.height / _data.icon.main.size.height;
@@ -30,7 +30,9 @@ public:
     bool checkTableFull(uint8_t page_index) const;
     bool checkVisible(void) const;
     bool checkPointInsideMain(lv_point_t &point) const;
+    bool getPageIconIds(uint8_t page_index, std::vector<int> &ids) const;
     uint8_t getActiveScreenIndex(void) const { return _table_current_page_index; }
+    const ESP_Brookesia_AppLauncherIconAtlas &getIconAtlas(void) const { return _icon_atlas; }
 
     static bool calibrateData(const ESP_Brookesia_StyleSize_t &screen_size, const ESP_Brookesia_CoreHome &home,
                               ESP_Brookesia_AppLauncherData_t &data);
@@ -55,6 +57,7 @@ private:
     bool togglePageIconClickable(uint8_t page_index, bool clickable);
     bool toggleCurrentPageIconClickable(bool clickable);
     bool updateActiveSpot(void);
+    bool updateIconAtlas(void);
     bool updateByNewData(void);
 
     static void onDataUpdateEventCallback(lv_event_t *event);
@@ -72,6 +75,7 @@ private:
     ESP_Brookesia_LvObj_t _table_obj;
     ESP_Brookesia_LvObj_t _indicator_obj;
     std::vector <ESP_Brookesia_AppLauncherMixObject_t> _mix_objs;
+    ESP_Brookesia_AppLauncherIconAtlas _icon_atlas;
     std::map <int, ESP_Brookesia_AppLauncherMixIcon_t> _id_mix_icon_map;
 };
 // *INDENT-OFF*
@@ -13,13 +13,15 @@
 using namespace std;
 
 ESP_Brookesia_AppLauncherIcon::ESP_Brookesia_AppLauncherIcon(ESP_Brookesia_Core &core, const ESP_Brookesia_AppLauncherIconInfo_t &info,
-        const ESP_Brookesia_AppLauncherIconData_t &data):
+        const ESP_Brookesia_AppLauncherIconData_t &data, ESP_Brookesia_AppLauncherIconAtlas &atlas):
     _core(core),
     _info(info),
     _data(data),
+    _atlas(atlas),
     _flags{},
     _image_default_zoom(LV_IMG_ZOOM_NONE),
     _image_press_zoom(LV_IMG_ZOOM_NONE),
+    _atlas_image(nullptr),
     _main_obj(nullptr),
     _icon_main_obj(nullptr),
     _icon_image_obj(nullptr),
@@ -116,6 +118,7 @@ bool ESP_Brookesia_AppLauncherIcon::del(void)
         return true;
     }
 
+    releaseAtlasImage();
     _main_obj.reset();
     _icon_main_obj.reset();
     _icon_image_obj.reset();
@@ -157,6 +160,23 @@ bool ESP_Brookesia_AppLauncherIcon::updateByNewData(void)
     lv_obj_set_style_text_color(_name_label.get(), lv_color_hex(_data.label.text_color.color), 0);
     lv_obj_set_style_text_opa(_name_label.get(), _data.label.text_color.opacity, 0);
     // Image
+    // Use the pre-scaled image in the atlas if possible, so it's drawn without zooming.
+    if ((_atlas_image == nullptr) && _atlas.checkInitialized()) {
+        _atlas_image = _atlas.addIcon(_info.image.resource);
+    }
+    if (_atlas_image != nullptr) {
+        lv_img_set_src(_icon_image_obj.get(), _atlas_image);
+        _image_default_zoom = LV_IMG_ZOOM_NONE;
+        lv_img_set_zoom(_icon_image_obj.get(), _image_default_zoom);
+        lv_obj_refr_size(_icon_image_obj.get());
+        // Only the pressed icon is zoomed, based on the pre-scaled image.
+        h_factor = (float)(_data.image.press_size.height) / _data.image.default_size.height;
+        w_factor = (float)(_data.image.press_size.width) / _data.image.default_size.width;
+        _image_press_zoom = (int)(min(h_factor, w_factor) * LV_IMG_ZOOM_NONE);
+
+        return true;
+    }
+    lv_img_set_src(_icon_image_obj.get(), _info.image.resource);
     // Calculate the multiple of the size between the target and the image.
     h_factor = (float)(_data.image.default_size.width) / ((lv_img_dsc_t *)_info.image.resource)->header.h;
     w_factor = (float)(_data.image.default_size.height) / ((lv_img_dsc_t *)_info.image.resource)->header.w;
@@ -184,6 +204,22 @@ bool ESP_Brookesia_AppLauncherIcon::updateByNewData(void)
     return true;
 }
 
+void ESP_Brookesia_AppLauncherIcon::releaseAtlasImage(void)
+{
+    if (_atlas_image == nullptr) {
+        return;
+    }
+
+    ESP_BROOKESIA_LOGD("Release atlas image(%d: @0x%p)", _info.id, this);
+    if (_icon_image_obj != nullptr) {
+        lv_img_set_src(_icon_image_obj.get(), _info.image.resource);
+    }
+    if (!_atlas.removeIcon(_info.image.resource)) {
+        ESP_BROOKESIA_LOGE("Remove icon from atlas failed");
+    }
+    _atlas_image = nullptr;
+}
+
 void ESP_Brookesia_AppLauncherIcon::onIconTouchEventCallback(lv_event_t *event)
 {
     ESP_Brookesia_AppLauncherIcon *icon = nullptr;
@@ -10,11 +10,13 @@
 #include "lvgl.h"
 #include "core/esp_brookesia_core.hpp"
 #include "esp_brookesia_app_launcher_type.h"
+#include "esp_brookesia_app_launcher_icon_atlas.hpp"
 
 // *INDENT-OFF*
 class ESP_Brookesia_AppLauncherIcon {
 public:
-    ESP_Brookesia_AppLauncherIcon(ESP_Brookesia_Core &core, const ESP_Brookesia_AppLauncherIconInfo_t &info, const ESP_Brookesia_AppLauncherIconData_t &data);
+    ESP_Brookesia_AppLauncherIcon(ESP_Brookesia_Core &core, const ESP_Brookesia_AppLauncherIconInfo_t &info, const ESP_Brookesia_AppLauncherIconData_t &data,
+                                  ESP_Brookesia_AppLauncherIconAtlas &atlas);
     ~ESP_Brookesia_AppLauncherIcon();
 
     bool begin(lv_obj_t *parent);
@@ -22,8 +24,10 @@ public:
     bool toggleClickable(bool clickable);
 
     bool checkInitialized(void) const { return (_main_obj != nullptr); }
+    lv_obj_t *getImageObject(void) const { return _icon_image_obj.get(); }
 
     bool updateByNewData(void);
+    void releaseAtlasImage(void);
 
 private:
     static void onIconTouchEventCallback(lv_event_t *event);
@@ -31,6 +35,7 @@ private:
     ESP_Brookesia_Core &_core;
     ESP_Brookesia_AppLauncherIconInfo_t _info;
     const ESP_Brookesia_AppLauncherIconData_t &_data;
+    ESP_Brookesia_AppLauncherIconAtlas &_atlas;
 
     struct {
         uint8_t is_pressed_losted: 1;
@@ -38,6 +43,7 @@ private:
     } _flags;
     uint16_t _image_default_zoom;
     uint16_t _image_press_zoom;
+    const lv_img_dsc_t *_atlas_image;   // The pre-scaled image in the atlas, nullptr if the image is zoomed
     ESP_Brookesia_LvObj_t _main_obj;
     ESP_Brookesia_LvObj_t _icon_main_obj;
     ESP_Brookesia_LvObj_t _icon_image_obj;
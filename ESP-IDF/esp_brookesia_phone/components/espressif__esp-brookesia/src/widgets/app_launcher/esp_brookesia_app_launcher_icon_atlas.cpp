@@ -0,0 +1,270 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include "esp_brookesia_app_launcher_icon_atlas.hpp"
+
+#if !ESP_BROOKESIA_LOG_ENABLE_DEBUG_WIDGETS_APP_LAUNCHER
+#undef ESP_BROOKESIA_LOGD
+#define ESP_BROOKESIA_LOGD(...)
+#endif
+
+using namespace std;
+
+ESP_Brookesia_AppLauncherIconAtlas::ESP_Brookesia_AppLauncherIconAtlas():
+    _icon_size{},
+    _cell_size(0)
+{
+}
+
+ESP_Brookesia_AppLauncherIconAtlas::~ESP_Brookesia_AppLauncherIconAtlas()
+{
+    ESP_BROOKESIA_LOGD("Destroy(@0x%p)", this);
+    if (!del()) {
+        ESP_BROOKESIA_LOGE("Delete failed");
+    }
+}
+
+bool ESP_Brookesia_AppLauncherIconAtlas::begin(const ESP_Brookesia_StyleSize_t &icon_size)
+{
+    ESP_BROOKESIA_LOGD("Begin(@0x%p)", this);
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(!checkInitialized(), false, "Initialized");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN((icon_size.width > 0) && (icon_size.height > 0), false, "Invalid icon size");
+
+    _icon_size = icon_size;
+    _cell_size = (size_t)icon_size.width * icon_size.height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    ESP_BROOKESIA_LOGD("Icon size(%dx%d), cell size(%d)", icon_size.width, icon_size.height, (int)_cell_size);
+
+    return true;
+}
+
+bool ESP_Brookesia_AppLauncherIconAtlas::del(void)
+{
+    ESP_BROOKESIA_LOGD("Delete(@0x%p)", this);
+
+    if (!checkInitialized()) {
+        return true;
+    }
+
+    if (!_icons.empty()) {
+        ESP_BROOKESIA_LOGW("There are still %d icons in use", (int)_icons.size());
+    }
+    for (auto &page : _pages) {
+        for (auto &cell : page->cells) {
+            lv_img_cache_invalidate_src(&cell);
+        }
+        lv_mem_free(page->buffer);
+    }
+    _pages.clear();
+    _icons.clear();
+    _icon_size = {};
+    _cell_size = 0;
+
+    return true;
+}
+
+const lv_img_dsc_t *ESP_Brookesia_AppLauncherIconAtlas::addIcon(const void *image)
+{
+    const lv_img_dsc_t *image_dsc = (const lv_img_dsc_t *)image;
+    Page *page = nullptr;
+    uint8_t cell = 0;
+
+    ESP_BROOKESIA_LOGD("Add icon(@0x%p)", image);
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(checkInitialized(), nullptr, "Not initialized");
+    ESP_BROOKESIA_CHECK_NULL_RETURN(image, nullptr, "Invalid image");
+
+    auto it = _icons.find(image);
+    if (it != _icons.end()) {
+        it->second.ref_count++;
+        return it->second.image;
+    }
+
+    if (!checkImageSupported(image)) {
+        ESP_BROOKESIA_LOGD("Image is not supported, skip");
+        return nullptr;
+    }
+
+    // The image already has the icon size, no need to scale
+    if ((image_dsc->header.w == _icon_size.width) && (image_dsc->header.h == _icon_size.height)) {
+        _icons[image] = {nullptr, 0, 1, image_dsc};
+        return image_dsc;
+    }
+
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(allocCell(page, cell), nullptr, "Alloc cell failed");
+    drawIcon(*image_dsc, page->cells[cell]);
+    _icons[image] = {page, cell, 1, &page->cells[cell]};
+
+    return &page->cells[cell];
+}
+
+bool ESP_Brookesia_AppLauncherIconAtlas::removeIcon(const void *image)
+{
+    ESP_BROOKESIA_LOGD("Remove icon(@0x%p)", image);
+
+    auto it = _icons.find(image);
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(it != _icons.end(), false, "Icon is not found");
+
+    if (--it->second.ref_count > 0) {
+        return true;
+    }
+    if (it->second.page != nullptr) {
+        freeCell(it->second.page, it->second.cell);
+    }
+    _icons.erase(it);
+
+    return true;
+}
+
+size_t ESP_Brookesia_AppLauncherIconAtlas::getMemorySize(void) const
+{
+    return _pages.size() * _cell_size * ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM;
+}
+
+bool ESP_Brookesia_AppLauncherIconAtlas::checkImageSupported(const void *image)
+{
+    if ((image == nullptr) || (lv_img_src_get_type(image) != LV_IMG_SRC_VARIABLE)) {
+        return false;
+    }
+
+    const lv_img_dsc_t *image_dsc = (const lv_img_dsc_t *)image;
+    if ((image_dsc->data == nullptr) || (image_dsc->header.w == 0) || (image_dsc->header.h == 0)) {
+        return false;
+    }
+
+    switch (image_dsc->header.cf) {
+    case LV_IMG_CF_TRUE_COLOR:
+    case LV_IMG_CF_TRUE_COLOR_ALPHA:
+    case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ESP_Brookesia_AppLauncherIconAtlas::allocCell(Page *&page, uint8_t &cell)
+{
+    constexpr uint8_t full_mask = (1 << ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM) - 1;
+
+    for (auto &p : _pages) {
+        if (p->used_mask != full_mask) {
+            page = p.get();
+            break;
+        }
+    }
+
+    if (page == nullptr) {
+        unique_ptr<Page> new_page(new (nothrow) Page{});
+        ESP_BROOKESIA_CHECK_NULL_RETURN(new_page, false, "Alloc page failed");
+        new_page->buffer = (uint8_t *)lv_mem_alloc(_cell_size * ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM);
+        ESP_BROOKESIA_CHECK_NULL_RETURN(new_page->buffer, false, "Alloc page buffer failed");
+        // Cells are stacked vertically, so each one is a contiguous image
+        for (int i = 0; i < ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM; i++) {
+            lv_img_dsc_t &dsc = new_page->cells[i];
+            dsc.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+            dsc.header.always_zero = 0;
+            dsc.header.w = _icon_size.width;
+            dsc.header.h = _icon_size.height;
+            dsc.data_size = _cell_size;
+            dsc.data = new_page->buffer + i * _cell_size;
+        }
+        page = new_page.get();
+        _pages.push_back(std::move(new_page));
+        ESP_BROOKESIA_LOGD("Alloc page(%d)", (int)_pages.size());
+    }
+
+    for (cell = 0; cell < ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM; cell++) {
+        if (!(page->used_mask & (1 << cell))) {
+            break;
+        }
+    }
+    page->used_mask |= (1 << cell);
+
+    return true;
+}
+
+void ESP_Brookesia_AppLauncherIconAtlas::freeCell(Page *page, uint8_t cell)
+{
+    // The decoded cell may be cached by LVGL, and the buffer will be reused by another icon
+    lv_img_cache_invalidate_src(&page->cells[cell]);
+    page->used_mask &= ~(1 << cell);
+    if (page->used_mask != 0) {
+        return;
+    }
+
+    auto it = find_if(_pages.begin(), _pages.end(), [page](const unique_ptr<Page> &p) {
+        return (p.get() == page);
+    });
+    if (it != _pages.end()) {
+        lv_mem_free(page->buffer);
+        _pages.erase(it);
+        ESP_BROOKESIA_LOGD("Free page(%d)", (int)_pages.size());
+    }
+}
+
+void ESP_Brookesia_AppLauncherIconAtlas::drawIcon(const lv_img_dsc_t &image, lv_img_dsc_t &cell) const
+{
+    // The getters of LVGL take a non-const descriptor, but only read it
+    lv_img_dsc_t *src = const_cast<lv_img_dsc_t *>(&image);
+    const int src_w = image.header.w;
+    const int src_h = image.header.h;
+    const int cell_w = cell.header.w;
+    const int cell_h = cell.header.h;
+    const bool has_alpha = (image.header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA);
+    const bool has_chroma_key = (image.header.cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED);
+    // Keep the aspect ratio and center the image in the cell, the same as zooming it
+    const float scale = min((float)cell_w / src_w, (float)cell_h / src_h);
+    const int fit_w = max(1, min(cell_w, (int)lroundf(src_w * scale)));
+    const int fit_h = max(1, min(cell_h, (int)lroundf(src_h * scale)));
+    const int offset_x = (cell_w - fit_w) / 2;
+    const int offset_y = (cell_h - fit_h) / 2;
+    const float step_x = (float)src_w / fit_w;
+    const float step_y = (float)src_h / fit_h;
+    const lv_color_t chroma_key = LV_COLOR_CHROMA_KEY;
+
+    memset((void *)cell.data, 0, cell.data_size);
+
+    // Average the source area covered by each target pixel, the colors are weighted by alpha to avoid dark edges
+    for (int y = 0; y < fit_h; y++) {
+        const float y0 = y * step_y;
+        const float y1 = min((float)src_h, y0 + step_y);
+        for (int x = 0; x < fit_w; x++) {
+            const float x0 = x * step_x;
+            const float x1 = min((float)src_w, x0 + step_x);
+            float sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0, sum_weight = 0;
+
+            for (int sy = (int)y0; sy < y1; sy++) {
+                const float weight_y = min(y1, (float)(sy + 1)) - max(y0, (float)sy);
+                for (int sx = (int)x0; sx < x1; sx++) {
+                    const float weight = weight_y * (min(x1, (float)(sx + 1)) - max(x0, (float)sx));
+                    lv_color_t color = lv_img_buf_get_px_color(src, sx, sy, chroma_key);
+                    float alpha = LV_OPA_COVER;
+                    if (has_alpha) {
+                        alpha = lv_img_buf_get_px_alpha(src, sx, sy);
+                    } else if (has_chroma_key && (color.full == chroma_key.full)) {
+                        alpha = LV_OPA_TRANSP;
+                    }
+                    const uint32_t rgb = lv_color_to32(color);
+                    const float weight_alpha = weight * alpha;
+                    sum_r += weight_alpha * ((rgb >> 16) & 0xff);
+                    sum_g += weight_alpha * ((rgb >> 8) & 0xff);
+                    sum_b += weight_alpha * (rgb & 0xff);
+                    sum_a += weight_alpha;
+                    sum_weight += weight;
+                }
+            }
+
+            if ((sum_a <= 0) || (sum_weight <= 0)) {
+                continue;
+            }
+            const lv_color_t color = lv_color_make((uint8_t)lroundf(sum_r / sum_a), (uint8_t)lroundf(sum_g / sum_a),
+                                                   (uint8_t)lroundf(sum_b / sum_a));
+            lv_img_buf_set_px_color(&cell, offset_x + x, offset_y + y, color);
+            lv_img_buf_set_px_alpha(&cell, offset_x + x, offset_y + y, (lv_opa_t)lroundf(sum_a / sum_weight));
+        }
+    }
+}
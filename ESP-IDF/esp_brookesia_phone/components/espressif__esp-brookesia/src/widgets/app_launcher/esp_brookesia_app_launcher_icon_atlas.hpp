@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "lvgl.h"
+#include "core/esp_brookesia_core.hpp"
+
+// The number of icons in each page of the atlas, a page is allocated at once
+#define ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM     (4)
+
+/**
+ * The launcher icons pre-scaled to the icon size of the stylesheet. The cells of a page are stacked vertically in one
+ * buffer of `LV_IMG_CF_TRUE_COLOR_ALPHA`, so each cell is a contiguous image which is drawn without any transformation.
+ * An icon which already has the icon size is used directly.
+ */
+// *INDENT-OFF*
+class ESP_Brookesia_AppLauncherIconAtlas {
+public:
+    ESP_Brookesia_AppLauncherIconAtlas();
+    ~ESP_Brookesia_AppLauncherIconAtlas();
+
+    bool begin(const ESP_Brookesia_StyleSize_t &icon_size);
+    bool del(void);
+
+    const lv_img_dsc_t *addIcon(const void *image);
+    bool removeIcon(const void *image);
+
+    bool checkInitialized(void) const                   { return (_icon_size.width > 0); }
+    const ESP_Brookesia_StyleSize_t &getIconSize(void) const { return _icon_size; }
+    size_t getIconCount(void) const                     { return _icons.size(); }
+    size_t getMemorySize(void) const;
+
+    static bool checkImageSupported(const void *image);
+
+private:
+    struct Page {
+        uint8_t *buffer;
+        lv_img_dsc_t cells[ESP_BROOKESIA_APP_LAUNCHER_ICON_ATLAS_PAGE_CELL_NUM];
+        uint8_t used_mask;
+    };
+    struct Icon {
+        Page *page;             // nullptr if the image is used directly
+        uint8_t cell;
+        int ref_count;
+        const lv_img_dsc_t *image;
+    };
+
+    bool allocCell(Page *&page, uint8_t &cell);
+    void freeCell(Page *page, uint8_t cell);
+    void drawIcon(const lv_img_dsc_t &image, lv_img_dsc_t &cell) const;
+
+    ESP_Brookesia_StyleSize_t _icon_size;
+    size_t _cell_size;
+    std::vector<std::unique_ptr<Page>> _pages;
+    std::map<const void *, Icon> _icons;
+};
+// *INDENT-OFF*
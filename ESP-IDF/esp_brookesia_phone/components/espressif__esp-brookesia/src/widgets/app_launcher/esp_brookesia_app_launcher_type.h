@@ -53,6 +53,7 @@ typedef struct {
     ESP_Brookesia_AppLauncherIconData_t icon;
     struct {
         uint8_t enable_table_scroll_anim: 1;
+        uint8_t enable_icon_atlas: 1;
     } flags;
 } ESP_Brookesia_AppLauncherData_t;
 
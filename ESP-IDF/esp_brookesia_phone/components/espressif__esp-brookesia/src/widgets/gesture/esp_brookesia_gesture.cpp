@@ -3,8 +3,8 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
-#include <limits>
 #include <cmath>
+#include <map>
 #include "esp_brookesia_gesture.hpp"
 
 #if !ESP_BROOKESIA_LOG_ENABLE_DEBUG_WIDGETS_GESTURE
@@ -24,13 +24,23 @@ using namespace std;
         .stop_x = -1,                             \
         .stop_y = -1,                             \
         .duration_ms = 0,                         \
+        .velocity_x_px_per_ms = 0,                \
+        .velocity_y_px_per_ms = 0,                \
+        .speed_px_per_ms = 0,                     \
         .distance_px = 0,                         \
+        .fling_stop_x = -1,                       \
+        .fling_stop_y = -1,                       \
+        .fling_direction = ESP_BROOKESIA_GESTURE_DIR_NONE, \
         .flags = {                                \
             .slow_speed = 0,                      \
             .short_duration = 0,                  \
         },                                        \
     }
 
+// The touch drivers whose read callbacks are chained by the gestures. LVGL v8 only passes the driver to the callback and
+// its `user_data` belongs to the port, so the gesture is found here.
+static map<lv_indev_drv_t *, ESP_Brookesia_Gesture *> touch_driver_gesture_map;
+
 ESP_Brookesia_Gesture::ESP_Brookesia_Gesture(ESP_Brookesia_Core &core_in, const ESP_Brookesia_GestureData_t &data_in):
     core(core_in),
     data(data_in),
@@ -40,7 +50,10 @@ ESP_Brookesia_Gesture::ESP_Brookesia_Gesture(ESP_Brookesia_Core &core_in, const
     _indicator_bar_min_lengths{},
     _indicator_bar_max_lengths{},
     _touch_start_tick(0),
-    _detect_timer(nullptr),
+    _pressing_event_tick(0),
+    _touch_read_cb(nullptr),
+    _touch_process_timer(nullptr),
+    _tracker(),
     _event_mask_obj(nullptr),
     _indicator_bars{},
     _indicator_bar_anim_var{},
@@ -64,7 +77,8 @@ ESP_Brookesia_Gesture::~ESP_Brookesia_Gesture()
 
 bool ESP_Brookesia_Gesture::begin(lv_obj_t *parent)
 {
-    ESP_Brookesia_LvTimer_t detect_timer = nullptr;
+    lv_indev_drv_t *touch_driver = nullptr;
+    ESP_Brookesia_LvTimer_t touch_process_timer = nullptr;
     ESP_Brookesia_LvObj_t event_mask_obj = nullptr;
     array<ESP_Brookesia_LvObj_t, ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX> indicator_bars = {};
     array<ESP_Brookesia_LvAnim_t, ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX> indicator_bar_scale_back_anims = {};
@@ -74,10 +88,15 @@ bool ESP_Brookesia_Gesture::begin(lv_obj_t *parent)
 
     ESP_BROOKESIA_LOGD("Begin(0x%p)", this);
     ESP_BROOKESIA_CHECK_NULL_RETURN(core.getTouchDevice(), false, "Invalid core touch device");
+    touch_driver = core.getTouchDevice()->driver;
+    ESP_BROOKESIA_CHECK_FALSE_RETURN((touch_driver != nullptr) && (touch_driver->read_cb != nullptr), false,
+                                     "Invalid touch device driver");
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(touch_driver_gesture_map.find(touch_driver) == touch_driver_gesture_map.end(),
+                                     false, "Touch device is already used by another gesture");
 
     /* Create objects */
-    detect_timer = ESP_BROOKESIA_LV_TIMER(onTouchDetectTimerCallback, data.detect_period_ms, this);
-    ESP_BROOKESIA_CHECK_NULL_RETURN(detect_timer, false, "Create detect timer failed");
+    touch_process_timer = ESP_BROOKESIA_LV_TIMER(onTouchProcessTimerCallback, 0, this);
+    ESP_BROOKESIA_CHECK_NULL_RETURN(touch_process_timer, false, "Create touch process timer failed");
     event_mask_obj = ESP_BROOKESIA_LV_OBJ(obj, parent);
     ESP_BROOKESIA_CHECK_NULL_RETURN(event_mask_obj, false, "Create event & mask object failed");
     press_event_code = core.getFreeEventCode();
@@ -122,9 +141,17 @@ bool ESP_Brookesia_Gesture::begin(lv_obj_t *parent)
         lv_anim_set_ready_cb(indicator_bar_scale_back_anims[i].get(), onIndicatorBarScaleBackAnimationReadyCallback);
     }
 
+    // Touch process timer, it's paused between the reads of the touch device instead of polling it
+    lv_timer_pause(touch_process_timer.get());
+
+    // Chain the read callback of the touch driver to know when a new point is read
+    _touch_read_cb = touch_driver->read_cb;
+    touch_driver->read_cb = onTouchReadCallback;
+    touch_driver_gesture_map[touch_driver] = this;
+
     // Save objects
     _touch_device = core.getTouchDevice();
-    _detect_timer = detect_timer;
+    _touch_process_timer = touch_process_timer;
     _event_mask_obj = event_mask_obj;
     _press_event_code = press_event_code;
     _pressing_event_code = pressing_event_code;
@@ -149,7 +176,22 @@ bool ESP_Brookesia_Gesture::del(void)
 
     _direction_tan_threshold = 0;
     _touch_start_tick = 0;
-    _detect_timer.reset();
+    _pressing_event_tick = 0;
+    if (_touch_read_cb != nullptr) {
+        // The touch device may have been deleted before the gesture, then its driver can't be reached anymore
+        if (checkTouchDeviceRegistered()) {
+            _touch_device->driver->read_cb = _touch_read_cb;
+        }
+        for (auto it = touch_driver_gesture_map.begin(); it != touch_driver_gesture_map.end();) {
+            if (it->second == this) {
+                it = touch_driver_gesture_map.erase(it);
+            } else {
+                it++;
+            }
+        }
+        _touch_read_cb = nullptr;
+    }
+    _touch_process_timer.reset();
     resetGestureInfo();
     _event_mask_obj.reset();
     for (int i = 0; i < ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX; i++) {
@@ -159,6 +201,21 @@ bool ESP_Brookesia_Gesture::del(void)
     return true;
 }
 
+bool ESP_Brookesia_Gesture::checkTouchDeviceRegistered(void) const
+{
+    lv_indev_t *indev = nullptr;
+
+    // A deleted device may leave its address to a new one, which isn't chained by this gesture
+    while ((indev = lv_indev_get_next(indev)) != nullptr) {
+        if (indev == _touch_device) {
+            auto res = touch_driver_gesture_map.find(indev->driver);
+            return (res != touch_driver_gesture_map.end()) && (res->second == this);
+        }
+    }
+
+    return false;
+}
+
 bool ESP_Brookesia_Gesture::readTouchPoint(int &x, int &y) const
 {
     lv_point_t point = {};
@@ -235,6 +292,11 @@ bool ESP_Brookesia_Gesture::calibrateData(const ESP_Brookesia_StyleSize_t &scree
     ESP_BROOKESIA_CHECK_VALUE_RETURN(data.threshold.vertical_edge, 1, parent_h, false, "Invalid top edge threshold");
     ESP_BROOKESIA_CHECK_FALSE_RETURN(data.threshold.speed_slow_px_per_ms > 0, false, "Invalid speed slow threshold");
     ESP_BROOKESIA_CHECK_FALSE_RETURN(data.threshold.duration_short_ms > 0, false, "Invalid duration short threshold");
+    if (data.threshold.fling_deceleration_px_per_ms2 == 0) {
+        data.threshold.fling_deceleration_px_per_ms2 = ESP_BROOKESIA_GESTURE_FLING_DECELERATION_DEFAULT;
+    }
+    ESP_BROOKESIA_CHECK_FALSE_RETURN(data.threshold.fling_deceleration_px_per_ms2 > 0, false,
+                                     "Invalid fling deceleration threshold");
     // Left/Right indicator bar
     for (int i = 0; i < ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX; i++) {
         if (!data.flags.enable_indicator_bars[i]) {
@@ -414,6 +476,7 @@ void ESP_Brookesia_Gesture::resetGestureInfo(void)
 {
     ESP_Brookesia_GestureInfo_t reset_info = (ESP_Brookesia_GestureInfo_t)ESP_BROOKESIA_GESTURE_INFO_INIT();
     _info = reset_info;
+    _tracker.reset();
 }
 
 bool ESP_Brookesia_Gesture::updateByNewData(void)
@@ -425,8 +488,6 @@ bool ESP_Brookesia_Gesture::updateByNewData(void)
     int align_x_offset = 0;
     int align_y_offset = 0;
     lv_align_t align = LV_ALIGN_DEFAULT;
-    // Timer
-    lv_timer_set_period(_detect_timer.get(), data.detect_period_ms);
     // Mask
     lv_obj_set_size(_event_mask_obj.get(), core.getCoreData().screen_size.width, core.getCoreData().screen_size.height);
     // Indicator bar
@@ -493,122 +554,149 @@ void ESP_Brookesia_Gesture::onDataUpdateEventCallback(lv_event_t *event)
     ESP_BROOKESIA_CHECK_FALSE_EXIT(gesture->updateByNewData(), "Update gesture object style failed");
 }
 
-void ESP_Brookesia_Gesture::onTouchDetectTimerCallback(struct _lv_timer_t *t)
+void ESP_Brookesia_Gesture::onTouchReadCallback(lv_indev_drv_t *drv, lv_indev_data_t *data)
 {
-    bool touched = false;
-    int distance_x = 0;
-    int distance_y = 0;
-    float distance_tan = numeric_limits<float>::infinity();
-    lv_event_code_t event_code = LV_EVENT_ALL;
+    ESP_Brookesia_Gesture *gesture = nullptr;
+
+    auto res = touch_driver_gesture_map.find(drv);
+    ESP_BROOKESIA_CHECK_FALSE_EXIT(res != touch_driver_gesture_map.end(), "Invalid touch driver");
+    gesture = res->second;
+    ESP_BROOKESIA_CHECK_NULL_EXIT(gesture, "Invalid gesture");
 
-    ESP_Brookesia_Gesture *gesture = (ESP_Brookesia_Gesture *)t->user_data;
+    gesture->_touch_read_cb(drv, data);
+
+    // LVGL processes the new point after this (e.g. rotates it), so it's used by the process timer in the next run of
+    // the timers. While no finger is down the timer stays paused.
+    if ((data->state == LV_INDEV_STATE_PRESSED) || gesture->checkGestureStart()) {
+        lv_timer_resume(gesture->_touch_process_timer.get());
+        lv_timer_ready(gesture->_touch_process_timer.get());
+    }
+}
+
+void ESP_Brookesia_Gesture::onTouchProcessTimerCallback(struct _lv_timer_t *t)
+{
+    ESP_Brookesia_Gesture *gesture = nullptr;
+
+    ESP_BROOKESIA_CHECK_NULL_EXIT(t, "Invalid timer");
+    gesture = (ESP_Brookesia_Gesture *)t->user_data;
     ESP_BROOKESIA_CHECK_NULL_EXIT(gesture, "Invalid gesture");
 
-    const ESP_Brookesia_GestureData_t &data = gesture->data;
-    const uint16_t &display_w = gesture->core.getCoreData().screen_size.width;
-    const uint16_t &display_h = gesture->core.getCoreData().screen_size.height;
-    const float &distance_tan_threshold = gesture->_direction_tan_threshold;
-    ESP_Brookesia_GestureInfo_t &info = gesture->_info;
+    // Run once for each read of the touch device
+    lv_timer_pause(t);
+    gesture->processTouchRead();
+}
 
-    // Check if touched and save the last touch point
-    touched = gesture->readTouchPoint(info.stop_x, info.stop_y);
+void ESP_Brookesia_Gesture::processTouchRead(void)
+{
+    bool touched = false;
+    int touch_x = -1;
+    int touch_y = -1;
+    int distance_x = 0;
+    int distance_y = 0;
+    uint32_t tick = 0;
+    ESP_Brookesia_GestureDirection_t direction = ESP_BROOKESIA_GESTURE_DIR_NONE;
+    lv_event_code_t event_code = LV_EVENT_ALL;
 
-    // Process the stop area
-    info.stop_area = ESP_BROOKESIA_GESTURE_AREA_CENTER;
-    info.stop_area |= (info.stop_y < data.threshold.vertical_edge) ? ESP_BROOKESIA_GESTURE_AREA_TOP_EDGE : 0;
-    info.stop_area |= ((display_h - info.stop_y) < data.threshold.vertical_edge) ? ESP_BROOKESIA_GESTURE_AREA_BOTTOM_EDGE : 0;
-    info.stop_area |= (info.stop_x < data.threshold.horizontal_edge) ? ESP_BROOKESIA_GESTURE_AREA_LEFT_EDGE : 0;
-    info.stop_area |= ((display_w - info.stop_x) < data.threshold.horizontal_edge) ? ESP_BROOKESIA_GESTURE_AREA_RIGHT_EDGE : 0;
+    const uint16_t &display_w = core.getCoreData().screen_size.width;
+    const uint16_t &display_h = core.getCoreData().screen_size.height;
+    auto get_area = [&](int x, int y) {
+        uint8_t area = ESP_BROOKESIA_GESTURE_AREA_CENTER;
+        area |= (y < data.threshold.vertical_edge) ? ESP_BROOKESIA_GESTURE_AREA_TOP_EDGE : 0;
+        area |= ((display_h - y) < data.threshold.vertical_edge) ? ESP_BROOKESIA_GESTURE_AREA_BOTTOM_EDGE : 0;
+        area |= (x < data.threshold.horizontal_edge) ? ESP_BROOKESIA_GESTURE_AREA_LEFT_EDGE : 0;
+        area |= ((display_w - x) < data.threshold.horizontal_edge) ? ESP_BROOKESIA_GESTURE_AREA_RIGHT_EDGE : 0;
+        return area;
+    };
 
     // If not touched before and now, just ignore and return
-    if (!gesture->checkGestureStart() && !touched) {
+    touched = readTouchPoint(touch_x, touch_y);
+    if (!checkGestureStart() && !touched) {
         return;
     }
 
+    // Save the last touch point and keep it for the velocity
+    tick = lv_tick_get();
+    if (touched) {
+        _info.stop_x = touch_x;
+        _info.stop_y = touch_y;
+        _tracker.addSample(touch_x, touch_y, tick);
+    }
+    _info.stop_area = get_area(_info.stop_x, _info.stop_y);
+
     // If not touched before but touched now, it means the gesture is started
-    if (!gesture->checkGestureStart() && touched) {
+    if (!checkGestureStart()) {
         // Save the first touch point
-        gesture->_touch_start_tick = lv_tick_get();
-        info.start_x = info.stop_x;
-        info.start_y = info.stop_y;
-
-        // Process the start area
-        info.start_area = ESP_BROOKESIA_GESTURE_AREA_CENTER;
-        info.start_area |= (info.start_y < data.threshold.vertical_edge) ? ESP_BROOKESIA_GESTURE_AREA_TOP_EDGE : 0;
-        info.start_area |= ((display_h - info.start_y) < data.threshold.vertical_edge) ? ESP_BROOKESIA_GESTURE_AREA_BOTTOM_EDGE : 0;
-        info.start_area |= (info.start_x < data.threshold.horizontal_edge) ? ESP_BROOKESIA_GESTURE_AREA_LEFT_EDGE : 0;
-        info.start_area |= ((display_w - info.start_x) < data.threshold.horizontal_edge) ? ESP_BROOKESIA_GESTURE_AREA_RIGHT_EDGE : 0;
+        _touch_start_tick = tick;
+        _pressing_event_tick = tick;
+        _info.start_x = _info.stop_x;
+        _info.start_y = _info.stop_y;
+        _info.start_area = _info.stop_area;
+        _info.fling_stop_x = _info.stop_x;
+        _info.fling_stop_y = _info.stop_y;
 
         // Set the press event code
-        event_code = gesture->_press_event_code;
+        event_code = _press_event_code;
         ESP_BROOKESIA_LOGD("Gesture send press event");
 
         goto event_process;
     }
 
     // Process the duration
-    info.duration_ms = lv_tick_elaps(gesture->_touch_start_tick);
-    info.flags.short_duration = (info.duration_ms < data.threshold.duration_short_ms);
+    _info.duration_ms = lv_tick_elaps(_touch_start_tick);
+    _info.flags.short_duration = (_info.duration_ms < data.threshold.duration_short_ms);
 
-    // Set the event code according to the touch status
+    // Set the event code according to the touch status, the pressing events are limited by the detect period
     if (touched) {
-        event_code = gesture->_pressing_event_code;
+        if (lv_tick_elaps(_pressing_event_tick) < data.detect_period_ms) {
+            return;
+        }
+        _pressing_event_tick = tick;
+        event_code = _pressing_event_code;
         ESP_BROOKESIA_LOGD("Gesture send pressing event");
     } else {
-        event_code = gesture->_release_event_code;
+        event_code = _release_event_code;
         ESP_BROOKESIA_LOGD("Gesture send release event");
     }
 
-    // If not touched now but touched before, it means the gesture is finished
-    distance_x = info.stop_x - info.start_x;
-    distance_y = info.stop_y - info.start_y;
+    // Process the velocity of the last samples, it's zero if the finger has stopped before release
+    _tracker.getVelocity(_info.velocity_x_px_per_ms, _info.velocity_y_px_per_ms);
+    _info.speed_px_per_ms = sqrtf(_info.velocity_x_px_per_ms * _info.velocity_x_px_per_ms +
+                                  _info.velocity_y_px_per_ms * _info.velocity_y_px_per_ms);
+    _info.flags.slow_speed = (_info.speed_px_per_ms < data.threshold.speed_slow_px_per_ms);
+
+    distance_x = _info.stop_x - _info.start_x;
+    distance_y = _info.stop_y - _info.start_y;
     if ((distance_x == 0) && (distance_y == 0)) {
         // If the distance is too small, just ignore and go to the end
         goto event_process;
     }
 
-    // Process the distance and speed
-    info.distance_px = (float)sqrt(distance_x * distance_x + distance_y * distance_y);
-    info.speed_px_per_ms = (info.duration_ms > 0) ? (info.distance_px / info.duration_ms) :
-                           numeric_limits<float>::infinity();
-    info.flags.slow_speed = (info.speed_px_per_ms < data.threshold.speed_slow_px_per_ms);
-
-    /* Process the direction */
-    // Calculate the tan value of the gesture
-    distance_tan = (distance_x == 0) ? numeric_limits<float>::infinity() : (float)distance_y / distance_x;
-    // Check if the tan absolute value is large enoughd
-    // if so, it means the gesture is up or down, otherwise, it's left or right
-    if ((distance_tan == numeric_limits<float>::infinity()) || (distance_tan > distance_tan_threshold) ||
-            (distance_tan < -distance_tan_threshold)) {
-        // Check the distance in y axis
-        if (distance_y > data.threshold.direction_vertical) {
-            info.direction = ESP_BROOKESIA_GESTURE_DIR_DOWN;
-        } else if (distance_y < -data.threshold.direction_vertical) {
-            info.direction = ESP_BROOKESIA_GESTURE_DIR_UP;
-        }
-    } else {
-        // Check the distance in x axis
-        if (distance_x > data.threshold.direction_horizon) {
-            info.direction = ESP_BROOKESIA_GESTURE_DIR_RIGHT;
-        } else if (distance_x < -data.threshold.direction_horizon) {
-            info.direction = ESP_BROOKESIA_GESTURE_DIR_LEFT;
-        }
+    // Process the distance and the direction, the direction is kept once it's detected
+    _info.distance_px = sqrtf(distance_x * distance_x + distance_y * distance_y);
+    direction = ESP_Brookesia_GestureTracker::getDirection(data, _direction_tan_threshold, distance_x, distance_y);
+    if (direction != ESP_BROOKESIA_GESTURE_DIR_NONE) {
+        _info.direction = direction;
     }
 
+    // Predict where a fling stops, so a short but fast gesture can be handled like a long one
+    _tracker.getFlingStopPoint(_info.velocity_x_px_per_ms, _info.velocity_y_px_per_ms,
+                               data.threshold.fling_deceleration_px_per_ms2, _info.fling_stop_x, _info.fling_stop_y);
+    _info.fling_direction = ESP_Brookesia_GestureTracker::getDirection(data, _direction_tan_threshold,
+                            _info.fling_stop_x - _info.start_x, _info.fling_stop_y - _info.start_y);
+
 event_process:
-    if (gesture->checkGestureStart()) {
-        ESP_BROOKESIA_LOGD(
-            "\n\tpoint(%d,%d->%d,%d), area(%d->%d), dir(%d), distance(%.2f), angle(%d), duration(%dms), speed(%.2f),"
-            "event(%d)", info.start_x, info.start_y, info.stop_x, info.stop_y, info.start_area, info.stop_area,
-            (int)info.direction, info.distance_px, (int)(atan(distance_tan) * -180 / M_PI), (int)info.duration_ms,
-            info.speed_px_per_ms, (int)event_code
-        );
-    }
-
-    gesture->_event_data = info;
-    lv_event_send(gesture->_event_mask_obj.get(), event_code, (void *)&gesture->_event_data);
-    if (event_code == gesture->_release_event_code) {
-        gesture->resetGestureInfo();
+    ESP_BROOKESIA_LOGD(
+        "\n\tpoint(%d,%d->%d,%d), area(%d->%d), dir(%d), distance(%.2f), angle(%d), duration(%dms), velocity(%.2f,%.2f), "
+        "fling(%d,%d), event(%d)", _info.start_x, _info.start_y, _info.stop_x, _info.stop_y, _info.start_area,
+        _info.stop_area, (int)_info.direction, _info.distance_px, (int)(atan2(-distance_y, distance_x) * 180 / M_PI),
+        (int)_info.duration_ms, _info.velocity_x_px_per_ms, _info.velocity_y_px_per_ms, _info.fling_stop_x,
+        _info.fling_stop_y, (int)event_code
+    );
+
+    _event_data = _info;
+    lv_event_send(_event_mask_obj.get(), event_code, (void *)&_event_data);
+    if (event_code == _release_event_code) {
+        resetGestureInfo();
     }
 }
 
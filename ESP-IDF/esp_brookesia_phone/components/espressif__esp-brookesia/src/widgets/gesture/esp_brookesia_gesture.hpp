@@ -9,6 +9,7 @@
 #include "core/esp_brookesia_core_type.h"
 #include "core/esp_brookesia_core.hpp"
 #include "esp_brookesia_gesture_type.h"
+#include "esp_brookesia_gesture_tracker.hpp"
 
 // *INDENT-OFF*
 class ESP_Brookesia_Gesture {
@@ -51,9 +52,12 @@ private:
     };
     void resetGestureInfo(void);
     bool updateByNewData(void);
+    bool checkTouchDeviceRegistered(void) const;
+    void processTouchRead(void);
 
     static void onDataUpdateEventCallback(lv_event_t *event);
-    static void onTouchDetectTimerCallback(struct _lv_timer_t *t);
+    static void onTouchReadCallback(lv_indev_drv_t *drv, lv_indev_data_t *data);
+    static void onTouchProcessTimerCallback(struct _lv_timer_t *t);
     static void onIndicatorBarScaleBackAnimationExecuteCallback(void *var, int32_t value);
     static void onIndicatorBarScaleBackAnimationReadyCallback(lv_anim_t *anim);
 
@@ -67,7 +71,10 @@ private:
     std::array<int, ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX>  _indicator_bar_min_lengths;
     std::array<int, ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX>  _indicator_bar_max_lengths;
     uint32_t _touch_start_tick;
-    ESP_Brookesia_LvTimer_t _detect_timer;
+    uint32_t _pressing_event_tick;
+    void (*_touch_read_cb)(lv_indev_drv_t *drv, lv_indev_data_t *data);
+    ESP_Brookesia_LvTimer_t _touch_process_timer;
+    ESP_Brookesia_GestureTracker _tracker;
     ESP_Brookesia_LvObj_t _event_mask_obj;
     std::array<ESP_Brookesia_LvObj_t, ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX>  _indicator_bars;
     std::array<IndicatorBarAnimVar_t, ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX>  _indicator_bar_anim_var;
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cmath>
+#include <cstdlib>
+#include "esp_brookesia_gesture_tracker.hpp"
+
+using namespace std;
+
+ESP_Brookesia_GestureTracker::ESP_Brookesia_GestureTracker():
+    _samples{},
+    _sample_head(SAMPLE_NUM - 1),
+    _sample_count(0)
+{
+}
+
+void ESP_Brookesia_GestureTracker::reset(void)
+{
+    _sample_head = SAMPLE_NUM - 1;
+    _sample_count = 0;
+}
+
+void ESP_Brookesia_GestureTracker::addSample(int x, int y, uint32_t tick_ms)
+{
+    _sample_head = (_sample_head + 1) % SAMPLE_NUM;
+    _samples[_sample_head] = {
+        .x = x,
+        .y = y,
+        .tick_ms = tick_ms,
+    };
+    _sample_count = min(_sample_count + 1, SAMPLE_NUM);
+}
+
+bool ESP_Brookesia_GestureTracker::getVelocity(float &velocity_x, float &velocity_y) const
+{
+    float sum_t = 0;
+    float sum_x = 0;
+    float sum_y = 0;
+    float sum_tt = 0;
+    float sum_tx = 0;
+    float sum_ty = 0;
+    float denominator = 0;
+    int n = 0;
+
+    velocity_x = 0;
+    velocity_y = 0;
+    if (_sample_count < 2) {
+        return false;
+    }
+
+    // Fit `x = a + b * t` and `y = c + d * t` by least squares on the samples of the last window, the time and the
+    // position are relative to the last sample to keep the precision of float
+    const Sample_t &last = getLastSample();
+    for (int i = 0; i < _sample_count; i++) {
+        const Sample_t &sample = _samples[(_sample_head - i + SAMPLE_NUM) % SAMPLE_NUM];
+        uint32_t age_ms = last.tick_ms - sample.tick_ms;
+        // Use at least 2 samples even if the finger has stopped for a long time
+        if ((age_ms > VELOCITY_WINDOW_MS) && (n >= 2)) {
+            break;
+        }
+        float t = -(float)age_ms;
+        float x = (float)(sample.x - last.x);
+        float y = (float)(sample.y - last.y);
+        sum_t += t;
+        sum_x += x;
+        sum_y += y;
+        sum_tt += t * t;
+        sum_tx += t * x;
+        sum_ty += t * y;
+        n++;
+    }
+
+    denominator = n * sum_tt - sum_t * sum_t;
+    // All the samples have the same tick
+    if (denominator <= 0) {
+        return false;
+    }
+    velocity_x = (n * sum_tx - sum_t * sum_x) / denominator;
+    velocity_y = (n * sum_ty - sum_t * sum_y) / denominator;
+
+    return true;
+}
+
+void ESP_Brookesia_GestureTracker::getFlingStopPoint(float velocity_x, float velocity_y, float deceleration, int &x,
+        int &y) const
+{
+    const Sample_t &last = getLastSample();
+    float speed = 0;
+
+    x = last.x;
+    y = last.y;
+    if (deceleration <= 0) {
+        return;
+    }
+
+    // With a constant deceleration, the fling stops after `speed^2 / (2 * deceleration)`
+    speed = sqrtf(velocity_x * velocity_x + velocity_y * velocity_y);
+    x += (int)(velocity_x * speed / (2 * deceleration));
+    y += (int)(velocity_y * speed / (2 * deceleration));
+}
+
+ESP_Brookesia_GestureDirection_t ESP_Brookesia_GestureTracker::getDirection(const ESP_Brookesia_GestureData_t &data,
+        float tan_threshold, int distance_x, int distance_y)
+{
+    if ((distance_x == 0) && (distance_y == 0)) {
+        return ESP_BROOKESIA_GESTURE_DIR_NONE;
+    }
+
+    // If the tan absolute value is large enough, the gesture is up or down, otherwise, it's left or right
+    if (abs(distance_y) > abs(distance_x) * tan_threshold) {
+        if (distance_y > data.threshold.direction_vertical) {
+            return ESP_BROOKESIA_GESTURE_DIR_DOWN;
+        } else if (distance_y < -data.threshold.direction_vertical) {
+            return ESP_BROOKESIA_GESTURE_DIR_UP;
+        }
+    } else {
+        if (distance_x > data.threshold.direction_horizon) {
+            return ESP_BROOKESIA_GESTURE_DIR_RIGHT;
+        } else if (distance_x < -data.threshold.direction_horizon) {
+            return ESP_BROOKESIA_GESTURE_DIR_LEFT;
+        }
+    }
+
+    return ESP_BROOKESIA_GESTURE_DIR_NONE;
+}
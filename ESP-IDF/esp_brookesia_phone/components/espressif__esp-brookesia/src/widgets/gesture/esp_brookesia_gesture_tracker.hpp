@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "core/esp_brookesia_core_type.h"
+#include "esp_brookesia_gesture_type.h"
+
+/**
+ * Keep the recent touch samples of a gesture, estimate its velocity and predict where a fling stops. It doesn't use
+ * LVGL, so the recorded touch traces can be replayed without a display.
+ */
+// *INDENT-OFF*
+class ESP_Brookesia_GestureTracker {
+public:
+    static constexpr int SAMPLE_NUM = 16;
+    static constexpr uint32_t VELOCITY_WINDOW_MS = 100;
+
+    typedef struct {
+        int x;
+        int y;
+        uint32_t tick_ms;
+    } Sample_t;
+
+    ESP_Brookesia_GestureTracker();
+
+    void reset(void);
+    void addSample(int x, int y, uint32_t tick_ms);
+
+    bool checkEmpty(void) const                  { return (_sample_count == 0); }
+    const Sample_t &getLastSample(void) const    { return _samples[_sample_head]; }
+    bool getVelocity(float &velocity_x, float &velocity_y) const;
+    void getFlingStopPoint(float velocity_x, float velocity_y, float deceleration, int &x, int &y) const;
+
+    static ESP_Brookesia_GestureDirection_t getDirection(const ESP_Brookesia_GestureData_t &data, float tan_threshold,
+                                                         int distance_x, int distance_y);
+
+private:
+    std::array<Sample_t, SAMPLE_NUM> _samples;
+    int _sample_head;
+    int _sample_count;
+};
+// *INDENT-OFF*
@@ -11,6 +11,9 @@
 extern "C" {
 #endif
 
+// Used if the fling deceleration of the data is 0, e.g. a stylesheet made before it was added
+#define ESP_BROOKESIA_GESTURE_FLING_DECELERATION_DEFAULT    (0.005f)
+
 typedef enum {
     ESP_BROOKESIA_GESTURE_DIR_NONE  = 0,
     ESP_BROOKESIA_GESTURE_DIR_UP    = (1 << 0),
@@ -55,7 +58,7 @@ typedef struct {
 } ESP_Brookesia_GestureIndicatorBarData_t;
 
 typedef struct {
-    uint8_t detect_period_ms;
+    uint8_t detect_period_ms;           /*!< Minimum interval of the pressing events, the touch device is read by LVGL */
     struct {
         uint16_t direction_vertical;
         uint16_t direction_horizon;
@@ -64,6 +67,7 @@ typedef struct {
         uint16_t vertical_edge;
         uint16_t duration_short_ms;
         float speed_slow_px_per_ms;
+        float fling_deceleration_px_per_ms2;   /*!< 0 means `ESP_BROOKESIA_GESTURE_FLING_DECELERATION_DEFAULT` */
     } threshold;
     ESP_Brookesia_GestureIndicatorBarData_t indicator_bars[ESP_BROOKESIA_GESTURE_INDICATOR_BAR_TYPE_MAX];
     struct {
@@ -80,8 +84,13 @@ typedef struct {
     int stop_x;
     int stop_y;
     uint32_t duration_ms;
+    float velocity_x_px_per_ms;         /*!< Velocity of the last samples, estimated by least squares */
+    float velocity_y_px_per_ms;
     float speed_px_per_ms;
     float distance_px;
+    int fling_stop_x;                   /*!< Where the content stops if it keeps moving and slows down after release */
+    int fling_stop_y;
+    ESP_Brookesia_GestureDirection_t fling_direction;
     struct {
         uint8_t slow_speed: 1;
         uint8_t short_duration: 1;
@@ -0,0 +1,332 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstring>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "unity.h"
+#include "esp_brookesia.hpp"
+
+#define TEST_MANY_OBJECT_NUM        (8)
+#define TEST_MANY_ID_NUM            (8)
+#define TEST_MANY_HANDLER_NUM       (4)
+#define TEST_MANY_SEND_TIMES        (10000)
+#define TEST_CHURN_TIMES            (1000)
+
+using ID = ESP_Brookesia_CoreEvent::ID;
+using HandlerData = ESP_Brookesia_CoreEvent::HandlerData;
+
+static const char *TAG = "test_esp_brookesia_core_event";
+
+typedef struct {
+    ESP_Brookesia_CoreEvent *event;
+    std::vector<int> calls;
+    ESP_Brookesia_CoreEvent::Handle handles[4];
+    void *param;
+} TestContext_t;
+
+static int test_objects[TEST_MANY_OBJECT_NUM];
+
+static bool test_handler_0(const HandlerData &data)
+{
+    static_cast<TestContext_t *>(data.user_data)->calls.push_back(0);
+    return true;
+}
+
+static bool test_handler_1(const HandlerData &data)
+{
+    static_cast<TestContext_t *>(data.user_data)->calls.push_back(1);
+    return true;
+}
+
+/* Unregister itself and the next handler while the event is being sent */
+static bool test_handler_unregister(const HandlerData &data)
+{
+    TestContext_t *context = static_cast<TestContext_t *>(data.user_data);
+    context->calls.push_back(2);
+    context->event->unregisterEvent(context->handles[2]);
+    context->event->unregisterEvent(context->handles[3]);
+    return true;
+}
+
+/* Register another handler while the event is being sent */
+static bool test_handler_register(const HandlerData &data)
+{
+    TestContext_t *context = static_cast<TestContext_t *>(data.user_data);
+    context->calls.push_back(3);
+    context->event->registerEvent(data.object, test_handler_1, data.id, context);
+    return true;
+}
+
+static bool test_handler_param(const HandlerData &data)
+{
+    static_cast<TestContext_t *>(data.user_data)->param = data.param;
+    return true;
+}
+
+/* Count the calls of each object and ID */
+static bool test_handler_count(const HandlerData &data)
+{
+    int (*counts)[TEST_MANY_ID_NUM] = static_cast<int (*)[TEST_MANY_ID_NUM]>(data.user_data);
+    int object = static_cast<int *>(data.object) - test_objects;
+    counts[object][static_cast<int>(data.id)]++;
+    return true;
+}
+
+TEST_CASE("test esp-brookesia core event to dispatch", "[esp-brookesia][core_event][dispatch]")
+{
+    ESP_Brookesia_CoreEvent event;
+    TestContext_t context = {};
+    context.event = &event;
+
+    // Handlers are called in the order of registration, only the ones of the object
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_0, ID::APP, &context, &context.handles[0]));
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_1, ID::APP, &context, &context.handles[1]));
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[1], test_handler_0, ID::APP, &context));
+    TEST_ASSERT_TRUE(event.sendEvent(&test_objects[0], ID::APP));
+    TEST_ASSERT_EQUAL(2, context.calls.size());
+    TEST_ASSERT_EQUAL(0, context.calls[0]);
+    TEST_ASSERT_EQUAL(1, context.calls[1]);
+
+    // A stale handle doesn't remove the handler which reuses its slot
+    ESP_Brookesia_CoreEvent::Handle stale_handle = context.handles[0];
+    event.unregisterEvent(context.handles[0]);
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_0, ID::APP, &context, &context.handles[0]));
+    TEST_ASSERT_EQUAL(stale_handle.index, context.handles[0].index);
+    event.unregisterEvent(stale_handle);
+    context.calls.clear();
+    TEST_ASSERT_TRUE(event.sendEvent(&test_objects[0], ID::APP));
+    TEST_ASSERT_EQUAL(2, context.calls.size());
+    TEST_ASSERT_EQUAL(1, context.calls[0]);
+    TEST_ASSERT_EQUAL(0, context.calls[1]);
+
+    // The handlers unregistered during the event are not called, the registered ones are called from the next event
+    event.unregisterEvent(&test_objects[0]);
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_register, ID::NAVIGATION, &context));
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_unregister, ID::NAVIGATION, &context,
+                                         &context.handles[2]));
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_0, ID::NAVIGATION, &context, &context.handles[3]));
+    context.calls.clear();
+    TEST_ASSERT_TRUE(event.sendEvent(&test_objects[0], ID::NAVIGATION));
+    TEST_ASSERT_EQUAL(2, context.calls.size());
+    TEST_ASSERT_EQUAL(3, context.calls[0]);
+    TEST_ASSERT_EQUAL(2, context.calls[1]);
+    context.calls.clear();
+    TEST_ASSERT_TRUE(event.sendEvent(&test_objects[0], ID::NAVIGATION));
+    TEST_ASSERT_EQUAL(2, context.calls.size());
+    TEST_ASSERT_EQUAL(3, context.calls[0]);
+    TEST_ASSERT_EQUAL(1, context.calls[1]);
+
+    // The custom IDs are recycled when they have no handler
+    ID custom_id = event.getFreeEventID();
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_0, custom_id, &context));
+    TEST_ASSERT_TRUE(event.getFreeEventID() != custom_id);
+    event.unregisterEvent(test_handler_0);
+    TEST_ASSERT_TRUE(event.getFreeEventID() == custom_id);
+}
+
+static void test_post_task(void *arg)
+{
+    ESP_Brookesia_CoreEvent *event = static_cast<ESP_Brookesia_CoreEvent *>(arg);
+
+    event->postEvent(&test_objects[0], ID::CUSTOM, &test_objects[1]);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("test esp-brookesia core event to post from a task", "[esp-brookesia][core_event][post]")
+{
+    ESP_Brookesia_CoreUiQueue *queue = new ESP_Brookesia_CoreUiQueue();
+    ESP_Brookesia_CoreEvent *event = new ESP_Brookesia_CoreEvent(queue);
+    TestContext_t context = {};
+
+    TEST_ASSERT_TRUE(event->registerEvent(&test_objects[0], test_handler_param, ID::CUSTOM, &context));
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_post_task, "Event Poster", 4096, event, uxTaskPriorityGet(NULL) + 1,
+                                          NULL));
+    // The event is only sent when the queue is drained
+    vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_NULL(context.param);
+    TEST_ASSERT_EQUAL(1, queue->drain());
+    TEST_ASSERT_EQUAL_PTR(&test_objects[1], context.param);
+
+    delete event;
+    delete queue;
+    // Wait for the idle task to free the poster task
+    vTaskDelay(pdMS_TO_TICKS(100));
+}
+
+TEST_CASE("test esp-brookesia core event to drop posted events without handlers", "[esp-brookesia][core_event][post]")
+{
+    ESP_Brookesia_CoreUiQueue queue;
+    ESP_Brookesia_CoreEvent event(&queue);
+    TestContext_t context = {};
+    context.event = &event;
+
+    // The handler is looked up when the queue is drained, not when the event is posted
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_0, ID::CUSTOM, &context, &context.handles[0]));
+    TEST_ASSERT_TRUE(event.postEvent(&test_objects[0], ID::CUSTOM));
+    TEST_ASSERT_TRUE(event.postEvent(&test_objects[0], ID::CUSTOM));
+    event.unregisterEvent(context.handles[0]);
+    TEST_ASSERT_TRUE(event.registerEvent(&test_objects[0], test_handler_1, ID::CUSTOM, &context));
+    TEST_ASSERT_EQUAL(2, queue.drain());
+    TEST_ASSERT_EQUAL(2, context.calls.size());
+    TEST_ASSERT_EQUAL(1, context.calls[0]);
+    TEST_ASSERT_EQUAL(1, context.calls[1]);
+
+    // Without a queue the events can't be posted
+    ESP_Brookesia_CoreEvent no_queue_event;
+    TEST_ASSERT_FALSE(no_queue_event.postEvent(&test_objects[0], ID::CUSTOM));
+}
+
+static void test_many_register(ESP_Brookesia_CoreEvent &event, int (*counts)[TEST_MANY_ID_NUM])
+{
+    for (int i = 0; i < TEST_MANY_OBJECT_NUM; i++) {
+        for (int j = 0; j < TEST_MANY_ID_NUM; j++) {
+            for (int k = 0; k < TEST_MANY_HANDLER_NUM; k++) {
+                TEST_ASSERT_TRUE(event.registerEvent(&test_objects[i], test_handler_count, static_cast<ID>(j), counts));
+            }
+        }
+    }
+}
+
+static void test_many_send_all(ESP_Brookesia_CoreEvent &event, int (*counts)[TEST_MANY_ID_NUM])
+{
+    memset(counts, 0, sizeof(int) * TEST_MANY_OBJECT_NUM * TEST_MANY_ID_NUM);
+    for (int i = 0; i < TEST_MANY_OBJECT_NUM; i++) {
+        for (int j = 0; j < TEST_MANY_ID_NUM; j++) {
+            TEST_ASSERT_TRUE(event.sendEvent(&test_objects[i], static_cast<ID>(j)));
+        }
+    }
+}
+
+TEST_CASE("test esp-brookesia core event to unregister many handlers", "[esp-brookesia][core_event][unregister]")
+{
+    ESP_Brookesia_CoreEvent event;
+    int counts[TEST_MANY_OBJECT_NUM][TEST_MANY_ID_NUM] = {};
+
+    // Every handler is called once per event, also when the index has grown
+    test_many_register(event, counts);
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < TEST_MANY_SEND_TIMES; i++) {
+        event.sendEvent(&test_objects[i % TEST_MANY_OBJECT_NUM], static_cast<ID>(i % TEST_MANY_ID_NUM));
+    }
+    ESP_LOGI(TAG, "%d objects x %d IDs x %d handlers: send(%dns)", TEST_MANY_OBJECT_NUM, TEST_MANY_ID_NUM,
+             TEST_MANY_HANDLER_NUM, (int)((esp_timer_get_time() - start_us) * 1000 / TEST_MANY_SEND_TIMES));
+    test_many_send_all(event, counts);
+    for (int i = 0; i < TEST_MANY_OBJECT_NUM; i++) {
+        for (int j = 0; j < TEST_MANY_ID_NUM; j++) {
+            TEST_ASSERT_EQUAL(TEST_MANY_HANDLER_NUM, counts[i][j]);
+        }
+    }
+
+    // Each way of unregistering only removes its own handlers
+    event.unregisterEvent(&test_objects[0]);
+    event.unregisterEvent(&test_objects[1], static_cast<ID>(1));
+    event.unregisterEvent(&test_objects[2], test_handler_count, static_cast<ID>(2));
+    event.unregisterEvent(static_cast<ID>(3));
+    test_many_send_all(event, counts);
+    for (int i = 0; i < TEST_MANY_OBJECT_NUM; i++) {
+        for (int j = 0; j < TEST_MANY_ID_NUM; j++) {
+            bool removed = (i == 0) || ((i == 1) && (j == 1)) || ((i == 2) && (j == 2)) || (j == 3);
+            TEST_ASSERT_EQUAL(removed ? 0 : TEST_MANY_HANDLER_NUM, counts[i][j]);
+        }
+    }
+
+    // The lists are reused after being emptied
+    event.unregisterEvent(test_handler_count);
+    test_many_send_all(event, counts);
+    test_many_register(event, counts);
+    test_many_send_all(event, counts);
+    for (int i = 0; i < TEST_MANY_OBJECT_NUM; i++) {
+        for (int j = 0; j < TEST_MANY_ID_NUM; j++) {
+            TEST_ASSERT_EQUAL(TEST_MANY_HANDLER_NUM, counts[i][j]);
+        }
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*unregister)(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle, ID id);
+} TestChurn_t;
+
+static int test_churn_object;
+
+static void test_churn_by_handle(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle, ID id)
+{
+    event.unregisterEvent(handle);
+}
+
+static void test_churn_by_object(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle, ID id)
+{
+    event.unregisterEvent(&test_churn_object);
+}
+
+static void test_churn_by_object_id(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle, ID id)
+{
+    event.unregisterEvent(&test_churn_object, id);
+}
+
+static void test_churn_by_object_handler_id(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle,
+        ID id)
+{
+    event.unregisterEvent(&test_churn_object, test_handler_0, id);
+}
+
+static void test_churn_by_id(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle, ID id)
+{
+    event.unregisterEvent(id);
+}
+
+static void test_churn_by_handler(ESP_Brookesia_CoreEvent &event, ESP_Brookesia_CoreEvent::Handle handle, ID id)
+{
+    event.unregisterEvent(test_handler_0);
+}
+
+static const TestChurn_t test_churns[] = {
+    {"handle", test_churn_by_handle},
+    {"object", test_churn_by_object},
+    {"object and ID", test_churn_by_object_id},
+    {"object, handler and ID", test_churn_by_object_handler_id},
+    {"ID", test_churn_by_id},
+    {"handler", test_churn_by_handler},
+};
+
+TEST_CASE("test esp-brookesia core event to churn registrations", "[esp-brookesia][core_event][churn]")
+{
+    ESP_Brookesia_CoreEvent event;
+    int counts[TEST_MANY_OBJECT_NUM][TEST_MANY_ID_NUM] = {};
+    TestContext_t context = {};
+    ESP_Brookesia_CoreEvent::Handle handle = {};
+    // Not used by the other handlers, so unregistering by ID only removes the churned one
+    ID churn_id = static_cast<ID>(TEST_MANY_ID_NUM);
+
+    // A screen registers and unregisters its handlers while the others stay registered
+    test_many_register(event, counts);
+    for (const TestChurn_t &churn : test_churns) {
+        int64_t start_us = esp_timer_get_time();
+        for (int i = 0; i < TEST_CHURN_TIMES; i++) {
+            TEST_ASSERT_TRUE(event.registerEvent(&test_churn_object, test_handler_0, churn_id, &context, &handle));
+            churn.unregister(event, handle, churn_id);
+        }
+        ESP_LOGI(TAG, "%d objects x %d IDs x %d handlers: register and unregister by %s(%dns)", TEST_MANY_OBJECT_NUM,
+                 TEST_MANY_ID_NUM, TEST_MANY_HANDLER_NUM, churn.name,
+                 (int)((esp_timer_get_time() - start_us) * 1000 / TEST_CHURN_TIMES));
+
+        // Nothing of the churned handler is left
+        TEST_ASSERT_TRUE(event.sendEvent(&test_churn_object, churn_id));
+        TEST_ASSERT_EQUAL(0, context.calls.size());
+    }
+
+    // The other handlers are untouched
+    test_many_send_all(event, counts);
+    for (int i = 0; i < TEST_MANY_OBJECT_NUM; i++) {
+        for (int j = 0; j < TEST_MANY_ID_NUM; j++) {
+            TEST_ASSERT_EQUAL(TEST_MANY_HANDLER_NUM, counts[i][j]);
+        }
+    }
+}
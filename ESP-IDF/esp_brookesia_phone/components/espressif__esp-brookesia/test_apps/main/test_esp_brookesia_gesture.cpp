@@ -0,0 +1,229 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cmath>
+#include <cstdlib>
+#include "esp_log.h"
+#include "unity.h"
+#include "lvgl.h"
+#include "esp_brookesia.hpp"
+
+static const char *TAG = "test_esp_brookesia_gesture";
+
+typedef struct {
+    uint32_t tick_ms;
+    int x;
+    int y;
+} TestTouchSample_t;
+
+typedef struct {
+    const char *name;
+    const TestTouchSample_t *samples;
+    size_t sample_num;
+    // Expected classification
+    ESP_Brookesia_GestureDirection_t direction;
+    ESP_Brookesia_GestureDirection_t fling_direction;
+    bool slow_speed;
+} TestTouchTrace_t;
+
+typedef struct {
+    ESP_Brookesia_GestureDirection_t direction;
+    ESP_Brookesia_GestureDirection_t fling_direction;
+    float speed_px_per_ms;
+    bool slow_speed;
+} TestGestureResult_t;
+
+/**
+ * Touch traces of a 1024x600 panel read every 16ms, the last sample is the last pressed point before release
+ */
+// A short and fast flick up from the bottom edge, it's shorter than the direction threshold
+static const TestTouchSample_t trace_home_flick[] = {
+    {0, 512, 595}, {16, 512, 586}, {32, 511, 576}, {48, 511, 566}, {64, 510, 555},
+};
+// A slow drag up from the bottom edge, then the finger stays before release
+static const TestTouchSample_t trace_recents_hold[] = {
+    {0, 512, 595}, {100, 512, 575}, {200, 513, 555}, {300, 513, 535}, {400, 514, 515}, {500, 514, 495},
+    {600, 514, 475}, {700, 515, 455}, {800, 515, 435}, {900, 515, 415}, {1000, 515, 395}, {1016, 515, 395},
+    {1032, 515, 395}, {1048, 515, 395}, {1064, 515, 395}, {1080, 515, 395}, {1096, 515, 395}, {1112, 515, 395},
+    {1128, 515, 395}, {1144, 515, 395}, {1160, 515, 395}, {1176, 515, 395}, {1192, 515, 395}, {1208, 515, 395},
+};
+// A swipe right from the left edge
+static const TestTouchSample_t trace_back_swipe[] = {
+    {0, 5, 300}, {16, 25, 301}, {32, 50, 302}, {48, 75, 302}, {64, 100, 303}, {80, 125, 303}, {96, 150, 304},
+    {112, 175, 304}, {128, 200, 305},
+};
+// A snapshot of the recents screen is flicked up, it's shorter than the deleting threshold
+static const TestTouchSample_t trace_snapshot_flick[] = {
+    {0, 512, 300}, {16, 512, 292}, {32, 512, 282}, {48, 511, 270},
+};
+// A fast drag right, then the finger stops before release, so there is no fling
+static const TestTouchSample_t trace_drag_stop[] = {
+    {0, 300, 300}, {16, 330, 300}, {32, 362, 301}, {48, 394, 301}, {64, 426, 302}, {80, 458, 302}, {96, 490, 302},
+    {112, 522, 303}, {128, 554, 303}, {144, 586, 303}, {160, 600, 303}, {176, 600, 303}, {192, 600, 303},
+    {208, 600, 303}, {224, 600, 303}, {240, 600, 303}, {256, 600, 303}, {272, 600, 303},
+};
+// A steady drag up at 0.5px/ms with the jitter of the touch panel
+static const TestTouchSample_t trace_noisy_drag[] = {
+    {0, 512, 500}, {16, 514, 490}, {32, 511, 486}, {48, 513, 474}, {64, 512, 470}, {80, 510, 458}, {96, 513, 454},
+    {112, 512, 442}, {128, 511, 438}, {144, 513, 426}, {160, 512, 422},
+};
+
+#define TEST_TRACE(samples, direction, fling_direction, slow_speed) \
+    { #samples, samples, sizeof(samples) / sizeof(samples[0]), direction, fling_direction, slow_speed }
+
+static const TestTouchTrace_t traces[] = {
+    TEST_TRACE(trace_home_flick, ESP_BROOKESIA_GESTURE_DIR_NONE, ESP_BROOKESIA_GESTURE_DIR_UP, false),
+    TEST_TRACE(trace_recents_hold, ESP_BROOKESIA_GESTURE_DIR_UP, ESP_BROOKESIA_GESTURE_DIR_UP, true),
+    TEST_TRACE(trace_back_swipe, ESP_BROOKESIA_GESTURE_DIR_RIGHT, ESP_BROOKESIA_GESTURE_DIR_RIGHT, false),
+    TEST_TRACE(trace_snapshot_flick, ESP_BROOKESIA_GESTURE_DIR_NONE, ESP_BROOKESIA_GESTURE_DIR_UP, false),
+    TEST_TRACE(trace_drag_stop, ESP_BROOKESIA_GESTURE_DIR_RIGHT, ESP_BROOKESIA_GESTURE_DIR_RIGHT, true),
+    TEST_TRACE(trace_noisy_drag, ESP_BROOKESIA_GESTURE_DIR_UP, ESP_BROOKESIA_GESTURE_DIR_UP, false),
+};
+
+static const ESP_Brookesia_GestureData_t gesture_data = ESP_BROOKESIA_PHONE_1024_600_DARK_GESTURE_DATA();
+
+static TestGestureResult_t replay_tracker(ESP_Brookesia_GestureTracker &tracker, const TestTouchTrace_t &trace,
+        float tan_threshold, float &velocity_x, float &velocity_y)
+{
+    TestGestureResult_t result = {};
+    const TestTouchSample_t &first = trace.samples[0];
+    int fling_x = 0;
+    int fling_y = 0;
+
+    tracker.reset();
+    for (size_t i = 0; i < trace.sample_num; i++) {
+        const TestTouchSample_t &sample = trace.samples[i];
+        tracker.addSample(sample.x, sample.y, sample.tick_ms);
+        ESP_Brookesia_GestureDirection_t direction = ESP_Brookesia_GestureTracker::getDirection(gesture_data,
+                tan_threshold, sample.x - first.x, sample.y - first.y);
+        if (direction != ESP_BROOKESIA_GESTURE_DIR_NONE) {
+            result.direction = direction;
+        }
+    }
+
+    // Release
+    tracker.getVelocity(velocity_x, velocity_y);
+    result.speed_px_per_ms = sqrtf(velocity_x * velocity_x + velocity_y * velocity_y);
+    result.slow_speed = (result.speed_px_per_ms < gesture_data.threshold.speed_slow_px_per_ms);
+    tracker.getFlingStopPoint(velocity_x, velocity_y, gesture_data.threshold.fling_deceleration_px_per_ms2, fling_x,
+                              fling_y);
+    result.fling_direction = ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, fling_x - first.x,
+                             fling_y - first.y);
+
+    return result;
+}
+
+TEST_CASE("test esp-brookesia gesture to replay touch traces", "[esp-brookesia][gesture][replay]")
+{
+    ESP_Brookesia_GestureTracker tracker;
+    float tan_threshold = tan((int)gesture_data.threshold.direction_angle * M_PI / 180);
+    float velocity_x = 0;
+    float velocity_y = 0;
+
+    for (auto &trace : traces) {
+        TestGestureResult_t result = replay_tracker(tracker, trace, tan_threshold, velocity_x, velocity_y);
+
+        ESP_LOGI(TAG, "%s: dir(%d) fling dir(%d) velocity(%.2f,%.2f) slow(%d)", trace.name, result.direction,
+                 result.fling_direction, velocity_x, velocity_y, result.slow_speed);
+
+        TEST_ASSERT_EQUAL_MESSAGE(trace.direction, result.direction, trace.name);
+        TEST_ASSERT_EQUAL_MESSAGE(trace.fling_direction, result.fling_direction, trace.name);
+        TEST_ASSERT_EQUAL_MESSAGE(trace.slow_speed, result.slow_speed, trace.name);
+    }
+}
+
+TEST_CASE("test esp-brookesia gesture to get the fling stop point", "[esp-brookesia][gesture][fling]")
+{
+    ESP_Brookesia_GestureTracker tracker;
+    int x = 0;
+    int y = 0;
+
+    tracker.addSample(100, 200, 0);
+
+    // No deceleration, the content stops at the last point
+    tracker.getFlingStopPoint(1, -1, 0, x, y);
+    TEST_ASSERT_EQUAL(100, x);
+    TEST_ASSERT_EQUAL(200, y);
+
+    // No velocity
+    tracker.getFlingStopPoint(0, 0, 0.01, x, y);
+    TEST_ASSERT_EQUAL(100, x);
+    TEST_ASSERT_EQUAL(200, y);
+
+    // 1px/ms slowed down by 0.01px/ms^2 stops after 1^2 / (2 * 0.01) = 50px
+    tracker.getFlingStopPoint(1, 0, 0.01, x, y);
+    TEST_ASSERT_EQUAL(150, x);
+    TEST_ASSERT_EQUAL(200, y);
+
+    // The distance is along the velocity, (0.6, -0.8) is 1px/ms
+    tracker.getFlingStopPoint(0.6, -0.8, 0.01, x, y);
+    TEST_ASSERT_INT_WITHIN(1, 130, x);
+    TEST_ASSERT_INT_WITHIN(1, 160, y);
+
+    // The stop point follows the last sample
+    tracker.addSample(300, 400, 16);
+    tracker.getFlingStopPoint(0, 2, 0.01, x, y);
+    TEST_ASSERT_EQUAL(300, x);
+    TEST_ASSERT_EQUAL(600, y);
+}
+
+TEST_CASE("test esp-brookesia gesture to get the direction", "[esp-brookesia][gesture][direction]")
+{
+    float tan_threshold = tan((int)gesture_data.threshold.direction_angle * M_PI / 180);
+    int vertical = gesture_data.threshold.direction_vertical;
+    int horizon = gesture_data.threshold.direction_horizon;
+
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_NONE,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, 0, 0));
+    // Not longer than the thresholds
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_NONE,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, 0, -vertical));
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_NONE,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, horizon, 0));
+    // Longer than the thresholds
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_UP,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, 0, -vertical - 1));
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_DOWN,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, 0, vertical + 1));
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_LEFT,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, -horizon - 1, 0));
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_RIGHT,
+                      ESP_Brookesia_GestureTracker::getDirection(gesture_data, tan_threshold, horizon + 1, 0));
+    // A diagonal move is classified by the angle threshold
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_UP, ESP_Brookesia_GestureTracker::getDirection(gesture_data,
+                      tan_threshold, (int)((vertical + 100) / tan_threshold) - 10, -vertical - 100));
+    TEST_ASSERT_EQUAL(ESP_BROOKESIA_GESTURE_DIR_RIGHT, ESP_Brookesia_GestureTracker::getDirection(gesture_data,
+                      tan_threshold, horizon + 100, (int)((horizon + 100) * tan_threshold) - 10));
+}
+
+TEST_CASE("test esp-brookesia gesture to estimate velocity", "[esp-brookesia][gesture][velocity]")
+{
+    ESP_Brookesia_GestureTracker tracker;
+    float velocity_x = 0;
+    float velocity_y = 0;
+
+    // Not enough samples
+    TEST_ASSERT_FALSE(tracker.getVelocity(velocity_x, velocity_y));
+    tracker.addSample(100, 100, 0);
+    TEST_ASSERT_FALSE(tracker.getVelocity(velocity_x, velocity_y));
+
+    // The jitter of the panel is smoothed, the last two points of the trace give -0.25px/ms
+    tracker.reset();
+    for (auto &sample : trace_noisy_drag) {
+        tracker.addSample(sample.x, sample.y, sample.tick_ms);
+    }
+    TEST_ASSERT_TRUE(tracker.getVelocity(velocity_x, velocity_y));
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 0, velocity_x);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, -0.5, velocity_y);
+
+    // Only the samples of the last window are used, more samples than the ring can hold are dropped
+    tracker.reset();
+    for (uint32_t t = 0; t < 1000; t += 10) {
+        tracker.addSample((t < 500) ? 0 : (t - 500), 0, t);
+    }
+    TEST_ASSERT_TRUE(tracker.getVelocity(velocity_x, velocity_y));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 1, velocity_x);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0, velocity_y);
+}
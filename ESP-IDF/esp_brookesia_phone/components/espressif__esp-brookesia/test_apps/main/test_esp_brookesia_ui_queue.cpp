@@ -0,0 +1,266 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "unity.h"
+#include "esp_brookesia.hpp"
+
+#define TEST_DURATION_MS            (2000)
+// The LVGL task renders a frame every period and holds the lock during the rendering
+#define TEST_RENDER_PERIOD_MS       (33)
+#define TEST_RENDER_TIME_MS         (20)
+// The worker tasks update the UI like the battery and the clock of the status bar, but much more often
+#define TEST_PRODUCER_NUM           (2)
+#define TEST_PRODUCER_PERIOD_MS     (5)
+// The number of the commands recorded by the order test
+#define TEST_RECORD_NUM             (8)
+
+static const char *TAG = "test_esp_brookesia_ui_queue";
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t done;
+    ESP_Brookesia_CoreUiQueue *queue;
+    volatile bool running;
+    bool is_key_shared;     // All the producers push the same key
+    int shown_values[TEST_PRODUCER_NUM];
+    int last_values[TEST_PRODUCER_NUM];
+    int missed_num[TEST_PRODUCER_NUM];
+    int64_t block_us_max[TEST_PRODUCER_NUM];
+} TestContext_t;
+
+typedef struct {
+    TestContext_t *context;
+    int id;
+} TestProducer_t;
+
+typedef struct {
+    int id;
+    int value;
+} TestUpdate_t;
+
+typedef struct {
+    int values[TEST_RECORD_NUM];
+    int value_num;
+} TestRecord_t;
+
+static void test_on_update(void *user_data, const void *data)
+{
+    TestContext_t *context = static_cast<TestContext_t *>(user_data);
+    const TestUpdate_t *update = static_cast<const TestUpdate_t *>(data);
+
+    context->shown_values[update->id] = update->value;
+}
+
+static void test_on_record(void *user_data, const void *data)
+{
+    TestRecord_t *record = static_cast<TestRecord_t *>(user_data);
+    const TestUpdate_t *update = static_cast<const TestUpdate_t *>(data);
+
+    if (record->value_num < TEST_RECORD_NUM) {
+        record->values[record->value_num++] = update->value;
+    }
+}
+
+static void test_producer_task(void *arg)
+{
+    TestProducer_t *producer = static_cast<TestProducer_t *>(arg);
+    TestContext_t *context = producer->context;
+    TestUpdate_t update = {
+        .id = producer->id,
+        .value = 0,
+    };
+
+    while (context->running) {
+        update.value++;
+        context->last_values[update.id] = update.value;
+
+        int64_t start_us = esp_timer_get_time();
+        if (!context->queue->push(test_on_update, context, update, context->is_key_shared ? 1 : (update.id + 1))) {
+            context->missed_num[update.id]++;
+        }
+        context->block_us_max[update.id] = std::max(context->block_us_max[update.id],
+                                                    esp_timer_get_time() - start_us);
+
+        vTaskDelay(pdMS_TO_TICKS(TEST_PRODUCER_PERIOD_MS));
+    }
+
+    xSemaphoreGive(context->done);
+    vTaskDelete(NULL);
+}
+
+static void test_run(TestContext_t &context)
+{
+    TestProducer_t producers[TEST_PRODUCER_NUM] = {};
+    int64_t end_us = 0;
+
+    context.lock = xSemaphoreCreateMutex();
+    TEST_ASSERT_NOT_NULL(context.lock);
+    context.done = xSemaphoreCreateCounting(TEST_PRODUCER_NUM, 0);
+    TEST_ASSERT_NOT_NULL(context.done);
+    context.running = true;
+
+    for (int i = 0; i < TEST_PRODUCER_NUM; i++) {
+        producers[i] = {
+            .context = &context,
+            .id = i,
+        };
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_producer_task, "UI Producer", 4096, &producers[i],
+                                              uxTaskPriorityGet(NULL) + 1, NULL));
+    }
+
+    // Act as the LVGL task, the queue is drained with the lock held like the drain timer
+    end_us = esp_timer_get_time() + TEST_DURATION_MS * 1000;
+    while (esp_timer_get_time() < end_us) {
+        xSemaphoreTake(context.lock, portMAX_DELAY);
+        context.queue->drain();
+        esp_rom_delay_us(TEST_RENDER_TIME_MS * 1000);
+        xSemaphoreGive(context.lock);
+        vTaskDelay(pdMS_TO_TICKS(TEST_RENDER_PERIOD_MS - TEST_RENDER_TIME_MS));
+    }
+
+    context.running = false;
+    for (int i = 0; i < TEST_PRODUCER_NUM; i++) {
+        xSemaphoreTake(context.done, portMAX_DELAY);
+    }
+    context.queue->drain();
+
+    vSemaphoreDelete(context.lock);
+    vSemaphoreDelete(context.done);
+    // Wait for the idle task to free the producer tasks
+    vTaskDelay(pdMS_TO_TICKS(100));
+}
+
+TEST_CASE("test esp-brookesia ui queue to coalesce commands", "[esp-brookesia][ui_queue][coalesce]")
+{
+    ESP_Brookesia_CoreUiQueue queue(4);
+    TestContext_t context = {};
+    TestUpdate_t update = {};
+
+    TEST_ASSERT_EQUAL(4, queue.getCapacity());
+
+    // Only the latest update of each key is executed, the order between the keys is kept
+    for (int i = 1; i <= 3; i++) {
+        update = { .id = 0, .value = i };
+        TEST_ASSERT_TRUE(queue.push(test_on_update, &context, update, 1));
+    }
+    update = { .id = 1, .value = 10 };
+    TEST_ASSERT_TRUE(queue.push(test_on_update, &context, update, 2));
+    // Each key only takes one cell, the commands without a key are never coalesced
+    for (int i = 11; i <= 12; i++) {
+        update = { .id = 1, .value = i };
+        TEST_ASSERT_TRUE(queue.push(test_on_update, &context, update));
+    }
+    // The queue is full, but a key which is already queued is still updated
+    TEST_ASSERT_FALSE(queue.push(test_on_update, &context, update));
+    update = { .id = 0, .value = 4 };
+    TEST_ASSERT_TRUE(queue.push(test_on_update, &context, update, 1));
+    TEST_ASSERT_EQUAL(4, queue.drain());
+    TEST_ASSERT_EQUAL(4, context.shown_values[0]);
+    TEST_ASSERT_EQUAL(12, context.shown_values[1]);
+    TEST_ASSERT_EQUAL(0, queue.drain());
+
+    ESP_Brookesia_CoreUiQueue::Stats stats = queue.getStats();
+    TEST_ASSERT_EQUAL(7, stats.pushed);
+    TEST_ASSERT_EQUAL(1, stats.dropped);
+    TEST_ASSERT_EQUAL(3, stats.coalesced);
+    TEST_ASSERT_EQUAL(4, stats.executed);
+}
+
+TEST_CASE("test esp-brookesia ui queue to keep the order of commands", "[esp-brookesia][ui_queue][order]")
+{
+    ESP_Brookesia_CoreUiQueue queue(8);
+    TestRecord_t record = {};
+    TestUpdate_t update = {};
+
+    // The data is copied when it's pushed, so the same variable can be reused
+    for (int i = 1; i <= 3; i++) {
+        update = { .id = 0, .value = i };
+        TEST_ASSERT_TRUE(queue.push(test_on_record, &record, update));
+    }
+    // A keyed command keeps the place of its first push
+    update = { .id = 0, .value = 4 };
+    TEST_ASSERT_TRUE(queue.push(test_on_record, &record, update, 1));
+    update = { .id = 0, .value = 5 };
+    TEST_ASSERT_TRUE(queue.push(test_on_record, &record, update));
+    update = { .id = 0, .value = 6 };
+    TEST_ASSERT_TRUE(queue.push(test_on_record, &record, update, 1));
+    TEST_ASSERT_EQUAL(5, queue.drain());
+
+    const int expected[] = { 1, 2, 3, 6, 5 };
+    TEST_ASSERT_EQUAL(5, record.value_num);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL(expected[i], record.values[i]);
+    }
+
+    // The key can be pushed again once it's drained
+    update = { .id = 0, .value = 7 };
+    TEST_ASSERT_TRUE(queue.push(test_on_record, &record, update, 1));
+    TEST_ASSERT_EQUAL(1, queue.drain());
+    TEST_ASSERT_EQUAL(6, record.value_num);
+    TEST_ASSERT_EQUAL(7, record.values[5]);
+}
+
+TEST_CASE("test esp-brookesia ui queue to push from tasks", "[esp-brookesia][ui_queue][task]")
+{
+    TestContext_t context = {};
+    ESP_Brookesia_CoreUiQueue *queue = new ESP_Brookesia_CoreUiQueue();
+    TEST_ASSERT_NOT_NULL(queue);
+
+    context.queue = queue;
+    test_run(context);
+
+    ESP_Brookesia_CoreUiQueue::Stats stats = queue->getStats();
+    ESP_LOGI(TAG, "Queue: pushed(%d) dropped(%d) coalesced(%d) executed(%d)", (int)stats.pushed, (int)stats.dropped,
+             (int)stats.coalesced, (int)stats.executed);
+
+    // No update is lost and the latest value is always shown at last
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(stats.pushed, stats.coalesced + stats.executed);
+    for (int i = 0; i < TEST_PRODUCER_NUM; i++) {
+        ESP_LOGI(TAG, "Producer(%d): shown(%d/%d) blocked max(%dus)", i, context.shown_values[i],
+                 context.last_values[i], (int)context.block_us_max[i]);
+        TEST_ASSERT_EQUAL(0, context.missed_num[i]);
+        TEST_ASSERT_EQUAL(context.last_values[i], context.shown_values[i]);
+        // Pushing never waits for the rendering which holds the lock
+        TEST_ASSERT_LESS_THAN(TEST_RENDER_TIME_MS * 1000 / 2, context.block_us_max[i]);
+    }
+
+    delete queue;
+}
+
+TEST_CASE("test esp-brookesia ui queue to push the same key from tasks", "[esp-brookesia][ui_queue][task]")
+{
+    TestContext_t context = {};
+    ESP_Brookesia_CoreUiQueue *queue = new ESP_Brookesia_CoreUiQueue();
+    TEST_ASSERT_NOT_NULL(queue);
+    int push_num = 0;
+    int missed_num = 0;
+
+    context.queue = queue;
+    context.is_key_shared = true;
+    test_run(context);
+
+    ESP_Brookesia_CoreUiQueue::Stats stats = queue->getStats();
+    ESP_LOGI(TAG, "Queue: pushed(%d) dropped(%d) coalesced(%d) executed(%d)", (int)stats.pushed, (int)stats.dropped,
+             (int)stats.coalesced, (int)stats.executed);
+
+    // A push which meets another one writing the slot fails and is counted as dropped, not as coalesced
+    for (int i = 0; i < TEST_PRODUCER_NUM; i++) {
+        push_num += context.last_values[i];
+        missed_num += context.missed_num[i];
+    }
+    TEST_ASSERT_EQUAL(missed_num, stats.dropped);
+    TEST_ASSERT_EQUAL(push_num - missed_num, stats.pushed);
+    TEST_ASSERT_EQUAL(stats.pushed, stats.coalesced + stats.executed);
+
+    delete queue;
+}
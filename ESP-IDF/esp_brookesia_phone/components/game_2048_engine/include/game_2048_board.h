@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A board of 2048 in 64 bits: each cell is a nibble with the exponent of its tile (0 if empty, 1 for 2, 11 for 2048).
+ * The cell of row `r` and column `c` is at the bit `16 * r + 4 * c`, so a row is 16 bits and each move of a row is
+ * read from a table of 65536 entries, built once by `game_2048_board_init()`.
+ */
+
+#define GAME_2048_SIZE              (4)
+#define GAME_2048_EXPONENT_MAX      (15)
+
+#define GAME_2048_OK                (0)
+#define GAME_2048_ERR_INVALID       (-1)
+#define GAME_2048_ERR_NO_MEM        (-2)
+
+typedef uint64_t game_2048_board_t;
+
+typedef enum {
+    GAME_2048_DIR_UP = 0,
+    GAME_2048_DIR_DOWN,
+    GAME_2048_DIR_LEFT,
+    GAME_2048_DIR_RIGHT,
+    GAME_2048_DIR_NUM,
+    GAME_2048_DIR_NONE = GAME_2048_DIR_NUM,
+} game_2048_dir_t;
+
+/**
+ * @brief Build the tables of the rows, about 640 KB in PSRAM. It can be called several times, from any thread.
+ *
+ * @return GAME_2048_OK, or GAME_2048_ERR_NO_MEM
+ */
+int game_2048_board_init(void);
+
+/**
+ * @brief Pack the exponents of the cells.
+ *
+ * @param exponents The exponents of the cells by row and column, they are clamped to `GAME_2048_EXPONENT_MAX`
+ *
+ * @return The board
+ */
+game_2048_board_t game_2048_board_pack(const int exponents[GAME_2048_SIZE][GAME_2048_SIZE]);
+
+/**
+ * @brief Unpack the exponents of the cells.
+ *
+ * @param board The board
+ * @param exponents The exponents of the cells by row and column
+ */
+void game_2048_board_unpack(game_2048_board_t board, int exponents[GAME_2048_SIZE][GAME_2048_SIZE]);
+
+/**
+ * @brief Get the exponent of a cell.
+ */
+static inline int game_2048_board_get(game_2048_board_t board, int row, int col)
+{
+    return (int)((board >> (16 * row + 4 * col)) & 0xf);
+}
+
+/**
+ * @brief Set the exponent of a cell.
+ */
+static inline game_2048_board_t game_2048_board_set(game_2048_board_t board, int row, int col, int exponent)
+{
+    int shift = 16 * row + 4 * col;
+
+    return (board & ~((game_2048_board_t)0xf << shift)) | ((game_2048_board_t)(exponent & 0xf) << shift);
+}
+
+/**
+ * @brief Move the tiles, the tables must be built.
+ *
+ * @param board The board
+ * @param dir The direction
+ * @param score The sum of the merged tiles, can be NULL
+ *
+ * @return The board after the move, `board` if no tile moves
+ */
+game_2048_board_t game_2048_board_move(game_2048_board_t board, game_2048_dir_t dir, uint32_t *score);
+
+/**
+ * @brief Check whether a move is left, the tables must be built.
+ */
+bool game_2048_board_can_move(game_2048_board_t board);
+
+/**
+ * @brief Count the empty cells.
+ */
+int game_2048_board_count_empty(game_2048_board_t board);
+
+/**
+ * @brief Get the highest exponent.
+ */
+int game_2048_board_max_exponent(game_2048_board_t board);
+
+/**
+ * @brief Swap the rows and the columns.
+ */
+game_2048_board_t game_2048_board_transpose(game_2048_board_t board);
+
+/**
+ * @brief Evaluate a board for the solver, higher is better: the sum of a value of each row and each column, read from
+ *        a table, for the empty cells, the merges and the monotonic lines. The tables must be built.
+ */
+float game_2048_board_evaluate(game_2048_board_t board);
+
+#ifdef __cplusplus
+}
+#endif
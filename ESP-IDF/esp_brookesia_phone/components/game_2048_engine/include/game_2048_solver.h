@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game_2048_board.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An expectimax solver of 2048: the moves are max nodes, the new tiles (2 at 90 %, 4 at 10 %) are chance nodes. It
+ * searches one move deeper at a time until its time budget is spent, and gives the best move of the deepest search
+ * which ended. The chance nodes are kept in a transposition table, so a board reached by several orders of moves is
+ * searched once.
+ *
+ * The searches run on a worker, requested by `game_2048_solver_request()` and polled by `game_2048_solver_get_hint()`,
+ * or in the caller by `game_2048_solver_search()`.
+ */
+
+typedef struct game_2048_solver_t game_2048_solver_t;
+
+typedef struct {
+    uint32_t time_budget_ms;    /*!< A search stops after this time, but the search of depth 1 always ends */
+    uint8_t depth_max;          /*!< The searches stop at this depth, in moves */
+    uint8_t tt_bits;            /*!< The transposition table has `1 << tt_bits` entries of 16 bytes, 0 for none */
+    uint32_t stack_size;        /*!< The stack of the worker */
+    uint8_t priority;           /*!< The priority of the worker, below the one of LVGL */
+} game_2048_solver_config_t;
+
+#define GAME_2048_SOLVER_DEFAULT_CONFIG() { \
+    .time_budget_ms = 200,                  \
+    .depth_max = 8,                         \
+    .tt_bits = 15,                          \
+    .stack_size = 8 * 1024,                 \
+    .priority = 2,                          \
+}
+
+typedef struct {
+    game_2048_board_t board;    /*!< The board which is searched */
+    game_2048_dir_t dir;        /*!< The best move, `GAME_2048_DIR_NONE` if there is none */
+    float value;                /*!< The expected evaluation after the best move */
+    uint8_t depth;              /*!< The depth of the deepest search which ended */
+    uint32_t node_num;          /*!< The nodes of all the searches */
+    uint32_t tt_hit_num;        /*!< The chance nodes read from the transposition table */
+    uint32_t time_ms;
+} game_2048_hint_t;
+
+/**
+ * @brief Create a solver, and build the tables of the boards.
+ *
+ * @param config The configuration
+ *
+ * @return The solver, NULL if out of memory
+ */
+game_2048_solver_t *game_2048_solver_new(const game_2048_solver_config_t *config);
+
+/**
+ * @brief Delete a solver, a running search is stopped.
+ *
+ * @param solver The solver, can be NULL
+ */
+void game_2048_solver_del(game_2048_solver_t *solver);
+
+/**
+ * @brief Search the best move in the caller, waiting for the search of the worker if any.
+ *
+ * @param solver The solver
+ * @param board The board
+ * @param hint The best move
+ *
+ * @return GAME_2048_OK, or GAME_2048_ERR_INVALID
+ */
+int game_2048_solver_search(game_2048_solver_t *solver, game_2048_board_t board, game_2048_hint_t *hint);
+
+/**
+ * @brief Request the best move of a board from the worker. The request replaces the previous one, and stops its
+ *        search if it's running.
+ *
+ * @param solver The solver
+ * @param board The board
+ *
+ * @return GAME_2048_OK, or GAME_2048_ERR_INVALID
+ */
+int game_2048_solver_request(game_2048_solver_t *solver, game_2048_board_t board);
+
+/**
+ * @brief Stop the search of the worker and drop its request.
+ *
+ * @param solver The solver
+ */
+void game_2048_solver_cancel(game_2048_solver_t *solver);
+
+/**
+ * @brief Get the best move of the last request, it can be polled by a timer of the UI.
+ *
+ * @param solver The solver
+ * @param hint The best move
+ *
+ * @return true once the search of the last request has ended
+ */
+bool game_2048_solver_get_hint(game_2048_solver_t *solver, game_2048_hint_t *hint);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "game_2048_board.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#define GAME_2048_TABLE_ALLOC(size)     heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define GAME_2048_TABLE_ALLOC(size)     malloc(size)
+#endif
+
+#define ROW_NUM                 (1 << 16)
+#define ROW_MASK                (0xffffULL)
+
+/* The weights of the evaluation of a line */
+#define EVAL_LOST_PENALTY       (200000.0f)
+#define EVAL_MONOTONIC_POWER    (4.0f)
+#define EVAL_MONOTONIC_WEIGHT   (47.0f)
+#define EVAL_SUM_POWER          (3.5f)
+#define EVAL_SUM_WEIGHT         (11.0f)
+#define EVAL_MERGE_WEIGHT       (700.0f)
+#define EVAL_EMPTY_WEIGHT       (270.0f)
+
+/* A move to the right is the move to the left of the reversed row, so it has no table */
+typedef struct {
+    uint16_t left[ROW_NUM];
+    uint32_t score[ROW_NUM];
+    float eval[ROW_NUM];
+} game_2048_tables_t;
+
+static game_2048_tables_t *tables = NULL;
+
+static inline uint16_t reverse_row(uint16_t row)
+{
+    return (uint16_t)((row >> 12) | ((row >> 4) & 0x00f0) | ((row << 4) & 0x0f00) | (row << 12));
+}
+
+static uint16_t build_move_left(uint16_t row, uint32_t *score)
+{
+    int out[GAME_2048_SIZE] = {};
+    bool merged[GAME_2048_SIZE] = {};
+    int out_num = 0;
+
+    *score = 0;
+    for (int i = 0; i < GAME_2048_SIZE; i++) {
+        int exponent = (row >> (4 * i)) & 0xf;
+        if (exponent == 0) {
+            continue;
+        }
+        /* A merged tile doesn't merge again, and two tiles of the highest exponent don't merge */
+        if ((out_num > 0) && (out[out_num - 1] == exponent) && !merged[out_num - 1] &&
+                (exponent < GAME_2048_EXPONENT_MAX)) {
+            out[out_num - 1]++;
+            merged[out_num - 1] = true;
+            *score += 1U << (exponent + 1);
+        } else {
+            out[out_num++] = exponent;
+        }
+    }
+
+    uint16_t result = 0;
+    for (int i = 0; i < out_num; i++) {
+        result |= (uint16_t)(out[i] << (4 * i));
+    }
+    return result;
+}
+
+static float build_eval(uint16_t row)
+{
+    int line[GAME_2048_SIZE];
+    float sum = 0;
+    int empty = 0;
+    int merges = 0;
+    int prev = 0;
+    int counter = 0;
+
+    for (int i = 0; i < GAME_2048_SIZE; i++) {
+        line[i] = (row >> (4 * i)) & 0xf;
+        sum += powf(line[i], EVAL_SUM_POWER);
+        if (line[i] == 0) {
+            empty++;
+            continue;
+        }
+        if (prev == line[i]) {
+            counter++;
+        } else if (counter > 0) {
+            merges += 1 + counter;
+            counter = 0;
+        }
+        prev = line[i];
+    }
+    if (counter > 0) {
+        merges += 1 + counter;
+    }
+
+    /* The penalty of the line is the lower one of its two directions */
+    float monotonic_left = 0;
+    float monotonic_right = 0;
+    for (int i = 1; i < GAME_2048_SIZE; i++) {
+        float prev_power = powf(line[i - 1], EVAL_MONOTONIC_POWER);
+        float power = powf(line[i], EVAL_MONOTONIC_POWER);
+        if (line[i - 1] > line[i]) {
+            monotonic_left += prev_power - power;
+        } else {
+            monotonic_right += power - prev_power;
+        }
+    }
+
+    return EVAL_LOST_PENALTY + EVAL_EMPTY_WEIGHT * empty + EVAL_MERGE_WEIGHT * merges -
+           EVAL_MONOTONIC_WEIGHT * fminf(monotonic_left, monotonic_right) - EVAL_SUM_WEIGHT * sum;
+}
+
+static void build_tables(void)
+{
+    game_2048_tables_t *new_tables = GAME_2048_TABLE_ALLOC(sizeof(game_2048_tables_t));
+    if (new_tables == NULL) {
+        return;
+    }
+
+    for (uint32_t row = 0; row < ROW_NUM; row++) {
+        new_tables->left[row] = build_move_left((uint16_t)row, &new_tables->score[row]);
+        new_tables->eval[row] = build_eval((uint16_t)row);
+    }
+    tables = new_tables;
+}
+
+int game_2048_board_init(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+    pthread_once(&once, build_tables);
+
+    return (tables != NULL) ? GAME_2048_OK : GAME_2048_ERR_NO_MEM;
+}
+
+game_2048_board_t game_2048_board_pack(const int exponents[GAME_2048_SIZE][GAME_2048_SIZE])
+{
+    game_2048_board_t board = 0;
+
+    for (int row = 0; row < GAME_2048_SIZE; row++) {
+        for (int col = 0; col < GAME_2048_SIZE; col++) {
+            int exponent = exponents[row][col];
+            exponent = (exponent < 0) ? 0 : ((exponent > GAME_2048_EXPONENT_MAX) ? GAME_2048_EXPONENT_MAX : exponent);
+            board = game_2048_board_set(board, row, col, exponent);
+        }
+    }
+    return board;
+}
+
+void game_2048_board_unpack(game_2048_board_t board, int exponents[GAME_2048_SIZE][GAME_2048_SIZE])
+{
+    for (int row = 0; row < GAME_2048_SIZE; row++) {
+        for (int col = 0; col < GAME_2048_SIZE; col++) {
+            exponents[row][col] = game_2048_board_get(board, row, col);
+        }
+    }
+}
+
+game_2048_board_t game_2048_board_transpose(game_2048_board_t board)
+{
+    /* Swap the 2x2 blocks of nibbles, then the cells within them */
+    game_2048_board_t a1 = board & 0xF0F00F0FF0F00F0FULL;
+    game_2048_board_t a2 = board & 0x0000F0F00000F0F0ULL;
+    game_2048_board_t a3 = board & 0x0F0F00000F0F0000ULL;
+    game_2048_board_t a = a1 | (a2 << 12) | (a3 >> 12);
+    game_2048_board_t b1 = a & 0xFF00FF0000FF00FFULL;
+    game_2048_board_t b2 = a & 0x00FF00FF00000000ULL;
+    game_2048_board_t b3 = a & 0x00000000FF00FF00ULL;
+
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+static inline game_2048_board_t move_rows(game_2048_board_t board, bool to_left, uint32_t *score)
+{
+    game_2048_board_t result = 0;
+
+    for (int i = 0; i < GAME_2048_SIZE; i++) {
+        uint16_t row = (uint16_t)((board >> (16 * i)) & ROW_MASK);
+        uint16_t moved = 0;
+        if (to_left) {
+            moved = tables->left[row];
+            *score += tables->score[row];
+        } else {
+            uint16_t reversed = reverse_row(row);
+            moved = reverse_row(tables->left[reversed]);
+            *score += tables->score[reversed];
+        }
+        result |= (game_2048_board_t)moved << (16 * i);
+    }
+    return result;
+}
+
+game_2048_board_t game_2048_board_move(game_2048_board_t board, game_2048_dir_t dir, uint32_t *score)
+{
+    uint32_t move_score = 0;
+    game_2048_board_t result = board;
+
+    switch (dir) {
+    case GAME_2048_DIR_LEFT:
+        result = move_rows(board, true, &move_score);
+        break;
+    case GAME_2048_DIR_RIGHT:
+        result = move_rows(board, false, &move_score);
+        break;
+    /* A column is moved as a row of the transposed board, row 0 being its left */
+    case GAME_2048_DIR_UP:
+        result = game_2048_board_transpose(move_rows(game_2048_board_transpose(board), true, &move_score));
+        break;
+    case GAME_2048_DIR_DOWN:
+        result = game_2048_board_transpose(move_rows(game_2048_board_transpose(board), false, &move_score));
+        break;
+    default:
+        break;
+    }
+    if (score != NULL) {
+        *score = move_score;
+    }
+
+    return result;
+}
+
+bool game_2048_board_can_move(game_2048_board_t board)
+{
+    for (int dir = 0; dir < GAME_2048_DIR_NUM; dir++) {
+        if (game_2048_board_move(board, (game_2048_dir_t)dir, NULL) != board) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int game_2048_board_count_empty(game_2048_board_t board)
+{
+    /* Fold each nibble into its lowest bit, which is set for a tile */
+    board |= (board >> 2) & 0x3333333333333333ULL;
+    board |= (board >> 1);
+
+    return __builtin_popcountll(~board & 0x1111111111111111ULL);
+}
+
+int game_2048_board_max_exponent(game_2048_board_t board)
+{
+    int max = 0;
+
+    for (; board != 0; board >>= 4) {
+        int exponent = (int)(board & 0xf);
+        max = (exponent > max) ? exponent : max;
+    }
+    return max;
+}
+
+float game_2048_board_evaluate(game_2048_board_t board)
+{
+    game_2048_board_t transposed = game_2048_board_transpose(board);
+    float eval = 0;
+
+    for (int i = 0; i < GAME_2048_SIZE; i++) {
+        eval += tables->eval[(board >> (16 * i)) & ROW_MASK];
+        eval += tables->eval[(transposed >> (16 * i)) & ROW_MASK];
+    }
+    return eval;
+}
@@ -0,0 +1,402 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game_2048_solver.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#define GAME_2048_LOGE(format, ...)     ESP_LOGE(TAG, format, ##__VA_ARGS__)
+#define GAME_2048_TT_CALLOC(num, size)  heap_caps_calloc(num, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define GAME_2048_LOGE(format, ...)     fprintf(stderr, "[%s] " format "\n", TAG, ##__VA_ARGS__)
+#define GAME_2048_TT_CALLOC(num, size)  calloc(num, size)
+#endif
+
+/* The branches of new tiles less likely than this are evaluated without a search */
+#define PROB_MIN                (0.0001f)
+#define PROB_TILE_2             (0.9f)
+#define PROB_TILE_4             (0.1f)
+/* The time is read once per this number of nodes */
+#define TIME_CHECK_NODE_MASK    (0x3ff)
+
+typedef struct {
+    game_2048_board_t board;
+    float value;
+    /* The depth which was left below the node */
+    uint8_t depth;
+    /* Entries of the previous searches are empty */
+    uint16_t generation;
+} game_2048_tt_entry_t;
+
+struct game_2048_solver_t {
+    game_2048_solver_config_t config;
+    game_2048_tt_entry_t *tt;
+    uint32_t tt_mask;
+    uint16_t generation;
+    /* Held during a search, so the worker and `game_2048_solver_search()` share the table */
+    pthread_mutex_t search_lock;
+    /* Guards the request and the hint */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t worker;
+    bool has_worker;
+    bool exit;
+    bool has_request;
+    game_2048_board_t request_board;
+    uint32_t request_id;
+    bool has_hint;
+    game_2048_hint_t hint;
+    /* Stops the search of the worker, it's read without the lock */
+    atomic_bool stop;
+};
+
+typedef struct {
+    game_2048_solver_t *solver;
+    bool can_stop;
+    int64_t deadline_ms;
+    /* The search of the current depth is dropped */
+    bool aborted;
+    uint32_t node_num;
+    uint32_t tt_hit_num;
+} game_2048_search_t;
+
+static const char *TAG = "game_2048_solver";
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static float move_node(game_2048_search_t *search, game_2048_board_t board, int depth, float prob);
+
+static float chance_node(game_2048_search_t *search, game_2048_board_t board, int depth, float prob)
+{
+    game_2048_solver_t *solver = search->solver;
+
+    search->node_num++;
+    if ((search->node_num & TIME_CHECK_NODE_MASK) == 0) {
+        search->aborted |= (search->deadline_ms > 0) && (now_ms() >= search->deadline_ms);
+        search->aborted |= search->can_stop && atomic_load(&solver->stop);
+    }
+    if (search->aborted) {
+        return 0;
+    }
+    if ((depth == 0) || (prob < PROB_MIN)) {
+        return game_2048_board_evaluate(board);
+    }
+
+    /* Multiplying by the golden ratio spreads the boards which differ in their high cells */
+    game_2048_tt_entry_t *entry = NULL;
+    if (solver->tt != NULL) {
+        entry = &solver->tt[(uint32_t)((board * 0x9E3779B97F4A7C15ULL) >> 40) & solver->tt_mask];
+        if ((entry->generation == solver->generation) && (entry->board == board) && (entry->depth >= depth)) {
+            search->tt_hit_num++;
+            return entry->value;
+        }
+    }
+
+    int empty_num = game_2048_board_count_empty(board);
+    if (empty_num == 0) {
+        return game_2048_board_evaluate(board);
+    }
+    prob /= empty_num;
+
+    float sum = 0;
+    game_2048_board_t cells = board;
+    game_2048_board_t tile = 1;
+    for (int i = 0; i < GAME_2048_SIZE * GAME_2048_SIZE; i++, cells >>= 4, tile <<= 4) {
+        if ((cells & 0xf) != 0) {
+            continue;
+        }
+        sum += PROB_TILE_2 * move_node(search, board | tile, depth, prob * PROB_TILE_2);
+        sum += PROB_TILE_4 * move_node(search, board | (tile << 1), depth, prob * PROB_TILE_4);
+    }
+    float value = sum / empty_num;
+
+    if ((entry != NULL) && !search->aborted) {
+        *entry = (game_2048_tt_entry_t) {
+            .board = board,
+            .value = value,
+            .depth = (uint8_t)depth,
+            .generation = solver->generation,
+        };
+    }
+
+    return value;
+}
+
+/* A board without a move is worth 0, below all the evaluations */
+static float move_node(game_2048_search_t *search, game_2048_board_t board, int depth, float prob)
+{
+    float best = 0;
+
+    for (int dir = 0; dir < GAME_2048_DIR_NUM; dir++) {
+        game_2048_board_t next = game_2048_board_move(board, (game_2048_dir_t)dir, NULL);
+        if (next == board) {
+            continue;
+        }
+        float value = chance_node(search, next, depth - 1, prob);
+        best = (value > best) ? value : best;
+    }
+    return best;
+}
+
+/* Search one move deeper at a time, the solver's search lock is held */
+static bool run_search(game_2048_solver_t *solver, game_2048_board_t board, bool can_stop, game_2048_hint_t *hint)
+{
+    int64_t start_ms = now_ms();
+    game_2048_search_t search = {
+        .solver = solver,
+        .can_stop = can_stop,
+    };
+
+    *hint = (game_2048_hint_t) {
+        .board = board,
+        .dir = GAME_2048_DIR_NONE,
+    };
+    /* The entries of the previous searches are dropped, and cleared once the generations wrap */
+    if (++solver->generation == 0) {
+        if (solver->tt != NULL) {
+            memset(solver->tt, 0, (solver->tt_mask + 1) * sizeof(game_2048_tt_entry_t));
+        }
+        solver->generation = 1;
+    }
+
+    for (int depth = 1; depth <= solver->config.depth_max; depth++) {
+        game_2048_dir_t best_dir = GAME_2048_DIR_NONE;
+        float best_value = 0;
+
+        /* The search of depth 1 has no deadline, so there is always a move */
+        search.deadline_ms = (depth > 1) ? (start_ms + solver->config.time_budget_ms) : 0;
+        for (int dir = 0; dir < GAME_2048_DIR_NUM; dir++) {
+            game_2048_board_t next = game_2048_board_move(board, (game_2048_dir_t)dir, NULL);
+            if (next == board) {
+                continue;
+            }
+            float value = chance_node(&search, next, depth - 1, 1.0f);
+            if ((best_dir == GAME_2048_DIR_NONE) || (value > best_value)) {
+                best_dir = (game_2048_dir_t)dir;
+                best_value = value;
+            }
+        }
+        if (search.aborted) {
+            break;
+        }
+        hint->dir = best_dir;
+        hint->value = best_value;
+        hint->depth = (uint8_t)depth;
+        if ((best_dir == GAME_2048_DIR_NONE) || (now_ms() - start_ms >= solver->config.time_budget_ms)) {
+            break;
+        }
+    }
+    hint->node_num = search.node_num;
+    hint->tt_hit_num = search.tt_hit_num;
+    hint->time_ms = (uint32_t)(now_ms() - start_ms);
+
+    /* Only a stop drops the result, the deadline keeps the one of the previous depth */
+    return !(can_stop && atomic_load(&solver->stop));
+}
+
+static void *worker_main(void *arg)
+{
+    game_2048_solver_t *solver = arg;
+    game_2048_hint_t hint;
+
+    pthread_mutex_lock(&solver->lock);
+    while (!solver->exit) {
+        if (!solver->has_request) {
+            pthread_cond_wait(&solver->cond, &solver->lock);
+            continue;
+        }
+        game_2048_board_t board = solver->request_board;
+        uint32_t request_id = solver->request_id;
+        solver->has_request = false;
+        atomic_store(&solver->stop, false);
+        pthread_mutex_unlock(&solver->lock);
+
+        pthread_mutex_lock(&solver->search_lock);
+        bool done = run_search(solver, board, true, &hint);
+        pthread_mutex_unlock(&solver->search_lock);
+
+        pthread_mutex_lock(&solver->lock);
+        if (done && (request_id == solver->request_id)) {
+            solver->hint = hint;
+            solver->has_hint = true;
+        }
+    }
+    pthread_mutex_unlock(&solver->lock);
+
+    return NULL;
+}
+
+static bool start_worker(game_2048_solver_t *solver)
+{
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t prev_cfg;
+    bool has_prev_cfg = (esp_pthread_get_cfg(&prev_cfg) == ESP_OK);
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = solver->config.stack_size;
+    cfg.prio = solver->config.priority;
+    cfg.thread_name = "2048_solver";
+    cfg.pin_to_core = tskNO_AFFINITY;
+    esp_pthread_set_cfg(&cfg);
+#endif
+
+    solver->has_worker = (pthread_create(&solver->worker, NULL, worker_main, solver) == 0);
+
+#ifdef ESP_PLATFORM
+    if (has_prev_cfg) {
+        esp_pthread_set_cfg(&prev_cfg);
+    } else {
+        esp_pthread_cfg_t restore_cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&restore_cfg);
+    }
+#endif
+
+    return solver->has_worker;
+}
+
+game_2048_solver_t *game_2048_solver_new(const game_2048_solver_config_t *config)
+{
+    if ((config == NULL) || (config->depth_max == 0) || (config->tt_bits > 24)) {
+        return NULL;
+    }
+    if (game_2048_board_init() != GAME_2048_OK) {
+        GAME_2048_LOGE("Build tables failed");
+        return NULL;
+    }
+
+    game_2048_solver_t *solver = calloc(1, sizeof(game_2048_solver_t));
+    if (solver == NULL) {
+        return NULL;
+    }
+    solver->config = *config;
+    if (config->tt_bits > 0) {
+        solver->tt = GAME_2048_TT_CALLOC(1U << config->tt_bits, sizeof(game_2048_tt_entry_t));
+        if (solver->tt == NULL) {
+            GAME_2048_LOGE("Allocate transposition table failed");
+            free(solver);
+            return NULL;
+        }
+        solver->tt_mask = (1U << config->tt_bits) - 1;
+    }
+    atomic_init(&solver->stop, false);
+
+    bool search_lock_ok = (pthread_mutex_init(&solver->search_lock, NULL) == 0);
+    bool lock_ok = (pthread_mutex_init(&solver->lock, NULL) == 0);
+    bool cond_ok = (pthread_cond_init(&solver->cond, NULL) == 0);
+    if (!search_lock_ok || !lock_ok || !cond_ok || !start_worker(solver)) {
+        GAME_2048_LOGE("Create solver failed");
+        if (cond_ok) {
+            pthread_cond_destroy(&solver->cond);
+        }
+        if (lock_ok) {
+            pthread_mutex_destroy(&solver->lock);
+        }
+        if (search_lock_ok) {
+            pthread_mutex_destroy(&solver->search_lock);
+        }
+        free(solver->tt);
+        free(solver);
+        return NULL;
+    }
+
+    return solver;
+}
+
+void game_2048_solver_del(game_2048_solver_t *solver)
+{
+    if (solver == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&solver->lock);
+    solver->exit = true;
+    atomic_store(&solver->stop, true);
+    pthread_cond_signal(&solver->cond);
+    pthread_mutex_unlock(&solver->lock);
+    pthread_join(solver->worker, NULL);
+
+    pthread_cond_destroy(&solver->cond);
+    pthread_mutex_destroy(&solver->lock);
+    pthread_mutex_destroy(&solver->search_lock);
+    free(solver->tt);
+    free(solver);
+}
+
+int game_2048_solver_search(game_2048_solver_t *solver, game_2048_board_t board, game_2048_hint_t *hint)
+{
+    if ((solver == NULL) || (hint == NULL)) {
+        return GAME_2048_ERR_INVALID;
+    }
+
+    pthread_mutex_lock(&solver->search_lock);
+    run_search(solver, board, false, hint);
+    pthread_mutex_unlock(&solver->search_lock);
+
+    return GAME_2048_OK;
+}
+
+int game_2048_solver_request(game_2048_solver_t *solver, game_2048_board_t board)
+{
+    if (solver == NULL) {
+        return GAME_2048_ERR_INVALID;
+    }
+
+    pthread_mutex_lock(&solver->lock);
+    solver->request_board = board;
+    solver->request_id++;
+    solver->has_request = true;
+    solver->has_hint = false;
+    atomic_store(&solver->stop, true);
+    pthread_cond_signal(&solver->cond);
+    pthread_mutex_unlock(&solver->lock);
+
+    return GAME_2048_OK;
+}
+
+void game_2048_solver_cancel(game_2048_solver_t *solver)
+{
+    if (solver == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&solver->lock);
+    solver->request_id++;
+    solver->has_request = false;
+    solver->has_hint = false;
+    atomic_store(&solver->stop, true);
+    pthread_mutex_unlock(&solver->lock);
+}
+
+bool game_2048_solver_get_hint(game_2048_solver_t *solver, game_2048_hint_t *hint)
+{
+    bool has_hint = false;
+
+    if ((solver == NULL) || (hint == NULL)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&solver->lock);
+    has_hint = solver->has_hint;
+    if (has_hint) {
+        *hint = solver->hint;
+    }
+    pthread_mutex_unlock(&solver->lock);
+
+    return has_hint;
+}
@@ -0,0 +1,425 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * Check the moves of the bitboard against a grid of cells moved by loops, like the ones of the app, and measure both.
+ * Then run the solver on the boards of a seeded game. See README.md.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game_2048_board.h"
+#include "game_2048_solver.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+#define TEST_BOARD_NUM          (100000)
+#define TEST_BENCH_MOVE_NUM     (4000000)
+#define TEST_HINT_WAIT_MS       (5000)
+
+typedef int test_grid_t[GAME_2048_SIZE][GAME_2048_SIZE];
+
+static uint64_t rand_state = 0x2048;
+
+/* xorshift64, the same numbers on every host */
+static uint32_t test_rand(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 7;
+    rand_state ^= rand_state << 17;
+    return (uint32_t)(rand_state >> 32);
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_ms(int ms)
+{
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static game_2048_board_t random_board(void)
+{
+    game_2048_board_t board = 0;
+
+    /* Mostly small tiles and empty cells, so the rows merge */
+    for (int i = 0; i < GAME_2048_SIZE * GAME_2048_SIZE; i++) {
+        uint32_t r = test_rand();
+        int exponent = ((r & 3) == 0) ? 0 : (int)((r >> 2) % 5);
+        if ((r >> 8) % 64 == 0) {
+            exponent = GAME_2048_EXPONENT_MAX;
+        }
+        board |= (game_2048_board_t)exponent << (4 * i);
+    }
+    return board;
+}
+
+/* Add a tile like the game: 2 at 90 %, 4 at 10 % */
+static game_2048_board_t add_tile(game_2048_board_t board)
+{
+    int empty_num = game_2048_board_count_empty(board);
+    if (empty_num == 0) {
+        return board;
+    }
+
+    int target = (int)(test_rand() % empty_num);
+    int exponent = (test_rand() % 10 == 0) ? 2 : 1;
+    for (int i = 0; i < GAME_2048_SIZE * GAME_2048_SIZE; i++) {
+        if (((board >> (4 * i)) & 0xf) == 0) {
+            if (target-- == 0) {
+                return board | ((game_2048_board_t)exponent << (4 * i));
+            }
+        }
+    }
+    return board;
+}
+
+/* The move of a grid by loops over its cells, the reference of the tables */
+static int grid_move(test_grid_t grid, game_2048_dir_t dir)
+{
+    int score = 0;
+
+    for (int line = 0; line < GAME_2048_SIZE; line++) {
+        int *cells[GAME_2048_SIZE];
+        for (int i = 0; i < GAME_2048_SIZE; i++) {
+            switch (dir) {
+            case GAME_2048_DIR_LEFT:
+                cells[i] = &grid[line][i];
+                break;
+            case GAME_2048_DIR_RIGHT:
+                cells[i] = &grid[line][GAME_2048_SIZE - 1 - i];
+                break;
+            case GAME_2048_DIR_UP:
+                cells[i] = &grid[i][line];
+                break;
+            default:
+                cells[i] = &grid[GAME_2048_SIZE - 1 - i][line];
+                break;
+            }
+        }
+
+        int target = 0;
+        bool target_merged = false;
+        for (int i = 0; i < GAME_2048_SIZE; i++) {
+            int value = *cells[i];
+            if (value == 0) {
+                continue;
+            }
+            *cells[i] = 0;
+            if ((target > 0) && (*cells[target - 1] == value) && !target_merged && (value < GAME_2048_EXPONENT_MAX)) {
+                (*cells[target - 1])++;
+                score += 1 << (value + 1);
+                target_merged = true;
+            } else {
+                *cells[target++] = value;
+                target_merged = false;
+            }
+        }
+    }
+    return score;
+}
+
+static bool test_moves(void)
+{
+    test_grid_t grid;
+    test_grid_t moved;
+
+    TEST_CHECK(game_2048_board_init() == GAME_2048_OK, "Build tables failed");
+    for (int n = 0; n < TEST_BOARD_NUM; n++) {
+        game_2048_board_t board = random_board();
+        game_2048_board_unpack(board, grid);
+        TEST_CHECK(game_2048_board_pack((const int (*)[GAME_2048_SIZE])grid) == board, "Pack isn't unpack");
+
+        game_2048_board_t transposed = game_2048_board_transpose(board);
+        for (int i = 0; i < GAME_2048_SIZE * GAME_2048_SIZE; i++) {
+            TEST_CHECK(game_2048_board_get(transposed, i % 4, i / 4) == grid[i / 4][i % 4], "Transpose is wrong");
+        }
+
+        int empty_num = 0;
+        for (int i = 0; i < GAME_2048_SIZE * GAME_2048_SIZE; i++) {
+            empty_num += (grid[i / 4][i % 4] == 0);
+        }
+        TEST_CHECK(game_2048_board_count_empty(board) == empty_num, "%d empty cells instead of %d",
+                   game_2048_board_count_empty(board), empty_num);
+
+        bool can_move = false;
+        for (int dir = 0; dir < GAME_2048_DIR_NUM; dir++) {
+            uint32_t score = 0;
+            memcpy(moved, grid, sizeof(grid));
+            int grid_score = grid_move(moved, (game_2048_dir_t)dir);
+            game_2048_board_t next = game_2048_board_move(board, (game_2048_dir_t)dir, &score);
+            TEST_CHECK(next == game_2048_board_pack((const int (*)[GAME_2048_SIZE])moved),
+                       "Board %016llx moved %d: %016llx", (unsigned long long)board, dir, (unsigned long long)next);
+            TEST_CHECK(score == (uint32_t)grid_score, "Board %016llx moved %d: score %u instead of %d",
+                       (unsigned long long)board, dir, (unsigned)score, grid_score);
+            can_move |= (next != board);
+        }
+        TEST_CHECK(game_2048_board_can_move(board) == can_move, "Board %016llx can move", (unsigned long long)board);
+    }
+
+    /* A full board of alternating tiles is over */
+    game_2048_board_t over = 0;
+    for (int i = 0; i < GAME_2048_SIZE * GAME_2048_SIZE; i++) {
+        over = game_2048_board_set(over, i / 4, i % 4, 1 + ((i / 4 + i % 4) % 2));
+    }
+    TEST_CHECK(!game_2048_board_can_move(over), "Board over can move");
+    TEST_CHECK(game_2048_board_max_exponent(game_2048_board_set(over, 3, 3, 11)) == 11, "Max exponent is wrong");
+
+    return true;
+}
+
+static bool test_move_bench(void)
+{
+    static game_2048_board_t boards[1024];
+    test_grid_t grid;
+    uint64_t checksum = 0;
+    int grid_checksum = 0;
+
+    for (int i = 0; i < 1024; i++) {
+        boards[i] = random_board();
+    }
+
+    int64_t start_us = now_us();
+    for (int n = 0; n < TEST_BENCH_MOVE_NUM; n++) {
+        uint32_t score = 0;
+        checksum += game_2048_board_move(boards[n & 1023], (game_2048_dir_t)(n & 3), &score) + score;
+    }
+    int64_t table_us = now_us() - start_us;
+
+    start_us = now_us();
+    for (int n = 0; n < TEST_BENCH_MOVE_NUM; n++) {
+        game_2048_board_unpack(boards[n & 1023], grid);
+        grid_checksum += grid_move(grid, (game_2048_dir_t)(n & 3)) + grid[0][0];
+    }
+    int64_t grid_us = now_us() - start_us;
+
+    double table_rate = TEST_BENCH_MOVE_NUM / (table_us / 1e6);
+    double grid_rate = TEST_BENCH_MOVE_NUM / (grid_us / 1e6);
+    printf("move_bench: tables %.1f M moves/s, grid %.1f M moves/s, x%.1f (%llx %x)\n", table_rate / 1e6,
+           grid_rate / 1e6, table_rate / grid_rate, (unsigned long long)(checksum & 0xff), grid_checksum & 0xff);
+    TEST_CHECK(table_rate > 2 * grid_rate, "Tables aren't faster than the grid");
+
+    return true;
+}
+
+/* Play a seeded game with the solver, and keep some boards of its middle */
+static bool play(game_2048_solver_t *solver, int move_max, game_2048_board_t *boards, int board_num, int *move_num,
+                 game_2048_board_t *last)
+{
+    game_2048_board_t board = add_tile(add_tile(0));
+    game_2048_hint_t hint;
+
+    *move_num = 0;
+    while ((*move_num < move_max) && game_2048_board_can_move(board)) {
+        TEST_CHECK(game_2048_solver_search(solver, board, &hint) == GAME_2048_OK, "Search failed");
+        TEST_CHECK(hint.dir != GAME_2048_DIR_NONE, "No move for %016llx", (unsigned long long)board);
+        game_2048_board_t next = game_2048_board_move(board, hint.dir, NULL);
+        TEST_CHECK(next != board, "Hint %d doesn't move %016llx", hint.dir, (unsigned long long)board);
+        if ((boards != NULL) && (*move_num % 100 == 50) && (*move_num / 100 < board_num)) {
+            boards[*move_num / 100] = board;
+        }
+        board = add_tile(next);
+        (*move_num)++;
+    }
+    *last = board;
+
+    return true;
+}
+
+static bool test_auto_play(void)
+{
+    game_2048_solver_config_t config = GAME_2048_SOLVER_DEFAULT_CONFIG();
+    game_2048_board_t last = 0;
+    int move_num = 0;
+
+    /* The depth limits the searches, not the time, so the game is the same on every host */
+    config.depth_max = 2;
+    config.time_budget_ms = 10000;
+    game_2048_solver_t *solver = game_2048_solver_new(&config);
+    TEST_CHECK(solver != NULL, "Create solver failed");
+    rand_state = 0x2048;
+    int64_t start_us = now_us();
+    bool ok = play(solver, 3000, NULL, 0, &move_num, &last);
+    int64_t time_us = now_us() - start_us;
+    game_2048_solver_del(solver);
+    TEST_CHECK(ok, "Play failed");
+
+    int max_exponent = game_2048_board_max_exponent(last);
+    printf("auto_play: depth 2, %d moves, max tile %d, %.1f us/move\n", move_num, 1 << max_exponent,
+           (double)time_us / move_num);
+    TEST_CHECK(max_exponent >= 11, "Max tile %d", 1 << max_exponent);
+
+    return true;
+}
+
+static bool test_solver_depth(void)
+{
+    static const uint32_t budgets_ms[] = {20, 100, 500};
+    game_2048_solver_config_t config = GAME_2048_SOLVER_DEFAULT_CONFIG();
+    game_2048_board_t boards[4] = {};
+    game_2048_board_t last = 0;
+    int move_num = 0;
+
+    config.depth_max = 2;
+    game_2048_solver_t *solver = game_2048_solver_new(&config);
+    TEST_CHECK(solver != NULL, "Create solver failed");
+    rand_state = 0x4096;
+    TEST_CHECK(play(solver, 400, boards, 4, &move_num, &last), "Play failed");
+    game_2048_solver_del(solver);
+    TEST_CHECK(boards[3] != 0, "Game is over after %d moves", move_num);
+
+    printf("solver_depth: budget, mean depth, max depth, mean time, nodes/s\n");
+    int prev_depth_sum = 0;
+    for (size_t b = 0; b < sizeof(budgets_ms) / sizeof(budgets_ms[0]); b++) {
+        config = (game_2048_solver_config_t)GAME_2048_SOLVER_DEFAULT_CONFIG();
+        config.time_budget_ms = budgets_ms[b];
+        config.depth_max = 16;
+        solver = game_2048_solver_new(&config);
+        TEST_CHECK(solver != NULL, "Create solver failed");
+
+        int depth_sum = 0;
+        int depth_max = 0;
+        uint64_t node_sum = 0;
+        uint32_t time_sum = 0;
+        for (int i = 0; i < 4; i++) {
+            game_2048_hint_t hint;
+            TEST_CHECK(game_2048_solver_search(solver, boards[i], &hint) == GAME_2048_OK, "Search failed");
+            TEST_CHECK(hint.dir != GAME_2048_DIR_NONE, "No move");
+            TEST_CHECK(hint.time_ms <= budgets_ms[b] * 3 / 2 + 20, "Search of %u ms for a budget of %u ms",
+                       (unsigned)hint.time_ms, (unsigned)budgets_ms[b]);
+            depth_sum += hint.depth;
+            depth_max = (hint.depth > depth_max) ? hint.depth : depth_max;
+            node_sum += hint.node_num;
+            time_sum += hint.time_ms;
+        }
+        game_2048_solver_del(solver);
+        printf("  %4u ms  %.2f  %d  %5.1f ms  %.2f M\n", (unsigned)budgets_ms[b], depth_sum / 4.0, depth_max,
+               time_sum / 4.0, time_sum ? node_sum / (time_sum / 1000.0) / 1e6 : 0);
+        TEST_CHECK(depth_sum >= prev_depth_sum, "Depth falls with a longer budget");
+        TEST_CHECK(depth_sum >= 4 * 2, "Depth below 2 for %u ms", (unsigned)budgets_ms[b]);
+        prev_depth_sum = depth_sum;
+    }
+
+    return true;
+}
+
+/* The same searches with and without the transposition table */
+static bool test_transposition(void)
+{
+    game_2048_solver_config_t config = GAME_2048_SOLVER_DEFAULT_CONFIG();
+    game_2048_hint_t hints[2];
+    game_2048_board_t board = 0;
+
+    config.time_budget_ms = 60000;
+    config.depth_max = 5;
+    rand_state = 0x8192;
+    board = add_tile(add_tile(add_tile(add_tile(add_tile(0)))));
+    for (int i = 0; i < 2; i++) {
+        config.tt_bits = (i == 0) ? 16 : 0;
+        game_2048_solver_t *solver = game_2048_solver_new(&config);
+        TEST_CHECK(solver != NULL, "Create solver failed");
+        TEST_CHECK(game_2048_solver_search(solver, board, &hints[i]) == GAME_2048_OK, "Search failed");
+        game_2048_solver_del(solver);
+        TEST_CHECK(hints[i].depth == 5, "Depth %d", hints[i].depth);
+    }
+    printf("transposition: depth 5, with table %u nodes %u hits %u ms, without %u nodes %u ms\n",
+           (unsigned)hints[0].node_num, (unsigned)hints[0].tt_hit_num, (unsigned)hints[0].time_ms,
+           (unsigned)hints[1].node_num, (unsigned)hints[1].time_ms);
+    TEST_CHECK(hints[0].tt_hit_num > 0, "No hit");
+    TEST_CHECK(hints[1].tt_hit_num == 0, "Hit without table");
+    TEST_CHECK(hints[0].node_num * 2 < hints[1].node_num, "Table saves less than half of the nodes");
+    TEST_CHECK(hints[0].dir == hints[1].dir, "Table changes the move");
+
+    return true;
+}
+
+static bool wait_hint(game_2048_solver_t *solver, game_2048_hint_t *hint)
+{
+    for (int i = 0; i < TEST_HINT_WAIT_MS / 10; i++) {
+        if (game_2048_solver_get_hint(solver, hint)) {
+            return true;
+        }
+        sleep_ms(10);
+    }
+    return false;
+}
+
+/* The worker searches the last request, like the hints of the UI polled by a timer */
+static bool test_async(void)
+{
+    game_2048_solver_config_t config = GAME_2048_SOLVER_DEFAULT_CONFIG();
+    game_2048_hint_t hint;
+
+    config.time_budget_ms = 100;
+    game_2048_solver_t *solver = game_2048_solver_new(&config);
+    TEST_CHECK(solver != NULL, "Create solver failed");
+
+    rand_state = 0x1024;
+    game_2048_board_t first = add_tile(add_tile(0));
+    game_2048_board_t second = add_tile(first);
+    TEST_CHECK(!game_2048_solver_get_hint(solver, &hint), "Hint without request");
+    TEST_CHECK(game_2048_solver_request(solver, first) == GAME_2048_OK, "Request failed");
+    TEST_CHECK(wait_hint(solver, &hint) && (hint.board == first), "No hint of the first board");
+    TEST_CHECK(hint.dir != GAME_2048_DIR_NONE, "No move");
+
+    /* A new request replaces the running one */
+    game_2048_solver_request(solver, first);
+    game_2048_solver_request(solver, second);
+    TEST_CHECK(wait_hint(solver, &hint) && (hint.board == second), "Hint isn't the one of the last request");
+
+    game_2048_solver_request(solver, first);
+    game_2048_solver_cancel(solver);
+    sleep_ms(config.time_budget_ms * 2);
+    TEST_CHECK(!game_2048_solver_get_hint(solver, &hint), "Hint of a cancelled request");
+
+    /* Deleting stops a running search */
+    game_2048_solver_request(solver, second);
+    int64_t start_us = now_us();
+    game_2048_solver_del(solver);
+    TEST_CHECK(now_us() - start_us < config.time_budget_ms * 1000 + 50000, "Delete waits for the search");
+
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"moves", test_moves},
+        {"move_bench", test_move_bench},
+        {"auto_play", test_auto_play},
+        {"solver_depth", test_solver_depth},
+        {"transposition", test_transposition},
+        {"async", test_async},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Settings store: a typed key-value cache in RAM in front of a persistent backend (NVS on the target, see
+ * `settings_store_nvs.h`). The values are read from the backend once, the changes are written behind: a worker thread
+ * writes all the changed values in one batch when no value has changed for `debounce_ms`, so dragging a slider costs
+ * one write instead of one per event. `settings_store_flush()` writes them at once, e.g. when an app is paused.
+ *
+ * It only uses pthreads, so it's built and tested on the host too with the backend in RAM of `settings_store_mem.h`
+ * (see `test_apps/host_test`).
+ */
+
+#define SETTINGS_STORE_KEY_LEN_MAX          (15)    /*!< The limit of NVS */
+#define SETTINGS_STORE_ENTRY_MAX            (32)
+#define SETTINGS_STORE_STR_LEN_MAX          (256)
+#define SETTINGS_STORE_SUBSCRIBER_MAX       (8)
+
+#define SETTINGS_STORE_OK                   (0)
+#define SETTINGS_STORE_ERR_INVALID          (-1)    /*!< Invalid argument, too many keys or a key of another type */
+#define SETTINGS_STORE_ERR_NOT_FOUND        (-2)    /*!< Returned by the backend only */
+#define SETTINGS_STORE_ERR_BACKEND          (-3)
+#define SETTINGS_STORE_ERR_NO_MEM           (-4)
+
+typedef enum {
+    SETTINGS_STORE_TYPE_I32 = 0,
+    SETTINGS_STORE_TYPE_STR,
+} settings_store_type_t;
+
+/**
+ * The persistent storage. Its functions are called by one thread at a time.
+ */
+typedef struct {
+    /**
+     * Read a value. For a string, `value` is a buffer of `*len` bytes and `*len` is set to the length of the string
+     * with its terminator. Returns `SETTINGS_STORE_ERR_NOT_FOUND` if the key was never written.
+     */
+    int (*get)(void *ctx, const char *key, settings_store_type_t type, void *value, size_t *len);
+    /**
+     * Write a value, it may be kept until `commit()`. `len` is the length of a string with its terminator.
+     */
+    int (*set)(void *ctx, const char *key, settings_store_type_t type, const void *value, size_t len);
+    /**
+     * Make the writes since the last commit persistent. Called once per batch.
+     */
+    int (*commit)(void *ctx);
+    void *ctx;
+} settings_store_backend_t;
+
+typedef struct {
+    const settings_store_backend_t *backend;    /*!< The backend, it's kept */
+    uint32_t debounce_ms;       /*!< The changes are written when no value has changed for this time. 0: each change
+                                     is written and committed at once, without the worker */
+    uint32_t max_delay_ms;      /*!< A change is written at most this time after it, even if the values keep changing */
+    uint32_t stack_size;        /*!< Stack of the worker, bytes. Only used on the target, the host uses the default */
+    uint8_t priority;           /*!< Priority of the worker. Only used on the target */
+} settings_store_config_t;
+
+#define SETTINGS_STORE_DEFAULT_CONFIG()     \
+    {                                       \
+        .backend = NULL,                    \
+        .debounce_ms = 500,                 \
+        .max_delay_ms = 5000,               \
+        .stack_size = 4 * 1024,             \
+        .priority = 2,                      \
+    }
+
+typedef struct {
+    uint32_t change_num;        /*!< Calls of the setters which changed a value */
+    uint32_t read_num;          /*!< Reads of the backend, once per key */
+    uint32_t write_num;         /*!< Writes of the backend */
+    uint32_t commit_num;        /*!< Commits of the backend, one per batch */
+    uint32_t error_num;         /*!< Failed writes or commits, their values are written again in the next batch */
+} settings_store_stats_t;
+
+/**
+ * @brief Called after a value has changed, in the thread which changed it.
+ *
+ * @param key The key which changed
+ * @param user_data The user data of `settings_store_subscribe()`
+ */
+typedef void (*settings_store_cb_t)(const char *key, void *user_data);
+
+typedef struct settings_store_t settings_store_t;
+
+/**
+ * @brief Create a store and start its worker.
+ *
+ * @param config The configuration, its backend is required
+ *
+ * @return The store, NULL if the configuration is invalid or out of memory
+ */
+settings_store_t *settings_store_new(const settings_store_config_t *config);
+
+/**
+ * @brief Write the pending changes, stop the worker and delete a store.
+ *
+ * @param store The store, can be NULL
+ */
+void settings_store_del(settings_store_t *store);
+
+/**
+ * @brief Get an integer. It's read from the backend the first time, then from the cache.
+ *
+ * @param store The store
+ * @param key The key
+ * @param value The value, `default_value` if the key was never written
+ * @param default_value The value of a missing key, it's cached but not written
+ *
+ * @return SETTINGS_STORE_OK, or an error if the key has another type or the backend failed
+ */
+int settings_store_get_i32(settings_store_t *store, const char *key, int32_t *value, int32_t default_value);
+
+/**
+ * @brief Set an integer. Only the cache is updated, the value is written later. The subscribers are notified if it
+ *        changed.
+ *
+ * @param store The store
+ * @param key The key
+ * @param value The value
+ *
+ * @return SETTINGS_STORE_OK, or an error if the key is invalid or has another type
+ */
+int settings_store_set_i32(settings_store_t *store, const char *key, int32_t value);
+
+/**
+ * @brief Get a string, like `settings_store_get_i32()`.
+ *
+ * @param store The store
+ * @param key The key
+ * @param value The buffer of the string
+ * @param size The size of the buffer, the string is truncated to fit
+ * @param default_value The value of a missing key, can be NULL for ""
+ *
+ * @return SETTINGS_STORE_OK, or an error if the key has another type or the backend failed
+ */
+int settings_store_get_str(settings_store_t *store, const char *key, char *value, size_t size,
+                           const char *default_value);
+
+/**
+ * @brief Set a string, like `settings_store_set_i32()`.
+ *
+ * @param store The store
+ * @param key The key
+ * @param value The string, at most `SETTINGS_STORE_STR_LEN_MAX` bytes with its terminator
+ *
+ * @return SETTINGS_STORE_OK, or an error if the key or the string is invalid, or out of memory
+ */
+int settings_store_set_str(settings_store_t *store, const char *key, const char *value);
+
+/**
+ * @brief Write the pending changes in one batch and wait for them, e.g. when an app is paused or closed.
+ *
+ * @param store The store
+ *
+ * @return SETTINGS_STORE_OK, SETTINGS_STORE_ERR_BACKEND if a write or the commit failed
+ */
+int settings_store_flush(settings_store_t *store);
+
+/**
+ * @brief Get notified when a value changes.
+ *
+ * @param store The store
+ * @param key The key, NULL for all the keys. The string is kept
+ * @param cb The callback
+ * @param user_data The user data of the callback
+ *
+ * @return The id of the subscription (>= 0), SETTINGS_STORE_ERR_INVALID if there are too many
+ */
+int settings_store_subscribe(settings_store_t *store, const char *key, settings_store_cb_t cb, void *user_data);
+
+/**
+ * @brief Cancel a subscription. The callback may still be running in another thread when it returns.
+ *
+ * @param store The store
+ * @param id The id of `settings_store_subscribe()`
+ *
+ * @return SETTINGS_STORE_OK, SETTINGS_STORE_ERR_INVALID if the id is unknown
+ */
+int settings_store_unsubscribe(settings_store_t *store, int id);
+
+/**
+ * @brief Get the counters of the store, to measure the write amplification.
+ *
+ * @param store The store
+ * @param stats The counters since the store was created
+ */
+void settings_store_get_stats(settings_store_t *store, settings_store_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "settings_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A backend in RAM which counts its accesses, for the host tests. The committed values are kept apart from the
+ * written ones, so a test can check what would survive a reset. Its functions can be called from any thread.
+ */
+
+typedef struct {
+    uint32_t get_num;
+    uint32_t set_num;
+    uint32_t commit_num;
+} settings_store_mem_stats_t;
+
+typedef struct settings_store_mem_t settings_store_mem_t;
+
+/**
+ * @brief Create a backend in RAM.
+ *
+ * @return The backend, NULL if out of memory
+ */
+settings_store_mem_t *settings_store_mem_new(void);
+
+/**
+ * @brief Delete a backend in RAM. The stores which use it must be deleted before.
+ *
+ * @param mem The backend, can be NULL
+ */
+void settings_store_mem_del(settings_store_mem_t *mem);
+
+/**
+ * @brief Get the functions of the backend to create a store.
+ *
+ * @param mem The backend
+ *
+ * @return The functions, they are a part of the backend
+ */
+const settings_store_backend_t *settings_store_mem_get_backend(settings_store_mem_t *mem);
+
+/**
+ * @brief Get the counters of the backend.
+ *
+ * @param mem The backend
+ *
+ * @return The counters since the backend was created
+ */
+settings_store_mem_stats_t settings_store_mem_get_stats(settings_store_mem_t *mem);
+
+/**
+ * @brief Make the writes and the commits fail, like a full or broken flash.
+ *
+ * @param mem The backend
+ * @param fail true to fail
+ */
+void settings_store_mem_set_fail(settings_store_mem_t *mem, bool fail);
+
+/**
+ * @brief Get an integer which was committed.
+ *
+ * @param mem The backend
+ * @param key The key
+ * @param value The value
+ *
+ * @return true if it was committed
+ */
+bool settings_store_mem_get_committed_i32(settings_store_mem_t *mem, const char *key, int32_t *value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "settings_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The NVS backend, and the store of the phone which is shared by the apps.
+ */
+
+#define SETTINGS_STORE_NVS_NAMESPACE        "storage"
+
+/**
+ * @brief Create a backend on a namespace of the default NVS partition, which must be initialized.
+ *
+ * @param name_space The namespace
+ *
+ * @return The backend, NULL if the namespace can't be opened or out of memory
+ */
+const settings_store_backend_t *settings_store_nvs_new(const char *name_space);
+
+/**
+ * @brief Delete a backend of `settings_store_nvs_new()`. The stores which use it must be deleted before.
+ *
+ * @param backend The backend, can be NULL
+ */
+void settings_store_nvs_del(const settings_store_backend_t *backend);
+
+/**
+ * @brief Get the store of the phone, on `SETTINGS_STORE_NVS_NAMESPACE` with the default configuration. It's created
+ *        by the first call, which must be after `nvs_flash_init()`, and never deleted.
+ *
+ * @return The store, NULL if it can't be created
+ */
+settings_store_t *settings_store_get_default(void);
+
+#ifdef __cplusplus
+}
+#endif
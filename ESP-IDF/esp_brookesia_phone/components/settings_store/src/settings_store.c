@@ -0,0 +1,579 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "settings_store.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#define SETTINGS_STORE_LOGE(format, ...)    ESP_LOGE(TAG, format, ##__VA_ARGS__)
+/* The timed waits of the pthread condition variables use the wall clock */
+#define SETTINGS_STORE_COND_CLOCK           CLOCK_REALTIME
+#else
+#define SETTINGS_STORE_LOGE(format, ...)    fprintf(stderr, "[%s] " format "\n", TAG, ##__VA_ARGS__)
+#define SETTINGS_STORE_COND_CLOCK           CLOCK_MONOTONIC
+#endif
+
+typedef struct {
+    char key[SETTINGS_STORE_KEY_LEN_MAX + 1];
+    settings_store_type_t type;
+    int32_t i32;
+    char *str;
+    /* False for a key added by a setter, until the value is set */
+    bool has_value;
+    /* The entry is written when they differ */
+    uint32_t version;
+    uint32_t written_version;
+} settings_store_entry_t;
+
+/* A copy of a changed entry, written without the lock of the store */
+typedef struct {
+    settings_store_entry_t *entry;
+    int32_t i32;
+    char *str;
+    uint32_t version;
+} settings_store_write_t;
+
+typedef struct {
+    const char *key;
+    settings_store_cb_t cb;
+    void *user_data;
+} settings_store_subscriber_t;
+
+struct settings_store_t {
+    settings_store_config_t config;
+    /* Guards the cache, the subscribers and the counters */
+    pthread_mutex_t lock;
+    /* Taken before `lock` by whoever uses the backend, so one batch or read runs at a time */
+    pthread_mutex_t backend_lock;
+    pthread_cond_t cond;
+    pthread_t worker;
+    bool has_worker;
+    bool exit;
+    settings_store_entry_t entries[SETTINGS_STORE_ENTRY_MAX];
+    uint8_t entry_num;
+    /* Some entries are to be written, since `first_change_ms` and until `last_change_ms` */
+    bool pending;
+    int64_t first_change_ms;
+    int64_t last_change_ms;
+    settings_store_subscriber_t subscribers[SETTINGS_STORE_SUBSCRIBER_MAX];
+    settings_store_stats_t stats;
+};
+
+static const char *TAG = "settings_store";
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void cond_wait_ms(settings_store_t *store, int64_t wait_ms)
+{
+    struct timespec ts;
+    clock_gettime(SETTINGS_STORE_COND_CLOCK, &ts);
+    ts.tv_sec += wait_ms / 1000;
+    ts.tv_nsec += (long)(wait_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&store->cond, &store->lock, &ts);
+}
+
+static bool check_key(const char *key)
+{
+    return (key != NULL) && (key[0] != '\0') && (strlen(key) <= SETTINGS_STORE_KEY_LEN_MAX);
+}
+
+static settings_store_entry_t *find_entry(settings_store_t *store, const char *key)
+{
+    for (int i = 0; i < store->entry_num; i++) {
+        if (strcmp(store->entries[i].key, key) == 0) {
+            return &store->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static settings_store_entry_t *add_entry(settings_store_t *store, const char *key, settings_store_type_t type)
+{
+    if (store->entry_num >= SETTINGS_STORE_ENTRY_MAX) {
+        SETTINGS_STORE_LOGE("Too many keys, %s isn't added", key);
+        return NULL;
+    }
+
+    settings_store_entry_t *entry = &store->entries[store->entry_num++];
+    strcpy(entry->key, key);
+    entry->type = type;
+
+    return entry;
+}
+
+/* Write all the changed entries and commit them once */
+static int write_batch(settings_store_t *store)
+{
+    const settings_store_backend_t *backend = store->config.backend;
+    settings_store_write_t writes[SETTINGS_STORE_ENTRY_MAX];
+    int write_num = 0;
+    int ret = SETTINGS_STORE_OK;
+
+    pthread_mutex_lock(&store->backend_lock);
+
+    pthread_mutex_lock(&store->lock);
+    for (int i = 0; i < store->entry_num; i++) {
+        settings_store_entry_t *entry = &store->entries[i];
+        if (entry->version == entry->written_version) {
+            continue;
+        }
+        settings_store_write_t *write = &writes[write_num];
+        write->entry = entry;
+        write->i32 = entry->i32;
+        write->str = (entry->type == SETTINGS_STORE_TYPE_STR) ? strdup(entry->str) : NULL;
+        write->version = entry->version;
+        if ((entry->type == SETTINGS_STORE_TYPE_STR) && (write->str == NULL)) {
+            ret = SETTINGS_STORE_ERR_NO_MEM;
+            continue;
+        }
+        write_num++;
+    }
+    /* The changes from now on start a new batch */
+    store->pending = false;
+    pthread_mutex_unlock(&store->lock);
+
+    int write_ok_num = 0;
+    for (int i = 0; i < write_num; i++) {
+        settings_store_write_t *write = &writes[i];
+        int err = (write->str != NULL) ?
+                  backend->set(backend->ctx, write->entry->key, SETTINGS_STORE_TYPE_STR, write->str, strlen(write->str) + 1) :
+                  backend->set(backend->ctx, write->entry->key, SETTINGS_STORE_TYPE_I32, &write->i32, sizeof(int32_t));
+        if (err != SETTINGS_STORE_OK) {
+            SETTINGS_STORE_LOGE("Write %s failed(%d)", write->entry->key, err);
+            ret = SETTINGS_STORE_ERR_BACKEND;
+            continue;
+        }
+        write_ok_num++;
+    }
+    if ((write_num > 0) && (ret == SETTINGS_STORE_OK) && (backend->commit(backend->ctx) != SETTINGS_STORE_OK)) {
+        SETTINGS_STORE_LOGE("Commit failed");
+        ret = SETTINGS_STORE_ERR_BACKEND;
+    }
+
+    pthread_mutex_lock(&store->lock);
+    store->stats.write_num += write_ok_num;
+    if (write_num > 0) {
+        store->stats.commit_num += (ret == SETTINGS_STORE_OK);
+    }
+    if (ret == SETTINGS_STORE_OK) {
+        /* An entry changed during the batch stays changed */
+        for (int i = 0; i < write_num; i++) {
+            writes[i].entry->written_version = writes[i].version;
+        }
+    } else {
+        /* Tried again after the debounce */
+        store->stats.error_num++;
+        if (!store->pending) {
+            store->pending = true;
+            store->first_change_ms = now_ms();
+        }
+        store->last_change_ms = now_ms();
+        pthread_cond_signal(&store->cond);
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    pthread_mutex_unlock(&store->backend_lock);
+
+    for (int i = 0; i < write_num; i++) {
+        free(writes[i].str);
+    }
+
+    return ret;
+}
+
+static void *worker_main(void *arg)
+{
+    settings_store_t *store = arg;
+
+    pthread_mutex_lock(&store->lock);
+    while (!store->exit) {
+        if (!store->pending) {
+            pthread_cond_wait(&store->cond, &store->lock);
+            continue;
+        }
+
+        int64_t deadline_ms = store->last_change_ms + store->config.debounce_ms;
+        int64_t max_deadline_ms = store->first_change_ms + store->config.max_delay_ms;
+        if (max_deadline_ms < deadline_ms) {
+            deadline_ms = max_deadline_ms;
+        }
+        int64_t wait_ms = deadline_ms - now_ms();
+        if (wait_ms > 0) {
+            cond_wait_ms(store, wait_ms);
+            continue;
+        }
+
+        pthread_mutex_unlock(&store->lock);
+        write_batch(store);
+        pthread_mutex_lock(&store->lock);
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    return NULL;
+}
+
+static bool start_worker(settings_store_t *store)
+{
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t prev_cfg;
+    bool has_prev_cfg = (esp_pthread_get_cfg(&prev_cfg) == ESP_OK);
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = store->config.stack_size;
+    cfg.prio = store->config.priority;
+    cfg.thread_name = "settings";
+    cfg.pin_to_core = tskNO_AFFINITY;
+    esp_pthread_set_cfg(&cfg);
+#endif
+
+    store->has_worker = (pthread_create(&store->worker, NULL, worker_main, store) == 0);
+
+#ifdef ESP_PLATFORM
+    if (has_prev_cfg) {
+        esp_pthread_set_cfg(&prev_cfg);
+    } else {
+        esp_pthread_cfg_t restore_cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&restore_cfg);
+    }
+#endif
+
+    return store->has_worker;
+}
+
+settings_store_t *settings_store_new(const settings_store_config_t *config)
+{
+    if ((config == NULL) || (config->backend == NULL) || (config->backend->get == NULL) ||
+            (config->backend->set == NULL) || (config->backend->commit == NULL)) {
+        return NULL;
+    }
+
+    settings_store_t *store = calloc(1, sizeof(settings_store_t));
+    if (store == NULL) {
+        return NULL;
+    }
+    store->config = *config;
+    if (store->config.max_delay_ms < store->config.debounce_ms) {
+        store->config.max_delay_ms = store->config.debounce_ms;
+    }
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+#ifndef ESP_PLATFORM
+    pthread_condattr_setclock(&cond_attr, SETTINGS_STORE_COND_CLOCK);
+#endif
+    bool lock_ok = (pthread_mutex_init(&store->lock, NULL) == 0);
+    bool backend_lock_ok = (pthread_mutex_init(&store->backend_lock, NULL) == 0);
+    bool cond_ok = (pthread_cond_init(&store->cond, &cond_attr) == 0);
+    pthread_condattr_destroy(&cond_attr);
+    if (!lock_ok || !backend_lock_ok || !cond_ok || ((config->debounce_ms > 0) && !start_worker(store))) {
+        SETTINGS_STORE_LOGE("Create store failed");
+        if (cond_ok) {
+            pthread_cond_destroy(&store->cond);
+        }
+        if (backend_lock_ok) {
+            pthread_mutex_destroy(&store->backend_lock);
+        }
+        if (lock_ok) {
+            pthread_mutex_destroy(&store->lock);
+        }
+        free(store);
+        return NULL;
+    }
+
+    return store;
+}
+
+void settings_store_del(settings_store_t *store)
+{
+    if (store == NULL) {
+        return;
+    }
+
+    if (store->has_worker) {
+        pthread_mutex_lock(&store->lock);
+        store->exit = true;
+        pthread_cond_signal(&store->cond);
+        pthread_mutex_unlock(&store->lock);
+        pthread_join(store->worker, NULL);
+    }
+    write_batch(store);
+
+    for (int i = 0; i < store->entry_num; i++) {
+        free(store->entries[i].str);
+    }
+    pthread_cond_destroy(&store->cond);
+    pthread_mutex_destroy(&store->backend_lock);
+    pthread_mutex_destroy(&store->lock);
+    free(store);
+}
+
+/* Read a key which isn't cached from the backend, the lock of the store isn't held */
+static int load_entry(settings_store_t *store, const char *key, settings_store_type_t type, const void *default_value)
+{
+    const settings_store_backend_t *backend = store->config.backend;
+    int32_t i32 = 0;
+    char *str = NULL;
+    size_t len = 0;
+    int err = SETTINGS_STORE_OK;
+
+    if (type == SETTINGS_STORE_TYPE_STR) {
+        str = malloc(SETTINGS_STORE_STR_LEN_MAX);
+        if (str == NULL) {
+            return SETTINGS_STORE_ERR_NO_MEM;
+        }
+    }
+
+    pthread_mutex_lock(&store->backend_lock);
+    if (type == SETTINGS_STORE_TYPE_STR) {
+        len = SETTINGS_STORE_STR_LEN_MAX;
+        err = backend->get(backend->ctx, key, type, str, &len);
+        if ((err == SETTINGS_STORE_OK) && ((len == 0) || (str[len - 1] != '\0'))) {
+            err = SETTINGS_STORE_ERR_BACKEND;
+        }
+    } else {
+        len = sizeof(int32_t);
+        err = backend->get(backend->ctx, key, type, &i32, &len);
+    }
+    if (err == SETTINGS_STORE_ERR_NOT_FOUND) {
+        if (type == SETTINGS_STORE_TYPE_STR) {
+            snprintf(str, SETTINGS_STORE_STR_LEN_MAX, "%s", default_value ? (const char *)default_value : "");
+        } else {
+            i32 = *(const int32_t *)default_value;
+        }
+    } else if (err != SETTINGS_STORE_OK) {
+        pthread_mutex_unlock(&store->backend_lock);
+        SETTINGS_STORE_LOGE("Read %s failed(%d)", key, err);
+        free(str);
+        return SETTINGS_STORE_ERR_BACKEND;
+    }
+
+    pthread_mutex_lock(&store->lock);
+    store->stats.read_num++;
+    int ret = SETTINGS_STORE_OK;
+    /* A setter may have added it meanwhile, its value is newer */
+    if (find_entry(store, key) == NULL) {
+        settings_store_entry_t *entry = add_entry(store, key, type);
+        if (entry != NULL) {
+            entry->i32 = i32;
+            entry->str = str;
+            entry->has_value = true;
+            str = NULL;
+        } else {
+            ret = SETTINGS_STORE_ERR_INVALID;
+        }
+    }
+    pthread_mutex_unlock(&store->lock);
+    pthread_mutex_unlock(&store->backend_lock);
+    free(str);
+
+    return ret;
+}
+
+static int get_value(settings_store_t *store, const char *key, settings_store_type_t type, int32_t *i32, char *str,
+                     size_t size, const void *default_value)
+{
+    if ((store == NULL) || !check_key(key)) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        pthread_mutex_lock(&store->lock);
+        settings_store_entry_t *entry = find_entry(store, key);
+        if (entry != NULL) {
+            int ret = SETTINGS_STORE_OK;
+            if (entry->type != type) {
+                ret = SETTINGS_STORE_ERR_INVALID;
+            } else if (type == SETTINGS_STORE_TYPE_STR) {
+                snprintf(str, size, "%s", entry->str);
+            } else {
+                *i32 = entry->i32;
+            }
+            pthread_mutex_unlock(&store->lock);
+            return ret;
+        }
+        pthread_mutex_unlock(&store->lock);
+
+        int ret = load_entry(store, key, type, default_value);
+        if (ret != SETTINGS_STORE_OK) {
+            return ret;
+        }
+    }
+
+    return SETTINGS_STORE_ERR_INVALID;
+}
+
+static int set_value(settings_store_t *store, const char *key, settings_store_type_t type, int32_t i32,
+                     const char *str)
+{
+    settings_store_subscriber_t notified[SETTINGS_STORE_SUBSCRIBER_MAX];
+    int notified_num = 0;
+    char *new_str = NULL;
+
+    if ((store == NULL) || !check_key(key)) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+
+    pthread_mutex_lock(&store->lock);
+    settings_store_entry_t *entry = find_entry(store, key);
+    if (entry == NULL) {
+        entry = add_entry(store, key, type);
+    }
+    if ((entry == NULL) || (entry->type != type)) {
+        pthread_mutex_unlock(&store->lock);
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+    /* A key which wasn't read is always written, the backend may have another value */
+    if (entry->has_value && ((type == SETTINGS_STORE_TYPE_STR) ? (strcmp(entry->str, str) == 0) : (entry->i32 == i32))) {
+        pthread_mutex_unlock(&store->lock);
+        return SETTINGS_STORE_OK;
+    }
+    if (type == SETTINGS_STORE_TYPE_STR) {
+        new_str = strdup(str);
+        if (new_str == NULL) {
+            pthread_mutex_unlock(&store->lock);
+            return SETTINGS_STORE_ERR_NO_MEM;
+        }
+        free(entry->str);
+        entry->str = new_str;
+    } else {
+        entry->i32 = i32;
+    }
+    entry->has_value = true;
+    entry->version++;
+    store->stats.change_num++;
+
+    int64_t now = now_ms();
+    if (!store->pending) {
+        store->pending = true;
+        store->first_change_ms = now;
+    }
+    store->last_change_ms = now;
+    pthread_cond_signal(&store->cond);
+
+    for (int i = 0; i < SETTINGS_STORE_SUBSCRIBER_MAX; i++) {
+        settings_store_subscriber_t *subscriber = &store->subscribers[i];
+        if ((subscriber->cb != NULL) && ((subscriber->key == NULL) || (strcmp(subscriber->key, key) == 0))) {
+            notified[notified_num++] = *subscriber;
+        }
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    for (int i = 0; i < notified_num; i++) {
+        notified[i].cb(key, notified[i].user_data);
+    }
+
+    if (!store->has_worker) {
+        return write_batch(store);
+    }
+
+    return SETTINGS_STORE_OK;
+}
+
+int settings_store_get_i32(settings_store_t *store, const char *key, int32_t *value, int32_t default_value)
+{
+    if (value == NULL) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+    return get_value(store, key, SETTINGS_STORE_TYPE_I32, value, NULL, 0, &default_value);
+}
+
+int settings_store_set_i32(settings_store_t *store, const char *key, int32_t value)
+{
+    return set_value(store, key, SETTINGS_STORE_TYPE_I32, value, NULL);
+}
+
+int settings_store_get_str(settings_store_t *store, const char *key, char *value, size_t size,
+                           const char *default_value)
+{
+    if ((value == NULL) || (size == 0)) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+    return get_value(store, key, SETTINGS_STORE_TYPE_STR, NULL, value, size, default_value);
+}
+
+int settings_store_set_str(settings_store_t *store, const char *key, const char *value)
+{
+    if ((value == NULL) || (strlen(value) >= SETTINGS_STORE_STR_LEN_MAX)) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+    return set_value(store, key, SETTINGS_STORE_TYPE_STR, 0, value);
+}
+
+int settings_store_flush(settings_store_t *store)
+{
+    if (store == NULL) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+    return write_batch(store);
+}
+
+int settings_store_subscribe(settings_store_t *store, const char *key, settings_store_cb_t cb, void *user_data)
+{
+    if ((store == NULL) || (cb == NULL) || ((key != NULL) && !check_key(key))) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+
+    int id = SETTINGS_STORE_ERR_INVALID;
+    pthread_mutex_lock(&store->lock);
+    for (int i = 0; i < SETTINGS_STORE_SUBSCRIBER_MAX; i++) {
+        if (store->subscribers[i].cb == NULL) {
+            store->subscribers[i] = (settings_store_subscriber_t) {
+                .key = key,
+                .cb = cb,
+                .user_data = user_data,
+            };
+            id = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    return id;
+}
+
+int settings_store_unsubscribe(settings_store_t *store, int id)
+{
+    if ((store == NULL) || (id < 0) || (id >= SETTINGS_STORE_SUBSCRIBER_MAX)) {
+        return SETTINGS_STORE_ERR_INVALID;
+    }
+
+    int ret = SETTINGS_STORE_ERR_INVALID;
+    pthread_mutex_lock(&store->lock);
+    if (store->subscribers[id].cb != NULL) {
+        memset(&store->subscribers[id], 0, sizeof(settings_store_subscriber_t));
+        ret = SETTINGS_STORE_OK;
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    return ret;
+}
+
+void settings_store_get_stats(settings_store_t *store, settings_store_stats_t *stats)
+{
+    if ((store == NULL) || (stats == NULL)) {
+        return;
+    }
+
+    pthread_mutex_lock(&store->lock);
+    *stats = store->stats;
+    pthread_mutex_unlock(&store->lock);
+}
@@ -0,0 +1,177 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings_store_mem.h"
+
+typedef struct {
+    char key[SETTINGS_STORE_KEY_LEN_MAX + 1];
+    settings_store_type_t type;
+    uint8_t value[SETTINGS_STORE_STR_LEN_MAX];
+    size_t len;
+} settings_store_mem_value_t;
+
+typedef struct {
+    settings_store_mem_value_t values[SETTINGS_STORE_ENTRY_MAX];
+    int value_num;
+} settings_store_mem_table_t;
+
+struct settings_store_mem_t {
+    settings_store_backend_t backend;
+    pthread_mutex_t lock;
+    settings_store_mem_stats_t stats;
+    bool fail;
+    settings_store_mem_table_t written;
+    settings_store_mem_table_t committed;
+};
+
+static settings_store_mem_value_t *find_value(settings_store_mem_table_t *table, const char *key)
+{
+    for (int i = 0; i < table->value_num; i++) {
+        if (strcmp(table->values[i].key, key) == 0) {
+            return &table->values[i];
+        }
+    }
+    return NULL;
+}
+
+static int mem_get(void *ctx, const char *key, settings_store_type_t type, void *value, size_t *len)
+{
+    settings_store_mem_t *mem = ctx;
+    int ret = SETTINGS_STORE_OK;
+
+    pthread_mutex_lock(&mem->lock);
+    mem->stats.get_num++;
+    settings_store_mem_value_t *stored = find_value(&mem->written, key);
+    if (stored == NULL) {
+        ret = SETTINGS_STORE_ERR_NOT_FOUND;
+    } else if ((stored->type != type) || (stored->len > *len)) {
+        ret = SETTINGS_STORE_ERR_BACKEND;
+    } else {
+        memcpy(value, stored->value, stored->len);
+        *len = stored->len;
+    }
+    pthread_mutex_unlock(&mem->lock);
+
+    return ret;
+}
+
+static int mem_set(void *ctx, const char *key, settings_store_type_t type, const void *value, size_t len)
+{
+    settings_store_mem_t *mem = ctx;
+    int ret = SETTINGS_STORE_OK;
+
+    pthread_mutex_lock(&mem->lock);
+    settings_store_mem_value_t *stored = find_value(&mem->written, key);
+    if (stored == NULL) {
+        stored = (mem->written.value_num < SETTINGS_STORE_ENTRY_MAX) ? &mem->written.values[mem->written.value_num] :
+                 NULL;
+    }
+    if (mem->fail || (stored == NULL) || (len > SETTINGS_STORE_STR_LEN_MAX)) {
+        ret = SETTINGS_STORE_ERR_BACKEND;
+    } else {
+        if (stored == &mem->written.values[mem->written.value_num]) {
+            strcpy(stored->key, key);
+            mem->written.value_num++;
+        }
+        stored->type = type;
+        memcpy(stored->value, value, len);
+        stored->len = len;
+        mem->stats.set_num++;
+    }
+    pthread_mutex_unlock(&mem->lock);
+
+    return ret;
+}
+
+static int mem_commit(void *ctx)
+{
+    settings_store_mem_t *mem = ctx;
+    int ret = SETTINGS_STORE_OK;
+
+    pthread_mutex_lock(&mem->lock);
+    if (mem->fail) {
+        ret = SETTINGS_STORE_ERR_BACKEND;
+    } else {
+        mem->stats.commit_num++;
+        mem->committed = mem->written;
+    }
+    pthread_mutex_unlock(&mem->lock);
+
+    return ret;
+}
+
+settings_store_mem_t *settings_store_mem_new(void)
+{
+    settings_store_mem_t *mem = calloc(1, sizeof(settings_store_mem_t));
+    if (mem == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&mem->lock, NULL) != 0) {
+        free(mem);
+        return NULL;
+    }
+    mem->backend = (settings_store_backend_t) {
+        .get = mem_get,
+        .set = mem_set,
+        .commit = mem_commit,
+        .ctx = mem,
+    };
+
+    return mem;
+}
+
+void settings_store_mem_del(settings_store_mem_t *mem)
+{
+    if (mem == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&mem->lock);
+    free(mem);
+}
+
+const settings_store_backend_t *settings_store_mem_get_backend(settings_store_mem_t *mem)
+{
+    return mem ? &mem->backend : NULL;
+}
+
+settings_store_mem_stats_t settings_store_mem_get_stats(settings_store_mem_t *mem)
+{
+    settings_store_mem_stats_t stats = {};
+
+    pthread_mutex_lock(&mem->lock);
+    stats = mem->stats;
+    pthread_mutex_unlock(&mem->lock);
+
+    return stats;
+}
+
+void settings_store_mem_set_fail(settings_store_mem_t *mem, bool fail)
+{
+    pthread_mutex_lock(&mem->lock);
+    mem->fail = fail;
+    pthread_mutex_unlock(&mem->lock);
+}
+
+bool settings_store_mem_get_committed_i32(settings_store_mem_t *mem, const char *key, int32_t *value)
+{
+    bool ret = false;
+
+    if ((key == NULL) || (value == NULL)) {
+        return false;
+    }
+    pthread_mutex_lock(&mem->lock);
+    settings_store_mem_value_t *stored = find_value(&mem->committed, key);
+    if ((stored != NULL) && (stored->type == SETTINGS_STORE_TYPE_I32)) {
+        memcpy(value, stored->value, sizeof(int32_t));
+        ret = true;
+    }
+    pthread_mutex_unlock(&mem->lock);
+
+    return ret;
+}
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "settings_store_nvs.h"
+
+typedef struct {
+    settings_store_backend_t backend;
+    nvs_handle_t handle;
+} settings_store_nvs_t;
+
+static const char *TAG = "settings_store_nvs";
+
+static int to_store_err(esp_err_t err)
+{
+    switch (err) {
+    case ESP_OK:
+        return SETTINGS_STORE_OK;
+    case ESP_ERR_NVS_NOT_FOUND:
+        return SETTINGS_STORE_ERR_NOT_FOUND;
+    default:
+        return SETTINGS_STORE_ERR_BACKEND;
+    }
+}
+
+static int nvs_backend_get(void *ctx, const char *key, settings_store_type_t type, void *value, size_t *len)
+{
+    settings_store_nvs_t *nvs = ctx;
+
+    if (type == SETTINGS_STORE_TYPE_STR) {
+        return to_store_err(nvs_get_str(nvs->handle, key, value, len));
+    }
+    return to_store_err(nvs_get_i32(nvs->handle, key, value));
+}
+
+static int nvs_backend_set(void *ctx, const char *key, settings_store_type_t type, const void *value, size_t len)
+{
+    settings_store_nvs_t *nvs = ctx;
+    esp_err_t err = ESP_OK;
+
+    (void)len;
+    if (type == SETTINGS_STORE_TYPE_STR) {
+        err = nvs_set_str(nvs->handle, key, value);
+    } else {
+        err = nvs_set_i32(nvs->handle, key, *(const int32_t *)value);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Set %s failed(%s)", key, esp_err_to_name(err));
+    }
+
+    return to_store_err(err);
+}
+
+static int nvs_backend_commit(void *ctx)
+{
+    settings_store_nvs_t *nvs = ctx;
+
+    return to_store_err(nvs_commit(nvs->handle));
+}
+
+const settings_store_backend_t *settings_store_nvs_new(const char *name_space)
+{
+    settings_store_nvs_t *nvs = calloc(1, sizeof(settings_store_nvs_t));
+    if (nvs == NULL) {
+        return NULL;
+    }
+
+    /* The handle is kept open, the namespace isn't looked up for each access */
+    esp_err_t err = nvs_open(name_space, NVS_READWRITE, &nvs->handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Open %s failed(%s)", name_space, esp_err_to_name(err));
+        free(nvs);
+        return NULL;
+    }
+    nvs->backend = (settings_store_backend_t) {
+        .get = nvs_backend_get,
+        .set = nvs_backend_set,
+        .commit = nvs_backend_commit,
+        .ctx = nvs,
+    };
+
+    return &nvs->backend;
+}
+
+void settings_store_nvs_del(const settings_store_backend_t *backend)
+{
+    if (backend == NULL) {
+        return;
+    }
+
+    settings_store_nvs_t *nvs = backend->ctx;
+    nvs_close(nvs->handle);
+    free(nvs);
+}
+
+static settings_store_t *default_store = NULL;
+
+static void create_default_store(void)
+{
+    settings_store_config_t config = SETTINGS_STORE_DEFAULT_CONFIG();
+
+    config.backend = settings_store_nvs_new(SETTINGS_STORE_NVS_NAMESPACE);
+    if (config.backend == NULL) {
+        return;
+    }
+    default_store = settings_store_new(&config);
+    if (default_store == NULL) {
+        ESP_LOGE(TAG, "Create default store failed");
+        settings_store_nvs_del(config.backend);
+    }
+}
+
+settings_store_t *settings_store_get_default(void)
+{
+    /* The apps which use it are installed by several boot workers */
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+    pthread_once(&once, create_default_store);
+
+    return default_store;
+}
@@ -0,0 +1,354 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * Run the settings store on the backend in RAM, which counts the writes and the commits. The slider drags set a value
+ * every 10 ms like the slider events of the settings app. See README.md.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "settings_store.h"
+#include "settings_store_mem.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+#define TEST_DEBOUNCE_MS        (100)
+#define TEST_DRAG_EVENT_MS      (10)
+#define TEST_DRAG_EVENT_NUM     (50)
+
+typedef struct {
+    settings_store_mem_t *mem;
+    settings_store_t *store;
+} test_env_t;
+
+static void sleep_ms(int ms)
+{
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static bool env_new(test_env_t *env, uint32_t debounce_ms, uint32_t max_delay_ms)
+{
+    settings_store_config_t config = SETTINGS_STORE_DEFAULT_CONFIG();
+
+    env->mem = settings_store_mem_new();
+    TEST_CHECK(env->mem != NULL, "Create backend failed");
+    config.backend = settings_store_mem_get_backend(env->mem);
+    config.debounce_ms = debounce_ms;
+    config.max_delay_ms = max_delay_ms;
+    env->store = settings_store_new(&config);
+    TEST_CHECK(env->store != NULL, "Create store failed");
+
+    return true;
+}
+
+static void env_del(test_env_t *env)
+{
+    settings_store_del(env->store);
+    settings_store_mem_del(env->mem);
+}
+
+/* Drag a slider from 0 to 100, returns the last value */
+static int32_t drag_slider(settings_store_t *store, const char *key, int event_num, int event_ms)
+{
+    int32_t value = 0;
+    for (int i = 1; i <= event_num; i++) {
+        value = i * 100 / event_num;
+        settings_store_set_i32(store, key, value);
+        sleep_ms(event_ms);
+    }
+    return value;
+}
+
+static bool test_cache(void)
+{
+    test_env_t env = {};
+    settings_store_stats_t stats = {};
+    settings_store_mem_stats_t mem_stats = {};
+    int32_t value = 0;
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 1000), "Create failed");
+
+    TEST_CHECK(settings_store_get_i32(env.store, "volume", &value, 70) == SETTINGS_STORE_OK, "Get failed");
+    TEST_CHECK(value == 70, "Missing key isn't the default: %d", (int)value);
+    TEST_CHECK(settings_store_get_i32(env.store, "volume", &value, 0) == SETTINGS_STORE_OK, "Get failed");
+    TEST_CHECK(value == 70, "Default isn't cached: %d", (int)value);
+    mem_stats = settings_store_mem_get_stats(env.mem);
+    TEST_CHECK(mem_stats.get_num == 1, "Key is read %u times", (unsigned)mem_stats.get_num);
+
+    TEST_CHECK(settings_store_set_i32(env.store, "volume", 70) == SETTINGS_STORE_OK, "Set failed");
+    settings_store_get_stats(env.store, &stats);
+    TEST_CHECK(stats.change_num == 0, "Same value is a change");
+    TEST_CHECK(settings_store_set_i32(env.store, "volume", 40) == SETTINGS_STORE_OK, "Set failed");
+    TEST_CHECK(settings_store_get_i32(env.store, "volume", &value, 0) == SETTINGS_STORE_OK && (value == 40),
+               "Set value isn't read back: %d", (int)value);
+    TEST_CHECK(settings_store_mem_get_stats(env.mem).set_num == 0, "Value is written at once");
+
+    /* A key which is set before it's read is written, and read from the cache */
+    TEST_CHECK(settings_store_set_i32(env.store, "brightness", 0) == SETTINGS_STORE_OK, "Set failed");
+    TEST_CHECK(settings_store_get_i32(env.store, "brightness", &value, 50) == SETTINGS_STORE_OK && (value == 0),
+               "Set value isn't read back: %d", (int)value);
+    TEST_CHECK(settings_store_mem_get_stats(env.mem).get_num == 1, "Set key is read");
+    sleep_ms(TEST_DEBOUNCE_MS * 3);
+    mem_stats = settings_store_mem_get_stats(env.mem);
+    TEST_CHECK((mem_stats.set_num == 2) && (mem_stats.commit_num == 1), "%u writes, %u commits",
+               (unsigned)mem_stats.set_num, (unsigned)mem_stats.commit_num);
+
+    env_del(&env);
+
+    /* The values are read from the backend by a new store */
+    settings_store_mem_t *mem = settings_store_mem_new();
+    settings_store_config_t config = SETTINGS_STORE_DEFAULT_CONFIG();
+    config.backend = settings_store_mem_get_backend(mem);
+    settings_store_t *store = settings_store_new(&config);
+    TEST_CHECK(settings_store_set_i32(store, "score", 2048) == SETTINGS_STORE_OK, "Set failed");
+    settings_store_del(store);
+    store = settings_store_new(&config);
+    TEST_CHECK(settings_store_get_i32(store, "score", &value, 0) == SETTINGS_STORE_OK && (value == 2048),
+               "Value isn't persistent: %d", (int)value);
+    settings_store_del(store);
+    settings_store_mem_del(mem);
+
+    return true;
+}
+
+/* The drag of the volume slider: one write after the drag instead of one per event */
+static bool test_slider_drag(void)
+{
+    test_env_t env = {};
+    settings_store_stats_t stats = {};
+    int32_t committed = -1;
+    settings_store_mem_stats_t through_stats = {};
+    settings_store_mem_stats_t mem_stats = {};
+
+    /* Without the debounce, like each event writing and committing */
+    TEST_CHECK(env_new(&env, 0, 0), "Create failed");
+    drag_slider(env.store, "volume", TEST_DRAG_EVENT_NUM, 0);
+    through_stats = settings_store_mem_get_stats(env.mem);
+    env_del(&env);
+    TEST_CHECK((through_stats.set_num == TEST_DRAG_EVENT_NUM) && (through_stats.commit_num == TEST_DRAG_EVENT_NUM),
+               "Write-through: %u writes, %u commits", (unsigned)through_stats.set_num,
+               (unsigned)through_stats.commit_num);
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 2000), "Create failed");
+    int32_t last = drag_slider(env.store, "volume", TEST_DRAG_EVENT_NUM, TEST_DRAG_EVENT_MS);
+    TEST_CHECK(settings_store_mem_get_stats(env.mem).commit_num == 0, "Written during the drag");
+    sleep_ms(TEST_DEBOUNCE_MS * 3);
+    settings_store_get_stats(env.store, &stats);
+    mem_stats = settings_store_mem_get_stats(env.mem);
+    TEST_CHECK((mem_stats.set_num == 1) && (mem_stats.commit_num == 1), "Debounced: %u writes, %u commits",
+               (unsigned)mem_stats.set_num, (unsigned)mem_stats.commit_num);
+    TEST_CHECK(stats.change_num == TEST_DRAG_EVENT_NUM, "%u changes", (unsigned)stats.change_num);
+    TEST_CHECK(settings_store_mem_get_committed_i32(env.mem, "volume", &committed) && (committed == last),
+               "Committed %d instead of %d", (int)committed, (int)last);
+    printf("slider_drag: %d events, write-through: %u writes %u commits, debounced: %u writes %u commits\n",
+           TEST_DRAG_EVENT_NUM, (unsigned)through_stats.set_num, (unsigned)through_stats.commit_num,
+           (unsigned)mem_stats.set_num, (unsigned)mem_stats.commit_num);
+    env_del(&env);
+
+    return true;
+}
+
+/* A drag which never stops is still written every `max_delay_ms` */
+static bool test_max_delay(void)
+{
+    test_env_t env = {};
+    int32_t committed = -1;
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 300), "Create failed");
+    /* About 1 s */
+    drag_slider(env.store, "brightness", 100, TEST_DRAG_EVENT_MS);
+    uint32_t commit_num = settings_store_mem_get_stats(env.mem).commit_num;
+    TEST_CHECK((commit_num >= 2) && (commit_num <= 4), "%u commits during the drag", (unsigned)commit_num);
+    TEST_CHECK(settings_store_mem_get_committed_i32(env.mem, "brightness", &committed) && (committed > 0),
+               "Nothing is committed during the drag");
+    sleep_ms(TEST_DEBOUNCE_MS * 3);
+    TEST_CHECK(settings_store_mem_get_stats(env.mem).commit_num == commit_num + 1, "Last value isn't written");
+    TEST_CHECK(settings_store_mem_get_committed_i32(env.mem, "brightness", &committed) && (committed == 100),
+               "Committed %d instead of 100", (int)committed);
+    env_del(&env);
+
+    return true;
+}
+
+/* The changes of several keys are written in one batch, a flush writes them at once */
+static bool test_batch_and_flush(void)
+{
+    test_env_t env = {};
+    settings_store_mem_stats_t mem_stats = {};
+    int32_t committed = -1;
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 1000), "Create failed");
+    settings_store_set_i32(env.store, "wifi_en", 1);
+    settings_store_set_i32(env.store, "ble_en", 1);
+    settings_store_set_i32(env.store, "volume", 30);
+    settings_store_set_str(env.store, "ssid", "phone");
+    sleep_ms(TEST_DEBOUNCE_MS * 3);
+    mem_stats = settings_store_mem_get_stats(env.mem);
+    TEST_CHECK((mem_stats.set_num == 4) && (mem_stats.commit_num == 1), "Batch: %u writes, %u commits",
+               (unsigned)mem_stats.set_num, (unsigned)mem_stats.commit_num);
+
+    /* Like the pause of an app */
+    settings_store_set_i32(env.store, "volume", 60);
+    TEST_CHECK(settings_store_flush(env.store) == SETTINGS_STORE_OK, "Flush failed");
+    TEST_CHECK(settings_store_mem_get_committed_i32(env.mem, "volume", &committed) && (committed == 60),
+               "Flush doesn't commit");
+    mem_stats = settings_store_mem_get_stats(env.mem);
+    TEST_CHECK((mem_stats.set_num == 5) && (mem_stats.commit_num == 2), "Flush: %u writes, %u commits",
+               (unsigned)mem_stats.set_num, (unsigned)mem_stats.commit_num);
+    sleep_ms(TEST_DEBOUNCE_MS * 3);
+    TEST_CHECK(settings_store_mem_get_stats(env.mem).commit_num == 2, "Flushed value is written again");
+    TEST_CHECK(settings_store_flush(env.store) == SETTINGS_STORE_OK, "Flush failed");
+    TEST_CHECK(settings_store_mem_get_stats(env.mem).commit_num == 2, "Empty flush commits");
+
+    /* Deleting the store writes the pending changes */
+    settings_store_set_i32(env.store, "volume", 80);
+    settings_store_del(env.store);
+    env.store = NULL;
+    TEST_CHECK(settings_store_mem_get_committed_i32(env.mem, "volume", &committed) && (committed == 80),
+               "Delete doesn't write");
+    env_del(&env);
+
+    return true;
+}
+
+typedef struct {
+    int num;
+    char key[SETTINGS_STORE_KEY_LEN_MAX + 1];
+} test_notify_t;
+
+static void on_change(const char *key, void *user_data)
+{
+    test_notify_t *notify = user_data;
+    notify->num++;
+    snprintf(notify->key, sizeof(notify->key), "%s", key);
+}
+
+static bool test_notify(void)
+{
+    test_env_t env = {};
+    test_notify_t volume_notify = {};
+    test_notify_t all_notify = {};
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 1000), "Create failed");
+    int volume_id = settings_store_subscribe(env.store, "volume", on_change, &volume_notify);
+    int all_id = settings_store_subscribe(env.store, NULL, on_change, &all_notify);
+    TEST_CHECK((volume_id >= 0) && (all_id >= 0), "Subscribe failed");
+
+    settings_store_set_i32(env.store, "volume", 10);
+    settings_store_set_i32(env.store, "volume", 10);
+    settings_store_set_i32(env.store, "brightness", 90);
+    TEST_CHECK((volume_notify.num == 1) && (strcmp(volume_notify.key, "volume") == 0), "Key subscriber: %d",
+               volume_notify.num);
+    TEST_CHECK((all_notify.num == 2) && (strcmp(all_notify.key, "brightness") == 0), "All subscriber: %d",
+               all_notify.num);
+
+    TEST_CHECK(settings_store_unsubscribe(env.store, volume_id) == SETTINGS_STORE_OK, "Unsubscribe failed");
+    TEST_CHECK(settings_store_unsubscribe(env.store, volume_id) == SETTINGS_STORE_ERR_INVALID, "Unsubscribed twice");
+    settings_store_set_i32(env.store, "volume", 20);
+    TEST_CHECK((volume_notify.num == 1) && (all_notify.num == 3), "Unsubscribed callback is called");
+    env_del(&env);
+
+    return true;
+}
+
+/* The values of a failed batch are written by the next one */
+static bool test_failure(void)
+{
+    test_env_t env = {};
+    settings_store_stats_t stats = {};
+    int32_t committed = -1;
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 1000), "Create failed");
+    settings_store_mem_set_fail(env.mem, true);
+    settings_store_set_i32(env.store, "volume", 30);
+    TEST_CHECK(settings_store_flush(env.store) == SETTINGS_STORE_ERR_BACKEND, "Failed flush succeeds");
+    TEST_CHECK(!settings_store_mem_get_committed_i32(env.mem, "volume", &committed), "Failed value is committed");
+    settings_store_mem_set_fail(env.mem, false);
+    TEST_CHECK(settings_store_flush(env.store) == SETTINGS_STORE_OK, "Flush failed");
+    TEST_CHECK(settings_store_mem_get_committed_i32(env.mem, "volume", &committed) && (committed == 30),
+               "Failed value isn't written again");
+    settings_store_get_stats(env.store, &stats);
+    TEST_CHECK((stats.error_num == 1) && (stats.commit_num == 1), "%u errors, %u commits", (unsigned)stats.error_num,
+               (unsigned)stats.commit_num);
+    env_del(&env);
+
+    return true;
+}
+
+static bool test_types(void)
+{
+    test_env_t env = {};
+    char str[8] = {};
+    char long_str[SETTINGS_STORE_STR_LEN_MAX + 1] = {};
+    int32_t value = 0;
+
+    TEST_CHECK(env_new(&env, TEST_DEBOUNCE_MS, 1000), "Create failed");
+    TEST_CHECK(settings_store_get_str(env.store, "ssid", str, sizeof(str), "none") == SETTINGS_STORE_OK, "Get failed");
+    TEST_CHECK(strcmp(str, "none") == 0, "Missing string isn't the default: %s", str);
+    TEST_CHECK(settings_store_set_str(env.store, "ssid", "espressif") == SETTINGS_STORE_OK, "Set failed");
+    TEST_CHECK(settings_store_get_str(env.store, "ssid", str, sizeof(str), NULL) == SETTINGS_STORE_OK, "Get failed");
+    TEST_CHECK(strcmp(str, "espress") == 0, "String isn't truncated: %s", str);
+
+    TEST_CHECK(settings_store_get_i32(env.store, "ssid", &value, 0) == SETTINGS_STORE_ERR_INVALID, "Type isn't checked");
+    TEST_CHECK(settings_store_set_i32(env.store, "ssid", 1) == SETTINGS_STORE_ERR_INVALID, "Type isn't checked");
+    TEST_CHECK(settings_store_set_i32(env.store, "a_key_too_long__", 1) == SETTINGS_STORE_ERR_INVALID,
+               "Long key is accepted");
+    TEST_CHECK(settings_store_set_i32(env.store, "", 1) == SETTINGS_STORE_ERR_INVALID, "Empty key is accepted");
+    memset(long_str, 'x', SETTINGS_STORE_STR_LEN_MAX);
+    TEST_CHECK(settings_store_set_str(env.store, "long", long_str) == SETTINGS_STORE_ERR_INVALID,
+               "Long string is accepted");
+
+    char key[SETTINGS_STORE_KEY_LEN_MAX + 1];
+    int added = 1;
+    for (int i = 0; i < SETTINGS_STORE_ENTRY_MAX; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        added += (settings_store_set_i32(env.store, key, i) == SETTINGS_STORE_OK);
+    }
+    TEST_CHECK(added == SETTINGS_STORE_ENTRY_MAX, "%d keys are added", added);
+    env_del(&env);
+
+    TEST_CHECK(settings_store_new(NULL) == NULL, "Store without backend is created");
+
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"cache", test_cache},
+        {"slider_drag", test_slider_drag},
+        {"max_delay", test_max_delay},
+        {"batch_and_flush", test_batch_and_flush},
+        {"notify", test_notify},
+        {"failure", test_failure},
+        {"types", test_types},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,35 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/**
+ * The boot steps of the phone and their dependencies, see `boot_graph_add()`. `main.cpp` runs the step `name` with
+ * `boot_<name>()`, the host test of `boot_graph` runs the same graph with stubs.
+ *
+ * - The I2C bus is shared by the codec, the touch of the display and the camera sensor, it's created once before them.
+ * - The SD card is mounted after SPIFFS, the VFS mounts are registered one at a time.
+ * - The apps are installed in the order of the launcher, `?` only orders them. Each one also requires what it uses,
+ *   so the video player is skipped without an SD card and the camera without a sensor.
+ * - Among the steps which are ready, the first one declared runs first: the ones leading to the UI come first.
+ */
+#define BOOT_STEPS(X)                                                           \
+    X(i2c,              "")                                                     \
+    X(display,          "i2c")                                                  \
+    X(stylesheet,       "display")                                              \
+    X(phone_begin,      "stylesheet")                                           \
+    X(camera_probe,     "i2c")                                                  \
+    X(codec,            "i2c")                                                  \
+    X(nvs,              "")                                                     \
+    X(spiffs,           "")                                                     \
+    X(sdcard,           "spiffs")                                               \
+    X(app_squareline,   "phone_begin")                                          \
+    X(app_calculator,   "phone_begin, ?app_squareline")                         \
+    X(app_music_player, "phone_begin, spiffs, codec, ?app_calculator")          \
+    X(app_settings,     "phone_begin, nvs, codec, ?app_music_player")           \
+    X(app_game_2048,    "phone_begin, nvs, spiffs, codec, ?app_settings")       \
+    X(app_camera,       "phone_begin, camera_probe, ?app_game_2048")            \
+    X(app_image,        "phone_begin, spiffs, ?app_camera")                     \
+    X(app_video_player, "phone_begin, sdcard, ?app_image")
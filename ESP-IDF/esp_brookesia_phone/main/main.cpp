@@ -7,6 +7,7 @@
 #include "esp_check.h"
 #include "esp_memory_utils.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "lvgl.h"
 #include "bsp/esp-bsp.h"
 #include "bsp/display.h"
@@ -15,10 +16,20 @@
 #include "esp_brookesia.hpp"
 #include "app_examples/phone/squareline/src/phone_app_squareline.hpp"
 #include "apps.h"
+#include "boot_graph.h"
+#include "boot_steps.h"
 
 static const char *TAG = "main";
 
-extern "C" void app_main(void)
+// The stylesheet of the panel is constant, so it's kept in flash and isn't copied by the phone
+static const ESP_Brookesia_PhoneStylesheet_t phone_stylesheet = ESP_BROOKESIA_PHONE_1024_600_DARK_STYLESHEET();
+
+static ESP_Brookesia_Phone *phone = nullptr;
+static Camera *camera = nullptr;
+
+// Steps of the boot graph, see `boot_steps.h`. They return 0 on success, the steps which use LVGL take the lock
+
+static int boot_nvs(void *arg)
 {
     esp_err_t err = nvs_flash_init();
     if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -27,17 +38,45 @@ extern "C" void app_main(void)
     }
     ESP_ERROR_CHECK(err);
 
+    return 0;
+}
+
+static int boot_spiffs(void *arg)
+{
     ESP_ERROR_CHECK(bsp_spiffs_mount());
     ESP_LOGI(TAG, "SPIFFS mount successfully");
 
-// #if CONFIG_EXAMPLE_ENABLE_SD_CARD
+    return 0;
+}
+
+static int boot_sdcard(void *arg)
+{
+    // Without an SD card, the video player isn't installed
     esp_err_t ret = bsp_sdcard_mount();
-    if(ret == ESP_OK)
-        ESP_LOGI(TAG, "SD card mount successfully");
-// #endif
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_LOGI(TAG, "SD card mount successfully");
 
+    return 0;
+}
+
+static int boot_i2c(void *arg)
+{
+    ESP_ERROR_CHECK(bsp_i2c_init());
+
+    return 0;
+}
+
+static int boot_codec(void *arg)
+{
     ESP_ERROR_CHECK(bsp_extra_codec_init());
 
+    return 0;
+}
+
+static int boot_display(void *arg)
+{
     bsp_display_cfg_t cfg = {
         .lvgl_port_cfg = ESP_LVGL_PORT_INIT_CONFIG(),
         .buffer_size = BSP_LCD_H_RES * 80,
@@ -51,51 +90,145 @@ extern "C" void app_main(void)
     bsp_display_start_with_config(&cfg);
     bsp_display_backlight_on();
 
+    return 0;
+}
+
+static int boot_camera_probe(void *arg)
+{
+    camera = new Camera(1288, 728);
+    assert(camera != nullptr && "Failed to create camera");
+
+    // Without a camera sensor, the camera isn't installed
+    return camera->probe() ? 0 : -1;
+}
+
+static int boot_stylesheet(void *arg)
+{
     bsp_display_lock(0);
 
-    ESP_Brookesia_Phone *phone = new ESP_Brookesia_Phone();
+    phone = new ESP_Brookesia_Phone();
     assert(phone != nullptr && "Failed to create phone");
 
-    ESP_Brookesia_PhoneStylesheet_t *phone_stylesheet = new ESP_Brookesia_PhoneStylesheet_t ESP_BROOKESIA_PHONE_1024_600_DARK_STYLESHEET();
-    ESP_BROOKESIA_CHECK_NULL_EXIT(phone_stylesheet, "Create phone stylesheet failed");
-    ESP_BROOKESIA_CHECK_FALSE_EXIT(phone->addStylesheet(*phone_stylesheet), "Add phone stylesheet failed");
-    ESP_BROOKESIA_CHECK_FALSE_EXIT(phone->activateStylesheet(*phone_stylesheet), "Activate phone stylesheet failed");
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(phone->addStaticStylesheet(phone_stylesheet), err, "Add phone stylesheet failed");
+    ESP_BROOKESIA_CHECK_FALSE_GOTO(phone->activateStylesheet(phone_stylesheet), err, "Activate phone stylesheet failed");
+
+    bsp_display_unlock();
+
+    return 0;
 
+err:
+    bsp_display_unlock();
+
+    return -1;
+}
+
+static int boot_phone_begin(void *arg)
+{
+    bsp_display_lock(0);
     assert(phone->begin() && "Failed to begin phone");
+    bsp_display_unlock();
+
+    return 0;
+}
+
+#if CONFIG_EXAMPLE_APP_LAZY_INIT
+// Only the name and the icon are registered at boot, the rest is done when the app is opened or prewarmed
+#define APP_INIT_MODE   ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND
+#else
+#define APP_INIT_MODE   ESP_BROOKESIA_CORE_APP_INIT_ON_INSTALL
+#endif
 
+static int install_app(ESP_Brookesia_PhoneApp *app, ESP_Brookesia_CoreAppInitMode_t init_mode)
+{
+    bsp_display_lock(0);
+    assert((phone->installApp(app, init_mode) >= 0) && "Failed to install app");
+    bsp_display_unlock();
+
+    return 0;
+}
+
+static int boot_app_squareline(void *arg)
+{
     PhoneAppSquareline *smart_gadget = new PhoneAppSquareline();
     assert(smart_gadget != nullptr && "Failed to create phone app squareline");
-    assert((phone->installApp(smart_gadget) >= 0) && "Failed to install phone app squareline");
 
+    return install_app(smart_gadget, ESP_BROOKESIA_CORE_APP_INIT_ON_INSTALL);
+}
+
+static int boot_app_calculator(void *arg)
+{
     Calculator *calculator = new Calculator();
     assert(calculator != nullptr && "Failed to create calculator");
-    assert((phone->installApp(calculator) >= 0) && "Failed to begin calculator");
 
+    return install_app(calculator, APP_INIT_MODE);
+}
+
+static int boot_app_music_player(void *arg)
+{
     MusicPlayer *music_player = new MusicPlayer();
     assert(music_player != nullptr && "Failed to create music_player");
-    assert((phone->installApp(music_player) >= 0) && "Failed to begin music_player");
 
+    return install_app(music_player, APP_INIT_MODE);
+}
+
+static int boot_app_settings(void *arg)
+{
     AppSettings *app_settings = new AppSettings();
     assert(app_settings != nullptr && "Failed to create app_settings");
-    assert((phone->installApp(app_settings) >= 0) && "Failed to begin app_settings");
 
+    // The status bar shows its state from the start
+    return install_app(app_settings, ESP_BROOKESIA_CORE_APP_INIT_ON_INSTALL);
+}
+
+static int boot_app_game_2048(void *arg)
+{
     Game2048 *game_2048 = new Game2048();
     assert(game_2048 != nullptr && "Failed to create game_2048");
-    assert((phone->installApp(game_2048) >= 0) && "Failed to begin game_2048");
 
-    Camera *camera = new Camera(1288, 728);
-    assert(camera != nullptr && "Failed to create camera");
-    assert((phone->installApp(camera) >= 0) && "Failed to begin camera");
-    if(camera->get_camera_ctlr_handle() < 0)
-    {
-        assert((phone->uninstallApp(camera) >= 0) && "Failed to begin camera");
-    
-    }
-        
+    return install_app(game_2048, APP_INIT_MODE);
+}
+
+static int boot_app_camera(void *arg)
+{
+    return install_app(camera, APP_INIT_MODE);
+}
 
+static int boot_app_image(void *arg)
+{
     AppImageDisplay *image = new AppImageDisplay();
     assert(image != nullptr && "Failed to create image");
-    assert((phone->installApp(image) >= 0) && "Failed to begin image");
+
+    return install_app(image, APP_INIT_MODE);
+}
+
+static int boot_app_video_player(void *arg)
+{
+    ESP_LOGW(TAG, "Using Video Player example requires inserting the SD card in advance and saving an MJPEG format video on the SD card");
+    AppVideoPlayer *app_video_player = new AppVideoPlayer();
+    assert(app_video_player != nullptr && "Failed to create app_video_player");
+
+    return install_app(app_video_player, APP_INIT_MODE);
+}
+
+extern "C" void app_main(void)
+{
+    boot_graph_t *graph = boot_graph_new();
+    assert(graph != nullptr && "Failed to create boot graph");
+
+#define BOOT_STEP_ADD(name, deps) \
+    assert((boot_graph_add(graph, #name, boot_##name, NULL, deps) == 0) && "Failed to add boot step " #name);
+    BOOT_STEPS(BOOT_STEP_ADD)
+#undef BOOT_STEP_ADD
+
+    // The steps which failed are logged, the missing SD card or camera sensor only leave their app out
+    // Most steps wait for the hardware (panel reset, sensor probe, SD card), so there are more workers than cores
+    boot_graph_config_t boot_config = BOOT_GRAPH_DEFAULT_CONFIG();
+    boot_config.worker_num = 3;
+    boot_graph_result_t boot_result = {};
+    int ret = boot_graph_run(graph, &boot_config, &boot_result);
+    assert((ret >= 0) && "Invalid boot graph");
+    boot_graph_print_timeline(graph);
+    boot_graph_del(graph);
 
     uint16_t free_sram_size_kb = heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024;
     uint16_t total_sram_size_kb = heap_caps_get_total_size(MALLOC_CAP_INTERNAL) / 1024;
@@ -104,26 +237,10 @@ extern "C" void app_main(void)
     ESP_LOGI(TAG, "Free sram size: %d KB, total sram size: %d KB, "
                          "free psram size: %d KB, total psram size: %d KB",
                          free_sram_size_kb, total_sram_size_kb, free_psram_size_kb, total_psram_size_kb);
+    // The cold boot and the idle memory, to compare the app init modes (`EXAMPLE_APP_LAZY_INIT`)
+    ESP_LOGI(TAG, "Cold boot: %d ms (boot graph: %d ms), idle psram used: %d KB, lazy app init: %s",
+             (int)(esp_timer_get_time() / 1000), (int)(boot_result.total_us / 1000),
+             total_psram_size_kb - free_psram_size_kb, (APP_INIT_MODE == ESP_BROOKESIA_CORE_APP_INIT_ON_DEMAND) ? "on" : "off");
 
-// #if CONFIG_EXAMPLE_ENABLE_SD_CARD
-    if(ret == ESP_OK)
-    {
-        ESP_LOGW(TAG, "Using Video Player example requires inserting the SD card in advance and saving an MJPEG format video on the SD card");
-        AppVideoPlayer *app_video_player = new AppVideoPlayer();
-        assert(app_video_player != nullptr && "Failed to create app_video_player");
-        assert((phone->installApp(app_video_player) >= 0) && "Failed to begin app_video_player");
-    }
-
-    free_sram_size_kb = heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024;
-    total_sram_size_kb = heap_caps_get_total_size(MALLOC_CAP_INTERNAL) / 1024;
-    free_psram_size_kb = heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024;
-    total_psram_size_kb = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) / 1024;
-    ESP_LOGI(TAG, "Free sram size: %d KB, total sram size: %d KB, "
-                         "free psram size: %d KB, total psram size: %d KB",
-                         free_sram_size_kb, total_sram_size_kb, free_psram_size_kb, total_psram_size_kb);
-
-    
-// #endif
     ESP_LOGI(TAG,"setup done");
-    bsp_display_unlock();
 }
@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A throughput benchmark like iperf, between a server and a client of the same protocol: the data goes from the
+ * client to the server (the server is the sink), or from the server to the client (the server is the source), over
+ * TCP or over UDP at a given rate. A test is set up on a TCP control connection, which also carries the report of
+ * each end at the end, so the client gets what the sink received, the datagrams lost, and the CPU time both ends
+ * spent. The server runs one test at a time.
+ *
+ * The control messages are little endian:
+ *
+ *     hello   | "EBH1" | test (4) | proto | dir | block (2) | duration ms (4) | rate kbps (4) | UDP port (2) | 0 (2) |
+ *     accept  | "EBA1" | status (4) |
+ *     report  | "EBR1" | bytes (8) | packets (4) | lost (4) | out of order (4) | elapsed us (8) | CPU us (8) | 0 (4) |
+ *
+ * A TCP test opens a data connection which starts with | "EBD1" | test (4) |. A UDP datagram starts with
+ * | test (4) | sequence (4) |.
+ */
+
+#define ETH_BENCH_OK                    (0)
+#define ETH_BENCH_ERR_INVALID           (-1)
+#define ETH_BENCH_ERR_NO_MEM            (-2)
+#define ETH_BENCH_ERR_SOCKET            (-3)
+#define ETH_BENCH_ERR_TIMEOUT           (-4)    /*!< The peer went silent */
+#define ETH_BENCH_ERR_PROTOCOL          (-5)    /*!< The peer sent an unexpected message, or refused the test */
+#define ETH_BENCH_ERR_NOT_SUPPORTED     (-6)
+
+#define ETH_BENCH_DEFAULT_PORT          (5101)
+#define ETH_BENCH_BLOCK_MIN             (16)
+#define ETH_BENCH_BLOCK_MAX             (16384)
+#define ETH_BENCH_CPU_UNKNOWN           (UINT64_MAX)
+
+typedef enum {
+    ETH_BENCH_PROTO_TCP = 0,
+    ETH_BENCH_PROTO_UDP,
+} eth_bench_proto_t;
+
+typedef enum {
+    ETH_BENCH_DIR_SEND = 0,         /*!< The client sends, the server is the sink */
+    ETH_BENCH_DIR_RECV,             /*!< The server sends, the client is the sink */
+} eth_bench_dir_t;
+
+typedef struct {
+    uint16_t port;                  /*!< The TCP and UDP port, 0 for any, see `eth_bench_server_get_port()` */
+    uint16_t block_max;             /*!< The largest block a client can ask, the buffer of the server */
+    uint32_t timeout_ms;            /*!< A test is aborted when its client is silent for this time */
+    uint32_t stack_size;            /*!< Stack of the server, bytes. Only used on the target */
+    uint8_t priority;               /*!< Priority of the server. Only used on the target */
+} eth_bench_server_config_t;
+
+#define ETH_BENCH_SERVER_DEFAULT_CONFIG()       \
+    {                                           \
+        .port = ETH_BENCH_DEFAULT_PORT,         \
+        .block_max = ETH_BENCH_BLOCK_MAX,       \
+        .timeout_ms = 3000,                     \
+        .stack_size = 4 * 1024,                 \
+        .priority = 5,                          \
+    }
+
+typedef struct {
+    uint32_t test_num;              /*!< The tests run to their end */
+    uint32_t error_num;             /*!< The tests refused or aborted */
+    uint64_t rx_byte_num;           /*!< The payload bytes received by the sink tests */
+    uint64_t tx_byte_num;           /*!< The payload bytes sent by the source tests */
+} eth_bench_server_stats_t;
+
+typedef struct eth_bench_server_t eth_bench_server_t;
+
+/**
+ * @brief The throughput of the client in an interval of a test, the bytes it sent or received.
+ */
+typedef struct {
+    uint32_t start_ms;              /*!< The start of the interval, since the start of the test */
+    uint32_t end_ms;
+    uint64_t byte_num;
+    uint32_t packet_num;            /*!< The writes of a TCP source, the reads of a TCP sink, or the UDP datagrams */
+    uint32_t kbps;
+} eth_bench_interval_t;
+
+typedef void (*eth_bench_interval_cb_t)(const eth_bench_interval_t *interval, void *user_data);
+
+typedef struct {
+    const char *host;               /*!< The IPv4 address of the server, dotted */
+    uint16_t port;
+    eth_bench_proto_t proto;
+    eth_bench_dir_t dir;
+    uint32_t duration_ms;           /*!< The time the source sends */
+    uint16_t block_len;             /*!< The bytes of a write of the source, or of a UDP datagram with its header */
+    uint32_t rate_kbps;             /*!< The rate of a UDP source, 0 to send as fast as possible. TCP ignores it */
+    uint32_t timeout_ms;            /*!< The test fails when the server is silent for this time */
+    uint32_t interval_ms;           /*!< The period of `on_interval`, 0 for none */
+    eth_bench_interval_cb_t on_interval;    /*!< Called in the task of `eth_bench_run()` */
+    void *user_data;
+} eth_bench_client_config_t;
+
+#define ETH_BENCH_CLIENT_DEFAULT_CONFIG()       \
+    {                                           \
+        .host = NULL,                           \
+        .port = ETH_BENCH_DEFAULT_PORT,         \
+        .proto = ETH_BENCH_PROTO_TCP,           \
+        .dir = ETH_BENCH_DIR_SEND,              \
+        .duration_ms = 10000,                   \
+        .block_len = 1460,                      \
+        .rate_kbps = 0,                         \
+        .timeout_ms = 3000,                     \
+        .interval_ms = 1000,                    \
+        .on_interval = NULL,                    \
+        .user_data = NULL,                      \
+    }
+
+typedef struct {
+    uint64_t sent_byte_num;         /*!< The payload bytes sent by the source */
+    uint32_t sent_packet_num;       /*!< The writes of a TCP source, or the UDP datagrams sent */
+    uint64_t byte_num;              /*!< The payload bytes received by the sink */
+    uint32_t packet_num;            /*!< The reads of a TCP sink, or the UDP datagrams received */
+    uint32_t lost_num;              /*!< The UDP datagrams sent and not received */
+    uint32_t out_of_order_num;      /*!< The UDP datagrams received after a later one */
+    uint64_t elapsed_us;            /*!< The time of the sink, from its first byte to its last one */
+    uint32_t kbps;                  /*!< The payload received by the sink, in its time */
+    uint64_t cpu_us;                /*!< The CPU time of the client in the test, all cores, or ETH_BENCH_CPU_UNKNOWN */
+    uint64_t peer_cpu_us;           /*!< The CPU time of the server in the test, or ETH_BENCH_CPU_UNKNOWN */
+    uint32_t cpu_us_per_mbit;       /*!< `cpu_us` per Mbit of payload received, 0 if unknown */
+    uint32_t peer_cpu_us_per_mbit;  /*!< `peer_cpu_us` per Mbit of payload received, 0 if unknown */
+} eth_bench_result_t;
+
+/**
+ * @brief Create a server and start it, on TCP and UDP.
+ *
+ * @param config The configuration
+ * @param ret_server The server
+ *
+ * @return ETH_BENCH_OK, or an error if the configuration is invalid, out of memory, or the port can't be bound
+ */
+int eth_bench_server_new(const eth_bench_server_config_t *config, eth_bench_server_t **ret_server);
+
+/**
+ * @brief Stop a server, abort its test, and delete it.
+ *
+ * @param server The server, can be NULL
+ */
+void eth_bench_server_del(eth_bench_server_t *server);
+
+/**
+ * @brief Get the port of the server, the one which was bound for the port 0.
+ *
+ * @param server The server
+ *
+ * @return The port
+ */
+uint16_t eth_bench_server_get_port(const eth_bench_server_t *server);
+
+/**
+ * @brief Get the counters of a server, from any task.
+ *
+ * @param server The server
+ * @param stats The counters
+ */
+void eth_bench_server_get_stats(eth_bench_server_t *server, eth_bench_server_stats_t *stats);
+
+/**
+ * @brief Run a test against a server, and return when both ends have reported.
+ *
+ * @param config The configuration
+ * @param result The result, from the sink and both ends
+ *
+ * @return ETH_BENCH_OK, ETH_BENCH_ERR_INVALID, ETH_BENCH_ERR_NO_MEM, ETH_BENCH_ERR_SOCKET if the server can't be
+ *         reached, ETH_BENCH_ERR_TIMEOUT, or ETH_BENCH_ERR_PROTOCOL
+ */
+int eth_bench_run(const eth_bench_client_config_t *config, eth_bench_result_t *result);
+
+/**
+ * @brief Get the CPU time spent since the first call, all cores. On the target, it's the time the idle tasks didn't
+ *        run, which needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS on the esp_timer clock; on the host, the CPU time of
+ *        the process. Call it more often than the run time counters wrap, every hour at least.
+ *
+ * @param cpu_us The CPU time
+ *
+ * @return ETH_BENCH_OK, or ETH_BENCH_ERR_NOT_SUPPORTED without the run time statistics
+ */
+int eth_bench_get_cpu_us(uint64_t *cpu_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_eth_driver.h"
+#include "esp_netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Counters of the frames between an Ethernet driver and its esp-netif: the input path of the driver and the transmit
+ * function of the esp-netif are wrapped to count them, then go on to where they went. A frame the stack refuses is
+ * only told apart with CONFIG_ESP_NETIF_RECEIVE_REPORT_ERRORS, else it's counted as received.
+ */
+
+typedef struct {
+    uint64_t rx_byte_num;
+    uint32_t rx_packet_num;         /*!< The frames received by the MAC, with the ones dropped by the stack */
+    uint32_t rx_drop_num;           /*!< The frames the stack refused: its input queue was full */
+    uint32_t rx_no_mem_num;         /*!< The frames dropped without a pbuf for them: the RX buffers were exhausted */
+    uint64_t tx_byte_num;
+    uint32_t tx_packet_num;         /*!< The frames the MAC took */
+    uint32_t tx_error_num;          /*!< The frames the MAC refused, with the ones below */
+    uint32_t tx_no_mem_num;         /*!< The frames refused without a free TX buffer */
+} eth_bench_netif_stats_t;
+
+typedef struct eth_bench_netif_t eth_bench_netif_t;
+
+/**
+ * @brief Count the frames of an Ethernet driver attached to an esp-netif, after `esp_netif_attach()`.
+ *
+ * @param eth The Ethernet driver
+ * @param netif Its esp-netif
+ * @param ret_counters The counters
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or an error of the driver
+ */
+esp_err_t eth_bench_netif_attach(esp_eth_handle_t eth, esp_netif_t *netif, eth_bench_netif_t **ret_counters);
+
+/**
+ * @brief Stop counting, once the driver is stopped and before the esp-netif glue is deleted.
+ *
+ * @param counters The counters, can be NULL
+ */
+void eth_bench_netif_detach(eth_bench_netif_t *counters);
+
+/**
+ * @brief Get the counters since they were attached, from any task.
+ *
+ * @param counters The counters
+ * @param stats The counters
+ */
+void eth_bench_netif_get_stats(eth_bench_netif_t *counters, eth_bench_netif_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
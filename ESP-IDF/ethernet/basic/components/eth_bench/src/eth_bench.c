@@ -0,0 +1,1157 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include "eth_bench.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_pthread.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#define ETH_BENCH_LOGI(format, ...)         ESP_LOGI(TAG, format, ##__VA_ARGS__)
+#define ETH_BENCH_LOGE(format, ...)         ESP_LOGE(TAG, format, ##__VA_ARGS__)
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER
+#define CPU_FROM_IDLE_TASKS                 (1)
+#endif
+#else
+#define ETH_BENCH_LOGI(format, ...)         do { } while (0)
+#define ETH_BENCH_LOGE(format, ...)         fprintf(stderr, "[%s] " format "\n", TAG, ##__VA_ARGS__)
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL                        (0)
+#endif
+
+#define HELLO_LEN                           (24)
+#define ACCEPT_LEN                          (8)
+#define REPORT_LEN                          (44)
+#define DATA_HELLO_LEN                      (8)
+#define UDP_HEADER_LEN                      (8)
+
+#define WAIT_SLICE_MS                       (100)
+/* The time the sink of a UDP test waits for the datagrams in flight after the report of the source */
+#define UDP_DRAIN_MS                        (100)
+/* The wait of a UDP source when the stack is out of buffers */
+#define UDP_BACKOFF_US                      (1000)
+/* The datagrams a UDP source sends at once to catch up with its rate */
+#define UDP_BURST_US                        (10000)
+
+#define WAIT_FD                             (1)
+#define WAIT_FD2                            (2)
+
+static const char *TAG = "eth_bench";
+
+static const uint8_t hello_magic[4] = {'E', 'B', 'H', '1'};
+static const uint8_t accept_magic[4] = {'E', 'B', 'A', '1'};
+static const uint8_t report_magic[4] = {'E', 'B', 'R', '1'};
+static const uint8_t data_magic[4] = {'E', 'B', 'D', '1'};
+
+typedef struct {
+    uint32_t test_id;
+    uint8_t proto;
+    uint8_t dir;
+    uint16_t block_len;
+    uint32_t duration_ms;
+    uint32_t rate_kbps;
+    uint16_t udp_port;      /* The UDP port of the client, where the server sends to */
+} hello_t;
+
+typedef struct {
+    uint64_t byte_num;
+    uint32_t packet_num;
+    uint32_t lost_num;
+    uint32_t out_of_order_num;
+    uint64_t elapsed_us;
+    uint64_t cpu_us;
+} report_t;
+
+/* The data sent or received by an end */
+typedef struct {
+    uint64_t byte_num;
+    uint32_t packet_num;
+    uint32_t lost_num;
+    uint32_t out_of_order_num;
+    uint32_t next_seq;
+    int64_t first_us;
+    int64_t last_us;
+} flow_t;
+
+typedef struct {
+    const eth_bench_client_config_t *config;
+    int64_t start_us;
+    int64_t last_us;
+    int64_t next_us;
+    uint64_t byte_num;      /* The bytes of the flow at the start of the interval */
+    uint32_t packet_num;
+} ticker_t;
+
+typedef struct {
+    eth_bench_server_t *server;     /* Stops the waits when the server is deleted, NULL on the client */
+    uint32_t timeout_ms;
+} bench_io_t;
+
+struct eth_bench_server_t {
+    eth_bench_server_config_t config;
+    /* Guards the stop flag and the counters */
+    pthread_mutex_t lock;
+    int listen_fd;
+    int udp_fd;
+    uint16_t port;
+    uint8_t *buf;
+    bool stop;
+    pthread_t thread;
+    bool has_thread;
+    eth_bench_server_stats_t stats;
+};
+
+static int64_t now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static void sleep_us(int64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = us / 1000000,
+        .tv_nsec = (us % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static inline void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline void put_le64(uint8_t *p, uint64_t v)
+{
+    put_le32(p, (uint32_t)v);
+    put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_le32(const uint8_t *p)
+{
+    return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+static inline uint64_t get_le64(const uint8_t *p)
+{
+    return get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+static bool set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0);
+}
+
+static inline bool would_block(int err)
+{
+    return (err == EAGAIN) || (err == EWOULDBLOCK) || (err == EINTR);
+}
+
+static bool is_stopped(const bench_io_t *io)
+{
+    if (io->server == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(&io->server->lock);
+    bool stop = io->server->stop;
+    pthread_mutex_unlock(&io->server->lock);
+    return stop;
+}
+
+/* Wait for `fd` to read or to write, or `fd2` to read, up to a deadline: the WAIT_FD flags of the ready ones, 0 at the
+ * deadline, -1 on an error or when the server stops */
+static int wait_fds(const bench_io_t *io, int fd, bool is_write, int fd2, int64_t deadline_us)
+{
+    while (!is_stopped(io)) {
+        int64_t left_us = deadline_us - now_us();
+        if (left_us <= 0) {
+            return 0;
+        }
+        left_us = (left_us > WAIT_SLICE_MS * 1000) ? WAIT_SLICE_MS * 1000 : left_us;
+
+        fd_set read_fds;
+        fd_set write_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(fd, is_write ? &write_fds : &read_fds);
+        if (fd2 >= 0) {
+            FD_SET(fd2, &read_fds);
+        }
+        struct timeval tv = {
+            .tv_sec = 0,
+            .tv_usec = left_us,
+        };
+        int ret = select(((fd > fd2) ? fd : fd2) + 1, &read_fds, &write_fds, NULL, &tv);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (ret > 0) {
+            return (FD_ISSET(fd, is_write ? &write_fds : &read_fds) ? WAIT_FD : 0) |
+                   (((fd2 >= 0) && FD_ISSET(fd2, &read_fds)) ? WAIT_FD2 : 0);
+        }
+    }
+    return -1;
+}
+
+static inline int64_t io_deadline(const bench_io_t *io)
+{
+    return now_us() + (int64_t)io->timeout_ms * 1000;
+}
+
+static int recv_full(const bench_io_t *io, int fd, uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        int ready = wait_fds(io, fd, false, -1, io_deadline(io));
+        if (ready <= 0) {
+            return (ready == 0) ? ETH_BENCH_ERR_TIMEOUT : ETH_BENCH_ERR_SOCKET;
+        }
+        ssize_t n = recv(fd, buf + done, len - done, MSG_DONTWAIT);
+        if (n == 0) {
+            return ETH_BENCH_ERR_PROTOCOL;
+        }
+        if (n < 0) {
+            if (would_block(errno)) {
+                continue;
+            }
+            return ETH_BENCH_ERR_SOCKET;
+        }
+        done += n;
+    }
+    return ETH_BENCH_OK;
+}
+
+static int send_full(const bench_io_t *io, int fd, const uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        int ready = wait_fds(io, fd, true, -1, io_deadline(io));
+        if (ready <= 0) {
+            return (ready == 0) ? ETH_BENCH_ERR_TIMEOUT : ETH_BENCH_ERR_SOCKET;
+        }
+        ssize_t n = send(fd, buf + done, len - done, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (would_block(errno)) {
+                continue;
+            }
+            return ETH_BENCH_ERR_SOCKET;
+        }
+        done += n;
+    }
+    return ETH_BENCH_OK;
+}
+
+static void encode_hello(const hello_t *hello, uint8_t *msg)
+{
+    memcpy(msg, hello_magic, 4);
+    put_le32(&msg[4], hello->test_id);
+    msg[8] = hello->proto;
+    msg[9] = hello->dir;
+    put_le16(&msg[10], hello->block_len);
+    put_le32(&msg[12], hello->duration_ms);
+    put_le32(&msg[16], hello->rate_kbps);
+    put_le16(&msg[20], hello->udp_port);
+    put_le16(&msg[22], 0);
+}
+
+static bool decode_hello(const uint8_t *msg, hello_t *hello)
+{
+    hello->test_id = get_le32(&msg[4]);
+    hello->proto = msg[8];
+    hello->dir = msg[9];
+    hello->block_len = get_le16(&msg[10]);
+    hello->duration_ms = get_le32(&msg[12]);
+    hello->rate_kbps = get_le32(&msg[16]);
+    hello->udp_port = get_le16(&msg[20]);
+
+    return (memcmp(msg, hello_magic, 4) == 0) &&
+           (hello->proto <= ETH_BENCH_PROTO_UDP) && (hello->dir <= ETH_BENCH_DIR_RECV) &&
+           (hello->block_len >= ETH_BENCH_BLOCK_MIN) && (hello->block_len <= ETH_BENCH_BLOCK_MAX) &&
+           (hello->duration_ms > 0) &&
+           ((hello->proto != ETH_BENCH_PROTO_UDP) || (hello->dir != ETH_BENCH_DIR_RECV) || (hello->udp_port != 0));
+}
+
+static int send_accept(const bench_io_t *io, int fd, int status)
+{
+    uint8_t msg[ACCEPT_LEN];
+
+    memcpy(msg, accept_magic, 4);
+    put_le32(&msg[4], (uint32_t)status);
+    return send_full(io, fd, msg, sizeof(msg));
+}
+
+static int recv_accept(const bench_io_t *io, int fd)
+{
+    uint8_t msg[ACCEPT_LEN];
+
+    int ret = recv_full(io, fd, msg, sizeof(msg));
+    if (ret != ETH_BENCH_OK) {
+        return ret;
+    }
+    if ((memcmp(msg, accept_magic, 4) != 0) || (get_le32(&msg[4]) != ETH_BENCH_OK)) {
+        return ETH_BENCH_ERR_PROTOCOL;
+    }
+    return ETH_BENCH_OK;
+}
+
+static int send_report(const bench_io_t *io, int fd, const report_t *report)
+{
+    uint8_t msg[REPORT_LEN];
+
+    memcpy(msg, report_magic, 4);
+    put_le64(&msg[4], report->byte_num);
+    put_le32(&msg[12], report->packet_num);
+    put_le32(&msg[16], report->lost_num);
+    put_le32(&msg[20], report->out_of_order_num);
+    put_le64(&msg[24], report->elapsed_us);
+    put_le64(&msg[32], report->cpu_us);
+    put_le32(&msg[40], 0);
+    return send_full(io, fd, msg, sizeof(msg));
+}
+
+static int recv_report(const bench_io_t *io, int fd, report_t *report)
+{
+    uint8_t msg[REPORT_LEN];
+
+    int ret = recv_full(io, fd, msg, sizeof(msg));
+    if (ret != ETH_BENCH_OK) {
+        return ret;
+    }
+    if (memcmp(msg, report_magic, 4) != 0) {
+        return ETH_BENCH_ERR_PROTOCOL;
+    }
+    report->byte_num = get_le64(&msg[4]);
+    report->packet_num = get_le32(&msg[12]);
+    report->lost_num = get_le32(&msg[16]);
+    report->out_of_order_num = get_le32(&msg[20]);
+    report->elapsed_us = get_le64(&msg[24]);
+    report->cpu_us = get_le64(&msg[32]);
+    return ETH_BENCH_OK;
+}
+
+static void flow_add(flow_t *flow, size_t len)
+{
+    int64_t now = now_us();
+
+    if (flow->packet_num == 0) {
+        flow->first_us = now;
+    }
+    flow->last_us = now;
+    flow->byte_num += len;
+    flow->packet_num++;
+}
+
+static void flow_report(const flow_t *flow, uint64_t cpu_us, report_t *report)
+{
+    report->byte_num = flow->byte_num;
+    report->packet_num = flow->packet_num;
+    report->lost_num = flow->lost_num;
+    report->out_of_order_num = flow->out_of_order_num;
+    report->elapsed_us = (flow->packet_num > 0) ? (uint64_t)(flow->last_us - flow->first_us) : 0;
+    report->cpu_us = cpu_us;
+}
+
+static void ticker_start(ticker_t *ticker, const eth_bench_client_config_t *config)
+{
+    ticker->config = config;
+    ticker->start_us = now_us();
+    ticker->last_us = ticker->start_us;
+    ticker->next_us = ticker->start_us + (int64_t)config->interval_ms * 1000;
+    ticker->byte_num = 0;
+    ticker->packet_num = 0;
+}
+
+/* Report the interval to the client when it's over, or the rest of one at the end of the test */
+static void ticker_update(ticker_t *ticker, const flow_t *flow, bool is_end)
+{
+    if (ticker == NULL) {
+        return;
+    }
+    int64_t now = now_us();
+    if (is_end ? (flow->packet_num == ticker->packet_num) : (now < ticker->next_us)) {
+        return;
+    }
+
+    eth_bench_interval_t interval = {
+        .start_ms = (uint32_t)((ticker->last_us - ticker->start_us) / 1000),
+        .end_ms = (uint32_t)((now - ticker->start_us) / 1000),
+        .byte_num = flow->byte_num - ticker->byte_num,
+        .packet_num = flow->packet_num - ticker->packet_num,
+    };
+    int64_t interval_us = (now > ticker->last_us) ? now - ticker->last_us : 1;
+    interval.kbps = (uint32_t)(interval.byte_num * 8000 / (uint64_t)interval_us);
+    ticker->config->on_interval(&interval, ticker->config->user_data);
+
+    ticker->last_us = now;
+    ticker->byte_num = flow->byte_num;
+    ticker->packet_num = flow->packet_num;
+    ticker->next_us += (int64_t)ticker->config->interval_ms * 1000;
+    if (ticker->next_us <= now) {
+        ticker->next_us = now + (int64_t)ticker->config->interval_ms * 1000;
+    }
+}
+
+/* Send blocks until the end of the test, then end the data connection */
+static int tcp_send(const bench_io_t *io, int fd, const uint8_t *buf, size_t block_len, int64_t end_us, flow_t *flow,
+                    ticker_t *ticker)
+{
+    while (now_us() < end_us) {
+        int64_t deadline_us = io_deadline(io);
+        int ready = wait_fds(io, fd, true, -1, (deadline_us < end_us) ? deadline_us : end_us);
+        if (ready < 0) {
+            return ETH_BENCH_ERR_SOCKET;
+        }
+        if (ready == 0) {
+            if (now_us() >= end_us) {
+                break;
+            }
+            return ETH_BENCH_ERR_TIMEOUT;
+        }
+        ssize_t n = send(fd, buf, block_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (would_block(errno)) {
+                continue;
+            }
+            return ETH_BENCH_ERR_SOCKET;
+        }
+        flow_add(flow, n);
+        ticker_update(ticker, flow, false);
+    }
+
+    shutdown(fd, SHUT_WR);
+    return ETH_BENCH_OK;
+}
+
+/* Receive until the source ends the data connection */
+static int tcp_recv(const bench_io_t *io, int fd, uint8_t *buf, size_t size, flow_t *flow, ticker_t *ticker)
+{
+    while (true) {
+        int ready = wait_fds(io, fd, false, -1, io_deadline(io));
+        if (ready <= 0) {
+            return (ready == 0) ? ETH_BENCH_ERR_TIMEOUT : ETH_BENCH_ERR_SOCKET;
+        }
+        ssize_t n = recv(fd, buf, size, MSG_DONTWAIT);
+        if (n == 0) {
+            return ETH_BENCH_OK;
+        }
+        if (n < 0) {
+            if (would_block(errno)) {
+                continue;
+            }
+            return ETH_BENCH_ERR_SOCKET;
+        }
+        flow_add(flow, n);
+        ticker_update(ticker, flow, false);
+    }
+}
+
+/* Send datagrams at the rate until the end of the test, to `to`, or to the peer of a connected socket if it's NULL */
+static int udp_send(const bench_io_t *io, int fd, const struct sockaddr_in *to, uint32_t test_id, uint8_t *buf,
+                    size_t block_len, uint32_t rate_kbps, int64_t end_us, flow_t *flow, ticker_t *ticker)
+{
+    /* The time of a datagram at the rate, in ns so the small ones keep their rate */
+    int64_t gap_ns = (rate_kbps > 0) ? (int64_t)block_len * 8 * 1000000 / rate_kbps : 0;
+    int64_t due_ns = now_us() * 1000;
+
+    put_le32(&buf[0], test_id);
+    while (true) {
+        int64_t now = now_us();
+        if (now >= end_us) {
+            break;
+        }
+        if (gap_ns > 0) {
+            if (due_ns > now * 1000) {
+                int64_t wait_us = due_ns / 1000 - now;
+                sleep_us((wait_us < end_us - now) ? wait_us : end_us - now);
+                continue;
+            }
+            /* A source which fell behind catches up in a burst, not with all the datagrams it missed */
+            if (due_ns < (now - UDP_BURST_US) * 1000) {
+                due_ns = (now - UDP_BURST_US) * 1000;
+            }
+        }
+        if (((flow->packet_num & 0x3f) == 0) && is_stopped(io)) {
+            return ETH_BENCH_ERR_SOCKET;
+        }
+
+        put_le32(&buf[4], flow->packet_num);
+        ssize_t n = (to != NULL) ? sendto(fd, buf, block_len, MSG_DONTWAIT, (const struct sockaddr *)to, sizeof(*to)) :
+                    send(fd, buf, block_len, MSG_DONTWAIT);
+        if (n < 0) {
+            if ((errno == ENOBUFS) || (errno == ENOMEM)) {
+                /* lwIP has no more buffers, and is still writable */
+                sleep_us(UDP_BACKOFF_US);
+            } else if (would_block(errno)) {
+                wait_fds(io, fd, true, -1, end_us);
+            } else {
+                return ETH_BENCH_ERR_SOCKET;
+            }
+            continue;
+        }
+        flow_add(flow, n);
+        due_ns += gap_ns;
+        ticker_update(ticker, flow, false);
+    }
+    return ETH_BENCH_OK;
+}
+
+static void udp_account(flow_t *flow, uint32_t test_id, const uint8_t *buf, ssize_t len)
+{
+    if ((len < UDP_HEADER_LEN) || (get_le32(&buf[0]) != test_id)) {
+        return;
+    }
+    uint32_t seq = get_le32(&buf[4]);
+    if (seq < flow->next_seq) {
+        flow->out_of_order_num++;
+    } else {
+        flow->next_seq = seq + 1;
+    }
+    flow_add(flow, len);
+}
+
+/* Receive datagrams until the source reports its end on the control connection, and the datagrams it sent arrived
+ * or stopped arriving */
+static int udp_recv(const bench_io_t *io, int fd, int ctrl_fd, uint32_t test_id, uint8_t *buf, size_t size,
+                    flow_t *flow, ticker_t *ticker, report_t *source)
+{
+    bool has_report = false;
+    int64_t deadline_us = io_deadline(io);
+
+    while (!has_report || (flow->packet_num < source->packet_num)) {
+        int ready = wait_fds(io, fd, false, has_report ? -1 : ctrl_fd, deadline_us);
+        if (ready < 0) {
+            return ETH_BENCH_ERR_SOCKET;
+        }
+        if (ready == 0) {
+            if (has_report) {
+                break;
+            }
+            return ETH_BENCH_ERR_TIMEOUT;
+        }
+        if (ready & WAIT_FD) {
+            ssize_t n;
+            while ((n = recv(fd, buf, size, MSG_DONTWAIT)) >= 0) {
+                udp_account(flow, test_id, buf, n);
+                ticker_update(ticker, flow, false);
+            }
+            if (!would_block(errno)) {
+                return ETH_BENCH_ERR_SOCKET;
+            }
+            deadline_us = has_report ? now_us() + UDP_DRAIN_MS * 1000 : io_deadline(io);
+        }
+        if (ready & WAIT_FD2) {
+            int ret = recv_report(io, ctrl_fd, source);
+            if (ret != ETH_BENCH_OK) {
+                return ret;
+            }
+            has_report = true;
+            deadline_us = now_us() + UDP_DRAIN_MS * 1000;
+        }
+    }
+
+    flow->lost_num = (source->packet_num > flow->packet_num) ? source->packet_num - flow->packet_num : 0;
+    return ETH_BENCH_OK;
+}
+
+static void fill_pattern(uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)i;
+    }
+}
+
+static inline uint32_t cpu_us_per_mbit(uint64_t cpu_us, uint64_t byte_num)
+{
+    if ((cpu_us == ETH_BENCH_CPU_UNKNOWN) || (byte_num == 0)) {
+        return 0;
+    }
+    return (uint32_t)(cpu_us * 1000000 / (byte_num * 8));
+}
+
+static uint64_t cpu_now(void)
+{
+    uint64_t cpu_us;
+    return (eth_bench_get_cpu_us(&cpu_us) == ETH_BENCH_OK) ? cpu_us : ETH_BENCH_CPU_UNKNOWN;
+}
+
+static inline uint64_t cpu_since(uint64_t start_us)
+{
+    uint64_t end_us = cpu_now();
+    return ((start_us == ETH_BENCH_CPU_UNKNOWN) || (end_us == ETH_BENCH_CPU_UNKNOWN)) ? ETH_BENCH_CPU_UNKNOWN :
+           end_us - start_us;
+}
+
+#ifdef CPU_FROM_IDLE_TASKS
+static pthread_mutex_t cpu_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    bool is_started;
+    int64_t start_us;
+    uint32_t last_idle_us[configNUMBER_OF_CORES];
+    uint64_t idle_us;
+} cpu;
+#elif !defined(ESP_PLATFORM)
+static pthread_mutex_t cpu_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    bool is_started;
+    uint64_t start_us;
+} cpu;
+#endif
+
+int eth_bench_get_cpu_us(uint64_t *cpu_us)
+{
+#ifdef CPU_FROM_IDLE_TASKS
+    pthread_mutex_lock(&cpu_lock);
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < configNUMBER_OF_CORES; i++) {
+        /* Counted in the 32 bits of the smaller counter type, it wraps every 71 minutes */
+        uint32_t idle_us = (uint32_t)ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(i));
+        if (cpu.is_started) {
+            cpu.idle_us += (uint32_t)(idle_us - cpu.last_idle_us[i]);
+        }
+        cpu.last_idle_us[i] = idle_us;
+    }
+    if (!cpu.is_started) {
+        cpu.start_us = now;
+        cpu.is_started = true;
+    }
+    uint64_t total_us = (uint64_t)(now - cpu.start_us) * configNUMBER_OF_CORES;
+    *cpu_us = (total_us > cpu.idle_us) ? total_us - cpu.idle_us : 0;
+    pthread_mutex_unlock(&cpu_lock);
+    return ETH_BENCH_OK;
+#elif defined(ESP_PLATFORM)
+    (void)cpu_us;
+    return ETH_BENCH_ERR_NOT_SUPPORTED;
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+        return ETH_BENCH_ERR_NOT_SUPPORTED;
+    }
+    uint64_t process_us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    pthread_mutex_lock(&cpu_lock);
+    if (!cpu.is_started) {
+        cpu.start_us = process_us;
+        cpu.is_started = true;
+    }
+    *cpu_us = process_us - cpu.start_us;
+    pthread_mutex_unlock(&cpu_lock);
+    return ETH_BENCH_OK;
+#endif
+}
+
+static void flush_udp(eth_bench_server_t *server)
+{
+    while (recv(server->udp_fd, server->buf, server->config.block_max, MSG_DONTWAIT) >= 0) {
+    }
+}
+
+/* Accept the data connection of a TCP test */
+static int accept_data(eth_bench_server_t *server, const bench_io_t *io, uint32_t test_id, int *ret_fd)
+{
+    int ready = wait_fds(io, server->listen_fd, false, -1, io_deadline(io));
+    if (ready <= 0) {
+        return (ready == 0) ? ETH_BENCH_ERR_TIMEOUT : ETH_BENCH_ERR_SOCKET;
+    }
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if ((fd < 0) || !set_nonblocking(fd)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return ETH_BENCH_ERR_SOCKET;
+    }
+
+    uint8_t msg[DATA_HELLO_LEN];
+    int ret = recv_full(io, fd, msg, sizeof(msg));
+    if ((ret == ETH_BENCH_OK) && ((memcmp(msg, data_magic, 4) != 0) || (get_le32(&msg[4]) != test_id))) {
+        ret = ETH_BENCH_ERR_PROTOCOL;
+    }
+    if (ret != ETH_BENCH_OK) {
+        close(fd);
+        return ret;
+    }
+    *ret_fd = fd;
+    return ETH_BENCH_OK;
+}
+
+static int serve_test(eth_bench_server_t *server, const bench_io_t *io, int ctrl_fd, const struct sockaddr_in *peer)
+{
+    int one = 1;
+    if (!set_nonblocking(ctrl_fd)) {
+        return ETH_BENCH_ERR_SOCKET;
+    }
+    setsockopt(ctrl_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    uint8_t msg[HELLO_LEN];
+    hello_t hello;
+    int ret = recv_full(io, ctrl_fd, msg, sizeof(msg));
+    if (ret != ETH_BENCH_OK) {
+        return ret;
+    }
+    if (!decode_hello(msg, &hello) || (hello.block_len > server->config.block_max)) {
+        send_accept(io, ctrl_fd, ETH_BENCH_ERR_INVALID);
+        return ETH_BENCH_ERR_PROTOCOL;
+    }
+
+    /* The datagrams of an earlier test would be counted as out of order */
+    if (hello.proto == ETH_BENCH_PROTO_UDP) {
+        flush_udp(server);
+    }
+    int data_fd = -1;
+    ret = send_accept(io, ctrl_fd, ETH_BENCH_OK);
+    if ((ret == ETH_BENCH_OK) && (hello.proto == ETH_BENCH_PROTO_TCP)) {
+        ret = accept_data(server, io, hello.test_id, &data_fd);
+    }
+
+    uint64_t cpu_start_us = cpu_now();
+    flow_t flow = {};
+    report_t source = {};
+    if ((ret == ETH_BENCH_OK) && (hello.dir == ETH_BENCH_DIR_SEND)) {
+        if (hello.proto == ETH_BENCH_PROTO_TCP) {
+            ret = tcp_recv(io, data_fd, server->buf, server->config.block_max, &flow, NULL);
+            if (ret == ETH_BENCH_OK) {
+                ret = recv_report(io, ctrl_fd, &source);
+            }
+        } else {
+            ret = udp_recv(io, server->udp_fd, ctrl_fd, hello.test_id, server->buf, server->config.block_max, &flow,
+                           NULL, &source);
+        }
+    } else if (ret == ETH_BENCH_OK) {
+        int64_t end_us = now_us() + (int64_t)hello.duration_ms * 1000;
+        if (hello.proto == ETH_BENCH_PROTO_TCP) {
+            ret = tcp_send(io, data_fd, server->buf, hello.block_len, end_us, &flow, NULL);
+        } else {
+            struct sockaddr_in to = *peer;
+            to.sin_port = htons(hello.udp_port);
+            ret = udp_send(io, server->udp_fd, &to, hello.test_id, server->buf, hello.block_len, hello.rate_kbps,
+                           end_us, &flow, NULL);
+        }
+    }
+    if (ret == ETH_BENCH_OK) {
+        report_t report;
+        flow_report(&flow, cpu_since(cpu_start_us), &report);
+        ret = send_report(io, ctrl_fd, &report);
+    }
+    if (data_fd >= 0) {
+        close(data_fd);
+    }
+
+    pthread_mutex_lock(&server->lock);
+    if (hello.dir == ETH_BENCH_DIR_SEND) {
+        server->stats.rx_byte_num += flow.byte_num;
+    } else {
+        server->stats.tx_byte_num += flow.byte_num;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    ETH_BENCH_LOGI("%s %s test: %d, %llu bytes in %lld ms", (hello.proto == ETH_BENCH_PROTO_TCP) ? "TCP" : "UDP",
+                   (hello.dir == ETH_BENCH_DIR_SEND) ? "sink" : "source", ret, (unsigned long long)flow.byte_num,
+                   (long long)((flow.last_us - flow.first_us) / 1000));
+    return ret;
+}
+
+static void *server_main(void *arg)
+{
+    eth_bench_server_t *server = (eth_bench_server_t *)arg;
+    const bench_io_t io = {
+        .server = server,
+        .timeout_ms = server->config.timeout_ms,
+    };
+
+    while (!is_stopped(&io)) {
+        if (wait_fds(&io, server->listen_fd, false, -1, now_us() + WAIT_SLICE_MS * 1000) <= 0) {
+            continue;
+        }
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(server->listen_fd, (struct sockaddr *)&peer, &peer_len);
+        if (fd < 0) {
+            continue;
+        }
+        int ret = serve_test(server, &io, fd, &peer);
+        close(fd);
+
+        pthread_mutex_lock(&server->lock);
+        if (ret == ETH_BENCH_OK) {
+            server->stats.test_num++;
+        } else {
+            server->stats.error_num++;
+        }
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    return NULL;
+}
+
+static bool start_server(eth_bench_server_t *server)
+{
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t prev_cfg;
+    bool has_prev_cfg = (esp_pthread_get_cfg(&prev_cfg) == ESP_OK);
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = server->config.stack_size;
+    cfg.prio = server->config.priority;
+    cfg.thread_name = "eth_bench";
+    cfg.pin_to_core = tskNO_AFFINITY;
+    esp_pthread_set_cfg(&cfg);
+#endif
+
+    server->has_thread = (pthread_create(&server->thread, NULL, server_main, server) == 0);
+
+#ifdef ESP_PLATFORM
+    if (has_prev_cfg) {
+        esp_pthread_set_cfg(&prev_cfg);
+    } else {
+        esp_pthread_cfg_t restore_cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&restore_cfg);
+    }
+#endif
+
+    return server->has_thread;
+}
+
+static int open_sockets(eth_bench_server_t *server)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(server->config.port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    socklen_t addr_len = sizeof(addr);
+    int reuse = 1;
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if ((server->listen_fd < 0) ||
+            (setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) ||
+            (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            (listen(server->listen_fd, 2) != 0) ||
+            !set_nonblocking(server->listen_fd) ||
+            (getsockname(server->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0)) {
+        ETH_BENCH_LOGE("listen on port %d failed: %d", server->config.port, errno);
+        return ETH_BENCH_ERR_SOCKET;
+    }
+    server->port = ntohs(addr.sin_port);
+
+    /* The UDP tests use the same port number */
+    server->udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if ((server->udp_fd < 0) ||
+            (bind(server->udp_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            !set_nonblocking(server->udp_fd)) {
+        ETH_BENCH_LOGE("UDP port %d failed: %d", server->port, errno);
+        return ETH_BENCH_ERR_SOCKET;
+    }
+
+    return ETH_BENCH_OK;
+}
+
+int eth_bench_server_new(const eth_bench_server_config_t *config, eth_bench_server_t **ret_server)
+{
+    if ((config == NULL) || (ret_server == NULL) || (config->block_max < ETH_BENCH_BLOCK_MIN) ||
+            (config->block_max > ETH_BENCH_BLOCK_MAX) || (config->timeout_ms == 0)) {
+        return ETH_BENCH_ERR_INVALID;
+    }
+
+    eth_bench_server_t *server = calloc(1, sizeof(eth_bench_server_t));
+    if (server == NULL) {
+        return ETH_BENCH_ERR_NO_MEM;
+    }
+    server->config = *config;
+    server->listen_fd = -1;
+    server->udp_fd = -1;
+    pthread_mutex_init(&server->lock, NULL);
+
+    int ret = ETH_BENCH_ERR_NO_MEM;
+    server->buf = malloc(config->block_max);
+    if (server->buf == NULL) {
+        goto err;
+    }
+    fill_pattern(server->buf, config->block_max);
+    /* Starts the CPU time before the first test */
+    cpu_now();
+
+    ret = open_sockets(server);
+    if (ret != ETH_BENCH_OK) {
+        goto err;
+    }
+    if (!start_server(server)) {
+        ret = ETH_BENCH_ERR_NO_MEM;
+        goto err;
+    }
+    ETH_BENCH_LOGI("serving on TCP and UDP port %d", server->port);
+
+    *ret_server = server;
+    return ETH_BENCH_OK;
+
+err:
+    eth_bench_server_del(server);
+    return ret;
+}
+
+void eth_bench_server_del(eth_bench_server_t *server)
+{
+    if (server == NULL) {
+        return;
+    }
+
+    if (server->has_thread) {
+        pthread_mutex_lock(&server->lock);
+        server->stop = true;
+        pthread_mutex_unlock(&server->lock);
+        pthread_join(server->thread, NULL);
+    }
+
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+    }
+    if (server->udp_fd >= 0) {
+        close(server->udp_fd);
+    }
+    free(server->buf);
+    pthread_mutex_destroy(&server->lock);
+    free(server);
+}
+
+uint16_t eth_bench_server_get_port(const eth_bench_server_t *server)
+{
+    return server->port;
+}
+
+void eth_bench_server_get_stats(eth_bench_server_t *server, eth_bench_server_stats_t *stats)
+{
+    pthread_mutex_lock(&server->lock);
+    *stats = server->stats;
+    pthread_mutex_unlock(&server->lock);
+}
+
+static int connect_to(const bench_io_t *io, const struct sockaddr_in *addr, int *ret_fd)
+{
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if ((fd < 0) || !set_nonblocking(fd)) {
+        goto err;
+    }
+    if (connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) != 0) {
+        if (errno != EINPROGRESS) {
+            goto err;
+        }
+        int ready = wait_fds(io, fd, true, -1, io_deadline(io));
+        int err = 0;
+        socklen_t err_len = sizeof(err);
+        if ((ready <= 0) || (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0) || (err != 0)) {
+            goto err;
+        }
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    *ret_fd = fd;
+    return ETH_BENCH_OK;
+
+err:
+    if (fd >= 0) {
+        close(fd);
+    }
+    return ETH_BENCH_ERR_SOCKET;
+}
+
+/* A UDP socket of the client, connected to the server */
+static int open_udp(const struct sockaddr_in *server_addr, int *ret_fd, uint16_t *ret_port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if ((fd < 0) ||
+            (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            (getsockname(fd, (struct sockaddr *)&addr, &addr_len) != 0) ||
+            (connect(fd, (const struct sockaddr *)server_addr, sizeof(*server_addr)) != 0) ||
+            !set_nonblocking(fd)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return ETH_BENCH_ERR_SOCKET;
+    }
+    *ret_fd = fd;
+    *ret_port = ntohs(addr.sin_port);
+    return ETH_BENCH_OK;
+}
+
+static void fill_result(const eth_bench_client_config_t *config, const report_t *local, const report_t *peer,
+                        eth_bench_result_t *result)
+{
+    const report_t *source = (config->dir == ETH_BENCH_DIR_SEND) ? local : peer;
+    const report_t *sink = (config->dir == ETH_BENCH_DIR_SEND) ? peer : local;
+
+    memset(result, 0, sizeof(*result));
+    result->sent_byte_num = source->byte_num;
+    result->sent_packet_num = source->packet_num;
+    result->byte_num = sink->byte_num;
+    result->packet_num = sink->packet_num;
+    result->lost_num = sink->lost_num;
+    result->out_of_order_num = sink->out_of_order_num;
+    result->elapsed_us = sink->elapsed_us;
+    result->kbps = (sink->elapsed_us > 0) ? (uint32_t)(sink->byte_num * 8000 / sink->elapsed_us) : 0;
+    result->cpu_us = local->cpu_us;
+    result->peer_cpu_us = peer->cpu_us;
+    result->cpu_us_per_mbit = cpu_us_per_mbit(local->cpu_us, sink->byte_num);
+    result->peer_cpu_us_per_mbit = cpu_us_per_mbit(peer->cpu_us, sink->byte_num);
+}
+
+int eth_bench_run(const eth_bench_client_config_t *config, eth_bench_result_t *result)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+    };
+    if ((config == NULL) || (result == NULL) || (config->host == NULL) ||
+            (inet_pton(AF_INET, config->host, &addr.sin_addr) != 1) || (config->port == 0) ||
+            (config->proto > ETH_BENCH_PROTO_UDP) || (config->dir > ETH_BENCH_DIR_RECV) ||
+            (config->block_len < ETH_BENCH_BLOCK_MIN) || (config->block_len > ETH_BENCH_BLOCK_MAX) ||
+            (config->duration_ms == 0) || (config->timeout_ms == 0)) {
+        return ETH_BENCH_ERR_INVALID;
+    }
+    addr.sin_port = htons(config->port);
+
+    uint8_t *buf = malloc(config->block_len);
+    if (buf == NULL) {
+        return ETH_BENCH_ERR_NO_MEM;
+    }
+    fill_pattern(buf, config->block_len);
+
+    const bench_io_t io = {
+        .server = NULL,
+        .timeout_ms = config->timeout_ms,
+    };
+    /* Tells the datagrams of this test from the ones of an earlier test */
+    int64_t start_us = now_us();
+    hello_t hello = {
+        .test_id = (uint32_t)start_us ^ ((uint32_t)(start_us >> 32) * 2654435761u) ^ (uint32_t)(uintptr_t)buf,
+        .proto = config->proto,
+        .dir = config->dir,
+        .block_len = config->block_len,
+        .duration_ms = config->duration_ms,
+        .rate_kbps = config->rate_kbps,
+    };
+    int ctrl_fd = -1;
+    int data_fd = -1;
+    int udp_fd = -1;
+    uint8_t msg[HELLO_LEN];
+
+    int ret = connect_to(&io, &addr, &ctrl_fd);
+    if ((ret == ETH_BENCH_OK) && (config->proto == ETH_BENCH_PROTO_UDP)) {
+        ret = open_udp(&addr, &udp_fd, &hello.udp_port);
+    }
+    if (ret == ETH_BENCH_OK) {
+        encode_hello(&hello, msg);
+        ret = send_full(&io, ctrl_fd, msg, HELLO_LEN);
+    }
+    if (ret == ETH_BENCH_OK) {
+        ret = recv_accept(&io, ctrl_fd);
+    }
+    if ((ret == ETH_BENCH_OK) && (config->proto == ETH_BENCH_PROTO_TCP)) {
+        ret = connect_to(&io, &addr, &data_fd);
+        if (ret == ETH_BENCH_OK) {
+            memcpy(msg, data_magic, 4);
+            put_le32(&msg[4], hello.test_id);
+            ret = send_full(&io, data_fd, msg, DATA_HELLO_LEN);
+        }
+    }
+
+    uint64_t cpu_start_us = cpu_now();
+    ticker_t ticker_buf;
+    ticker_t *ticker = NULL;
+    if ((config->on_interval != NULL) && (config->interval_ms > 0)) {
+        ticker_start(&ticker_buf, config);
+        ticker = &ticker_buf;
+    }
+    flow_t flow = {};
+    report_t peer = {};
+    if ((ret == ETH_BENCH_OK) && (config->dir == ETH_BENCH_DIR_SEND)) {
+        int64_t end_us = now_us() + (int64_t)config->duration_ms * 1000;
+        if (config->proto == ETH_BENCH_PROTO_TCP) {
+            ret = tcp_send(&io, data_fd, buf, config->block_len, end_us, &flow, ticker);
+        } else {
+            ret = udp_send(&io, udp_fd, NULL, hello.test_id, buf, config->block_len, config->rate_kbps, end_us,
+                           &flow, ticker);
+        }
+        if (ret == ETH_BENCH_OK) {
+            report_t report;
+            flow_report(&flow, 0, &report);
+            ret = send_report(&io, ctrl_fd, &report);
+        }
+        if (ret == ETH_BENCH_OK) {
+            ret = recv_report(&io, ctrl_fd, &peer);
+        }
+    } else if (ret == ETH_BENCH_OK) {
+        if (config->proto == ETH_BENCH_PROTO_TCP) {
+            ret = tcp_recv(&io, data_fd, buf, config->block_len, &flow, ticker);
+            if (ret == ETH_BENCH_OK) {
+                ret = recv_report(&io, ctrl_fd, &peer);
+            }
+        } else {
+            ret = udp_recv(&io, udp_fd, ctrl_fd, hello.test_id, buf, config->block_len, &flow, ticker, &peer);
+        }
+    }
+    ticker_update(ticker, &flow, true);
+
+    if (ret == ETH_BENCH_OK) {
+        report_t local;
+        flow_report(&flow, cpu_since(cpu_start_us), &local);
+        fill_result(config, &local, &peer, result);
+    }
+
+    if (data_fd >= 0) {
+        close(data_fd);
+    }
+    if (udp_fd >= 0) {
+        close(udp_fd);
+    }
+    if (ctrl_fd >= 0) {
+        close(ctrl_fd);
+    }
+    free(buf);
+    return ret;
+}
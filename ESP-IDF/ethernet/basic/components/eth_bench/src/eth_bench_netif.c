@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include "esp_eth_driver.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include "eth_bench_netif.h"
+
+/* The interfaces counted at once */
+#define COUNTERS_MAX                        (4)
+
+struct eth_bench_netif_t {
+    esp_eth_handle_t eth;
+    esp_netif_t *netif;
+    /* Guards the counters, updated by the RX task of the driver and by the TCP/IP task */
+    portMUX_TYPE lock;
+    eth_bench_netif_stats_t stats;
+};
+
+/* The transmit function of esp-netif only gets the driver, which is kept as the handle of the esp-netif for the
+ * other users of `esp_netif_get_io_driver()`, so its counters are looked up */
+static eth_bench_netif_t *counters_list[COUNTERS_MAX];
+static portMUX_TYPE list_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static eth_bench_netif_t *find_counters(void *eth)
+{
+    eth_bench_netif_t *found = NULL;
+
+    portENTER_CRITICAL(&list_lock);
+    for (int i = 0; i < COUNTERS_MAX; i++) {
+        if ((counters_list[i] != NULL) && (counters_list[i]->eth == eth)) {
+            found = counters_list[i];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&list_lock);
+    return found;
+}
+
+static bool add_counters(eth_bench_netif_t *counters)
+{
+    bool is_added = false;
+
+    portENTER_CRITICAL(&list_lock);
+    for (int i = 0; (i < COUNTERS_MAX) && !is_added; i++) {
+        if (counters_list[i] == NULL) {
+            counters_list[i] = counters;
+            is_added = true;
+        }
+    }
+    portEXIT_CRITICAL(&list_lock);
+    return is_added;
+}
+
+static void remove_counters(eth_bench_netif_t *counters)
+{
+    portENTER_CRITICAL(&list_lock);
+    for (int i = 0; i < COUNTERS_MAX; i++) {
+        if (counters_list[i] == counters) {
+            counters_list[i] = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&list_lock);
+}
+
+static esp_err_t counting_input(esp_eth_handle_t eth, uint8_t *buffer, uint32_t length, void *priv)
+{
+    eth_bench_netif_t *counters = (eth_bench_netif_t *)priv;
+
+    /* The buffer is freed by esp-netif, even when it's dropped */
+    esp_err_t ret = esp_netif_receive(counters->netif, buffer, length, NULL);
+
+    portENTER_CRITICAL(&counters->lock);
+    counters->stats.rx_packet_num++;
+    counters->stats.rx_byte_num += length;
+    if (ret == ESP_ERR_NO_MEM) {
+        counters->stats.rx_no_mem_num++;
+    } else if (ret != ESP_OK) {
+        counters->stats.rx_drop_num++;
+    }
+    portEXIT_CRITICAL(&counters->lock);
+    return ret;
+}
+
+/* The input path of the esp-netif glue */
+static esp_err_t forward_input(esp_eth_handle_t eth, uint8_t *buffer, uint32_t length, void *priv)
+{
+    return esp_netif_receive((esp_netif_t *)priv, buffer, length, NULL);
+}
+
+static esp_err_t counting_transmit(void *h, void *buffer, size_t len)
+{
+    esp_err_t ret = esp_eth_transmit(h, buffer, len);
+
+    eth_bench_netif_t *counters = find_counters(h);
+    if (counters != NULL) {
+        portENTER_CRITICAL(&counters->lock);
+        if (ret == ESP_OK) {
+            counters->stats.tx_packet_num++;
+            counters->stats.tx_byte_num += len;
+        } else {
+            counters->stats.tx_error_num++;
+            counters->stats.tx_no_mem_num += (ret == ESP_ERR_NO_MEM) ? 1 : 0;
+        }
+        portEXIT_CRITICAL(&counters->lock);
+    }
+    return ret;
+}
+
+/* The receive buffers of the Ethernet driver are from the heap, as for the esp-netif glue */
+static void free_rx_buffer(void *h, void *buffer)
+{
+    free(buffer);
+}
+
+static esp_err_t set_transmit(esp_netif_t *netif, esp_eth_handle_t eth,
+                              esp_err_t (*transmit)(void *h, void *buffer, size_t len))
+{
+    const esp_netif_driver_ifconfig_t driver_config = {
+        .handle = eth,
+        .transmit = transmit,
+        .driver_free_rx_buffer = free_rx_buffer,
+    };
+    return esp_netif_set_driver_config(netif, &driver_config);
+}
+
+esp_err_t eth_bench_netif_attach(esp_eth_handle_t eth, esp_netif_t *netif, eth_bench_netif_t **ret_counters)
+{
+    if ((eth == NULL) || (netif == NULL) || (ret_counters == NULL) || (find_counters(eth) != NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    eth_bench_netif_t *counters = calloc(1, sizeof(eth_bench_netif_t));
+    if (counters == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    counters->eth = eth;
+    counters->netif = netif;
+    portMUX_INITIALIZE(&counters->lock);
+    if (!add_counters(counters)) {
+        free(counters);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = set_transmit(netif, eth, counting_transmit);
+    if (ret == ESP_OK) {
+        ret = esp_eth_update_input_path(eth, counting_input, counters);
+    }
+    if (ret != ESP_OK) {
+        set_transmit(netif, eth, esp_eth_transmit);
+        remove_counters(counters);
+        free(counters);
+        return ret;
+    }
+
+    *ret_counters = counters;
+    return ESP_OK;
+}
+
+void eth_bench_netif_detach(eth_bench_netif_t *counters)
+{
+    if (counters == NULL) {
+        return;
+    }
+
+    esp_eth_update_input_path(counters->eth, forward_input, counters->netif);
+    set_transmit(counters->netif, counters->eth, esp_eth_transmit);
+    remove_counters(counters);
+    free(counters);
+}
+
+void eth_bench_netif_get_stats(eth_bench_netif_t *counters, eth_bench_netif_stats_t *stats)
+{
+    portENTER_CRITICAL(&counters->lock);
+    *stats = counters->stats;
+    portEXIT_CRITICAL(&counters->lock);
+}
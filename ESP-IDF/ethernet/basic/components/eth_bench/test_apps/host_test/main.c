@@ -0,0 +1,416 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Run the benchmark between a server and clients over the loopback, TCP and UDP in both directions, check the
+ * reports of both ends, the refused and the aborted tests, then measure the throughput and the CPU time per Mbit.
+ * See README.md.
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "eth_bench.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+#define TEST_HOST                   "127.0.0.1"
+#define TEST_DURATION_MS            (500)
+#define TEST_INTERVAL_MS            (100)
+#define TEST_UDP_KBPS               (50000)
+#define TEST_BENCH_MS               (1000)
+
+static const char *proto_name[] = {"TCP", "UDP"};
+static const char *dir_name[] = {"send", "recv"};
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_us(int64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = us / 1000000,
+        .tv_nsec = (long)(us % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+typedef struct {
+    int num;
+    uint64_t byte_num;
+    uint32_t packet_num;
+    uint32_t end_ms;
+    bool is_ordered;
+} test_intervals_t;
+
+static void on_interval(const eth_bench_interval_t *interval, void *user_data)
+{
+    test_intervals_t *intervals = (test_intervals_t *)user_data;
+
+    if ((interval->start_ms != intervals->end_ms) || (interval->end_ms < interval->start_ms)) {
+        intervals->is_ordered = false;
+    }
+    intervals->num++;
+    intervals->byte_num += interval->byte_num;
+    intervals->packet_num += interval->packet_num;
+    intervals->end_ms = interval->end_ms;
+}
+
+static eth_bench_server_t *new_server(uint16_t block_max, uint32_t timeout_ms)
+{
+    eth_bench_server_config_t config = ETH_BENCH_SERVER_DEFAULT_CONFIG();
+    config.port = 0;
+    config.block_max = block_max;
+    config.timeout_ms = timeout_ms;
+
+    eth_bench_server_t *server = NULL;
+    return (eth_bench_server_new(&config, &server) == ETH_BENCH_OK) ? server : NULL;
+}
+
+static eth_bench_client_config_t client_config(const eth_bench_server_t *server, eth_bench_proto_t proto,
+                                               eth_bench_dir_t dir, uint32_t duration_ms)
+{
+    eth_bench_client_config_t config = ETH_BENCH_CLIENT_DEFAULT_CONFIG();
+    config.host = TEST_HOST;
+    config.port = eth_bench_server_get_port(server);
+    config.proto = proto;
+    config.dir = dir;
+    config.duration_ms = duration_ms;
+    config.interval_ms = 0;
+    return config;
+}
+
+/* A TCP connection to a port of the loopback, or -1 */
+static int connect_raw(uint16_t port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if ((fd >= 0) && (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static bool wait_server_tests(eth_bench_server_t *server, uint32_t test_num, uint32_t error_num)
+{
+    eth_bench_server_stats_t stats;
+    for (int i = 0; i < 300; i++) {
+        eth_bench_server_get_stats(server, &stats);
+        if ((stats.test_num >= test_num) && (stats.error_num >= error_num)) {
+            return true;
+        }
+        sleep_us(10000);
+    }
+    return false;
+}
+
+static bool test_tcp(void)
+{
+    eth_bench_server_t *server = new_server(ETH_BENCH_BLOCK_MAX, 1000);
+    TEST_CHECK(server != NULL, "no server");
+
+    uint64_t server_bytes[2] = {};
+    for (int dir = ETH_BENCH_DIR_SEND; dir <= ETH_BENCH_DIR_RECV; dir++) {
+        test_intervals_t intervals = {.is_ordered = true};
+        eth_bench_client_config_t config = client_config(server, ETH_BENCH_PROTO_TCP, dir, TEST_DURATION_MS);
+        config.block_len = 4096;
+        config.interval_ms = TEST_INTERVAL_MS;
+        config.on_interval = on_interval;
+        config.user_data = &intervals;
+        eth_bench_result_t result;
+        int64_t start_us = now_us();
+        int ret = eth_bench_run(&config, &result);
+        int64_t elapsed_ms = (now_us() - start_us) / 1000;
+
+        TEST_CHECK(ret == ETH_BENCH_OK, "%s: %d", dir_name[dir], ret);
+        TEST_CHECK((elapsed_ms >= TEST_DURATION_MS) && (elapsed_ms < TEST_DURATION_MS + 500), "%s: %lld ms",
+                   dir_name[dir], (long long)elapsed_ms);
+        TEST_CHECK((result.byte_num > 0) && (result.byte_num == result.sent_byte_num),
+                   "%s: %llu bytes received, %llu sent", dir_name[dir], (unsigned long long)result.byte_num,
+                   (unsigned long long)result.sent_byte_num);
+        TEST_CHECK((result.packet_num > 0) && (result.sent_packet_num > 0) && (result.lost_num == 0) &&
+                   (result.out_of_order_num == 0), "%s: packets", dir_name[dir]);
+        TEST_CHECK((result.elapsed_us > 0) && (result.elapsed_us <= (TEST_DURATION_MS + 200) * 1000) &&
+                   (result.kbps == result.byte_num * 8000 / result.elapsed_us), "%s: %llu us, %u kbps", dir_name[dir],
+                   (unsigned long long)result.elapsed_us, result.kbps);
+        TEST_CHECK((result.cpu_us != ETH_BENCH_CPU_UNKNOWN) && (result.peer_cpu_us != ETH_BENCH_CPU_UNKNOWN) &&
+                   (result.cpu_us_per_mbit > 0), "%s: no CPU time", dir_name[dir]);
+
+        /* The intervals of the client follow each other, and add up to its bytes */
+        uint64_t client_bytes = (dir == ETH_BENCH_DIR_SEND) ? result.sent_byte_num : result.byte_num;
+        uint32_t client_packets = (dir == ETH_BENCH_DIR_SEND) ? result.sent_packet_num : result.packet_num;
+        TEST_CHECK((intervals.num >= TEST_DURATION_MS / TEST_INTERVAL_MS - 1) &&
+                   (intervals.num <= TEST_DURATION_MS / TEST_INTERVAL_MS + 2) && intervals.is_ordered &&
+                   (intervals.byte_num == client_bytes) && (intervals.packet_num == client_packets),
+                   "%s: %d intervals of %llu bytes", dir_name[dir], intervals.num,
+                   (unsigned long long)intervals.byte_num);
+        server_bytes[dir] = result.byte_num;
+        printf("TCP %s: %.1f Mbit/s, %u reads, %u us CPU per Mbit\n", dir_name[dir], result.kbps / 1000.0,
+               result.packet_num, result.cpu_us_per_mbit);
+    }
+
+    /* The server counts a test after its report */
+    TEST_CHECK(wait_server_tests(server, 2, 0), "tests not counted");
+    eth_bench_server_stats_t stats;
+    eth_bench_server_get_stats(server, &stats);
+    TEST_CHECK((stats.test_num == 2) && (stats.error_num == 0) && (stats.rx_byte_num == server_bytes[0]) &&
+               (stats.tx_byte_num == server_bytes[1]), "server stats: %u tests, %u errors", stats.test_num,
+               stats.error_num);
+    eth_bench_server_del(server);
+    return true;
+}
+
+static bool test_udp(void)
+{
+    eth_bench_server_t *server = new_server(ETH_BENCH_BLOCK_MAX, 1000);
+    TEST_CHECK(server != NULL, "no server");
+
+    for (int dir = ETH_BENCH_DIR_SEND; dir <= ETH_BENCH_DIR_RECV; dir++) {
+        eth_bench_client_config_t config = client_config(server, ETH_BENCH_PROTO_UDP, dir, TEST_DURATION_MS);
+        config.block_len = 1000;
+        config.rate_kbps = TEST_UDP_KBPS;
+        eth_bench_result_t result;
+        int ret = eth_bench_run(&config, &result);
+
+        TEST_CHECK(ret == ETH_BENCH_OK, "%s: %d", dir_name[dir], ret);
+        /* The datagrams of the rate, in the duration */
+        uint32_t expected = TEST_UDP_KBPS / 8 * TEST_DURATION_MS / config.block_len;
+        TEST_CHECK((result.sent_packet_num >= expected * 9 / 10) && (result.sent_packet_num <= expected * 11 / 10),
+                   "%s: %u datagrams sent, %u expected", dir_name[dir], result.sent_packet_num, expected);
+        TEST_CHECK(result.sent_byte_num == (uint64_t)result.sent_packet_num * config.block_len, "%s: sent bytes",
+                   dir_name[dir]);
+        TEST_CHECK((result.packet_num == result.sent_packet_num) && (result.byte_num == result.sent_byte_num) &&
+                   (result.lost_num == 0) && (result.out_of_order_num == 0), "%s: %u received, %u lost, %u late",
+                   dir_name[dir], result.packet_num, result.lost_num, result.out_of_order_num);
+        TEST_CHECK((result.kbps > TEST_UDP_KBPS * 9 / 10) && (result.kbps < TEST_UDP_KBPS * 11 / 10), "%s: %u kbps",
+                   dir_name[dir], result.kbps);
+        printf("UDP %s at %u kbps: %u datagrams, %u kbps received\n", dir_name[dir], TEST_UDP_KBPS,
+               result.packet_num, result.kbps);
+    }
+
+    /* As fast as possible, the loopback may drop some, but every datagram is received or lost */
+    for (int dir = ETH_BENCH_DIR_SEND; dir <= ETH_BENCH_DIR_RECV; dir++) {
+        eth_bench_client_config_t config = client_config(server, ETH_BENCH_PROTO_UDP, dir, 200);
+        eth_bench_result_t result;
+        int ret = eth_bench_run(&config, &result);
+
+        TEST_CHECK(ret == ETH_BENCH_OK, "flood %s: %d", dir_name[dir], ret);
+        TEST_CHECK((result.packet_num > 0) && (result.packet_num + result.lost_num == result.sent_packet_num) &&
+                   (result.out_of_order_num == 0), "flood %s: %u sent, %u received, %u lost", dir_name[dir],
+                   result.sent_packet_num, result.packet_num, result.lost_num);
+        printf("UDP %s flood: %u datagrams sent, %u lost\n", dir_name[dir], result.sent_packet_num, result.lost_num);
+    }
+
+    eth_bench_server_del(server);
+    return true;
+}
+
+static bool test_invalid(void)
+{
+    eth_bench_server_t *server = new_server(1024, 1000);
+    TEST_CHECK(server != NULL, "no server");
+    eth_bench_result_t result;
+
+    /* Refused by the client */
+    eth_bench_client_config_t config = client_config(server, ETH_BENCH_PROTO_TCP, ETH_BENCH_DIR_SEND, 100);
+    config.host = "not an address";
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_ERR_INVALID, "bad host");
+    config = client_config(server, ETH_BENCH_PROTO_TCP, ETH_BENCH_DIR_SEND, 100);
+    config.block_len = ETH_BENCH_BLOCK_MIN - 1;
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_ERR_INVALID, "short block");
+    config.block_len = 1024;
+    config.duration_ms = 0;
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_ERR_INVALID, "no duration");
+
+    /* Refused by the server, for a block over its buffer */
+    config = client_config(server, ETH_BENCH_PROTO_TCP, ETH_BENCH_DIR_SEND, 100);
+    config.block_len = 2048;
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_ERR_PROTOCOL, "large block");
+    TEST_CHECK(wait_server_tests(server, 0, 1), "large block not counted");
+
+    /* Not a client of the benchmark */
+    int fd = connect_raw(eth_bench_server_get_port(server));
+    TEST_CHECK(fd >= 0, "no connection");
+    static const char request[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    TEST_CHECK(send(fd, request, sizeof(request) - 1, 0) == sizeof(request) - 1, "send failed");
+    TEST_CHECK(wait_server_tests(server, 0, 2), "bad hello not counted");
+    close(fd);
+
+    /* Still serving */
+    config.block_len = 1024;
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_OK, "after errors");
+    TEST_CHECK(wait_server_tests(server, 1, 2), "test not counted");
+    eth_bench_server_stats_t stats;
+    eth_bench_server_get_stats(server, &stats);
+    TEST_CHECK((stats.test_num == 1) && (stats.error_num == 2), "%u tests, %u errors", stats.test_num,
+               stats.error_num);
+
+    /* No server */
+    uint16_t port = eth_bench_server_get_port(server);
+    eth_bench_server_del(server);
+    config.port = port;
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_ERR_SOCKET, "no server");
+    return true;
+}
+
+typedef struct {
+    uint16_t port;
+    int ret;
+    eth_bench_result_t result;
+} test_run_t;
+
+static void *run_main(void *arg)
+{
+    test_run_t *run = (test_run_t *)arg;
+    eth_bench_client_config_t config = ETH_BENCH_CLIENT_DEFAULT_CONFIG();
+    config.host = TEST_HOST;
+    config.port = run->port;
+    config.duration_ms = 10000;
+    config.timeout_ms = 500;
+    run->ret = eth_bench_run(&config, &run->result);
+    return NULL;
+}
+
+static bool test_timeout(void)
+{
+    eth_bench_server_t *server = new_server(ETH_BENCH_BLOCK_MAX, 200);
+    TEST_CHECK(server != NULL, "no server");
+
+    /* A client which never says hello is dropped after the timeout of the server */
+    int fd = connect_raw(eth_bench_server_get_port(server));
+    TEST_CHECK(fd >= 0, "no connection");
+    int64_t start_us = now_us();
+    TEST_CHECK(wait_server_tests(server, 0, 1), "silent client kept");
+    int64_t elapsed_ms = (now_us() - start_us) / 1000;
+    TEST_CHECK((elapsed_ms >= 150) && (elapsed_ms < 500), "silent client dropped after %lld ms",
+               (long long)elapsed_ms);
+    close(fd);
+
+    eth_bench_result_t result;
+    eth_bench_client_config_t config = client_config(server, ETH_BENCH_PROTO_UDP, ETH_BENCH_DIR_SEND, 100);
+    config.rate_kbps = TEST_UDP_KBPS;
+    TEST_CHECK(eth_bench_run(&config, &result) == ETH_BENCH_OK, "after a silent client");
+
+    /* A server deleted in a test stops at once, and its client fails */
+    test_run_t run = {.port = eth_bench_server_get_port(server)};
+    pthread_t thread;
+    TEST_CHECK(pthread_create(&thread, NULL, run_main, &run) == 0, "no thread");
+    sleep_us(200000);
+    start_us = now_us();
+    eth_bench_server_del(server);
+    elapsed_ms = (now_us() - start_us) / 1000;
+    pthread_join(thread, NULL);
+    TEST_CHECK(elapsed_ms < 500, "deleted in %lld ms", (long long)elapsed_ms);
+    TEST_CHECK((run.ret == ETH_BENCH_ERR_SOCKET) || (run.ret == ETH_BENCH_ERR_PROTOCOL) ||
+               (run.ret == ETH_BENCH_ERR_TIMEOUT), "client of a deleted server: %d", run.ret);
+
+    /* A server which accepts and never answers */
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+    TEST_CHECK((listen_fd >= 0) && (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) &&
+               (listen(listen_fd, 1) == 0) && (getsockname(listen_fd, (struct sockaddr *)&addr, &addr_len) == 0),
+               "no listener");
+    eth_bench_client_config_t mute_config = ETH_BENCH_CLIENT_DEFAULT_CONFIG();
+    mute_config.host = TEST_HOST;
+    mute_config.port = ntohs(addr.sin_port);
+    mute_config.timeout_ms = 300;
+    start_us = now_us();
+    int ret = eth_bench_run(&mute_config, &result);
+    elapsed_ms = (now_us() - start_us) / 1000;
+    close(listen_fd);
+    TEST_CHECK(ret == ETH_BENCH_ERR_TIMEOUT, "mute server: %d", ret);
+    TEST_CHECK((elapsed_ms >= 250) && (elapsed_ms < 600), "mute server: %lld ms", (long long)elapsed_ms);
+    return true;
+}
+
+static bool test_bench(void)
+{
+    static const struct {
+        eth_bench_proto_t proto;
+        uint16_t block_len;
+    } cases[] = {
+        {ETH_BENCH_PROTO_TCP, 512},
+        {ETH_BENCH_PROTO_TCP, 1460},
+        {ETH_BENCH_PROTO_TCP, 16384},
+        {ETH_BENCH_PROTO_UDP, 512},
+        {ETH_BENCH_PROTO_UDP, 1460},
+    };
+    eth_bench_server_t *server = new_server(ETH_BENCH_BLOCK_MAX, 1000);
+    TEST_CHECK(server != NULL, "no server");
+
+    printf("| Proto | Dir | Block | Mbit/s | Packets/s | CPU us/Mbit | Lost |\n");
+    printf("| --- | --- | --- | --- | --- | --- | --- |\n");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        for (int dir = ETH_BENCH_DIR_SEND; dir <= ETH_BENCH_DIR_RECV; dir++) {
+            eth_bench_client_config_t config = client_config(server, cases[i].proto, dir, TEST_BENCH_MS);
+            config.block_len = cases[i].block_len;
+            eth_bench_result_t result;
+            int ret = eth_bench_run(&config, &result);
+            TEST_CHECK((ret == ETH_BENCH_OK) && (result.byte_num > 0), "%s %s %u: %d", proto_name[cases[i].proto],
+                       dir_name[dir], cases[i].block_len, ret);
+            /* Both ends are in this process, so the CPU time of each one is the one of both */
+            printf("| %s | %s | %u | %.1f | %.0f | %u | %.2f%% |\n", proto_name[cases[i].proto], dir_name[dir],
+                   cases[i].block_len, result.kbps / 1000.0, result.packet_num * 1e6 / result.elapsed_us,
+                   result.cpu_us_per_mbit, 100.0 * result.lost_num / result.sent_packet_num);
+        }
+    }
+
+    eth_bench_server_del(server);
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"tcp", test_tcp},
+        {"udp", test_udp},
+        {"invalid", test_invalid},
+        {"timeout", test_timeout},
+        {"bench", test_bench},
+    };
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * The benchmark on a PC, as the server or the client of a board. See README.md.
+ */
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "eth_bench.h"
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s -s [-p port]\n"
+            "       %s -c host [-p port] [-u] [-R] [-t seconds] [-l block] [-b kbps]\n"
+            "  -s  serve tests until interrupted\n"
+            "  -c  run a test against the server at host\n"
+            "  -u  UDP instead of TCP\n"
+            "  -R  the server sends, the client receives\n"
+            "  -t  the time the source sends, 10 s by default\n"
+            "  -l  the bytes of a write, or of a UDP datagram, 1460 by default\n"
+            "  -b  the rate of a UDP source in kbit/s, 0 to send as fast as possible\n",
+            name, name);
+}
+
+static void print_interval(const eth_bench_interval_t *interval, void *user_data)
+{
+    (void)user_data;
+    printf("%6.1f - %6.1f s  %10llu bytes  %8.2f Mbit/s\n", interval->start_ms / 1000.0, interval->end_ms / 1000.0,
+           (unsigned long long)interval->byte_num, interval->kbps / 1000.0);
+}
+
+static int serve(uint16_t port)
+{
+    eth_bench_server_config_t config = ETH_BENCH_SERVER_DEFAULT_CONFIG();
+    config.port = port;
+    eth_bench_server_t *server = NULL;
+    int ret = eth_bench_server_new(&config, &server);
+    if (ret != ETH_BENCH_OK) {
+        fprintf(stderr, "server failed: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+    printf("serving on TCP and UDP port %u\n", eth_bench_server_get_port(server));
+
+    eth_bench_server_stats_t last = {};
+    while (true) {
+        sleep(1);
+        eth_bench_server_stats_t stats;
+        eth_bench_server_get_stats(server, &stats);
+        if ((stats.test_num != last.test_num) || (stats.error_num != last.error_num)) {
+            printf("%u tests, %u failed, %llu bytes received, %llu sent\n", stats.test_num, stats.error_num,
+                   (unsigned long long)stats.rx_byte_num, (unsigned long long)stats.tx_byte_num);
+            last = stats;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    eth_bench_client_config_t config = ETH_BENCH_CLIENT_DEFAULT_CONFIG();
+    config.on_interval = print_interval;
+    bool is_server = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "sc:p:uRt:l:b:")) != -1) {
+        switch (opt) {
+        case 's':
+            is_server = true;
+            break;
+        case 'c':
+            config.host = optarg;
+            break;
+        case 'p':
+            config.port = (uint16_t)atoi(optarg);
+            break;
+        case 'u':
+            config.proto = ETH_BENCH_PROTO_UDP;
+            break;
+        case 'R':
+            config.dir = ETH_BENCH_DIR_RECV;
+            break;
+        case 't':
+            config.duration_ms = (uint32_t)(atof(optarg) * 1000);
+            break;
+        case 'l':
+            config.block_len = (uint16_t)atoi(optarg);
+            break;
+        case 'b':
+            config.rate_kbps = (uint32_t)atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    if (is_server) {
+        return serve(config.port);
+    }
+    if (config.host == NULL) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    eth_bench_result_t result;
+    int ret = eth_bench_run(&config, &result);
+    if (ret != ETH_BENCH_OK) {
+        fprintf(stderr, "test failed: %d\n", ret);
+        return EXIT_FAILURE;
+    }
+    printf("%llu bytes in %.2f s: %.2f Mbit/s", (unsigned long long)result.byte_num, result.elapsed_us / 1e6,
+           result.kbps / 1000.0);
+    if (config.proto == ETH_BENCH_PROTO_UDP) {
+        printf(", %u of %u datagrams lost, %u out of order", result.lost_num, result.sent_packet_num,
+               result.out_of_order_num);
+    }
+    printf("\nCPU per Mbit: %u us here, ", result.cpu_us_per_mbit);
+    if (result.peer_cpu_us != ETH_BENCH_CPU_UNKNOWN) {
+        printf("%u us on the server\n", result.peer_cpu_us_per_mbit);
+    } else {
+        printf("unknown on the server\n");
+    }
+    return EXIT_SUCCESS;
+}
@@ -6,7 +6,9 @@
    software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
    CONDITIONS OF ANY KIND, either express or implied.
 */
+#include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -16,6 +18,10 @@
 #include "esp_log.h"
 #include "ethernet_init.h"
 #include "sdkconfig.h"
+#if CONFIG_EXAMPLE_ETH_BENCH
+#include "eth_bench.h"
+#include "eth_bench_netif.h"
+#endif
 
 static const char *TAG = "eth_example";
 
@@ -63,6 +69,125 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base,
     ESP_LOGI(TAG, "~~~~~~~~~~~");
 }
 
+#if CONFIG_EXAMPLE_ETH_BENCH
+#define BENCH_TASK_STACK_SIZE   (4096)
+#define BENCH_TASK_PRIO         (5)
+#define BENCH_RETRY_MS          (2000)
+
+typedef struct {
+    eth_bench_netif_t **counters;
+    uint8_t counter_num;
+} bench_stats_ctx_t;
+
+/** Log the frames of each Ethernet and the CPU load every period */
+static void bench_stats_task(void *arg)
+{
+    const bench_stats_ctx_t *ctx = (const bench_stats_ctx_t *)arg;
+    const float period_s = CONFIG_EXAMPLE_ETH_BENCH_STATS_PERIOD_MS / 1000.0f;
+    eth_bench_netif_stats_t last[ctx->counter_num];
+    memset(last, 0, sizeof(last));
+    uint64_t last_cpu_us = 0;
+    bool has_cpu = (eth_bench_get_cpu_us(&last_cpu_us) == ETH_BENCH_OK);
+    if (!has_cpu) {
+        ESP_LOGW(TAG, "CPU load unknown without the FreeRTOS run time statistics on esp_timer");
+    }
+
+    TickType_t wake_tick = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&wake_tick, pdMS_TO_TICKS(CONFIG_EXAMPLE_ETH_BENCH_STATS_PERIOD_MS));
+        uint64_t byte_num = 0;
+        for (int i = 0; i < ctx->counter_num; i++) {
+            eth_bench_netif_stats_t stats;
+            eth_bench_netif_get_stats(ctx->counters[i], &stats);
+            uint64_t rx_byte_num = stats.rx_byte_num - last[i].rx_byte_num;
+            uint64_t tx_byte_num = stats.tx_byte_num - last[i].tx_byte_num;
+            ESP_LOGI(TAG, "ETH_%d RX %.2f Mbit/s %.0f frames/s, TX %.2f Mbit/s %.0f frames/s, "
+                     "dropped %"PRIu32" RX queue full, %"PRIu32" RX no buffer, %"PRIu32" TX (%"PRIu32" no buffer)",
+                     i, rx_byte_num * 8 / 1e6 / period_s, (stats.rx_packet_num - last[i].rx_packet_num) / period_s,
+                     tx_byte_num * 8 / 1e6 / period_s, (stats.tx_packet_num - last[i].tx_packet_num) / period_s,
+                     stats.rx_drop_num - last[i].rx_drop_num, stats.rx_no_mem_num - last[i].rx_no_mem_num,
+                     stats.tx_error_num - last[i].tx_error_num, stats.tx_no_mem_num - last[i].tx_no_mem_num);
+            byte_num += rx_byte_num + tx_byte_num;
+            last[i] = stats;
+        }
+
+        uint64_t cpu_us;
+        if (has_cpu && (eth_bench_get_cpu_us(&cpu_us) == ETH_BENCH_OK)) {
+            float busy_us = cpu_us - last_cpu_us;
+            float mbit = byte_num * 8 / 1e6;
+            ESP_LOGI(TAG, "CPU %.1f%%, %.0f us per Mbit", 100.0f * busy_us / (period_s * 1e6 * portNUM_PROCESSORS),
+                     (mbit > 0) ? busy_us / mbit : 0);
+            last_cpu_us = cpu_us;
+        }
+    }
+}
+
+#if CONFIG_EXAMPLE_ETH_BENCH_CLIENT
+static void bench_log_interval(const eth_bench_interval_t *interval, void *user_data)
+{
+    ESP_LOGI(TAG, "%6.1f - %6.1f s: %.2f Mbit/s", interval->start_ms / 1000.0f, interval->end_ms / 1000.0f,
+             interval->kbps / 1000.0f);
+}
+
+/** Run the test against the server again and again, from the first IP address */
+static void bench_client_task(void *arg)
+{
+    eth_bench_client_config_t config = ETH_BENCH_CLIENT_DEFAULT_CONFIG();
+    config.host = CONFIG_EXAMPLE_ETH_BENCH_PEER;
+    config.port = CONFIG_EXAMPLE_ETH_BENCH_PORT;
+#if CONFIG_EXAMPLE_ETH_BENCH_UDP
+    config.proto = ETH_BENCH_PROTO_UDP;
+    config.rate_kbps = CONFIG_EXAMPLE_ETH_BENCH_RATE_KBPS;
+#endif
+#if CONFIG_EXAMPLE_ETH_BENCH_REVERSE
+    config.dir = ETH_BENCH_DIR_RECV;
+#endif
+    config.duration_ms = CONFIG_EXAMPLE_ETH_BENCH_DURATION_S * 1000;
+    config.block_len = CONFIG_EXAMPLE_ETH_BENCH_BLOCK_LEN;
+    config.on_interval = bench_log_interval;
+
+    while (1) {
+        eth_bench_result_t result;
+        int ret = eth_bench_run(&config, &result);
+        if (ret == ETH_BENCH_OK) {
+            ESP_LOGI(TAG, "%s %s %s: %.2f Mbit/s, %"PRIu32" of %"PRIu32" datagrams lost, "
+                     "%"PRIu32" us CPU per Mbit here, %"PRIu32" on the server",
+                     (config.proto == ETH_BENCH_PROTO_UDP) ? "UDP" : "TCP",
+                     (config.dir == ETH_BENCH_DIR_SEND) ? "to" : "from", config.host, result.kbps / 1000.0f,
+                     result.lost_num, result.sent_packet_num, result.cpu_us_per_mbit, result.peer_cpu_us_per_mbit);
+        } else {
+            ESP_LOGW(TAG, "Benchmark against %s failed: %d", config.host, ret);
+        }
+        vTaskDelay(pdMS_TO_TICKS(BENCH_RETRY_MS));
+    }
+}
+#endif // CONFIG_EXAMPLE_ETH_BENCH_CLIENT
+
+/** Count the frames of each Ethernet, and serve the benchmark or run it */
+static void bench_start(esp_eth_handle_t *eth_handles, esp_netif_t **eth_netifs, uint8_t eth_port_cnt)
+{
+    static bench_stats_ctx_t stats_ctx;
+    stats_ctx.counters = calloc(eth_port_cnt, sizeof(eth_bench_netif_t *));
+    stats_ctx.counter_num = eth_port_cnt;
+    assert(stats_ctx.counters);
+    for (int i = 0; i < eth_port_cnt; i++) {
+        ESP_ERROR_CHECK(eth_bench_netif_attach(eth_handles[i], eth_netifs[i], &stats_ctx.counters[i]));
+    }
+    xTaskCreate(bench_stats_task, "bench_stats", BENCH_TASK_STACK_SIZE, &stats_ctx, BENCH_TASK_PRIO, NULL);
+
+#if CONFIG_EXAMPLE_ETH_BENCH_SERVER
+    eth_bench_server_config_t config = ETH_BENCH_SERVER_DEFAULT_CONFIG();
+    config.port = CONFIG_EXAMPLE_ETH_BENCH_PORT;
+    eth_bench_server_t *server = NULL;
+    if (eth_bench_server_new(&config, &server) != ETH_BENCH_OK) {
+        ESP_LOGE(TAG, "Benchmark server failed");
+    }
+#else
+    xTaskCreate(bench_client_task, "bench_client", BENCH_TASK_STACK_SIZE, NULL, BENCH_TASK_PRIO, NULL);
+#endif
+}
+#endif // CONFIG_EXAMPLE_ETH_BENCH
+
 void app_main(void)
 {
     // Initialize Ethernet driver
@@ -121,6 +246,10 @@ void app_main(void)
         ESP_ERROR_CHECK(esp_eth_start(eth_handles[i]));
     }
 
+#if CONFIG_EXAMPLE_ETH_BENCH
+    bench_start(eth_handles, eth_netifs, eth_port_cnt);
+#endif
+
 #if CONFIG_EXAMPLE_ETH_DEINIT_AFTER_S >= 0
     // For demonstration purposes, wait and then deinit Ethernet network
     vTaskDelay(pdMS_TO_TICKS(CONFIG_EXAMPLE_ETH_DEINIT_AFTER_S * 1000));
@@ -51,6 +51,7 @@ typedef struct {
  *  STATIC PROTOTYPES
  **********************/
 
+static void screen_init(void);
 static void load_scene(uint32_t scene);
 static void next_scene_timer_cb(lv_timer_t * timer);
 
@@ -274,6 +275,43 @@ static void multiple_arcs_cb(void)
     }
 }
 
+static void multiple_box_shadows_cb(void)
+{
+    lv_obj_set_flex_flow(lv_screen_active(), LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_flex_align(lv_screen_active(), LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_SPACE_EVENLY);
+
+    /*Shadows of typical cards, buttons, message boxes and round buttons on the same screen*/
+    static const struct {
+        int32_t w;
+        int32_t h;
+        int32_t radius;
+        int32_t width;
+        int32_t spread;
+    } shadows[] = {
+        {150, 90, 12, 20, 0},
+        {120, 48, 8, 10, 2},
+        {180, 110, 16, 40, 4},
+        {64, 64, LV_RADIUS_CIRCLE, 15, 0},
+    };
+
+    uint32_t i;
+    for(i = 0; i < 12; i++) {
+        uint32_t s = i % (sizeof(shadows) / sizeof(shadows[0]));
+        lv_obj_t * obj = lv_obj_create(lv_screen_active());
+        lv_obj_remove_style_all(obj);
+        lv_obj_set_size(obj, shadows[s].w, shadows[s].h);
+        lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, 0);
+        lv_obj_set_style_bg_color(obj, lv_color_white(), 0);
+        lv_obj_set_style_radius(obj, shadows[s].radius, 0);
+        lv_obj_set_style_shadow_width(obj, shadows[s].width, 0);
+        lv_obj_set_style_shadow_spread(obj, shadows[s].spread, 0);
+        lv_obj_set_style_shadow_offset_y(obj, shadows[s].width / 4, 0);
+        lv_obj_set_style_shadow_opa(obj, LV_OPA_50, 0);
+
+        shake_anim(obj, 30);
+    }
+}
+
 static void containers_cb(void)
 {
 
@@ -409,6 +447,7 @@ static scene_dsc_t scenes[] = {
     {.name = "Multiple labels",            .scene_time = 3000, .create_cb = multiple_labels_cb},
     {.name = "Screen sized text",          .scene_time = 5000, .create_cb = screen_sized_text_cb},
     {.name = "Multiple arcs",              .scene_time = 3000, .create_cb = multiple_arcs_cb},
+    {.name = "Multiple box shadows",       .scene_time = 3000, .create_cb = multiple_box_shadows_cb},
 
     {.name = "Containers",                 .scene_time = 3000, .create_cb = containers_cb},
     {.name = "Containers with overlay",    .scene_time = 3000, .create_cb = containers_with_overlay_cb},
@@ -436,14 +475,7 @@ void lv_demo_benchmark(void)
 {
     scene_act = 0;
 
-    lv_obj_t * scr = lv_screen_active();
-    lv_obj_remove_style_all(scr);
-    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
-    lv_obj_set_style_text_color(scr, lv_color_black(), 0);
-    lv_obj_set_style_bg_color(scr, lv_palette_lighten(LV_PALETTE_GREY, 4), 0);
-    lv_obj_set_style_pad_all(lv_screen_active(), 8, 0);
-    lv_obj_set_style_pad_top(lv_screen_active(), 48, 0);
-    lv_obj_set_style_pad_gap(lv_screen_active(), 8, 0);
+    screen_init();
 
     lv_obj_t * title = lv_label_create(lv_layer_top());
     lv_obj_set_style_bg_opa(title, LV_OPA_COVER, 0);
@@ -466,10 +498,46 @@ void lv_demo_benchmark(void)
 #endif
 }
 
+uint32_t lv_demo_benchmark_get_scene_count(void)
+{
+    uint32_t cnt = 0;
+    while(scenes[cnt].create_cb) cnt++;
+
+    return cnt;
+}
+
+const char * lv_demo_benchmark_get_scene_name(uint32_t scene)
+{
+    if(scene >= lv_demo_benchmark_get_scene_count()) return NULL;
+
+    return scenes[scene].name;
+}
+
+void lv_demo_benchmark_load_scene(uint32_t scene)
+{
+    if(scene >= lv_demo_benchmark_get_scene_count()) return;
+
+    scene_act = scene;
+    screen_init();
+    load_scene(scene);
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+static void screen_init(void)
+{
+    lv_obj_t * scr = lv_screen_active();
+    lv_obj_remove_style_all(scr);
+    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+    lv_obj_set_style_text_color(scr, lv_color_black(), 0);
+    lv_obj_set_style_bg_color(scr, lv_palette_lighten(LV_PALETTE_GREY, 4), 0);
+    lv_obj_set_style_pad_all(lv_screen_active(), 8, 0);
+    lv_obj_set_style_pad_top(lv_screen_active(), 48, 0);
+    lv_obj_set_style_pad_gap(lv_screen_active(), 8, 0);
+}
+
 static void load_scene(uint32_t scene)
 {
     lv_obj_t * scr = lv_screen_active();
@@ -50,6 +50,26 @@ extern "C" {
  */
 void lv_demo_benchmark(void);
 
+/**
+ * Get the number of benchmark scenes.
+ * @return      the number of scenes
+ */
+uint32_t lv_demo_benchmark_get_scene_count(void);
+
+/**
+ * Get the name of a benchmark scene.
+ * @param scene index of the scene
+ * @return      the name of the scene or NULL if `scene` is out of range
+ */
+const char * lv_demo_benchmark_get_scene_name(uint32_t scene);
+
+/**
+ * Load a single benchmark scene on the active screen without starting the scene timer.
+ * Useful to measure the scenes one by one, e.g. from a headless runner which drives the ticks itself.
+ * @param scene index of the scene
+ */
+void lv_demo_benchmark_load_scene(uint32_t scene);
+
 /**********************
  *      MACROS
  **********************/
@@ -171,9 +171,13 @@
     #if LV_DRAW_SW_COMPLEX == 1
         /*Allow buffering some shadow calculation.
         *LV_DRAW_SW_SHADOW_CACHE_SIZE is the max. shadow size to buffer, where shadow size is `shadow_width + radius`
-        *Caching has LV_DRAW_SW_SHADOW_CACHE_SIZE^2 RAM cost*/
+        *Caching a shadow has shadow size^2 RAM cost*/
         #define LV_DRAW_SW_SHADOW_CACHE_SIZE 0
 
+        /*Max. RAM used by the cached shadows in bytes. Shadows with different sizes, radii or
+        *spreads are cached separately, the least recently used ones are dropped first.*/
+        #define LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE (4 * LV_DRAW_SW_SHADOW_CACHE_SIZE * LV_DRAW_SW_SHADOW_CACHE_SIZE)
+
         /* Set number of maximally cached circle data.
         * The circumference of 1/4 circle are saved for anti-aliasing
         * radius * 4 bytes are used per circle (the most often used radiuses are saved)
@@ -365,6 +369,17 @@
  *If size is 0, the cache function is not enabled and the decoded mem will be released immediately after use.*/
 #define LV_CACHE_DEF_SIZE       0
 
+/*1: Use a scan resistant eviction policy for the image cache instead of LRU.
+ *Images used only once (e.g. while scrolling through many icons) can't flush
+ *the images which are used repeatedly. See `lv_cache_class_clock_rb_size`.*/
+#define LV_IMAGE_CACHE_SCAN_RESISTANT   0
+
+/*Number of threads decoding images which are not in the image cache yet. 0: decode while drawing.
+ *Until an image is decoded a placeholder is drawn and its area is redrawn when it's ready,
+ *so a large image scrolling into view doesn't stall the frame.
+ *Requires `LV_USE_OS` and the image cache (`LV_CACHE_DEF_SIZE > 0`).*/
+#define LV_IMAGE_DECODER_ASYNC_THREAD_CNT   0
+
 /*Default number of image header cache entries. The cache is used to store the headers of images
  *The main logic is like `LV_CACHE_DEF_SIZE` but for image headers.*/
 #define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
@@ -792,6 +807,14 @@
 #if LV_USE_GIF
     /*GIF decoder accelerate*/
     #define LV_GIF_CACHE_DECODE_DATA 0
+
+    /*1: Decode the next frame of each GIF on its own thread while the current one is shown.
+     *Needs one more `4 x width x height` frame buffer per GIF. Requires `LV_USE_OS`.*/
+    #define LV_GIF_DECODE_THREAD 0
+
+    /*Max. bytes of composed frames cached per GIF. A looping GIF whose frames fit is
+     *played from the cached frames after its first loop without decoding. 0: disable*/
+    #define LV_GIF_FRAME_CACHE_SIZE 0
 #endif
 
 
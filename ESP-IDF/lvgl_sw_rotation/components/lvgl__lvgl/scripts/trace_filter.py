@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import argparse
+import json
 import re
 from pathlib import Path
 
@@ -12,18 +13,45 @@ def get_arg():
     parser.add_argument('log_file', metavar='log_file', type=str,
                         help='The input log file to process.')
     parser.add_argument('trace_file', metavar='trace_file', type=str, nargs='?',
-                        help='The output trace file. If not provided, defaults to \'<log_file>.systrace\'.')
+                        help='The output trace file. If not provided, defaults to \'<log_file>.systrace\' '
+                             'or \'<log_file>.json\'.')
+    parser.add_argument('--format', choices=['systrace', 'json'], default='systrace',
+                        help='The output format: \'systrace\' (ftrace text) or \'json\' (Chrome trace event format, '
+                             'can be loaded by chrome://tracing and Perfetto). Defaults to \'systrace\'.')
 
     args = parser.parse_args()
     return args
 
 
+def to_chrome_trace(lines):
+    # '   LVGL-<tid> [<cpu>] <sec>.<usec>: tracing_mark_write: <B|E>|<pid>|<name>'
+    line_pattern = re.compile(r'^.+-([0-9]+)\s\[([0-9]+)]\s([0-9]+)\.([0-9]+):\s\S+:\s([BE])\|([0-9]+)\|(.+)$')
+
+    events = []
+    for line in lines:
+        m = line_pattern.match(line)
+        if not m:
+            continue
+        tid, cpu, sec, usec, ph, pid, name = m.groups()
+        events.append({
+            'name': name,
+            'ph': ph,
+            'ts': int(sec) * 1000000 + int(usec),
+            'pid': int(pid),
+            'tid': int(tid),
+            'args': {'cpu': int(cpu)},
+        })
+
+    return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+
 if __name__ == '__main__':
     args = get_arg()
 
     if not args.trace_file:
         log_file = Path(args.log_file)
-        args.trace_file = log_file.with_suffix('.systrace').as_posix()
+        suffix = '.json' if args.format == 'json' else '.systrace'
+        args.trace_file = log_file.with_suffix(suffix).as_posix()
 
     print('log_file  :', args.log_file)
     print('trace_file:', args.trace_file)
@@ -32,7 +60,7 @@ if __name__ == '__main__':
         content = f.read()
 
     # compile regex pattern
-    pattern = re.compile(r'(^.+-[0-9]+\s\[[0-9]]\s[0-9]+\.[0-9]+:\s('
+    pattern = re.compile(r'(^.+-[0-9]+\s\[[0-9]+]\s[0-9]+\.[0-9]+:\s('
                          + "|".join(MARK_LIST)
                          + r'):\s[B|E]\|[0-9]+\|.+$)', re.M)
 
@@ -40,6 +68,9 @@ if __name__ == '__main__':
 
     # write to args.trace_file
     with open(args.trace_file, 'w') as f:
-        f.write('# tracer: nop\n#\n')
-        for match in matches:
-            f.write(match[0] + '\n')
+        if args.format == 'json':
+            json.dump(to_chrome_trace([match[0] for match in matches]), f)
+        else:
+            f.write('# tracer: nop\n#\n')
+            for match in matches:
+                f.write(match[0] + '\n')
@@ -45,6 +45,7 @@ extern "C" {
 #include "../tick/lv_tick_private.h"
 #include "../draw/lv_draw_buf_private.h"
 #include "../draw/lv_draw_private.h"
+#include "../draw/lv_image_decoder_private.h"
 #include "../draw/sw/lv_draw_sw_private.h"
 #include "../draw/sw/lv_draw_sw_mask_private.h"
 #include "../stdlib/builtin/lv_tlsf_private.h"
@@ -83,6 +84,7 @@ typedef struct lv_global_t {
     lv_ll_t disp_ll;
     lv_display_t * disp_refresh;
     lv_display_t * disp_default;
+    uint32_t refr_cnt;          /**< Incremented by every refresh of a display, e.g. to tell the frames apart */
 
     lv_ll_t style_trans_ll;
     bool style_refresh;
@@ -120,14 +122,20 @@ typedef struct lv_global_t {
 
     lv_cache_t * img_cache;
     lv_cache_t * img_header_cache;
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+    lv_image_decoder_async_t img_decoder_async;
+#endif
 
     lv_draw_global_info_t draw_info;
 #if defined(LV_DRAW_SW_SHADOW_CACHE_SIZE) && LV_DRAW_SW_SHADOW_CACHE_SIZE > 0
-    lv_draw_sw_shadow_cache_t sw_shadow_cache;
+    lv_cache_t * sw_shadow_cache;
 #endif
 #if LV_DRAW_SW_COMPLEX
     lv_draw_sw_mask_radius_circle_dsc_arr_t sw_circle_cache;
 #endif
+#if LV_USE_DRAW_SW
+    uint32_t sw_blend_px_cnt;
+#endif
 
 #if LV_USE_LOG
     lv_log_print_g_cb_t custom_log_print_cb;
@@ -39,7 +39,10 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static void lv_refr_join_area(void);
+static void lv_refr_join_area(lv_display_t * disp);
+static void lv_refr_split_area(void);
+static uint32_t inv_area_cost(const lv_area_t * area_p);
+static int8_t inv_area_subtract(lv_area_t res_p[], const lv_area_t * a1_p, const lv_area_t * a2_p);
 static void refr_invalid_areas(void);
 static void refr_sync_areas(void);
 static void refr_area(const lv_area_t * area_p);
@@ -315,14 +318,28 @@ void lv_inv_area(lv_display_t * disp, const lv_area_t * area_p)
         if(lv_area_is_in(&com_area, &disp->inv_areas[i], 0) != false) return;
     }
 
-    /*Save the area*/
-    lv_area_t * tmp_area_p = &com_area;
-    if(disp->inv_p >= LV_INV_BUF_SIZE) { /*If no place for the area add the screen*/
-        disp->inv_p = 0;
-        tmp_area_p = &scr_area;
+    /*If there is no place for the area join the saved areas to make room*/
+    if(disp->inv_p >= LV_INV_BUF_SIZE) lv_refr_join_area(disp);
+
+    /*If there is still no place join the new area with the saved area which grows the least*/
+    if(disp->inv_p >= LV_INV_BUF_SIZE) {
+        uint32_t best_i = 0;
+        uint32_t best_cost = UINT32_MAX;
+        lv_area_t joined_area;
+        for(i = 0; i < disp->inv_p; i++) {
+            lv_area_join(&joined_area, &disp->inv_areas[i], &com_area);
+            uint32_t cost = inv_area_cost(&joined_area) - inv_area_cost(&disp->inv_areas[i]);
+            if(cost < best_cost) {
+                best_cost = cost;
+                best_i = i;
+            }
+        }
+        lv_area_join(&disp->inv_areas[best_i], &disp->inv_areas[best_i], &com_area);
+    }
+    else {
+        lv_area_copy(&disp->inv_areas[disp->inv_p], &com_area);
+        disp->inv_p++;
     }
-    lv_area_copy(&disp->inv_areas[disp->inv_p], tmp_area_p);
-    disp->inv_p++;
 
     lv_display_send_event(disp, LV_EVENT_REFR_REQUEST, NULL);
 }
@@ -374,7 +391,9 @@ void lv_display_refr_timer(lv_timer_t * tmr)
         return;
     }
 
+    LV_GLOBAL_DEFAULT()->refr_cnt++;
     lv_display_send_event(disp_refr, LV_EVENT_REFR_START, NULL);
+    disp_refr->refr_px_cnt = 0;
 
     /*Refresh the screen's layout if required*/
     LV_PROFILER_BEGIN_TAG("layout");
@@ -393,7 +412,8 @@ void lv_display_refr_timer(lv_timer_t * tmr)
         goto refr_finish;
     }
 
-    lv_refr_join_area();
+    lv_refr_join_area(disp_refr);
+    lv_refr_split_area();
     refr_sync_areas();
     refr_invalid_areas();
 
@@ -436,44 +456,159 @@ refr_finish:
  **********************/
 
 /**
- * Join the areas which has got common parts
+ * Join the invalidated areas if rendering their bounding box is cheaper than rendering them one by one.
+ * The joined areas are removed from `inv_areas`, so `inv_area_joined` is cleared when it returns.
+ * If the remaining areas would cost more than the whole screen, the whole screen is invalidated instead.
+ * @param disp  pointer to a display
  */
-static void lv_refr_join_area(void)
+static void lv_refr_join_area(lv_display_t * disp)
 {
     LV_PROFILER_BEGIN;
     uint32_t join_from;
     uint32_t join_in;
     lv_area_t joined_area;
-    for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
-        if(disp_refr->inv_area_joined[join_in] != 0) continue;
+    lv_area_t common_area;
+    bool joined;
 
-        /*Check all areas to join them in 'join_in'*/
-        for(join_from = 0; join_from < disp_refr->inv_p; join_from++) {
-            /*Handle only unjoined areas and ignore itself*/
-            if(disp_refr->inv_area_joined[join_from] != 0 || join_in == join_from) {
-                continue;
+    /*Joining two areas creates a larger area which might be worth joining with an other area,
+     *so repeat until nothing can be joined*/
+    do {
+        joined = false;
+        for(join_in = 0; join_in < disp->inv_p; join_in++) {
+            if(disp->inv_area_joined[join_in] != 0) continue;
+
+            /*Check all areas to join them in 'join_in'*/
+            for(join_from = join_in + 1; join_from < disp->inv_p; join_from++) {
+                /*Handle only unjoined areas*/
+                if(disp->inv_area_joined[join_from] != 0) continue;
+
+                lv_area_t * in_p = &disp->inv_areas[join_in];
+                lv_area_t * from_p = &disp->inv_areas[join_from];
+                lv_area_join(&joined_area, in_p, from_p);
+
+                /*The common part will be rendered only once (see `lv_refr_split_area`)*/
+                uint32_t separate_cost = inv_area_cost(in_p) + inv_area_cost(from_p);
+                if(lv_area_intersect(&common_area, in_p, from_p)) separate_cost -= lv_area_get_size(&common_area);
+
+                /*Join the two areas only if rendering the joined area is cheaper*/
+                if(inv_area_cost(&joined_area) <= separate_cost) {
+                    lv_area_copy(in_p, &joined_area);
+
+                    /*Mark 'join_form' is joined into 'join_in'*/
+                    disp->inv_area_joined[join_from] = 1;
+                    joined = true;
+                }
             }
+        }
+    } while(joined);
 
-            /*Check if the areas are on each other*/
-            if(lv_area_is_on(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]) == false) {
-                continue;
-            }
+    /*Remove the joined areas and sum the cost of the remaining ones*/
+    uint32_t i;
+    uint32_t cnt = 0;
+    uint64_t total_cost = 0;
+    for(i = 0; i < disp->inv_p; i++) {
+        if(disp->inv_area_joined[i]) {
+            disp->inv_area_joined[i] = 0;
+            continue;
+        }
+        disp->inv_areas[cnt] = disp->inv_areas[i];
+        total_cost += inv_area_cost(&disp->inv_areas[cnt]);
+        cnt++;
+    }
+    disp->inv_p = cnt;
+
+    /*Render the screen in one go if it's cheaper*/
+    lv_area_t scr_area;
+    scr_area.x1 = 0;
+    scr_area.y1 = 0;
+    scr_area.x2 = lv_display_get_horizontal_resolution(disp) - 1;
+    scr_area.y2 = lv_display_get_vertical_resolution(disp) - 1;
+    if(disp->inv_p > 1 && total_cost >= inv_area_cost(&scr_area)) {
+        disp->inv_areas[0] = scr_area;
+        disp->inv_p = 1;
+    }
 
-            lv_area_join(&joined_area, &disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]);
+    LV_PROFILER_END;
+}
 
-            /*Join two area only if the joined area size is smaller*/
-            if(lv_area_get_size(&joined_area) < (lv_area_get_size(&disp_refr->inv_areas[join_in]) +
-                                                 lv_area_get_size(&disp_refr->inv_areas[join_from]))) {
-                lv_area_copy(&disp_refr->inv_areas[join_in], &joined_area);
+/**
+ * Split the overlapping invalidated areas so that no pixel is rendered twice.
+ * The part of an area covered by an earlier area is cut out and the remaining bands are added as new areas.
+ * If there is no place for the new areas the overlapping area is kept as it is.
+ */
+static void lv_refr_split_area(void)
+{
+    LV_PROFILER_BEGIN;
+    uint32_t i;
+    uint32_t j;
+    lv_area_t res[4];
+    for(i = 0; i < disp_refr->inv_p; i++) {
+        for(j = i + 1; j < disp_refr->inv_p; j++) {
+            int8_t res_c = inv_area_subtract(res, &disp_refr->inv_areas[j], &disp_refr->inv_areas[i]);
+            if(res_c < 0) continue; /*No common parts*/
+            if(disp_refr->inv_p + res_c - 1 > LV_INV_BUF_SIZE) continue;
+
+            if(res_c == 0) {
+                /*Entirely covered: replace it with the last area*/
+                disp_refr->inv_areas[j] = disp_refr->inv_areas[disp_refr->inv_p - 1];
+                disp_refr->inv_p--;
+                j--;
+                continue;
+            }
 
-                /*Mark 'join_form' is joined into 'join_in'*/
-                disp_refr->inv_area_joined[join_from] = 1;
+            /*The pieces are inside the original area so they don't overlap the areas before `i` either*/
+            disp_refr->inv_areas[j] = res[0];
+            int8_t r;
+            for(r = 1; r < res_c; r++) {
+                disp_refr->inv_areas[disp_refr->inv_p] = res[r];
+                disp_refr->inv_p++;
             }
         }
     }
     LV_PROFILER_END;
 }
 
+/**
+ * Get the cost of rendering and flushing an area, measured in pixels
+ * @param area_p    pointer to an area
+ * @return          size of the area plus the fixed overhead of an area
+ */
+static uint32_t inv_area_cost(const lv_area_t * area_p)
+{
+    return lv_area_get_size(area_p) + LV_INV_AREA_OVERHEAD;
+}
+
+/**
+ * Remove the common part of two areas from the first area.
+ * Unlike `lv_area_diff` the results don't overlap each other or the second area:
+ * the full width top and bottom bands come first, then the left and right parts next to the common part.
+ * @param res_p     pointer to an array of areas with a count of 4, the resulting areas will be stored here
+ * @param a1_p      pointer to the first area
+ * @param a2_p      pointer to the second area
+ * @return          number of results (max 4) or -1 if no intersect
+ */
+static int8_t inv_area_subtract(lv_area_t res_p[], const lv_area_t * a1_p, const lv_area_t * a2_p)
+{
+    lv_area_t common;
+    if(!lv_area_intersect(&common, a1_p, a2_p)) return -1;
+
+    int8_t res_c = 0;
+    if(a1_p->y1 < common.y1) {
+        lv_area_set(&res_p[res_c++], a1_p->x1, a1_p->y1, a1_p->x2, common.y1 - 1);
+    }
+    if(a1_p->y2 > common.y2) {
+        lv_area_set(&res_p[res_c++], a1_p->x1, common.y2 + 1, a1_p->x2, a1_p->y2);
+    }
+    if(a1_p->x1 < common.x1) {
+        lv_area_set(&res_p[res_c++], a1_p->x1, common.y1, common.x1 - 1, common.y2);
+    }
+    if(a1_p->x2 > common.x2) {
+        lv_area_set(&res_p[res_c++], common.x2 + 1, common.y1, a1_p->x2, common.y2);
+    }
+
+    return res_c;
+}
+
 /**
  * Refresh the sync areas
  */
@@ -584,6 +719,7 @@ static void refr_invalid_areas(void)
             if(i == last_i) disp_refr->last_area = 1;
             disp_refr->last_part = 0;
             refr_area(&disp_refr->inv_areas[i]);
+            disp_refr->refr_px_cnt += lv_area_get_size(&disp_refr->inv_areas[i]);
         }
     }
 
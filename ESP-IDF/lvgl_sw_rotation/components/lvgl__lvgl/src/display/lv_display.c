@@ -852,6 +852,14 @@ uint32_t lv_display_get_inactive_time(const lv_display_t * disp)
     return t;
 }
 
+uint32_t lv_display_get_refr_px_count(const lv_display_t * disp)
+{
+    if(disp == NULL) disp = lv_display_get_default();
+    if(disp == NULL) return 0;
+
+    return disp->refr_px_cnt;
+}
+
 void lv_display_trigger_activity(lv_display_t * disp)
 {
     if(!disp) disp = lv_display_get_default();
@@ -486,6 +486,14 @@ lv_theme_t * lv_display_get_theme(lv_display_t * disp);
  */
 uint32_t lv_display_get_inactive_time(const lv_display_t * disp);
 
+/**
+ * Get the number of pixels rendered during the last refresh of a display.
+ * Useful to see how much of the screen is redrawn by an update.
+ * @param disp      pointer to a display (NULL to use the default display)
+ * @return          number of rendered pixels (0 if nothing was rendered)
+ */
+uint32_t lv_display_get_refr_px_count(const lv_display_t * disp);
+
 /**
  * Manually trigger an activity on a display
  * @param disp      pointer to a display (NULL to use the default display)
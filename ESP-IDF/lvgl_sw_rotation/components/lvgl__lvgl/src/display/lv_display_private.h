@@ -29,6 +29,12 @@ extern "C" {
 #define LV_INV_BUF_SIZE 32 /**< Buffer size for invalid areas */
 #endif
 
+#ifndef LV_INV_AREA_OVERHEAD
+/** Fixed cost of rendering and flushing an invalid area, in pixels (layer setup, flush call, setting the
+ * display's window, etc.). Invalid areas are joined if the extra pixels cost less than the saved overhead.*/
+#define LV_INV_AREA_OVERHEAD 1024
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -103,6 +109,9 @@ struct lv_display_t {
     uint32_t inv_p;
     int32_t inv_en_cnt;
 
+    /** Number of pixels rendered during the last refresh*/
+    uint32_t refr_px_cnt;
+
     /** Double buffer sync areas (redrawn during last refresh) */
     lv_ll_t sync_areas;
 
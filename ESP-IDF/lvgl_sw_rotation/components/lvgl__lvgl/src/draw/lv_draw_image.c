@@ -13,7 +13,9 @@
 #include "../display/lv_display.h"
 #include "../misc/lv_log.h"
 #include "../misc/lv_math.h"
-#include "../core/lv_refr.h"
+#include "../core/lv_refr_private.h"
+#include "../display/lv_display_private.h"
+#include "lv_draw_rect.h"
 #include "../stdlib/lv_mem.h"
 #include "../stdlib/lv_string.h"
 
@@ -34,6 +36,11 @@ static void img_decode_and_draw(lv_draw_unit_t * draw_unit, const lv_draw_image_
                                 const lv_area_t * img_area, const lv_area_t * clipped_img_area,
                                 lv_draw_image_core_cb draw_core_cb);
 
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+static bool decode_async(lv_layer_t * layer, const lv_draw_image_dsc_t * dsc, const lv_area_t * real_area);
+static void draw_placeholder(lv_layer_t * layer, const lv_draw_image_dsc_t * dsc, const lv_area_t * coords);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -111,13 +118,25 @@ void lv_draw_image(lv_layer_t * layer, const lv_draw_image_dsc_t * dsc, const lv
         return;
     }
 
+    lv_area_t real_area;
+    lv_image_buf_get_transformed_area(&real_area, lv_area_get_width(coords), lv_area_get_height(coords),
+                                      dsc->rotation, dsc->scale_x, dsc->scale_y, &dsc->pivot);
+    lv_area_move(&real_area, coords->x1, coords->y1);
+
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+    /*Don't wait for the decoder, its area will be redrawn when the image is ready*/
+    if(decode_async(layer, new_image_dsc, &real_area)) {
+        draw_placeholder(layer, new_image_dsc, coords);
+        lv_free(new_image_dsc);
+        LV_PROFILER_END;
+        return;
+    }
+#endif
+
     lv_draw_task_t * t = lv_draw_add_task(layer, coords);
     t->draw_dsc = new_image_dsc;
     t->type = LV_DRAW_TASK_TYPE_IMAGE;
-
-    lv_image_buf_get_transformed_area(&t->_real_area, lv_area_get_width(coords), lv_area_get_height(coords),
-                                      dsc->rotation, dsc->scale_x, dsc->scale_y, &dsc->pivot);
-    lv_area_move(&t->_real_area, coords->x1, coords->y1);
+    t->_real_area = real_area;
 
     lv_draw_finalize_task_creation(layer, t);
     LV_PROFILER_END;
@@ -312,3 +331,39 @@ static void img_decode_and_draw(lv_draw_unit_t * draw_unit, const lv_draw_image_
         }
     }
 }
+
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+static bool decode_async(lv_layer_t * layer, const lv_draw_image_dsc_t * dsc, const lv_area_t * real_area)
+{
+    /*Only when refreshing a display. E.g. a canvas or a snapshot needs the image immediately.*/
+    lv_display_t * disp = lv_refr_get_disp_refreshing();
+    if(disp == NULL || !disp->rendering_in_progress) return false;
+
+    lv_layer_t * root = layer;
+    while(root->parent) root = root->parent;
+    if(root != disp->layer_head) return false;
+
+    /*The area on the display is unknown in transformed layers, redraw the whole display then*/
+    lv_area_t inv_area;
+    const lv_area_t * inv_area_p = NULL;
+    if(layer == root && lv_area_intersect(&inv_area, real_area, &layer->_clip_area)) inv_area_p = &inv_area;
+
+    return lv_image_decoder_async_request(dsc->src, disp, inv_area_p);
+}
+
+static void draw_placeholder(lv_layer_t * layer, const lv_draw_image_dsc_t * dsc, const lv_area_t * coords)
+{
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    rect_dsc.bg_color = lv_color_hex3(0x888);
+    rect_dsc.bg_opa = LV_OPA_MIX2(dsc->opa, LV_OPA_30);
+    rect_dsc.radius = dsc->clip_radius;
+
+    lv_area_t area;
+    if(lv_area_get_width(&dsc->image_area) >= 0) area = dsc->image_area;
+    else area = *coords;
+    if(!lv_area_intersect(&area, &area, coords)) return;
+
+    lv_draw_rect(layer, &rect_dsc, &area);
+}
+#endif
@@ -10,8 +10,12 @@
 #include "../misc/lv_assert.h"
 #include "../draw/lv_draw_image.h"
 #include "../misc/lv_ll.h"
+#include "../misc/lv_area_private.h"
 #include "../stdlib/lv_string.h"
 #include "../core/lv_global.h"
+#include "../core/lv_refr_private.h"
+#include "../display/lv_display.h"
+#include "../misc/lv_timer.h"
 
 /*********************
  *      DEFINES
@@ -20,6 +24,14 @@
 #define img_cache_p (LV_GLOBAL_DEFAULT()->img_cache)
 #define img_header_cache_p (LV_GLOBAL_DEFAULT()->img_header_cache)
 #define image_cache_draw_buf_handlers &(LV_GLOBAL_DEFAULT()->image_cache_draw_buf_handlers)
+#define img_decoder_async_p (&(LV_GLOBAL_DEFAULT()->img_decoder_async))
+
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0 && LV_USE_OS == LV_OS_NONE
+    #error "LV_IMAGE_DECODER_ASYNC_THREAD_CNT requires LV_USE_OS"
+#endif
+
+/*Remember at most this many images which need to be decoded while drawing*/
+#define ASYNC_SYNC_JOB_MAX      16
 
 /**********************
  *      TYPEDEFS
@@ -41,6 +53,16 @@ static lv_image_decoder_t * image_decoder_get_info(lv_image_decoder_dsc_t * dsc,
 
 static lv_result_t try_cache(lv_image_decoder_dsc_t * dsc);
 
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+static void async_init(void);
+static void async_deinit(void);
+static bool async_is_cached(const void * src, lv_image_src_t src_type);
+static lv_image_decoder_async_job_t * async_find_job(const void * src, lv_image_src_t src_type);
+static void async_thread_cb(void * user_data);
+static void async_timer_cb(lv_timer_t * timer);
+static void async_job_delete(lv_image_decoder_async_job_t * job);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -63,6 +85,10 @@ void lv_image_decoder_init(uint32_t image_cache_size, uint32_t image_header_coun
     /*Initialize the cache*/
     lv_image_cache_init(image_cache_size);
     lv_image_header_cache_init(image_header_count);
+
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+    async_init();
+#endif
 }
 
 /**
@@ -70,6 +96,11 @@ void lv_image_decoder_init(uint32_t image_cache_size, uint32_t image_header_coun
  */
 void lv_image_decoder_deinit(void)
 {
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+    /*Stop the threads first as they might be using the cache*/
+    async_deinit();
+#endif
+
     lv_cache_destroy(img_cache_p, NULL);
     lv_cache_destroy(img_header_cache_p, NULL);
 
@@ -94,6 +125,8 @@ lv_result_t lv_image_decoder_open(lv_image_decoder_dsc_t * dsc, const void * src
     lv_memzero(dsc, sizeof(lv_image_decoder_dsc_t));
 
     if(src == NULL) return LV_RESULT_INVALID;
+
+    LV_PROFILER_BEGIN;
     dsc->src = src;
     dsc->src_type = lv_image_src_get_type(src);
 
@@ -104,13 +137,19 @@ lv_result_t lv_image_decoder_open(lv_image_decoder_dsc_t * dsc, const void * src
             /*
             * Check the cache first
             * If the image is found in the cache, just return it.*/
-            if(try_cache(dsc) == LV_RESULT_OK) return LV_RESULT_OK;
+            if(try_cache(dsc) == LV_RESULT_OK) {
+                LV_PROFILER_END;
+                return LV_RESULT_OK;
+            }
         }
     }
 
     /*Find the decoder that can open the image source, and get the header info in the same time.*/
     dsc->decoder = image_decoder_get_info(dsc, &dsc->header);
-    if(dsc->decoder == NULL) return LV_RESULT_INVALID;
+    if(dsc->decoder == NULL) {
+        LV_PROFILER_END;
+        return LV_RESULT_INVALID;
+    }
 
     /*Make a copy of args*/
     dsc->args = args ? *args : (lv_image_decoder_args_t) {
@@ -126,7 +165,9 @@ lv_result_t lv_image_decoder_open(lv_image_decoder_dsc_t * dsc, const void * src
      * If decoder open failed, free the source and return error.
      * If decoder open succeed, add the image to cache if enabled.
      * */
+    LV_PROFILER_BEGIN_TAG("image_decode");
     lv_result_t res = dsc->decoder->open_cb(dsc->decoder, dsc);
+    LV_PROFILER_END_TAG("image_decode");
 
     /* Flush the D-Cache if enabled and the image was successfully opened */
     if(dsc->args.flush_cache && res == LV_RESULT_OK && dsc->decoded != NULL) {
@@ -140,15 +181,18 @@ lv_result_t lv_image_decoder_open(lv_image_decoder_dsc_t * dsc, const void * src
                     dsc->decoded->header.cf);
     }
 
+    LV_PROFILER_END;
     return res;
 }
 
 lv_result_t lv_image_decoder_get_area(lv_image_decoder_dsc_t * dsc, const lv_area_t * full_area,
                                       lv_area_t * decoded_area)
 {
+    LV_PROFILER_BEGIN;
     lv_result_t res = LV_RESULT_INVALID;
     if(dsc->decoder->get_area_cb) res = dsc->decoder->get_area_cb(dsc->decoder, dsc, full_area, decoded_area);
 
+    LV_PROFILER_END;
     return res;
 }
 
@@ -286,6 +330,116 @@ lv_draw_buf_t * lv_image_decoder_post_process(lv_image_decoder_dsc_t * dsc, lv_d
     return decoded;
 }
 
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+
+void lv_image_decoder_set_async(bool en)
+{
+    img_decoder_async_p->enabled = en;
+}
+
+bool lv_image_decoder_get_async(void)
+{
+    return img_decoder_async_p->enabled;
+}
+
+uint32_t lv_image_decoder_get_async_pending_count(void)
+{
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+    uint32_t cnt = 0;
+
+    lv_mutex_lock(&async->mutex);
+    lv_image_decoder_async_job_t * job;
+    LV_LL_READ(&async->job_ll, job) {
+        if(job->state != LV_IMAGE_DECODER_ASYNC_JOB_SYNC) cnt++;
+    }
+    lv_mutex_unlock(&async->mutex);
+
+    return cnt;
+}
+
+bool lv_image_decoder_async_request(const void * src, lv_display_t * disp, const lv_area_t * inv_area)
+{
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+    if(!async->enabled || !lv_image_cache_is_enabled()) return false;
+
+    lv_image_src_t src_type = lv_image_src_get_type(src);
+    if(src_type == LV_IMAGE_SRC_VARIABLE) {
+        /*Plain pixel arrays are drawn directly, only encoded or compressed data is decoded*/
+        const lv_image_header_t * header = &((const lv_image_dsc_t *)src)->header;
+        if(header->cf != LV_COLOR_FORMAT_RAW && header->cf != LV_COLOR_FORMAT_RAW_ALPHA &&
+           !(header->flags & LV_IMAGE_FLAGS_COMPRESSED)) return false;
+    }
+    else if(src_type != LV_IMAGE_SRC_FILE) {
+        return false;
+    }
+
+    if(async_is_cached(src, src_type)) return false;
+
+    LV_PROFILER_BEGIN;
+    lv_mutex_lock(&async->mutex);
+
+    lv_image_decoder_async_job_t * job = async_find_job(src, src_type);
+    if(job && job->state == LV_IMAGE_DECODER_ASYNC_JOB_SYNC) {
+        lv_mutex_unlock(&async->mutex);
+        LV_PROFILER_END;
+        return false;
+    }
+
+    if(job) {
+        /*Drawn again or at multiple places before it was decoded*/
+        if(job->disp != disp) job->disp = NULL;
+        if(inv_area == NULL || job->disp == NULL) lv_area_set(&job->inv_area, 0, 0, -1, -1);
+        else if(lv_area_get_size(&job->inv_area) > 0) lv_area_join(&job->inv_area, &job->inv_area, inv_area);
+
+        lv_mutex_unlock(&async->mutex);
+        LV_PROFILER_END;
+        return true;
+    }
+
+    job = lv_ll_ins_tail(&async->job_ll);
+    LV_ASSERT_MALLOC(job);
+    if(job == NULL) {
+        lv_mutex_unlock(&async->mutex);
+        LV_PROFILER_END;
+        return false;
+    }
+
+    job->src_type = src_type;
+    job->src = src_type == LV_IMAGE_SRC_FILE ? lv_strdup(src) : src;
+    job->disp = disp;
+    job->state = LV_IMAGE_DECODER_ASYNC_JOB_QUEUED;
+    /*An empty area means the whole display*/
+    if(inv_area) job->inv_area = *inv_area;
+    else lv_area_set(&job->inv_area, 0, 0, -1, -1);
+
+    lv_mutex_unlock(&async->mutex);
+
+    /*Start the threads only when they are needed first*/
+    if(!async->started) {
+        uint32_t i;
+        for(i = 0; i < LV_IMAGE_DECODER_ASYNC_THREAD_CNT; i++) {
+            lv_thread_sync_init(&async->syncs[i]);
+            lv_thread_init(&async->threads[i], LV_THREAD_PRIO_LOW, async_thread_cb, LV_DRAW_THREAD_STACK_SIZE,
+                           &async->syncs[i]);
+        }
+        async->timer = lv_timer_create(async_timer_cb, LV_DEF_REFR_PERIOD, NULL);
+        async->started = true;
+    }
+    else {
+        lv_timer_resume(async->timer);
+    }
+
+    uint32_t i;
+    for(i = 0; i < LV_IMAGE_DECODER_ASYNC_THREAD_CNT; i++) {
+        lv_thread_sync_signal(&async->syncs[i]);
+    }
+
+    LV_PROFILER_END;
+    return true;
+}
+
+#endif /*LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0*/
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -413,3 +567,173 @@ static lv_result_t try_cache(lv_image_decoder_dsc_t * dsc)
 
     return LV_RESULT_INVALID;
 }
+
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+
+static void async_init(void)
+{
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+    lv_memzero(async, sizeof(lv_image_decoder_async_t));
+    lv_ll_init(&async->job_ll, sizeof(lv_image_decoder_async_job_t));
+    lv_mutex_init(&async->mutex);
+    async->enabled = true;
+}
+
+static void async_deinit(void)
+{
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+
+    if(async->started) {
+        lv_mutex_lock(&async->mutex);
+        async->exit = true;
+        lv_mutex_unlock(&async->mutex);
+
+        uint32_t i;
+        for(i = 0; i < LV_IMAGE_DECODER_ASYNC_THREAD_CNT; i++) {
+            lv_thread_sync_signal(&async->syncs[i]);
+            lv_thread_delete(&async->threads[i]);
+            lv_thread_sync_delete(&async->syncs[i]);
+        }
+
+        lv_timer_delete(async->timer);
+        async->started = false;
+    }
+
+    lv_image_decoder_async_job_t * job = lv_ll_get_head(&async->job_ll);
+    while(job) {
+        lv_image_decoder_async_job_t * job_next = lv_ll_get_next(&async->job_ll, job);
+        async_job_delete(job);
+        job = job_next;
+    }
+
+    lv_mutex_delete(&async->mutex);
+}
+
+static bool async_is_cached(const void * src, lv_image_src_t src_type)
+{
+    lv_image_cache_data_t search_key;
+    search_key.src_type = src_type;
+    search_key.src = src;
+
+    /*Only a peek: the draw which follows is the one counted and seen by the cache's policy*/
+    return lv_cache_contains(img_cache_p, &search_key, NULL);
+}
+
+static lv_image_decoder_async_job_t * async_find_job(const void * src, lv_image_src_t src_type)
+{
+    lv_image_decoder_async_job_t * job;
+    LV_LL_READ(&img_decoder_async_p->job_ll, job) {
+        if(job->src_type != src_type) continue;
+        if(src_type == LV_IMAGE_SRC_FILE) {
+            if(lv_strcmp(job->src, src) == 0) return job;
+        }
+        else if(job->src == src) {
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+static void async_thread_cb(void * user_data)
+{
+    lv_thread_sync_t * sync = user_data;
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+
+    while(1) {
+        lv_mutex_lock(&async->mutex);
+        if(async->exit) {
+            lv_mutex_unlock(&async->mutex);
+            break;
+        }
+
+        lv_image_decoder_async_job_t * job;
+        LV_LL_READ(&async->job_ll, job) {
+            if(job->state == LV_IMAGE_DECODER_ASYNC_JOB_QUEUED) break;
+        }
+        if(job) job->state = LV_IMAGE_DECODER_ASYNC_JOB_DECODING;
+        lv_mutex_unlock(&async->mutex);
+
+        if(job == NULL) {
+            lv_thread_sync_wait(sync);
+            continue;
+        }
+
+        /*The job can't be deleted while it's being decoded so it's safe to use it unlocked*/
+        LV_PROFILER_BEGIN_TAG("image_decode_async");
+        lv_image_decoder_dsc_t dsc;
+        lv_result_t res = lv_image_decoder_open(&dsc, job->src, NULL);
+        /*If the decoder didn't add it to the cache there is nothing to wait for*/
+        bool cached = res == LV_RESULT_OK && dsc.cache_entry != NULL;
+        if(res == LV_RESULT_OK) lv_image_decoder_close(&dsc);
+        LV_PROFILER_END_TAG("image_decode_async");
+
+        lv_mutex_lock(&async->mutex);
+        job->state = cached ? LV_IMAGE_DECODER_ASYNC_JOB_CACHED : LV_IMAGE_DECODER_ASYNC_JOB_NOT_CACHED;
+        lv_mutex_unlock(&async->mutex);
+    }
+}
+
+static void async_timer_cb(lv_timer_t * timer)
+{
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+    uint32_t pending_cnt = 0;
+    uint32_t sync_cnt = 0;
+
+    lv_mutex_lock(&async->mutex);
+
+    lv_image_decoder_async_job_t * job = lv_ll_get_head(&async->job_ll);
+    while(job) {
+        lv_image_decoder_async_job_t * job_next = lv_ll_get_next(&async->job_ll, job);
+        if(job->state == LV_IMAGE_DECODER_ASYNC_JOB_CACHED || job->state == LV_IMAGE_DECODER_ASYNC_JOB_NOT_CACHED) {
+            /*Redraw the placeholders. The display might have been deleted since then.*/
+            lv_display_t * disp = lv_display_get_next(NULL);
+            while(disp) {
+                if(job->disp == NULL || job->disp == disp) {
+                    lv_inv_area(disp, lv_area_get_size(&job->inv_area) > 0 ? &job->inv_area : NULL);
+                }
+                disp = lv_display_get_next(disp);
+            }
+
+            if(job->state == LV_IMAGE_DECODER_ASYNC_JOB_CACHED) {
+                async_job_delete(job);
+            }
+            else {
+                job->state = LV_IMAGE_DECODER_ASYNC_JOB_SYNC;
+                sync_cnt++;
+            }
+        }
+        else if(job->state == LV_IMAGE_DECODER_ASYNC_JOB_SYNC) {
+            sync_cnt++;
+        }
+        else {
+            pending_cnt++;
+        }
+        job = job_next;
+    }
+
+    /*Forget the oldest images which are decoded while drawing*/
+    job = lv_ll_get_head(&async->job_ll);
+    while(job && sync_cnt > ASYNC_SYNC_JOB_MAX) {
+        lv_image_decoder_async_job_t * job_next = lv_ll_get_next(&async->job_ll, job);
+        if(job->state == LV_IMAGE_DECODER_ASYNC_JOB_SYNC) {
+            async_job_delete(job);
+            sync_cnt--;
+        }
+        job = job_next;
+    }
+
+    lv_mutex_unlock(&async->mutex);
+
+    if(pending_cnt == 0) lv_timer_pause(timer);
+}
+
+static void async_job_delete(lv_image_decoder_async_job_t * job)
+{
+    lv_image_decoder_async_t * async = img_decoder_async_p;
+    if(job->src_type == LV_IMAGE_SRC_FILE) lv_free((void *)job->src);
+    lv_ll_remove(&async->job_ll, job);
+    lv_free(job);
+}
+
+#endif /*LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0*/
@@ -183,6 +183,31 @@ lv_cache_entry_t * lv_image_decoder_add_to_cache(lv_image_decoder_t * decoder,
  */
 lv_draw_buf_t * lv_image_decoder_post_process(lv_image_decoder_dsc_t * dsc, lv_draw_buf_t * decoded);
 
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+
+/**
+ * Enable or disable decoding images in the background.
+ * If enabled, images missing from the image cache are decoded on `LV_IMAGE_DECODER_ASYNC_THREAD_CNT`
+ * threads and a placeholder is drawn until they are ready. Enabled by default.
+ * @param en        true: decode in the background; false: decode while drawing
+ */
+void lv_image_decoder_set_async(bool en);
+
+/**
+ * Check if images are decoded in the background
+ * @return          true: images are decoded in the background
+ */
+bool lv_image_decoder_get_async(void);
+
+/**
+ * Get the number of images which are waiting to be decoded in the background
+ * or are decoded but their area is not invalidated yet.
+ * @return          number of pending images
+ */
+uint32_t lv_image_decoder_get_async_pending_count(void);
+
+#endif /*LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0*/
+
 /**********************
  *      MACROS
  **********************/
@@ -15,6 +15,8 @@ extern "C" {
  *********************/
 
 #include "lv_image_decoder.h"
+#include "../misc/lv_ll.h"
+#include "../osal/lv_os.h"
 
 /*********************
  *      DEFINES
@@ -115,6 +117,35 @@ struct lv_image_decoder_dsc_t {
 };
 
 
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+typedef enum {
+    LV_IMAGE_DECODER_ASYNC_JOB_QUEUED,      /**< Waiting for a thread */
+    LV_IMAGE_DECODER_ASYNC_JOB_DECODING,    /**< A thread is decoding it */
+    LV_IMAGE_DECODER_ASYNC_JOB_CACHED,      /**< In the cache, its area needs to be invalidated */
+    LV_IMAGE_DECODER_ASYNC_JOB_NOT_CACHED,  /**< Not cached by its decoder, its area needs to be invalidated */
+    LV_IMAGE_DECODER_ASYNC_JOB_SYNC,        /**< Not cached by its decoder, decode it while drawing */
+} lv_image_decoder_async_job_state_t;
+
+typedef struct {
+    const void * src;           /**< File names are duplicated */
+    lv_image_src_t src_type;
+    lv_display_t * disp;        /**< Display to invalidate or NULL to invalidate all displays */
+    lv_area_t inv_area;         /**< Area to invalidate when the image is decoded */
+    lv_image_decoder_async_job_state_t state;
+} lv_image_decoder_async_job_t;
+
+typedef struct {
+    lv_thread_t threads[LV_IMAGE_DECODER_ASYNC_THREAD_CNT];
+    lv_thread_sync_t syncs[LV_IMAGE_DECODER_ASYNC_THREAD_CNT];
+    lv_mutex_t mutex;           /**< Protects `job_ll` and the jobs' state */
+    lv_ll_t job_ll;             /**< lv_image_decoder_async_job_t, oldest first */
+    lv_timer_t * timer;         /**< Invalidates the decoded images' area on the main thread */
+    bool enabled;
+    bool started;
+    bool exit;
+} lv_image_decoder_async_t;
+#endif
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -131,6 +162,19 @@ void lv_image_decoder_init(uint32_t image_cache_size, uint32_t image_header_coun
  */
 void lv_image_decoder_deinit(void);
 
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+/**
+ * Start decoding an image in the background if it's not in the image cache yet.
+ * Called from the main thread when a draw task is created for the image.
+ * @param src       the image source
+ * @param disp      display to redraw when the image is decoded or NULL to redraw all displays
+ * @param inv_area  area to invalidate when the image is decoded or NULL to invalidate the whole display
+ * @return          true: the image is not decoded yet, draw a placeholder instead;
+ *                  false: draw the image normally
+ */
+bool lv_image_decoder_async_request(const void * src, lv_display_t * disp, const lv_area_t * inv_area);
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -10,6 +10,7 @@
 #include "lv_draw_sw_blend_private.h"
 #include "../../lv_draw_private.h"
 #include "../lv_draw_sw.h"
+#include "../../../core/lv_global.h"
 #if LV_DRAW_SW_SUPPORT_L8
     #include "lv_draw_sw_blend_to_l8.h"
 #endif
@@ -33,6 +34,7 @@
 /*********************
  *      DEFINES
  *********************/
+#define blend_px_cnt LV_GLOBAL_DEFAULT()->sw_blend_px_cnt
 
 /**********************
  *      TYPEDEFS
@@ -67,6 +69,8 @@ void lv_draw_sw_blend(lv_draw_unit_t * draw_unit, const lv_draw_sw_blend_dsc_t *
     uint32_t layer_stride_byte = layer->draw_buf->header.stride;
 
     if(blend_dsc->src_buf == NULL) {
+        blend_px_cnt += lv_area_get_size(&blend_area);
+
         lv_draw_sw_blend_fill_dsc_t fill_dsc;
         fill_dsc.dest_w = lv_area_get_width(&blend_area);
         fill_dsc.dest_h = lv_area_get_height(&blend_area);
@@ -140,6 +144,8 @@ void lv_draw_sw_blend(lv_draw_unit_t * draw_unit, const lv_draw_sw_blend_dsc_t *
             return;
         }
 
+        blend_px_cnt += lv_area_get_size(&blend_area);
+
         lv_draw_sw_blend_image_dsc_t image_dsc;
         image_dsc.dest_w = lv_area_get_width(&blend_area);
         image_dsc.dest_h = lv_area_get_height(&blend_area);
@@ -221,6 +227,11 @@ void lv_draw_sw_blend(lv_draw_unit_t * draw_unit, const lv_draw_sw_blend_dsc_t *
     LV_PROFILER_END;
 }
 
+uint32_t lv_draw_sw_blend_get_px_count(void)
+{
+    return blend_px_cnt;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -39,6 +39,14 @@ extern "C" {
  */
 void lv_draw_sw_blend(lv_draw_unit_t * draw_unit, const lv_draw_sw_blend_dsc_t * dsc);
 
+/**
+ * Get the number of pixels blended by the SW renderer since `lv_init()`.
+ * The counter is increased by the size of the blended area on every blend call and wraps around on overflow,
+ * so use the difference of two readings to measure the blending workload of a period.
+ * @return          the number of blended pixels
+ */
+uint32_t lv_draw_sw_blend_get_px_count(void);
+
 /**********************
  *      MACROS
  **********************/
@@ -166,6 +166,9 @@ void lv_draw_sw_init(void)
 
 #if LV_DRAW_SW_COMPLEX == 1
     lv_draw_sw_mask_init();
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE
+    lv_draw_sw_shadow_cache_init();
+#endif
 #endif
 
     uint32_t i;
@@ -193,6 +196,9 @@ void lv_draw_sw_deinit(void)
 #endif
 
 #if LV_DRAW_SW_COMPLEX == 1
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE
+    lv_draw_sw_shadow_cache_deinit();
+#endif
     lv_draw_sw_mask_deinit();
 #endif
 }
@@ -20,6 +20,7 @@ extern "C" {
 #include "../../misc/lv_color.h"
 #include "../../display/lv_display.h"
 #include "../../osal/lv_os.h"
+#include "../../misc/cache/lv_cache.h"
 
 #include "../lv_draw_vector.h"
 #include "../lv_draw_triangle.h"
@@ -71,6 +72,27 @@ void lv_draw_sw_border(lv_draw_unit_t * draw_unit, const lv_draw_border_dsc_t *
  */
 void lv_draw_sw_box_shadow(lv_draw_unit_t * draw_unit, const lv_draw_box_shadow_dsc_t * dsc, const lv_area_t * coords);
 
+#if LV_DRAW_SW_COMPLEX && LV_DRAW_SW_SHADOW_CACHE_SIZE
+/**
+ * Resize the cache of the blurred shadow corners.
+ * If set to 0, the cache is disabled.
+ * @param size      new max size of the cache in bytes
+ * @param evict_now true: evict the corners which don't fit anymore, false: wait for the next cache cleanup
+ */
+void lv_draw_sw_shadow_cache_resize(uint32_t size, bool evict_now);
+
+/**
+ * Drop all the cached shadow corners.
+ */
+void lv_draw_sw_shadow_cache_drop_all(void);
+
+/**
+ * Get the hit, miss and eviction counters of the shadow cache.
+ * @param stats     pointer to a statistics struct to fill
+ */
+void lv_draw_sw_shadow_cache_get_stats(lv_cache_stats_t * stats);
+#endif
+
 /**
  * Draw an image with SW render. It handles image decoding, tiling, transformations, and recoloring.
  * @param draw_unit     pointer to a draw unit
@@ -29,7 +29,8 @@
 #define SHADOW_ENHANCE          1
 
 #if defined(LV_DRAW_SW_SHADOW_CACHE_SIZE) && LV_DRAW_SW_SHADOW_CACHE_SIZE > 0
-    #define shadow_cache LV_GLOBAL_DEFAULT()->sw_shadow_cache
+    #define shadow_cache_p LV_GLOBAL_DEFAULT()->sw_shadow_cache
+    #define SHADOW_CACHE_NAME   "SW_SHADOW"
 #endif
 
 /**********************
@@ -43,6 +44,14 @@ static void /* LV_ATTRIBUTE_FAST_MEM */ shadow_draw_corner_buf(const lv_area_t *
                                                                int32_t r);
 static void /* LV_ATTRIBUTE_FAST_MEM */ shadow_blur_corner(int32_t size, int32_t sw, uint16_t * sh_ups_buf);
 
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE
+static lv_opa_t * shadow_cache_get(const lv_area_t * core_area, int32_t corner_size, int32_t r);
+static lv_cache_compare_res_t shadow_cache_compare_cb(const lv_draw_sw_shadow_cache_data_t * lhs,
+                                                      const lv_draw_sw_shadow_cache_data_t * rhs);
+static bool shadow_cache_create_cb(lv_draw_sw_shadow_cache_data_t * data, void * user_data);
+static void shadow_cache_free_cb(lv_draw_sw_shadow_cache_data_t * data, void * user_data);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -55,6 +64,48 @@ static void /* LV_ATTRIBUTE_FAST_MEM */ shadow_blur_corner(int32_t size, int32_t
  *   GLOBAL FUNCTIONS
  **********************/
 
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE
+void lv_draw_sw_shadow_cache_init(void)
+{
+    if(shadow_cache_p != NULL) return;
+
+    shadow_cache_p = lv_cache_create(&lv_cache_class_lru_rb_size,
+    sizeof(lv_draw_sw_shadow_cache_data_t), LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE, (lv_cache_ops_t) {
+        .compare_cb = (lv_cache_compare_cb_t) shadow_cache_compare_cb,
+        .create_cb = (lv_cache_create_cb_t) shadow_cache_create_cb,
+        .free_cb = (lv_cache_free_cb_t) shadow_cache_free_cb
+    });
+
+    lv_cache_set_name(shadow_cache_p, SHADOW_CACHE_NAME);
+}
+
+void lv_draw_sw_shadow_cache_deinit(void)
+{
+    if(shadow_cache_p == NULL) return;
+
+    lv_cache_destroy(shadow_cache_p, NULL);
+    shadow_cache_p = NULL;
+}
+
+void lv_draw_sw_shadow_cache_resize(uint32_t size, bool evict_now)
+{
+    lv_cache_set_max_size(shadow_cache_p, size, NULL);
+    if(evict_now) {
+        lv_cache_reserve(shadow_cache_p, size, NULL);
+    }
+}
+
+void lv_draw_sw_shadow_cache_drop_all(void)
+{
+    lv_cache_drop_all(shadow_cache_p, NULL);
+}
+
+void lv_draw_sw_shadow_cache_get_stats(lv_cache_stats_t * stats)
+{
+    lv_cache_get_stats(shadow_cache_p, stats);
+}
+#endif /*LV_DRAW_SW_SHADOW_CACHE_SIZE*/
+
 void lv_draw_sw_box_shadow(lv_draw_unit_t * draw_unit, const lv_draw_box_shadow_dsc_t * dsc, const lv_area_t * coords)
 {
     /*Calculate the rectangle which is blurred to get the shadow in `shadow_area`*/
@@ -97,31 +148,18 @@ void lv_draw_sw_box_shadow(lv_draw_unit_t * draw_unit, const lv_draw_box_shadow_
     /*Get how many pixels are affected by the blur on the corners*/
     int32_t corner_size = dsc->width  + r_sh;
 
-    lv_opa_t * sh_buf;
+    lv_opa_t * sh_buf = NULL;
 
 #if LV_DRAW_SW_SHADOW_CACHE_SIZE
-    lv_draw_sw_shadow_cache_t * cache = &shadow_cache;
-    if(cache->cache_size == corner_size && cache->cache_r == r_sh) {
-        /*Use the cache if available*/
-        sh_buf = lv_malloc(corner_size * corner_size);
-        lv_memcpy(sh_buf, cache->cache, corner_size * corner_size);
-    }
-    else {
+    /*Use a copy of the cached corner as it's mirrored in place while drawing*/
+    sh_buf = shadow_cache_get(&core_area, corner_size, r_sh);
+#endif /*LV_DRAW_SW_SHADOW_CACHE_SIZE*/
+
+    if(sh_buf == NULL) {
         /*A larger buffer is required for calculation*/
         sh_buf = lv_malloc(corner_size * corner_size * sizeof(uint16_t));
         shadow_draw_corner_buf(&core_area, (uint16_t *)sh_buf, dsc->width, r_sh);
-
-        /*Cache the corner if it fits into the cache size*/
-        if((uint32_t)corner_size * corner_size < sizeof(cache->cache)) {
-            lv_memcpy(cache->cache, sh_buf, corner_size * corner_size);
-            cache->cache_size = corner_size;
-            cache->cache_r = r_sh;
-        }
     }
-#else
-    sh_buf = lv_malloc(corner_size * corner_size * sizeof(uint16_t));
-    shadow_draw_corner_buf(&core_area, (uint16_t *)sh_buf, dsc->width, r_sh);
-#endif /*LV_DRAW_SW_SHADOW_CACHE_SIZE*/
 
     /*Skip a lot of masking if the background will cover the shadow that would be masked out*/
     bool simple = dsc->bg_cover;
@@ -727,6 +765,79 @@ static void LV_ATTRIBUTE_FAST_MEM shadow_blur_corner(int32_t size, int32_t sw, u
     lv_free(sh_ups_blur_buf);
 }
 
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE
+/**
+ * Get a copy of a blurred corner from the shadow cache, calculate and add it if it's not cached yet.
+ * @param core_area     the rectangle which is blurred
+ * @param corner_size   the width and height of the corner
+ * @param r             the clamped radius
+ * @return              a copy of the cached corner which needs to be freed, or NULL if it can't be cached
+ */
+static lv_opa_t * shadow_cache_get(const lv_area_t * core_area, int32_t corner_size, int32_t r)
+{
+    uint32_t buf_size = (uint32_t)corner_size * corner_size;
+    if(corner_size > LV_DRAW_SW_SHADOW_CACHE_SIZE) return NULL;
+    if(!lv_cache_is_enabled(shadow_cache_p) || buf_size > lv_cache_get_max_size(shadow_cache_p, NULL)) return NULL;
+
+    /*Only the near edges of the rectangle are on the corner if it's at least 2 corners wide (or high).
+     *Clamp the size to have the same key for e.g. all the cards of a list with the same style.*/
+    lv_draw_sw_shadow_cache_data_t search_key;
+    lv_memzero(&search_key, sizeof(search_key));
+    search_key.slot.size = buf_size;
+    search_key.size = corner_size;
+    search_key.r = r;
+    search_key.w = LV_MIN(lv_area_get_width(core_area), 2 * corner_size);
+    search_key.h = LV_MIN(lv_area_get_height(core_area), 2 * corner_size);
+
+    lv_cache_entry_t * entry = lv_cache_acquire_or_create(shadow_cache_p, &search_key, NULL);
+    if(entry == NULL) return NULL;
+
+    lv_draw_sw_shadow_cache_data_t * data = lv_cache_entry_get_data(entry);
+    lv_opa_t * buf = lv_malloc(buf_size);
+    if(buf) lv_memcpy(buf, data->buf, buf_size);
+    lv_cache_release(shadow_cache_p, entry, NULL);
+
+    return buf;
+}
+
+static lv_cache_compare_res_t shadow_cache_compare_cb(const lv_draw_sw_shadow_cache_data_t * lhs,
+                                                      const lv_draw_sw_shadow_cache_data_t * rhs)
+{
+    if(lhs->size != rhs->size) return lhs->size > rhs->size ? 1 : -1;
+    if(lhs->r != rhs->r) return lhs->r > rhs->r ? 1 : -1;
+    if(lhs->w != rhs->w) return lhs->w > rhs->w ? 1 : -1;
+    if(lhs->h != rhs->h) return lhs->h > rhs->h ? 1 : -1;
+    return 0;
+}
+
+static bool shadow_cache_create_cb(lv_draw_sw_shadow_cache_data_t * data, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    /*A larger buffer is required for calculation*/
+    uint16_t * buf = lv_malloc(data->size * data->size * sizeof(uint16_t));
+    if(buf == NULL) return false;
+
+    /*Only the size of the area matters*/
+    lv_area_t core_area = {0, 0, data->w - 1, data->h - 1};
+    shadow_draw_corner_buf(&core_area, buf, data->size - data->r, data->r);
+
+    /*Keep only the opacity values*/
+    data->buf = lv_realloc(buf, data->slot.size);
+    if(data->buf == NULL) data->buf = (lv_opa_t *)buf;
+
+    return true;
+}
+
+static void shadow_cache_free_cb(lv_draw_sw_shadow_cache_data_t * data, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_free(data->buf);
+    data->buf = NULL;
+}
+#endif /*LV_DRAW_SW_SHADOW_CACHE_SIZE*/
+
 #else /*LV_DRAW_SW_COMPLEX*/
 
 void lv_draw_sw_box_shadow(lv_draw_unit_t * draw_unit, const lv_draw_box_shadow_dsc_t * dsc, const lv_area_t * coords)
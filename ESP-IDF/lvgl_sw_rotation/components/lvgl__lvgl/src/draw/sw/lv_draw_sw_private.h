@@ -44,17 +44,37 @@ struct lv_draw_sw_unit_t {
 };
 
 #if LV_DRAW_SW_SHADOW_CACHE_SIZE
+/**
+ * A blurred shadow corner in the shadow cache.
+ * The corner depends only on the fields below, `w` and `h` are clamped, as the far edges of larger
+ * rectangles don't reach the corner.
+ */
 typedef struct {
-    uint8_t cache[LV_DRAW_SW_SHADOW_CACHE_SIZE * LV_DRAW_SW_SHADOW_CACHE_SIZE];
-    int32_t cache_size;
-    int32_t cache_r;
-} lv_draw_sw_shadow_cache_t;
+    lv_cache_slot_size_t slot;      /**< Size of `buf` in bytes, used by the size based eviction*/
+    int32_t size;                   /**< Width and height of the corner: `shadow width + radius`*/
+    int32_t r;                      /**< Clamped radius of the shadow*/
+    int32_t w;                      /**< Clamped width of the blurred rectangle (with spread)*/
+    int32_t h;                      /**< Clamped height of the blurred rectangle (with spread)*/
+    lv_opa_t * buf;                 /**< `size * size` opacity values*/
+} lv_draw_sw_shadow_cache_data_t;
 #endif
 
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
 
+#if LV_DRAW_SW_COMPLEX && LV_DRAW_SW_SHADOW_CACHE_SIZE
+/**
+ * Create the cache of the blurred shadow corners. Called by `lv_draw_sw_init`.
+ */
+void lv_draw_sw_shadow_cache_init(void);
+
+/**
+ * Destroy the cache of the blurred shadow corners. Called by `lv_draw_sw_deinit`.
+ */
+void lv_draw_sw_shadow_cache_deinit(void);
+#endif
+
 /**********************
  *      MACROS
  **********************/
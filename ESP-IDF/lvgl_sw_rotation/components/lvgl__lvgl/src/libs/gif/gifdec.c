@@ -162,6 +162,7 @@ static gd_GIF * gif_open(gd_GIF * gif_base)
 #endif
     gif->anim_start = f_gif_seek(gif, 0, LV_FS_SEEK_CUR);
     gif->loop_count = -1;
+    gif->frame_index = -1;
     goto ok;
 fail:
     f_gif_close(gif_base);
@@ -596,8 +597,9 @@ read_image_data(gd_GIF * gif, int interlace)
         if(ret == 1) key_size++;
         entry = table->entries[key];
         str_len = entry.length;
-	if(frm_off + str_len >= frm_size){
+	if(frm_off + str_len > frm_size){
 		LV_LOG_WARN("LZW table token overflows the frame buffer");
+		lv_free(table);
 		return -1;
 	}
         for(i = 0; i < str_len; i++) {
@@ -738,6 +740,8 @@ gd_get_frame(gd_GIF * gif)
             else if(gif->loop_count > 1) {
                 gif->loop_count--;
             }
+            /* The next frame is the first one of the loop. */
+            gif->frame_index = -1;
         }
         else if(sep == '!')
             read_ext(gif);
@@ -746,6 +750,7 @@ gd_get_frame(gd_GIF * gif)
     }
     if(read_image(gif) == -1)
         return -1;
+    gif->frame_index++;
     return 1;
 }
 
@@ -759,6 +764,7 @@ void
 gd_rewind(gd_GIF * gif)
 {
     gif->loop_count = -1;
+    gif->frame_index = -1;
     f_gif_seek(gif, gif->anim_start, LV_FS_SEEK_SET);
 }
 
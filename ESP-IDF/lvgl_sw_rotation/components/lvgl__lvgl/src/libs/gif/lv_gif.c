@@ -7,12 +7,18 @@
  *      INCLUDES
  *********************/
 #include "../../misc/lv_timer_private.h"
+#include "../../misc/lv_area_private.h"
 #include "../../core/lv_obj_class_private.h"
+#include "../../stdlib/lv_string.h"
 #include "lv_gif_private.h"
 #if LV_USE_GIF
 
 #include "gifdec.h"
 
+#if LV_GIF_DECODE_THREAD && LV_USE_OS == LV_OS_NONE
+    #error "LV_GIF_DECODE_THREAD requires LV_USE_OS"
+#endif
+
 /*********************
  *      DEFINES
  *********************/
@@ -28,6 +34,24 @@
 static void lv_gif_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
 static void lv_gif_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
 static void next_frame_task_cb(lv_timer_t * t);
+static void decode_next_frame(lv_gif_t * gifobj);
+static void show_next_frame(lv_gif_t * gifobj);
+static void invalidate_frame_area(lv_gif_t * gifobj, const lv_area_t * area);
+static void area_add_rect(lv_area_t * area, int32_t x, int32_t y, int32_t w, int32_t h);
+
+#if LV_GIF_DECODE_THREAD
+    static void decode_thread_cb(void * user_data);
+    static void decode_thread_start(lv_gif_t * gifobj);
+    static void decode_thread_stop(lv_gif_t * gifobj);
+    static void decode_thread_request(lv_gif_t * gifobj);
+    static void decode_thread_wait(lv_gif_t * gifobj);
+#endif
+
+#if LV_GIF_FRAME_CACHE_SIZE
+    static void frame_cache_add(lv_gif_t * gifobj, const lv_area_t * area);
+    static void frame_cache_show_next(lv_gif_t * gifobj);
+    static void frame_cache_drop(lv_gif_t * gifobj);
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -67,6 +91,16 @@ void lv_gif_set_src(lv_obj_t * obj, const void * src)
     if(gif != NULL) {
         lv_image_cache_drop(lv_image_get_src(obj));
 
+#if LV_GIF_DECODE_THREAD
+        decode_thread_wait(gifobj);
+        gifobj->decode_state = LV_GIF_DECODE_STATE_IDLE;
+        lv_free(gifobj->front_buf);
+        gifobj->front_buf = NULL;
+#endif
+#if LV_GIF_FRAME_CACHE_SIZE
+        frame_cache_drop(gifobj);
+#endif
+
         gd_close_gif(gif);
         gifobj->gif = NULL;
         gifobj->imgdsc.data = NULL;
@@ -84,8 +118,20 @@ void lv_gif_set_src(lv_obj_t * obj, const void * src)
         return;
     }
 
+    uint8_t * buf = gif->canvas;
+#if LV_GIF_DECODE_THREAD
+    /*The decoder composes the next frame in its canvas while this one is shown*/
+    gifobj->front_buf = lv_malloc(gif->width * gif->height * 4);
+    if(gifobj->front_buf == NULL) {
+        LV_LOG_WARN("Couldn't allocate the frame buffer");
+        gd_close_gif(gif);
+        return;
+    }
+    buf = gifobj->front_buf;
+#endif
+
     gifobj->gif = gif;
-    gifobj->imgdsc.data = gif->canvas;
+    gifobj->imgdsc.data = buf;
     gifobj->imgdsc.header.magic = LV_IMAGE_HEADER_MAGIC;
     gifobj->imgdsc.header.flags = LV_IMAGE_FLAGS_MODIFIABLE;
     gifobj->imgdsc.header.cf = LV_COLOR_FORMAT_ARGB8888;
@@ -94,15 +140,17 @@ void lv_gif_set_src(lv_obj_t * obj, const void * src)
     gifobj->imgdsc.header.stride = gif->width * 4;
     gifobj->imgdsc.data_size = gif->width * gif->height * 4;
 
-    gifobj->last_call = lv_tick_get();
+    lv_memzero(&gifobj->stats, sizeof(gifobj->stats));
 
     lv_image_set_src(obj, &gifobj->imgdsc);
 
     lv_timer_resume(gifobj->timer);
     lv_timer_reset(gifobj->timer);
 
-    next_frame_task_cb(gifobj->timer);
-
+    /*Show the first frame right away. The whole image is new, copy and redraw all of it.*/
+    decode_next_frame(gifobj);
+    lv_area_set(&gifobj->dirty_area, 0, 0, gif->width - 1, gif->height - 1);
+    show_next_frame(gifobj);
 }
 
 void lv_gif_restart(lv_obj_t * obj)
@@ -114,6 +162,26 @@ void lv_gif_restart(lv_obj_t * obj)
         return;
     }
 
+#if LV_GIF_DECODE_THREAD
+    /*Drop the frame decoded ahead. Its area stays in `dirty_area` as the canvas differs there.*/
+    decode_thread_wait(gifobj);
+    gifobj->decode_state = LV_GIF_DECODE_STATE_IDLE;
+#endif
+#if LV_GIF_FRAME_CACHE_SIZE
+    if(gifobj->frame_cache_state == LV_GIF_FRAME_CACHE_STATE_PLAYING) {
+        /*The canvas of the decoder has the last decoded frame, show it until the first one is decoded*/
+#if LV_GIF_DECODE_THREAD
+        gifobj->imgdsc.data = gifobj->front_buf;
+        lv_area_set(&gifobj->dirty_area, 0, 0, gifobj->gif->width - 1, gifobj->gif->height - 1);
+#else
+        gifobj->imgdsc.data = gifobj->gif->canvas;
+#endif
+        lv_image_cache_drop(lv_image_get_src(obj));
+        lv_obj_invalidate(obj);
+    }
+    frame_cache_drop(gifobj);
+#endif
+
     gd_rewind(gifobj->gif);
     lv_timer_resume(gifobj->timer);
     lv_timer_reset(gifobj->timer);
@@ -152,6 +220,10 @@ int32_t lv_gif_get_loop_count(lv_obj_t * obj)
         return -1;
     }
 
+#if LV_GIF_DECODE_THREAD
+    decode_thread_wait(gifobj);
+#endif
+
     return gifobj->gif->loop_count;
 }
 
@@ -164,9 +236,31 @@ void lv_gif_set_loop_count(lv_obj_t * obj, int32_t count)
         return;
     }
 
+#if LV_GIF_DECODE_THREAD
+    decode_thread_wait(gifobj);
+#endif
+
     gifobj->gif->loop_count = count;
 }
 
+void lv_gif_get_stats(lv_obj_t * obj, lv_gif_stats_t * stats)
+{
+    LV_ASSERT_NULL(stats);
+    lv_gif_t * gifobj = (lv_gif_t *) obj;
+
+    *stats = gifobj->stats;
+#if LV_GIF_FRAME_CACHE_SIZE
+    stats->cached_frame_cnt = lv_array_size(&gifobj->frames);
+#endif
+}
+
+void lv_gif_reset_stats(lv_obj_t * obj)
+{
+    lv_gif_t * gifobj = (lv_gif_t *) obj;
+
+    lv_memzero(&gifobj->stats, sizeof(gifobj->stats));
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -180,6 +274,11 @@ static void lv_gif_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
     gifobj->gif = NULL;
     gifobj->timer = lv_timer_create(next_frame_task_cb, 10, obj);
     lv_timer_pause(gifobj->timer);
+    lv_area_set(&gifobj->dirty_area, 0, 0, -1, -1);
+
+#if LV_GIF_FRAME_CACHE_SIZE
+    lv_array_init(&gifobj->frames, 0, sizeof(lv_gif_frame_t));
+#endif
 }
 
 static void lv_gif_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
@@ -189,6 +288,15 @@ static void lv_gif_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
 
     lv_image_cache_drop(lv_image_get_src(obj));
 
+#if LV_GIF_DECODE_THREAD
+    decode_thread_stop(gifobj);
+    lv_free(gifobj->front_buf);
+#endif
+#if LV_GIF_FRAME_CACHE_SIZE
+    frame_cache_drop(gifobj);
+    lv_array_deinit(&gifobj->frames);
+#endif
+
     if(gifobj->gif)
         gd_close_gif(gifobj->gif);
     lv_timer_delete(gifobj->timer);
@@ -199,22 +307,356 @@ static void next_frame_task_cb(lv_timer_t * t)
     lv_obj_t * obj = t->user_data;
     lv_gif_t * gifobj = (lv_gif_t *) obj;
     uint32_t elaps = lv_tick_elaps(gifobj->last_call);
-    if(elaps < gifobj->gif->gce.delay * 10) return;
+    if(elaps < gifobj->delay) return;
+
+#if LV_GIF_FRAME_CACHE_SIZE
+    if(gifobj->frame_cache_state == LV_GIF_FRAME_CACHE_STATE_PLAYING) {
+        frame_cache_show_next(gifobj);
+        return;
+    }
+#endif
+
+#if LV_GIF_DECODE_THREAD
+    lv_mutex_lock(&gifobj->mutex);
+    lv_gif_decode_state_t state = gifobj->decode_state;
+    lv_mutex_unlock(&gifobj->mutex);
+
+    /*Keep showing the current frame until the next one is decoded*/
+    if(state != LV_GIF_DECODE_STATE_READY) {
+        if(state == LV_GIF_DECODE_STATE_IDLE) decode_thread_request(gifobj);
+        return;
+    }
+
+    lv_mutex_lock(&gifobj->mutex);
+    gifobj->decode_state = LV_GIF_DECODE_STATE_IDLE;
+    lv_mutex_unlock(&gifobj->mutex);
+#else
+    decode_next_frame(gifobj);
+#endif
+
+    show_next_frame(gifobj);
+}
+
+/**
+ * Decode the next frame into the canvas of the decoder and collect the area changed by it.
+ * Called from the decoding thread if `LV_GIF_DECODE_THREAD` is enabled.
+ * @param gifobj    pointer to a gif object
+ */
+static void decode_next_frame(lv_gif_t * gifobj)
+{
+    gd_GIF * gif = gifobj->gif;
+    uint32_t t_start = lv_tick_get();
+
+    /*Disposing the previous frame restores its area to the background*/
+    if(gif->gce.disposal == 2) area_add_rect(&gifobj->dirty_area, gif->fx, gif->fy, gif->fw, gif->fh);
+
+    gifobj->has_next = gd_get_frame(gif);
+    gd_render_frame(gif, gif->canvas);
+
+    area_add_rect(&gifobj->dirty_area, gif->fx, gif->fy, gif->fw, gif->fh);
+
+    gifobj->decode_time = lv_tick_elaps(t_start);
+}
+
+/**
+ * Show the frame decoded by `decode_next_frame()` and redraw only the area changed by it.
+ * @param gifobj    pointer to a gif object
+ */
+static void show_next_frame(lv_gif_t * gifobj)
+{
+    lv_obj_t * obj = (lv_obj_t *)gifobj;
+    gd_GIF * gif = gifobj->gif;
 
     gifobj->last_call = lv_tick_get();
+    gifobj->delay = gif->gce.delay * 10;
+    gifobj->stats.decode_time += gifobj->decode_time;
+    gifobj->stats.decoded_frame_cnt++;
+
+#if LV_GIF_DECODE_THREAD
+    /*Only the changed area differs between the canvas of the decoder and the shown frame*/
+    if(gifobj->dirty_area.x2 >= gifobj->dirty_area.x1) {
+        uint32_t stride = gif->width * 4;
+        uint32_t offset = gifobj->dirty_area.y1 * stride + gifobj->dirty_area.x1 * 4;
+        uint32_t line_size = lv_area_get_width(&gifobj->dirty_area) * 4;
+        int32_t y;
+        for(y = gifobj->dirty_area.y1; y <= gifobj->dirty_area.y2; y++) {
+            lv_memcpy(&gifobj->front_buf[offset], &gif->canvas[offset], line_size);
+            offset += stride;
+        }
+    }
+#endif
+
+    int32_t has_next = gifobj->has_next;
+    lv_area_t area = gifobj->dirty_area;
+    lv_area_set(&gifobj->dirty_area, 0, 0, -1, -1);
+
+#if LV_GIF_FRAME_CACHE_SIZE
+    if(has_next == 1) frame_cache_add(gifobj, &area);
+    else frame_cache_drop(gifobj);
+#endif
+
+#if LV_GIF_DECODE_THREAD
+    /*Decode the next frame while this one is shown*/
+    bool decode_next = has_next != 0;
+#if LV_GIF_FRAME_CACHE_SIZE
+    if(gifobj->frame_cache_state == LV_GIF_FRAME_CACHE_STATE_PLAYING) decode_next = false;
+#endif
+    if(decode_next) decode_thread_request(gifobj);
+#endif
 
-    int has_next = gd_get_frame(gifobj->gif);
     if(has_next == 0) {
         /*It was the last repeat*/
         lv_result_t res = lv_obj_send_event(obj, LV_EVENT_READY, NULL);
-        lv_timer_pause(t);
+        lv_timer_pause(gifobj->timer);
         if(res != LV_RESULT_OK) return;
     }
 
-    gd_render_frame(gifobj->gif, (uint8_t *)gifobj->imgdsc.data);
+    invalidate_frame_area(gifobj, &area);
+}
+
+/**
+ * Invalidate the area of the gif object where a part of the frame is drawn.
+ * @param gifobj    pointer to a gif object
+ * @param area      the changed area of the frame in image coordinates
+ */
+static void invalidate_frame_area(lv_gif_t * gifobj, const lv_area_t * area)
+{
+    lv_obj_t * obj = (lv_obj_t *)gifobj;
+    lv_image_t * img = (lv_image_t *)gifobj;
 
+    gifobj->stats.frame_cnt++;
     lv_image_cache_drop(lv_image_get_src(obj));
-    lv_obj_invalidate(obj);
+
+    if(area->x2 < area->x1) return;
+
+    /*The frame is drawn 1:1 only if the image is not scaled, rotated or tiled.
+     *Else redraw the whole object.*/
+    if(img->scale_x != LV_SCALE_NONE || img->scale_y != LV_SCALE_NONE || img->rotation != 0 ||
+       img->align >= LV_IMAGE_ALIGN_AUTO_TRANSFORM) {
+        gifobj->stats.redrawn_px += lv_area_get_size(&obj->coords);
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    /*Same as drawing the image in `lv_image`'s draw event*/
+    lv_area_t image_area;
+    lv_area_set(&image_area, obj->coords.x1, obj->coords.y1, obj->coords.x1 + img->w - 1, obj->coords.y1 + img->h - 1);
+    lv_area_align(&obj->coords, &image_area, img->align, img->offset.x, img->offset.y);
+
+    lv_area_t inv_area = *area;
+    lv_area_move(&inv_area, image_area.x1, image_area.y1);
+    if(!lv_area_intersect(&inv_area, &inv_area, &obj->coords)) return;
+
+    gifobj->stats.redrawn_px += lv_area_get_size(&inv_area);
+    lv_obj_invalidate_area(obj, &inv_area);
 }
 
+/**
+ * Add a rectangle to an area. An area with `x2 < x1` is empty.
+ */
+static void area_add_rect(lv_area_t * area, int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    if(w <= 0 || h <= 0) return;
+
+    lv_area_t rect;
+    lv_area_set(&rect, x, y, x + w - 1, y + h - 1);
+    if(area->x2 < area->x1) *area = rect;
+    else lv_area_join(area, area, &rect);
+}
+
+#if LV_GIF_DECODE_THREAD
+
+static void decode_thread_cb(void * user_data)
+{
+    lv_gif_t * gifobj = user_data;
+
+    while(1) {
+        lv_thread_sync_wait(&gifobj->sync);
+
+        lv_mutex_lock(&gifobj->mutex);
+        if(gifobj->exit) {
+            lv_mutex_unlock(&gifobj->mutex);
+            break;
+        }
+        if(gifobj->decode_state != LV_GIF_DECODE_STATE_REQUESTED) {
+            lv_mutex_unlock(&gifobj->mutex);
+            continue;
+        }
+        gifobj->decode_state = LV_GIF_DECODE_STATE_DECODING;
+        lv_mutex_unlock(&gifobj->mutex);
+
+        decode_next_frame(gifobj);
+
+        lv_mutex_lock(&gifobj->mutex);
+        gifobj->decode_state = LV_GIF_DECODE_STATE_READY;
+        lv_mutex_unlock(&gifobj->mutex);
+        lv_thread_sync_signal(&gifobj->done_sync);
+    }
+
+    lv_thread_sync_signal(&gifobj->done_sync);
+}
+
+static void decode_thread_start(lv_gif_t * gifobj)
+{
+    if(gifobj->thread_started) return;
+
+    lv_mutex_init(&gifobj->mutex);
+    lv_thread_sync_init(&gifobj->sync);
+    lv_thread_sync_init(&gifobj->done_sync);
+    gifobj->decode_state = LV_GIF_DECODE_STATE_IDLE;
+    gifobj->exit = 0;
+    lv_thread_init(&gifobj->thread, LV_THREAD_PRIO_LOW, decode_thread_cb, LV_DRAW_THREAD_STACK_SIZE, gifobj);
+    gifobj->thread_started = 1;
+}
+
+static void decode_thread_stop(lv_gif_t * gifobj)
+{
+    if(!gifobj->thread_started) return;
+
+    decode_thread_wait(gifobj);
+
+    lv_mutex_lock(&gifobj->mutex);
+    gifobj->exit = 1;
+    lv_mutex_unlock(&gifobj->mutex);
+
+    lv_thread_sync_signal(&gifobj->sync);
+    lv_thread_delete(&gifobj->thread);
+    lv_thread_sync_delete(&gifobj->sync);
+    lv_thread_sync_delete(&gifobj->done_sync);
+    lv_mutex_delete(&gifobj->mutex);
+    gifobj->thread_started = 0;
+}
+
+static void decode_thread_request(lv_gif_t * gifobj)
+{
+    decode_thread_start(gifobj);
+
+    lv_mutex_lock(&gifobj->mutex);
+    gifobj->decode_state = LV_GIF_DECODE_STATE_REQUESTED;
+    lv_mutex_unlock(&gifobj->mutex);
+    lv_thread_sync_signal(&gifobj->sync);
+}
+
+/**
+ * Wait until the thread doesn't use the decoder.
+ * A requested frame is decoded first, so the state is either IDLE or READY after it.
+ * @param gifobj    pointer to a gif object
+ */
+static void decode_thread_wait(lv_gif_t * gifobj)
+{
+    if(!gifobj->thread_started) return;
+
+    while(1) {
+        lv_mutex_lock(&gifobj->mutex);
+        lv_gif_decode_state_t state = gifobj->decode_state;
+        lv_mutex_unlock(&gifobj->mutex);
+        if(state == LV_GIF_DECODE_STATE_IDLE || state == LV_GIF_DECODE_STATE_READY) break;
+
+        lv_thread_sync_wait(&gifobj->done_sync);
+    }
+}
+
+#endif /*LV_GIF_DECODE_THREAD*/
+
+#if LV_GIF_FRAME_CACHE_SIZE
+
+/**
+ * Cache the shown frame while the first loop is played.
+ * When the next loop starts and every frame is cached, play the loops from the cache.
+ * @param gifobj    pointer to a gif object
+ */
+static void frame_cache_add(lv_gif_t * gifobj, const lv_area_t * area)
+{
+    gd_GIF * gif = gifobj->gif;
+    uint32_t frame_size = gif->width * gif->height * 4;
+
+    if(gifobj->frame_cache_state == LV_GIF_FRAME_CACHE_STATE_DISABLED) return;
+
+    if(gif->frame_index == 0) {
+        if(gifobj->frame_cache_state == LV_GIF_FRAME_CACHE_STATE_RECORDING) {
+            /*Looped. If the first frame is composed the same way as in the previous loop
+             *(e.g. it covers the whole canvas) the rest of the loop is the same too.*/
+            lv_gif_frame_t * frame = lv_array_at(&gifobj->frames, 0);
+            if(lv_memcmp(frame->buf, gifobj->imgdsc.data, frame_size) != 0) {
+                frame_cache_drop(gifobj);
+                gifobj->frame_cache_state = LV_GIF_FRAME_CACHE_STATE_DISABLED;
+                return;
+            }
+
+            gifobj->frame_cache_state = LV_GIF_FRAME_CACHE_STATE_PLAYING;
+            gifobj->frame_idx = 0;
+            gifobj->imgdsc.data = frame->buf;
+            return;
+        }
+
+        gifobj->frame_cache_state = LV_GIF_FRAME_CACHE_STATE_RECORDING;
+    }
+
+    if(gifobj->frame_cache_state != LV_GIF_FRAME_CACHE_STATE_RECORDING) return;
+
+    lv_gif_frame_t frame;
+    frame.buf = NULL;
+    if(gifobj->frames_size + frame_size <= LV_GIF_FRAME_CACHE_SIZE) frame.buf = lv_malloc(frame_size);
+    if(frame.buf == NULL) {
+        frame_cache_drop(gifobj);
+        gifobj->frame_cache_state = LV_GIF_FRAME_CACHE_STATE_DISABLED;
+        return;
+    }
+
+    lv_memcpy(frame.buf, gifobj->imgdsc.data, frame_size);
+    frame.delay = gifobj->delay;
+    /*The first frame is shown after the last one, redraw all of it*/
+    if(gif->frame_index == 0) lv_area_set(&frame.area, 0, 0, gif->width - 1, gif->height - 1);
+    else lv_area_copy(&frame.area, area);
+    if(lv_array_push_back(&gifobj->frames, &frame) != LV_RESULT_OK) {
+        lv_free(frame.buf);
+        frame_cache_drop(gifobj);
+        gifobj->frame_cache_state = LV_GIF_FRAME_CACHE_STATE_DISABLED;
+        return;
+    }
+    gifobj->frames_size += frame_size;
+}
+
+static void frame_cache_show_next(lv_gif_t * gifobj)
+{
+    lv_obj_t * obj = (lv_obj_t *)gifobj;
+    gd_GIF * gif = gifobj->gif;
+
+    gifobj->last_call = lv_tick_get();
+
+    gifobj->frame_idx++;
+    if(gifobj->frame_idx >= lv_array_size(&gifobj->frames)) {
+        /*Count the loops the same way as the decoder*/
+        if(gif->loop_count == 1 || gif->loop_count < 0) {
+            gifobj->frame_idx--;
+            lv_obj_send_event(obj, LV_EVENT_READY, NULL);
+            lv_timer_pause(gifobj->timer);
+            return;
+        }
+        else if(gif->loop_count > 1) {
+            gif->loop_count--;
+        }
+        gifobj->frame_idx = 0;
+    }
+
+    lv_gif_frame_t * frame = lv_array_at(&gifobj->frames, gifobj->frame_idx);
+    gifobj->imgdsc.data = frame->buf;
+    gifobj->delay = frame->delay;
+    invalidate_frame_area(gifobj, &frame->area);
+}
+
+static void frame_cache_drop(lv_gif_t * gifobj)
+{
+    uint32_t i;
+    for(i = 0; i < lv_array_size(&gifobj->frames); i++) {
+        lv_gif_frame_t * frame = lv_array_at(&gifobj->frames, i);
+        lv_free(frame->buf);
+    }
+    lv_array_clear(&gifobj->frames);
+    gifobj->frames_size = 0;
+    gifobj->frame_cache_state = LV_GIF_FRAME_CACHE_STATE_IDLE;
+}
+
+#endif /*LV_GIF_FRAME_CACHE_SIZE*/
+
 #endif /*LV_USE_GIF*/
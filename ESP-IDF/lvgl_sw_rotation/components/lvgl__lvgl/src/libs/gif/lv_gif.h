@@ -35,6 +35,17 @@ extern "C" {
 
 LV_ATTRIBUTE_EXTERN_DATA extern const lv_obj_class_t lv_gif_class;
 
+/**
+ * Counters of a gif object since its source was set
+ */
+typedef struct {
+    uint32_t frame_cnt;         /**< Number of frames shown*/
+    uint32_t decoded_frame_cnt; /**< Number of frames decoded, the others were played from the frame cache*/
+    uint32_t decode_time;       /**< Sum of the time spent decoding the frames [ms]*/
+    uint64_t redrawn_px;        /**< Sum of the pixels invalidated for the frames*/
+    uint32_t cached_frame_cnt;  /**< Number of frames in the frame cache*/
+} lv_gif_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -91,6 +102,21 @@ int32_t lv_gif_get_loop_count(lv_obj_t * obj);
  */
 void lv_gif_set_loop_count(lv_obj_t * obj, int32_t count);
 
+/**
+ * Get the counters of decoding and showing the frames.
+ * `decode_time / decoded_frame_cnt` is the CPU time of a frame,
+ * `redrawn_px / frame_cnt` is the area redrawn for a frame.
+ * @param obj   pointer to a gif obj
+ * @param stats store the counters here
+ */
+void lv_gif_get_stats(lv_obj_t * obj, lv_gif_stats_t * stats);
+
+/**
+ * Reset the counters of a gif object (except `cached_frame_cnt`).
+ * @param obj   pointer to a gif obj
+ */
+void lv_gif_reset_stats(lv_obj_t * obj);
+
 /**********************
  *      MACROS
  **********************/
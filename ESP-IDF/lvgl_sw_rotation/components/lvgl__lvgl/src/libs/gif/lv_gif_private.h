@@ -15,6 +15,8 @@ extern "C" {
  *********************/
 
 #include "../../widgets/image/lv_image_private.h"
+#include "../../misc/lv_array.h"
+#include "../../osal/lv_os.h"
 #include "lv_gif.h"
 
 #if LV_USE_GIF
@@ -27,9 +29,29 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 
-/**********************
- *      TYPEDEFS
- **********************/
+#if LV_GIF_DECODE_THREAD
+typedef enum {
+    LV_GIF_DECODE_STATE_IDLE,
+    LV_GIF_DECODE_STATE_REQUESTED,      /**< The thread should decode the next frame*/
+    LV_GIF_DECODE_STATE_DECODING,
+    LV_GIF_DECODE_STATE_READY,          /**< The next frame is in the canvas of the decoder*/
+} lv_gif_decode_state_t;
+#endif
+
+#if LV_GIF_FRAME_CACHE_SIZE
+typedef enum {
+    LV_GIF_FRAME_CACHE_STATE_IDLE,      /**< Waiting for the first frame of a loop*/
+    LV_GIF_FRAME_CACHE_STATE_RECORDING, /**< Caching the frames of a loop*/
+    LV_GIF_FRAME_CACHE_STATE_PLAYING,   /**< All the frames are cached, the decoder is not used*/
+    LV_GIF_FRAME_CACHE_STATE_DISABLED,  /**< The frames don't fit or can't be cached*/
+} lv_gif_frame_cache_state_t;
+
+typedef struct {
+    uint8_t * buf;          /**< The composed ARGB8888 frame*/
+    lv_area_t area;         /**< Changed area compared to the previous frame*/
+    uint32_t delay;         /**< Time to show the frame [ms]*/
+} lv_gif_frame_t;
+#endif
 
 struct lv_gif_t {
     lv_image_t img;
@@ -37,6 +59,29 @@ struct lv_gif_t {
     lv_timer_t * timer;
     lv_image_dsc_t imgdsc;
     uint32_t last_call;
+    uint32_t delay;         /**< Time to show the current frame [ms]*/
+    lv_area_t dirty_area;   /**< Area of the next frame changed compared to the shown one (image coordinates)*/
+    int32_t has_next;       /**< Return value of decoding the next frame*/
+    uint32_t decode_time;   /**< Time of decoding the next frame [ms]*/
+    lv_gif_stats_t stats;
+
+#if LV_GIF_DECODE_THREAD
+    uint8_t * front_buf;    /**< The shown frame, the canvas of the decoder has the next one*/
+    lv_thread_t thread;
+    lv_thread_sync_t sync;      /**< Signaled to start decoding*/
+    lv_thread_sync_t done_sync; /**< Signaled when a frame is decoded*/
+    lv_mutex_t mutex;           /**< Protects `decode_state` and `exit`*/
+    lv_gif_decode_state_t decode_state;
+    uint32_t thread_started : 1;
+    uint32_t exit : 1;
+#endif
+
+#if LV_GIF_FRAME_CACHE_SIZE
+    lv_array_t frames;      /**< Cached frames of a loop, elements are `lv_gif_frame_t`*/
+    uint32_t frames_size;   /**< Sum of the size of the cached frames*/
+    uint32_t frame_idx;     /**< Index of the shown frame while playing from the cache*/
+    lv_gif_frame_cache_state_t frame_cache_state;
+#endif
 };
 
 
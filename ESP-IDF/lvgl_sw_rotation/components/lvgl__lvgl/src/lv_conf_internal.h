@@ -518,7 +518,7 @@
     #if LV_DRAW_SW_COMPLEX == 1
         /*Allow buffering some shadow calculation.
         *LV_DRAW_SW_SHADOW_CACHE_SIZE is the max. shadow size to buffer, where shadow size is `shadow_width + radius`
-        *Caching has LV_DRAW_SW_SHADOW_CACHE_SIZE^2 RAM cost*/
+        *Caching a shadow has shadow size^2 RAM cost*/
         #ifndef LV_DRAW_SW_SHADOW_CACHE_SIZE
             #ifdef CONFIG_LV_DRAW_SW_SHADOW_CACHE_SIZE
                 #define LV_DRAW_SW_SHADOW_CACHE_SIZE CONFIG_LV_DRAW_SW_SHADOW_CACHE_SIZE
@@ -527,6 +527,16 @@
             #endif
         #endif
 
+        /*Max. RAM used by the cached shadows in bytes. Shadows with different sizes, radii or
+        *spreads are cached separately, the least recently used ones are dropped first.*/
+        #ifndef LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE
+            #ifdef CONFIG_LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE
+                #define LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE CONFIG_LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE
+            #else
+                #define LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE (4 * LV_DRAW_SW_SHADOW_CACHE_SIZE * LV_DRAW_SW_SHADOW_CACHE_SIZE)
+            #endif
+        #endif
+
         /* Set number of maximally cached circle data.
         * The circumference of 1/4 circle are saved for anti-aliasing
         * radius * 4 bytes are used per circle (the most often used radiuses are saved)
@@ -1086,6 +1096,29 @@
     #endif
 #endif
 
+/*1: Use a scan resistant eviction policy for the image cache instead of LRU.
+ *Images used only once (e.g. while scrolling through many icons) can't flush
+ *the images which are used repeatedly. See `lv_cache_class_clock_rb_size`.*/
+#ifndef LV_IMAGE_CACHE_SCAN_RESISTANT
+    #ifdef CONFIG_LV_IMAGE_CACHE_SCAN_RESISTANT
+        #define LV_IMAGE_CACHE_SCAN_RESISTANT CONFIG_LV_IMAGE_CACHE_SCAN_RESISTANT
+    #else
+        #define LV_IMAGE_CACHE_SCAN_RESISTANT   0
+    #endif
+#endif
+
+/*Number of threads decoding images which are not in the image cache yet. 0: decode while drawing.
+ *Until an image is decoded a placeholder is drawn and its area is redrawn when it's ready,
+ *so a large image scrolling into view doesn't stall the frame.
+ *Requires `LV_USE_OS` and the image cache (`LV_CACHE_DEF_SIZE > 0`).*/
+#ifndef LV_IMAGE_DECODER_ASYNC_THREAD_CNT
+    #ifdef CONFIG_LV_IMAGE_DECODER_ASYNC_THREAD_CNT
+        #define LV_IMAGE_DECODER_ASYNC_THREAD_CNT CONFIG_LV_IMAGE_DECODER_ASYNC_THREAD_CNT
+    #else
+        #define LV_IMAGE_DECODER_ASYNC_THREAD_CNT   0
+    #endif
+#endif
+
 /*Default number of image header cache entries. The cache is used to store the headers of images
  *The main logic is like `LV_CACHE_DEF_SIZE` but for image headers.*/
 #ifndef LV_IMAGE_HEADER_CACHE_DEF_CNT
@@ -2629,6 +2662,26 @@
             #define LV_GIF_CACHE_DECODE_DATA 0
         #endif
     #endif
+
+    /*1: Decode the next frame of each GIF on its own thread while the current one is shown.
+     *Needs one more `4 x width x height` frame buffer per GIF. Requires `LV_USE_OS`.*/
+    #ifndef LV_GIF_DECODE_THREAD
+        #ifdef CONFIG_LV_GIF_DECODE_THREAD
+            #define LV_GIF_DECODE_THREAD CONFIG_LV_GIF_DECODE_THREAD
+        #else
+            #define LV_GIF_DECODE_THREAD 0
+        #endif
+    #endif
+
+    /*Max. bytes of composed frames cached per GIF. A looping GIF whose frames fit is
+     *played from the cached frames after its first loop without decoding. 0: disable*/
+    #ifndef LV_GIF_FRAME_CACHE_SIZE
+        #ifdef CONFIG_LV_GIF_FRAME_CACHE_SIZE
+            #define LV_GIF_FRAME_CACHE_SIZE CONFIG_LV_GIF_FRAME_CACHE_SIZE
+        #else
+            #define LV_GIF_FRAME_CACHE_SIZE 0
+        #endif
+    #endif
 #endif
 
 
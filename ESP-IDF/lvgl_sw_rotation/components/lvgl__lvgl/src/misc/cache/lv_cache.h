@@ -18,6 +18,7 @@ extern "C" {
 #include "../lv_types.h"
 
 #include "lv_cache_lru_rb.h"
+#include "lv_cache_clock_rb.h"
 
 #include "lv_image_cache.h"
 #include "lv_image_header_cache.h"
@@ -35,9 +36,11 @@ extern "C" {
 
 /**
  * Create a cache object with the given parameters.
- * @param cache_class   The class of the cache. Currently only support one two builtin classes:
+ * @param cache_class   The class of the cache. The builtin classes are:
  *                        - lv_cache_class_lru_rb_count for LRU-based cache with count-based eviction policy.
  *                        - lv_cache_class_lru_rb_size for LRU-based cache with size-based eviction policy.
+ *                        - lv_cache_class_clock_rb_count for scan resistant cache with count-based eviction policy.
+ *                        - lv_cache_class_clock_rb_size for scan resistant cache with size-based eviction policy.
  * @param node_size     The node size is the size of the data stored in the cache..
  * @param max_size      The max size is the maximum amount of memory or count that the cache can hold.
  *                        - lv_cache_class_lru_rb_count: max_size is the maximum count of nodes in the cache.
@@ -66,6 +69,16 @@ void lv_cache_destroy(lv_cache_t * cache, void * user_data);
  */
 lv_cache_entry_t * lv_cache_acquire(lv_cache_t * cache, const void * key, void * user_data);
 
+/**
+ * Check if an entry with the given key is in the cache, without acquiring it. Unlike lv_cache_acquire(), it's not
+ * counted as a hit or a miss and the entry's priority isn't changed (if the cache class has a `peek_cb`).
+ * @param cache         The cache object pointer to check.
+ * @param key           The key of the entry to check.
+ * @param user_data     A user data pointer that will be passed to the cache class.
+ * @return              true: the entry is in the cache
+ */
+bool lv_cache_contains(lv_cache_t * cache, const void * key, void * user_data);
+
 /**
  * Acquire a cache entry with the given key. If the entry is not in the cache, it will create a new entry with the given key.
  * If the entry is found, it's priority will be changed by the cache's policy. And the `lv_cache_entry_t::ref_cnt` will be incremented.
@@ -215,6 +228,20 @@ void lv_cache_set_name(lv_cache_t * cache, const char * name);
  */
 const char * lv_cache_get_name(lv_cache_t * cache);
 
+/**
+ * Get the hit, miss and eviction counters of a cache object.
+ * Lookups are counted by `lv_cache_acquire` and `lv_cache_acquire_or_create`.
+ * @param cache         The cache object pointer to get the statistics of.
+ * @param stats         Pointer to a statistics struct to fill.
+ */
+void lv_cache_get_stats(lv_cache_t * cache, lv_cache_stats_t * stats);
+
+/**
+ * Reset the hit, miss and eviction counters of a cache object.
+ * @param cache         The cache object pointer to reset the statistics of.
+ */
+void lv_cache_reset_stats(lv_cache_t * cache);
+
 /*************************
  *    GLOBAL VARIABLES
  *************************/
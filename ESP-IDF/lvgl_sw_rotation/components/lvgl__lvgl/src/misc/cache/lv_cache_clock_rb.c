@@ -0,0 +1,537 @@
+/**
+* @file lv_cache_clock_rb.c
+*
+*/
+
+/**
+ * Segmented CLOCK cache
+ *
+ * New entries are added to the probation list. Entries which are hit again while in probation
+ * are promoted to the protected list. If the cache has a clock (see `lv_cache_clock_rb_set_tick_cb`),
+ * only a hit more than `correlated_cnt` ticks after the entry was added promotes it. The hits before
+ * are correlated: e.g. with the display refreshes as the clock, an image is looked up several times
+ * while a frame is drawn, and an icon scrolling by is drawn in the few frames it's visible, neither
+ * means it's reused. The protected list can use at most `PROTECTED_RATIO` percent of the cache's
+ * maximal size, the entries above it are demoted to the probation list.
+ *
+ * Victims are taken from the tail of the probation list first, so a scan through many
+ * entries which are used only once (e.g. scrolling through the icons of a launcher)
+ * can't flush the protected entries.
+ *
+ * Hits in the protected list only set a reference bit instead of moving the entry.
+ * The protected list is swept like a clock: referenced entries get a second chance,
+ * the others are demoted or evicted.
+ *
+ *            hit                       hit: set the ref. bit
+ *        +---------+                   +--------+
+ *        |         v                   |        v
+ *  add  +-----------+    promote    +-------------+  ref. bit set:
+ * ----> | probation | ------------> |  protected  | ---+ clear it and
+ *       |  (FIFO)   | <------------ |   (CLOCK)   | <--+ move to head
+ *       +-----------+    demote     +-------------+
+ *             | tail
+ *             v
+ *           victim
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_cache_clock_rb.h"
+#include "../../stdlib/lv_sprintf.h"
+#include "../../stdlib/lv_string.h"
+#include "../lv_ll.h"
+#include "../lv_rb_private.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/*Maximal size of the protected list in percentage of the cache's maximal size*/
+#define PROTECTED_RATIO 80
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef uint32_t (get_data_size_cb_t)(const void * data);
+
+typedef struct {
+    void * ll_node;             /**< Node in `probation_ll` or `protected_ll`*/
+    uint8_t is_protected;       /**< 1: the entry is in `protected_ll`*/
+    uint8_t referenced;         /**< 1: the entry was hit since the clock hand passed it last*/
+    uint32_t probation_tick;    /**< The tick of the clock when the entry was put into the probation list*/
+} clock_meta_t;
+
+struct lv_clock_rb_t {
+    lv_cache_t cache;
+
+    lv_rb_t rb;
+    lv_ll_t probation_ll;       /**< Entries hit at most once since they were added, newest at the head*/
+    lv_ll_t protected_ll;       /**< Entries hit more than once, the clock hand is at the tail*/
+    uint32_t protected_size;    /**< Size of the entries in `protected_ll`*/
+
+    get_data_size_cb_t * get_data_size_cb;
+
+    lv_cache_clock_rb_tick_cb_t tick_cb;    /**< NULL: any hit in the probation list promotes the entry*/
+    uint32_t correlated_cnt;                /**< Ticks after adding an entry in which its hits don't promote it*/
+};
+typedef struct lv_clock_rb_t lv_clock_rb_t_;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static void * alloc_cb(void);
+static bool init_cnt_cb(lv_cache_t * cache);
+static bool init_size_cb(lv_cache_t * cache);
+static void destroy_cb(lv_cache_t * cache, void * user_data);
+
+static lv_cache_entry_t * get_cb(lv_cache_t * cache, const void * key, void * user_data);
+static lv_cache_entry_t * peek_cb(lv_cache_t * cache, const void * key, void * user_data);
+static lv_cache_entry_t * add_cb(lv_cache_t * cache, const void * key, void * user_data);
+static void remove_cb(lv_cache_t * cache, lv_cache_entry_t * entry, void * user_data);
+static void drop_cb(lv_cache_t * cache, const void * key, void * user_data);
+static void drop_all_cb(lv_cache_t * cache, void * user_data);
+static lv_cache_entry_t * get_victim_cb(lv_cache_t * cache, void * user_data);
+static lv_cache_reserve_cond_res_t reserve_cond_cb(lv_cache_t * cache, const void * key, size_t reserved_size,
+                                                   void * user_data);
+
+static bool init_common(lv_clock_rb_t_ * clock, get_data_size_cb_t * get_data_size_cb);
+static inline clock_meta_t * get_meta(lv_clock_rb_t_ * clock, lv_rb_node_t * node);
+static void unlink_node(lv_clock_rb_t_ * clock, lv_rb_node_t * node);
+static void balance_protected(lv_clock_rb_t_ * clock);
+static void free_list(lv_clock_rb_t_ * clock, lv_ll_t * ll, void * user_data, uint32_t * used_cnt);
+
+static uint32_t cnt_get_data_size_cb(const void * data);
+static uint32_t size_get_data_size_cb(const void * data);
+
+/**********************
+ *  GLOBAL VARIABLES
+ **********************/
+const lv_cache_class_t lv_cache_class_clock_rb_count = {
+    .alloc_cb = alloc_cb,
+    .init_cb = init_cnt_cb,
+    .destroy_cb = destroy_cb,
+
+    .get_cb = get_cb,
+    .peek_cb = peek_cb,
+    .add_cb = add_cb,
+    .remove_cb = remove_cb,
+    .drop_cb = drop_cb,
+    .drop_all_cb = drop_all_cb,
+    .get_victim_cb = get_victim_cb,
+    .reserve_cond_cb = reserve_cond_cb
+};
+
+const lv_cache_class_t lv_cache_class_clock_rb_size = {
+    .alloc_cb = alloc_cb,
+    .init_cb = init_size_cb,
+    .destroy_cb = destroy_cb,
+
+    .get_cb = get_cb,
+    .peek_cb = peek_cb,
+    .add_cb = add_cb,
+    .remove_cb = remove_cb,
+    .drop_cb = drop_cb,
+    .drop_all_cb = drop_all_cb,
+    .get_victim_cb = get_victim_cb,
+    .reserve_cond_cb = reserve_cond_cb
+};
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_cache_clock_rb_set_tick_cb(lv_cache_t * cache, lv_cache_clock_rb_tick_cb_t tick_cb, uint32_t correlated_cnt)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT(cache->clz == &lv_cache_class_clock_rb_count || cache->clz == &lv_cache_class_clock_rb_size);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    lv_mutex_lock(&cache->lock);
+    clock->tick_cb = tick_cb;
+    clock->correlated_cnt = correlated_cnt;
+    lv_mutex_unlock(&cache->lock);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static inline clock_meta_t * get_meta(lv_clock_rb_t_ * clock, lv_rb_node_t * node)
+{
+    return (clock_meta_t *)((char *)node->data + clock->rb.size - sizeof(clock_meta_t));
+}
+
+static void * alloc_cb(void)
+{
+    void * res = lv_malloc(sizeof(lv_clock_rb_t_));
+    LV_ASSERT_MALLOC(res);
+    if(res == NULL) {
+        LV_LOG_ERROR("malloc failed");
+        return NULL;
+    }
+
+    lv_memzero(res, sizeof(lv_clock_rb_t_));
+    return res;
+}
+
+static bool init_common(lv_clock_rb_t_ * clock, get_data_size_cb_t * get_data_size_cb)
+{
+    LV_ASSERT_NULL(clock->cache.ops.compare_cb);
+    LV_ASSERT_NULL(clock->cache.ops.free_cb);
+    LV_ASSERT(clock->cache.node_size > 0);
+
+    if(clock->cache.node_size <= 0 || clock->cache.ops.compare_cb == NULL || clock->cache.ops.free_cb == NULL) {
+        return false;
+    }
+
+    /*add the meta data to store the ll node pointer and the state of the entry*/
+    if(!lv_rb_init(&clock->rb, clock->cache.ops.compare_cb,
+                   lv_cache_entry_get_size(clock->cache.node_size) + sizeof(clock_meta_t))) {
+        return false;
+    }
+    lv_ll_init(&clock->probation_ll, sizeof(void *));
+    lv_ll_init(&clock->protected_ll, sizeof(void *));
+
+    clock->get_data_size_cb = get_data_size_cb;
+
+    return true;
+}
+
+static bool init_cnt_cb(lv_cache_t * cache)
+{
+    return init_common((lv_clock_rb_t_ *)cache, cnt_get_data_size_cb);
+}
+
+static bool init_size_cb(lv_cache_t * cache)
+{
+    return init_common((lv_clock_rb_t_ *)cache, size_get_data_size_cb);
+}
+
+static void destroy_cb(lv_cache_t * cache, void * user_data)
+{
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+
+    if(clock == NULL) {
+        return;
+    }
+
+    cache->clz->drop_all_cb(cache, user_data);
+}
+
+static lv_cache_entry_t * get_cb(lv_cache_t * cache, const void * key, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+    LV_ASSERT_NULL(key);
+
+    if(clock == NULL || key == NULL) {
+        return NULL;
+    }
+
+    lv_rb_node_t * node = lv_rb_find(&clock->rb, key);
+    if(node == NULL) {
+        return NULL;
+    }
+
+    clock_meta_t * meta = get_meta(clock, node);
+    if(meta->is_protected) {
+        /*Only mark it, the clock hand will move it when it passes*/
+        meta->referenced = 1;
+    }
+    else if(clock->tick_cb == NULL || clock->tick_cb() - meta->probation_tick > clock->correlated_cnt) {
+        /*Hit again after the correlated hits: promote it to the protected list*/
+        lv_ll_chg_list(&clock->probation_ll, &clock->protected_ll, meta->ll_node, true);
+        meta->is_protected = 1;
+        meta->referenced = 1;
+        clock->protected_size += clock->get_data_size_cb(node->data);
+        balance_protected(clock);
+    }
+
+    return lv_cache_entry_get_entry(node->data, cache->node_size);
+}
+
+static lv_cache_entry_t * peek_cb(lv_cache_t * cache, const void * key, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+    LV_ASSERT_NULL(key);
+
+    if(clock == NULL || key == NULL) {
+        return NULL;
+    }
+
+    lv_rb_node_t * node = lv_rb_find(&clock->rb, key);
+    return node ? lv_cache_entry_get_entry(node->data, cache->node_size) : NULL;
+}
+
+static lv_cache_entry_t * add_cb(lv_cache_t * cache, const void * key, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+    LV_ASSERT_NULL(key);
+
+    if(clock == NULL || key == NULL) {
+        return NULL;
+    }
+
+    lv_rb_node_t * node = lv_rb_insert(&clock->rb, (void *)key);
+    if(node == NULL) {
+        return NULL;
+    }
+
+    void * data = node->data;
+    lv_memcpy(data, key, cache->node_size);
+
+    void * ll_node = lv_ll_ins_head(&clock->probation_ll);
+    if(ll_node == NULL) {
+        lv_rb_drop_node(&clock->rb, node);
+        return NULL;
+    }
+    lv_memcpy(ll_node, &node, sizeof(void *));
+
+    clock_meta_t * meta = get_meta(clock, node);
+    meta->ll_node = ll_node;
+    meta->is_protected = 0;
+    meta->referenced = 0;
+    meta->probation_tick = clock->tick_cb ? clock->tick_cb() : 0;
+
+    lv_cache_entry_t * entry = lv_cache_entry_get_entry(data, cache->node_size);
+    lv_cache_entry_init(entry, cache, cache->node_size);
+
+    cache->size += clock->get_data_size_cb(key);
+
+    return entry;
+}
+
+static void remove_cb(lv_cache_t * cache, lv_cache_entry_t * entry, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+    LV_ASSERT_NULL(entry);
+
+    if(clock == NULL || entry == NULL) {
+        return;
+    }
+
+    void * data = lv_cache_entry_get_data(entry);
+    lv_rb_node_t * node = lv_rb_find(&clock->rb, data);
+    if(node == NULL) {
+        return;
+    }
+
+    unlink_node(clock, node);
+}
+
+static void drop_cb(lv_cache_t * cache, const void * key, void * user_data)
+{
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+    LV_ASSERT_NULL(key);
+
+    if(clock == NULL || key == NULL) {
+        return;
+    }
+
+    lv_rb_node_t * node = lv_rb_find(&clock->rb, key);
+    if(node == NULL) {
+        return;
+    }
+
+    void * data = node->data;
+    clock->cache.ops.free_cb(data, user_data);
+
+    unlink_node(clock, node);
+    lv_cache_entry_delete(lv_cache_entry_get_entry(data, cache->node_size));
+}
+
+static void drop_all_cb(lv_cache_t * cache, void * user_data)
+{
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+
+    if(clock == NULL) {
+        return;
+    }
+
+    uint32_t used_cnt = 0;
+    free_list(clock, &clock->probation_ll, user_data, &used_cnt);
+    free_list(clock, &clock->protected_ll, user_data, &used_cnt);
+    if(used_cnt > 0) {
+        LV_LOG_WARN("%" LV_PRId32 " entries are still referenced", used_cnt);
+    }
+
+    lv_rb_destroy(&clock->rb);
+    lv_ll_clear(&clock->probation_ll);
+    lv_ll_clear(&clock->protected_ll);
+
+    cache->size = 0;
+    clock->protected_size = 0;
+}
+
+static lv_cache_entry_t * get_victim_cb(lv_cache_t * cache, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+
+    /*The oldest entry of the probation list which is not in use*/
+    lv_rb_node_t ** tail;
+    LV_LL_READ_BACK(&clock->probation_ll, tail) {
+        lv_cache_entry_t * entry = lv_cache_entry_get_entry((*tail)->data, cache->node_size);
+        if(lv_cache_entry_get_ref(entry) == 0) {
+            return entry;
+        }
+    }
+
+    /*Sweep the protected list. After one round all the reference bits are cleared
+     *so two rounds are enough to find a victim if there is any.*/
+    uint32_t step_max = lv_ll_get_len(&clock->protected_ll) * 2;
+    uint32_t i;
+    for(i = 0; i < step_max; i++) {
+        void * ll_node = lv_ll_get_tail(&clock->protected_ll);
+        lv_rb_node_t * node = *(lv_rb_node_t **)ll_node;
+        clock_meta_t * meta = get_meta(clock, node);
+        lv_cache_entry_t * entry = lv_cache_entry_get_entry(node->data, cache->node_size);
+
+        if(meta->referenced == 0 && lv_cache_entry_get_ref(entry) == 0) {
+            return entry;
+        }
+
+        meta->referenced = 0;
+        lv_ll_move_before(&clock->protected_ll, ll_node, lv_ll_get_head(&clock->protected_ll));
+    }
+
+    return NULL;
+}
+
+static lv_cache_reserve_cond_res_t reserve_cond_cb(lv_cache_t * cache, const void * key, size_t reserved_size,
+                                                   void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_clock_rb_t_ * clock = (lv_clock_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(clock);
+
+    if(clock == NULL) {
+        return LV_CACHE_RESERVE_COND_ERROR;
+    }
+
+    uint32_t data_size = key ? clock->get_data_size_cb(key) : 0;
+    if(data_size > clock->cache.max_size) {
+        LV_LOG_ERROR("data size (%" LV_PRIu32 ") is larger than max size (%" LV_PRIu32 ")", data_size, clock->cache.max_size);
+        return LV_CACHE_RESERVE_COND_TOO_LARGE;
+    }
+
+    return cache->size + reserved_size + data_size > clock->cache.max_size
+           ? LV_CACHE_RESERVE_COND_NEED_VICTIM
+           : LV_CACHE_RESERVE_COND_OK;
+}
+
+/**
+ * Remove a node from the tree and from its list, but don't free its data
+ * @param clock     pointer to a clock cache
+ * @param node      the node to remove
+ */
+static void unlink_node(lv_clock_rb_t_ * clock, lv_rb_node_t * node)
+{
+    void * data = node->data;
+    clock_meta_t * meta = get_meta(clock, node);
+    uint32_t data_size = clock->get_data_size_cb(data);
+
+    if(meta->is_protected) {
+        lv_ll_remove(&clock->protected_ll, meta->ll_node);
+        clock->protected_size -= data_size;
+    }
+    else {
+        lv_ll_remove(&clock->probation_ll, meta->ll_node);
+    }
+    lv_free(meta->ll_node);
+
+    lv_rb_remove_node(&clock->rb, node);
+    clock->cache.size -= data_size;
+}
+
+/**
+ * Demote entries from the protected list until it fits into its share of the cache.
+ * Referenced entries get a second chance.
+ * @param clock     pointer to a clock cache
+ */
+static void balance_protected(lv_clock_rb_t_ * clock)
+{
+    uint32_t protected_max = (uint32_t)((uint64_t)clock->cache.max_size * PROTECTED_RATIO / 100);
+
+    /*Every step either clears a reference bit or demotes an entry so it terminates*/
+    while(clock->protected_size > protected_max && lv_ll_get_len(&clock->protected_ll) > 1) {
+        void * ll_node = lv_ll_get_tail(&clock->protected_ll);
+        lv_rb_node_t * node = *(lv_rb_node_t **)ll_node;
+        clock_meta_t * meta = get_meta(clock, node);
+
+        if(meta->referenced) {
+            meta->referenced = 0;
+            lv_ll_move_before(&clock->protected_ll, ll_node, lv_ll_get_head(&clock->protected_ll));
+            continue;
+        }
+
+        lv_ll_chg_list(&clock->protected_ll, &clock->probation_ll, ll_node, true);
+        meta->is_protected = 0;
+        clock->protected_size -= clock->get_data_size_cb(node->data);
+    }
+}
+
+static void free_list(lv_clock_rb_t_ * clock, lv_ll_t * ll, void * user_data, uint32_t * used_cnt)
+{
+    lv_rb_node_t ** node;
+    LV_LL_READ(ll, node) {
+        /*free user handled data and do other clean up*/
+        void * search_key = (*node)->data;
+        lv_cache_entry_t * entry = lv_cache_entry_get_entry(search_key, clock->cache.node_size);
+        if(lv_cache_entry_get_ref(entry) == 0) {
+            clock->cache.ops.free_cb(search_key, user_data);
+        }
+        else {
+            LV_LOG_WARN("entry (%p) is still referenced (%" LV_PRId32 ")", (void *)entry, lv_cache_entry_get_ref(entry));
+            (*used_cnt)++;
+        }
+    }
+}
+
+static uint32_t cnt_get_data_size_cb(const void * data)
+{
+    LV_UNUSED(data);
+    return 1;
+}
+
+static uint32_t size_get_data_size_cb(const void * data)
+{
+    lv_cache_slot_size_t * slot = (lv_cache_slot_size_t *)data;
+    return slot->size;
+}
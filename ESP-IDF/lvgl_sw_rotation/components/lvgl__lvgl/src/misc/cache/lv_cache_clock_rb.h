@@ -0,0 +1,60 @@
+/**
+* @file lv_cache_clock_rb.h
+*
+*/
+
+#ifndef LV_CACHE_CLOCK_RB_H
+#define LV_CACHE_CLOCK_RB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_cache_entry.h"
+#include "lv_cache_private.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * Get the current tick of the clock which tells the correlated hits of a CLOCK cache apart,
+ * e.g. the number of display refreshes.
+ */
+typedef uint32_t (*lv_cache_clock_rb_tick_cb_t)(void);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Set the clock of a CLOCK cache. The hits of an entry in the first `correlated_cnt` ticks after
+ * it was added are correlated (e.g. the lookups of an image while a frame is drawn) and don't promote it.
+ * Without a clock, which is the default, any hit of an entry in the probation list promotes it.
+ * @param cache             a cache created with `lv_cache_class_clock_rb_count` or `lv_cache_class_clock_rb_size`
+ * @param tick_cb           returns the current tick, NULL to promote on any hit
+ * @param correlated_cnt    the number of ticks after adding an entry in which its hits don't promote it
+ */
+void lv_cache_clock_rb_set_tick_cb(lv_cache_t * cache, lv_cache_clock_rb_tick_cb_t tick_cb, uint32_t correlated_cnt);
+
+/*************************
+ *    GLOBAL VARIABLES
+ *************************/
+LV_ATTRIBUTE_EXTERN_DATA extern const lv_cache_class_t lv_cache_class_clock_rb_count;
+LV_ATTRIBUTE_EXTERN_DATA extern const lv_cache_class_t lv_cache_class_clock_rb_size;
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_CACHE_CLOCK_RB_H*/
@@ -77,6 +77,7 @@ static bool init_size_cb(lv_cache_t * cache);
 static void  destroy_cb(lv_cache_t * cache, void * user_data);
 
 static lv_cache_entry_t * get_cb(lv_cache_t * cache, const void * key, void * user_data);
+static lv_cache_entry_t * peek_cb(lv_cache_t * cache, const void * key, void * user_data);
 static lv_cache_entry_t * add_cb(lv_cache_t * cache, const void * key, void * user_data);
 static void remove_cb(lv_cache_t * cache, lv_cache_entry_t * entry, void * user_data);
 static void drop_cb(lv_cache_t * cache, const void * key, void * user_data);
@@ -100,6 +101,7 @@ const lv_cache_class_t lv_cache_class_lru_rb_count = {
     .destroy_cb = destroy_cb,
 
     .get_cb = get_cb,
+    .peek_cb = peek_cb,
     .add_cb = add_cb,
     .remove_cb = remove_cb,
     .drop_cb = drop_cb,
@@ -114,6 +116,7 @@ const lv_cache_class_t lv_cache_class_lru_rb_size = {
     .destroy_cb = destroy_cb,
 
     .get_cb = get_cb,
+    .peek_cb = peek_cb,
     .add_cb = add_cb,
     .remove_cb = remove_cb,
     .drop_cb = drop_cb,
@@ -288,6 +291,23 @@ static lv_cache_entry_t * get_cb(lv_cache_t * cache, const void * key, void * us
     return NULL;
 }
 
+static lv_cache_entry_t * peek_cb(lv_cache_t * cache, const void * key, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_lru_rb_t_ * lru = (lv_lru_rb_t_ *)cache;
+
+    LV_ASSERT_NULL(lru);
+    LV_ASSERT_NULL(key);
+
+    if(lru == NULL || key == NULL) {
+        return NULL;
+    }
+
+    lv_rb_node_t * node = lv_rb_find(&lru->rb, key);
+    return node ? lv_cache_entry_get_entry(node->data, cache->node_size) : NULL;
+}
+
 static lv_cache_entry_t * add_cb(lv_cache_t * cache, const void * key, void * user_data)
 {
     LV_UNUSED(user_data);
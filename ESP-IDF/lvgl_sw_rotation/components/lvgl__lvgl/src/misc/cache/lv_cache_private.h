@@ -72,6 +72,12 @@ typedef void (*lv_cache_destroy_cb_t)(lv_cache_t * cache, void * user_data);
  */
 typedef lv_cache_entry_t * (*lv_cache_get_cb_t)(lv_cache_t * cache, const void * key, void * user_data);
 
+/**
+ * The cache peek function, used by the cache class to find a cache entry by its key without changing its priority.
+ * @return `NULL` if the key is not found.
+ */
+typedef lv_cache_entry_t * (*lv_cache_peek_cb_t)(lv_cache_t * cache, const void * key, void * user_data);
+
 /**
  * The cache add function, used by the cache class to add a cache entry with a given key.
  * This function only cares about how to add the entry, it doesn't check if the entry already exists and doesn't care about is it a victim or not.
@@ -107,6 +113,15 @@ typedef lv_cache_entry_t * (*lv_cache_get_victim_cb)(lv_cache_t * cache, void *
 typedef lv_cache_reserve_cond_res_t (*lv_cache_reserve_cond_cb)(lv_cache_t * cache, const void * key, size_t size,
                                                                 void * user_data);
 
+/**
+ * Statistics of a cache, see `lv_cache_get_stats`
+ */
+typedef struct {
+    uint32_t hit_cnt;                 /**< Number of lookups which found the entry */
+    uint32_t miss_cnt;                /**< Number of lookups which didn't find the entry */
+    uint32_t evict_cnt;               /**< Number of entries evicted to make room for new entries */
+} lv_cache_stats_t;
+
 /**
  * The cache operations struct
  */
@@ -120,9 +135,11 @@ struct lv_cache_ops_t {
  * The cache entry struct
  */
 struct lv_cache_t {
-    const lv_cache_class_t * clz;     /**< Cache class. There are two built-in classes:
+    const lv_cache_class_t * clz;     /**< Cache class. The built-in classes are:
                                        * - lv_cache_class_lru_rb_count for LRU-based cache with count-based eviction policy.
-                                       * - lv_cache_class_lru_rb_size for LRU-based cache with size-based eviction policy. */
+                                       * - lv_cache_class_lru_rb_size for LRU-based cache with size-based eviction policy.
+                                       * - lv_cache_class_clock_rb_count for scan resistant cache with count-based eviction policy.
+                                       * - lv_cache_class_clock_rb_size for scan resistant cache with size-based eviction policy. */
 
     uint32_t node_size;               /**< Size of a node */
 
@@ -134,6 +151,8 @@ struct lv_cache_t {
     lv_mutex_t lock;                  /**< Cache lock used to protect the cache in multithreading environments */
 
     const char * name;                /**< Name of the cache */
+
+    lv_cache_stats_t stats;           /**< Hit, miss and eviction counters */
 };
 
 /**
@@ -142,6 +161,7 @@ struct lv_cache_t {
  * Examples:
  * - lv_cache_class_lru_rb_count for LRU-based cache with count-based eviction policy.
  * - lv_cache_class_lru_rb_size for LRU-based cache with size-based eviction policy.
+ * - lv_cache_class_clock_rb_size for scan resistant cache with size-based eviction policy.
  */
 struct lv_cache_class_t {
     lv_cache_alloc_cb_t alloc_cb;                 /**< The allocation function for cache entries */
@@ -149,6 +169,7 @@ struct lv_cache_class_t {
     lv_cache_destroy_cb_t destroy_cb;             /**< The destruction function for cache entries */
 
     lv_cache_get_cb_t get_cb;                     /**< The get function for cache entries */
+    lv_cache_peek_cb_t peek_cb;                   /**< The peek function for cache entries (optional) */
     lv_cache_add_cb_t add_cb;                     /**< The add function for cache entries */
     lv_cache_remove_cb_t remove_cb;               /**< The remove function for cache entries */
     lv_cache_drop_cb_t drop_cb;                   /**< The drop function for cache entries */
@@ -20,6 +20,9 @@
 
 #define CACHE_NAME  "IMAGE"
 
+/*Number of display refreshes after caching an image in which its hits don't promote it (scan resistant cache)*/
+#define CORRELATED_REFR_CNT 4
+
 #define img_cache_p (LV_GLOBAL_DEFAULT()->img_cache)
 #define image_cache_draw_buf_handlers &(LV_GLOBAL_DEFAULT()->image_cache_draw_buf_handlers)
 
@@ -34,6 +37,9 @@
 static lv_cache_compare_res_t image_cache_compare_cb(const lv_image_cache_data_t * lhs,
                                                      const lv_image_cache_data_t * rhs);
 static void image_cache_free_cb(lv_image_cache_data_t * entry, void * user_data);
+#if LV_IMAGE_CACHE_SCAN_RESISTANT
+static uint32_t image_cache_tick_cb(void);
+#endif
 
 /**********************
  *  GLOBAL VARIABLES
@@ -57,15 +63,30 @@ lv_result_t lv_image_cache_init(uint32_t size)
         return LV_RESULT_OK;
     }
 
-    img_cache_p = lv_cache_create(&lv_cache_class_lru_rb_size,
+#if LV_IMAGE_CACHE_SCAN_RESISTANT
+    const lv_cache_class_t * cache_class = &lv_cache_class_clock_rb_size;
+#else
+    const lv_cache_class_t * cache_class = &lv_cache_class_lru_rb_size;
+#endif
+
+    img_cache_p = lv_cache_create(cache_class,
     sizeof(lv_image_cache_data_t), size, (lv_cache_ops_t) {
         .compare_cb = (lv_cache_compare_cb_t) image_cache_compare_cb,
         .create_cb = NULL,
         .free_cb = (lv_cache_free_cb_t) image_cache_free_cb,
     });
 
+    if(img_cache_p == NULL) {
+        return LV_RESULT_INVALID;
+    }
+
+#if LV_IMAGE_CACHE_SCAN_RESISTANT
+    /*The images are looked up while the displays are refreshed, so the frames tell the reuses apart*/
+    lv_cache_clock_rb_set_tick_cb(img_cache_p, image_cache_tick_cb, CORRELATED_REFR_CNT);
+#endif
+
     lv_cache_set_name(img_cache_p, CACHE_NAME);
-    return img_cache_p != NULL ? LV_RESULT_OK : LV_RESULT_INVALID;
+    return LV_RESULT_OK;
 }
 
 void lv_image_cache_resize(uint32_t new_size, bool evict_now)
@@ -99,6 +120,11 @@ bool lv_image_cache_is_enabled(void)
     return lv_cache_is_enabled(img_cache_p);
 }
 
+void lv_image_cache_get_stats(lv_cache_stats_t * stats)
+{
+    lv_cache_get_stats(img_cache_p, stats);
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -143,3 +169,10 @@ static void image_cache_free_cb(lv_image_cache_data_t * entry, void * user_data)
     /*Free the duplicated file name*/
     if(entry->src_type == LV_IMAGE_SRC_FILE) lv_free((void *)entry->src);
 }
+
+#if LV_IMAGE_CACHE_SCAN_RESISTANT
+static uint32_t image_cache_tick_cb(void)
+{
+    return LV_GLOBAL_DEFAULT()->refr_cnt;
+}
+#endif
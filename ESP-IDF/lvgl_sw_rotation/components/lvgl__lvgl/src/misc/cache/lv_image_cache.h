@@ -16,6 +16,7 @@ extern "C" {
 
 #include "../../lv_conf_internal.h"
 #include "../lv_types.h"
+#include "lv_cache_private.h"
 
 /*********************
  *      DEFINES
@@ -56,6 +57,12 @@ void lv_image_cache_drop(const void * src);
  */
 bool lv_image_cache_is_enabled(void);
 
+/**
+ * Get the hit, miss and eviction counters of the image cache.
+ * @param stats     pointer to a statistics struct to fill
+ */
+void lv_image_cache_get_stats(lv_cache_stats_t * stats);
+
 /*************************
  *    GLOBAL VARIABLES
  *************************/
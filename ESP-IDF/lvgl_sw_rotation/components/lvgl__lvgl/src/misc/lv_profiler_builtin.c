@@ -58,6 +58,7 @@ typedef struct lv_profiler_builtin_ctx_t {
     lv_profiler_builtin_item_t * item_arr; /**< Pointer to an array of profiler items */
     uint32_t item_num;                     /**< Number of profiler items in the array */
     uint32_t cur_index;                    /**< Index of the current profiler item */
+    bool wrapped;                          /**< In ring mode: the buffer was filled and older items were overwritten */
     lv_profiler_builtin_config_t config;   /**< Configuration for the built-in profiler */
     bool enable;                           /**< Whether the built-in profiler is enabled */
 #if LV_USE_OS
@@ -73,6 +74,7 @@ static void default_flush_cb(const char * buf);
 static int default_tid_get_cb(void);
 static int default_cpu_get_cb(void);
 static void flush_no_lock(void);
+static void flush_item(const lv_profiler_builtin_item_t * item, char * buf, uint32_t buf_size);
 
 /**********************
  *  STATIC VARIABLES
@@ -185,7 +187,13 @@ void lv_profiler_builtin_write(const char * func, char tag)
     LV_PROFILER_MULTEX_LOCK;
 
     if(profiler_ctx->cur_index >= profiler_ctx->item_num) {
-        flush_no_lock();
+        if(profiler_ctx->config.ring_mode) {
+            /*Keep recording, the oldest items will be overwritten*/
+            profiler_ctx->wrapped = true;
+        }
+        else {
+            flush_no_lock();
+        }
         profiler_ctx->cur_index = 0;
     }
 
@@ -230,33 +238,58 @@ static void flush_no_lock(void)
         return;
     }
 
-    uint32_t cur = 0;
     char buf[LV_PROFILER_STR_MAX_LEN];
+
+    /*Before the ring wrapped the oldest item is the first one, then the one which will be overwritten next*/
+    uint32_t item_num = profiler_ctx->wrapped ? profiler_ctx->item_num : profiler_ctx->cur_index;
+    uint32_t start = profiler_ctx->wrapped ? profiler_ctx->cur_index : 0;
+    uint32_t skip = 0;
+
+    if(profiler_ctx->config.ring_mode && profiler_ctx->config.ring_keep_ms && item_num) {
+        uint32_t last = (start + item_num - 1) % profiler_ctx->item_num;
+        uint32_t last_tick = profiler_ctx->item_arr[last].tick;
+        uint64_t keep_tick = (uint64_t)profiler_ctx->config.ring_keep_ms * profiler_ctx->config.tick_per_sec / 1000;
+
+        /*Skip the items which are older than the kept time window*/
+        while(skip < item_num) {
+            const lv_profiler_builtin_item_t * item = &profiler_ctx->item_arr[(start + skip) % profiler_ctx->item_num];
+            if((uint32_t)(last_tick - item->tick) <= keep_tick) break;
+            skip++;
+        }
+    }
+
+    for(uint32_t i = skip; i < item_num; i++) {
+        flush_item(&profiler_ctx->item_arr[(start + i) % profiler_ctx->item_num], buf, sizeof(buf));
+    }
+
+    profiler_ctx->cur_index = 0;
+    profiler_ctx->wrapped = false;
+}
+
+static void flush_item(const lv_profiler_builtin_item_t * item, char * buf, uint32_t buf_size)
+{
     uint32_t tick_per_sec = profiler_ctx->config.tick_per_sec;
-    while(cur < profiler_ctx->cur_index) {
-        lv_profiler_builtin_item_t * item = &profiler_ctx->item_arr[cur++];
-        uint32_t sec = item->tick / tick_per_sec;
-        uint32_t usec = (item->tick % tick_per_sec) * (LV_PROFILER_TICK_PER_SEC_MAX / tick_per_sec);
+    uint32_t sec = item->tick / tick_per_sec;
+    uint32_t usec = (item->tick % tick_per_sec) * (LV_PROFILER_TICK_PER_SEC_MAX / tick_per_sec);
 
 #if LV_USE_OS
-        lv_snprintf(buf, sizeof(buf),
-                    "   LVGL-%d [%d] %" LV_PRIu32 ".%06" LV_PRIu32 ": tracing_mark_write: %c|1|%s\n",
-                    item->tid,
-                    item->cpu,
-                    sec,
-                    usec,
-                    item->tag,
-                    item->func);
+    lv_snprintf(buf, buf_size,
+                "   LVGL-%d [%d] %" LV_PRIu32 ".%06" LV_PRIu32 ": tracing_mark_write: %c|1|%s\n",
+                item->tid,
+                item->cpu,
+                sec,
+                usec,
+                item->tag,
+                item->func);
 #else
-        lv_snprintf(buf, sizeof(buf),
-                    "   LVGL-1 [0] %" LV_PRIu32 ".%06" LV_PRIu32 ": tracing_mark_write: %c|1|%s\n",
-                    sec,
-                    usec,
-                    item->tag,
-                    item->func);
+    lv_snprintf(buf, buf_size,
+                "   LVGL-1 [0] %" LV_PRIu32 ".%06" LV_PRIu32 ": tracing_mark_write: %c|1|%s\n",
+                sec,
+                usec,
+                item->tag,
+                item->func);
 #endif
-        profiler_ctx->config.flush_cb(buf);
-    }
+    profiler_ctx->config.flush_cb(buf);
 }
 
 #endif /*LV_USE_PROFILER_BUILTIN*/
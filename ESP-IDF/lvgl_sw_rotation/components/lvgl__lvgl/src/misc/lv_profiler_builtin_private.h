@@ -36,6 +36,8 @@ struct lv_profiler_builtin_config_t {
     void (*flush_cb)(const char * buf); /**< Callback function to flush the profiling data */
     int (*tid_get_cb)(void);            /**< Callback function to get the current thread ID */
     int (*cpu_get_cb)(void);            /**< Callback function to get the current CPU */
+    bool ring_mode;                     /**< Overwrite the oldest items instead of flushing when the buffer is full */
+    uint32_t ring_keep_ms;              /**< In ring mode only flush the items of the last N ms (0: all buffered items) */
 };
 
 
@@ -201,6 +201,7 @@ static void perf_monitor_disp_event_cb(lv_event_t * e)
             info->measured.render_in_progress = 0;
             info->measured.render_elaps_sum += lv_tick_elaps(info->measured.render_start);
             info->measured.render_cnt++;
+            info->measured.render_px_sum += lv_display_get_refr_px_count(disp);
             break;
         case LV_EVENT_FLUSH_START:
         case LV_EVENT_FLUSH_WAIT_START:
@@ -258,6 +259,11 @@ static void perf_update_timer_cb(lv_timer_t * t)
                                                                      info->measured.flush_in_render_elaps_sum) /
                                                                     info->measured.render_cnt) : 0;
 
+    info->calculated.render_px_avg = info->measured.render_cnt ? (uint32_t)(info->measured.render_px_sum /
+                                                                           info->measured.render_cnt) : 0;
+    uint32_t scr_px = lv_display_get_horizontal_resolution(disp) * lv_display_get_vertical_resolution(disp);
+    info->calculated.render_px_pct = scr_px ? (uint32_t)((uint64_t)info->calculated.render_px_avg * 100 / scr_px) : 0;
+
     info->calculated.cpu_avg_total = ((info->calculated.cpu_avg_total * (info->calculated.run_cnt - 1)) +
                                       info->calculated.cpu) / info->calculated.run_cnt;
     info->calculated.fps_avg_total = ((info->calculated.fps_avg_total * (info->calculated.run_cnt - 1)) +
@@ -284,19 +290,22 @@ static void perf_observer_cb(lv_observer_t * observer, lv_subject_t * subject)
     LV_LOG("sysmon: "
            "%" LV_PRIu32 " FPS (refr_cnt: %" LV_PRIu32 " | redraw_cnt: %" LV_PRIu32"), "
            "refr %" LV_PRIu32 "ms (render %" LV_PRIu32 "ms | flush %" LV_PRIu32 "ms), "
-           "CPU %" LV_PRIu32 "%%\n",
+           "CPU %" LV_PRIu32 "%%, "
+           "redraw %" LV_PRIu32 " px (%" LV_PRIu32 "%%)\n",
            perf->calculated.fps, perf->measured.refr_cnt, perf->measured.render_cnt,
            perf->calculated.refr_avg_time, perf->calculated.render_avg_time, perf->calculated.flush_avg_time,
-           perf->calculated.cpu);
+           perf->calculated.cpu, perf->calculated.render_px_avg, perf->calculated.render_px_pct);
 #else
     lv_obj_t * label = lv_observer_get_target(observer);
     lv_label_set_text_fmt(
         label,
         "%" LV_PRIu32" FPS, %" LV_PRIu32 "%% CPU\n"
-        "%" LV_PRIu32" ms (%" LV_PRIu32" | %" LV_PRIu32")",
+        "%" LV_PRIu32" ms (%" LV_PRIu32" | %" LV_PRIu32")\n"
+        "%" LV_PRIu32" px (%" LV_PRIu32"%%) redrawn",
         perf->calculated.fps, perf->calculated.cpu,
         perf->calculated.render_avg_time + perf->calculated.flush_avg_time,
-        perf->calculated.render_avg_time, perf->calculated.flush_avg_time
+        perf->calculated.render_avg_time, perf->calculated.flush_avg_time,
+        perf->calculated.render_px_avg, perf->calculated.render_px_pct
     );
 #endif /*LV_USE_PERF_MONITOR_LOG_MODE*/
 }
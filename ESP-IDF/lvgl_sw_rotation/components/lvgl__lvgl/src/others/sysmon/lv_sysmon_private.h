@@ -42,6 +42,7 @@ struct lv_sysmon_perf_info_t {
         uint32_t render_start;
         uint32_t render_elaps_sum; /*Contains the flush time too*/
         uint32_t render_cnt;
+        uint64_t render_px_sum;
         uint32_t flush_in_render_start;
         uint32_t flush_in_render_elaps_sum;
         uint32_t flush_not_in_render_start;
@@ -56,6 +57,8 @@ struct lv_sysmon_perf_info_t {
         uint32_t refr_avg_time;
         uint32_t render_avg_time;       /**< Pure rendering time without flush time*/
         uint32_t flush_avg_time;        /**< Pure flushing time without rendering time*/
+        uint32_t render_px_avg;         /**< Average number of pixels rendered in a refresh*/
+        uint32_t render_px_pct;         /**< `render_px_avg` in percentage of the screen*/
         uint32_t cpu_avg_total;
         uint32_t fps_avg_total;
         uint32_t run_cnt;
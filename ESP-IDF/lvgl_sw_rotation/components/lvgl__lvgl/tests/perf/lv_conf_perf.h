@@ -0,0 +1,41 @@
+/**
+ * @file lv_conf_perf.h
+ * Configuration of the headless performance regression runner.
+ * Everything not set here takes the default value of `lv_conf_internal.h`.
+ */
+
+#ifndef LV_CONF_PERF_H
+#define LV_CONF_PERF_H
+
+#define LV_CONF_SUPPRESS_DEFINE_CHECK 1
+
+/*Match the typical MCU setup: RGB565 rendered by a single SW draw unit without an OS*/
+#define LV_COLOR_DEPTH              16
+#define LV_USE_OS                   LV_OS_NONE
+#define LV_DRAW_SW_DRAW_UNIT_CNT    1
+
+/*Cache the blurred corners of the shadows, see "Multiple box shadows"*/
+#define LV_DRAW_SW_SHADOW_CACHE_SIZE        64
+#define LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE    (16 * 1024)
+
+/*Use the built-in heap so that its high-water mark can be reported*/
+#define LV_USE_STDLIB_MALLOC        LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_STRING        LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_SPRINTF       LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE                 (4 * 1024 * 1024U)
+
+#define LV_USE_LOG                  0
+#define LV_USE_ASSERT_NULL          1
+#define LV_USE_ASSERT_MALLOC        1
+
+#define LV_FONT_MONTSERRAT_12       1
+#define LV_FONT_MONTSERRAT_14       1
+#define LV_FONT_MONTSERRAT_16       1
+#define LV_FONT_MONTSERRAT_18       1
+#define LV_FONT_MONTSERRAT_20       1
+#define LV_FONT_MONTSERRAT_24       1
+
+#define LV_USE_DEMO_WIDGETS         1
+#define LV_USE_DEMO_BENCHMARK       1
+
+#endif /*LV_CONF_PERF_H*/
@@ -0,0 +1,173 @@
+/**
+ * @file lv_perf_benchmark.c
+ *
+ * Headless runner of the benchmark demo's scenes.
+ * Every scene is rendered on a fresh LVGL instance with a fake tick, so the rendered content is deterministic,
+ * and the measurements are printed to stdout as JSON.
+ *
+ * Usage: lv_perf_benchmark [frames_per_scene]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+#include "demos/lv_demos.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         800
+#define VER_RES         480
+#define BUF_LINES       48
+#define FRAMES_DEF      100
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    uint64_t refr_start_ns;
+    uint64_t refr_time_sum_ns;
+    uint64_t refr_time_max_ns;
+    uint32_t refr_cnt;
+    uint64_t flush_px;
+} scene_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static void run_scene(uint32_t scene, uint32_t frames, bool last);
+static void flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map);
+static void refr_event_cb(lv_event_t * e);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static scene_result_t result;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : FRAMES_DEF;
+    if(frames == 0) frames = FRAMES_DEF;
+
+    /*Only to get the scene count*/
+    lv_init();
+    uint32_t scene_cnt = lv_demo_benchmark_get_scene_count();
+    lv_deinit();
+
+    printf("{\n");
+    printf("  \"lvgl\": \"%d.%d.%d\",\n", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+    printf("  \"hor_res\": %d,\n  \"ver_res\": %d,\n  \"color_depth\": %d,\n", HOR_RES, VER_RES, LV_COLOR_DEPTH);
+    printf("  \"frames\": %u,\n", (unsigned)frames);
+    printf("  \"scenes\": [\n");
+
+    uint32_t i;
+    for(i = 0; i < scene_cnt; i++) {
+        run_scene(i, frames, i == scene_cnt - 1);
+    }
+
+    printf("  ]\n}\n");
+
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void run_scene(uint32_t scene, uint32_t frames, bool last)
+{
+    /*Start from a clean state to make the memory high-water mark belong to this scene only*/
+    lv_init();
+
+    static uint8_t buf[HOR_RES * BUF_LINES * 2 + LV_DRAW_BUF_ALIGN];
+    lv_display_t * disp = lv_display_create(HOR_RES, VER_RES);
+    lv_display_set_buffers(disp, lv_draw_buf_align(buf, LV_COLOR_FORMAT_RGB565), NULL, HOR_RES * BUF_LINES * 2,
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    lv_demo_benchmark_load_scene(scene);
+
+    /*Render the initial state of the scene once, it's not part of the measurement*/
+    lv_refr_now(disp);
+
+    lv_memzero(&result, sizeof(result));
+    uint32_t blend_px_start = lv_draw_sw_blend_get_px_count();
+
+    uint32_t i;
+    for(i = 0; i < frames; i++) {
+        lv_tick_inc(LV_DEF_REFR_PERIOD);
+        lv_timer_handler();
+    }
+
+    uint32_t blend_px = lv_draw_sw_blend_get_px_count() - blend_px_start;
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    lv_cache_stats_t shadow_stats;
+    lv_memzero(&shadow_stats, sizeof(shadow_stats));
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE
+    lv_draw_sw_shadow_cache_get_stats(&shadow_stats);
+#endif
+
+    uint32_t refr_cnt = result.refr_cnt ? result.refr_cnt : 1;
+    printf("    {\"name\": \"%s\", \"refr_cnt\": %u, \"render_time_avg_us\": %u, \"render_time_max_us\": %u, "
+           "\"blend_px\": %u, \"flush_px\": %llu, \"mem_max_used\": %u, "
+           "\"shadow_cache_hit\": %u, \"shadow_cache_miss\": %u}%s\n",
+           lv_demo_benchmark_get_scene_name(scene),
+           (unsigned)result.refr_cnt,
+           (unsigned)(result.refr_time_sum_ns / refr_cnt / 1000),
+           (unsigned)(result.refr_time_max_ns / 1000),
+           (unsigned)blend_px,
+           (unsigned long long)result.flush_px,
+           (unsigned)mon.max_used,
+           (unsigned)shadow_stats.hit_cnt,
+           (unsigned)shadow_stats.miss_cnt,
+           last ? "" : ",");
+    fflush(stdout);
+
+    lv_deinit();
+}
+
+static void flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    LV_UNUSED(px_map);
+    result.flush_px += lv_area_get_size(area);
+    lv_display_flush_ready(disp);
+}
+
+static void refr_event_cb(lv_event_t * e)
+{
+    if(lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        result.refr_start_ns = time_ns();
+        return;
+    }
+
+    uint64_t t = time_ns() - result.refr_start_ns;
+    result.refr_time_sum_ns += t;
+    if(t > result.refr_time_max_ns) result.refr_time_max_ns = t;
+    result.refr_cnt++;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
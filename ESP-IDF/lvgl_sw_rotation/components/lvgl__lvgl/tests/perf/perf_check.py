@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import subprocess
+import sys
+from pathlib import Path
+
+# Metrics which depend only on the rendered content
+CONTENT_METRICS = ['blend_px', 'flush_px', 'mem_max_used']
+# Metrics which depend on the machine running the test
+TIME_METRICS = ['render_time_avg_us']
+
+
+def get_arg():
+    parser = argparse.ArgumentParser(description='Run the headless benchmark and compare it with a baseline.')
+    parser.add_argument('--runner', required=True, type=str,
+                        help='Path of the lv_perf_benchmark executable.')
+    parser.add_argument('--frames', type=int, default=100,
+                        help='Number of frames rendered per scene.')
+    parser.add_argument('--baseline', required=True, type=str,
+                        help='The baseline JSON file.')
+    parser.add_argument('--output', type=str,
+                        help='Save the result of this run to this JSON file.')
+    parser.add_argument('--threshold', type=float, default=10,
+                        help='Allowed regression compared to the baseline in percent.')
+    parser.add_argument('--no-time', action='store_true',
+                        help='Do not check the render time, only the machine independent metrics.')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='Write the result to the baseline file instead of comparing.')
+
+    return parser.parse_args()
+
+
+def compare(baseline, result, metrics, threshold):
+    base_scenes = {scene['name']: scene for scene in baseline['scenes']}
+    failed = []
+
+    print('%-28s %-20s %14s %14s %9s' % ('Scene', 'Metric', 'Baseline', 'Result', 'Diff'))
+    for scene in result['scenes']:
+        base = base_scenes.get(scene['name'])
+        if base is None:
+            print('%-28s new scene, no baseline' % scene['name'])
+            continue
+
+        for metric in metrics:
+            old = base[metric]
+            new = scene[metric]
+            diff = (new - old) * 100.0 / old if old else (0.0 if new == old else 100.0)
+            mark = ''
+            if diff > threshold:
+                mark = '  <-- REGRESSION'
+                failed.append('%s: %s' % (scene['name'], metric))
+            print('%-28s %-20s %14d %14d %+8.1f%%%s' % (scene['name'], metric, old, new, diff, mark))
+
+    return failed
+
+
+if __name__ == '__main__':
+    args = get_arg()
+
+    proc = subprocess.run([args.runner, str(args.frames)], stdout=subprocess.PIPE, check=True)
+    result = json.loads(proc.stdout)
+
+    if args.output:
+        Path(args.output).write_text(json.dumps(result, indent=2) + '\n')
+
+    if args.update_baseline:
+        Path(args.baseline).write_text(json.dumps(result, indent=2) + '\n')
+        print('Baseline updated:', args.baseline)
+        sys.exit(0)
+
+    baseline = json.loads(Path(args.baseline).read_text())
+    if baseline['frames'] != result['frames']:
+        print('The baseline was recorded with %d frames per scene, but %d were rendered now'
+              % (baseline['frames'], result['frames']))
+        sys.exit(1)
+
+    metrics = CONTENT_METRICS + ([] if args.no_time else TIME_METRICS)
+    failed = compare(baseline, result, metrics, args.threshold)
+
+    if failed:
+        print('\n%d metric(s) regressed more than %.1f%%:' % (len(failed), args.threshold))
+        for f in failed:
+            print('  ' + f)
+        sys.exit(1)
+
+    print('\nNo regression above %.1f%%' % args.threshold)
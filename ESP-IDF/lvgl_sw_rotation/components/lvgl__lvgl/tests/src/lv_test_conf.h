@@ -23,6 +23,8 @@ extern "C" {
 #define LV_USE_OS                   LV_OS_PTHREAD
 #define LV_OBJ_STYLE_CACHE          0
 #define LV_BIN_DECODER_RAM_LOAD     1   /* Run test with bin image loaded to RAM */
+#define LV_IMAGE_DECODER_ASYNC_THREAD_CNT   2
+#define LV_GIF_DECODE_THREAD        1
 #endif
 
 #ifdef LVGL_CI_USING_DEF_HEAP
@@ -80,6 +80,7 @@
     #define LV_USE_LIBJPEG_TURBO   1
 #endif
 #define LV_USE_GIF          1
+#define LV_GIF_FRAME_CACHE_SIZE (4 * 1024 * 1024)
 #define LV_USE_QRCODE       1
 #define LV_USE_BARCODE      1
 #define LV_USE_FRAGMENT     1
@@ -28,6 +28,10 @@ void lv_test_init(void)
     lv_sysmon_hide_performance(NULL);
 #endif
 #endif
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+    /*Most tests compare the first frame with a reference image, so don't draw placeholders*/
+    lv_image_decoder_set_async(false);
+#endif
 }
 
 void lv_test_deinit(void)
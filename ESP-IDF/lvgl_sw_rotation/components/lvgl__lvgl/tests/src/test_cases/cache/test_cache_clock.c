@@ -0,0 +1,466 @@
+#if LV_BUILD_TEST
+
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+#include "lv_test_helpers.h"
+
+#include "unity/unity.h"
+
+static uint32_t MEM_SIZE = 0;
+
+/*The clock of the CLOCK caches, counts the frames like the image cache counts the display refreshes*/
+static uint32_t frame_cnt = 0;
+
+#define CORRELATED_FRAME_CNT 4
+
+typedef struct _test_data {
+    lv_cache_slot_size_t slot;
+
+    int32_t key;
+
+    void * data; // malloced data
+} test_data;
+
+static lv_cache_compare_res_t compare_cb(const test_data * lhs, const test_data * rhs)
+{
+    if(lhs->key != rhs->key) {
+        return lhs->key > rhs->key ? 1 : -1;
+    }
+    return 0;
+}
+
+static void free_cb(test_data * node, void * user_data)
+{
+    LV_UNUSED(user_data);
+    lv_free(node->data);
+}
+
+static uint32_t frame_tick_cb(void)
+{
+    return frame_cnt;
+}
+
+static lv_cache_t * create_cache(const lv_cache_class_t * cache_class, size_t max_size)
+{
+    lv_cache_ops_t ops = {
+        .compare_cb = (lv_cache_compare_cb_t) compare_cb,
+        .create_cb = NULL,
+        .free_cb = (lv_cache_free_cb_t)free_cb,
+    };
+    lv_cache_t * cache = lv_cache_create(cache_class, sizeof(test_data), max_size, ops);
+    TEST_ASSERT_NOT_NULL(cache);
+    if(cache_class == &lv_cache_class_clock_rb_count || cache_class == &lv_cache_class_clock_rb_size) {
+        lv_cache_clock_rb_set_tick_cb(cache, frame_tick_cb, CORRELATED_FRAME_CNT);
+    }
+    return cache;
+}
+
+static void next_frame(void)
+{
+    frame_cnt++;
+}
+
+/*Skip the frames in which the hits of a new entry are correlated and don't promote it*/
+static void skip_correlated_frames(void)
+{
+    int32_t i;
+    for(i = 0; i <= CORRELATED_FRAME_CNT; i++) {
+        next_frame();
+    }
+}
+
+/**
+ * Look up a key and add it on miss like the image decoder does
+ * @return true on hit
+ */
+static bool cache_access(lv_cache_t * cache, int32_t key, uint32_t size)
+{
+    test_data search_key = {
+        .slot.size = size,
+        .key = key,
+    };
+
+    lv_cache_entry_t * entry = lv_cache_acquire(cache, &search_key, NULL);
+    if(entry != NULL) {
+        lv_cache_release(cache, entry, NULL);
+        return true;
+    }
+
+    entry = lv_cache_add(cache, &search_key, NULL);
+    TEST_ASSERT_NOT_NULL(entry);
+    test_data * data = lv_cache_entry_get_data(entry);
+    data->data = lv_malloc(8);
+    lv_cache_release(cache, entry, NULL);
+    return false;
+}
+
+/*Replay traces of a launcher: a few icons (dock, status bar) are drawn in every frame
+ *while the app grid shows many icons which are visible only for a few frames.*/
+#define TRACE_HOT_CNT       8
+#define TRACE_HOT_SIZE      (48 * 48 * 4)
+#define TRACE_HOME_CNT      12
+#define TRACE_GRID_CNT      60
+#define TRACE_GRID_VISIBLE  12
+#define TRACE_FLING_STEP    3   /*New icons in each frame of a fling*/
+#define TRACE_FLING_VISIBLE 9   /*So each icon stays visible for 3 frames*/
+#define TRACE_ICON_SIZE     (64 * 64 * 4)
+#define TRACE_FRAME_CNT     600
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t decoded_size;
+} replay_res_t;
+
+typedef void (*trace_frame_cb_t)(lv_cache_t * cache, uint32_t frame, replay_res_t * res);
+
+static void trace_draw(lv_cache_t * cache, int32_t key, uint32_t size, replay_res_t * res)
+{
+    if(!cache_access(cache, key, size)) res->decoded_size += size;
+}
+
+/*Scroll the grid by one icon in every 2nd frame, back and forth*/
+static void trace_scroll_frame(lv_cache_t * cache, uint32_t frame, replay_res_t * res)
+{
+    int32_t i;
+    for(i = 0; i < TRACE_HOT_CNT; i++) {
+        trace_draw(cache, i, TRACE_HOT_SIZE, res);
+    }
+
+    int32_t first = (frame / 2) % (2 * TRACE_GRID_CNT);
+    if(first >= TRACE_GRID_CNT) first = 2 * TRACE_GRID_CNT - first - 1;
+    for(i = 0; i < TRACE_GRID_VISIBLE; i++) {
+        trace_draw(cache, 1000 + (first + i) % TRACE_GRID_CNT, TRACE_ICON_SIZE, res);
+    }
+}
+
+/*Show the home screen for 20 frames, then fling through the app drawer for 10 frames,
+ *which shows 30 icons for a few frames each, then return to the home screen*/
+static void trace_fling_frame(lv_cache_t * cache, uint32_t frame, replay_res_t * res)
+{
+    int32_t i;
+    for(i = 0; i < TRACE_HOT_CNT; i++) {
+        trace_draw(cache, i, TRACE_HOT_SIZE, res);
+    }
+
+    uint32_t cycle = frame / 30;
+    uint32_t phase = frame % 30;
+    if(phase < 20) {
+        for(i = 0; i < TRACE_HOME_CNT; i++) {
+            trace_draw(cache, 100 + i, TRACE_ICON_SIZE, res);
+        }
+    }
+    else {
+        /*Scroll through a page of 30 icons, 3 new icons in each frame, the next page in the next cycle*/
+        int32_t page = (int32_t)((cycle * 30) % TRACE_GRID_CNT);
+        int32_t first = (int32_t)(phase - 20) * TRACE_FLING_STEP;
+        for(i = first; i < first + TRACE_FLING_VISIBLE && i < 30; i++) {
+            trace_draw(cache, 1000 + page + i, TRACE_ICON_SIZE, res);
+        }
+    }
+}
+
+static replay_res_t replay(const lv_cache_class_t * cache_class, trace_frame_cb_t frame_cb, uint32_t cache_size)
+{
+    lv_cache_t * cache = create_cache(cache_class, cache_size);
+    replay_res_t res = {0};
+
+    uint32_t frame;
+    for(frame = 0; frame < TRACE_FRAME_CNT; frame++) {
+        next_frame();
+        frame_cb(cache, frame, &res);
+    }
+
+    lv_cache_stats_t stats;
+    lv_cache_get_stats(cache, &stats);
+    res.hit_cnt = stats.hit_cnt;
+    res.miss_cnt = stats.miss_cnt;
+
+    lv_cache_destroy(cache, NULL);
+    return res;
+}
+
+static void print_replay_res(const char * name, const replay_res_t * res)
+{
+    TEST_PRINTF("%s: %" LV_PRIu32 " hits, %" LV_PRIu32 " misses, %" LV_PRIu32 " KiB decoded",
+                name, res->hit_cnt, res->miss_cnt, res->decoded_size / 1024);
+}
+
+void setUp(void)
+{
+    /* Function run before every test */
+    MEM_SIZE = lv_test_get_free_mem();
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+    TEST_ASSERT_MEM_LEAK_LESS_THAN(MEM_SIZE, 32);
+}
+
+void test_cache_clock_stats(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 2);
+
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+    TEST_ASSERT_FALSE(cache_access(cache, 2, 1));
+    TEST_ASSERT_TRUE(cache_access(cache, 1, 1));
+    TEST_ASSERT_FALSE(cache_access(cache, 3, 1));
+
+    lv_cache_stats_t stats;
+    lv_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hit_cnt);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.miss_cnt);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.evict_cnt);
+    TEST_ASSERT_EQUAL(2, lv_cache_get_size(cache, NULL));
+
+    lv_cache_reset_stats(cache);
+    lv_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.hit_cnt + stats.miss_cnt + stats.evict_cnt);
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_contains_is_not_an_access(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 4);
+
+    cache_access(cache, 1, 1);
+    lv_cache_reset_stats(cache);
+
+    /*Checking 1 in later frames doesn't count and doesn't promote it*/
+    test_data search_key = { .key = 1 };
+    skip_correlated_frames();
+    TEST_ASSERT_TRUE(lv_cache_contains(cache, &search_key, NULL));
+    search_key.key = 2;
+    TEST_ASSERT_FALSE(lv_cache_contains(cache, &search_key, NULL));
+
+    lv_cache_stats_t stats;
+    lv_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.hit_cnt + stats.miss_cnt);
+
+    int32_t i;
+    for(i = 100; i < 104; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_evicts_probation_first(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 4);
+
+    /*1 and 2 are used again in a later frame so they are protected*/
+    cache_access(cache, 1, 1);
+    cache_access(cache, 2, 1);
+    skip_correlated_frames();
+    cache_access(cache, 1, 1);
+    cache_access(cache, 2, 1);
+
+    /*A scan of entries used only once evicts only the scanned entries*/
+    int32_t i;
+    for(i = 100; i < 120; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_TRUE(cache_access(cache, 1, 1));
+    TEST_ASSERT_TRUE(cache_access(cache, 2, 1));
+    TEST_ASSERT_EQUAL(4, lv_cache_get_size(cache, NULL));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_same_frame_is_not_reuse(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 4);
+
+    /*1 and 2 are looked up several times while a frame is drawn, they stay in probation*/
+    cache_access(cache, 1, 1);
+    cache_access(cache, 2, 1);
+    cache_access(cache, 1, 1);
+    cache_access(cache, 2, 1);
+    next_frame();
+
+    int32_t i;
+    for(i = 100; i < 104; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+    TEST_ASSERT_FALSE(cache_access(cache, 2, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_scrolling_by_is_not_reuse(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 4);
+
+    /*1 is drawn in 3 frames in a row like an icon scrolling by, 2 in every frame like a dock icon*/
+    int32_t frame;
+    for(frame = 0; frame < 8; frame++) {
+        if(frame < 3) cache_access(cache, 1, 1);
+        cache_access(cache, 2, 1);
+        next_frame();
+    }
+
+    int32_t i;
+    for(i = 100; i < 104; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+    TEST_ASSERT_TRUE(cache_access(cache, 2, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_without_tick_cb_promotes_on_any_hit(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 4);
+    lv_cache_clock_rb_set_tick_cb(cache, NULL, 0);
+
+    /*Without a clock the hits can't be told apart, e.g. a cache used outside the display refresh*/
+    cache_access(cache, 1, 1);
+    cache_access(cache, 1, 1);
+
+    int32_t i;
+    for(i = 100; i < 120; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_TRUE(cache_access(cache, 1, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_promotes_after_the_correlated_ticks(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 4);
+
+    /*1 is drawn again 2 frames after it was cached, a gap doesn't matter, only the ticks since adding it*/
+    cache_access(cache, 1, 1);
+    next_frame();
+    next_frame();
+    cache_access(cache, 1, 1);
+    /*2 is drawn in every frame, the first hit more than 4 frames after it was cached promotes it*/
+    int32_t frame;
+    for(frame = 0; frame <= CORRELATED_FRAME_CNT + 1; frame++) {
+        cache_access(cache, 2, 1);
+        next_frame();
+    }
+
+    int32_t i;
+    for(i = 100; i < 120; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+    TEST_ASSERT_TRUE(cache_access(cache, 2, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_lru_is_flushed_by_scan(void)
+{
+    /*The same trace with LRU for reference*/
+    lv_cache_t * cache = create_cache(&lv_cache_class_lru_rb_count, 4);
+
+    cache_access(cache, 1, 1);
+    cache_access(cache, 2, 1);
+    cache_access(cache, 1, 1);
+    cache_access(cache, 2, 1);
+
+    int32_t i;
+    for(i = 100; i < 120; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+    TEST_ASSERT_FALSE(cache_access(cache, 2, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_protected_size_is_limited(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_size, 100);
+
+    /*Promote more than 80% of the cache*/
+    int32_t i;
+    for(i = 0; i < 5; i++) {
+        cache_access(cache, i, 20);
+        skip_correlated_frames();
+        cache_access(cache, i, 20);
+    }
+
+    /*There is still room for a new entry: something was demoted and can be evicted*/
+    TEST_ASSERT_FALSE(cache_access(cache, 10, 20));
+    TEST_ASSERT_TRUE(cache_access(cache, 10, 20));
+    TEST_ASSERT_EQUAL(100, lv_cache_get_size(cache, NULL));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_acquired_entry_is_not_evicted(void)
+{
+    lv_cache_t * cache = create_cache(&lv_cache_class_clock_rb_count, 2);
+
+    test_data search_key = { .slot.size = 1, .key = 1 };
+    lv_cache_entry_t * entry = lv_cache_add(cache, &search_key, NULL);
+    test_data * data = lv_cache_entry_get_data(entry);
+    data->data = lv_malloc(8);
+
+    /*Keep entry 1 acquired while others come and go*/
+    int32_t i;
+    for(i = 2; i < 10; i++) {
+        cache_access(cache, i, 1);
+    }
+
+    TEST_ASSERT_NOT_NULL(lv_cache_acquire(cache, &search_key, NULL));
+    lv_cache_release(cache, entry, NULL);
+    lv_cache_release(cache, entry, NULL);
+
+    lv_cache_drop(cache, &search_key, NULL);
+    TEST_ASSERT_FALSE(cache_access(cache, 1, 1));
+
+    lv_cache_destroy(cache, NULL);
+}
+
+void test_cache_clock_replay_fling(void)
+{
+    /*Room for the home screen, the icons visible while flinging and a few more icons*/
+    uint32_t cache_size = TRACE_HOT_CNT * TRACE_HOT_SIZE + (TRACE_HOME_CNT + TRACE_FLING_VISIBLE + 4) * TRACE_ICON_SIZE;
+    replay_res_t lru = replay(&lv_cache_class_lru_rb_size, trace_fling_frame, cache_size);
+    replay_res_t clock = replay(&lv_cache_class_clock_rb_size, trace_fling_frame, cache_size);
+
+    print_replay_res("fling, LRU", &lru);
+    print_replay_res("fling, CLOCK", &clock);
+
+    TEST_ASSERT_EQUAL_UINT32(lru.hit_cnt + lru.miss_cnt, clock.hit_cnt + clock.miss_cnt);
+
+    /*The drawer's icons must not flush the home screen*/
+    TEST_ASSERT_GREATER_THAN_UINT32(lru.hit_cnt, clock.hit_cnt);
+    TEST_ASSERT_LESS_THAN_UINT32(lru.decoded_size, clock.decoded_size);
+}
+
+void test_cache_clock_replay_scroll(void)
+{
+    /*Room for a frame and a few more icons*/
+    uint32_t cache_size = TRACE_HOT_CNT * TRACE_HOT_SIZE + (TRACE_GRID_VISIBLE + 4) * TRACE_ICON_SIZE;
+    replay_res_t lru = replay(&lv_cache_class_lru_rb_size, trace_scroll_frame, cache_size);
+    replay_res_t clock = replay(&lv_cache_class_clock_rb_size, trace_scroll_frame, cache_size);
+
+    print_replay_res("scroll, LRU", &lru);
+    print_replay_res("scroll, CLOCK", &clock);
+
+    TEST_ASSERT_EQUAL_UINT32(lru.hit_cnt + lru.miss_cnt, clock.hit_cnt + clock.miss_cnt);
+
+    /*Slow scrolling is friendly for LRU too, CLOCK shouldn't be worse*/
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(lru.decoded_size, clock.decoded_size);
+}
+
+#endif
@@ -0,0 +1,131 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+
+#if LV_USE_DRAW_SW && LV_DRAW_SW_COMPLEX && LV_DRAW_SW_SHADOW_CACHE_SIZE && LV_USE_SNAPSHOT
+
+/*Shadow size (`shadow_width + radius`) of all the styles fits into `LV_DRAW_SW_SHADOW_CACHE_SIZE` of the test config*/
+#define STYLE_CNT   4
+
+static const struct {
+    int32_t w;
+    int32_t h;
+    int32_t radius;
+    int32_t width;
+    int32_t spread;
+} styles[STYLE_CNT] = {
+    {60, 40, 2, 6, 0},
+    {40, 20, 0, 6, 2},
+    {80, 50, 4, 4, 1},
+    {8, 8, LV_RADIUS_CIRCLE, 4, 0},
+};
+
+static void create_objs(uint32_t cnt)
+{
+    lv_obj_t * scr = lv_screen_active();
+    lv_obj_set_flex_flow(scr, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_style_pad_all(scr, 20, 0);
+    lv_obj_set_style_pad_gap(scr, 20, 0);
+
+    uint32_t i;
+    for(i = 0; i < cnt; i++) {
+        uint32_t s = i % STYLE_CNT;
+        lv_obj_t * obj = lv_obj_create(scr);
+        lv_obj_remove_style_all(obj);
+        lv_obj_set_size(obj, styles[s].w, styles[s].h);
+        lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, 0);
+        lv_obj_set_style_radius(obj, styles[s].radius, 0);
+        lv_obj_set_style_shadow_width(obj, styles[s].width, 0);
+        lv_obj_set_style_shadow_spread(obj, styles[s].spread, 0);
+        lv_obj_set_style_shadow_offset_y(obj, 2, 0);
+        lv_obj_set_style_shadow_opa(obj, LV_OPA_70, 0);
+    }
+}
+
+static lv_draw_buf_t * render(void)
+{
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(NULL);
+    return lv_snapshot_take(lv_screen_active(), LV_COLOR_FORMAT_XRGB8888);
+}
+
+void setUp(void)
+{
+    lv_draw_sw_shadow_cache_resize(LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE, true);
+    lv_draw_sw_shadow_cache_drop_all();
+    lv_cache_reset_stats(LV_GLOBAL_DEFAULT()->sw_shadow_cache);
+}
+
+void tearDown(void)
+{
+    lv_obj_clean(lv_screen_active());
+    lv_draw_sw_shadow_cache_resize(LV_DRAW_SW_SHADOW_CACHE_MEM_SIZE, true);
+}
+
+void test_shadow_cache_keeps_all_styles(void)
+{
+    create_objs(STYLE_CNT * 3);
+
+    lv_cache_stats_t stats;
+    lv_draw_buf_t * snapshot = render();
+    lv_draw_buf_destroy(snapshot);
+
+    /*Each style is blurred once, then reused for the objects with the same style*/
+    lv_draw_sw_shadow_cache_get_stats(&stats);
+    uint32_t miss_cnt = stats.miss_cnt;
+    TEST_ASSERT_EQUAL_UINT32(STYLE_CNT, miss_cnt);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.hit_cnt);
+
+    /*All the styles are still cached when drawing them again*/
+    snapshot = render();
+    lv_draw_buf_destroy(snapshot);
+
+    lv_draw_sw_shadow_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(miss_cnt, stats.miss_cnt);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.evict_cnt);
+}
+
+void test_shadow_cache_renders_the_same(void)
+{
+    create_objs(STYLE_CNT * 3);
+
+    lv_draw_buf_t * cached = render();
+    lv_draw_buf_t * cached_again = render();
+
+    lv_draw_sw_shadow_cache_resize(0, true);
+    lv_draw_buf_t * uncached = render();
+
+    TEST_ASSERT_NOT_NULL(cached);
+    TEST_ASSERT_NOT_NULL(cached_again);
+    TEST_ASSERT_NOT_NULL(uncached);
+    TEST_ASSERT_EQUAL_UINT32(uncached->data_size, cached->data_size);
+    TEST_ASSERT_EQUAL_MEMORY(uncached->data, cached->data, uncached->data_size);
+    TEST_ASSERT_EQUAL_MEMORY(uncached->data, cached_again->data, uncached->data_size);
+
+    lv_draw_buf_destroy(cached);
+    lv_draw_buf_destroy(cached_again);
+    lv_draw_buf_destroy(uncached);
+}
+
+void test_shadow_cache_evicts_over_budget(void)
+{
+    /*Room only for the largest corner*/
+    lv_draw_sw_shadow_cache_resize(LV_DRAW_SW_SHADOW_CACHE_SIZE * LV_DRAW_SW_SHADOW_CACHE_SIZE, true);
+    create_objs(STYLE_CNT);
+
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(NULL);
+
+    lv_cache_stats_t stats;
+    lv_draw_sw_shadow_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(STYLE_CNT, stats.miss_cnt);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.evict_cnt);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(LV_DRAW_SW_SHADOW_CACHE_SIZE * LV_DRAW_SW_SHADOW_CACHE_SIZE,
+                                     lv_cache_get_size(LV_GLOBAL_DEFAULT()->sw_shadow_cache, NULL));
+}
+
+#endif /*LV_USE_DRAW_SW && LV_DRAW_SW_COMPLEX && LV_DRAW_SW_SHADOW_CACHE_SIZE && LV_USE_SNAPSHOT*/
+
+#endif
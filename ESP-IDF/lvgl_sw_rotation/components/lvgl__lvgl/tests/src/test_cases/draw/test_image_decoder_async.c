@@ -0,0 +1,290 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+#include "lv_test_helpers.h"
+
+#include "unity/unity.h"
+
+#if LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*A decoder which is as slow as decoding a large PNG or JPEG on an MCU*/
+#define DECODE_TIME_MS  50
+#define IMG_SIZE        64
+#define IMG_CNT         12
+
+/*Each test uses new sources to start with an empty cache*/
+#define SRC_SET_CNT     4
+
+static lv_image_decoder_t * slow_decoder;
+static lv_obj_t * imgs[IMG_CNT];
+static lv_image_dsc_t srcs[SRC_SET_CNT][IMG_CNT];
+static uint32_t src_set_cnt;
+
+/*The reference screen, freed in tearDown() also if an assertion fails*/
+static uint8_t * expected;
+
+static bool is_slow_src(const lv_image_decoder_dsc_t * dsc)
+{
+    if(dsc->src_type != LV_IMAGE_SRC_VARIABLE) return false;
+    const lv_image_dsc_t * img_dsc = dsc->src;
+    return img_dsc->header.cf == LV_COLOR_FORMAT_RAW && strncmp((const char *)img_dsc->data, "slow", 4) == 0;
+}
+
+static bool is_cacheable_src(const lv_image_decoder_dsc_t * dsc)
+{
+    /*"slow_nocache" sources behave like decoders which don't use the image cache*/
+    const lv_image_dsc_t * img_dsc = dsc->src;
+    return strcmp((const char *)img_dsc->data, "slow_nocache") != 0;
+}
+
+static lv_result_t slow_info_cb(lv_image_decoder_t * decoder, lv_image_decoder_dsc_t * dsc,
+                                lv_image_header_t * header)
+{
+    LV_UNUSED(decoder);
+    if(!is_slow_src(dsc)) return LV_RESULT_INVALID;
+
+    header->w = IMG_SIZE;
+    header->h = IMG_SIZE;
+    header->cf = LV_COLOR_FORMAT_ARGB8888;
+    header->stride = IMG_SIZE * 4;
+    return LV_RESULT_OK;
+}
+
+static lv_result_t slow_open_cb(lv_image_decoder_t * decoder, lv_image_decoder_dsc_t * dsc)
+{
+    if(!is_slow_src(dsc)) return LV_RESULT_INVALID;
+
+    usleep(DECODE_TIME_MS * 1000);
+
+    lv_draw_buf_t * decoded = lv_draw_buf_create(IMG_SIZE, IMG_SIZE, LV_COLOR_FORMAT_ARGB8888, 0);
+    TEST_ASSERT_NOT_NULL(decoded);
+    lv_draw_buf_clear(decoded, NULL);
+    /*Red left half*/
+    int32_t y;
+    for(y = 0; y < IMG_SIZE; y++) {
+        lv_color32_t * row = lv_draw_buf_goto_xy(decoded, 0, y);
+        int32_t x;
+        for(x = 0; x < IMG_SIZE / 2; x++) {
+            row[x] = lv_color32_make(0xff, 0x00, 0x00, LV_OPA_COVER);
+        }
+    }
+    dsc->decoded = decoded;
+
+    if(!is_cacheable_src(dsc)) return LV_RESULT_OK;
+
+    lv_image_cache_data_t search_key;
+    search_key.src_type = dsc->src_type;
+    search_key.src = dsc->src;
+    search_key.slot.size = decoded->data_size;
+
+    lv_cache_entry_t * entry = lv_image_decoder_add_to_cache(decoder, &search_key, decoded, NULL);
+    TEST_ASSERT_NOT_NULL(entry);
+    dsc->cache_entry = entry;
+
+    return LV_RESULT_OK;
+}
+
+static void slow_close_cb(lv_image_decoder_t * decoder, lv_image_decoder_dsc_t * dsc)
+{
+    LV_UNUSED(decoder);
+    if(!is_cacheable_src(dsc)) lv_draw_buf_destroy((lv_draw_buf_t *)dsc->decoded);
+}
+
+static uint32_t time_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static uint32_t measure_frame(void)
+{
+    uint32_t t = time_ms();
+    lv_test_wait(LV_DEF_REFR_PERIOD);
+    return time_ms() - t;
+}
+
+/*Encoded images in the memory, e.g. PNG files converted to C arrays*/
+static void set_srcs(const char * data)
+{
+    TEST_ASSERT_LESS_THAN_UINT32(SRC_SET_CNT, src_set_cnt);
+    lv_image_dsc_t * set = srcs[src_set_cnt++];
+
+    uint32_t i;
+    for(i = 0; i < IMG_CNT; i++) {
+        lv_memzero(&set[i], sizeof(lv_image_dsc_t));
+        set[i].header.magic = LV_IMAGE_HEADER_MAGIC;
+        set[i].header.cf = LV_COLOR_FORMAT_RAW;
+        set[i].data = (const uint8_t *)data;
+        set[i].data_size = lv_strlen(data) + 1;
+        lv_image_set_src(imgs[i], &set[i]);
+    }
+}
+
+/*Keep rendering while the images are decoded and return the longest frame*/
+static uint32_t stream_images(void)
+{
+    uint32_t frame_max = 0;
+    uint32_t frame_cnt = 0;
+    while(lv_image_decoder_get_async_pending_count() > 0) {
+        usleep(5000);
+        frame_max = LV_MAX(frame_max, measure_frame());
+        frame_cnt++;
+        TEST_ASSERT_LESS_THAN_UINT32(1000, frame_cnt);
+    }
+
+    TEST_PRINTF("%" LV_PRIu32 " frames while decoding, longest: %" LV_PRIu32 " ms", frame_cnt, frame_max);
+    return frame_max;
+}
+
+static void copy_screen(void)
+{
+    lv_draw_buf_t * buf = lv_display_get_buf_active(NULL);
+    expected = lv_malloc(buf->data_size);
+    TEST_ASSERT_NOT_NULL(expected);
+    lv_memcpy(expected, buf->data, buf->data_size);
+}
+
+static void assert_screen_equal(void)
+{
+    lv_draw_buf_t * buf = lv_display_get_buf_active(NULL);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buf->data, buf->data_size);
+}
+
+void setUp(void)
+{
+    src_set_cnt = 0;
+
+    slow_decoder = lv_image_decoder_create();
+    lv_image_decoder_set_info_cb(slow_decoder, slow_info_cb);
+    lv_image_decoder_set_open_cb(slow_decoder, slow_open_cb);
+    lv_image_decoder_set_close_cb(slow_decoder, slow_close_cb);
+
+    lv_obj_t * cont = lv_obj_create(lv_screen_active());
+    lv_obj_set_size(cont, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_flex_flow(cont, LV_FLEX_FLOW_ROW_WRAP);
+
+    uint32_t i;
+    for(i = 0; i < IMG_CNT; i++) {
+        imgs[i] = lv_image_create(cont);
+    }
+}
+
+void tearDown(void)
+{
+    /*The decoder can't be deleted while it's used by the threads*/
+    while(lv_image_decoder_get_async_pending_count() > 0) {
+        usleep(5000);
+        lv_test_wait(LV_DEF_REFR_PERIOD);
+    }
+
+    lv_image_decoder_set_async(false);
+    lv_obj_clean(lv_screen_active());
+    lv_image_cache_drop(NULL);
+    lv_image_header_cache_drop(NULL);
+    lv_image_decoder_delete(slow_decoder);
+
+    lv_free(expected);
+    expected = NULL;
+}
+
+void test_image_decoder_async_frame_time_is_flat(void)
+{
+    /*Reference: decoding while drawing stalls the frame for all the decodes*/
+    set_srcs("slow_sync");
+    uint32_t frame_sync = measure_frame();
+    TEST_PRINTF("decoding while drawing: %" LV_PRIu32 " ms", frame_sync);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(IMG_CNT * DECODE_TIME_MS / LV_DRAW_SW_DRAW_UNIT_CNT, frame_sync);
+    copy_screen();
+
+    /*The same images with other sources: placeholders are drawn until they are decoded*/
+    lv_image_decoder_set_async(true);
+    set_srcs("slow_async");
+    uint32_t frame_first = measure_frame();
+    TEST_ASSERT_GREATER_THAN_UINT32(0, lv_image_decoder_get_async_pending_count());
+
+    /*Compare with the reference instead of a fixed time: a loaded machine slows down both*/
+    uint32_t frame_max = stream_images();
+    TEST_ASSERT_LESS_THAN_UINT32(frame_sync / 2, frame_first);
+    TEST_ASSERT_LESS_THAN_UINT32(frame_sync / 2, frame_max);
+
+    /*All areas were redrawn with the decoded images*/
+    assert_screen_equal();
+
+    /*Now they are cached and drawn normally*/
+    lv_obj_invalidate(lv_screen_active());
+    measure_frame();
+    TEST_ASSERT_EQUAL_UINT32(0, lv_image_decoder_get_async_pending_count());
+    assert_screen_equal();
+}
+
+void test_image_decoder_async_not_cached_image_is_decoded_while_drawing(void)
+{
+    set_srcs("slow_sync");
+    measure_frame();
+    copy_screen();
+
+    lv_image_decoder_set_async(true);
+    set_srcs("slow_nocache");
+    measure_frame();
+
+    /*After trying once in the background these images are decoded while drawing*/
+    stream_images();
+    measure_frame();
+    assert_screen_equal();
+
+    lv_obj_invalidate(lv_screen_active());
+    measure_frame();
+    TEST_ASSERT_EQUAL_UINT32(0, lv_image_decoder_get_async_pending_count());
+    assert_screen_equal();
+}
+
+void test_image_decoder_async_snapshot_waits_for_the_image(void)
+{
+#if LV_USE_SNAPSHOT
+    lv_image_decoder_set_async(true);
+    set_srcs("slow_snapshot");
+
+    /*Snapshots are not refreshed later so they are never drawn with placeholders*/
+    lv_draw_buf_t * snapshot = lv_snapshot_take(imgs[0], LV_COLOR_FORMAT_ARGB8888);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    TEST_ASSERT_EQUAL_UINT32(0, lv_image_decoder_get_async_pending_count());
+
+    /*The left half of the images is red*/
+    const lv_color32_t * px = (const lv_color32_t *)snapshot->data;
+    TEST_ASSERT_EQUAL_UINT8(0xff, px[0].red);
+    TEST_ASSERT_EQUAL_UINT8(LV_OPA_COVER, px[0].alpha);
+
+    lv_draw_buf_destroy(snapshot);
+#endif
+}
+
+#else
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_image_decoder_async_frame_time_is_flat(void)
+{
+}
+
+void test_image_decoder_async_not_cached_image_is_decoded_while_drawing(void)
+{
+}
+
+void test_image_decoder_async_snapshot_waits_for_the_image(void)
+{
+}
+
+#endif /*LV_IMAGE_DECODER_ASYNC_THREAD_CNT > 0*/
+
+#endif
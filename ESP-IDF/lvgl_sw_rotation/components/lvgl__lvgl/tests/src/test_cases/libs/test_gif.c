@@ -0,0 +1,154 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+#include "lv_test_helpers.h"
+
+#include "unity/unity.h"
+
+#if LV_USE_GIF
+
+#include <string.h>
+
+/*60x80, loops forever. Most frames change only a small part of the bulb.*/
+#define GIF_SRC     "A:src/test_assets/test_img_bulb.gif"
+#define GIF_W       60
+#define GIF_H       80
+
+/*More than two loops to play from the frame cache too*/
+#define FRAME_CNT   300
+
+static lv_obj_t * gif;
+
+void setUp(void)
+{
+    gif = lv_gif_create(lv_screen_active());
+    lv_obj_set_pos(gif, 30, 20);
+}
+
+void tearDown(void)
+{
+    lv_obj_clean(lv_screen_active());
+}
+
+/**
+ * Advance the time until the next frame is shown.
+ * @return the number of shown frames
+ */
+static uint32_t wait_next_frame(void)
+{
+    lv_gif_stats_t stats;
+    lv_gif_get_stats(gif, &stats);
+    uint32_t frame_cnt = stats.frame_cnt;
+
+    uint32_t i;
+    for(i = 0; i < 1000 && stats.frame_cnt == frame_cnt; i++) {
+        /*Also waits for the decoding thread*/
+        lv_gif_get_loop_count(gif);
+        lv_test_wait(10);
+        lv_gif_get_stats(gif, &stats);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(frame_cnt + 1, stats.frame_cnt);
+    return stats.frame_cnt;
+}
+
+void test_gif_shows_the_decoded_frames(void)
+{
+    lv_gif_set_src(gif, GIF_SRC);
+    TEST_ASSERT_TRUE(lv_gif_is_loaded(gif));
+
+    /*Decode the same GIF directly as reference*/
+    gd_GIF * ref = gd_open_gif_file(GIF_SRC);
+    TEST_ASSERT_NOT_NULL(ref);
+
+    lv_gif_t * gifobj = (lv_gif_t *)gif;
+    uint32_t i;
+    for(i = 0; i < FRAME_CNT; i++) {
+        if(i > 0) wait_next_frame();
+
+        TEST_ASSERT_EQUAL_INT(1, gd_get_frame(ref));
+        gd_render_frame(ref, ref->canvas);
+        TEST_ASSERT_EQUAL_MEMORY(ref->canvas, gifobj->imgdsc.data, GIF_W * GIF_H * 4);
+    }
+
+    gd_close_gif(ref);
+
+    lv_gif_stats_t stats;
+    lv_gif_get_stats(gif, &stats);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_CNT, stats.frame_cnt);
+#if LV_GIF_FRAME_CACHE_SIZE
+    /*After the first loop the frames are not decoded anymore*/
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.cached_frame_cnt);
+    TEST_ASSERT_LESS_THAN_UINT32(FRAME_CNT / 2, stats.decoded_frame_cnt);
+#else
+    TEST_ASSERT_EQUAL_UINT32(FRAME_CNT, stats.decoded_frame_cnt);
+#endif
+}
+
+void test_gif_redraws_only_the_changed_area(void)
+{
+    lv_gif_set_src(gif, GIF_SRC);
+    lv_refr_now(NULL);
+    lv_gif_reset_stats(gif);
+
+    lv_draw_buf_t * fb = lv_display_get_buf_active(NULL);
+    uint8_t * redrawn = lv_malloc(fb->data_size);
+    TEST_ASSERT_NOT_NULL(redrawn);
+
+    uint32_t i;
+    for(i = 0; i < FRAME_CNT; i++) {
+        /*Only the invalidated area of the frame is redrawn in the frame buffer...*/
+        wait_next_frame();
+        lv_memcpy(redrawn, fb->data, fb->data_size);
+
+        /*...and it has to be the same as redrawing everything*/
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(NULL);
+        TEST_ASSERT_EQUAL_MEMORY(fb->data, redrawn, fb->data_size);
+    }
+
+    lv_free(redrawn);
+
+    lv_gif_stats_t stats;
+    lv_gif_get_stats(gif, &stats);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_CNT, stats.frame_cnt);
+    TEST_ASSERT_LESS_THAN_UINT64((uint64_t)FRAME_CNT * GIF_W * GIF_H / 2, stats.redrawn_px);
+}
+
+void test_gif_redraws_all_if_scaled(void)
+{
+    lv_gif_set_src(gif, GIF_SRC);
+    lv_image_set_scale(gif, 512);
+    lv_refr_now(NULL);
+    lv_gif_reset_stats(gif);
+
+    wait_next_frame();
+
+    lv_gif_stats_t stats;
+    lv_gif_get_stats(gif, &stats);
+    TEST_ASSERT_EQUAL_UINT64(lv_area_get_size(&gif->coords), stats.redrawn_px);
+}
+
+void test_gif_restart(void)
+{
+    lv_gif_set_src(gif, GIF_SRC);
+    lv_gif_t * gifobj = (lv_gif_t *)gif;
+
+    uint8_t * first_frame = lv_malloc(GIF_W * GIF_H * 4);
+    TEST_ASSERT_NOT_NULL(first_frame);
+    lv_memcpy(first_frame, gifobj->imgdsc.data, GIF_W * GIF_H * 4);
+
+    /*Restart while playing from the frame cache*/
+    uint32_t i;
+    for(i = 0; i < FRAME_CNT; i++) wait_next_frame();
+    lv_gif_restart(gif);
+
+    wait_next_frame();
+    TEST_ASSERT_EQUAL_MEMORY(first_frame, gifobj->imgdsc.data, GIF_W * GIF_H * 4);
+
+    lv_free(first_frame);
+}
+
+#endif /*LV_USE_GIF*/
+
+#endif
@@ -0,0 +1,108 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+
+static void inv_area(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    lv_area_t a;
+    lv_area_set(&a, x1, y1, x2, y2);
+    lv_inv_area(NULL, &a);
+}
+
+void setUp(void)
+{
+    /*Render everything that was invalidated before the test*/
+    lv_refr_now(NULL);
+}
+
+void tearDown(void)
+{
+    lv_obj_clean(lv_screen_active());
+}
+
+void test_inv_area_overlap_rendered_once(void)
+{
+    inv_area(0, 0, 99, 99);
+    inv_area(50, 50, 149, 149);
+    lv_refr_now(NULL);
+
+    /*The bounding box would be larger, so the areas are kept but the common part is rendered only once*/
+    TEST_ASSERT_EQUAL_UINT32(100 * 100 * 2 - 50 * 50, lv_display_get_refr_px_count(NULL));
+}
+
+void test_inv_area_close_areas_joined(void)
+{
+    inv_area(0, 0, 9, 9);
+    inv_area(12, 0, 21, 9);
+    lv_refr_now(NULL);
+
+    /*Rendering the gap between them is cheaper than rendering two areas*/
+    TEST_ASSERT_EQUAL_UINT32(22 * 10, lv_display_get_refr_px_count(NULL));
+    TEST_ASSERT_EQUAL_UINT32(0, lv_display_get_default()->inv_p);
+}
+
+void test_inv_area_distant_areas_not_joined(void)
+{
+    inv_area(0, 0, 9, 9);
+    inv_area(700, 400, 709, 409);
+    lv_refr_now(NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(10 * 10 * 2, lv_display_get_refr_px_count(NULL));
+}
+
+void test_inv_area_overflow_does_not_redraw_the_screen(void)
+{
+    uint32_t scr_px = lv_display_get_horizontal_resolution(NULL) * lv_display_get_vertical_resolution(NULL);
+
+    /*Scattered small updates, more than the buffer can hold*/
+    int32_t x;
+    int32_t y;
+    uint32_t cnt = 0;
+    for(y = 0; y < 5; y++) {
+        for(x = 0; x < 8; x++) {
+            inv_area(x * 100, y * 96, x * 100 + 9, y * 96 + 9);
+            cnt++;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(LV_INV_BUF_SIZE, cnt);
+
+    lv_refr_now(NULL);
+
+    uint32_t px_cnt = lv_display_get_refr_px_count(NULL);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(cnt * 10 * 10, px_cnt);
+    TEST_ASSERT_LESS_THAN_UINT32(scr_px / 4, px_cnt);
+}
+
+void test_inv_area_large_areas_redraw_the_screen(void)
+{
+    uint32_t scr_px = lv_display_get_horizontal_resolution(NULL) * lv_display_get_vertical_resolution(NULL);
+
+    inv_area(0, 0, 799, 299);
+    inv_area(0, 200, 799, 479);
+    lv_refr_now(NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(scr_px, lv_display_get_refr_px_count(NULL));
+}
+
+void test_inv_area_rendering_is_unchanged(void)
+{
+    lv_obj_t * obj = lv_obj_create(lv_screen_active());
+    lv_obj_set_size(obj, 200, 100);
+    lv_obj_center(obj);
+    lv_obj_t * label = lv_label_create(obj);
+    lv_label_set_text(label, "Hello");
+    lv_obj_center(label);
+    lv_refr_now(NULL);
+
+    /*Invalidate many overlapping areas and check that the result is the same as a full redraw*/
+    int32_t i;
+    for(i = 0; i < 60; i++) {
+        inv_area(250 + i * 3, 180 + (i % 7) * 11, 330 + i * 3, 230 + (i % 5) * 13);
+    }
+
+    TEST_ASSERT_EQUAL_SCREENSHOT("inv_area_1.png");
+}
+
+#endif
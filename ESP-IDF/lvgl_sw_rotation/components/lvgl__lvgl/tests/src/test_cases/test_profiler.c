@@ -98,4 +98,89 @@ void test_profiler_disable(void)
     TEST_ASSERT_EQUAL_CHAR(output_buf[4][0], '\0');
 }
 
+void test_profiler_ring_mode(void)
+{
+    lv_profiler_builtin_config_t config;
+    lv_profiler_builtin_config_init(&config);
+    config.buf_size = 1024;
+    config.tick_per_sec = 1;
+    config.tick_get_cb = get_tick_cb;
+    config.flush_cb = flush_cb;
+    config.ring_mode = true;
+    lv_profiler_builtin_init(&config);
+
+    /* reset */
+    profiler_tick = 0;
+    output_line = 0;
+    lv_memzero(output_buf, sizeof(output_buf));
+
+    /* overflow the buffer several times, nothing should be flushed */
+    for(int i = 0; i < 1000; i++) {
+        LV_PROFILER_BEGIN_TAG("ring_tag");
+        LV_PROFILER_END_TAG("ring_tag");
+    }
+    TEST_ASSERT_EQUAL_INT(output_line, 0);
+
+    /* re-init with a time window to get only the latest items */
+    config.ring_keep_ms = 3000; /* 3 ticks */
+    lv_profiler_builtin_init(&config);
+    output_line = 0;
+
+    for(int i = 0; i < 1000; i++) {
+        LV_PROFILER_BEGIN_TAG("ring_tag");
+        LV_PROFILER_END_TAG("ring_tag");
+    }
+    uint32_t last_tick = profiler_tick - 1;
+    lv_profiler_builtin_flush();
+
+    /* check output: the items of the last 3 ticks, the oldest first */
+    TEST_ASSERT_EQUAL_INT(output_line, 4);
+    for(int i = 0; i < 4; i++) {
+        char expected[OUTPUT_BUF_MAX];
+        uint32_t tick = last_tick - 3 + i;
+        lv_snprintf(expected, sizeof(expected), "   LVGL-1 [0] %" LV_PRIu32 ".000000: tracing_mark_write: %c|1|ring_tag\n",
+                    tick, i % 2 ? 'E' : 'B');
+        TEST_ASSERT_EQUAL_STRING(expected, output_buf[i]);
+    }
+
+    /* the buffer is empty after flushing */
+    output_line = 0;
+    lv_profiler_builtin_flush();
+    TEST_ASSERT_EQUAL_INT(output_line, 0);
+}
+
+void test_profiler_ring_keep_before_wrap(void)
+{
+    lv_profiler_builtin_config_t config;
+    lv_profiler_builtin_config_init(&config);
+    config.buf_size = 1024;
+    config.tick_per_sec = 1;
+    config.tick_get_cb = get_tick_cb;
+    config.flush_cb = flush_cb;
+    config.ring_mode = true;
+    config.ring_keep_ms = 3000; /* 3 ticks */
+    lv_profiler_builtin_init(&config);
+
+    /* reset */
+    profiler_tick = 0;
+    output_line = 0;
+    lv_memzero(output_buf, sizeof(output_buf));
+
+    /* far less than the buffer holds, it doesn't wrap */
+    for(int i = 0; i < 10; i++) {
+        LV_PROFILER_BEGIN_TAG("ring_tag");
+        LV_PROFILER_END_TAG("ring_tag");
+    }
+    lv_profiler_builtin_flush();
+
+    /* check output: the time window applies as well */
+    TEST_ASSERT_EQUAL_INT(output_line, 4);
+    for(int i = 0; i < 4; i++) {
+        char expected[OUTPUT_BUF_MAX];
+        lv_snprintf(expected, sizeof(expected), "   LVGL-1 [0] %d.000000: tracing_mark_write: %c|1|ring_tag\n",
+                    16 + i, i % 2 ? 'E' : 'B');
+        TEST_ASSERT_EQUAL_STRING(expected, output_buf[i]);
+    }
+}
+
 #endif
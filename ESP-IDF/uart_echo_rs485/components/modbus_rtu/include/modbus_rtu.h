@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Modbus RTU on a serial line: a frame is the address of the slave, the function, the data and the CRC16, and it
+ * ends with a silence of 3.5 characters (T3.5). The port delimits the frames by this silence, with the RX timeout
+ * of the UART on the target, and the master and the slave build and check them in the buffer they were received in.
+ */
+
+#define MODBUS_RTU_OK                   (0)
+#define MODBUS_RTU_ERR_INVALID          (-1)
+#define MODBUS_RTU_ERR_NO_MEM           (-2)
+#define MODBUS_RTU_ERR_PORT             (-3)
+#define MODBUS_RTU_ERR_TIMEOUT          (-4)    /*!< No frame, or no answer of the slave */
+#define MODBUS_RTU_ERR_CRC              (-5)
+#define MODBUS_RTU_ERR_FRAME            (-6)    /*!< Too long, too short, or not the answer to the request */
+#define MODBUS_RTU_ERR_EXCEPTION        (-7)    /*!< The slave answered an exception */
+
+#define MODBUS_RTU_FRAME_MAX            (256)
+#define MODBUS_RTU_ADDRESS_BROADCAST    (0)
+#define MODBUS_RTU_ADDRESS_MAX          (247)
+
+#define MODBUS_RTU_READ_COILS                   (0x01)
+#define MODBUS_RTU_READ_DISCRETE_INPUTS         (0x02)
+#define MODBUS_RTU_READ_HOLDING_REGISTERS       (0x03)
+#define MODBUS_RTU_READ_INPUT_REGISTERS         (0x04)
+#define MODBUS_RTU_WRITE_SINGLE_COIL            (0x05)
+#define MODBUS_RTU_WRITE_SINGLE_REGISTER        (0x06)
+#define MODBUS_RTU_WRITE_MULTIPLE_COILS         (0x0f)
+#define MODBUS_RTU_WRITE_MULTIPLE_REGISTERS     (0x10)
+
+#define MODBUS_RTU_READ_BIT_MAX         (2000)
+#define MODBUS_RTU_READ_REGISTER_MAX    (125)
+#define MODBUS_RTU_WRITE_BIT_MAX        (1968)
+#define MODBUS_RTU_WRITE_REGISTER_MAX   (123)
+
+#define MODBUS_RTU_EX_ILLEGAL_FUNCTION          (0x01)
+#define MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS      (0x02)
+#define MODBUS_RTU_EX_ILLEGAL_DATA_VALUE        (0x03)
+#define MODBUS_RTU_EX_SLAVE_DEVICE_FAILURE      (0x04)
+
+/**
+ * @brief The serial line of a master or a slave. The functions are called by one task at a time.
+ */
+typedef struct {
+    /**
+     * @brief Send a frame, and return when it's sent, so the line can be read.
+     *
+     * @return MODBUS_RTU_OK or MODBUS_RTU_ERR_PORT
+     */
+    int (*send)(void *ctx, const uint8_t *frame, size_t len);
+    /**
+     * @brief Receive a frame: wait up to `timeout_ms` for its first byte, then read it until a silence of T3.5.
+     *
+     * @return MODBUS_RTU_OK, MODBUS_RTU_ERR_TIMEOUT without a byte, MODBUS_RTU_ERR_FRAME if the frame was longer
+     *         than `size` (the rest of it is dropped) or garbled on the line, or MODBUS_RTU_ERR_PORT
+     */
+    int (*recv)(void *ctx, uint8_t *frame, size_t size, uint32_t timeout_ms, size_t *len);
+    void *ctx;
+} modbus_rtu_port_t;
+
+/**
+ * @brief Compute the CRC16 of Modbus, by a table.
+ *
+ * @param data The bytes
+ * @param len The length of the bytes
+ *
+ * @return The CRC, its low byte is sent first
+ */
+uint16_t modbus_rtu_crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief Check the CRC at the end of a frame.
+ *
+ * @param frame The frame, with its CRC
+ * @param len The length of the frame
+ *
+ * @return true if the frame has at least an address, a function and a CRC, and the CRC is right
+ */
+bool modbus_rtu_check_crc(const uint8_t *frame, size_t len);
+
+/**
+ * @brief Append the CRC to a frame.
+ *
+ * @param frame The frame, with 2 bytes free at the end
+ * @param len The length of the frame without the CRC
+ *
+ * @return The length with the CRC
+ */
+size_t modbus_rtu_append_crc(uint8_t *frame, size_t len);
+
+/**
+ * @brief Get the silence of 3.5 characters which ends a frame: 11 bits a character, and 1750 us above 19200 baud
+ *        as the specification fixes it.
+ *
+ * @param baud_rate The baud rate
+ *
+ * @return The silence, us
+ */
+uint32_t modbus_rtu_t35_us(uint32_t baud_rate);
+
+/**
+ * @brief Get the most time between two reads of a frame, when the port is woken up every `char_num` characters
+ *        received (e.g. by the RX FIFO threshold of a UART): the characters of 11 bits, then T3.5 which ends the frame.
+ *
+ * @param baud_rate The baud rate
+ * @param char_num The characters between two reads
+ *
+ * @return The time, us
+ */
+uint32_t modbus_rtu_read_wait_us(uint32_t baud_rate, uint32_t char_num);
+
+/**
+ * @brief Get a register of the data of a frame, registers are big endian.
+ */
+static inline uint16_t modbus_rtu_get_register(const uint8_t *data, size_t index)
+{
+    return (uint16_t)((data[index * 2] << 8) | data[index * 2 + 1]);
+}
+
+/**
+ * @brief Get a bit of the data of a frame, bits are packed from the low bit of the first byte.
+ */
+static inline bool modbus_rtu_get_bit(const uint8_t *data, size_t index)
+{
+    return (data[index / 8] >> (index % 8)) & 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
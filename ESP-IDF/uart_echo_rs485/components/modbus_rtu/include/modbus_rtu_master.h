@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A master polls the slaves of a line from its own task. The requests are added once, with a period, and their
+ * frames are built then: the task sends the most overdue one, receives the answer in a free result of a ring, and
+ * queues it for the application, which reads it in place while the next request is on the line.
+ *
+ * A slave which doesn't answer is tried again `retry_max` times. After that it's offline: its requests are sent
+ * once, every `offline_period_ms` at most, so it doesn't hold the line until it answers again.
+ */
+
+typedef struct {
+    uint8_t slave;                  /*!< 1 to 247, or MODBUS_RTU_ADDRESS_BROADCAST for a write to all the slaves */
+    uint8_t function;               /*!< MODBUS_RTU_READ_COILS to MODBUS_RTU_WRITE_MULTIPLE_REGISTERS */
+    uint16_t address;               /*!< The first coil or register */
+    uint16_t count;                 /*!< The coils or registers, 1 for a single write */
+    const uint16_t *values;         /*!< The values of a write, a coil is on if its value isn't 0. Copied */
+    uint32_t period_ms;             /*!< 0 to send the request once, else its period, at a fixed rate */
+    uint32_t timeout_ms;            /*!< The time the slave has to answer, 0 for the default of the master */
+    uint8_t retry_max;              /*!< The tries after the first one, when the slave doesn't answer right */
+} modbus_rtu_request_t;
+
+typedef struct {
+    int id;                         /*!< The request, see `modbus_rtu_master_add()` */
+    uint8_t slave;
+    uint8_t function;
+    uint16_t address;
+    uint16_t count;
+    int status;                     /*!< MODBUS_RTU_OK, or the error of the last try */
+    uint8_t exception;              /*!< The exception code, with MODBUS_RTU_ERR_EXCEPTION */
+    uint8_t retry_num;              /*!< The tries after the first one */
+    const uint8_t *data;            /*!< The values of a read, in the frame of the answer: see
+                                         `modbus_rtu_get_register()` and `modbus_rtu_get_bit()` */
+    size_t data_len;
+    uint32_t latency_us;            /*!< From the request sent to the answer received, on the last try */
+} modbus_rtu_result_t;
+
+typedef struct {
+    modbus_rtu_port_t port;
+    uint8_t request_max;            /*!< The requests added at a time */
+    uint8_t result_num;             /*!< The results of the ring. The line waits for a free one */
+    uint32_t timeout_ms;            /*!< The default time a slave has to answer */
+    uint32_t turnaround_ms;         /*!< The time after a broadcast, for the slaves to handle it */
+    uint32_t offline_period_ms;     /*!< The least period of the requests to an offline slave */
+    uint32_t stack_size;            /*!< Stack of the task, bytes. Only used on the target */
+    uint8_t priority;               /*!< Priority of the task. Only used on the target */
+} modbus_rtu_master_config_t;
+
+#define MODBUS_RTU_MASTER_DEFAULT_CONFIG()  \
+    {                                       \
+        .request_max = 16,                  \
+        .result_num = 8,                    \
+        .timeout_ms = 100,                  \
+        .turnaround_ms = 100,               \
+        .offline_period_ms = 1000,          \
+        .stack_size = 4 * 1024,             \
+        .priority = 10,                     \
+    }
+
+typedef struct {
+    uint32_t request_num;           /*!< The frames sent, with the retries */
+    uint32_t response_num;          /*!< The right answers, with the exceptions */
+    uint32_t exception_num;
+    uint32_t timeout_num;
+    uint32_t crc_error_num;
+    uint32_t frame_error_num;       /*!< The answers of the wrong length or function, too long, or of another slave */
+    uint32_t retry_num;
+    uint32_t stall_num;             /*!< The times the line waited for a free result */
+} modbus_rtu_master_stats_t;
+
+typedef struct modbus_rtu_master_t modbus_rtu_master_t;
+
+/**
+ * @brief Create a master and start its task.
+ *
+ * @param config The configuration
+ * @param ret_master The master
+ *
+ * @return MODBUS_RTU_OK, MODBUS_RTU_ERR_INVALID or MODBUS_RTU_ERR_NO_MEM
+ */
+int modbus_rtu_master_new(const modbus_rtu_master_config_t *config, modbus_rtu_master_t **ret_master);
+
+/**
+ * @brief Stop the task and delete a master. The results taken must not be used after it.
+ *
+ * @param master The master, can be NULL
+ */
+void modbus_rtu_master_del(modbus_rtu_master_t *master);
+
+/**
+ * @brief Add a request. Its first try is due at once.
+ *
+ * @param master The master
+ * @param request The request
+ * @param ret_id The id of the request in its results, can be NULL
+ *
+ * @return MODBUS_RTU_OK, MODBUS_RTU_ERR_INVALID if the request can't be framed, or MODBUS_RTU_ERR_NO_MEM if
+ *         `request_max` requests are added
+ */
+int modbus_rtu_master_add(modbus_rtu_master_t *master, const modbus_rtu_request_t *request, int *ret_id);
+
+/**
+ * @brief Remove a request. A request on the line is removed after it, its result is still queued.
+ *
+ * @param master The master
+ * @param id The request
+ *
+ * @return MODBUS_RTU_OK, or MODBUS_RTU_ERR_INVALID if it isn't added, or was sent once
+ */
+int modbus_rtu_master_remove(modbus_rtu_master_t *master, int id);
+
+/**
+ * @brief Take the oldest result of the ring. It stays in the ring until it's released.
+ *
+ * @param master The master
+ * @param timeout_ms The time to wait for a result
+ * @param ret_result The result
+ *
+ * @return MODBUS_RTU_OK, or MODBUS_RTU_ERR_TIMEOUT
+ */
+int modbus_rtu_master_take(modbus_rtu_master_t *master, uint32_t timeout_ms, const modbus_rtu_result_t **ret_result);
+
+/**
+ * @brief Give a result back to the ring.
+ *
+ * @param master The master
+ * @param result The result of `modbus_rtu_master_take()`
+ */
+void modbus_rtu_master_release(modbus_rtu_master_t *master, const modbus_rtu_result_t *result);
+
+/**
+ * @brief Get the counters of a master.
+ *
+ * @param master The master
+ * @param stats The counters
+ */
+void modbus_rtu_master_get_stats(modbus_rtu_master_t *master, modbus_rtu_master_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
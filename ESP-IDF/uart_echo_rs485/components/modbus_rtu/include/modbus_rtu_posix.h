@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The line of a host, on a file descriptor: a serial port, or a pty to test the master and the slave against each
+ * other. The silence which ends a frame is timed by `select()`.
+ */
+
+typedef struct {
+    int fd;                     /*!< Opened and set raw by the application, it's not closed */
+    uint32_t baud_rate;         /*!< The baud rate of T3.5 */
+    uint32_t t35_us;            /*!< The silence which ends a frame, 0 for T3.5 of the baud rate */
+} modbus_rtu_posix_config_t;
+
+/**
+ * @brief Create the port of a file descriptor.
+ *
+ * @param config The configuration
+ * @param ret_port The port
+ *
+ * @return MODBUS_RTU_OK, MODBUS_RTU_ERR_INVALID or MODBUS_RTU_ERR_NO_MEM
+ */
+int modbus_rtu_posix_new(const modbus_rtu_posix_config_t *config, modbus_rtu_port_t *ret_port);
+
+/**
+ * @brief Delete the port of a file descriptor.
+ *
+ * @param port The port
+ */
+void modbus_rtu_posix_del(modbus_rtu_port_t *port);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A slave serves the tables of the application: the coils and the discrete inputs (bits packed from the low bit of
+ * the first byte), the holding and the input registers. A request is answered in the buffer it was received in, and
+ * the tables are read and written under the lock of the slave, see `modbus_rtu_slave_lock()`.
+ */
+
+/**
+ * @brief Called after a write of the master, in the lock of the slave.
+ *
+ * @param function MODBUS_RTU_WRITE_SINGLE_COIL to MODBUS_RTU_WRITE_MULTIPLE_REGISTERS
+ * @param address The first coil or register written
+ * @param count The coils or registers written
+ * @param user_data The user data of the configuration
+ */
+typedef void (*modbus_rtu_slave_write_cb_t)(uint8_t function, uint16_t address, uint16_t count, void *user_data);
+
+typedef struct {
+    uint8_t address;                /*!< 1 to 247 */
+    modbus_rtu_port_t port;         /*!< The line of `modbus_rtu_slave_poll()` */
+    uint8_t *coils;                 /*!< Can be NULL, read and written */
+    uint16_t coil_num;
+    const uint8_t *discrete_inputs; /*!< Can be NULL, read only */
+    uint16_t discrete_input_num;
+    uint16_t *holding_registers;    /*!< Can be NULL, read and written */
+    uint16_t holding_register_num;
+    const uint16_t *input_registers;    /*!< Can be NULL, read only */
+    uint16_t input_register_num;
+    modbus_rtu_slave_write_cb_t on_write;   /*!< Can be NULL */
+    void *user_data;
+} modbus_rtu_slave_config_t;
+
+typedef struct {
+    uint32_t frame_num;             /*!< The frames received with a right CRC */
+    uint32_t response_num;          /*!< The answers, with the exceptions */
+    uint32_t exception_num;
+    uint32_t broadcast_num;         /*!< The writes to all the slaves, not answered */
+    uint32_t ignored_num;           /*!< The frames to other slaves */
+    uint32_t crc_error_num;         /*!< The frames with a wrong CRC, or too short */
+    uint32_t overrun_num;           /*!< The frames longer than MODBUS_RTU_FRAME_MAX */
+} modbus_rtu_slave_stats_t;
+
+typedef struct modbus_rtu_slave_t modbus_rtu_slave_t;
+
+/**
+ * @brief Create a slave. The tables are kept, not copied.
+ *
+ * @param config The configuration
+ * @param ret_slave The slave
+ *
+ * @return MODBUS_RTU_OK, MODBUS_RTU_ERR_INVALID or MODBUS_RTU_ERR_NO_MEM
+ */
+int modbus_rtu_slave_new(const modbus_rtu_slave_config_t *config, modbus_rtu_slave_t **ret_slave);
+
+/**
+ * @brief Delete a slave.
+ *
+ * @param slave The slave, can be NULL
+ */
+void modbus_rtu_slave_del(modbus_rtu_slave_t *slave);
+
+/**
+ * @brief Receive a frame on the line of the slave, and answer it.
+ *
+ * @param slave The slave
+ * @param timeout_ms The time to wait for a frame
+ *
+ * @return MODBUS_RTU_OK after a frame, even if it wasn't answered, MODBUS_RTU_ERR_TIMEOUT without a frame, or
+ *         MODBUS_RTU_ERR_PORT
+ */
+int modbus_rtu_slave_poll(modbus_rtu_slave_t *slave, uint32_t timeout_ms);
+
+/**
+ * @brief Handle a frame received by the application, e.g. on a line shared by several slaves, and build the answer
+ *        in its place.
+ *
+ * @param slave The slave
+ * @param frame The frame, its buffer gets the answer
+ * @param len The length of the frame
+ * @param size The size of the buffer, at least MODBUS_RTU_FRAME_MAX for an answer to any request
+ * @param resp_len The length of the answer, 0 for no answer: a frame to another slave, a broadcast or an error
+ *
+ * @return MODBUS_RTU_OK, or MODBUS_RTU_ERR_CRC
+ */
+int modbus_rtu_slave_handle(modbus_rtu_slave_t *slave, uint8_t *frame, size_t len, size_t size, size_t *resp_len);
+
+/**
+ * @brief Lock the tables of a slave, to update them in the application.
+ */
+void modbus_rtu_slave_lock(modbus_rtu_slave_t *slave);
+
+/**
+ * @brief Unlock the tables of a slave.
+ */
+void modbus_rtu_slave_unlock(modbus_rtu_slave_t *slave);
+
+/**
+ * @brief Get the counters of a slave.
+ *
+ * @param slave The slave
+ * @param stats The counters
+ */
+void modbus_rtu_slave_get_stats(modbus_rtu_slave_t *slave, modbus_rtu_slave_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
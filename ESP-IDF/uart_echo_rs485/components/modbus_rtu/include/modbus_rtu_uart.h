@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "driver/uart.h"
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The line of the target, on a UART in the RS485 half duplex mode. The RX timeout of the UART is set to T3.5, so
+ * the driver posts the end of a frame with its last bytes, and the frame is read from the ring buffer of the driver
+ * into the buffer of the master or the slave.
+ */
+
+typedef struct {
+    uart_port_t uart_num;
+    uint32_t baud_rate;
+    uart_parity_t parity;
+    int tx_pin;
+    int rx_pin;
+    int rts_pin;                /*!< Drives DE/~RE of the transceiver, UART_PIN_NO_CHANGE if it switches alone */
+    int rx_buf_size;            /*!< The ring buffer of the driver */
+} modbus_rtu_uart_config_t;
+
+#define MODBUS_RTU_UART_DEFAULT_CONFIG()    \
+    {                                       \
+        .uart_num = UART_NUM_1,             \
+        .baud_rate = 115200,                \
+        .parity = UART_PARITY_DISABLE,      \
+        .tx_pin = UART_PIN_NO_CHANGE,       \
+        .rx_pin = UART_PIN_NO_CHANGE,       \
+        .rts_pin = UART_PIN_NO_CHANGE,      \
+        .rx_buf_size = 1024,                \
+    }
+
+/**
+ * @brief Install the driver of a UART and create its port.
+ *
+ * @param config The configuration
+ * @param ret_port The port
+ *
+ * @return MODBUS_RTU_OK, MODBUS_RTU_ERR_INVALID, MODBUS_RTU_ERR_NO_MEM, or MODBUS_RTU_ERR_PORT if the driver fails
+ */
+int modbus_rtu_uart_new(const modbus_rtu_uart_config_t *config, modbus_rtu_port_t *ret_port);
+
+/**
+ * @brief Delete the port of a UART, and its driver.
+ *
+ * @param port The port
+ */
+void modbus_rtu_uart_del(modbus_rtu_port_t *port);
+
+#ifdef __cplusplus
+}
+#endif
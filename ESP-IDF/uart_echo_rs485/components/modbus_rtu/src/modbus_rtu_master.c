@@ -0,0 +1,585 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "modbus_rtu_master.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#define MODBUS_RTU_LOGE(format, ...)        ESP_LOGE(TAG, format, ##__VA_ARGS__)
+/* The timed waits of the pthread condition variables use the wall clock */
+#define MODBUS_RTU_COND_CLOCK               CLOCK_REALTIME
+#else
+#define MODBUS_RTU_LOGE(format, ...)        fprintf(stderr, "[%s] " format "\n", TAG, ##__VA_ARGS__)
+#define MODBUS_RTU_COND_CLOCK               CLOCK_MONOTONIC
+#endif
+
+/* The time the task waits without a request due, to check it's stopped */
+#define IDLE_WAIT_US                        (1000 * 1000)
+
+typedef struct {
+    int id;                 /* 0 for a free request */
+    modbus_rtu_request_t request;
+    /* Built when it's added, sent as is on each try */
+    uint8_t frame[MODBUS_RTU_FRAME_MAX];
+    size_t frame_len;
+    size_t resp_len;        /* The length of a right answer */
+    int64_t due_us;
+    bool is_busy;           /* On the line, only the task changes it */
+    bool is_removed;        /* Removed while on the line */
+} request_t;
+
+typedef struct {
+    modbus_rtu_result_t result;
+    /* The answer is received here, the result points into it */
+    uint8_t frame[MODBUS_RTU_FRAME_MAX];
+} result_slot_t;
+
+struct modbus_rtu_master_t {
+    modbus_rtu_master_config_t config;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;            /* For the task: a request added, a result released, or stopped */
+    pthread_cond_t result_cond;     /* For the application: a result queued */
+    pthread_t task;
+    bool has_task;
+    bool exit;
+    request_t *requests;
+    int next_id;
+    /* The ring of results: free ones on a stack, queued ones in order */
+    result_slot_t *slots;
+    uint8_t *free_slots;
+    uint8_t free_num;
+    uint8_t *queued_slots;
+    uint8_t queued_head;
+    uint8_t queued_num;
+    /* The failed requests of each slave in a row, it's offline when it isn't 0 */
+    uint8_t fail_num[MODBUS_RTU_ADDRESS_MAX + 1];
+    modbus_rtu_master_stats_t stats;
+};
+
+static const char *TAG = "modbus_rtu_master";
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int cond_wait_us(pthread_cond_t *cond, pthread_mutex_t *lock, int64_t wait_us)
+{
+    struct timespec ts;
+    clock_gettime(MODBUS_RTU_COND_CLOCK, &ts);
+    ts.tv_sec += wait_us / 1000000;
+    ts.tv_nsec += (long)(wait_us % 1000000) * 1000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return pthread_cond_timedwait(cond, lock, &ts);
+}
+
+static void sleep_us(int64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = us / 1000000,
+        .tv_nsec = (long)(us % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static inline void put_u16(uint8_t *data, uint16_t value)
+{
+    data[0] = value >> 8;
+    data[1] = value & 0xff;
+}
+
+/* Build the frame of a request, and the length of its answer */
+static bool build_request(request_t *req, const modbus_rtu_request_t *request)
+{
+    uint8_t function = request->function;
+    uint16_t count = request->count;
+    bool is_read = (function >= MODBUS_RTU_READ_COILS) && (function <= MODBUS_RTU_READ_INPUT_REGISTERS);
+    bool is_bits = (function == MODBUS_RTU_READ_COILS) || (function == MODBUS_RTU_READ_DISCRETE_INPUTS);
+    uint8_t *frame = req->frame;
+
+    if ((request->slave > MODBUS_RTU_ADDRESS_MAX) ||
+            ((request->slave == MODBUS_RTU_ADDRESS_BROADCAST) && is_read) ||
+            ((uint32_t)request->address + count > 0x10000)) {
+        return false;
+    }
+
+    frame[0] = request->slave;
+    frame[1] = function;
+    put_u16(&frame[2], request->address);
+    size_t len = 6;
+    switch (function) {
+    case MODBUS_RTU_READ_COILS:
+    case MODBUS_RTU_READ_DISCRETE_INPUTS:
+    case MODBUS_RTU_READ_HOLDING_REGISTERS:
+    case MODBUS_RTU_READ_INPUT_REGISTERS:
+        if ((count == 0) || (count > (is_bits ? MODBUS_RTU_READ_BIT_MAX : MODBUS_RTU_READ_REGISTER_MAX))) {
+            return false;
+        }
+        put_u16(&frame[4], count);
+        req->resp_len = 3 + (is_bits ? (count + 7) / 8 : count * 2) + 2;
+        break;
+    case MODBUS_RTU_WRITE_SINGLE_COIL:
+    case MODBUS_RTU_WRITE_SINGLE_REGISTER:
+        if ((count != 1) || (request->values == NULL)) {
+            return false;
+        }
+        if (function == MODBUS_RTU_WRITE_SINGLE_COIL) {
+            put_u16(&frame[4], (request->values[0] != 0) ? 0xff00 : 0x0000);
+        } else {
+            put_u16(&frame[4], request->values[0]);
+        }
+        req->resp_len = 8;
+        break;
+    case MODBUS_RTU_WRITE_MULTIPLE_COILS:
+        if ((count == 0) || (count > MODBUS_RTU_WRITE_BIT_MAX) || (request->values == NULL)) {
+            return false;
+        }
+        put_u16(&frame[4], count);
+        frame[6] = (count + 7) / 8;
+        memset(&frame[7], 0, frame[6]);
+        for (uint16_t i = 0; i < count; i++) {
+            if (request->values[i] != 0) {
+                frame[7 + i / 8] |= 1 << (i % 8);
+            }
+        }
+        len = 7 + frame[6];
+        req->resp_len = 8;
+        break;
+    case MODBUS_RTU_WRITE_MULTIPLE_REGISTERS:
+        if ((count == 0) || (count > MODBUS_RTU_WRITE_REGISTER_MAX) || (request->values == NULL)) {
+            return false;
+        }
+        put_u16(&frame[4], count);
+        frame[6] = count * 2;
+        for (uint16_t i = 0; i < count; i++) {
+            put_u16(&frame[7 + i * 2], request->values[i]);
+        }
+        len = 7 + frame[6];
+        req->resp_len = 8;
+        break;
+    default:
+        return false;
+    }
+    req->frame_len = modbus_rtu_append_crc(frame, len);
+
+    return true;
+}
+
+static int check_answer(const request_t *req, const uint8_t *frame, size_t len, uint8_t *exception)
+{
+    uint8_t function = req->frame[1];
+
+    if (!modbus_rtu_check_crc(frame, len)) {
+        return MODBUS_RTU_ERR_CRC;
+    }
+    if (frame[1] == (function | 0x80)) {
+        if (len != 5) {
+            return MODBUS_RTU_ERR_FRAME;
+        }
+        *exception = frame[2];
+        return MODBUS_RTU_ERR_EXCEPTION;
+    }
+    if ((frame[1] != function) || (len != req->resp_len)) {
+        return MODBUS_RTU_ERR_FRAME;
+    }
+    /* A read answers the byte count, a write echoes its address and value or count */
+    if ((function <= MODBUS_RTU_READ_INPUT_REGISTERS) ? (frame[2] != len - 5) : (memcmp(frame, req->frame, 6) != 0)) {
+        return MODBUS_RTU_ERR_FRAME;
+    }
+
+    return MODBUS_RTU_OK;
+}
+
+static void count_error(modbus_rtu_master_t *master, int status)
+{
+    pthread_mutex_lock(&master->lock);
+    switch (status) {
+    case MODBUS_RTU_ERR_TIMEOUT:
+        master->stats.timeout_num++;
+        break;
+    case MODBUS_RTU_ERR_CRC:
+        master->stats.crc_error_num++;
+        break;
+    case MODBUS_RTU_ERR_FRAME:
+        master->stats.frame_error_num++;
+        break;
+    default:
+        break;
+    }
+    pthread_mutex_unlock(&master->lock);
+}
+
+/* Send a request and receive its answer in the slot, with the retries. Called without the lock: the request is busy,
+ * and the slot is only the task's */
+static void run_request(modbus_rtu_master_t *master, const request_t *req, uint8_t retry_max, result_slot_t *slot)
+{
+    const modbus_rtu_port_t *port = &master->config.port;
+    modbus_rtu_result_t *result = &slot->result;
+    uint32_t timeout_ms = (req->request.timeout_ms > 0) ? req->request.timeout_ms : master->config.timeout_ms;
+
+    result->exception = 0;
+    for (uint8_t try = 0; ; try++) {
+        int64_t start_us = now_us();
+        int status = port->send(port->ctx, req->frame, req->frame_len);
+        pthread_mutex_lock(&master->lock);
+        master->stats.request_num++;
+        master->stats.retry_num += (try > 0) ? 1 : 0;
+        pthread_mutex_unlock(&master->lock);
+
+        if ((status == MODBUS_RTU_OK) && (req->request.slave == MODBUS_RTU_ADDRESS_BROADCAST)) {
+            /* Nothing answers, the slaves are given the time to handle it before the next request */
+            sleep_us((int64_t)master->config.turnaround_ms * 1000);
+        }
+        /* Wait for the answer of the slave, the frames of other slaves are late answers */
+        int64_t end_us = start_us + (int64_t)timeout_ms * 1000;
+        size_t len = 0;
+        while ((status == MODBUS_RTU_OK) && (req->request.slave != MODBUS_RTU_ADDRESS_BROADCAST)) {
+            int64_t wait_us = end_us - now_us();
+            if (wait_us <= 0) {
+                status = MODBUS_RTU_ERR_TIMEOUT;
+                break;
+            }
+            status = port->recv(port->ctx, slot->frame, sizeof(slot->frame), (uint32_t)((wait_us + 999) / 1000), &len);
+            if ((status == MODBUS_RTU_OK) && (len >= 1) && (slot->frame[0] != req->request.slave)) {
+                count_error(master, MODBUS_RTU_ERR_FRAME);
+                continue;
+            }
+            if (status == MODBUS_RTU_OK) {
+                status = check_answer(req, slot->frame, len, &result->exception);
+            }
+            break;
+        }
+
+        result->status = status;
+        result->retry_num = try;
+        result->latency_us = (uint32_t)(now_us() - start_us);
+        if ((status == MODBUS_RTU_OK) || (status == MODBUS_RTU_ERR_EXCEPTION)) {
+            pthread_mutex_lock(&master->lock);
+            master->stats.response_num++;
+            master->stats.exception_num += (status == MODBUS_RTU_ERR_EXCEPTION) ? 1 : 0;
+            pthread_mutex_unlock(&master->lock);
+            break;
+        }
+        count_error(master, status);
+        if ((try >= retry_max) || (status == MODBUS_RTU_ERR_PORT)) {
+            break;
+        }
+    }
+
+    bool is_read = (req->request.function <= MODBUS_RTU_READ_INPUT_REGISTERS);
+    result->data = ((result->status == MODBUS_RTU_OK) && is_read) ? &slot->frame[3] : NULL;
+    result->data_len = (result->data != NULL) ? slot->frame[2] : 0;
+}
+
+/* The most overdue request which isn't on the line, in the lock */
+static request_t *next_request(modbus_rtu_master_t *master, int64_t now, int64_t *wait_us)
+{
+    request_t *next = NULL;
+
+    for (int i = 0; i < master->config.request_max; i++) {
+        request_t *req = &master->requests[i];
+        if ((req->id != 0) && !req->is_busy && ((next == NULL) || (req->due_us < next->due_us))) {
+            next = req;
+        }
+    }
+    if (next == NULL) {
+        *wait_us = IDLE_WAIT_US;
+        return NULL;
+    }
+    if (next->due_us > now) {
+        *wait_us = next->due_us - now;
+        return NULL;
+    }
+
+    return next;
+}
+
+static void *task_main(void *arg)
+{
+    modbus_rtu_master_t *master = (modbus_rtu_master_t *)arg;
+
+    pthread_mutex_lock(&master->lock);
+    while (!master->exit) {
+        int64_t start_us = now_us();
+        int64_t wait_us = 0;
+        request_t *req = next_request(master, start_us, &wait_us);
+        if (req == NULL) {
+            cond_wait_us(&master->cond, &master->lock, wait_us);
+            continue;
+        }
+        /* The line waits for the application to release a result */
+        if (master->free_num == 0) {
+            master->stats.stall_num++;
+            while ((master->free_num == 0) && !master->exit) {
+                pthread_cond_wait(&master->cond, &master->lock);
+            }
+            continue;
+        }
+
+        uint8_t slot_index = master->free_slots[--master->free_num];
+        result_slot_t *slot = &master->slots[slot_index];
+        uint8_t slave = req->request.slave;
+        bool is_offline = (master->fail_num[slave] > 0);
+        req->is_busy = true;
+        pthread_mutex_unlock(&master->lock);
+
+        run_request(master, req, is_offline ? 0 : req->request.retry_max, slot);
+
+        pthread_mutex_lock(&master->lock);
+        req->is_busy = false;
+        modbus_rtu_result_t *result = &slot->result;
+        result->id = req->id;
+        result->slave = slave;
+        result->function = req->request.function;
+        result->address = req->request.address;
+        result->count = req->request.count;
+        bool is_failed = (result->status != MODBUS_RTU_OK) && (result->status != MODBUS_RTU_ERR_EXCEPTION);
+        if (slave != MODBUS_RTU_ADDRESS_BROADCAST) {
+            master->fail_num[slave] = is_failed ? ((master->fail_num[slave] < UINT8_MAX) ?
+                                                   master->fail_num[slave] + 1 : UINT8_MAX) : 0;
+        }
+        if ((req->request.period_ms == 0) || req->is_removed) {
+            req->id = 0;
+        } else {
+            /* At a fixed rate: a request delayed by the line is due again at once, without drifting */
+            req->due_us += (int64_t)req->request.period_ms * 1000;
+            if (req->due_us < start_us) {
+                req->due_us = start_us;
+            }
+            if (master->fail_num[slave] > 0) {
+                int64_t offline_due_us = start_us + (int64_t)master->config.offline_period_ms * 1000;
+                req->due_us = (req->due_us > offline_due_us) ? req->due_us : offline_due_us;
+            }
+        }
+        master->queued_slots[(master->queued_head + master->queued_num) % master->config.result_num] = slot_index;
+        master->queued_num++;
+        pthread_cond_signal(&master->result_cond);
+    }
+    pthread_mutex_unlock(&master->lock);
+
+    return NULL;
+}
+
+static bool start_task(modbus_rtu_master_t *master)
+{
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t prev_cfg;
+    bool has_prev_cfg = (esp_pthread_get_cfg(&prev_cfg) == ESP_OK);
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = master->config.stack_size;
+    cfg.prio = master->config.priority;
+    cfg.thread_name = "modbus_master";
+    cfg.pin_to_core = tskNO_AFFINITY;
+    esp_pthread_set_cfg(&cfg);
+#endif
+
+    master->has_task = (pthread_create(&master->task, NULL, task_main, master) == 0);
+
+#ifdef ESP_PLATFORM
+    if (has_prev_cfg) {
+        esp_pthread_set_cfg(&prev_cfg);
+    } else {
+        esp_pthread_cfg_t restore_cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&restore_cfg);
+    }
+#endif
+
+    return master->has_task;
+}
+
+int modbus_rtu_master_new(const modbus_rtu_master_config_t *config, modbus_rtu_master_t **ret_master)
+{
+    if ((config == NULL) || (ret_master == NULL) || (config->port.send == NULL) || (config->port.recv == NULL) ||
+            (config->request_max == 0) || (config->result_num == 0) || (config->timeout_ms == 0)) {
+        return MODBUS_RTU_ERR_INVALID;
+    }
+
+    modbus_rtu_master_t *master = calloc(1, sizeof(modbus_rtu_master_t));
+    if (master == NULL) {
+        return MODBUS_RTU_ERR_NO_MEM;
+    }
+    master->config = *config;
+    master->next_id = 1;
+    master->requests = calloc(config->request_max, sizeof(request_t));
+    master->slots = calloc(config->result_num, sizeof(result_slot_t));
+    master->free_slots = calloc(config->result_num, sizeof(uint8_t));
+    master->queued_slots = calloc(config->result_num, sizeof(uint8_t));
+    if ((master->requests == NULL) || (master->slots == NULL) || (master->free_slots == NULL) ||
+            (master->queued_slots == NULL)) {
+        goto err;
+    }
+    for (int i = 0; i < config->result_num; i++) {
+        master->free_slots[i] = i;
+    }
+    master->free_num = config->result_num;
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+#ifndef ESP_PLATFORM
+    pthread_condattr_setclock(&cond_attr, MODBUS_RTU_COND_CLOCK);
+#endif
+    pthread_mutex_init(&master->lock, NULL);
+    pthread_cond_init(&master->cond, &cond_attr);
+    pthread_cond_init(&master->result_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (!start_task(master)) {
+        MODBUS_RTU_LOGE("create task failed");
+        pthread_cond_destroy(&master->result_cond);
+        pthread_cond_destroy(&master->cond);
+        pthread_mutex_destroy(&master->lock);
+        goto err;
+    }
+
+    *ret_master = master;
+    return MODBUS_RTU_OK;
+
+err:
+    free(master->queued_slots);
+    free(master->free_slots);
+    free(master->slots);
+    free(master->requests);
+    free(master);
+    return MODBUS_RTU_ERR_NO_MEM;
+}
+
+void modbus_rtu_master_del(modbus_rtu_master_t *master)
+{
+    if (master == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&master->lock);
+    master->exit = true;
+    pthread_cond_broadcast(&master->cond);
+    pthread_mutex_unlock(&master->lock);
+    pthread_join(master->task, NULL);
+
+    pthread_cond_destroy(&master->result_cond);
+    pthread_cond_destroy(&master->cond);
+    pthread_mutex_destroy(&master->lock);
+    free(master->queued_slots);
+    free(master->free_slots);
+    free(master->slots);
+    free(master->requests);
+    free(master);
+}
+
+int modbus_rtu_master_add(modbus_rtu_master_t *master, const modbus_rtu_request_t *request, int *ret_id)
+{
+    if ((master == NULL) || (request == NULL)) {
+        return MODBUS_RTU_ERR_INVALID;
+    }
+
+    /* Built out of the lock, in a request the task doesn't see yet */
+    request_t new_req = {
+        .request = *request,
+    };
+    if (!build_request(&new_req, request)) {
+        return MODBUS_RTU_ERR_INVALID;
+    }
+    new_req.request.values = NULL;
+
+    pthread_mutex_lock(&master->lock);
+    request_t *req = NULL;
+    for (int i = 0; i < master->config.request_max; i++) {
+        if ((master->requests[i].id == 0) && !master->requests[i].is_busy) {
+            req = &master->requests[i];
+            break;
+        }
+    }
+    if (req == NULL) {
+        pthread_mutex_unlock(&master->lock);
+        return MODBUS_RTU_ERR_NO_MEM;
+    }
+    *req = new_req;
+    req->id = master->next_id++;
+    if (master->next_id <= 0) {
+        master->next_id = 1;
+    }
+    req->due_us = now_us();
+    if (ret_id != NULL) {
+        *ret_id = req->id;
+    }
+    pthread_cond_signal(&master->cond);
+    pthread_mutex_unlock(&master->lock);
+
+    return MODBUS_RTU_OK;
+}
+
+int modbus_rtu_master_remove(modbus_rtu_master_t *master, int id)
+{
+    int ret = MODBUS_RTU_ERR_INVALID;
+
+    pthread_mutex_lock(&master->lock);
+    for (int i = 0; (i < master->config.request_max) && (id > 0); i++) {
+        request_t *req = &master->requests[i];
+        if (req->id != id) {
+            continue;
+        }
+        if (req->is_busy) {
+            req->is_removed = true;
+        } else {
+            req->id = 0;
+        }
+        ret = MODBUS_RTU_OK;
+        break;
+    }
+    pthread_mutex_unlock(&master->lock);
+
+    return ret;
+}
+
+int modbus_rtu_master_take(modbus_rtu_master_t *master, uint32_t timeout_ms, const modbus_rtu_result_t **ret_result)
+{
+    int64_t end_us = now_us() + (int64_t)timeout_ms * 1000;
+
+    pthread_mutex_lock(&master->lock);
+    while (master->queued_num == 0) {
+        int64_t wait_us = end_us - now_us();
+        if (wait_us <= 0) {
+            pthread_mutex_unlock(&master->lock);
+            return MODBUS_RTU_ERR_TIMEOUT;
+        }
+        cond_wait_us(&master->result_cond, &master->lock, wait_us);
+    }
+    uint8_t slot_index = master->queued_slots[master->queued_head];
+    master->queued_head = (master->queued_head + 1) % master->config.result_num;
+    master->queued_num--;
+    pthread_mutex_unlock(&master->lock);
+
+    *ret_result = &master->slots[slot_index].result;
+    return MODBUS_RTU_OK;
+}
+
+void modbus_rtu_master_release(modbus_rtu_master_t *master, const modbus_rtu_result_t *result)
+{
+    /* The result is the first member of its slot */
+    uint8_t slot_index = (uint8_t)((const result_slot_t *)result - master->slots);
+
+    pthread_mutex_lock(&master->lock);
+    master->free_slots[master->free_num++] = slot_index;
+    pthread_cond_signal(&master->cond);
+    pthread_mutex_unlock(&master->lock);
+}
+
+void modbus_rtu_master_get_stats(modbus_rtu_master_t *master, modbus_rtu_master_stats_t *stats)
+{
+    pthread_mutex_lock(&master->lock);
+    *stats = master->stats;
+    pthread_mutex_unlock(&master->lock);
+}
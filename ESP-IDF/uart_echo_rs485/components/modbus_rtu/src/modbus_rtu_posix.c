@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include "modbus_rtu_posix.h"
+
+typedef struct {
+    int fd;
+    uint32_t t35_us;
+} posix_port_t;
+
+/* Wait for a byte to read: 1 if there is one, 0 after the time, -1 on an error */
+static int wait_readable(int fd, uint32_t wait_us)
+{
+    while (true) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(fd, &read_fds);
+        struct timeval timeout = {
+            .tv_sec = wait_us / 1000000,
+            .tv_usec = wait_us % 1000000,
+        };
+        int ret = select(fd + 1, &read_fds, NULL, NULL, &timeout);
+        if ((ret >= 0) || (errno != EINTR)) {
+            return (ret > 0) ? 1 : ret;
+        }
+    }
+}
+
+static int posix_send(void *ctx, const uint8_t *frame, size_t len)
+{
+    posix_port_t *port = (posix_port_t *)ctx;
+    size_t offset = 0;
+
+    while (offset < len) {
+        ssize_t ret = write(port->fd, &frame[offset], len - offset);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return MODBUS_RTU_ERR_PORT;
+        }
+        offset += ret;
+    }
+    /* A serial port returns when the last byte is on the line, so the silence after it can be timed */
+    tcdrain(port->fd);
+
+    return MODBUS_RTU_OK;
+}
+
+static int posix_recv(void *ctx, uint8_t *frame, size_t size, uint32_t timeout_ms, size_t *len)
+{
+    posix_port_t *port = (posix_port_t *)ctx;
+    bool is_dropped = false;
+    uint8_t drop[64];
+
+    *len = 0;
+    int ret = wait_readable(port->fd, timeout_ms * 1000);
+    if (ret <= 0) {
+        return (ret == 0) ? MODBUS_RTU_ERR_TIMEOUT : MODBUS_RTU_ERR_PORT;
+    }
+    /* Read the frame in place until the line is silent for T3.5, the bytes past the buffer are dropped */
+    do {
+        bool is_full = (*len == size);
+        ssize_t read_len = read(port->fd, is_full ? drop : &frame[*len], is_full ? sizeof(drop) : (size - *len));
+        if (read_len < 0) {
+            if ((errno == EINTR) || (errno == EAGAIN)) {
+                continue;
+            }
+            return MODBUS_RTU_ERR_PORT;
+        }
+        if (is_full) {
+            is_dropped |= (read_len > 0);
+        } else {
+            *len += read_len;
+        }
+        ret = wait_readable(port->fd, port->t35_us);
+    } while (ret > 0);
+
+    if (ret < 0) {
+        return MODBUS_RTU_ERR_PORT;
+    }
+    return is_dropped ? MODBUS_RTU_ERR_FRAME : MODBUS_RTU_OK;
+}
+
+int modbus_rtu_posix_new(const modbus_rtu_posix_config_t *config, modbus_rtu_port_t *ret_port)
+{
+    if ((config == NULL) || (ret_port == NULL) || (config->fd < 0)) {
+        return MODBUS_RTU_ERR_INVALID;
+    }
+
+    posix_port_t *port = calloc(1, sizeof(posix_port_t));
+    if (port == NULL) {
+        return MODBUS_RTU_ERR_NO_MEM;
+    }
+    port->fd = config->fd;
+    port->t35_us = (config->t35_us > 0) ? config->t35_us : modbus_rtu_t35_us(config->baud_rate);
+
+    ret_port->send = posix_send;
+    ret_port->recv = posix_recv;
+    ret_port->ctx = port;
+    return MODBUS_RTU_OK;
+}
+
+void modbus_rtu_posix_del(modbus_rtu_port_t *port)
+{
+    if ((port == NULL) || (port->ctx == NULL)) {
+        return;
+    }
+
+    free(port->ctx);
+    port->ctx = NULL;
+}
@@ -0,0 +1,288 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "modbus_rtu_slave.h"
+
+struct modbus_rtu_slave_t {
+    modbus_rtu_slave_config_t config;
+    pthread_mutex_t lock;
+    modbus_rtu_slave_stats_t stats;
+    uint8_t frame[MODBUS_RTU_FRAME_MAX];
+};
+
+static inline uint16_t get_u16(const uint8_t *data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static inline void put_u16(uint8_t *data, uint16_t value)
+{
+    data[0] = value >> 8;
+    data[1] = value & 0xff;
+}
+
+static inline bool get_bit(const uint8_t *bits, uint32_t index)
+{
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static inline void set_bit(uint8_t *bits, uint32_t index, bool value)
+{
+    if (value) {
+        bits[index / 8] |= 1 << (index % 8);
+    } else {
+        bits[index / 8] &= ~(1 << (index % 8));
+    }
+}
+
+static bool in_table(const void *table, uint16_t table_num, uint16_t address, uint16_t count)
+{
+    return (table != NULL) && ((uint32_t)address + count <= table_num);
+}
+
+static uint8_t read_bits(const uint8_t *table, uint16_t table_num, uint8_t *frame, size_t size, size_t *pdu_len)
+{
+    uint16_t address = get_u16(&frame[2]);
+    uint16_t count = get_u16(&frame[4]);
+    size_t byte_num = (count + 7) / 8;
+
+    if ((count == 0) || (count > MODBUS_RTU_READ_BIT_MAX) || (3 + byte_num + 2 > size)) {
+        return MODBUS_RTU_EX_ILLEGAL_DATA_VALUE;
+    }
+    if (!in_table(table, table_num, address, count)) {
+        return MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS;
+    }
+
+    /* The request is parsed, the answer is written over it */
+    uint8_t *data = &frame[3];
+    frame[2] = (uint8_t)byte_num;
+    memset(data, 0, byte_num);
+    for (uint16_t i = 0; i < count; i++) {
+        if (get_bit(table, address + i)) {
+            data[i / 8] |= 1 << (i % 8);
+        }
+    }
+    *pdu_len = 3 + byte_num;
+
+    return 0;
+}
+
+static uint8_t read_registers(const uint16_t *table, uint16_t table_num, uint8_t *frame, size_t size,
+                              size_t *pdu_len)
+{
+    uint16_t address = get_u16(&frame[2]);
+    uint16_t count = get_u16(&frame[4]);
+
+    if ((count == 0) || (count > MODBUS_RTU_READ_REGISTER_MAX) || (3 + count * 2 + 2u > size)) {
+        return MODBUS_RTU_EX_ILLEGAL_DATA_VALUE;
+    }
+    if (!in_table(table, table_num, address, count)) {
+        return MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS;
+    }
+
+    frame[2] = (uint8_t)(count * 2);
+    for (uint16_t i = 0; i < count; i++) {
+        put_u16(&frame[3 + i * 2], table[address + i]);
+    }
+    *pdu_len = 3 + count * 2;
+
+    return 0;
+}
+
+/* Check the request and answer it in its place, or return an exception */
+static uint8_t handle_request(modbus_rtu_slave_t *slave, uint8_t *frame, size_t len, size_t size, size_t *pdu_len,
+                              uint16_t *write_count)
+{
+    const modbus_rtu_slave_config_t *config = &slave->config;
+    uint8_t function = frame[1];
+    bool is_read = (function >= MODBUS_RTU_READ_COILS) && (function <= MODBUS_RTU_READ_INPUT_REGISTERS);
+    bool is_single = (function == MODBUS_RTU_WRITE_SINGLE_COIL) || (function == MODBUS_RTU_WRITE_SINGLE_REGISTER);
+    bool is_multiple = (function == MODBUS_RTU_WRITE_MULTIPLE_COILS) ||
+                       (function == MODBUS_RTU_WRITE_MULTIPLE_REGISTERS);
+
+    if (!is_read && !is_single && !is_multiple) {
+        return MODBUS_RTU_EX_ILLEGAL_FUNCTION;
+    }
+    /* Address, function, 4 bytes of fields and the CRC, and the values of a multiple write */
+    if ((len < 8) || ((is_read || is_single) && (len != 8)) || (is_multiple && ((len < 9) || (len != 9u + frame[6])))) {
+        return MODBUS_RTU_EX_ILLEGAL_DATA_VALUE;
+    }
+
+    uint16_t address = get_u16(&frame[2]);
+    uint16_t value = get_u16(&frame[4]);
+    switch (function) {
+    case MODBUS_RTU_READ_COILS:
+        return read_bits(config->coils, config->coil_num, frame, size, pdu_len);
+    case MODBUS_RTU_READ_DISCRETE_INPUTS:
+        return read_bits(config->discrete_inputs, config->discrete_input_num, frame, size, pdu_len);
+    case MODBUS_RTU_READ_HOLDING_REGISTERS:
+        return read_registers(config->holding_registers, config->holding_register_num, frame, size, pdu_len);
+    case MODBUS_RTU_READ_INPUT_REGISTERS:
+        return read_registers(config->input_registers, config->input_register_num, frame, size, pdu_len);
+    case MODBUS_RTU_WRITE_SINGLE_COIL:
+        if ((value != 0xff00) && (value != 0x0000)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_VALUE;
+        }
+        if (!in_table(config->coils, config->coil_num, address, 1)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS;
+        }
+        set_bit(config->coils, address, value == 0xff00);
+        break;
+    case MODBUS_RTU_WRITE_SINGLE_REGISTER:
+        if (!in_table(config->holding_registers, config->holding_register_num, address, 1)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS;
+        }
+        config->holding_registers[address] = value;
+        break;
+    case MODBUS_RTU_WRITE_MULTIPLE_COILS:
+        if ((value == 0) || (value > MODBUS_RTU_WRITE_BIT_MAX) || (frame[6] != (value + 7) / 8)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_VALUE;
+        }
+        if (!in_table(config->coils, config->coil_num, address, value)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS;
+        }
+        for (uint16_t i = 0; i < value; i++) {
+            set_bit(config->coils, address + i, get_bit(&frame[7], i));
+        }
+        break;
+    case MODBUS_RTU_WRITE_MULTIPLE_REGISTERS:
+        if ((value == 0) || (value > MODBUS_RTU_WRITE_REGISTER_MAX) || (frame[6] != value * 2)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_VALUE;
+        }
+        if (!in_table(config->holding_registers, config->holding_register_num, address, value)) {
+            return MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS;
+        }
+        for (uint16_t i = 0; i < value; i++) {
+            config->holding_registers[address + i] = get_u16(&frame[7 + i * 2]);
+        }
+        break;
+    }
+
+    /* A write is answered with the echo of its address, function, and the address and the value or the count */
+    *pdu_len = 6;
+    *write_count = is_single ? 1 : value;
+    return 0;
+}
+
+int modbus_rtu_slave_new(const modbus_rtu_slave_config_t *config, modbus_rtu_slave_t **ret_slave)
+{
+    if ((config == NULL) || (ret_slave == NULL) || (config->address == MODBUS_RTU_ADDRESS_BROADCAST) ||
+            (config->address > MODBUS_RTU_ADDRESS_MAX)) {
+        return MODBUS_RTU_ERR_INVALID;
+    }
+
+    modbus_rtu_slave_t *slave = calloc(1, sizeof(modbus_rtu_slave_t));
+    if (slave == NULL) {
+        return MODBUS_RTU_ERR_NO_MEM;
+    }
+    slave->config = *config;
+    pthread_mutex_init(&slave->lock, NULL);
+
+    *ret_slave = slave;
+    return MODBUS_RTU_OK;
+}
+
+void modbus_rtu_slave_del(modbus_rtu_slave_t *slave)
+{
+    if (slave == NULL) {
+        return;
+    }
+
+    pthread_mutex_destroy(&slave->lock);
+    free(slave);
+}
+
+int modbus_rtu_slave_handle(modbus_rtu_slave_t *slave, uint8_t *frame, size_t len, size_t size, size_t *resp_len)
+{
+    *resp_len = 0;
+    if (!modbus_rtu_check_crc(frame, len)) {
+        pthread_mutex_lock(&slave->lock);
+        slave->stats.crc_error_num++;
+        pthread_mutex_unlock(&slave->lock);
+        return MODBUS_RTU_ERR_CRC;
+    }
+
+    bool is_broadcast = (frame[0] == MODBUS_RTU_ADDRESS_BROADCAST);
+    bool is_write = (frame[1] >= MODBUS_RTU_WRITE_SINGLE_COIL) && (frame[1] <= MODBUS_RTU_WRITE_MULTIPLE_REGISTERS);
+    pthread_mutex_lock(&slave->lock);
+    /* A broadcast is a write, read by all the slaves of the line: it can't be answered in place */
+    if (((frame[0] != slave->config.address) && !is_broadcast) || (is_broadcast && !is_write)) {
+        slave->stats.ignored_num++;
+        pthread_mutex_unlock(&slave->lock);
+        return MODBUS_RTU_OK;
+    }
+
+    size_t pdu_len = 0;
+    uint16_t write_count = 0;
+    uint8_t exception = handle_request(slave, frame, len, size, &pdu_len, &write_count);
+    slave->stats.frame_num++;
+    if ((exception == 0) && (write_count > 0) && (slave->config.on_write != NULL)) {
+        slave->config.on_write(frame[1], (uint16_t)((frame[2] << 8) | frame[3]), write_count,
+                               slave->config.user_data);
+    }
+    if (is_broadcast) {
+        slave->stats.broadcast_num++;
+        pthread_mutex_unlock(&slave->lock);
+        return MODBUS_RTU_OK;
+    }
+    if (exception != 0) {
+        frame[1] |= 0x80;
+        frame[2] = exception;
+        pdu_len = 3;
+        slave->stats.exception_num++;
+    }
+    slave->stats.response_num++;
+    pthread_mutex_unlock(&slave->lock);
+
+    *resp_len = modbus_rtu_append_crc(frame, pdu_len);
+    return MODBUS_RTU_OK;
+}
+
+int modbus_rtu_slave_poll(modbus_rtu_slave_t *slave, uint32_t timeout_ms)
+{
+    const modbus_rtu_port_t *port = &slave->config.port;
+    size_t len = 0;
+
+    int ret = port->recv(port->ctx, slave->frame, sizeof(slave->frame), timeout_ms, &len);
+    if (ret == MODBUS_RTU_ERR_FRAME) {
+        pthread_mutex_lock(&slave->lock);
+        slave->stats.overrun_num++;
+        pthread_mutex_unlock(&slave->lock);
+        return MODBUS_RTU_OK;
+    }
+    if (ret != MODBUS_RTU_OK) {
+        return ret;
+    }
+
+    /* The line has been silent for T3.5 since the request, the answer can be sent at once */
+    size_t resp_len = 0;
+    if ((modbus_rtu_slave_handle(slave, slave->frame, len, sizeof(slave->frame), &resp_len) == MODBUS_RTU_OK) &&
+            (resp_len > 0)) {
+        return port->send(port->ctx, slave->frame, resp_len);
+    }
+
+    return MODBUS_RTU_OK;
+}
+
+void modbus_rtu_slave_lock(modbus_rtu_slave_t *slave)
+{
+    pthread_mutex_lock(&slave->lock);
+}
+
+void modbus_rtu_slave_unlock(modbus_rtu_slave_t *slave)
+{
+    pthread_mutex_unlock(&slave->lock);
+}
+
+void modbus_rtu_slave_get_stats(modbus_rtu_slave_t *slave, modbus_rtu_slave_stats_t *stats)
+{
+    pthread_mutex_lock(&slave->lock);
+    *stats = slave->stats;
+    pthread_mutex_unlock(&slave->lock);
+}
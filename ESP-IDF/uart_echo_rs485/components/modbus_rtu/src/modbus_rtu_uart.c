@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "modbus_rtu_uart.h"
+
+#define EVENT_QUEUE_LEN         (16)
+/* The driver posts the bytes of a frame each time the RX FIFO holds this many of them, or at the RX timeout */
+#define RX_FULL_THRESH          (120)
+/* The latency of the interrupt and of the event queue, over the time between two events of a frame on the line */
+#define FRAME_EVENT_MARGIN_MS   (10)
+#define SEND_WAIT_MS            (500)
+/* The RX timeout of the UART, in characters */
+#define RX_TOUT_MIN             (4)
+#define RX_TOUT_MAX             (100)
+
+static const char *TAG = "modbus_rtu_uart";
+
+typedef struct {
+    uart_port_t uart_num;
+    QueueHandle_t event_queue;
+    TickType_t frame_event_wait;    /* The most between two events of a frame, e.g. the RX FIFO full then the RX timeout */
+} uart_port_ctx_t;
+
+static TickType_t ms_to_ticks(uint32_t ms)
+{
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+}
+
+static int uart_send(void *ctx, const uint8_t *frame, size_t len)
+{
+    uart_port_ctx_t *port = (uart_port_ctx_t *)ctx;
+
+    if (uart_write_bytes(port->uart_num, frame, len) != (int)len) {
+        return MODBUS_RTU_ERR_PORT;
+    }
+    /* The silence after the frame is timed from its last bit */
+    if (uart_wait_tx_done(port->uart_num, ms_to_ticks(SEND_WAIT_MS)) != ESP_OK) {
+        return MODBUS_RTU_ERR_PORT;
+    }
+
+    return MODBUS_RTU_OK;
+}
+
+static int uart_recv(void *ctx, uint8_t *frame, size_t size, uint32_t timeout_ms, size_t *len)
+{
+    uart_port_ctx_t *port = (uart_port_ctx_t *)ctx;
+    TickType_t wait = ms_to_ticks(timeout_ms);
+    bool is_bad = false;
+    uart_event_t event;
+
+    *len = 0;
+    while (true) {
+        if (xQueueReceive(port->event_queue, &event, wait) != pdTRUE) {
+            /* The end of a frame was lost, e.g. in a queue overflow */
+            return (*len == 0) ? MODBUS_RTU_ERR_TIMEOUT : MODBUS_RTU_ERR_FRAME;
+        }
+        switch (event.type) {
+        case UART_DATA: {
+            size_t read_len = (event.size < size - *len) ? event.size : (size - *len);
+            int ret = uart_read_bytes(port->uart_num, &frame[*len], read_len, 0);
+            *len += (ret > 0) ? ret : 0;
+            if (read_len < event.size) {
+                /* Longer than a frame, the rest of it is dropped */
+                uart_flush_input(port->uart_num);
+                is_bad = true;
+            }
+            if (event.timeout_flag) {
+                return is_bad ? MODBUS_RTU_ERR_FRAME : MODBUS_RTU_OK;
+            }
+            wait = port->frame_event_wait;
+            break;
+        }
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            ESP_LOGW(TAG, "rx overflow");
+            uart_flush_input(port->uart_num);
+            xQueueReset(port->event_queue);
+            return MODBUS_RTU_ERR_FRAME;
+        case UART_FRAME_ERR:
+        case UART_PARITY_ERR:
+            is_bad = true;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+int modbus_rtu_uart_new(const modbus_rtu_uart_config_t *config, modbus_rtu_port_t *ret_port)
+{
+    if ((config == NULL) || (ret_port == NULL) || (config->baud_rate == 0)) {
+        return MODBUS_RTU_ERR_INVALID;
+    }
+
+    uart_port_ctx_t *port = calloc(1, sizeof(uart_port_ctx_t));
+    if (port == NULL) {
+        return MODBUS_RTU_ERR_NO_MEM;
+    }
+    port->uart_num = config->uart_num;
+
+    uart_config_t uart_config = {
+        .baud_rate = config->baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = config->parity,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    /* T3.5 in characters of 11 bits, rounded up */
+    uint32_t char_us = (11 * 1000000 + config->baud_rate - 1) / config->baud_rate;
+    uint32_t rx_tout = (modbus_rtu_t35_us(config->baud_rate) + char_us - 1) / char_us;
+    rx_tout = (rx_tout < RX_TOUT_MIN) ? RX_TOUT_MIN : ((rx_tout > RX_TOUT_MAX) ? RX_TOUT_MAX : rx_tout);
+    /* A full RX FIFO then the RX timeout, e.g. 14 ms at 115200 baud but 142 ms at 9600 baud */
+    uint32_t frame_event_wait_ms = (modbus_rtu_read_wait_us(config->baud_rate, RX_FULL_THRESH) + 999) / 1000;
+    port->frame_event_wait = ms_to_ticks(frame_event_wait_ms + FRAME_EVENT_MARGIN_MS);
+
+    esp_err_t ret = uart_driver_install(config->uart_num, config->rx_buf_size, 0, EVENT_QUEUE_LEN,
+                                        &port->event_queue, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "install driver failed: %s", esp_err_to_name(ret));
+        free(port);
+        return MODBUS_RTU_ERR_PORT;
+    }
+    if ((uart_param_config(config->uart_num, &uart_config) != ESP_OK) ||
+            (uart_set_pin(config->uart_num, config->tx_pin, config->rx_pin, config->rts_pin,
+                          UART_PIN_NO_CHANGE) != ESP_OK) ||
+            (uart_set_mode(config->uart_num, UART_MODE_RS485_HALF_DUPLEX) != ESP_OK) ||
+            (uart_set_rx_timeout(config->uart_num, rx_tout) != ESP_OK) ||
+            (uart_set_rx_full_threshold(config->uart_num, RX_FULL_THRESH) != ESP_OK)) {
+        ESP_LOGE(TAG, "configure uart failed");
+        uart_driver_delete(config->uart_num);
+        free(port);
+        return MODBUS_RTU_ERR_PORT;
+    }
+
+    ret_port->send = uart_send;
+    ret_port->recv = uart_recv;
+    ret_port->ctx = port;
+    return MODBUS_RTU_OK;
+}
+
+void modbus_rtu_uart_del(modbus_rtu_port_t *port)
+{
+    if ((port == NULL) || (port->ctx == NULL)) {
+        return;
+    }
+
+    uart_port_ctx_t *ctx = (uart_port_ctx_t *)port->ctx;
+    uart_driver_delete(ctx->uart_num);
+    free(ctx);
+    port->ctx = NULL;
+}
@@ -0,0 +1,756 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Run the master against slaves over a pty pair, a line of the host: the slaves of a line are served by one thread,
+ * some of them dead or flaky, then measure the transactions per second and their latency. See README.md.
+ */
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "modbus_rtu.h"
+#include "modbus_rtu_master.h"
+#include "modbus_rtu_posix.h"
+#include "modbus_rtu_slave.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+#define TEST_SLAVE_MAX          (16)
+#define TEST_REGISTER_NUM       (64)
+#define TEST_COIL_NUM           (40)
+#define TEST_T35_US             (300)       /* Shorter than at 115200 baud, for the functional tests */
+
+static uint64_t test_seed = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t test_rand(void)
+{
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 7;
+    test_seed ^= test_seed << 17;
+    return test_seed;
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool open_pty(int *master_fd, int *slave_fd)
+{
+    *master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((*master_fd < 0) || (grantpt(*master_fd) != 0) || (unlockpt(*master_fd) != 0)) {
+        return false;
+    }
+    *slave_fd = open(ptsname(*master_fd), O_RDWR | O_NOCTTY);
+    if (*slave_fd < 0) {
+        return false;
+    }
+
+    /* Bytes as they are, no echo */
+    struct termios tio;
+    tcgetattr(*slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave_fd, TCSANOW, &tio);
+    return true;
+}
+
+typedef enum {
+    BEHAVIOR_NORMAL = 0,
+    BEHAVIOR_DEAD,          /* Never answers */
+    BEHAVIOR_FLAKY,         /* Answers every other request */
+    BEHAVIOR_CORRUPT,       /* Corrupts one answer of 3 */
+} behavior_t;
+
+/* The slaves of a line, served by one thread on one end of the pty */
+typedef struct {
+    int fd;
+    modbus_rtu_port_t port;
+    modbus_rtu_slave_t *slaves[TEST_SLAVE_MAX + 1];
+    uint16_t registers[TEST_SLAVE_MAX + 1][TEST_REGISTER_NUM];
+    uint8_t coils[TEST_SLAVE_MAX + 1][(TEST_COIL_NUM + 7) / 8];
+    behavior_t behaviors[TEST_SLAVE_MAX + 1];
+    uint32_t request_nums[TEST_SLAVE_MAX + 1];
+    atomic_bool stop;
+    pthread_t thread;
+} test_line_t;
+
+static void *line_main(void *arg)
+{
+    test_line_t *line = (test_line_t *)arg;
+    uint8_t frame[MODBUS_RTU_FRAME_MAX];
+
+    while (!atomic_load(&line->stop)) {
+        size_t len = 0;
+        if (line->port.recv(line->port.ctx, frame, sizeof(frame), 20, &len) != MODBUS_RTU_OK) {
+            continue;
+        }
+        uint8_t address = frame[0];
+        if (address == MODBUS_RTU_ADDRESS_BROADCAST) {
+            for (int i = 1; i <= TEST_SLAVE_MAX; i++) {
+                size_t resp_len;
+                modbus_rtu_slave_handle(line->slaves[i], frame, len, sizeof(frame), &resp_len);
+            }
+            continue;
+        }
+        if ((address > TEST_SLAVE_MAX) || (line->behaviors[address] == BEHAVIOR_DEAD)) {
+            continue;
+        }
+
+        uint32_t request_num = ++line->request_nums[address];
+        size_t resp_len = 0;
+        modbus_rtu_slave_handle(line->slaves[address], frame, len, sizeof(frame), &resp_len);
+        if ((resp_len == 0) || ((line->behaviors[address] == BEHAVIOR_FLAKY) && (request_num % 2 == 1))) {
+            continue;
+        }
+        if ((line->behaviors[address] == BEHAVIOR_CORRUPT) && (request_num % 3 == 1)) {
+            frame[resp_len - 1] ^= 0x5a;
+        }
+        line->port.send(line->port.ctx, frame, resp_len);
+    }
+
+    return NULL;
+}
+
+static bool start_line(test_line_t *line, int fd, uint32_t t35_us, const behavior_t *behaviors)
+{
+    memset(line, 0, sizeof(*line));
+    if (behaviors != NULL) {
+        memcpy(line->behaviors, behaviors, sizeof(line->behaviors));
+    }
+    modbus_rtu_posix_config_t port_config = {
+        .fd = fd,
+        .baud_rate = 115200,
+        .t35_us = t35_us,
+    };
+    if (modbus_rtu_posix_new(&port_config, &line->port) != MODBUS_RTU_OK) {
+        return false;
+    }
+    line->fd = fd;
+    for (int i = 1; i <= TEST_SLAVE_MAX; i++) {
+        for (int j = 0; j < TEST_REGISTER_NUM; j++) {
+            line->registers[i][j] = i * 1000 + j;
+        }
+        modbus_rtu_slave_config_t slave_config = {
+            .address = i,
+            .coils = line->coils[i],
+            .coil_num = TEST_COIL_NUM,
+            .holding_registers = line->registers[i],
+            .holding_register_num = TEST_REGISTER_NUM,
+        };
+        if (modbus_rtu_slave_new(&slave_config, &line->slaves[i]) != MODBUS_RTU_OK) {
+            return false;
+        }
+    }
+    atomic_store(&line->stop, false);
+    return pthread_create(&line->thread, NULL, line_main, line) == 0;
+}
+
+static void stop_line(test_line_t *line)
+{
+    atomic_store(&line->stop, true);
+    pthread_join(line->thread, NULL);
+    for (int i = 1; i <= TEST_SLAVE_MAX; i++) {
+        modbus_rtu_slave_del(line->slaves[i]);
+    }
+    modbus_rtu_posix_del(&line->port);
+}
+
+typedef struct {
+    int master_fd;
+    int slave_fd;
+    modbus_rtu_port_t port;
+    modbus_rtu_master_t *master;
+    test_line_t line;
+} test_bus_t;
+
+static bool start_bus(test_bus_t *bus, uint32_t t35_us, uint8_t result_num, uint32_t offline_period_ms,
+                      const behavior_t *behaviors)
+{
+    if (!open_pty(&bus->master_fd, &bus->slave_fd) ||
+            !start_line(&bus->line, bus->slave_fd, t35_us, behaviors)) {
+        return false;
+    }
+    modbus_rtu_posix_config_t port_config = {
+        .fd = bus->master_fd,
+        .baud_rate = 115200,
+        .t35_us = t35_us,
+    };
+    if (modbus_rtu_posix_new(&port_config, &bus->port) != MODBUS_RTU_OK) {
+        return false;
+    }
+    modbus_rtu_master_config_t config = MODBUS_RTU_MASTER_DEFAULT_CONFIG();
+    config.port = bus->port;
+    config.result_num = result_num;
+    config.timeout_ms = 20;
+    config.turnaround_ms = 5;
+    config.offline_period_ms = offline_period_ms;
+    return modbus_rtu_master_new(&config, &bus->master) == MODBUS_RTU_OK;
+}
+
+static void stop_bus(test_bus_t *bus)
+{
+    modbus_rtu_master_del(bus->master);
+    stop_line(&bus->line);
+    modbus_rtu_posix_del(&bus->port);
+    close(bus->slave_fd);
+    close(bus->master_fd);
+}
+
+static uint16_t crc16_ref(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xffff;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xa001) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static bool test_crc(void)
+{
+    /* The read of 10 holding registers of slave 1, from the specification */
+    uint8_t frame[8] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0a};
+    TEST_CHECK(modbus_rtu_append_crc(frame, 6) == 8, "length with the CRC");
+    TEST_CHECK((frame[6] == 0xc5) && (frame[7] == 0xcd), "crc %02x %02x", frame[6], frame[7]);
+    TEST_CHECK(modbus_rtu_check_crc(frame, 8), "crc not checked");
+    frame[3] ^= 1;
+    TEST_CHECK(!modbus_rtu_check_crc(frame, 8), "bad crc checked");
+    TEST_CHECK(!modbus_rtu_check_crc(frame, 3), "short frame checked");
+
+    uint8_t data[MODBUS_RTU_FRAME_MAX];
+    for (int i = 0; i < 10000; i++) {
+        size_t len = test_rand() % sizeof(data);
+        for (size_t j = 0; j < len; j++) {
+            data[j] = (uint8_t)test_rand();
+        }
+        TEST_CHECK(modbus_rtu_crc16(data, len) == crc16_ref(data, len), "crc of %zu bytes", len);
+    }
+
+    TEST_CHECK(modbus_rtu_t35_us(9600) == 4011, "t35 at 9600: %u", modbus_rtu_t35_us(9600));
+    TEST_CHECK(modbus_rtu_t35_us(19200) == 2006, "t35 at 19200: %u", modbus_rtu_t35_us(19200));
+    TEST_CHECK(modbus_rtu_t35_us(115200) == 1750, "t35 at 115200: %u", modbus_rtu_t35_us(115200));
+    TEST_CHECK(modbus_rtu_read_wait_us(9600, 120) == 141511, "read wait at 9600: %u",
+               modbus_rtu_read_wait_us(9600, 120));
+    TEST_CHECK(modbus_rtu_read_wait_us(115200, 120) == 13209, "read wait at 115200: %u",
+               modbus_rtu_read_wait_us(115200, 120));
+    return true;
+}
+
+#define TEST_SLOW_BAUD_RATE     (1200)
+#define TEST_SLOW_FRAME_LEN     (40)
+
+/* A device on a slow line, its bytes come one character apart and its frames are separated by 2 x T3.5 */
+typedef struct {
+    int fd;
+    uint32_t char_us;
+    uint32_t t35_us;
+    uint8_t frames[2][TEST_SLOW_FRAME_LEN];
+} test_slow_line_t;
+
+static void sleep_us(uint32_t us)
+{
+    struct timespec ts = {
+        .tv_sec = us / 1000000,
+        .tv_nsec = (long)(us % 1000000) * 1000,
+    };
+    while (nanosleep(&ts, &ts) != 0) {
+    }
+}
+
+static void *slow_line_main(void *arg)
+{
+    test_slow_line_t *line = (test_slow_line_t *)arg;
+
+    for (int i = 0; i < 2; i++) {
+        for (size_t j = 0; j < TEST_SLOW_FRAME_LEN; j++) {
+            if (write(line->fd, &line->frames[i][j], 1) != 1) {
+                return NULL;
+            }
+            sleep_us(line->char_us);
+        }
+        sleep_us(2 * line->t35_us);
+    }
+
+    return NULL;
+}
+
+static bool test_slow_line(void)
+{
+    int master_fd, slave_fd;
+    TEST_CHECK(open_pty(&master_fd, &slave_fd), "no pty");
+
+    modbus_rtu_posix_config_t config = {
+        .fd = slave_fd,
+        .baud_rate = TEST_SLOW_BAUD_RATE,
+    };
+    modbus_rtu_port_t port;
+    TEST_CHECK(modbus_rtu_posix_new(&config, &port) == MODBUS_RTU_OK, "no port");
+
+    static test_slow_line_t line;
+    line.fd = master_fd;
+    line.char_us = (11 * 1000000 + TEST_SLOW_BAUD_RATE - 1) / TEST_SLOW_BAUD_RATE;
+    line.t35_us = modbus_rtu_t35_us(TEST_SLOW_BAUD_RATE);
+    for (int i = 0; i < 2; i++) {
+        for (size_t j = 0; j < TEST_SLOW_FRAME_LEN; j++) {
+            line.frames[i][j] = (uint8_t)test_rand();
+        }
+    }
+    pthread_t thread;
+    TEST_CHECK(pthread_create(&thread, NULL, slow_line_main, &line) == 0, "no thread");
+
+    /* Each frame is read whole, though it takes much longer than a frame at 115200 baud */
+    bool ok = true;
+    uint8_t frame[MODBUS_RTU_FRAME_MAX];
+    for (int i = 0; ok && (i < 2); i++) {
+        size_t len = 0;
+        int ret = port.recv(port.ctx, frame, sizeof(frame), 1000, &len);
+        printf("frame %d: %zu bytes, ret %d\n", i, len, ret);
+        ok = (ret == MODBUS_RTU_OK) && (len == TEST_SLOW_FRAME_LEN) && (memcmp(frame, line.frames[i], len) == 0);
+    }
+
+    pthread_join(thread, NULL);
+    modbus_rtu_posix_del(&port);
+    close(slave_fd);
+    close(master_fd);
+    TEST_CHECK(ok, "frame split or garbled at %d baud", TEST_SLOW_BAUD_RATE);
+    return true;
+}
+
+static uint16_t written_address;
+static uint16_t written_count;
+
+static void on_write(uint8_t function, uint16_t address, uint16_t count, void *user_data)
+{
+    (void)function;
+    (void)user_data;
+    written_address = address;
+    written_count = count;
+}
+
+/* Handle a request, the answer is checked against `expected`, without its CRC */
+static bool handle(modbus_rtu_slave_t *slave, const uint8_t *request, size_t len, const uint8_t *expected,
+                   size_t expected_len)
+{
+    uint8_t frame[MODBUS_RTU_FRAME_MAX];
+    size_t resp_len = 0;
+
+    memcpy(frame, request, len);
+    len = modbus_rtu_append_crc(frame, len);
+    int ret = modbus_rtu_slave_handle(slave, frame, len, sizeof(frame), &resp_len);
+    if ((ret != MODBUS_RTU_OK) || (resp_len != ((expected_len > 0) ? expected_len + 2 : 0))) {
+        return false;
+    }
+    return (expected_len == 0) ||
+           ((memcmp(frame, expected, expected_len) == 0) && modbus_rtu_check_crc(frame, resp_len));
+}
+
+static bool test_slave(void)
+{
+    uint16_t holding[8] = {0x1234, 0x5678, 3, 4, 5, 6, 7, 8};
+    const uint16_t input[2] = {0xabcd, 0x0102};
+    uint8_t coils[2] = {0xa5, 0x03};            /* Coils 0 to 9: 1010 0101, 11 */
+    const uint8_t discrete[1] = {0x0f};
+    modbus_rtu_slave_config_t config = {
+        .address = 7,
+        .coils = coils,
+        .coil_num = 10,
+        .discrete_inputs = discrete,
+        .discrete_input_num = 8,
+        .holding_registers = holding,
+        .holding_register_num = 8,
+        .input_registers = input,
+        .input_register_num = 2,
+        .on_write = on_write,
+    };
+    modbus_rtu_slave_t *slave = NULL;
+    TEST_CHECK(modbus_rtu_slave_new(&config, &slave) == MODBUS_RTU_OK, "no slave");
+
+    /* Reads */
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x03, 0, 0, 0, 2}, 6, (uint8_t[]) {7, 0x03, 4, 0x12, 0x34, 0x56, 0x78}, 7),
+               "read holding registers");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x04, 0, 1, 0, 1}, 6, (uint8_t[]) {7, 0x04, 2, 0x01, 0x02}, 5),
+               "read input registers");
+    /* Coils 1 to 9: 0 1 0 0 1 0 1 1 1 */
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x01, 0, 1, 0, 9}, 6, (uint8_t[]) {7, 0x01, 2, 0xd2, 0x01}, 5),
+               "read coils");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x02, 0, 2, 0, 4}, 6, (uint8_t[]) {7, 0x02, 1, 0x03}, 4),
+               "read discrete inputs");
+
+    /* Writes are echoed */
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x06, 0, 3, 0xbe, 0xef}, 6, (uint8_t[]) {7, 0x06, 0, 3, 0xbe, 0xef}, 6),
+               "write single register");
+    TEST_CHECK((holding[3] == 0xbeef) && (written_address == 3) && (written_count == 1), "register not written");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x05, 0, 1, 0xff, 0}, 6, (uint8_t[]) {7, 0x05, 0, 1, 0xff, 0}, 6),
+               "write single coil");
+    TEST_CHECK(coils[0] == 0xa7, "coil not written: %02x", coils[0]);
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x10, 0, 5, 0, 2, 4, 0, 9, 0, 10}, 11,
+                      (uint8_t[]) {7, 0x10, 0, 5, 0, 2}, 6), "write multiple registers");
+    TEST_CHECK((holding[5] == 9) && (holding[6] == 10) && (written_address == 5) && (written_count == 2),
+               "registers not written");
+    /* Coils 6 to 9: 1 0 1 0 */
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x0f, 0, 6, 0, 4, 1, 0x05}, 8, (uint8_t[]) {7, 0x0f, 0, 6, 0, 4}, 6),
+               "write multiple coils");
+    TEST_CHECK((coils[0] == 0x67) && (coils[1] == 0x01), "coils not written: %02x %02x", coils[0], coils[1]);
+
+    /* Exceptions */
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x2b, 0, 0, 0, 1}, 6, (uint8_t[]) {7, 0xab, 1}, 3), "illegal function");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x03, 0, 7, 0, 2}, 6, (uint8_t[]) {7, 0x83, 2}, 3), "illegal address");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x03, 0, 0, 0, 0}, 6, (uint8_t[]) {7, 0x83, 3}, 3), "zero count");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x03, 0, 0, 0, 126}, 6, (uint8_t[]) {7, 0x83, 3}, 3), "count too large");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x05, 0, 1, 0x12, 0}, 6, (uint8_t[]) {7, 0x85, 3}, 3), "coil value");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x10, 0, 0, 0, 2, 3, 0, 1, 0}, 10, (uint8_t[]) {7, 0x90, 3}, 3),
+               "byte count");
+    TEST_CHECK(handle(slave, (uint8_t[]) {7, 0x03, 0, 0}, 4, (uint8_t[]) {7, 0x83, 3}, 3), "short request");
+
+    /* No answer: to another slave, a broadcast write is done, a broadcast read is ignored */
+    TEST_CHECK(handle(slave, (uint8_t[]) {8, 0x03, 0, 0, 0, 1}, 6, NULL, 0), "other slave");
+    TEST_CHECK(handle(slave, (uint8_t[]) {0, 0x06, 0, 0, 0, 42}, 6, NULL, 0) && (holding[0] == 42),
+               "broadcast write");
+    TEST_CHECK(handle(slave, (uint8_t[]) {0, 0x03, 0, 0, 0, 1}, 6, NULL, 0), "broadcast read");
+
+    uint8_t frame[MODBUS_RTU_FRAME_MAX] = {7, 0x03, 0, 0, 0, 1, 0, 0};
+    size_t resp_len = 1;
+    TEST_CHECK(modbus_rtu_slave_handle(slave, frame, 8, sizeof(frame), &resp_len) == MODBUS_RTU_ERR_CRC, "bad crc");
+    TEST_CHECK(resp_len == 0, "bad crc answered");
+
+    modbus_rtu_slave_stats_t stats;
+    modbus_rtu_slave_get_stats(slave, &stats);
+    TEST_CHECK((stats.exception_num == 7) && (stats.broadcast_num == 1) && (stats.ignored_num == 2) &&
+               (stats.crc_error_num == 1), "stats: %u exceptions, %u broadcasts, %u ignored, %u crc errors",
+               stats.exception_num, stats.broadcast_num, stats.ignored_num, stats.crc_error_num);
+
+    modbus_rtu_slave_del(slave);
+    return true;
+}
+
+static bool test_master_slave(void)
+{
+    static test_bus_t bus;
+    TEST_CHECK(start_bus(&bus, TEST_T35_US, 8, 1000, NULL), "no bus");
+    int ids[9] = {};
+    uint32_t result_nums[9] = {};
+
+    /* A read of each slave every 20 ms */
+    for (int slave = 1; slave <= 8; slave++) {
+        modbus_rtu_request_t request = {
+            .slave = slave,
+            .function = MODBUS_RTU_READ_HOLDING_REGISTERS,
+            .address = slave,
+            .count = 10,
+            .period_ms = 20,
+        };
+        TEST_CHECK(modbus_rtu_master_add(bus.master, &request, &ids[slave]) == MODBUS_RTU_OK, "add %d", slave);
+    }
+    /* Writes once, then a read of them */
+    uint16_t values[3] = {111, 222, 333};
+    modbus_rtu_request_t write = {
+        .slave = 3,
+        .function = MODBUS_RTU_WRITE_MULTIPLE_REGISTERS,
+        .address = 50,
+        .count = 3,
+        .values = values,
+    };
+    int write_id = 0;
+    TEST_CHECK(modbus_rtu_master_add(bus.master, &write, &write_id) == MODBUS_RTU_OK, "add write");
+    uint16_t coil_values[12] = {1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1};
+    modbus_rtu_request_t write_coils = {
+        .slave = MODBUS_RTU_ADDRESS_BROADCAST,
+        .function = MODBUS_RTU_WRITE_MULTIPLE_COILS,
+        .address = 4,
+        .count = 12,
+        .values = coil_values,
+    };
+    TEST_CHECK(modbus_rtu_master_add(bus.master, &write_coils, NULL) == MODBUS_RTU_OK, "add broadcast");
+    modbus_rtu_request_t bad = {
+        .slave = 2,
+        .function = MODBUS_RTU_READ_HOLDING_REGISTERS,
+        .address = TEST_REGISTER_NUM - 1,
+        .count = 2,
+    };
+    int bad_id = 0;
+    TEST_CHECK(modbus_rtu_master_add(bus.master, &bad, &bad_id) == MODBUS_RTU_OK, "add bad read");
+    bad.count = 0;
+    TEST_CHECK(modbus_rtu_master_add(bus.master, &bad, NULL) == MODBUS_RTU_ERR_INVALID, "read of 0 added");
+    bad.function = MODBUS_RTU_READ_COILS;
+    bad.slave = MODBUS_RTU_ADDRESS_BROADCAST;
+    bad.count = 1;
+    TEST_CHECK(modbus_rtu_master_add(bus.master, &bad, NULL) == MODBUS_RTU_ERR_INVALID, "broadcast read added");
+
+    bool is_written = false;
+    bool is_exception = false;
+    int64_t end_us = now_us() + 500000;
+    while (now_us() < end_us) {
+        const modbus_rtu_result_t *result = NULL;
+        if (modbus_rtu_master_take(bus.master, 100, &result) != MODBUS_RTU_OK) {
+            continue;
+        }
+        if (result->id == write_id) {
+            TEST_CHECK((result->status == MODBUS_RTU_OK) && (result->data == NULL), "write: %d", result->status);
+            is_written = true;
+        } else if (result->id == bad_id) {
+            TEST_CHECK((result->status == MODBUS_RTU_ERR_EXCEPTION) && (result->retry_num == 0) &&
+                       (result->exception == MODBUS_RTU_EX_ILLEGAL_DATA_ADDRESS), "bad read: %d, exception %d",
+                       result->status, result->exception);
+            is_exception = true;
+        } else if (result->slave != MODBUS_RTU_ADDRESS_BROADCAST) {
+            int slave = result->slave;
+            TEST_CHECK(result->id == ids[slave], "result of slave %d has id %d", slave, result->id);
+            TEST_CHECK((result->status == MODBUS_RTU_OK) && (result->data_len == 20), "slave %d: %d", slave,
+                       result->status);
+            for (int i = 0; i < 10; i++) {
+                TEST_CHECK(modbus_rtu_get_register(result->data, i) == slave * 1000 + slave + i,
+                           "register %d of slave %d", i, slave);
+            }
+            result_nums[slave]++;
+        }
+        modbus_rtu_master_release(bus.master, result);
+    }
+    TEST_CHECK(is_written && is_exception, "write or exception missing");
+
+    modbus_rtu_master_stats_t stats;
+    modbus_rtu_master_get_stats(bus.master, &stats);
+    stop_bus(&bus);
+    printf("%u requests, %u answers, %u exceptions, results of each slave:", stats.request_num, stats.response_num,
+           stats.exception_num);
+    for (int slave = 1; slave <= 8; slave++) {
+        printf(" %u", result_nums[slave]);
+        /* About 25 in 500 ms */
+        TEST_CHECK((result_nums[slave] >= 20) && (result_nums[slave] <= 27), "slave %d polled %u times", slave,
+                   result_nums[slave]);
+    }
+    printf("\n");
+    TEST_CHECK((bus.line.registers[3][50] == 111) && (bus.line.registers[3][52] == 333), "registers not written");
+    for (int slave = 1; slave <= TEST_SLAVE_MAX; slave++) {
+        /* Coils 4 to 15 */
+        TEST_CHECK((bus.line.coils[slave][0] == 0xd0) && (bus.line.coils[slave][1] == 0x90),
+                   "coils of slave %d: %02x %02x", slave, bus.line.coils[slave][0], bus.line.coils[slave][1]);
+    }
+    TEST_CHECK((stats.timeout_num == 0) && (stats.crc_error_num == 0) && (stats.frame_error_num == 0),
+               "errors on a clean line");
+    return true;
+}
+
+static bool test_retry(void)
+{
+    static test_bus_t bus;
+    const uint32_t offline_period_ms = 200;
+    const behavior_t behaviors[TEST_SLAVE_MAX + 1] = {
+        [9] = BEHAVIOR_DEAD,
+        [10] = BEHAVIOR_FLAKY,
+        [11] = BEHAVIOR_CORRUPT,
+    };
+    TEST_CHECK(start_bus(&bus, TEST_T35_US, 8, offline_period_ms, behaviors), "no bus");
+    uint32_t ok_nums[TEST_SLAVE_MAX + 1] = {};
+    uint32_t fail_nums[TEST_SLAVE_MAX + 1] = {};
+    uint32_t retried_nums[TEST_SLAVE_MAX + 1] = {};
+    bool is_first_failure = true;
+
+    for (int slave = 1; slave <= 11; slave += (slave == 1) ? 8 : 1) {
+        modbus_rtu_request_t request = {
+            .slave = slave,
+            .function = MODBUS_RTU_READ_HOLDING_REGISTERS,
+            .address = 0,
+            .count = 4,
+            .period_ms = (slave == 1) ? 20 : 100,
+            .retry_max = 2,
+        };
+        TEST_CHECK(modbus_rtu_master_add(bus.master, &request, NULL) == MODBUS_RTU_OK, "add %d", slave);
+    }
+
+    int64_t end_us = now_us() + 1000000;
+    while (now_us() < end_us) {
+        const modbus_rtu_result_t *result = NULL;
+        if (modbus_rtu_master_take(bus.master, 100, &result) != MODBUS_RTU_OK) {
+            continue;
+        }
+        int slave = result->slave;
+        if (result->status == MODBUS_RTU_OK) {
+            ok_nums[slave]++;
+            TEST_CHECK(modbus_rtu_get_register(result->data, 3) == slave * 1000 + 3, "data of slave %d", slave);
+        } else {
+            TEST_CHECK((slave == 9) && (result->status == MODBUS_RTU_ERR_TIMEOUT), "slave %d failed: %d", slave,
+                       result->status);
+            /* Tried again on the first failure, then once at a time while it's offline */
+            TEST_CHECK(result->retry_num == (is_first_failure ? 2 : 0), "%d retries", result->retry_num);
+            is_first_failure = false;
+            fail_nums[slave]++;
+        }
+        retried_nums[slave] += (result->retry_num > 0) ? 1 : 0;
+        modbus_rtu_master_release(bus.master, result);
+    }
+
+    modbus_rtu_master_stats_t stats;
+    modbus_rtu_master_get_stats(bus.master, &stats);
+    stop_bus(&bus);
+    printf("in 1 s: healthy %u, dead %u (failed), flaky %u (%u retried), corrupt %u (%u retried); "
+           "%u timeouts, %u crc errors\n", ok_nums[1], fail_nums[9], ok_nums[10], retried_nums[10], ok_nums[11],
+           retried_nums[11], stats.timeout_num, stats.crc_error_num);
+    /* The dead slave doesn't hold the line: the others are polled at their period */
+    TEST_CHECK(ok_nums[1] >= 40, "the healthy slave got %u results", ok_nums[1]);
+    TEST_CHECK((fail_nums[9] >= 4) && (fail_nums[9] <= 1000 / offline_period_ms + 1), "the dead slave got %u tries",
+               fail_nums[9]);
+    TEST_CHECK((ok_nums[10] >= 8) && (retried_nums[10] == ok_nums[10]), "flaky: %u, %u retried", ok_nums[10],
+               retried_nums[10]);
+    TEST_CHECK((ok_nums[11] >= 8) && (retried_nums[11] > 0) && (stats.crc_error_num == retried_nums[11]),
+               "corrupt: %u, %u retried", ok_nums[11], retried_nums[11]);
+    return true;
+}
+
+static bool test_ring(void)
+{
+    static test_bus_t bus;
+    TEST_CHECK(start_bus(&bus, TEST_T35_US, 2, 1000, NULL), "no bus");
+    int ids[3] = {};
+
+    for (int slave = 1; slave <= 2; slave++) {
+        modbus_rtu_request_t request = {
+            .slave = slave,
+            .function = MODBUS_RTU_READ_HOLDING_REGISTERS,
+            .count = 2,
+            .period_ms = 1,
+        };
+        TEST_CHECK(modbus_rtu_master_add(bus.master, &request, &ids[slave]) == MODBUS_RTU_OK, "add %d", slave);
+    }
+
+    /* The application holds a result while the line fills the other one, then waits */
+    const modbus_rtu_result_t *held = NULL;
+    TEST_CHECK(modbus_rtu_master_take(bus.master, 100, &held) == MODBUS_RTU_OK, "no result");
+    usleep(50000);
+    modbus_rtu_master_stats_t stats;
+    modbus_rtu_master_get_stats(bus.master, &stats);
+    uint32_t request_num = stats.request_num;
+    TEST_CHECK(stats.stall_num > 0, "the line didn't wait");
+    TEST_CHECK(request_num == 2, "%u requests sent with a full ring", request_num);
+    /* The held result is still intact */
+    TEST_CHECK((held->status == MODBUS_RTU_OK) &&
+               (modbus_rtu_get_register(held->data, 1) == held->slave * 1000 + 1), "held result changed");
+
+    /* Results come in order, the requests alternate */
+    int last_id = held->id;
+    modbus_rtu_master_release(bus.master, held);
+    for (int i = 0; i < 100; i++) {
+        const modbus_rtu_result_t *result = NULL;
+        TEST_CHECK(modbus_rtu_master_take(bus.master, 100, &result) == MODBUS_RTU_OK, "no result");
+        TEST_CHECK(result->id != last_id, "request %d polled twice in a row", result->id);
+        last_id = result->id;
+        modbus_rtu_master_release(bus.master, result);
+    }
+    TEST_CHECK(modbus_rtu_master_remove(bus.master, ids[1]) == MODBUS_RTU_OK, "remove");
+    TEST_CHECK(modbus_rtu_master_remove(bus.master, ids[1]) == MODBUS_RTU_ERR_INVALID, "removed twice");
+    /* At most one result of it was on the line */
+    int removed_num = 0;
+    for (int i = 0; i < 20; i++) {
+        const modbus_rtu_result_t *result = NULL;
+        TEST_CHECK(modbus_rtu_master_take(bus.master, 100, &result) == MODBUS_RTU_OK, "no result");
+        removed_num += (result->id == ids[1]) ? 1 : 0;
+        modbus_rtu_master_release(bus.master, result);
+    }
+    TEST_CHECK(removed_num <= 2, "%d results of a removed request", removed_num);
+
+    stop_bus(&bus);
+    return true;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static bool bench(uint32_t t35_us, int slave_num, const char *name)
+{
+    static test_bus_t bus;
+    static uint32_t latencies[200000];
+    size_t latency_num = 0;
+    TEST_CHECK(start_bus(&bus, t35_us, 8, 1000, NULL), "no bus");
+
+    /* 8 requests due at any time keep the line busy */
+    for (int i = 0; i < 8; i++) {
+        modbus_rtu_request_t request = {
+            .slave = 1 + i % slave_num,
+            .function = MODBUS_RTU_READ_HOLDING_REGISTERS,
+            .address = i,
+            .count = 10,
+            .period_ms = 1,
+        };
+        TEST_CHECK(modbus_rtu_master_add(bus.master, &request, NULL) == MODBUS_RTU_OK, "add %d", i);
+    }
+
+    int64_t start_us = now_us();
+    int64_t end_us = start_us + 1000000;
+    while (now_us() < end_us) {
+        const modbus_rtu_result_t *result = NULL;
+        if (modbus_rtu_master_take(bus.master, 100, &result) != MODBUS_RTU_OK) {
+            continue;
+        }
+        TEST_CHECK(result->status == MODBUS_RTU_OK, "slave %d: %d", result->slave, result->status);
+        if (latency_num < sizeof(latencies) / sizeof(latencies[0])) {
+            latencies[latency_num++] = result->latency_us;
+        }
+        modbus_rtu_master_release(bus.master, result);
+    }
+    double elapsed_s = (now_us() - start_us) / 1e6;
+    stop_bus(&bus);
+
+    TEST_CHECK(latency_num > 0, "no result");
+    qsort(latencies, latency_num, sizeof(latencies[0]), compare_u32);
+    printf("| %s | %d | %u | %.0f | %.0f | %u | %u |\n", name, slave_num, t35_us, latency_num / elapsed_s,
+           2 * latency_num / elapsed_s, latencies[latency_num / 2], latencies[latency_num * 99 / 100]);
+    /* A transaction takes at least T3.5 at each end */
+    TEST_CHECK(latencies[0] >= 2 * t35_us, "latency %u below 2 x T3.5", latencies[0]);
+    return true;
+}
+
+static bool test_bench(void)
+{
+    printf("| Timing | Slaves | T3.5 (us) | Transactions/s | Frames/s | Latency p50 (us) | Latency p99 (us) |\n");
+    return bench(1750, 1, "115200 baud") && bench(1750, 8, "115200 baud") && bench(100, 1, "short") &&
+           bench(100, 8, "short");
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"crc", test_crc},
+        {"slow_line", test_slow_line},
+        {"slave", test_slave},
+        {"master_slave", test_master_slave},
+        {"retry", test_retry},
+        {"ring", test_ring},
+        {"bench", test_bench},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -6,6 +6,7 @@
    software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
    CONDITIONS OF ANY KIND, either express or implied.
 */
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -17,6 +18,9 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "sdkconfig.h"
+#include "modbus_rtu_master.h"
+#include "modbus_rtu_slave.h"
+#include "modbus_rtu_uart.h"
 
 /**
  * This is a example which echos any data it receives on UART back to the sender using RS485 interface in half duplex mode.
@@ -123,8 +127,144 @@ static void echo_task(void *arg)
     vTaskDelete(NULL);
 }
 
+#if !CONFIG_ECHO_APP_MODE_ECHO
+#define MODBUS_REGISTER_NUM     (16)
+#define MODBUS_READ_NUM         (10)
+
+static modbus_rtu_port_t modbus_port_init(void)
+{
+    modbus_rtu_uart_config_t config = MODBUS_RTU_UART_DEFAULT_CONFIG();
+    config.uart_num = ECHO_UART_PORT;
+    config.baud_rate = BAUD_RATE;
+    config.tx_pin = ECHO_TEST_TXD;
+    config.rx_pin = ECHO_TEST_RXD;
+    config.rts_pin = ECHO_TEST_RTS;
+
+    modbus_rtu_port_t port;
+    if (modbus_rtu_uart_new(&config, &port) != MODBUS_RTU_OK) {
+        ESP_LOGE(TAG, "Modbus UART init failure.");
+        abort();
+    }
+    return port;
+}
+#endif
+
+#if CONFIG_ECHO_APP_MODE_MODBUS_SLAVE
+static uint16_t holding_registers[MODBUS_REGISTER_NUM];
+static uint16_t input_registers[MODBUS_REGISTER_NUM];
+
+static void on_write(uint8_t function, uint16_t address, uint16_t count, void *user_data)
+{
+    ESP_LOGI(TAG, "Function 0x%02x wrote %u values at %u", function, count, address);
+}
+
+// A slave answers in the frame it received, the UART task only waits for the next one
+static void modbus_slave_task(void *arg)
+{
+    modbus_rtu_slave_config_t config = {
+        .address = CONFIG_ECHO_MODBUS_SLAVE_ADDRESS,
+        .port = modbus_port_init(),
+        .holding_registers = holding_registers,
+        .holding_register_num = MODBUS_REGISTER_NUM,
+        .input_registers = input_registers,
+        .input_register_num = MODBUS_REGISTER_NUM,
+        .on_write = on_write,
+    };
+    modbus_rtu_slave_t *slave = NULL;
+    if (modbus_rtu_slave_new(&config, &slave) != MODBUS_RTU_OK) {
+        ESP_LOGE(TAG, "Modbus slave init failure.");
+        abort();
+    }
+    ESP_LOGI(TAG, "Modbus slave %d on UART%d.", CONFIG_ECHO_MODBUS_SLAVE_ADDRESS, ECHO_UART_PORT);
+
+    TickType_t last_tick = xTaskGetTickCount();
+    while (1) {
+        modbus_rtu_slave_poll(slave, 1000);
+
+        // The input registers count the seconds and the frames of the slave
+        if (xTaskGetTickCount() - last_tick >= pdMS_TO_TICKS(1000)) {
+            last_tick = xTaskGetTickCount();
+            modbus_rtu_slave_stats_t stats;
+            modbus_rtu_slave_get_stats(slave, &stats);
+            modbus_rtu_slave_lock(slave);
+            input_registers[0]++;
+            input_registers[1] = (uint16_t)stats.frame_num;
+            input_registers[2] = (uint16_t)stats.crc_error_num;
+            modbus_rtu_slave_unlock(slave);
+        }
+    }
+}
+#endif
+
+#if CONFIG_ECHO_APP_MODE_MODBUS_MASTER
+// A master polls the slaves from its own task, this one reads the results in place
+static void modbus_master_task(void *arg)
+{
+    modbus_rtu_master_config_t config = MODBUS_RTU_MASTER_DEFAULT_CONFIG();
+    config.port = modbus_port_init();
+    config.timeout_ms = CONFIG_ECHO_MODBUS_TIMEOUT_MS;
+    modbus_rtu_master_t *master = NULL;
+    if (modbus_rtu_master_new(&config, &master) != MODBUS_RTU_OK) {
+        ESP_LOGE(TAG, "Modbus master init failure.");
+        abort();
+    }
+
+    for (int slave = 1; slave <= CONFIG_ECHO_MODBUS_SLAVE_NUM; slave++) {
+        modbus_rtu_request_t request = {
+            .slave = slave,
+            .function = MODBUS_RTU_READ_HOLDING_REGISTERS,
+            .address = 0,
+            .count = MODBUS_READ_NUM,
+            .period_ms = CONFIG_ECHO_MODBUS_POLL_PERIOD_MS,
+            .retry_max = 2,
+        };
+        if (modbus_rtu_master_add(master, &request, NULL) != MODBUS_RTU_OK) {
+            ESP_LOGE(TAG, "Modbus request of slave %d failure.", slave);
+            abort();
+        }
+    }
+    ESP_LOGI(TAG, "Modbus master polls %d slaves on UART%d every %d ms.", CONFIG_ECHO_MODBUS_SLAVE_NUM,
+             ECHO_UART_PORT, CONFIG_ECHO_MODBUS_POLL_PERIOD_MS);
+
+    uint32_t result_num = 0;
+    uint32_t latency_max_us = 0;
+    TickType_t last_tick = xTaskGetTickCount();
+    while (1) {
+        const modbus_rtu_result_t *result = NULL;
+        if (modbus_rtu_master_take(master, 1000, &result) == MODBUS_RTU_OK) {
+            if (result->status == MODBUS_RTU_OK) {
+                result_num++;
+                latency_max_us = (result->latency_us > latency_max_us) ? result->latency_us : latency_max_us;
+                ESP_LOGD(TAG, "Slave %u: 0x%04x 0x%04x ...", result->slave, modbus_rtu_get_register(result->data, 0),
+                         modbus_rtu_get_register(result->data, 1));
+            } else {
+                ESP_LOGW(TAG, "Slave %u failed: %d, %u retries", result->slave, result->status, result->retry_num);
+            }
+            modbus_rtu_master_release(master, result);
+        }
+
+        if (xTaskGetTickCount() - last_tick >= pdMS_TO_TICKS(5000)) {
+            last_tick = xTaskGetTickCount();
+            modbus_rtu_master_stats_t stats;
+            modbus_rtu_master_get_stats(master, &stats);
+            ESP_LOGI(TAG, "%"PRIu32" results, max latency %"PRIu32" us; %"PRIu32" requests, %"PRIu32" timeouts, "
+                     "%"PRIu32" CRC errors, %"PRIu32" retries", result_num, latency_max_us, stats.request_num,
+                     stats.timeout_num, stats.crc_error_num, stats.retry_num);
+            result_num = 0;
+            latency_max_us = 0;
+        }
+    }
+}
+#endif
+
 void app_main(void)
 {
+#if CONFIG_ECHO_APP_MODE_MODBUS_SLAVE
+    xTaskCreate(modbus_slave_task, "modbus_slave_task", ECHO_TASK_STACK_SIZE, NULL, ECHO_TASK_PRIO, NULL);
+#elif CONFIG_ECHO_APP_MODE_MODBUS_MASTER
+    xTaskCreate(modbus_master_task, "modbus_master_task", ECHO_TASK_STACK_SIZE, NULL, ECHO_TASK_PRIO, NULL);
+#else
     //A uart read/write example without event queue;
     xTaskCreate(echo_task, "uart_echo_task", ECHO_TASK_STACK_SIZE, NULL, ECHO_TASK_PRIO, NULL);
+#endif
 }
@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bulk transfer of a payload, e.g. a firmware or a log dump, on a half duplex RS485 line. The sender cuts it into
+ * chunks, each in a frame with a CRC32, and sends a window of frames at once: the last one asks for an ACK, the
+ * line is turned around, and the receiver answers the offset it has received up to. The sender goes on from this
+ * offset, so a lost or corrupted frame is sent again with the frames after it.
+ *
+ * A frame is a sync word, a header, the payload and the CRC32 of the header and the payload, all little endian:
+ *
+ *     | 0xa5 0x5a | type | flags | transfer (2) | poll (2) | offset (4) | length (2) | payload | CRC32 (4) |
+ */
+
+#define RS485_BULK_OK                   (0)
+#define RS485_BULK_ERR_INVALID          (-1)
+#define RS485_BULK_ERR_NO_MEM           (-2)
+#define RS485_BULK_ERR_PORT             (-3)
+#define RS485_BULK_ERR_TIMEOUT          (-4)    /*!< No frame, or no progress after the retries */
+#define RS485_BULK_ERR_CRC              (-5)    /*!< The CRC32 of the whole payload is wrong */
+#define RS485_BULK_ERR_OVERFLOW         (-6)    /*!< The port dropped received bytes */
+#define RS485_BULK_ERR_ABORTED          (-7)    /*!< The receiver refused the payload */
+
+#define RS485_BULK_HEADER_LEN           (14)
+#define RS485_BULK_CRC_LEN              (4)
+#define RS485_BULK_CHUNK_MAX            (4096)
+#define RS485_BULK_FRAME_MAX            (RS485_BULK_HEADER_LEN + RS485_BULK_CHUNK_MAX + RS485_BULK_CRC_LEN)
+
+/**
+ * @brief The serial line of a sender or a receiver, used by one task at a time.
+ */
+typedef struct {
+    /**
+     * @brief Queue bytes to send, wait while the TX buffer is full.
+     *
+     * @return RS485_BULK_OK or RS485_BULK_ERR_PORT
+     */
+    int (*write)(void *ctx, const uint8_t *data, size_t len);
+    /**
+     * @brief Wait until the bytes queued are sent, so the line can be turned around.
+     *
+     * @return RS485_BULK_OK or RS485_BULK_ERR_PORT
+     */
+    int (*flush)(void *ctx);
+    /**
+     * @brief Read the bytes received: wait up to `timeout_ms` for the first one, then take what's there.
+     *
+     * @return RS485_BULK_OK, RS485_BULK_ERR_TIMEOUT without a byte, RS485_BULK_ERR_OVERFLOW if bytes were dropped
+     *         since the last read, or RS485_BULK_ERR_PORT
+     */
+    int (*read)(void *ctx, uint8_t *data, size_t size, uint32_t timeout_ms, size_t *len);
+    /**
+     * @brief Get the bytes queued and not sent yet. Can be NULL, then the underruns are not counted.
+     */
+    size_t (*tx_pending)(void *ctx);
+    void *ctx;
+} rs485_bulk_port_t;
+
+/**
+ * @brief Write a chunk of the payload received, in order.
+ *
+ * @return true to go on, false to abort the transfer
+ */
+typedef bool (*rs485_bulk_write_cb_t)(uint32_t offset, const uint8_t *data, size_t len, void *user_data);
+
+typedef struct {
+    rs485_bulk_port_t port;
+    uint16_t chunk_size;            /*!< The payload of a frame sent, 1 to RS485_BULK_CHUNK_MAX */
+    uint8_t window;                 /*!< The frames sent before an ACK is asked */
+    uint32_t ack_timeout_ms;        /*!< The time from the last bit of a window to its ACK. The same on both ends */
+    uint8_t retry_max;              /*!< The windows sent again without progress before a transfer fails */
+    uint32_t turnaround_us;         /*!< The time the other end takes to release the line after its last bit */
+} rs485_bulk_config_t;
+
+#define RS485_BULK_DEFAULT_CONFIG()     \
+    {                                   \
+        .chunk_size = 1024,             \
+        .window = 8,                    \
+        .ack_timeout_ms = 100,          \
+        .retry_max = 5,                 \
+        .turnaround_us = 100,           \
+    }
+
+typedef struct {
+    uint64_t tx_byte_num;           /*!< The bytes of the frames sent, with the retransmissions */
+    uint64_t rx_byte_num;           /*!< The bytes read from the line */
+    uint64_t payload_byte_num;      /*!< The bytes of the payloads acknowledged, or written by the receiver */
+    uint32_t tx_frame_num;
+    uint32_t rx_frame_num;          /*!< The frames received with a right CRC */
+    uint32_t retransmit_num;        /*!< The data frames sent again */
+    uint32_t ack_timeout_num;       /*!< The windows without an ACK in time */
+    uint32_t crc_error_num;         /*!< The frames dropped for their CRC */
+    uint32_t out_of_order_num;      /*!< The data frames dropped by the receiver, after a lost one */
+    uint32_t skipped_byte_num;      /*!< The bytes dropped to find the start of a frame */
+    uint32_t overflow_num;          /*!< The times the port dropped received bytes: RX FIFO or buffer full */
+    uint32_t underrun_num;          /*!< The times the TX buffer ran empty inside a window, the line idled in it */
+} rs485_bulk_stats_t;
+
+typedef struct rs485_bulk_t rs485_bulk_t;
+
+/**
+ * @brief Compute the CRC32 of IEEE 802.3, by a table.
+ *
+ * @param crc The CRC of the bytes before, 0 for the first ones
+ * @param data The bytes
+ * @param len The length of the bytes
+ *
+ * @return The CRC
+ */
+uint32_t rs485_bulk_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Create the end of a line, to send or receive payloads.
+ *
+ * @param config The configuration
+ * @param ret_bulk The end of the line
+ *
+ * @return RS485_BULK_OK, RS485_BULK_ERR_INVALID or RS485_BULK_ERR_NO_MEM
+ */
+int rs485_bulk_new(const rs485_bulk_config_t *config, rs485_bulk_t **ret_bulk);
+
+/**
+ * @brief Delete the end of a line, the port is not deleted.
+ *
+ * @param bulk The end of the line, can be NULL
+ */
+void rs485_bulk_del(rs485_bulk_t *bulk);
+
+/**
+ * @brief Send a payload, and return when the receiver has it all.
+ *
+ * @param bulk The end of the line
+ * @param data The payload, sent in place: it must not change until the function returns
+ * @param len The length of the payload, can be 0
+ *
+ * @return RS485_BULK_OK, RS485_BULK_ERR_TIMEOUT if the receiver doesn't answer or the payload doesn't progress,
+ *         RS485_BULK_ERR_CRC, RS485_BULK_ERR_ABORTED, or RS485_BULK_ERR_PORT
+ */
+int rs485_bulk_send(rs485_bulk_t *bulk, const void *data, size_t len);
+
+/**
+ * @brief Receive a payload: wait for a sender to start one, and write it chunk by chunk, in order. The end is
+ *        answered to the sender, and answered again until the line is silent for 2 ACK timeouts, in case the answer
+ *        was lost.
+ *
+ * @param bulk The end of the line
+ * @param timeout_ms The time to wait for a transfer to start
+ * @param write The function writing the chunks
+ * @param user_data The argument of `write`
+ * @param ret_len The length of the payload, can be NULL
+ *
+ * @return RS485_BULK_OK, RS485_BULK_ERR_TIMEOUT if no transfer starts or the sender stops in it,
+ *         RS485_BULK_ERR_CRC, RS485_BULK_ERR_ABORTED if `write` returned false, or RS485_BULK_ERR_PORT
+ */
+int rs485_bulk_recv(rs485_bulk_t *bulk, uint32_t timeout_ms, rs485_bulk_write_cb_t write, void *user_data,
+                    uint32_t *ret_len);
+
+/**
+ * @brief Get the statistics since the end of the line was created, from any task.
+ *
+ * @param bulk The end of the line
+ * @param stats The statistics
+ */
+void rs485_bulk_get_stats(rs485_bulk_t *bulk, rs485_bulk_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
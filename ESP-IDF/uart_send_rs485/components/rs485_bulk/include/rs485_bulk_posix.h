@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "rs485_bulk.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The line of a host, on a file descriptor: a serial port, or a pty to test the sender and the receiver against each
+ * other. The TX queue of the file descriptor is not seen, so the underruns are not counted.
+ */
+
+typedef struct {
+    int fd;                     /*!< Opened and set raw by the application, it's not closed */
+} rs485_bulk_posix_config_t;
+
+/**
+ * @brief Create the port of a file descriptor.
+ *
+ * @param config The configuration
+ * @param ret_port The port
+ *
+ * @return RS485_BULK_OK, RS485_BULK_ERR_INVALID or RS485_BULK_ERR_NO_MEM
+ */
+int rs485_bulk_posix_new(const rs485_bulk_posix_config_t *config, rs485_bulk_port_t *ret_port);
+
+/**
+ * @brief Delete the port of a file descriptor.
+ *
+ * @param port The port
+ */
+void rs485_bulk_posix_del(rs485_bulk_port_t *port);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "driver/uart.h"
+#include "rs485_bulk.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The line of the target, on a UART in RS485 half duplex mode. The driver has large ring buffers: a window of
+ * frames is queued at once and sent by the interrupts while the task goes on, and the frames received wait in the
+ * RX ring while the task handles the one before. The FIFO thresholds leave room for the interrupt latency at a high
+ * baud rate, so the RX FIFO doesn't overflow and the TX FIFO doesn't run empty in a frame.
+ */
+
+typedef struct {
+    uart_port_t uart_num;
+    uint32_t baud_rate;
+    int tx_pin;
+    int rx_pin;
+    int rts_pin;                /*!< Drives DE/~RE of the transceiver, UART_PIN_NO_CHANGE if it switches alone */
+    int rx_buf_size;            /*!< The RX ring buffer of the driver, a few frames */
+    int tx_buf_size;            /*!< The TX ring buffer of the driver, a window of frames */
+    int rx_full_thresh;         /*!< The bytes in the RX FIFO which wake the driver up */
+    int tx_empty_thresh;        /*!< The bytes left in the TX FIFO when the driver fills it again */
+    int rx_timeout;             /*!< The silence, in characters, after which the bytes in the RX FIFO are read */
+} rs485_bulk_uart_config_t;
+
+#define RS485_BULK_UART_DEFAULT_CONFIG()    \
+    {                                       \
+        .uart_num = UART_NUM_1,             \
+        .baud_rate = 115200,                \
+        .tx_pin = UART_PIN_NO_CHANGE,       \
+        .rx_pin = UART_PIN_NO_CHANGE,       \
+        .rts_pin = UART_PIN_NO_CHANGE,      \
+        .rx_buf_size = 16 * 1024,           \
+        .tx_buf_size = 16 * 1024,           \
+        .rx_full_thresh = 64,               \
+        .tx_empty_thresh = 32,              \
+        .rx_timeout = 2,                    \
+    }
+
+/**
+ * @brief Install the driver of a UART and create its port.
+ *
+ * @param config The configuration
+ * @param ret_port The port
+ *
+ * @return RS485_BULK_OK, RS485_BULK_ERR_INVALID, RS485_BULK_ERR_NO_MEM or RS485_BULK_ERR_PORT
+ */
+int rs485_bulk_uart_new(const rs485_bulk_uart_config_t *config, rs485_bulk_port_t *ret_port);
+
+/**
+ * @brief Delete the port of a UART and its driver.
+ *
+ * @param port The port
+ */
+void rs485_bulk_uart_del(rs485_bulk_port_t *port);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,525 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rs485_bulk.h"
+
+#define SYNC_0                  (0xa5)
+#define SYNC_1                  (0x5a)
+
+#define FRAME_START             (1)     /* The length and the CRC32 of the payload */
+#define FRAME_DATA              (2)     /* A chunk of the payload at its offset */
+#define FRAME_ACK               (3)     /* The offset received up to, answers a poll */
+
+#define FLAG_ACK_REQ            (1 << 0)    /* Start or data: answer an ACK after it */
+#define FLAG_DONE               (1 << 1)    /* ACK: the payload is received, its CRC32 is right */
+#define FLAG_CRC_ERR            (1 << 2)    /* ACK: the payload is received, its CRC32 is wrong */
+#define FLAG_ABORT              (1 << 3)    /* ACK: the receiver refused the payload */
+
+#define START_LEN               (8)
+/* The frame being parsed and the next one, read at once */
+#define RX_BUF_SIZE             (2 * RS485_BULK_FRAME_MAX)
+
+#define STATS_ADD(bulk, field, n)   do {        \
+        pthread_mutex_lock(&(bulk)->lock);      \
+        (bulk)->stats.field += (n);             \
+        pthread_mutex_unlock(&(bulk)->lock);    \
+    } while (0)
+
+typedef struct {
+    uint8_t type;
+    uint8_t flags;
+    uint16_t transfer;
+    uint16_t poll;
+    uint32_t offset;
+    uint16_t len;
+    const uint8_t *payload;     /* In the RX buffer, until the next frame is read */
+    size_t frame_len;
+} frame_t;
+
+struct rs485_bulk_t {
+    rs485_bulk_config_t config;
+    pthread_mutex_t lock;       /* For the stats, the rest is used by one task */
+    rs485_bulk_stats_t stats;
+    uint16_t transfer;          /* The last transfer sent */
+    uint8_t *tx_frame;
+    uint8_t *rx_buf;
+    size_t rx_start;
+    size_t rx_end;
+    int64_t last_rx_us;         /* The time bytes were last read, the other end turns the line around from it */
+};
+
+/* The CRC of each byte, for the reflected polynomial 0xedb88320 */
+static const uint32_t crc_table[256] = {
+    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
+    0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
+    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
+    0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
+    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
+    0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
+    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
+    0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
+    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
+    0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
+    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
+    0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
+    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
+    0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
+    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
+    0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
+    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
+    0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
+    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
+    0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
+    0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
+    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
+    0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
+    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
+    0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
+    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
+    0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
+    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
+    0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
+    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
+    0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
+    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
+    0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
+    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
+    0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
+    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
+    0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
+    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
+    0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
+    0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
+    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
+};
+
+uint32_t rs485_bulk_crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ crc_table[(crc ^ data[i]) & 0xff];
+    }
+
+    return ~crc;
+}
+
+static inline uint16_t get_u16(const uint8_t *data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static inline void put_u16(uint8_t *data, uint16_t value)
+{
+    data[0] = value & 0xff;
+    data[1] = value >> 8;
+}
+
+static inline void put_u32(uint8_t *data, uint32_t value)
+{
+    put_u16(data, value & 0xffff);
+    put_u16(&data[2], value >> 16);
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Let the other end release the line after the bytes it sent */
+static void wait_turnaround(rs485_bulk_t *bulk)
+{
+    int64_t wait_us = bulk->last_rx_us + bulk->config.turnaround_us - now_us();
+    if (wait_us > 0) {
+        struct timespec ts = {
+            .tv_sec = wait_us / 1000000,
+            .tv_nsec = (wait_us % 1000000) * 1000,
+        };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static int write_frame(rs485_bulk_t *bulk, uint8_t type, uint8_t flags, uint16_t transfer, uint16_t poll,
+                       uint32_t offset, const uint8_t *payload, uint16_t len)
+{
+    uint8_t *frame = bulk->tx_frame;
+
+    frame[0] = SYNC_0;
+    frame[1] = SYNC_1;
+    frame[2] = type;
+    frame[3] = flags;
+    put_u16(&frame[4], transfer);
+    put_u16(&frame[6], poll);
+    put_u32(&frame[8], offset);
+    put_u16(&frame[12], len);
+    if (len > 0) {
+        memcpy(&frame[RS485_BULK_HEADER_LEN], payload, len);
+    }
+    /* The sync word is left out, a frame is found by it */
+    put_u32(&frame[RS485_BULK_HEADER_LEN + len], rs485_bulk_crc32(0, &frame[2], RS485_BULK_HEADER_LEN - 2 + len));
+    size_t frame_len = RS485_BULK_HEADER_LEN + len + RS485_BULK_CRC_LEN;
+
+    int ret = bulk->config.port.write(bulk->config.port.ctx, frame, frame_len);
+    if (ret != RS485_BULK_OK) {
+        return ret;
+    }
+    pthread_mutex_lock(&bulk->lock);
+    bulk->stats.tx_frame_num++;
+    bulk->stats.tx_byte_num += frame_len;
+    pthread_mutex_unlock(&bulk->lock);
+
+    return RS485_BULK_OK;
+}
+
+/* Parse the next frame in the RX buffer, and read the line until there's one or the deadline passes */
+static int read_frame(rs485_bulk_t *bulk, int64_t deadline_us, frame_t *frame)
+{
+    while (true) {
+        uint8_t *data = &bulk->rx_buf[bulk->rx_start];
+        size_t avail = bulk->rx_end - bulk->rx_start;
+
+        /* Skip to the sync word, a first byte of it at the end is kept */
+        size_t skip = 0;
+        while ((skip + 1 < avail) && !((data[skip] == SYNC_0) && (data[skip + 1] == SYNC_1))) {
+            skip++;
+        }
+        if ((skip + 1 == avail) && (data[skip] != SYNC_0)) {
+            skip++;
+        }
+        if (skip > 0) {
+            bulk->rx_start += skip;
+            STATS_ADD(bulk, skipped_byte_num, skip);
+            continue;
+        }
+
+        if (avail >= RS485_BULK_HEADER_LEN) {
+            uint8_t type = data[2];
+            uint16_t len = get_u16(&data[12]);
+            if ((type < FRAME_START) || (type > FRAME_ACK) || (len > RS485_BULK_CHUNK_MAX)) {
+                /* Not a header, the sync word was in the bytes of a frame */
+                bulk->rx_start++;
+                STATS_ADD(bulk, skipped_byte_num, 1);
+                continue;
+            }
+            size_t frame_len = RS485_BULK_HEADER_LEN + len + RS485_BULK_CRC_LEN;
+            if (avail >= frame_len) {
+                uint32_t crc = rs485_bulk_crc32(0, &data[2], RS485_BULK_HEADER_LEN - 2 + len);
+                if (crc != get_u32(&data[RS485_BULK_HEADER_LEN + len])) {
+                    /* Look for the next frame in it */
+                    bulk->rx_start++;
+                    STATS_ADD(bulk, crc_error_num, 1);
+                    continue;
+                }
+                frame->type = type;
+                frame->flags = data[3];
+                frame->transfer = get_u16(&data[4]);
+                frame->poll = get_u16(&data[6]);
+                frame->offset = get_u32(&data[8]);
+                frame->len = len;
+                frame->payload = &data[RS485_BULK_HEADER_LEN];
+                frame->frame_len = frame_len;
+                bulk->rx_start += frame_len;
+                STATS_ADD(bulk, rx_frame_num, 1);
+                return RS485_BULK_OK;
+            }
+        }
+
+        /* Read the rest of the frame after its start */
+        if (bulk->rx_start > 0) {
+            memmove(bulk->rx_buf, data, avail);
+            bulk->rx_start = 0;
+            bulk->rx_end = avail;
+        }
+        int64_t wait_us = deadline_us - now_us();
+        if (wait_us <= 0) {
+            return RS485_BULK_ERR_TIMEOUT;
+        }
+        size_t len = 0;
+        int ret = bulk->config.port.read(bulk->config.port.ctx, &bulk->rx_buf[bulk->rx_end], RX_BUF_SIZE - bulk->rx_end,
+                                         (uint32_t)((wait_us + 999) / 1000), &len);
+        if (ret == RS485_BULK_ERR_OVERFLOW) {
+            /* The frame being read lost bytes */
+            bulk->rx_start = 0;
+            bulk->rx_end = 0;
+            STATS_ADD(bulk, overflow_num, 1);
+            continue;
+        }
+        if (ret != RS485_BULK_OK) {
+            return ret;
+        }
+        bulk->rx_end += len;
+        bulk->last_rx_us = now_us();
+        STATS_ADD(bulk, rx_byte_num, len);
+    }
+}
+
+/* Put the frame just read back, for the next read */
+static void unread_frame(rs485_bulk_t *bulk, const frame_t *frame)
+{
+    bulk->rx_start -= frame->frame_len;
+    pthread_mutex_lock(&bulk->lock);
+    bulk->stats.rx_frame_num--;
+    pthread_mutex_unlock(&bulk->lock);
+}
+
+/* Wait for the ACK of a poll, the frames of other polls are late or stray */
+static int wait_ack(rs485_bulk_t *bulk, uint16_t transfer, uint16_t poll, frame_t *ack)
+{
+    int64_t deadline_us = now_us() + (int64_t)bulk->config.ack_timeout_ms * 1000;
+
+    while (true) {
+        int ret = read_frame(bulk, deadline_us, ack);
+        if (ret != RS485_BULK_OK) {
+            return ret;
+        }
+        if ((ack->type == FRAME_ACK) && (ack->transfer == transfer) && (ack->poll == poll)) {
+            return RS485_BULK_OK;
+        }
+    }
+}
+
+int rs485_bulk_new(const rs485_bulk_config_t *config, rs485_bulk_t **ret_bulk)
+{
+    if ((config == NULL) || (ret_bulk == NULL) || (config->port.write == NULL) || (config->port.flush == NULL) ||
+            (config->port.read == NULL) || (config->chunk_size == 0) ||
+            (config->chunk_size > RS485_BULK_CHUNK_MAX) || (config->window == 0) || (config->ack_timeout_ms == 0)) {
+        return RS485_BULK_ERR_INVALID;
+    }
+
+    rs485_bulk_t *bulk = calloc(1, sizeof(rs485_bulk_t));
+    if (bulk == NULL) {
+        return RS485_BULK_ERR_NO_MEM;
+    }
+    bulk->config = *config;
+    size_t payload_max = (config->chunk_size > START_LEN) ? config->chunk_size : START_LEN;
+    bulk->tx_frame = malloc(RS485_BULK_HEADER_LEN + payload_max + RS485_BULK_CRC_LEN);
+    bulk->rx_buf = malloc(RX_BUF_SIZE);
+    if ((bulk->tx_frame == NULL) || (bulk->rx_buf == NULL)) {
+        free(bulk->rx_buf);
+        free(bulk->tx_frame);
+        free(bulk);
+        return RS485_BULK_ERR_NO_MEM;
+    }
+    /* Another transfer than the one of a sender which was restarted */
+    bulk->transfer = (uint16_t)now_us();
+    pthread_mutex_init(&bulk->lock, NULL);
+
+    *ret_bulk = bulk;
+    return RS485_BULK_OK;
+}
+
+void rs485_bulk_del(rs485_bulk_t *bulk)
+{
+    if (bulk == NULL) {
+        return;
+    }
+
+    pthread_mutex_destroy(&bulk->lock);
+    free(bulk->rx_buf);
+    free(bulk->tx_frame);
+    free(bulk);
+}
+
+/* Send the window of frames from `base`, the last one polls the receiver */
+static int send_window(rs485_bulk_t *bulk, const uint8_t *payload, uint32_t total, uint16_t transfer, uint16_t poll,
+                       uint32_t base, uint32_t *sent_end)
+{
+    const rs485_bulk_port_t *port = &bulk->config.port;
+    uint32_t offset = base;
+
+    for (int i = 0; (i < bulk->config.window) && (offset < total); i++) {
+        uint16_t len = (total - offset < bulk->config.chunk_size) ? (uint16_t)(total - offset) :
+                       bulk->config.chunk_size;
+        bool is_last = (i == bulk->config.window - 1) || (offset + len == total);
+        /* The frames of a window are queued while the ones before are sent: the line idles if it ran empty */
+        if ((i > 0) && (port->tx_pending != NULL) && (port->tx_pending(port->ctx) == 0)) {
+            STATS_ADD(bulk, underrun_num, 1);
+        }
+        int ret = write_frame(bulk, FRAME_DATA, is_last ? FLAG_ACK_REQ : 0, transfer, poll, offset, &payload[offset],
+                              len);
+        if (ret != RS485_BULK_OK) {
+            return ret;
+        }
+        if (offset < *sent_end) {
+            STATS_ADD(bulk, retransmit_num, 1);
+        }
+        offset += len;
+    }
+    *sent_end = (offset > *sent_end) ? offset : *sent_end;
+
+    return RS485_BULK_OK;
+}
+
+int rs485_bulk_send(rs485_bulk_t *bulk, const void *data, size_t len)
+{
+    if ((bulk == NULL) || ((data == NULL) && (len > 0)) || (len > UINT32_MAX)) {
+        return RS485_BULK_ERR_INVALID;
+    }
+
+    const uint8_t *payload = (const uint8_t *)data;
+    uint32_t total = (uint32_t)len;
+    uint16_t transfer = ++bulk->transfer;
+    uint16_t poll = 0;
+    uint8_t start[START_LEN];
+    put_u32(&start[0], total);
+    put_u32(&start[4], rs485_bulk_crc32(0, payload, len));
+
+    bool is_started = false;
+    uint32_t base = 0;          /* Received up to, by the ACKs */
+    uint32_t sent_end = 0;      /* Sent up to once, the frames before are sent again */
+    int retry_num = 0;
+    while (true) {
+        poll++;
+        wait_turnaround(bulk);
+        int ret = is_started ? send_window(bulk, payload, total, transfer, poll, base, &sent_end) :
+                  write_frame(bulk, FRAME_START, FLAG_ACK_REQ, transfer, poll, 0, start, START_LEN);
+        if ((ret != RS485_BULK_OK) || (bulk->config.port.flush(bulk->config.port.ctx) != RS485_BULK_OK)) {
+            return RS485_BULK_ERR_PORT;
+        }
+
+        /* The ACK is timed from the last bit of the window */
+        frame_t ack;
+        ret = wait_ack(bulk, transfer, poll, &ack);
+        if (ret == RS485_BULK_ERR_TIMEOUT) {
+            STATS_ADD(bulk, ack_timeout_num, 1);
+            if (++retry_num > bulk->config.retry_max) {
+                return RS485_BULK_ERR_TIMEOUT;
+            }
+            continue;
+        }
+        if (ret != RS485_BULK_OK) {
+            return ret;
+        }
+        if (ack.flags & FLAG_ABORT) {
+            return RS485_BULK_ERR_ABORTED;
+        }
+        if (ack.flags & FLAG_CRC_ERR) {
+            return RS485_BULK_ERR_CRC;
+        }
+
+        if (!is_started) {
+            is_started = true;
+            retry_num = 0;
+        } else if ((ack.offset > base) && (ack.offset <= total)) {
+            STATS_ADD(bulk, payload_byte_num, ack.offset - base);
+            base = ack.offset;
+            retry_num = 0;
+        } else if (++retry_num > bulk->config.retry_max) {
+            /* The frames after `base` are lost again and again */
+            return RS485_BULK_ERR_TIMEOUT;
+        }
+        if (ack.flags & FLAG_DONE) {
+            return RS485_BULK_OK;
+        }
+    }
+}
+
+int rs485_bulk_recv(rs485_bulk_t *bulk, uint32_t timeout_ms, rs485_bulk_write_cb_t write, void *user_data,
+                    uint32_t *ret_len)
+{
+    if ((bulk == NULL) || (write == NULL)) {
+        return RS485_BULK_ERR_INVALID;
+    }
+
+    /* Wait for a transfer to start, the frames before it are dropped */
+    frame_t frame;
+    int64_t deadline_us = now_us() + (int64_t)timeout_ms * 1000;
+    do {
+        int ret = read_frame(bulk, deadline_us, &frame);
+        if (ret != RS485_BULK_OK) {
+            return ret;
+        }
+    } while ((frame.type != FRAME_START) || (frame.len != START_LEN));
+
+    uint16_t transfer = frame.transfer;
+    uint32_t total = get_u32(&frame.payload[0]);
+    uint32_t expected_crc = get_u32(&frame.payload[4]);
+    uint32_t crc = 0;
+    uint32_t offset = 0;        /* Received up to, in order */
+    int status = RS485_BULK_OK;
+    bool is_end = (total == 0);
+    bool is_answered = false;   /* The end is sent in an ACK */
+    /* The sender gives up after its retries, its last window answered stays answered while it's sent again */
+    const int64_t silence_us = (int64_t)(bulk->config.retry_max + 2) * bulk->config.ack_timeout_ms * 1000;
+    const int64_t linger_us = (int64_t)2 * bulk->config.ack_timeout_ms * 1000;
+
+    while (true) {
+        if (frame.transfer != transfer) {
+            /* The sender started another transfer */
+            unread_frame(bulk, &frame);
+            if (!is_answered) {
+                return RS485_BULK_ERR_TIMEOUT;
+            }
+            break;
+        }
+        if ((frame.type == FRAME_DATA) && !is_end) {
+            if ((frame.offset == offset) && (frame.len > 0) && (frame.len <= total - offset)) {
+                if (!write(offset, frame.payload, frame.len, user_data)) {
+                    status = RS485_BULK_ERR_ABORTED;
+                    is_end = true;
+                } else {
+                    crc = rs485_bulk_crc32(crc, frame.payload, frame.len);
+                    offset += frame.len;
+                    STATS_ADD(bulk, payload_byte_num, frame.len);
+                    if (offset == total) {
+                        status = (crc == expected_crc) ? RS485_BULK_OK : RS485_BULK_ERR_CRC;
+                        is_end = true;
+                    }
+                }
+            } else if (frame.offset > offset) {
+                STATS_ADD(bulk, out_of_order_num, 1);
+            }
+        }
+        if ((frame.type != FRAME_ACK) && (frame.flags & FLAG_ACK_REQ)) {
+            uint8_t flags = 0;
+            if (is_end) {
+                flags = (status == RS485_BULK_ERR_ABORTED) ? FLAG_ABORT :
+                        ((status == RS485_BULK_ERR_CRC) ? FLAG_CRC_ERR : FLAG_DONE);
+            }
+            wait_turnaround(bulk);
+            if ((write_frame(bulk, FRAME_ACK, flags, transfer, frame.poll, offset, NULL, 0) != RS485_BULK_OK) ||
+                    (bulk->config.port.flush(bulk->config.port.ctx) != RS485_BULK_OK)) {
+                return RS485_BULK_ERR_PORT;
+            }
+            is_answered = is_end;
+        }
+
+        int ret = read_frame(bulk, now_us() + (is_answered ? linger_us : silence_us), &frame);
+        if (ret == RS485_BULK_ERR_TIMEOUT) {
+            if (!is_answered) {
+                return RS485_BULK_ERR_TIMEOUT;
+            }
+            break;
+        }
+        if (ret != RS485_BULK_OK) {
+            return ret;
+        }
+    }
+
+    if (ret_len != NULL) {
+        *ret_len = offset;
+    }
+    return status;
+}
+
+void rs485_bulk_get_stats(rs485_bulk_t *bulk, rs485_bulk_stats_t *stats)
+{
+    pthread_mutex_lock(&bulk->lock);
+    *stats = bulk->stats;
+    pthread_mutex_unlock(&bulk->lock);
+}
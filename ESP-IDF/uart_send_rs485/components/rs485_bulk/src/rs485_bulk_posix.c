@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include "rs485_bulk_posix.h"
+
+typedef struct {
+    int fd;
+} posix_port_t;
+
+static int posix_write(void *ctx, const uint8_t *data, size_t len)
+{
+    posix_port_t *port = (posix_port_t *)ctx;
+    size_t offset = 0;
+
+    while (offset < len) {
+        ssize_t ret = write(port->fd, &data[offset], len - offset);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return RS485_BULK_ERR_PORT;
+        }
+        offset += ret;
+    }
+
+    return RS485_BULK_OK;
+}
+
+static int posix_flush(void *ctx)
+{
+    posix_port_t *port = (posix_port_t *)ctx;
+
+    return ((tcdrain(port->fd) == 0) || (errno == ENOTTY)) ? RS485_BULK_OK : RS485_BULK_ERR_PORT;
+}
+
+static int posix_read(void *ctx, uint8_t *data, size_t size, uint32_t timeout_ms, size_t *len)
+{
+    posix_port_t *port = (posix_port_t *)ctx;
+
+    *len = 0;
+    while (true) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(port->fd, &read_fds);
+        struct timeval timeout = {
+            .tv_sec = timeout_ms / 1000,
+            .tv_usec = (timeout_ms % 1000) * 1000,
+        };
+        int ret = select(port->fd + 1, &read_fds, NULL, NULL, &timeout);
+        if (ret == 0) {
+            return RS485_BULK_ERR_TIMEOUT;
+        }
+        if (ret > 0) {
+            ssize_t read_len = read(port->fd, data, size);
+            if (read_len > 0) {
+                *len = read_len;
+                return RS485_BULK_OK;
+            }
+            if (read_len == 0) {
+                return RS485_BULK_ERR_PORT;
+            }
+        }
+        if ((errno != EINTR) && (errno != EAGAIN)) {
+            return RS485_BULK_ERR_PORT;
+        }
+    }
+}
+
+int rs485_bulk_posix_new(const rs485_bulk_posix_config_t *config, rs485_bulk_port_t *ret_port)
+{
+    if ((config == NULL) || (ret_port == NULL) || (config->fd < 0)) {
+        return RS485_BULK_ERR_INVALID;
+    }
+
+    posix_port_t *port = calloc(1, sizeof(posix_port_t));
+    if (port == NULL) {
+        return RS485_BULK_ERR_NO_MEM;
+    }
+    port->fd = config->fd;
+
+    ret_port->write = posix_write;
+    ret_port->flush = posix_flush;
+    ret_port->read = posix_read;
+    ret_port->tx_pending = NULL;
+    ret_port->ctx = port;
+    return RS485_BULK_OK;
+}
+
+void rs485_bulk_posix_del(rs485_bulk_port_t *port)
+{
+    if ((port == NULL) || (port->ctx == NULL)) {
+        return;
+    }
+
+    free(port->ctx);
+    port->ctx = NULL;
+}
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "rs485_bulk_uart.h"
+
+#define EVENT_QUEUE_LEN         (32)
+/* Added to the time the TX buffer takes to be sent */
+#define FLUSH_MARGIN_MS         (100)
+
+static const char *TAG = "rs485_bulk_uart";
+
+typedef struct {
+    uart_port_t uart_num;
+    QueueHandle_t event_queue;
+    size_t tx_buf_size;
+    TickType_t flush_wait;
+} uart_port_ctx_t;
+
+static int uart_write(void *ctx, const uint8_t *data, size_t len)
+{
+    uart_port_ctx_t *port = (uart_port_ctx_t *)ctx;
+
+    return (uart_write_bytes(port->uart_num, data, len) == (int)len) ? RS485_BULK_OK : RS485_BULK_ERR_PORT;
+}
+
+static int uart_flush(void *ctx)
+{
+    uart_port_ctx_t *port = (uart_port_ctx_t *)ctx;
+
+    return (uart_wait_tx_done(port->uart_num, port->flush_wait) == ESP_OK) ? RS485_BULK_OK : RS485_BULK_ERR_PORT;
+}
+
+static size_t uart_tx_pending(void *ctx)
+{
+    uart_port_ctx_t *port = (uart_port_ctx_t *)ctx;
+    size_t free_size = port->tx_buf_size;
+
+    uart_get_tx_buffer_free_size(port->uart_num, &free_size);
+    return port->tx_buf_size - free_size;
+}
+
+/* Drain the events and check them for an overflow, the data is read from the ring buffer as it comes */
+static bool is_overflow(uart_port_ctx_t *port)
+{
+    uart_event_t event;
+
+    while (xQueueReceive(port->event_queue, &event, 0) == pdTRUE) {
+        if ((event.type == UART_FIFO_OVF) || (event.type == UART_BUFFER_FULL)) {
+            ESP_LOGW(TAG, "rx overflow");
+            uart_flush_input(port->uart_num);
+            xQueueReset(port->event_queue);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int uart_read(void *ctx, uint8_t *data, size_t size, uint32_t timeout_ms, size_t *len)
+{
+    uart_port_ctx_t *port = (uart_port_ctx_t *)ctx;
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms) + 1;
+    uart_event_t event;
+
+    *len = 0;
+    while (true) {
+        if (is_overflow(port)) {
+            return RS485_BULK_ERR_OVERFLOW;
+        }
+        size_t buffered = 0;
+        uart_get_buffered_data_len(port->uart_num, &buffered);
+        if (buffered > 0) {
+            int ret = uart_read_bytes(port->uart_num, data, (buffered < size) ? buffered : size, 0);
+            if (ret < 0) {
+                return RS485_BULK_ERR_PORT;
+            }
+            *len = ret;
+            return RS485_BULK_OK;
+        }
+
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return RS485_BULK_ERR_TIMEOUT;
+        }
+        /* Wait for the next event, it's drained above */
+        xQueuePeek(port->event_queue, &event, timeout - elapsed);
+    }
+}
+
+int rs485_bulk_uart_new(const rs485_bulk_uart_config_t *config, rs485_bulk_port_t *ret_port)
+{
+    if ((config == NULL) || (ret_port == NULL) || (config->baud_rate == 0) || (config->tx_buf_size <= 0)) {
+        return RS485_BULK_ERR_INVALID;
+    }
+
+    uart_port_ctx_t *port = calloc(1, sizeof(uart_port_ctx_t));
+    if (port == NULL) {
+        return RS485_BULK_ERR_NO_MEM;
+    }
+    port->uart_num = config->uart_num;
+    port->tx_buf_size = config->tx_buf_size;
+    /* The TX buffer and the FIFO, 10 bits a byte */
+    uint32_t flush_ms = (uint32_t)(((uint64_t)config->tx_buf_size + 256) * 10 * 1000 / config->baud_rate);
+    port->flush_wait = pdMS_TO_TICKS(flush_ms + FLUSH_MARGIN_MS);
+
+    uart_config_t uart_config = {
+        .baud_rate = config->baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    esp_err_t ret = uart_driver_install(config->uart_num, config->rx_buf_size, config->tx_buf_size, EVENT_QUEUE_LEN,
+                                        &port->event_queue, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "install driver failed: %s", esp_err_to_name(ret));
+        free(port);
+        return RS485_BULK_ERR_PORT;
+    }
+    if ((uart_param_config(config->uart_num, &uart_config) != ESP_OK) ||
+            (uart_set_pin(config->uart_num, config->tx_pin, config->rx_pin, config->rts_pin,
+                          UART_PIN_NO_CHANGE) != ESP_OK) ||
+            (uart_set_mode(config->uart_num, UART_MODE_RS485_HALF_DUPLEX) != ESP_OK) ||
+            (uart_set_rx_full_threshold(config->uart_num, config->rx_full_thresh) != ESP_OK) ||
+            (uart_set_tx_empty_threshold(config->uart_num, config->tx_empty_thresh) != ESP_OK) ||
+            (uart_set_rx_timeout(config->uart_num, config->rx_timeout) != ESP_OK)) {
+        ESP_LOGE(TAG, "configure uart failed");
+        uart_driver_delete(config->uart_num);
+        free(port);
+        return RS485_BULK_ERR_PORT;
+    }
+
+    ret_port->write = uart_write;
+    ret_port->flush = uart_flush;
+    ret_port->read = uart_read;
+    ret_port->tx_pending = uart_tx_pending;
+    ret_port->ctx = port;
+    return RS485_BULK_OK;
+}
+
+void rs485_bulk_uart_del(rs485_bulk_port_t *port)
+{
+    if ((port == NULL) || (port->ctx == NULL)) {
+        return;
+    }
+
+    uart_port_ctx_t *ctx = (uart_port_ctx_t *)port->ctx;
+    uart_driver_delete(ctx->uart_num);
+    free(ctx);
+    port->ctx = NULL;
+}
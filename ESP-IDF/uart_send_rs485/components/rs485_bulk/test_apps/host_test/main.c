@@ -0,0 +1,716 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Send payloads between the two ends of a pty pair, on a line which paces the bytes at a baud rate and corrupts or
+ * drops some of them, then measure the payload bytes per second. See README.md.
+ */
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "rs485_bulk.h"
+#include "rs485_bulk_posix.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+/* The bytes the line sends at once */
+#define TEST_LINE_BURST     (64)
+
+static uint64_t test_seed = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t test_rand_r(uint64_t *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return *seed;
+}
+
+static uint64_t test_rand(void)
+{
+    return test_rand_r(&test_seed);
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_us(int64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = us / 1000000,
+        .tv_nsec = (us % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static bool open_pty(int *master_fd, int *slave_fd)
+{
+    *master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((*master_fd < 0) || (grantpt(*master_fd) != 0) || (unlockpt(*master_fd) != 0)) {
+        return false;
+    }
+    *slave_fd = open(ptsname(*master_fd), O_RDWR | O_NOCTTY);
+    if (*slave_fd < 0) {
+        return false;
+    }
+
+    /* Bytes as they are, no echo */
+    struct termios tio;
+    tcgetattr(*slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave_fd, TCSANOW, &tio);
+    return true;
+}
+
+typedef struct {
+    uint32_t baud_rate;         /* 0 to send at the speed of the pty */
+    uint32_t corrupt_every;     /* About the bytes sent between 2 corrupted ones, 0 for none */
+    uint32_t drop_every;        /* About the bytes received between 2 overflows, 0 for none */
+    size_t tx_buf_size;
+} test_line_config_t;
+
+/* An end of the line, like the driver of a UART: a TX ring sent by a thread at the baud rate */
+typedef struct {
+    test_line_config_t config;
+    int fd;
+    rs485_bulk_port_t posix;
+    uint8_t *ring;
+    size_t head;
+    size_t count;               /* Queued or on the line */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool stop;
+    pthread_t thread;
+    uint64_t tx_seed;
+    uint64_t rx_seed;
+    uint64_t next_corrupt;
+    uint64_t next_drop;
+    uint32_t corrupted_num;
+    uint32_t dropped_num;
+} test_line_t;
+
+static void *line_main(void *arg)
+{
+    test_line_t *line = (test_line_t *)arg;
+    uint8_t burst[TEST_LINE_BURST];
+    uint64_t sent = 0;
+    int64_t next_us = now_us();
+
+    pthread_mutex_lock(&line->lock);
+    while (true) {
+        while ((line->count == 0) && !line->stop) {
+            pthread_cond_wait(&line->cond, &line->lock);
+        }
+        if (line->stop) {
+            break;
+        }
+        size_t len = (line->count < sizeof(burst)) ? line->count : sizeof(burst);
+        for (size_t i = 0; i < len; i++) {
+            burst[i] = line->ring[(line->head + i) % line->config.tx_buf_size];
+        }
+        pthread_mutex_unlock(&line->lock);
+
+        if ((line->config.corrupt_every > 0) && (sent + len > line->next_corrupt)) {
+            burst[line->next_corrupt - sent] ^= 0x10;
+            line->next_corrupt += 1 + test_rand_r(&line->tx_seed) % (2 * line->config.corrupt_every);
+            line->corrupted_num++;
+        }
+        sent += len;
+        size_t offset = 0;
+        while (offset < len) {
+            ssize_t ret = write(line->fd, &burst[offset], len - offset);
+            offset += (ret > 0) ? ret : 0;
+        }
+        /* The bytes are on the line for their time, 10 bits each */
+        if (line->config.baud_rate > 0) {
+            int64_t now = now_us();
+            next_us = (next_us < now - 1000) ? now : next_us;
+            next_us += (int64_t)len * 10 * 1000000 / line->config.baud_rate;
+            if (next_us > now) {
+                sleep_us(next_us - now);
+            }
+        }
+
+        pthread_mutex_lock(&line->lock);
+        line->head = (line->head + len) % line->config.tx_buf_size;
+        line->count -= len;
+        pthread_cond_broadcast(&line->cond);
+    }
+    pthread_mutex_unlock(&line->lock);
+
+    return NULL;
+}
+
+static int line_write(void *ctx, const uint8_t *data, size_t len)
+{
+    test_line_t *line = (test_line_t *)ctx;
+
+    pthread_mutex_lock(&line->lock);
+    for (size_t i = 0; i < len; i++) {
+        while (line->count == line->config.tx_buf_size) {
+            pthread_cond_wait(&line->cond, &line->lock);
+        }
+        line->ring[(line->head + line->count) % line->config.tx_buf_size] = data[i];
+        line->count++;
+        if (line->count == 1) {
+            pthread_cond_broadcast(&line->cond);
+        }
+    }
+    pthread_cond_broadcast(&line->cond);
+    pthread_mutex_unlock(&line->lock);
+
+    return RS485_BULK_OK;
+}
+
+static int line_flush(void *ctx)
+{
+    test_line_t *line = (test_line_t *)ctx;
+
+    pthread_mutex_lock(&line->lock);
+    while (line->count > 0) {
+        pthread_cond_wait(&line->cond, &line->lock);
+    }
+    pthread_mutex_unlock(&line->lock);
+
+    return RS485_BULK_OK;
+}
+
+static size_t line_tx_pending(void *ctx)
+{
+    test_line_t *line = (test_line_t *)ctx;
+
+    pthread_mutex_lock(&line->lock);
+    size_t count = line->count;
+    pthread_mutex_unlock(&line->lock);
+
+    return count;
+}
+
+static int line_read(void *ctx, uint8_t *data, size_t size, uint32_t timeout_ms, size_t *len)
+{
+    test_line_t *line = (test_line_t *)ctx;
+
+    int ret = line->posix.read(line->posix.ctx, data, size, timeout_ms, len);
+    if ((ret != RS485_BULK_OK) || (line->config.drop_every == 0)) {
+        return ret;
+    }
+    /* Like a UART, the bytes received are dropped */
+    if (*len >= line->next_drop) {
+        line->next_drop = 1 + test_rand_r(&line->rx_seed) % (2 * line->config.drop_every);
+        line->dropped_num++;
+        *len = 0;
+        return RS485_BULK_ERR_OVERFLOW;
+    }
+    line->next_drop -= *len;
+
+    return RS485_BULK_OK;
+}
+
+static bool start_line(test_line_t *line, int fd, const test_line_config_t *config, rs485_bulk_port_t *port)
+{
+    memset(line, 0, sizeof(*line));
+    line->config = *config;
+    line->fd = fd;
+    rs485_bulk_posix_config_t posix_config = {
+        .fd = fd,
+    };
+    if (rs485_bulk_posix_new(&posix_config, &line->posix) != RS485_BULK_OK) {
+        return false;
+    }
+    line->ring = malloc(config->tx_buf_size);
+    if (line->ring == NULL) {
+        return false;
+    }
+    line->tx_seed = test_rand() | 1;
+    line->rx_seed = test_rand() | 1;
+    line->next_corrupt = (config->corrupt_every > 0) ? test_rand() % (2 * config->corrupt_every) : 0;
+    line->next_drop = (config->drop_every > 0) ? 1 + test_rand() % (2 * config->drop_every) : 0;
+    pthread_mutex_init(&line->lock, NULL);
+    pthread_cond_init(&line->cond, NULL);
+
+    port->write = line_write;
+    port->flush = line_flush;
+    port->read = line_read;
+    port->tx_pending = line_tx_pending;
+    port->ctx = line;
+    return pthread_create(&line->thread, NULL, line_main, line) == 0;
+}
+
+static void stop_line(test_line_t *line)
+{
+    pthread_mutex_lock(&line->lock);
+    line->stop = true;
+    pthread_cond_broadcast(&line->cond);
+    pthread_mutex_unlock(&line->lock);
+    pthread_join(line->thread, NULL);
+    pthread_cond_destroy(&line->cond);
+    pthread_mutex_destroy(&line->lock);
+    rs485_bulk_posix_del(&line->posix);
+    free(line->ring);
+}
+
+/* The sender on one end of a pty, the receiver on the other */
+typedef struct {
+    int fds[2];
+    bool is_raw;                /* The POSIX port as is, without a line */
+    test_line_t lines[2];
+    rs485_bulk_port_t raw_ports[2];
+    rs485_bulk_t *bulks[2];
+} test_link_t;
+
+static bool open_link(test_link_t *link, const test_line_config_t *line_config, const rs485_bulk_config_t *config)
+{
+    memset(link, 0, sizeof(*link));
+    link->is_raw = (line_config == NULL);
+    if (!open_pty(&link->fds[0], &link->fds[1])) {
+        return false;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        rs485_bulk_config_t bulk_config = *config;
+        if (link->is_raw) {
+            rs485_bulk_posix_config_t posix_config = {
+                .fd = link->fds[i],
+            };
+            if (rs485_bulk_posix_new(&posix_config, &link->raw_ports[i]) != RS485_BULK_OK) {
+                return false;
+            }
+            bulk_config.port = link->raw_ports[i];
+        } else if (!start_line(&link->lines[i], link->fds[i], line_config, &bulk_config.port)) {
+            return false;
+        }
+        if (rs485_bulk_new(&bulk_config, &link->bulks[i]) != RS485_BULK_OK) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void close_link(test_link_t *link)
+{
+    for (int i = 0; i < 2; i++) {
+        rs485_bulk_del(link->bulks[i]);
+        if (link->is_raw) {
+            rs485_bulk_posix_del(&link->raw_ports[i]);
+        } else {
+            stop_line(&link->lines[i]);
+        }
+    }
+    close(link->fds[1]);
+    close(link->fds[0]);
+}
+
+typedef struct {
+    rs485_bulk_t *bulk;
+    const uint8_t *data;
+    size_t len;
+    int status;
+    int64_t elapsed_us;         /* Up to the end known by the sender, the receiver lingers after it */
+    pthread_t thread;
+} test_sender_t;
+
+static void *sender_main(void *arg)
+{
+    test_sender_t *sender = (test_sender_t *)arg;
+
+    int64_t start_us = now_us();
+    sender->status = rs485_bulk_send(sender->bulk, sender->data, sender->len);
+    sender->elapsed_us = now_us() - start_us;
+    return NULL;
+}
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    uint32_t next_offset;
+    uint32_t abort_offset;      /* 0 to take all of it */
+    bool is_bad;
+} test_sink_t;
+
+static bool sink_write(uint32_t offset, const uint8_t *data, size_t len, void *user_data)
+{
+    test_sink_t *sink = (test_sink_t *)user_data;
+
+    if ((offset != sink->next_offset) || (offset + len > sink->size)) {
+        sink->is_bad = true;
+        return false;
+    }
+    if ((sink->abort_offset > 0) && (offset >= sink->abort_offset)) {
+        return false;
+    }
+    memcpy(&sink->data[offset], data, len);
+    sink->next_offset += len;
+    return true;
+}
+
+/* Send a payload from a thread and receive it, the statuses of both ends and the time of the sender */
+static bool transfer(test_link_t *link, const uint8_t *data, size_t len, test_sink_t *sink, int *send_status,
+                     int *recv_status, uint32_t *recv_len, double *elapsed_s)
+{
+    test_sender_t sender = {
+        .bulk = link->bulks[0],
+        .data = data,
+        .len = len,
+    };
+    if (pthread_create(&sender.thread, NULL, sender_main, &sender) != 0) {
+        return false;
+    }
+    *recv_status = rs485_bulk_recv(link->bulks[1], 1000, sink_write, sink, recv_len);
+    pthread_join(sender.thread, NULL);
+    *send_status = sender.status;
+    if (elapsed_s != NULL) {
+        *elapsed_s = sender.elapsed_us / 1e6;
+    }
+    return true;
+}
+
+static uint8_t *random_payload(size_t len)
+{
+    uint8_t *data = malloc(len + 1);
+    for (size_t i = 0; (data != NULL) && (i < len); i++) {
+        data[i] = (uint8_t)test_rand();
+    }
+    return data;
+}
+
+static uint32_t crc32_ref(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xffffffff;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xedb88320) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
+static bool test_crc(void)
+{
+    TEST_CHECK(rs485_bulk_crc32(0, (const uint8_t *)"123456789", 9) == 0xcbf43926, "check value");
+    TEST_CHECK(rs485_bulk_crc32(0, NULL, 0) == 0, "crc of nothing");
+
+    uint8_t data[4096];
+    for (int i = 0; i < 1000; i++) {
+        size_t len = test_rand() % sizeof(data);
+        for (size_t j = 0; j < len; j++) {
+            data[j] = (uint8_t)test_rand();
+        }
+        uint32_t crc = rs485_bulk_crc32(0, data, len);
+        TEST_CHECK(crc == crc32_ref(data, len), "crc of %zu bytes", len);
+        /* In pieces, like the chunks of a payload */
+        size_t split = (len > 0) ? test_rand() % len : 0;
+        TEST_CHECK(rs485_bulk_crc32(rs485_bulk_crc32(0, data, split), &data[split], len - split) == crc,
+                   "crc of %zu bytes split at %zu", len, split);
+    }
+    return true;
+}
+
+static bool test_transfer(void)
+{
+    static test_link_t link;
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    TEST_CHECK(open_link(&link, NULL, &config), "no link");
+    const size_t lens[] = {0, 1, 1024, 8 * 1024, 8 * 1024 + 1, 1024 * 1024};
+
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        size_t len = lens[i];
+        uint8_t *data = random_payload(len);
+        test_sink_t sink = {
+            .data = calloc(1, len + 1),
+            .size = len,
+        };
+        int send_status = 0;
+        int recv_status = 0;
+        uint32_t recv_len = UINT32_MAX;
+        TEST_CHECK(transfer(&link, data, len, &sink, &send_status, &recv_status, &recv_len, NULL), "no sender");
+        TEST_CHECK((send_status == RS485_BULK_OK) && (recv_status == RS485_BULK_OK), "%zu bytes: sent %d, received %d",
+                   len, send_status, recv_status);
+        TEST_CHECK((recv_len == len) && !sink.is_bad && (memcmp(sink.data, data, len) == 0), "%zu bytes: %u received",
+                   len, recv_len);
+        free(sink.data);
+        free(data);
+    }
+
+    rs485_bulk_stats_t sent;
+    rs485_bulk_stats_t received;
+    rs485_bulk_get_stats(link.bulks[0], &sent);
+    rs485_bulk_get_stats(link.bulks[1], &received);
+    close_link(&link);
+    uint64_t total = 0;
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        total += lens[i];
+    }
+    TEST_CHECK((sent.payload_byte_num == total) && (received.payload_byte_num == total), "payload bytes %llu, %llu",
+               (unsigned long long)sent.payload_byte_num, (unsigned long long)received.payload_byte_num);
+    TEST_CHECK((sent.retransmit_num == 0) && (sent.ack_timeout_num == 0) && (received.crc_error_num == 0) &&
+               (received.skipped_byte_num == 0), "errors on a clean line");
+    /* The frames of a window are counted on both ends */
+    TEST_CHECK((sent.tx_frame_num == received.rx_frame_num) && (received.tx_frame_num == sent.rx_frame_num),
+               "frames: sent %u, received %u, acks sent %u, received %u", sent.tx_frame_num, received.rx_frame_num,
+               received.tx_frame_num, sent.rx_frame_num);
+    return true;
+}
+
+static bool test_lossy(void)
+{
+    static test_link_t link;
+    test_line_config_t line_config = {
+        .corrupt_every = 20000,
+        .drop_every = 50000,
+        .tx_buf_size = 16 * 1024,
+    };
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    config.ack_timeout_ms = 20;
+    config.retry_max = 10;
+    TEST_CHECK(open_link(&link, &line_config, &config), "no link");
+    const size_t len = 512 * 1024;
+    uint8_t *data = random_payload(len);
+    test_sink_t sink = {
+        .data = calloc(1, len),
+        .size = len,
+    };
+
+    int send_status = 0;
+    int recv_status = 0;
+    uint32_t recv_len = 0;
+    double elapsed_s = 0;
+    TEST_CHECK(transfer(&link, data, len, &sink, &send_status, &recv_status, &recv_len, &elapsed_s), "no sender");
+    rs485_bulk_stats_t sent;
+    rs485_bulk_stats_t received;
+    rs485_bulk_get_stats(link.bulks[0], &sent);
+    rs485_bulk_get_stats(link.bulks[1], &received);
+    close_link(&link);
+    uint32_t corrupted_num = link.lines[0].corrupted_num + link.lines[1].corrupted_num;
+    uint32_t dropped_num = link.lines[0].dropped_num + link.lines[1].dropped_num;
+
+    printf("%zu KB in %.2f s: %u bytes corrupted, %u reads dropped; %u crc errors, %u overflows, %u skipped bytes, "
+           "%u out of order, %u retransmitted, %u ack timeouts\n", len / 1024, elapsed_s, corrupted_num, dropped_num,
+           received.crc_error_num + sent.crc_error_num, received.overflow_num + sent.overflow_num,
+           received.skipped_byte_num + sent.skipped_byte_num, received.out_of_order_num, sent.retransmit_num,
+           sent.ack_timeout_num);
+    TEST_CHECK((send_status == RS485_BULK_OK) && (recv_status == RS485_BULK_OK), "sent %d, received %d", send_status,
+               recv_status);
+    TEST_CHECK((recv_len == len) && !sink.is_bad && (memcmp(sink.data, data, len) == 0), "%u received", recv_len);
+    TEST_CHECK((corrupted_num > 0) && (dropped_num > 0), "the line is clean");
+    TEST_CHECK((received.overflow_num + sent.overflow_num == dropped_num), "overflows not counted");
+    TEST_CHECK((sent.retransmit_num > 0) && (received.crc_error_num + received.overflow_num > 0),
+               "errors not counted");
+    free(sink.data);
+    free(data);
+    return true;
+}
+
+static bool test_abort(void)
+{
+    static test_link_t link;
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    TEST_CHECK(open_link(&link, NULL, &config), "no link");
+    const size_t len = 256 * 1024;
+    uint8_t *data = random_payload(len);
+    test_sink_t sink = {
+        .data = calloc(1, len),
+        .size = len,
+        .abort_offset = 100 * 1024,
+    };
+
+    /* The receiver refuses the payload in its middle */
+    int send_status = 0;
+    int recv_status = 0;
+    uint32_t recv_len = 0;
+    TEST_CHECK(transfer(&link, data, len, &sink, &send_status, &recv_status, &recv_len, NULL), "no sender");
+    TEST_CHECK((send_status == RS485_BULK_ERR_ABORTED) && (recv_status == RS485_BULK_ERR_ABORTED),
+               "sent %d, received %d", send_status, recv_status);
+    TEST_CHECK(recv_len == sink.abort_offset, "%u received", recv_len);
+
+    /* The line is still good for the next one */
+    sink.abort_offset = 0;
+    sink.next_offset = 0;
+    TEST_CHECK(transfer(&link, data, len, &sink, &send_status, &recv_status, &recv_len, NULL), "no sender");
+    TEST_CHECK((send_status == RS485_BULK_OK) && (recv_status == RS485_BULK_OK) &&
+               (memcmp(sink.data, data, len) == 0), "sent %d, received %d", send_status, recv_status);
+
+    close_link(&link);
+    free(sink.data);
+    free(data);
+    return true;
+}
+
+static bool test_timeout(void)
+{
+    static test_link_t link;
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    config.ack_timeout_ms = 20;
+    config.retry_max = 3;
+    TEST_CHECK(open_link(&link, NULL, &config), "no link");
+    uint8_t data[100] = {};
+
+    /* No receiver: the start is sent 4 times */
+    int64_t start_us = now_us();
+    TEST_CHECK(rs485_bulk_send(link.bulks[0], data, sizeof(data)) == RS485_BULK_ERR_TIMEOUT, "sent to nobody");
+    int64_t elapsed_ms = (now_us() - start_us) / 1000;
+    TEST_CHECK((elapsed_ms >= 80) && (elapsed_ms < 200), "gave up in %lld ms", (long long)elapsed_ms);
+
+    /* No sender, after the starts sent to nobody */
+    tcflush(link.fds[1], TCIFLUSH);
+    test_sink_t sink = {};
+    start_us = now_us();
+    TEST_CHECK(rs485_bulk_recv(link.bulks[1], 50, sink_write, &sink, NULL) == RS485_BULK_ERR_TIMEOUT,
+               "received from nobody");
+    elapsed_ms = (now_us() - start_us) / 1000;
+    TEST_CHECK((elapsed_ms >= 50) && (elapsed_ms < 150), "waited %lld ms", (long long)elapsed_ms);
+
+    close_link(&link);
+    return true;
+}
+
+static bool test_underrun(void)
+{
+    static test_link_t link;
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    test_line_config_t line_config = {
+        .baud_rate = 2000000,
+        .tx_buf_size = 16 * 1024,
+    };
+    const size_t len = 64 * 1024;
+    uint8_t *data = random_payload(len);
+    test_sink_t sink = {
+        .data = calloc(1, len),
+        .size = len,
+    };
+    int send_status = 0;
+    int recv_status = 0;
+    uint32_t recv_len = 0;
+    uint32_t underrun_nums[2] = {};
+
+    /* The window is queued faster than the line sends it, then as fast as the pty takes it */
+    for (int i = 0; i < 2; i++) {
+        line_config.baud_rate = (i == 0) ? 2000000 : 0;
+        sink.next_offset = 0;
+        TEST_CHECK(open_link(&link, &line_config, &config), "no link");
+        TEST_CHECK(transfer(&link, data, len, &sink, &send_status, &recv_status, &recv_len, NULL), "no sender");
+        TEST_CHECK((send_status == RS485_BULK_OK) && (recv_status == RS485_BULK_OK), "sent %d, received %d",
+                   send_status, recv_status);
+        rs485_bulk_stats_t stats;
+        rs485_bulk_get_stats(link.bulks[0], &stats);
+        underrun_nums[i] = stats.underrun_num;
+        close_link(&link);
+    }
+    printf("underruns: %u at 2 Mbaud, %u on the pty, of %zu frames\n", underrun_nums[0], underrun_nums[1],
+           len / config.chunk_size);
+    TEST_CHECK(underrun_nums[0] == 0, "%u underruns with a full TX buffer", underrun_nums[0]);
+    TEST_CHECK(underrun_nums[1] > 0, "no underrun with an empty TX buffer");
+
+    free(sink.data);
+    free(data);
+    return true;
+}
+
+static bool bench(uint32_t baud_rate, uint16_t chunk_size, uint8_t window)
+{
+    static test_link_t link;
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    config.chunk_size = chunk_size;
+    config.window = window;
+    test_line_config_t line_config = {
+        .baud_rate = baud_rate,
+        .tx_buf_size = 16 * 1024,
+    };
+    /* About 0.3 s on the line */
+    size_t len = (baud_rate > 0) ? baud_rate / 10 * 3 / 10 : 4 * 1024 * 1024;
+    uint8_t *data = random_payload(len);
+    test_sink_t sink = {
+        .data = malloc(len),
+        .size = len,
+    };
+    TEST_CHECK(open_link(&link, (baud_rate > 0) ? &line_config : NULL, &config), "no link");
+
+    int send_status = 0;
+    int recv_status = 0;
+    uint32_t recv_len = 0;
+    double elapsed_s = 0;
+    TEST_CHECK(transfer(&link, data, len, &sink, &send_status, &recv_status, &recv_len, &elapsed_s), "no sender");
+    rs485_bulk_stats_t stats;
+    rs485_bulk_get_stats(link.bulks[0], &stats);
+    close_link(&link);
+    TEST_CHECK((send_status == RS485_BULK_OK) && (recv_status == RS485_BULK_OK) &&
+               (memcmp(sink.data, data, len) == 0), "sent %d, received %d", send_status, recv_status);
+
+    double byte_rate = len / elapsed_s;
+    char line[32] = "pty";
+    char share[16] = "-";
+    if (baud_rate > 0) {
+        snprintf(line, sizeof(line), "%u baud", (unsigned)baud_rate);
+        snprintf(share, sizeof(share), "%.0f%%", 100 * byte_rate / (baud_rate / 10));
+    }
+    printf("| %s | %u | %u | %.0f | %s | %u |\n", line, chunk_size, window, byte_rate / 1024, share,
+           stats.underrun_num);
+    free(sink.data);
+    free(data);
+    return true;
+}
+
+static bool test_bench(void)
+{
+    const uint32_t baud_rates[] = {0, 921600, 3000000};
+    const uint16_t chunk_sizes[] = {256, 1024, 4096};
+    const uint8_t windows[] = {1, 4, 16};
+
+    printf("| Line | Chunk | Window | Payload KB/s | Of the line | Underruns |\n");
+    for (size_t i = 0; i < sizeof(baud_rates) / sizeof(baud_rates[0]); i++) {
+        for (size_t j = 0; j < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); j++) {
+            for (size_t k = 0; k < sizeof(windows) / sizeof(windows[0]); k++) {
+                if (!bench(baud_rates[i], chunk_sizes[j], windows[k])) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"crc", test_crc},
+        {"transfer", test_transfer},
+        {"lossy", test_lossy},
+        {"abort", test_abort},
+        {"timeout", test_timeout},
+        {"underrun", test_underrun},
+        {"bench", test_bench},
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
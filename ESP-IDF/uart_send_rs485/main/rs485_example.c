@@ -6,6 +6,7 @@
    software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
    CONDITIONS OF ANY KIND, either express or implied.
 */
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -17,6 +18,9 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "sdkconfig.h"
+#include "esp_timer.h"
+#include "rs485_bulk.h"
+#include "rs485_bulk_uart.h"
 
 /**
  * This is a example which echos any data it receives on UART back to the sender using RS485 interface in half duplex mode.
@@ -132,8 +136,133 @@ static void echo_task(void *arg)
     vTaskDelete(NULL);
 }
 
+#if !CONFIG_ECHO_APP_MODE_TEST
+static rs485_bulk_t *bulk_init(uint16_t chunk_size, uint8_t window)
+{
+    rs485_bulk_uart_config_t uart_config = RS485_BULK_UART_DEFAULT_CONFIG();
+    uart_config.uart_num = ECHO_UART_PORT;
+    uart_config.baud_rate = BAUD_RATE;
+    uart_config.tx_pin = ECHO_TEST_TXD;
+    uart_config.rx_pin = ECHO_TEST_RXD;
+    uart_config.rts_pin = ECHO_TEST_RTS;
+
+    rs485_bulk_config_t config = RS485_BULK_DEFAULT_CONFIG();
+    if (rs485_bulk_uart_new(&uart_config, &config.port) != RS485_BULK_OK) {
+        ESP_LOGE(TAG, "Bulk UART init failure.");
+        abort();
+    }
+    config.chunk_size = chunk_size;
+    config.window = window;
+    // The transceiver of the other end releases the line in about 2 characters
+    config.turnaround_us = (20 * 1000000 / BAUD_RATE > 100) ? 20 * 1000000 / BAUD_RATE : 100;
+
+    rs485_bulk_t *bulk = NULL;
+    if (rs485_bulk_new(&config, &bulk) != RS485_BULK_OK) {
+        ESP_LOGE(TAG, "Bulk init failure.");
+        abort();
+    }
+    return bulk;
+}
+
+static inline uint8_t bulk_pattern(uint32_t offset)
+{
+    return (uint8_t)(offset ^ (offset >> 8) ^ (offset >> 16));
+}
+#endif
+
+#if CONFIG_ECHO_APP_MODE_BULK_SEND
+// Send the same payload again and again, and log the bytes per second of each
+static void bulk_send_task(void *arg)
+{
+    const size_t len = CONFIG_ECHO_BULK_PAYLOAD_KB * 1024;
+    uint8_t *data = (uint8_t *) malloc(len);
+    assert(data);
+    for (size_t i = 0; i < len; i++) {
+        data[i] = bulk_pattern(i);
+    }
+    rs485_bulk_t *bulk = bulk_init(CONFIG_ECHO_BULK_CHUNK_SIZE, CONFIG_ECHO_BULK_WINDOW);
+    ESP_LOGI(TAG, "Send %d KB at %d baud in chunks of %d, windows of %d.", CONFIG_ECHO_BULK_PAYLOAD_KB, BAUD_RATE,
+             CONFIG_ECHO_BULK_CHUNK_SIZE, CONFIG_ECHO_BULK_WINDOW);
+
+    while (1) {
+        rs485_bulk_stats_t before;
+        rs485_bulk_get_stats(bulk, &before);
+        int64_t start_us = esp_timer_get_time();
+        int ret = rs485_bulk_send(bulk, data, len);
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+        rs485_bulk_stats_t stats;
+        rs485_bulk_get_stats(bulk, &stats);
+
+        if (ret == RS485_BULK_OK) {
+            ESP_LOGI(TAG, "Sent %u bytes in %"PRId64" ms: %"PRId64" bytes/s, %"PRIu32" retransmitted, %"PRIu32
+                     " ack timeouts, %"PRIu32" underruns", (unsigned)len, elapsed_us / 1000,
+                     (int64_t)len * 1000000 / elapsed_us, stats.retransmit_num - before.retransmit_num,
+                     stats.ack_timeout_num - before.ack_timeout_num, stats.underrun_num - before.underrun_num);
+        } else {
+            ESP_LOGW(TAG, "Send failure: %d", ret);
+        }
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
+#endif
+
+#if CONFIG_ECHO_APP_MODE_BULK_RECV
+typedef struct {
+    uint32_t bad_offset;
+    bool is_bad;
+} bulk_check_t;
+
+// Check the chunks against the pattern of the sender, a firmware would be written to its partition here
+static bool bulk_write(uint32_t offset, const uint8_t *data, size_t len, void *user_data)
+{
+    bulk_check_t *check = (bulk_check_t *) user_data;
+
+    for (size_t i = 0; (i < len) && !check->is_bad; i++) {
+        if (data[i] != bulk_pattern(offset + i)) {
+            check->bad_offset = offset + i;
+            check->is_bad = true;
+        }
+    }
+    return true;
+}
+
+static void bulk_recv_task(void *arg)
+{
+    rs485_bulk_t *bulk = bulk_init(RS485_BULK_CHUNK_MAX, 1);
+    ESP_LOGI(TAG, "Receive at %d baud.", BAUD_RATE);
+
+    while (1) {
+        bulk_check_t check = {};
+        uint32_t len = 0;
+        int64_t start_us = esp_timer_get_time();
+        int ret = rs485_bulk_recv(bulk, 5000, bulk_write, &check, &len);
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+        if (ret == RS485_BULK_ERR_TIMEOUT) {
+            continue;
+        }
+        rs485_bulk_stats_t stats;
+        rs485_bulk_get_stats(bulk, &stats);
+
+        if ((ret == RS485_BULK_OK) && !check.is_bad) {
+            ESP_LOGI(TAG, "Received %"PRIu32" bytes in %"PRId64" ms, with the wait and the end; in all %"PRIu32
+                     " CRC errors, %"PRIu32" overflows, %"PRIu32" out of order", len, elapsed_us / 1000,
+                     stats.crc_error_num, stats.overflow_num, stats.out_of_order_num);
+        } else {
+            ESP_LOGW(TAG, "Receive failure: %d, %"PRIu32" bytes, %s", ret, len,
+                     check.is_bad ? "bad pattern" : "pattern ok");
+        }
+    }
+}
+#endif
+
 void app_main(void)
 {
+#if CONFIG_ECHO_APP_MODE_BULK_SEND
+    xTaskCreate(bulk_send_task, "bulk_send_task", ECHO_TASK_STACK_SIZE, NULL, ECHO_TASK_PRIO, NULL);
+#elif CONFIG_ECHO_APP_MODE_BULK_RECV
+    xTaskCreate(bulk_recv_task, "bulk_recv_task", ECHO_TASK_STACK_SIZE, NULL, ECHO_TASK_PRIO, NULL);
+#else
     //A uart read/write example without event queue;
     xTaskCreate(echo_task, "uart_echo_task", ECHO_TASK_STACK_SIZE, NULL, ECHO_TASK_PRIO, NULL);
+#endif
 }
@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An MJPEG server over HTTP: each client of `uri` gets the frames as the parts of a `multipart/x-mixed-replace`
+ * response, like a webcam in a browser.
+ *
+ * A frame is encoded once, from the buffer of the camera while it's lent by the video task, into a JPEG buffer of
+ * the stream. The buffer is shared by the clients which send it, and it's sent from there with the part header and
+ * trailer of the stream, by scatter-gather, so the JPEG is not copied. A client which can't keep up isn't queued
+ * frames: it sends its current frame to the end, then the latest one, the frames in between are dropped for it.
+ */
+
+#define MJPEG_STREAM_OK                 (0)
+#define MJPEG_STREAM_ERR_INVALID        (-1)
+#define MJPEG_STREAM_ERR_NO_MEM         (-2)
+#define MJPEG_STREAM_ERR_SOCKET         (-3)
+#define MJPEG_STREAM_ERR_BUSY           (-4)    /*!< The frame is dropped: no client, or all the buffers are sent */
+#define MJPEG_STREAM_ERR_ENCODE         (-5)
+
+/**
+ * @brief Encode a frame into a JPEG buffer of the stream, in the task of `mjpeg_stream_push_frame()`.
+ *
+ * @param pixels The pixels of the frame
+ * @param len The length of the pixels
+ * @param width The width of the frame
+ * @param height The height of the frame
+ * @param jpeg The JPEG buffer
+ * @param jpeg_size The size of the JPEG buffer
+ * @param jpeg_len The length of the JPEG
+ * @param user_data The user data of the configuration
+ *
+ * @return 0 on success
+ */
+typedef int (*mjpeg_stream_encode_cb_t)(const uint8_t *pixels, size_t len, uint32_t width, uint32_t height,
+                                        uint8_t *jpeg, size_t jpeg_size, size_t *jpeg_len, void *user_data);
+
+typedef struct {
+    uint16_t port;              /*!< The TCP port of the server, 0 for any, see `mjpeg_stream_get_port()` */
+    const char *uri;            /*!< The path of the stream, the other paths get a 404. The string is kept */
+    uint8_t client_max;         /*!< The clients above it get a 503 */
+    uint8_t frame_buf_num;      /*!< The JPEG buffers. A client holds one while it sends it, the latest frame holds
+                                     one, and one is encoded: `client_max + 2` never drops a frame for a slow client */
+    size_t frame_buf_size;      /*!< The size of a JPEG buffer, a larger JPEG is dropped */
+    uint32_t client_timeout_ms; /*!< A client which hasn't accepted a byte for this time is closed */
+    int send_buf_size;          /*!< The send buffer of a client socket, 0 for the default of the system. A large buffer
+                                     queues frames for a slow client instead of skipping them */
+    mjpeg_stream_encode_cb_t encode;    /*!< The encoder, required */
+    void *user_data;            /*!< The user data of the encoder */
+    uint32_t stack_size;        /*!< Stack of the server, bytes. Only used on the target, the host uses the default */
+    uint8_t priority;           /*!< Priority of the server. Only used on the target */
+} mjpeg_stream_config_t;
+
+#define MJPEG_STREAM_DEFAULT_CONFIG()       \
+    {                                       \
+        .port = 8080,                       \
+        .uri = "/stream",                   \
+        .client_max = 4,                    \
+        .frame_buf_num = 6,                 \
+        .frame_buf_size = 256 * 1024,       \
+        .client_timeout_ms = 5000,          \
+        .send_buf_size = 0,                 \
+        .encode = NULL,                     \
+        .user_data = NULL,                  \
+        .stack_size = 4 * 1024,             \
+        .priority = 5,                      \
+    }
+
+typedef struct {
+    uint32_t client_num;        /*!< The clients of the stream now */
+    uint32_t frame_num;         /*!< The frames encoded */
+    uint32_t busy_num;          /*!< The frames dropped since all the buffers were sent */
+    uint32_t error_num;         /*!< The frames the encoder failed, or too large */
+    uint64_t sent_frame_num;    /*!< The frames sent to the end, by all the clients */
+    uint64_t skipped_frame_num; /*!< The frames replaced by a newer one before a client sent them */
+    uint64_t sent_byte_num;     /*!< The bytes sent to the clients, with the HTTP headers */
+} mjpeg_stream_stats_t;
+
+typedef struct mjpeg_stream_t mjpeg_stream_t;
+
+/**
+ * @brief Create a stream and start its server.
+ *
+ * @param config The configuration, its encoder is required
+ * @param ret_stream The stream
+ *
+ * @return MJPEG_STREAM_OK, or an error if the configuration is invalid, out of memory, or the port can't be bound
+ */
+int mjpeg_stream_new(const mjpeg_stream_config_t *config, mjpeg_stream_t **ret_stream);
+
+/**
+ * @brief Stop the server, close its clients, and delete a stream.
+ *
+ * @param stream The stream, can be NULL
+ */
+void mjpeg_stream_del(mjpeg_stream_t *stream);
+
+/**
+ * @brief Get the TCP port of the server, the one which was bound for the port 0.
+ *
+ * @param stream The stream
+ *
+ * @return The port
+ */
+uint16_t mjpeg_stream_get_port(const mjpeg_stream_t *stream);
+
+/**
+ * @brief Check if a client is waiting for a frame, so a frame which can't be sent isn't encoded.
+ *
+ * @param stream The stream
+ *
+ * @return true if a client is connected, and a buffer is free
+ */
+bool mjpeg_stream_is_wanted(mjpeg_stream_t *stream);
+
+/**
+ * @brief Encode a frame and send it to the clients. The pixels are only read during the call, so it can be called
+ *        with the buffer of the camera while it's dequeued.
+ *
+ * @param stream The stream
+ * @param pixels The pixels of the frame
+ * @param len The length of the pixels
+ * @param width The width of the frame
+ * @param height The height of the frame
+ *
+ * @return MJPEG_STREAM_OK, MJPEG_STREAM_ERR_BUSY if the frame isn't wanted, or MJPEG_STREAM_ERR_ENCODE
+ */
+int mjpeg_stream_push_frame(mjpeg_stream_t *stream, const uint8_t *pixels, size_t len, uint32_t width,
+                            uint32_t height);
+
+/**
+ * @brief Get the counters of a stream.
+ *
+ * @param stream The stream
+ * @param stats The counters
+ */
+void mjpeg_stream_get_stats(mjpeg_stream_t *stream, mjpeg_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include "driver/jpeg_encode.h"
+#include "mjpeg_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The JPEG encoder of the ESP32-P4 as the encoder of a stream: it reads the pixels by DMA from the buffer of the
+ * camera, and writes the JPEG into the buffer of the stream.
+ */
+
+typedef struct {
+    jpeg_enc_input_format_t src_type;       /*!< The format of the camera, e.g. JPEG_ENCODE_IN_FORMAT_RGB565 */
+    jpeg_down_sampling_type_t sub_sample;   /*!< The chroma subsampling of the JPEG */
+    uint8_t quality;                        /*!< 1 to 100 */
+    int timeout_ms;                         /*!< The timeout of a frame */
+} mjpeg_stream_hw_encoder_config_t;
+
+#define MJPEG_STREAM_HW_ENCODER_DEFAULT_CONFIG()        \
+    {                                                   \
+        .src_type = JPEG_ENCODE_IN_FORMAT_RGB565,       \
+        .sub_sample = JPEG_DOWN_SAMPLING_YUV420,        \
+        .quality = 80,                                  \
+        .timeout_ms = 100,                              \
+    }
+
+typedef struct mjpeg_stream_hw_encoder_t mjpeg_stream_hw_encoder_t;
+
+/**
+ * @brief Create an encoder.
+ *
+ * @param config The configuration
+ * @param ret_encoder The encoder, the user data of `mjpeg_stream_hw_encode()`
+ *
+ * @return MJPEG_STREAM_OK, or MJPEG_STREAM_ERR_NO_MEM if the engine can't be created
+ */
+int mjpeg_stream_hw_encoder_new(const mjpeg_stream_hw_encoder_config_t *config,
+                                mjpeg_stream_hw_encoder_t **ret_encoder);
+
+/**
+ * @brief Delete an encoder.
+ *
+ * @param encoder The encoder, can be NULL
+ */
+void mjpeg_stream_hw_encoder_del(mjpeg_stream_hw_encoder_t *encoder);
+
+/**
+ * @brief The encoder of the stream, see `mjpeg_stream_encode_cb_t`. `user_data` is the encoder.
+ */
+int mjpeg_stream_hw_encode(const uint8_t *pixels, size_t len, uint32_t width, uint32_t height, uint8_t *jpeg,
+                           size_t jpeg_size, size_t *jpeg_len, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,688 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "mjpeg_stream.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#define MJPEG_STREAM_LOGI(format, ...)      ESP_LOGI(TAG, format, ##__VA_ARGS__)
+#define MJPEG_STREAM_LOGE(format, ...)      ESP_LOGE(TAG, format, ##__VA_ARGS__)
+#else
+#define MJPEG_STREAM_LOGI(format, ...)      do { } while (0)
+#define MJPEG_STREAM_LOGE(format, ...)      fprintf(stderr, "[%s] " format "\n", TAG, ##__VA_ARGS__)
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL                        (0)
+#endif
+
+#define BOUNDARY                            "mjpegstreamframe"
+#define REQUEST_LEN_MAX                     (512)
+#define PART_HEADER_LEN_MAX                 (96)
+#define SELECT_TIMEOUT_MS                   (100)
+
+static const char *TAG = "mjpeg_stream";
+
+static const char stream_reply[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=" BOUNDARY "\r\n"
+    "Cache-Control: no-cache, no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+static const char bad_request_reply[] = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+static const char not_found_reply[] = "HTTP/1.1 404 Not Found\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+static const char busy_reply[] = "HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+static const char part_trailer[] = "\r\n";
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    /* The clients sending it or about to, the latest frame, and the encoder */
+    int ref_num;
+    char header[PART_HEADER_LEN_MAX];
+    size_t header_len;
+} frame_buf_t;
+
+typedef enum {
+    CLIENT_FREE = 0,
+    CLIENT_REQUEST,     /* Reading the request */
+    CLIENT_STREAM,      /* Sending the frames */
+    CLIENT_CLOSING,     /* Sending an error, then closed */
+} client_state_t;
+
+typedef struct {
+    int fd;
+    client_state_t state;
+    char request[REQUEST_LEN_MAX];
+    size_t request_len;
+    const char *reply;
+    size_t reply_len;
+    size_t reply_offset;
+    /* Only used by the server */
+    frame_buf_t *current;
+    size_t current_offset;
+    /* Replaced by each new frame, taken by the server when the current frame is sent */
+    frame_buf_t *pending;
+    int64_t progress_ms;
+} client_t;
+
+struct mjpeg_stream_t {
+    mjpeg_stream_config_t config;
+    /* Guards the references of the buffers, the pending frames, the states of the clients and the counters */
+    pthread_mutex_t lock;
+    frame_buf_t *bufs;
+    frame_buf_t *latest;
+    client_t *clients;
+    int listen_fd;
+    /* A UDP socket connected to itself, which wakes up the server when a frame is pushed */
+    int wake_fd;
+    uint16_t port;
+    bool stop;
+    pthread_t server;
+    bool has_server;
+    mjpeg_stream_stats_t stats;
+};
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0);
+}
+
+static inline void unref_buf(frame_buf_t *buf)
+{
+    if (buf != NULL) {
+        buf->ref_num--;
+    }
+}
+
+static void *alloc_buf(size_t size)
+{
+#ifdef ESP_PLATFORM
+    /* Aligned to the cache line, so the JPEG encoder can write it by DMA */
+    size_t align = 0;
+    esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &align);
+    align = (align > 0) ? align : 4;
+    return heap_caps_aligned_calloc(align, 1, (size + align - 1) & ~(align - 1), MALLOC_CAP_SPIRAM);
+#else
+    return malloc(size);
+#endif
+}
+
+static void free_buf(void *buf)
+{
+#ifdef ESP_PLATFORM
+    heap_caps_free(buf);
+#else
+    free(buf);
+#endif
+}
+
+static void close_client(mjpeg_stream_t *stream, client_t *client)
+{
+    pthread_mutex_lock(&stream->lock);
+    unref_buf(client->current);
+    unref_buf(client->pending);
+    if (client->state == CLIENT_STREAM) {
+        stream->stats.client_num--;
+    }
+    client->state = CLIENT_FREE;
+    client->current = NULL;
+    client->pending = NULL;
+    pthread_mutex_unlock(&stream->lock);
+
+    close(client->fd);
+    client->fd = -1;
+}
+
+static void set_reply(client_t *client, const char *reply, size_t len)
+{
+    client->reply = reply;
+    client->reply_len = len;
+    client->reply_offset = 0;
+}
+
+/* Reply an error, then close */
+static void reject_client(mjpeg_stream_t *stream, client_t *client, const char *reply, size_t len)
+{
+    set_reply(client, reply, len);
+    pthread_mutex_lock(&stream->lock);
+    client->state = CLIENT_CLOSING;
+    pthread_mutex_unlock(&stream->lock);
+}
+
+static void accept_client(mjpeg_stream_t *stream)
+{
+    int fd = accept(stream->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+
+    client_t *client = NULL;
+    for (int i = 0; i < stream->config.client_max; i++) {
+        if (stream->clients[i].state == CLIENT_FREE) {
+            client = &stream->clients[i];
+            break;
+        }
+    }
+    if ((client == NULL) || !set_nonblocking(fd)) {
+        /* The reply fits in the empty send buffer of the socket */
+        send(fd, busy_reply, sizeof(busy_reply) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(fd);
+        return;
+    }
+
+    if (stream->config.send_buf_size > 0) {
+        /* Not all the stacks have it, lwIP sizes its buffer at build time */
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &stream->config.send_buf_size, sizeof(stream->config.send_buf_size));
+    }
+    client->fd = fd;
+    client->request_len = 0;
+    client->current = NULL;
+    client->pending = NULL;
+    client->progress_ms = now_ms();
+    set_reply(client, NULL, 0);
+    pthread_mutex_lock(&stream->lock);
+    client->state = CLIENT_REQUEST;
+    pthread_mutex_unlock(&stream->lock);
+}
+
+static void parse_request(mjpeg_stream_t *stream, client_t *client)
+{
+    char *end = strstr(client->request, "\r\n\r\n");
+    if (end == NULL) {
+        if (client->request_len >= sizeof(client->request) - 1) {
+            reject_client(stream, client, bad_request_reply, sizeof(bad_request_reply) - 1);
+        }
+        return;
+    }
+
+    /* "GET <uri> HTTP/1.x", the query is ignored */
+    size_t uri_len = strlen(stream->config.uri);
+    if (strncmp(client->request, "GET ", 4) != 0) {
+        reject_client(stream, client, bad_request_reply, sizeof(bad_request_reply) - 1);
+        return;
+    }
+    char *uri = client->request + 4;
+    if ((strncmp(uri, stream->config.uri, uri_len) != 0) || ((uri[uri_len] != ' ') && (uri[uri_len] != '?'))) {
+        reject_client(stream, client, not_found_reply, sizeof(not_found_reply) - 1);
+        return;
+    }
+
+    set_reply(client, stream_reply, sizeof(stream_reply) - 1);
+    /* The latest frame is sent at once, without waiting for the next one */
+    pthread_mutex_lock(&stream->lock);
+    client->state = CLIENT_STREAM;
+    client->pending = stream->latest;
+    if (client->pending != NULL) {
+        client->pending->ref_num++;
+    }
+    stream->stats.client_num++;
+    pthread_mutex_unlock(&stream->lock);
+}
+
+static void receive_client(mjpeg_stream_t *stream, client_t *client)
+{
+    char discard[64];
+    bool is_request = (client->state == CLIENT_REQUEST);
+    char *buf = is_request ? &client->request[client->request_len] : discard;
+    size_t size = is_request ? (sizeof(client->request) - 1 - client->request_len) : sizeof(discard);
+
+    ssize_t len = recv(client->fd, buf, size, MSG_DONTWAIT);
+    if ((len == 0) || ((len < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+        close_client(stream, client);
+        return;
+    }
+    if ((len > 0) && is_request) {
+        client->request_len += len;
+        client->request[client->request_len] = '\0';
+        parse_request(stream, client);
+    }
+}
+
+/* Send as much as the socket takes without blocking, returns false if the client is closed */
+static bool send_client(mjpeg_stream_t *stream, client_t *client)
+{
+    uint64_t sent_byte_num = 0;
+    uint32_t sent_frame_num = 0;
+    bool is_open = true;
+
+    while (true) {
+        struct iovec iov[3];
+        int iov_num = 0;
+        size_t offset = 0;
+
+        if (client->reply_offset < client->reply_len) {
+            iov[iov_num].iov_base = (void *)(client->reply + client->reply_offset);
+            iov[iov_num++].iov_len = client->reply_len - client->reply_offset;
+        } else if (client->state == CLIENT_CLOSING) {
+            is_open = false;
+            break;
+        } else if (client->state != CLIENT_STREAM) {
+            break;
+        } else {
+            if (client->current == NULL) {
+                pthread_mutex_lock(&stream->lock);
+                client->current = client->pending;
+                client->pending = NULL;
+                pthread_mutex_unlock(&stream->lock);
+                client->current_offset = 0;
+                if (client->current == NULL) {
+                    break;
+                }
+            }
+            /* The part header, the JPEG and the trailer, from where the last send stopped */
+            frame_buf_t *buf = client->current;
+            const struct {
+                const void *data;
+                size_t len;
+            } parts[] = {
+                {buf->header, buf->header_len},
+                {buf->data, buf->len},
+                {part_trailer, sizeof(part_trailer) - 1},
+            };
+            for (int i = 0; i < 3; i++) {
+                if (client->current_offset < offset + parts[i].len) {
+                    size_t skip = (client->current_offset > offset) ? (client->current_offset - offset) : 0;
+                    iov[iov_num].iov_base = (void *)((const uint8_t *)parts[i].data + skip);
+                    iov[iov_num++].iov_len = parts[i].len - skip;
+                }
+                offset += parts[i].len;
+            }
+        }
+
+        struct msghdr msg = {
+            .msg_iov = iov,
+            .msg_iovlen = iov_num,
+        };
+        ssize_t len = sendmsg(client->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (len < 0) {
+            is_open = (errno == EAGAIN) || (errno == EWOULDBLOCK);
+            break;
+        }
+        client->progress_ms = now_ms();
+        sent_byte_num += len;
+
+        if (client->reply_offset < client->reply_len) {
+            client->reply_offset += len;
+        } else {
+            client->current_offset += len;
+            if (client->current_offset == offset) {
+                pthread_mutex_lock(&stream->lock);
+                unref_buf(client->current);
+                pthread_mutex_unlock(&stream->lock);
+                client->current = NULL;
+                sent_frame_num++;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    stream->stats.sent_byte_num += sent_byte_num;
+    stream->stats.sent_frame_num += sent_frame_num;
+    pthread_mutex_unlock(&stream->lock);
+
+    if (!is_open) {
+        close_client(stream, client);
+    }
+    return is_open;
+}
+
+static inline bool has_data(client_t *client)
+{
+    /* The pending frame is read without the lock, a frame pushed meanwhile wakes up the server again */
+    return (client->reply_offset < client->reply_len) || (client->current != NULL) ||
+           (__atomic_load_n(&client->pending, __ATOMIC_RELAXED) != NULL);
+}
+
+static void *server_main(void *arg)
+{
+    mjpeg_stream_t *stream = (mjpeg_stream_t *)arg;
+
+    while (true) {
+        pthread_mutex_lock(&stream->lock);
+        bool stop = stream->stop;
+        pthread_mutex_unlock(&stream->lock);
+        if (stop) {
+            break;
+        }
+
+        fd_set read_fds;
+        fd_set write_fds;
+        int max_fd = (stream->listen_fd > stream->wake_fd) ? stream->listen_fd : stream->wake_fd;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(stream->listen_fd, &read_fds);
+        FD_SET(stream->wake_fd, &read_fds);
+        for (int i = 0; i < stream->config.client_max; i++) {
+            client_t *client = &stream->clients[i];
+            if (client->state == CLIENT_FREE) {
+                continue;
+            }
+            FD_SET(client->fd, &read_fds);
+            if (has_data(client)) {
+                FD_SET(client->fd, &write_fds);
+            }
+            max_fd = (client->fd > max_fd) ? client->fd : max_fd;
+        }
+
+        struct timeval timeout = {
+            .tv_sec = 0,
+            .tv_usec = SELECT_TIMEOUT_MS * 1000,
+        };
+        int ready_num = select(max_fd + 1, &read_fds, &write_fds, NULL, &timeout);
+        if ((ready_num < 0) && (errno != EINTR)) {
+            MJPEG_STREAM_LOGE("select failed: %d", errno);
+            break;
+        }
+        if (ready_num <= 0) {
+            FD_ZERO(&read_fds);
+            FD_ZERO(&write_fds);
+        }
+
+        if (FD_ISSET(stream->wake_fd, &read_fds)) {
+            char wake[16];
+            while (recv(stream->wake_fd, wake, sizeof(wake), MSG_DONTWAIT) > 0) {
+            }
+        }
+        if (FD_ISSET(stream->listen_fd, &read_fds)) {
+            accept_client(stream);
+        }
+
+        int64_t now = now_ms();
+        for (int i = 0; i < stream->config.client_max; i++) {
+            client_t *client = &stream->clients[i];
+            if ((client->state == CLIENT_FREE) || !FD_ISSET(client->fd, &read_fds)) {
+                continue;
+            }
+            receive_client(stream, client);
+        }
+        for (int i = 0; i < stream->config.client_max; i++) {
+            client_t *client = &stream->clients[i];
+            if (client->state == CLIENT_FREE) {
+                continue;
+            }
+            /* A new frame is sent at once, the socket is likely to take it */
+            if ((FD_ISSET(client->fd, &write_fds) || has_data(client)) && !send_client(stream, client)) {
+                continue;
+            }
+            if (has_data(client) && (now - client->progress_ms > stream->config.client_timeout_ms)) {
+                MJPEG_STREAM_LOGI("client %d timed out", i);
+                close_client(stream, client);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static bool start_server(mjpeg_stream_t *stream)
+{
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t prev_cfg;
+    bool has_prev_cfg = (esp_pthread_get_cfg(&prev_cfg) == ESP_OK);
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = stream->config.stack_size;
+    cfg.prio = stream->config.priority;
+    cfg.thread_name = "mjpeg_stream";
+    cfg.pin_to_core = tskNO_AFFINITY;
+    esp_pthread_set_cfg(&cfg);
+#endif
+
+    stream->has_server = (pthread_create(&stream->server, NULL, server_main, stream) == 0);
+
+#ifdef ESP_PLATFORM
+    if (has_prev_cfg) {
+        esp_pthread_set_cfg(&prev_cfg);
+    } else {
+        esp_pthread_cfg_t restore_cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&restore_cfg);
+    }
+#endif
+
+    return stream->has_server;
+}
+
+static int open_sockets(mjpeg_stream_t *stream)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(stream->config.port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    socklen_t addr_len = sizeof(addr);
+    int reuse = 1;
+
+    stream->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if ((stream->listen_fd < 0) ||
+            (setsockopt(stream->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) ||
+            (bind(stream->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            (listen(stream->listen_fd, stream->config.client_max) != 0) ||
+            !set_nonblocking(stream->listen_fd) ||
+            (getsockname(stream->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0)) {
+        MJPEG_STREAM_LOGE("listen on port %d failed: %d", stream->config.port, errno);
+        return MJPEG_STREAM_ERR_SOCKET;
+    }
+    stream->port = ntohs(addr.sin_port);
+
+    struct sockaddr_in wake_addr = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    addr_len = sizeof(wake_addr);
+    stream->wake_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if ((stream->wake_fd < 0) ||
+            (bind(stream->wake_fd, (struct sockaddr *)&wake_addr, sizeof(wake_addr)) != 0) ||
+            (getsockname(stream->wake_fd, (struct sockaddr *)&wake_addr, &addr_len) != 0) ||
+            (connect(stream->wake_fd, (struct sockaddr *)&wake_addr, sizeof(wake_addr)) != 0) ||
+            !set_nonblocking(stream->wake_fd)) {
+        MJPEG_STREAM_LOGE("wake socket failed: %d", errno);
+        return MJPEG_STREAM_ERR_SOCKET;
+    }
+
+    return MJPEG_STREAM_OK;
+}
+
+int mjpeg_stream_new(const mjpeg_stream_config_t *config, mjpeg_stream_t **ret_stream)
+{
+    if ((config == NULL) || (ret_stream == NULL) || (config->encode == NULL) || (config->uri == NULL) ||
+            (config->client_max == 0) || (config->frame_buf_num < 2) || (config->frame_buf_size == 0)) {
+        return MJPEG_STREAM_ERR_INVALID;
+    }
+
+    mjpeg_stream_t *stream = calloc(1, sizeof(mjpeg_stream_t));
+    if (stream == NULL) {
+        return MJPEG_STREAM_ERR_NO_MEM;
+    }
+    stream->config = *config;
+    stream->listen_fd = -1;
+    stream->wake_fd = -1;
+    pthread_mutex_init(&stream->lock, NULL);
+
+    int ret = MJPEG_STREAM_ERR_NO_MEM;
+    stream->bufs = calloc(config->frame_buf_num, sizeof(frame_buf_t));
+    stream->clients = calloc(config->client_max, sizeof(client_t));
+    if ((stream->bufs == NULL) || (stream->clients == NULL)) {
+        goto err;
+    }
+    for (int i = 0; i < config->frame_buf_num; i++) {
+        stream->bufs[i].data = alloc_buf(config->frame_buf_size);
+        if (stream->bufs[i].data == NULL) {
+            goto err;
+        }
+    }
+    for (int i = 0; i < config->client_max; i++) {
+        stream->clients[i].fd = -1;
+    }
+
+    ret = open_sockets(stream);
+    if (ret != MJPEG_STREAM_OK) {
+        goto err;
+    }
+    if (!start_server(stream)) {
+        ret = MJPEG_STREAM_ERR_NO_MEM;
+        goto err;
+    }
+    MJPEG_STREAM_LOGI("serving http://<ip>:%d%s", stream->port, config->uri);
+
+    *ret_stream = stream;
+    return MJPEG_STREAM_OK;
+
+err:
+    mjpeg_stream_del(stream);
+    return ret;
+}
+
+void mjpeg_stream_del(mjpeg_stream_t *stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+
+    if (stream->has_server) {
+        pthread_mutex_lock(&stream->lock);
+        stream->stop = true;
+        pthread_mutex_unlock(&stream->lock);
+        send(stream->wake_fd, "", 1, MSG_DONTWAIT);
+        pthread_join(stream->server, NULL);
+    }
+
+    for (int i = 0; (stream->clients != NULL) && (i < stream->config.client_max); i++) {
+        if (stream->clients[i].state != CLIENT_FREE) {
+            close_client(stream, &stream->clients[i]);
+        }
+    }
+    if (stream->listen_fd >= 0) {
+        close(stream->listen_fd);
+    }
+    if (stream->wake_fd >= 0) {
+        close(stream->wake_fd);
+    }
+    for (int i = 0; (stream->bufs != NULL) && (i < stream->config.frame_buf_num); i++) {
+        free_buf(stream->bufs[i].data);
+    }
+    free(stream->bufs);
+    free(stream->clients);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream);
+}
+
+uint16_t mjpeg_stream_get_port(const mjpeg_stream_t *stream)
+{
+    return stream->port;
+}
+
+static frame_buf_t *find_free_buf(mjpeg_stream_t *stream)
+{
+    for (int i = 0; i < stream->config.frame_buf_num; i++) {
+        if (stream->bufs[i].ref_num == 0) {
+            return &stream->bufs[i];
+        }
+    }
+    return NULL;
+}
+
+bool mjpeg_stream_is_wanted(mjpeg_stream_t *stream)
+{
+    pthread_mutex_lock(&stream->lock);
+    bool is_wanted = (stream->stats.client_num > 0) && (find_free_buf(stream) != NULL);
+    pthread_mutex_unlock(&stream->lock);
+
+    return is_wanted;
+}
+
+int mjpeg_stream_push_frame(mjpeg_stream_t *stream, const uint8_t *pixels, size_t len, uint32_t width,
+                            uint32_t height)
+{
+    if ((stream == NULL) || (pixels == NULL)) {
+        return MJPEG_STREAM_ERR_INVALID;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    if (stream->stats.client_num == 0) {
+        pthread_mutex_unlock(&stream->lock);
+        return MJPEG_STREAM_ERR_BUSY;
+    }
+    frame_buf_t *buf = find_free_buf(stream);
+    if (buf == NULL) {
+        stream->stats.busy_num++;
+        pthread_mutex_unlock(&stream->lock);
+        return MJPEG_STREAM_ERR_BUSY;
+    }
+    /* Held by the encoder, then by the latest frame */
+    buf->ref_num = 1;
+    pthread_mutex_unlock(&stream->lock);
+
+    size_t jpeg_len = 0;
+    int ret = stream->config.encode(pixels, len, width, height, buf->data, stream->config.frame_buf_size,
+                                    &jpeg_len, stream->config.user_data);
+    if ((ret == 0) && (jpeg_len > 0) && (jpeg_len <= stream->config.frame_buf_size)) {
+        buf->len = jpeg_len;
+        buf->header_len = snprintf(buf->header, sizeof(buf->header),
+                                   "--" BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                                   (unsigned int)jpeg_len);
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    if ((ret != 0) || (jpeg_len == 0) || (jpeg_len > stream->config.frame_buf_size)) {
+        buf->ref_num = 0;
+        stream->stats.error_num++;
+        pthread_mutex_unlock(&stream->lock);
+        return MJPEG_STREAM_ERR_ENCODE;
+    }
+    stream->stats.frame_num++;
+    unref_buf(stream->latest);
+    stream->latest = buf;
+    /* A client gets the latest frame only, the one it was waiting for is dropped */
+    for (int i = 0; i < stream->config.client_max; i++) {
+        client_t *client = &stream->clients[i];
+        if (client->state != CLIENT_STREAM) {
+            continue;
+        }
+        if (client->pending != NULL) {
+            unref_buf(client->pending);
+            stream->stats.skipped_frame_num++;
+        }
+        buf->ref_num++;
+        __atomic_store_n(&client->pending, buf, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    send(stream->wake_fd, "", 1, MSG_DONTWAIT);
+
+    return MJPEG_STREAM_OK;
+}
+
+void mjpeg_stream_get_stats(mjpeg_stream_t *stream, mjpeg_stream_stats_t *stats)
+{
+    pthread_mutex_lock(&stream->lock);
+    *stats = stream->stats;
+    pthread_mutex_unlock(&stream->lock);
+}
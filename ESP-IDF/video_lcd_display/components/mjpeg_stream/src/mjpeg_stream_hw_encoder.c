@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include "esp_log.h"
+#include "mjpeg_stream_hw_encoder.h"
+
+static const char *TAG = "mjpeg_hw_enc";
+
+struct mjpeg_stream_hw_encoder_t {
+    mjpeg_stream_hw_encoder_config_t config;
+    jpeg_encoder_handle_t engine;
+};
+
+int mjpeg_stream_hw_encoder_new(const mjpeg_stream_hw_encoder_config_t *config,
+                                mjpeg_stream_hw_encoder_t **ret_encoder)
+{
+    if ((config == NULL) || (ret_encoder == NULL) || (config->quality == 0) || (config->quality > 100)) {
+        return MJPEG_STREAM_ERR_INVALID;
+    }
+
+    mjpeg_stream_hw_encoder_t *encoder = calloc(1, sizeof(mjpeg_stream_hw_encoder_t));
+    if (encoder == NULL) {
+        return MJPEG_STREAM_ERR_NO_MEM;
+    }
+    encoder->config = *config;
+
+    jpeg_encode_engine_cfg_t engine_config = {
+        .intr_priority = 0,
+        .timeout_ms = config->timeout_ms,
+    };
+    esp_err_t ret = jpeg_new_encoder_engine(&engine_config, &encoder->engine);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "create the engine failed: %s", esp_err_to_name(ret));
+        free(encoder);
+        return MJPEG_STREAM_ERR_NO_MEM;
+    }
+
+    *ret_encoder = encoder;
+    return MJPEG_STREAM_OK;
+}
+
+void mjpeg_stream_hw_encoder_del(mjpeg_stream_hw_encoder_t *encoder)
+{
+    if (encoder == NULL) {
+        return;
+    }
+
+    jpeg_del_encoder_engine(encoder->engine);
+    free(encoder);
+}
+
+int mjpeg_stream_hw_encode(const uint8_t *pixels, size_t len, uint32_t width, uint32_t height, uint8_t *jpeg,
+                           size_t jpeg_size, size_t *jpeg_len, void *user_data)
+{
+    mjpeg_stream_hw_encoder_t *encoder = (mjpeg_stream_hw_encoder_t *)user_data;
+    jpeg_encode_cfg_t encode_config = {
+        .height = height,
+        .width = width,
+        .src_type = encoder->config.src_type,
+        .sub_sample = encoder->config.sub_sample,
+        .image_quality = encoder->config.quality,
+    };
+    uint32_t out_len = 0;
+
+    /* The pixels are read by DMA from the buffer of the camera, there is no copy of the frame */
+    esp_err_t ret = jpeg_encoder_process(encoder->engine, &encode_config, pixels, len, jpeg, jpeg_size, &out_len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "encode failed: %s", esp_err_to_name(ret));
+        return MJPEG_STREAM_ERR_ENCODE;
+    }
+    *jpeg_len = out_len;
+
+    return MJPEG_STREAM_OK;
+}
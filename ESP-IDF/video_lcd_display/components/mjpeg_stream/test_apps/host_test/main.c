@@ -0,0 +1,577 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Serve synthetic frames over the loopback to clients which parse the multipart stream and check each JPEG, fast and
+ * slow ones, then measure the frames and the bytes per second for 1, 4 and 8 clients. See README.md.
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "mjpeg_stream.h"
+
+#define TEST_CHECK(x, ...)  do {                    \
+        if (!(x)) {                                 \
+            fprintf(stderr, "[%s:%d] ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);           \
+            fprintf(stderr, "\n");                  \
+            return false;                           \
+        }                                           \
+    } while (0)
+
+#define TEST_WIDTH                  (1280)
+#define TEST_HEIGHT                 (720)
+#define TEST_PIXELS_LEN             (TEST_WIDTH * TEST_HEIGHT * 2)
+#define TEST_JPEG_LEN               (96 * 1024)
+#define TEST_CLIENT_MAX             (8)
+#define TEST_READER_BUF_SIZE        (64 * 1024)
+#define TEST_BENCH_MS               (2000)
+
+/* The frames of the synthetic encoder: SOI, the sequence number, a pattern of it, and EOI */
+static size_t test_jpeg_len(uint32_t seq)
+{
+    return TEST_JPEG_LEN + (seq % 7) * 1000;
+}
+
+static inline uint8_t test_jpeg_byte(uint32_t seq, size_t i)
+{
+    return (uint8_t)(seq * 31 + i);
+}
+
+static atomic_int encode_num;
+
+static int test_encode(const uint8_t *pixels, size_t len, uint32_t width, uint32_t height, uint8_t *jpeg,
+                       size_t jpeg_size, size_t *jpeg_len, void *user_data)
+{
+    (void)width;
+    (void)height;
+    (void)user_data;
+    uint32_t seq;
+
+    if (len < sizeof(seq)) {
+        return -1;
+    }
+    memcpy(&seq, pixels, sizeof(seq));
+    size_t out_len = test_jpeg_len(seq);
+    if (out_len > jpeg_size) {
+        return -1;
+    }
+
+    jpeg[0] = 0xff;
+    jpeg[1] = 0xd8;
+    memcpy(&jpeg[2], &seq, sizeof(seq));
+    for (size_t i = 6; i < out_len - 2; i++) {
+        jpeg[i] = test_jpeg_byte(seq, i);
+    }
+    jpeg[out_len - 2] = 0xff;
+    jpeg[out_len - 1] = 0xd9;
+    *jpeg_len = out_len;
+    atomic_fetch_add(&encode_num, 1);
+
+    return 0;
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_us(int64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = us / 1000000,
+        .tv_nsec = (long)(us % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+typedef struct {
+    uint16_t port;
+    const char *request;
+    int rcvbuf;                 /* The receive buffer of the socket, 0 for the default */
+    int read_size;              /* The bytes of a read, and the pause after it, to read slowly */
+    int read_pause_us;
+    bool check_all;             /* Check each byte of the frames, else a few of them */
+    atomic_bool stop;
+    /* Results */
+    int status;
+    atomic_int frame_num;
+    int bad_frame_num;
+    uint64_t byte_num;
+    uint32_t last_seq;
+    bool is_closed;
+    pthread_t thread;
+} test_client_t;
+
+typedef struct {
+    int fd;
+    test_client_t *client;
+    uint8_t buf[TEST_READER_BUF_SIZE];
+    size_t start;
+    size_t end;
+} test_reader_t;
+
+static bool reader_fill(test_reader_t *reader)
+{
+    if (reader->start == reader->end) {
+        reader->start = reader->end = 0;
+    } else if (reader->start > 0) {
+        memmove(reader->buf, &reader->buf[reader->start], reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+
+    test_client_t *client = reader->client;
+    size_t size = sizeof(reader->buf) - reader->end;
+    if ((client->read_size > 0) && (size > (size_t)client->read_size)) {
+        size = client->read_size;
+    }
+    ssize_t len = recv(reader->fd, &reader->buf[reader->end], size, 0);
+    if (len <= 0) {
+        return false;
+    }
+    reader->end += len;
+    client->byte_num += len;
+    if (client->read_pause_us > 0) {
+        sleep_us(client->read_pause_us);
+    }
+    return true;
+}
+
+static bool reader_line(test_reader_t *reader, char *line, size_t size)
+{
+    while (true) {
+        uint8_t *eol = memchr(&reader->buf[reader->start], '\n', reader->end - reader->start);
+        if (eol != NULL) {
+            size_t len = eol - &reader->buf[reader->start] + 1;
+            size_t copy_len = (len < size) ? len : (size - 1);
+            memcpy(line, &reader->buf[reader->start], copy_len);
+            line[copy_len] = '\0';
+            reader->start += len;
+            return true;
+        }
+        if (!reader_fill(reader)) {
+            return false;
+        }
+    }
+}
+
+/* Read a JPEG and check it, bytes of the stream are consumed as they come */
+static bool reader_jpeg(test_reader_t *reader, size_t len, bool check_all, uint32_t *seq, bool *is_valid)
+{
+    uint8_t head[6];
+    size_t pos = 0;
+    *is_valid = true;
+
+    while (pos < len) {
+        if ((reader->start == reader->end) && !reader_fill(reader)) {
+            return false;
+        }
+        size_t chunk = reader->end - reader->start;
+        chunk = (chunk < len - pos) ? chunk : (len - pos);
+        const uint8_t *data = &reader->buf[reader->start] - pos;
+        size_t end = pos + chunk;
+        for (size_t index = pos; index < end; index++) {
+            if (index < sizeof(head)) {
+                head[index] = data[index];
+                if (index == sizeof(head) - 1) {
+                    memcpy(seq, &head[2], sizeof(*seq));
+                    *is_valid &= (head[0] == 0xff) && (head[1] == 0xd8) && (len == test_jpeg_len(*seq));
+                }
+            } else if (index >= len - 2) {
+                *is_valid &= (data[index] == ((index == len - 2) ? 0xff : 0xd9));
+            } else if (check_all) {
+                *is_valid &= (data[index] == test_jpeg_byte(*seq, index));
+            } else {
+                /* A byte in each 4 KB, up to the tail */
+                if (index % 4096 == 0) {
+                    *is_valid &= (data[index] == test_jpeg_byte(*seq, index));
+                }
+                size_t next = (index | 4095) + 1;
+                next = (next < len - 2) ? next : (len - 2);
+                index = ((next < end) ? next : end) - 1;
+            }
+        }
+        reader->start += chunk;
+        pos += chunk;
+    }
+    return true;
+}
+
+static void *client_main(void *arg)
+{
+    test_client_t *client = (test_client_t *)arg;
+    test_reader_t *reader = calloc(1, sizeof(test_reader_t));
+    char line[256];
+
+    client->status = -1;
+    client->is_closed = true;
+    reader->client = client;
+    reader->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (client->rcvbuf > 0) {
+        setsockopt(reader->fd, SOL_SOCKET, SO_RCVBUF, &client->rcvbuf, sizeof(client->rcvbuf));
+    }
+    struct timeval timeout = {
+        .tv_sec = 2,
+    };
+    setsockopt(reader->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(client->port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if ((connect(reader->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            (send(reader->fd, client->request, strlen(client->request), MSG_NOSIGNAL) < 0) ||
+            !reader_line(reader, line, sizeof(line))) {
+        goto end;
+    }
+    sscanf(line, "HTTP/1.1 %d", &client->status);
+    while (reader_line(reader, line, sizeof(line)) && (strcmp(line, "\r\n") != 0)) {
+    }
+    if (client->status != 200) {
+        /* The server closes after an error */
+        client->is_closed = !reader_fill(reader);
+        goto end;
+    }
+
+    client->is_closed = false;
+    while (!atomic_load(&client->stop)) {
+        size_t len = 0;
+        uint32_t seq = 0;
+        bool is_valid = false;
+        /* "--boundary", the headers, an empty line, the JPEG and "\r\n" */
+        if (!reader_line(reader, line, sizeof(line)) || (strncmp(line, "--", 2) != 0)) {
+            client->is_closed = true;
+            break;
+        }
+        while (reader_line(reader, line, sizeof(line)) && (strcmp(line, "\r\n") != 0)) {
+            sscanf(line, "Content-Length: %zu", &len);
+        }
+        if ((len == 0) || !reader_jpeg(reader, len, client->check_all, &seq, &is_valid) ||
+                !reader_line(reader, line, sizeof(line))) {
+            client->is_closed = true;
+            break;
+        }
+        /* The frames are in order, some may be skipped */
+        if (!is_valid || ((client->frame_num > 0) && (seq <= client->last_seq))) {
+            client->bad_frame_num++;
+        }
+        client->last_seq = seq;
+        atomic_fetch_add(&client->frame_num, 1);
+    }
+
+end:
+    close(reader->fd);
+    free(reader);
+    return NULL;
+}
+
+static void start_client(test_client_t *client, uint16_t port, const char *request)
+{
+    client->port = port;
+    client->request = (request != NULL) ? request : "GET /stream HTTP/1.1\r\nHost: test\r\n\r\n";
+    atomic_store(&client->stop, false);
+    pthread_create(&client->thread, NULL, client_main, client);
+}
+
+static void stop_client(test_client_t *client)
+{
+    atomic_store(&client->stop, true);
+    pthread_join(client->thread, NULL);
+}
+
+static uint32_t wait_client_num(mjpeg_stream_t *stream, uint32_t num)
+{
+    mjpeg_stream_stats_t stats = {};
+
+    for (int i = 0; i < 200; i++) {
+        mjpeg_stream_get_stats(stream, &stats);
+        if (stats.client_num == num) {
+            break;
+        }
+        sleep_us(10000);
+    }
+    return stats.client_num;
+}
+
+static mjpeg_stream_t *new_stream(int client_max, uint32_t client_timeout_ms)
+{
+    mjpeg_stream_config_t config = MJPEG_STREAM_DEFAULT_CONFIG();
+    mjpeg_stream_t *stream = NULL;
+
+    config.port = 0;
+    config.client_max = client_max;
+    config.frame_buf_num = client_max + 2;
+    config.frame_buf_size = TEST_JPEG_LEN + 8 * 1024;
+    config.client_timeout_ms = client_timeout_ms;
+    config.send_buf_size = 64 * 1024;
+    config.encode = test_encode;
+
+    return (mjpeg_stream_new(&config, &stream) == MJPEG_STREAM_OK) ? stream : NULL;
+}
+
+static uint8_t *new_pixels(void)
+{
+    return calloc(1, TEST_PIXELS_LEN);
+}
+
+static int push_frame(mjpeg_stream_t *stream, uint8_t *pixels, uint32_t seq)
+{
+    memcpy(pixels, &seq, sizeof(seq));
+    return mjpeg_stream_push_frame(stream, pixels, TEST_PIXELS_LEN, TEST_WIDTH, TEST_HEIGHT);
+}
+
+static bool test_http(void)
+{
+    static test_client_t clients[4];
+    memset(clients, 0, sizeof(clients));
+    mjpeg_stream_t *stream = new_stream(1, 5000);
+    TEST_CHECK(stream != NULL, "no stream");
+    uint16_t port = mjpeg_stream_get_port(stream);
+    uint8_t *pixels = new_pixels();
+
+    TEST_CHECK(push_frame(stream, pixels, 1) == MJPEG_STREAM_ERR_BUSY, "a frame encoded without client");
+    TEST_CHECK(!mjpeg_stream_is_wanted(stream), "a frame wanted without client");
+
+    start_client(&clients[0], port, "GET /other HTTP/1.1\r\n\r\n");
+    stop_client(&clients[0]);
+    TEST_CHECK((clients[0].status == 404) && clients[0].is_closed, "other path: %d", clients[0].status);
+    start_client(&clients[1], port, "POST /stream HTTP/1.1\r\n\r\n");
+    stop_client(&clients[1]);
+    TEST_CHECK((clients[1].status == 400) && clients[1].is_closed, "post: %d", clients[1].status);
+
+    start_client(&clients[2], port, "GET /stream?fps=30 HTTP/1.1\r\n\r\n");
+    TEST_CHECK(wait_client_num(stream, 1) == 1, "client not streaming");
+    TEST_CHECK(mjpeg_stream_is_wanted(stream), "a frame not wanted with a client");
+    start_client(&clients[3], port, NULL);
+    stop_client(&clients[3]);
+    TEST_CHECK((clients[3].status == 503) && clients[3].is_closed, "client above the max: %d", clients[3].status);
+
+    TEST_CHECK(push_frame(stream, pixels, 1) == MJPEG_STREAM_OK, "frame not pushed");
+    for (int i = 0; (i < 200) && (clients[2].frame_num == 0); i++) {
+        sleep_us(10000);
+    }
+    stop_client(&clients[2]);
+    TEST_CHECK(clients[2].status == 200, "stream: %d", clients[2].status);
+    TEST_CHECK((clients[2].frame_num == 1) && (clients[2].bad_frame_num == 0) && (clients[2].last_seq == 1),
+               "%d frames, %d bad", clients[2].frame_num, clients[2].bad_frame_num);
+    TEST_CHECK(wait_client_num(stream, 0) == 0, "client not closed");
+
+    mjpeg_stream_del(stream);
+    free(pixels);
+    return true;
+}
+
+static bool test_fan_out(void)
+{
+    static test_client_t clients[4];
+    memset(clients, 0, sizeof(clients));
+    const int frame_num = 100;
+    mjpeg_stream_t *stream = new_stream(4, 5000);
+    TEST_CHECK(stream != NULL, "no stream");
+    uint8_t *pixels = new_pixels();
+
+    for (int i = 0; i < 4; i++) {
+        clients[i].check_all = true;
+        start_client(&clients[i], mjpeg_stream_get_port(stream), NULL);
+    }
+    TEST_CHECK(wait_client_num(stream, 4) == 4, "clients not streaming");
+
+    atomic_store(&encode_num, 0);
+    /* Paced, so fast clients get every frame */
+    for (uint32_t seq = 1; seq <= (uint32_t)frame_num; seq++) {
+        TEST_CHECK(push_frame(stream, pixels, seq) == MJPEG_STREAM_OK, "frame %u not pushed", seq);
+        sleep_us(5000);
+    }
+    sleep_us(100000);
+
+    mjpeg_stream_stats_t stats;
+    mjpeg_stream_get_stats(stream, &stats);
+    for (int i = 0; i < 4; i++) {
+        stop_client(&clients[i]);
+        TEST_CHECK((clients[i].frame_num == frame_num) && (clients[i].bad_frame_num == 0),
+                   "client %d: %d frames, %d bad", i, clients[i].frame_num, clients[i].bad_frame_num);
+    }
+    printf("%d frames: %d encoded, %llu sent, %llu bytes\n", frame_num, atomic_load(&encode_num),
+           (unsigned long long)stats.sent_frame_num, (unsigned long long)stats.sent_byte_num);
+    /* Encoded once, sent to each client */
+    TEST_CHECK(atomic_load(&encode_num) == frame_num, "%d encodes", atomic_load(&encode_num));
+    TEST_CHECK(stats.sent_frame_num == (uint64_t)frame_num * 4, "%llu frames sent",
+               (unsigned long long)stats.sent_frame_num);
+
+    mjpeg_stream_del(stream);
+    free(pixels);
+    return true;
+}
+
+static bool test_backpressure(void)
+{
+    static test_client_t clients[2];
+    memset(clients, 0, sizeof(clients));
+    mjpeg_stream_t *stream = new_stream(2, 5000);
+    TEST_CHECK(stream != NULL, "no stream");
+    uint8_t *pixels = new_pixels();
+
+    /* A client reading about 1 MB/s, about 10 frames per second, and a fast one */
+    clients[0].check_all = true;
+    clients[0].rcvbuf = 16 * 1024;
+    clients[0].read_size = 4 * 1024;
+    clients[0].read_pause_us = 4000;
+    clients[1].check_all = true;
+    for (int i = 0; i < 2; i++) {
+        start_client(&clients[i], mjpeg_stream_get_port(stream), NULL);
+    }
+    TEST_CHECK(wait_client_num(stream, 2) == 2, "clients not streaming");
+
+    int pushed_num = 0;
+    int64_t end_us = now_us() + 1000000;
+    for (uint32_t seq = 1; now_us() < end_us; seq++) {
+        pushed_num += (push_frame(stream, pixels, seq) == MJPEG_STREAM_OK) ? 1 : 0;
+        sleep_us(2000);
+    }
+    sleep_us(100000);
+
+    mjpeg_stream_stats_t stats;
+    mjpeg_stream_get_stats(stream, &stats);
+    for (int i = 0; i < 2; i++) {
+        stop_client(&clients[i]);
+        TEST_CHECK(clients[i].bad_frame_num == 0, "client %d: %d bad frames", i, clients[i].bad_frame_num);
+    }
+    printf("%d frames pushed: %d to the slow client, %d to the fast one, %llu skipped, %u busy\n", pushed_num,
+           clients[0].frame_num, clients[1].frame_num, (unsigned long long)stats.skipped_frame_num,
+           stats.busy_num);
+    /* The slow client skips frames, without slowing down the other one */
+    TEST_CHECK(clients[0].frame_num > 0, "the slow client got nothing");
+    TEST_CHECK(clients[0].frame_num * 4 < pushed_num, "the slow client was queued %d frames", clients[0].frame_num);
+    TEST_CHECK(clients[1].frame_num * 10 >= pushed_num * 9, "the fast client got %d frames of %d",
+               clients[1].frame_num, pushed_num);
+    TEST_CHECK(stats.busy_num == 0, "%u frames dropped for all", stats.busy_num);
+    TEST_CHECK(stats.skipped_frame_num > 0, "no frame skipped");
+
+    mjpeg_stream_del(stream);
+    free(pixels);
+    return true;
+}
+
+static bool test_timeout(void)
+{
+    test_client_t client = {};
+    mjpeg_stream_t *stream = new_stream(1, 300);
+    TEST_CHECK(stream != NULL, "no stream");
+    uint8_t *pixels = new_pixels();
+
+    /* It reads the reply and a few bytes, then stops reading */
+    client.rcvbuf = 4 * 1024;
+    client.read_size = 1024;
+    client.read_pause_us = 3000000;
+    start_client(&client, mjpeg_stream_get_port(stream), NULL);
+    TEST_CHECK(wait_client_num(stream, 1) == 1, "client not streaming");
+
+    mjpeg_stream_stats_t stats;
+    int64_t start_us = now_us();
+    for (uint32_t seq = 1; seq < 200; seq++) {
+        mjpeg_stream_get_stats(stream, &stats);
+        if (stats.client_num == 0) {
+            break;
+        }
+        push_frame(stream, pixels, seq);
+        sleep_us(10000);
+    }
+    int64_t closed_ms = (now_us() - start_us) / 1000;
+    TEST_CHECK(stats.client_num == 0, "the stuck client is not closed");
+    printf("the stuck client is closed after %lld ms, %llu bytes sent\n", (long long)closed_ms,
+           (unsigned long long)stats.sent_byte_num);
+    TEST_CHECK(closed_ms < 1000, "the stuck client is closed after %lld ms", (long long)closed_ms);
+    TEST_CHECK(mjpeg_stream_push_frame(stream, pixels, TEST_PIXELS_LEN, TEST_WIDTH, TEST_HEIGHT) ==
+               MJPEG_STREAM_ERR_BUSY, "a frame encoded without client");
+    stop_client(&client);
+
+    mjpeg_stream_del(stream);
+    free(pixels);
+    return true;
+}
+
+static bool test_bench(void)
+{
+    static const int client_nums[] = {1, 4, 8};
+    static test_client_t clients[TEST_CLIENT_MAX];
+    uint8_t *pixels = new_pixels();
+
+    printf("| Clients | Encoded FPS | FPS per client | Sent MB/s | Skipped |\n");
+    for (size_t n = 0; n < sizeof(client_nums) / sizeof(client_nums[0]); n++) {
+        int client_num = client_nums[n];
+        memset(clients, 0, sizeof(clients));
+        mjpeg_stream_t *stream = new_stream(client_num, 5000);
+        TEST_CHECK(stream != NULL, "no stream");
+        for (int i = 0; i < client_num; i++) {
+            start_client(&clients[i], mjpeg_stream_get_port(stream), NULL);
+        }
+        TEST_CHECK(wait_client_num(stream, client_num) == (uint32_t)client_num, "clients not streaming");
+
+        /* As fast as the buffers are sent */
+        int64_t start_us = now_us();
+        int64_t end_us = start_us + TEST_BENCH_MS * 1000;
+        for (uint32_t seq = 1; now_us() < end_us; seq++) {
+            if (push_frame(stream, pixels, seq) != MJPEG_STREAM_OK) {
+                sleep_us(100);
+            }
+        }
+        double elapsed_s = (now_us() - start_us) / 1000000.0;
+        mjpeg_stream_stats_t stats;
+        mjpeg_stream_get_stats(stream, &stats);
+
+        int frame_num = 0;
+        for (int i = 0; i < client_num; i++) {
+            stop_client(&clients[i]);
+            TEST_CHECK((clients[i].frame_num > 0) && (clients[i].bad_frame_num == 0), "client %d: %d frames, %d bad",
+                       i, clients[i].frame_num, clients[i].bad_frame_num);
+            frame_num += clients[i].frame_num;
+        }
+        printf("| %d | %.0f | %.0f | %.0f | %llu |\n", client_num, stats.frame_num / elapsed_s,
+               frame_num / elapsed_s / client_num, stats.sent_byte_num / elapsed_s / 1e6,
+               (unsigned long long)stats.skipped_frame_num);
+        mjpeg_stream_del(stream);
+    }
+
+    free(pixels);
+    return true;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*func)(void);
+    } tests[] = {
+        {"http", test_http},
+        {"fan_out", test_fan_out},
+        {"backpressure", test_backpressure},
+        {"timeout", test_timeout},
+        {"bench", test_bench},
+    };
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        bool ok = tests[i].func();
+        printf("%s: %s\n", tests[i].name, ok ? "OK" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
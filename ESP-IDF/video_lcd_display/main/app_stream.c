@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#include "esp_check.h"
+#include "esp_eth.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "ethernet_init.h"
+#include "mjpeg_stream.h"
+#include "mjpeg_stream_hw_encoder.h"
+#include "app_video.h"
+#include "app_stream.h"
+
+static const char *TAG = "app_stream";
+
+static mjpeg_stream_hw_encoder_t *stream_encoder;
+static mjpeg_stream_t *stream;
+
+static void got_ip_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+
+    ESP_LOGI(TAG, "stream on http://" IPSTR ":%d/stream", IP2STR(&event->ip_info.ip), CONFIG_EXAMPLE_MJPEG_STREAM_PORT);
+}
+
+static esp_err_t app_stream_eth_init(void)
+{
+    uint8_t eth_port_cnt = 0;
+    esp_eth_handle_t *eth_handles;
+    ESP_RETURN_ON_ERROR(example_eth_init(&eth_handles, &eth_port_cnt), TAG, "ethernet init failed");
+    if (eth_port_cnt == 0) {
+        ESP_LOGE(TAG, "no ethernet port");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_RETURN_ON_ERROR(esp_netif_init(), TAG, "netif init failed");
+    esp_err_t ret = esp_event_loop_create_default();
+    if ((ret != ESP_OK) && (ret != ESP_ERR_INVALID_STATE)) {
+        return ret;
+    }
+
+    // The stream is served on the first port
+    esp_netif_config_t cfg = ESP_NETIF_DEFAULT_ETH();
+    esp_netif_t *eth_netif = esp_netif_new(&cfg);
+    ESP_RETURN_ON_ERROR(esp_netif_attach(eth_netif, esp_eth_new_netif_glue(eth_handles[0])), TAG, "netif attach failed");
+    ESP_RETURN_ON_ERROR(esp_event_handler_register(IP_EVENT, IP_EVENT_ETH_GOT_IP, &got_ip_event_handler, NULL), TAG,
+                        "register event failed");
+
+    return esp_eth_start(eth_handles[0]);
+}
+
+esp_err_t app_stream_init(void)
+{
+    ESP_RETURN_ON_ERROR(app_stream_eth_init(), TAG, "ethernet start failed");
+
+    mjpeg_stream_hw_encoder_config_t encoder_config = MJPEG_STREAM_HW_ENCODER_DEFAULT_CONFIG();
+    encoder_config.src_type = (APP_VIDEO_FMT == APP_VIDEO_FMT_RGB565) ? JPEG_ENCODE_IN_FORMAT_RGB565 :
+                              JPEG_ENCODE_IN_FORMAT_RGB888;
+    encoder_config.quality = CONFIG_EXAMPLE_MJPEG_STREAM_QUALITY;
+    if (mjpeg_stream_hw_encoder_new(&encoder_config, &stream_encoder) != MJPEG_STREAM_OK) {
+        ESP_LOGE(TAG, "create the encoder failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    mjpeg_stream_config_t stream_config = MJPEG_STREAM_DEFAULT_CONFIG();
+    stream_config.port = CONFIG_EXAMPLE_MJPEG_STREAM_PORT;
+    stream_config.client_max = CONFIG_EXAMPLE_MJPEG_STREAM_CLIENT_MAX;
+    stream_config.frame_buf_num = CONFIG_EXAMPLE_MJPEG_STREAM_CLIENT_MAX + 2;
+    stream_config.encode = mjpeg_stream_hw_encode;
+    stream_config.user_data = stream_encoder;
+    if (mjpeg_stream_new(&stream_config, &stream) != MJPEG_STREAM_OK) {
+        ESP_LOGE(TAG, "create the stream failed");
+        mjpeg_stream_hw_encoder_del(stream_encoder);
+        stream_encoder = NULL;
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+void app_stream_frame(const uint8_t *camera_buf, size_t camera_buf_len, uint32_t width, uint32_t height)
+{
+    // Don't encode the frames which nobody watches
+    if ((stream == NULL) || !mjpeg_stream_is_wanted(stream)) {
+        return;
+    }
+
+    int ret = mjpeg_stream_push_frame(stream, camera_buf, camera_buf_len, width, height);
+    if ((ret != MJPEG_STREAM_OK) && (ret != MJPEG_STREAM_ERR_BUSY)) {
+        ESP_LOGW(TAG, "push frame failed: %d", ret);
+    }
+}
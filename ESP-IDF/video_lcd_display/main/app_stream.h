@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#ifndef APP_STREAM_H
+#define APP_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the Ethernet and the MJPEG server of the camera.
+ *
+ * The stream is served on `http://<ip>:CONFIG_EXAMPLE_MJPEG_STREAM_PORT/stream`, the address is logged when the
+ * Ethernet gets it.
+ *
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t app_stream_init(void);
+
+/**
+ * @brief Send a frame of the camera to the clients of the stream.
+ *
+ * The frame is encoded by the JPEG encoder straight from the buffer of the camera, so the buffer must stay dequeued
+ * until it returns. It does nothing without a client, or while the JPEG buffers are all being sent.
+ *
+ * @param camera_buf The frame, in the format of the camera
+ * @param camera_buf_len The length of the frame
+ * @param width The width of the frame
+ * @param height The height of the frame
+ */
+void app_stream_frame(const uint8_t *camera_buf, size_t camera_buf_len, uint32_t width, uint32_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
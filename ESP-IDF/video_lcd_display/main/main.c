@@ -16,6 +16,9 @@
 #include "driver/ledc.h"
 #include "app_video.h"
 #include "app_lcd.h"
+#if CONFIG_EXAMPLE_ENABLE_MJPEG_STREAM
+#include "app_stream.h"
+#endif
 
 #define ALIGN_UP(num, align)    (((num) + ((align) - 1)) & ~((align) - 1))
 
@@ -88,6 +91,14 @@ void app_main(void)
 
     bsp_display_backlight_on();
 
+#if CONFIG_EXAMPLE_ENABLE_MJPEG_STREAM
+    // Serve the camera over the Ethernet, the display runs without it
+    ret = app_stream_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "stream init failed with error 0x%x", ret);
+    }
+#endif
+
     // Register the video frame operation callback
     ESP_ERROR_CHECK(app_video_register_frame_operation_cb(camera_video_frame_operation));
 
@@ -179,6 +190,11 @@ static void camera_video_frame_operation(uint8_t *camera_buf, uint8_t camera_buf
     // } else {
         // ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(display_panel, 0, 0, camera_buf_hes, camera_buf_ves, camera_buf));
     // }
+
+#if CONFIG_EXAMPLE_ENABLE_MJPEG_STREAM
+    // The camera buffer is still dequeued, the encoder reads it in place
+    app_stream_frame(camera_buf, camera_buf_len, camera_buf_hes, camera_buf_ves);
+#endif
 }
 
 #define BSP_LCD_BACKLIGHT   GPIO_NUM_23